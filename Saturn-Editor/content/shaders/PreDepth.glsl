@@ -11,7 +11,6 @@ layout(location = 4) in vec2 a_TexCoord;
 layout(location = 5) in vec4 a_TransformBufferR1;
 layout(location = 6) in vec4 a_TransformBufferR2;
 layout(location = 7) in vec4 a_TransformBufferR3;
-layout(location = 8) in vec4 a_TransformBufferR4;
 
 layout(set = 0, binding = 0) uniform Matrices
 {
@@ -17,11 +17,14 @@ layout(location = 2) in vec3 a_Tangent;
 layout(location = 3) in vec3 a_Binormal;
 layout(location = 4) in vec2 a_TexCoord;
 
-// I don't really know if we need the last colunm as it's always 0.0, 0.0, 0.0, 1.0. Meaning we could use a mat3
+// Only the first three rows are sent, the last row of the transform is always 0.0, 0.0, 0.0, 1.0
 layout(location = 5) in vec4 a_TransformBufferR1;
 layout(location = 6) in vec4 a_TransformBufferR2;
 layout(location = 7) in vec4 a_TransformBufferR3;
-layout(location = 8) in vec4 a_TransformBufferR4;
+
+// Set when the mesh uses QuantisedStaticVertex. Positions are already dequantised by the instance transform,
+// normals and tangents are octahedral encoded and a_Binormal.x is the sign of the binormal.
+layout(constant_id = 0) const bool QUANTISED_VERTICES = false;
 
 layout(binding = 0) uniform Matrices 
 {
@@ -51,23 +54,44 @@ struct VertexOutput
 
 layout( location = 1 ) out VertexOutput vs_Output;
 
+vec3 OctahedralDecode( vec2 Encoded )
+{
+	vec3 Result = vec3( Encoded, 1.0 - abs( Encoded.x ) - abs( Encoded.y ) );
+
+	if( Result.z < 0.0 )
+		Result.xy = ( 1.0 - abs( Result.yx ) ) * vec2( Result.x >= 0.0 ? 1.0 : -1.0, Result.y >= 0.0 ? 1.0 : -1.0 );
+
+	return normalize( Result );
+}
+
 void main()
 {
+	vec3 Normal = a_Normal;
+	vec3 Tangent = a_Tangent;
+	vec3 Binormal = a_Binormal;
+
+	if( QUANTISED_VERTICES )
+	{
+		Normal = OctahedralDecode( a_Normal.xy );
+		Tangent = OctahedralDecode( a_Tangent.xy );
+		Binormal = cross( Normal, Tangent ) * a_Binormal.x;
+	}
+
 	mat4 transform = mat4( 
-		a_TransformBufferR1.x, a_TransformBufferR2.x, a_TransformBufferR3.x, a_TransformBufferR4.x, 
-		a_TransformBufferR1.y, a_TransformBufferR2.y, a_TransformBufferR3.y, a_TransformBufferR4.y, 
-		a_TransformBufferR1.z, a_TransformBufferR2.z, a_TransformBufferR3.z, a_TransformBufferR4.z, 
-		a_TransformBufferR1.w, a_TransformBufferR2.w, a_TransformBufferR3.w, a_TransformBufferR4.w  );
+		a_TransformBufferR1.x, a_TransformBufferR2.x, a_TransformBufferR3.x, 0.0, 
+		a_TransformBufferR1.y, a_TransformBufferR2.y, a_TransformBufferR3.y, 0.0, 
+		a_TransformBufferR1.z, a_TransformBufferR2.z, a_TransformBufferR3.z, 0.0, 
+		a_TransformBufferR1.w, a_TransformBufferR2.w, a_TransformBufferR3.w, 1.0 );
 
 	vec4 WorldPos = transform * vec4( a_Position, 1.0 );
 
 	vs_Output.Position   = WorldPos.xyz;
 	vs_Output.TexCoord   = vec2( a_TexCoord.x, 1.0 - a_TexCoord.y );
-	vs_Output.Normal = mat3( transform ) * a_Normal;
+	vs_Output.Normal = mat3( transform ) * Normal;
 
-	vs_Output.WorldNormals = mat3( transform ) * mat3( a_Tangent, a_Binormal, a_Normal );
+	vs_Output.WorldNormals = mat3( transform ) * mat3( Tangent, Binormal, Normal );
 
-	vs_Output.Bionormal = a_Binormal;
+	vs_Output.Bionormal = Binormal;
 
 	vs_Output.CameraView = mat3( u_Matrices.View );
 
@@ -85,6 +109,8 @@ void main()
 #type fragment
 #version 450 core
 
+#extension GL_EXT_nonuniform_qualifier : require
+
 #define TRUE 1
 #define FALSE 0
 
@@ -114,7 +140,8 @@ struct PointLight
 	float Falloff;
 };
 
-layout(push_constant) uniform pc_Materials
+// Matches BindlessMaterial on the CPU.
+struct MaterialData
 {
 	vec3 AlbedoColor;
 	float UseNormalMap;
@@ -123,7 +150,17 @@ layout(push_constant) uniform pc_Materials
 	float Roughness;
 	float Emissive;
 
-} u_Materials; 
+	// Slots in u_Textures.
+	uint AlbedoTexture;
+	uint NormalTexture;
+	uint MetallicTexture;
+	uint RoughnessTexture;
+};
+
+layout(push_constant) uniform pc_Material
+{
+	uint Index;
+} u_Material;
 
 layout(set = 0, binding = 2) uniform Camera 
 {
@@ -136,29 +173,30 @@ layout(set = 0, binding = 3) uniform ShadowData
 	vec4 CascadeSplits;
 };
 
-layout(set = 0, binding = 12) uniform DebugData 
-{
-	// Very temp.
-	int TilesCountX;
-} u_DebugData;
-
-// TODO: Change number of lights...
-layout(set = 0, binding = 13) uniform Lights 
+// Point lights that are inside the view.
+layout(std430, set = 0, binding = 13) readonly buffer PointLightBuffer
 {
 	uint nbLights;
-	PointLight Lights[512];
-} u_Lights;
+	PointLight Lights[];
+} s_PointLights;
 
-layout(std430, set = 0, binding = 14) buffer VisiblePointLightIndicesBuffer
+// Clustered light lists, see LightClusters on the CPU.
+// Data starts with an offset and count for every cluster followed by the indices into s_PointLights.
+layout(std430, set = 0, binding = 14) readonly buffer LightClusterBuffer
 {
-	int Indices[];
-} s_VisiblePointLightIndicesBuffer;
+	uvec4 GridSize;
+	// xy: log( view depth ) to depth slice, zw: one over the cluster size in pixels.
+	vec4 Slicing;
+	uint Data[];
+} s_LightClusters;
 
-// Textures
-layout (set = 0, binding = 4) uniform sampler2D u_AlbedoTexture;
-layout (set = 0, binding = 5) uniform sampler2D u_NormalTexture;
-layout (set = 0, binding = 6) uniform sampler2D u_MetallicTexture;
-layout (set = 0, binding = 7) uniform sampler2D u_RoughnessTexture;
+// Set 2, owned by the bindless table, every resident texture and material.
+layout (set = 2, binding = 0) uniform sampler2D u_Textures[];
+
+layout(std430, set = 2, binding = 1) readonly buffer MaterialTable
+{
+	MaterialData Materials[];
+} s_Materials;
 
 // Set 1, owned by renderer, environment settings.
 layout (set = 1, binding = 8) uniform sampler2DArray u_ShadowMap;
@@ -350,45 +388,39 @@ vec3 IBL(vec3 F0, vec3 Lr)
 }
 
 //////////////////////////////////////////////////////////////////////////
-// Forward+
-int GetPointLightBufferIndex(int i)
+// Clustered Forward+
+uint GetLightClusterIndex()
 {
-	ivec2 tileID = ivec2(gl_FragCoord) / ivec2(16, 16);
-	uint index = tileID.y * u_DebugData.TilesCountX + tileID.x;
+	float ViewDepth = max( -vs_Input.ViewPosition.z, 0.0001 );
 
-	uint offset = index * 1024;
-	return s_VisiblePointLightIndicesBuffer.Indices[offset + i];
+	uvec3 Cluster;
+	Cluster.xy = min( uvec2( gl_FragCoord.xy * s_LightClusters.Slicing.zw ), s_LightClusters.GridSize.xy - 1 );
+	Cluster.z = uint( clamp( floor( log( ViewDepth ) * s_LightClusters.Slicing.x + s_LightClusters.Slicing.y ), 0.0, float( s_LightClusters.GridSize.z - 1 ) ) );
+
+	return ( Cluster.z * s_LightClusters.GridSize.y + Cluster.y ) * s_LightClusters.GridSize.x + Cluster.x;
 }
 
-int GetPointLightCount()
+uint GetPointLightCount()
 {
-	int result = 0;
-	for (int i = 0; i < u_Lights.nbLights; i++)
-	{
-		uint lightIndex = GetPointLightBufferIndex(i);
-		if (lightIndex == -1)
-			break;
-
-		result++;
-	}
-
-	return result;
+	return s_LightClusters.Data[ GetLightClusterIndex() * 2 + 1 ];
 }
 
-
 //////////////////////////////////////////////////////////////////////////
 // Forward+, Point Lights
 
 vec3 CalculatePointLights(in vec3 F0, vec3 worldPos)
 {
 	vec3 result = vec3(0.0);
-	for (int i = 0; i < u_Lights.nbLights; i++)
+
+	uint cluster = GetLightClusterIndex();
+	uint offset = s_LightClusters.Data[cluster * 2];
+	uint count = s_LightClusters.Data[cluster * 2 + 1];
+
+	for (uint i = 0; i < count; i++)
 	{
-		uint lightIndex = GetPointLightBufferIndex(i);
-		if (lightIndex == -1)
-			break;
+		uint lightIndex = s_LightClusters.Data[offset + i];
 
-		PointLight light = u_Lights.Lights[lightIndex];
+		PointLight light = s_PointLights.Lights[lightIndex];
 		vec3 Li = normalize(light.Position - worldPos);
 		float lightDistance = length(light.Position - worldPos);
 		vec3 Lh = normalize(Li + m_Params.View);
@@ -419,17 +451,21 @@ vec3 CalculatePointLights(in vec3 F0, vec3 worldPos)
 
 void main() 
 {
-	vec4 AlbedoColor = texture( u_AlbedoTexture, vs_Input.TexCoord );
-	m_Params.Albedo = AlbedoColor.rgb * u_Materials.AlbedoColor;
+	MaterialData Material = s_Materials.Materials[ u_Material.Index ];
+
+	vec4 AlbedoColor = texture( u_Textures[ Material.AlbedoTexture ], vs_Input.TexCoord );
+	m_Params.Albedo = AlbedoColor.rgb * Material.AlbedoColor;
 
-	m_Params.Metalness = texture( u_MetallicTexture, vs_Input.TexCoord ).r * u_Materials.Metalness;
-	m_Params.Roughness = texture( u_RoughnessTexture, vs_Input.TexCoord ).r * u_Materials.Roughness;
+	m_Params.Metalness = texture( u_Textures[ Material.MetallicTexture ], vs_Input.TexCoord ).r * Material.Metalness;
+	m_Params.Roughness = texture( u_Textures[ Material.RoughnessTexture ], vs_Input.TexCoord ).r * Material.Roughness;
 	m_Params.Roughness = max( m_Params.Roughness, 0.05 ); // Minimum roughness of 0.05 to keep specular highlight
 
 	m_Params.Normal = normalize( vs_Input.Normal );
-	if( u_Materials.UseNormalMap > 0.5 ) 
+	if( Material.UseNormalMap > 0.5 ) 
 	{
-		m_Params.Normal = normalize( 2.0 * texture( u_NormalTexture, vs_Input.TexCoord ).rgb - 1.0);
+		// Cooked normal maps are BC5 and only store X and Y, rebuild Z the same way for every normal map.
+		vec2 NormalXY = 2.0 * texture( u_Textures[ Material.NormalTexture ], vs_Input.TexCoord ).rg - 1.0;
+		m_Params.Normal = normalize( vec3( NormalXY, sqrt( max( 1.0 - dot( NormalXY, NormalXY ), 0.0 ) ) ) );
 		m_Params.Normal = normalize( vs_Input.WorldNormals * m_Params.Normal );
 	}
 
@@ -467,7 +503,7 @@ void main()
 	LightingContribution = Lighting( F0 ) * ShadowAmount;
 	iblContribution = IBL( F0, Lr );
 	LightingContribution += CalculatePointLights( F0, vs_Input.Position );
-	LightingContribution += m_Params.Albedo * u_Materials.Emissive;
+	LightingContribution += m_Params.Albedo * Material.Emissive;
 
 	FinalColor = vec4( iblContribution + LightingContribution, 1.0 );
 
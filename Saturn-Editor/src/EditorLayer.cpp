@@ -52,6 +52,7 @@
 #include <Saturn/Vulkan/ShaderBundle.h>
 #include <Saturn/Vulkan/Renderer2D.h>
 #include <Saturn/Vulkan/VulkanImageAux.h>
+#include <Saturn/Vulkan/Material.h>
 
 #include <Saturn/Core/EnvironmentVariables.h>
 
@@ -1115,13 +1116,15 @@ namespace Saturn {
 
 	void EditorLayer::DrawMaterialHeader( Ref<MaterialAsset>& rMaterial )
 	{
-		auto drawItemValue = [&]( const char* name, const char* property )
+		auto drawItemValue = [&]( const char* name, uint64_t property )
 			{
 				ImGui::Text( name );
 
 				ImGui::Separator();
 
-				float v = rMaterial->Get< float >( property );
+				MaterialParam<float> Param = rMaterial->Resolve<float>( property );
+
+				float v = rMaterial->Get( Param );
 
 				ImGui::PushID( name );
 
@@ -1129,8 +1132,8 @@ namespace Saturn {
 
 				ImGui::PopID();
 
-				if( v != rMaterial->Get<float>( property ) )
-					rMaterial->Set( property, v );
+				if( v != rMaterial->Get( Param ) )
+					rMaterial->Set( Param, v );
 			};
 
 		auto displayItemMap = [&]( const char* property )
@@ -1154,7 +1157,7 @@ namespace Saturn {
 			Auxiliary::DrawAssetDragDropTarget<MaterialAsset>( "Change asset", rMaterial->GetName().c_str(), id,
 				[rMaterial]( Ref<MaterialAsset> asset ) mutable
 				{
-					rMaterial->SetMaterial( asset->GetMaterial() );
+					rMaterial->SetMaterial( asset );
 				} );
 
 			ImGui::Separator();
@@ -1177,35 +1180,35 @@ namespace Saturn {
 				}
 			}
 
-			glm::vec3 color = rMaterial->Get<glm::vec3>( "u_Materials.AlbedoColor" );
+			glm::vec3 color = rMaterial->GetAlbeoColor();
 
 			bool changed = ImGui::ColorEdit3( "##Albedo Color", glm::value_ptr( color ), ImGuiColorEditFlags_NoInputs );
 
 			if( changed )
-				rMaterial->Set<glm::vec3>( "u_Materials.AlbedoColor", color );
+				rMaterial->SetAlbeoColor( color );
 
-			drawItemValue( "Emissive", "u_Materials.Emissive" );
+			drawItemValue( "Emissive", "u_Materials.Emissive"_param );
 
 			ImGui::Text( "Normal" );
 
 			ImGui::Separator();
 
-			bool UseNormalMap = rMaterial->Get< float >( "u_Materials.UseNormalMap" );
+			bool UseNormalMap = rMaterial->IsUsingNormalMap() > 0.5f;
 
 			if( UseNormalMap )
 				displayItemMap( "u_NormalTexture" );
 
 			if( ImGui::Checkbox( "Use Normal Map", &UseNormalMap ) )
-				rMaterial->Set( "u_Materials.UseNormalMap", UseNormalMap ? 1.0f : 0.0f );
+				rMaterial->UseNormalMap( UseNormalMap );
 
 			// Roughness Value
-			drawItemValue( "Roughness", "u_Materials.Roughness" );
+			drawItemValue( "Roughness", "u_Materials.Roughness"_param );
 
 			// Roughness map
 			displayItemMap( "u_RoughnessTexture" );
 
 			// Metalness value
-			drawItemValue( "Metalness", "u_Materials.Metalness" );
+			drawItemValue( "Metalness", "u_Materials.Metalness"_param );
 
 			// Metalness map
 			displayItemMap( "u_MetallicTexture" );
@@ -1533,6 +1536,22 @@ namespace Saturn {
 				ImGui::Text( "Vendor ID: %i", devices.DeviceProps.vendorID );
 				ImGui::Text( "Vulkan Version: 1.2.128" );
 			}
+
+			ImGui::Separator();
+
+			static MaterialParamBenchmark s_MaterialBenchmark;
+
+			if( ImGui::Button( "Benchmark material parameters" ) )
+			{
+				if( Ref<Shader> StaticMeshShader = ShaderLibrary::Get().Find( "shader_new" ) )
+					s_MaterialBenchmark = Material::BenchmarkParameters( StaticMeshShader, 1000000 );
+			}
+
+			if( s_MaterialBenchmark.Iterations )
+			{
+				ImGui::Text( "%s x %u: linear %.3f ms, hashed name %.3f ms, handle %.3f ms", s_MaterialBenchmark.Parameter.c_str(), s_MaterialBenchmark.Iterations, 
+					s_MaterialBenchmark.LinearSearchMs, s_MaterialBenchmark.HashedNameMs, s_MaterialBenchmark.HandleMs );
+			}
 		}
 
 		ImGui::End();
@@ -1759,6 +1778,32 @@ namespace Saturn {
 			}
 		}
 
+		// Instance painting
+		InstancePainter& rPainter = hierarchyPanel->GetInstancePainter();
+
+		if( !m_RuntimeScene && rPainter.IsActive() && selectedEntities.size() == 1 && selectedEntities[ 0 ]->HasComponent<InstancedStaticMeshComponent>() )
+		{
+			bool OverGizmo = m_GizmoOperation != 0 && ImGuizmo::IsOver();
+
+			if( m_MouseOverViewport && !OverGizmo && ImGui::IsMouseDown( ImGuiMouseButton_Left ) )
+			{
+				ImVec2 MousePosition = ImGui::GetMousePos();
+
+				// The viewport image is flipped, up on the screen is up in clip space.
+				glm::vec2 NDC = { ( MousePosition.x - minBound.x ) / m_ViewportSize.x * 2.0f - 1.0f, 1.0f - ( MousePosition.y - minBound.y ) / m_ViewportSize.y * 2.0f };
+
+				glm::vec4 FarPoint = glm::inverse( m_EditorCamera.ViewProjection() ) * glm::vec4( NDC, 1.0f, 1.0f );
+				glm::vec3 Direction = glm::normalize( glm::vec3( FarPoint ) / FarPoint.w - m_EditorCamera.GetPosition() );
+
+				if( rPainter.Stroke( m_EditorScene.Get(), selectedEntities[ 0 ], m_EditorCamera.GetPosition(), Direction, ImGui::GetIO().KeyShift ) )
+					m_EditorScene->MarkDirty();
+			}
+			else
+			{
+				rPainter.EndStroke();
+			}
+		}
+
 		ImGui::PopStyleVar();
 		ImGui::End();
 	}
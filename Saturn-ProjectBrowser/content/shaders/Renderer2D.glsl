@@ -1,22 +1,22 @@
 #type vertex
 #version 450
 
-// Inputs
-layout(location = 0) in vec3 a_Position;
-layout(location = 1) in vec4 a_Color;
-layout(location = 2) in vec2 a_TexCoord;
-layout(location = 3) in float a_TextureIndex;
+// Per vertex, one corner of the unit quad.
+layout(location = 0) in vec2 a_Corner;
+
+// Per instance.
+layout(location = 1) in vec4 a_Position; // xyz: centre, w: texture index
+layout(location = 2) in vec4 a_Color;
+layout(location = 3) in vec4 a_AxisX;    // xyz: edge, w: 1 for billboards
+layout(location = 4) in vec4 a_AxisY;
 
 layout(set = 0, binding = 0) uniform Matrices
 {
 	mat4 ViewProjection;
+	vec4 CameraRight;
+	vec4 CameraUp;
 } u_Matrices;
 
-layout(push_constant) uniform pc_Transform
-{
-	mat4 Transform;
-} u_Transform; 
-
 struct VertOut 
 {
 	vec2 TexCoord;
@@ -28,11 +28,24 @@ layout( location = 2 ) out flat float o_TexIndex;
 
 void main() 
 {
+	vec3 Position;
+
+	// Billboards only store their size and always face the camera.
+	if( a_AxisX.w > 0.5 )
+	{
+		Position = a_Position.xyz + u_Matrices.CameraRight.xyz * a_Corner.x * a_AxisX.x + u_Matrices.CameraUp.xyz * a_Corner.y * a_AxisY.y;
+		o_OutputData.TexCoord = vec2( a_Corner.x + 0.5, 0.5 - a_Corner.y );
+	}
+	else
+	{
+		Position = a_Position.xyz + a_AxisX.xyz * a_Corner.x + a_AxisY.xyz * a_Corner.y;
+		o_OutputData.TexCoord = vec2( a_Corner.y + 0.5, a_Corner.x + 0.5 );
+	}
+
 	o_OutputData.Color = a_Color;
-	o_OutputData.TexCoord = a_TexCoord;
-	o_TexIndex = a_TextureIndex;
+	o_TexIndex = a_Position.w;
 
-	gl_Position = u_Matrices.ViewProjection * u_Transform.Transform * vec4( a_Position, 1.0 );
+	gl_Position = u_Matrices.ViewProjection * vec4( Position, 1.0 );
 }
 
 #type fragment
@@ -52,6 +65,8 @@ layout( location = 0 ) out vec4 FinalColor;
 layout(set = 0, binding = 0) uniform Matrices
 {
 	mat4 ViewProjection;
+	vec4 CameraRight;
+	vec4 CameraUp;
 } u_Matrices;
 
 layout( set = 0, binding = 1 ) uniform sampler2D u_InputTexture[32];
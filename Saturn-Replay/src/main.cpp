@@ -0,0 +1,511 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#include "sppch.h"
+
+#include "Saturn/Asset/TextureCooker.h"
+#include "Saturn/Core/Renderer/DrawListCapture.h"
+#include "Saturn/Core/Renderer/DrawListReplay.h"
+#include "Saturn/Core/Renderer/LightClusters.h"
+#include "Saturn/Core/Renderer/OcclusionCuller.h"
+#include "Saturn/Core/Renderer/ParticleSystem.h"
+#include "Saturn/Core/Timer.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// Replays a draw list capture from SceneRenderer::CaptureDrawList through the CPU side of the scene renderer and prints the time of every stage.
+// Nothing is drawn, commands are built into a null backend, so this runs without a device.
+// The other modes run a CPU system on a fixed scene twice and check that both runs produce the same result.
+// The particle mode simulates emitters at a fixed time step with fixed seeds.
+// Usage: Saturn-Replay <capture> [iterations] [csv]
+//        Saturn-Replay --occlusion [boxes]
+//        Saturn-Replay --clusters [lights]
+//        Saturn-Replay --textures [size]
+//        Saturn-Replay --particles [emitters] [frames]
+
+static uint64_t HashBytes( uint64_t Hash, const void* pData, size_t Size )
+{
+	const uint8_t* pBytes = ( const uint8_t* ) pData;
+
+	for( size_t i = 0; i < Size; i++ )
+	{
+		Hash ^= pBytes[ i ];
+		Hash *= 1099511628211ull;
+	}
+
+	return Hash;
+}
+
+// Xorshift, the scenes use a fixed seed so every run builds the same one.
+static float RandomFloat( uint32_t& rState )
+{
+	rState ^= rState << 13;
+	rState ^= rState >> 17;
+	rState ^= rState << 5;
+
+	return ( float ) ( rState & 0xFFFFFF ) / ( float ) 0xFFFFFF;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Occlusion culling
+
+static const glm::vec3 s_BoxVertices[ 8 ] =
+{
+	{ -0.5f, -0.5f, -0.5f }, { 0.5f, -0.5f, -0.5f }, { 0.5f, 0.5f, -0.5f }, { -0.5f, 0.5f, -0.5f },
+	{ -0.5f, -0.5f,  0.5f }, { 0.5f, -0.5f,  0.5f }, { 0.5f, 0.5f,  0.5f }, { -0.5f, 0.5f,  0.5f }
+};
+
+static const uint32_t s_BoxIndices[ 36 ] =
+{
+	0, 2, 1, 0, 3, 2, 4, 5, 6, 4, 6, 7,
+	0, 1, 5, 0, 5, 4, 3, 7, 6, 3, 6, 2,
+	0, 4, 7, 0, 7, 3, 1, 2, 6, 1, 6, 5
+};
+
+// A row of walls in front of the camera with a field of boxes around them, returns the hash of the depth buffer and of every visibility result.
+static uint64_t CullScene( uint32_t BoxCount, float* pMs, uint32_t* pVisible )
+{
+	const glm::mat4 View = glm::lookAt( glm::vec3( 0.0f, 2.0f, 20.0f ), glm::vec3( 0.0f, 2.0f, 0.0f ), glm::vec3( 0.0f, 1.0f, 0.0f ) );
+	const glm::mat4 Projection = glm::perspective( glm::radians( 60.0f ), 2.0f, 0.1f, 500.0f );
+
+	std::vector<glm::mat4> Walls;
+
+	for( int i = -3; i <= 3; i++ )
+	{
+		glm::mat4 Transform = glm::translate( glm::mat4( 1.0f ), glm::vec3( ( float ) i * 7.0f, 2.5f, ( float ) ( i & 1 ) * 3.0f ) );
+		Walls.push_back( glm::scale( Transform, glm::vec3( 6.0f, 5.0f, 0.5f ) ) );
+	}
+
+	uint32_t Seed = 1;
+	std::vector<glm::mat4> Boxes;
+
+	for( uint32_t i = 0; i < BoxCount; i++ )
+	{
+		const glm::vec3 Position = glm::vec3( RandomFloat( Seed ) * 80.0f - 40.0f, RandomFloat( Seed ) * 6.0f, RandomFloat( Seed ) * -60.0f + 15.0f );
+		Boxes.push_back( glm::scale( glm::translate( glm::mat4( 1.0f ), Position ), glm::vec3( 0.5f + RandomFloat( Seed ) * 2.0f ) ) );
+	}
+
+	Saturn::Ref<Saturn::OcclusionCuller> Culler = Saturn::Ref<Saturn::OcclusionCuller>::Create();
+
+	Saturn::Timer CullTimer;
+
+	Culler->BeginFrame( Projection * View );
+
+	for( const glm::mat4& rWall : Walls )
+		Culler->AddOccluder( s_BoxVertices, sizeof( glm::vec3 ), s_BoxIndices, 36, rWall );
+
+	Culler->Rasterise();
+
+	const Saturn::AABB Bounds( glm::vec3( -0.5f ), glm::vec3( 0.5f ) );
+	std::vector<uint8_t> Visible( Boxes.size() );
+
+	for( size_t i = 0; i < Boxes.size(); i++ )
+		Visible[ i ] = Culler->IsVisible( Bounds, Boxes[ i ] ) ? 1 : 0;
+
+	*pMs = CullTimer.ElapsedMilliseconds();
+	*pVisible = 0;
+
+	for( uint8_t Value : Visible )
+		*pVisible += Value;
+
+	uint64_t Hash = 14695981039346656037ull;
+	Hash = HashBytes( Hash, Culler->GetDepth().data(), Culler->GetDepth().size() * sizeof( float ) );
+	Hash = HashBytes( Hash, Visible.data(), Visible.size() );
+
+	return Hash;
+}
+
+static int RunOcclusion( int count, char** args )
+{
+	uint32_t BoxCount = count > 2 ? ( uint32_t ) std::max( atoi( args[ 2 ] ), 1 ) : 10000;
+
+	float FirstMs = 0.0f, SecondMs = 0.0f;
+	uint32_t Visible = 0;
+
+	uint64_t FirstHash = CullScene( BoxCount, &FirstMs, &Visible );
+	uint64_t SecondHash = CullScene( BoxCount, &SecondMs, &Visible );
+
+	printf( "Occlusion: %u boxes, %u visible, hash %016llx\n", BoxCount, Visible, ( unsigned long long ) FirstHash );
+	printf( "Cull: %.3f ms, %.3f ms\n", FirstMs, SecondMs );
+
+	if( FirstHash != SecondHash )
+	{
+		fprintf( stderr, "Runs culled different boxes!\n" );
+		return 2;
+	}
+
+	return 0;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Light clusters
+
+// Point lights spread through a 200m area around the camera, returns the hash of the visible lights and of every cluster list.
+static uint64_t AssignLights( uint32_t LightCount, float* pMs, uint32_t* pVisible, uint32_t* pIndices )
+{
+	const glm::mat4 View = glm::lookAt( glm::vec3( 0.0f, 5.0f, 0.0f ), glm::vec3( 0.0f, 5.0f, -1.0f ), glm::vec3( 0.0f, 1.0f, 0.0f ) );
+	const glm::mat4 Projection = glm::perspective( glm::radians( 60.0f ), 16.0f / 9.0f, 0.1f, 500.0f );
+
+	uint32_t Seed = 1;
+	std::vector<glm::vec4> Spheres;
+
+	for( uint32_t i = 0; i < LightCount; i++ )
+	{
+		const glm::vec3 Position = glm::vec3( RandomFloat( Seed ) * 200.0f - 100.0f, RandomFloat( Seed ) * 10.0f, RandomFloat( Seed ) * 200.0f - 100.0f );
+		Spheres.push_back( glm::vec4( Position, 1.0f + RandomFloat( Seed ) * 9.0f ) );
+	}
+
+	Saturn::Ref<Saturn::LightClusters> Clusters = Saturn::Ref<Saturn::LightClusters>::Create();
+
+	Saturn::Timer BuildTimer;
+
+	Clusters->Build( Spheres, View, Projection, 1920, 1080 );
+
+	*pMs = BuildTimer.ElapsedMilliseconds();
+	*pVisible = ( uint32_t ) Clusters->GetVisibleLights().size();
+	*pIndices = Clusters->GetIndexCount();
+
+	uint64_t Hash = 14695981039346656037ull;
+	Hash = HashBytes( Hash, Clusters->GetVisibleLights().data(), Clusters->GetVisibleLights().size() * sizeof( uint32_t ) );
+	Hash = HashBytes( Hash, Clusters->GetClusterData().data(), Clusters->GetClusterData().size() * sizeof( uint32_t ) );
+
+	return Hash;
+}
+
+static int RunClusters( int count, char** args )
+{
+	uint32_t LightCount = count > 2 ? ( uint32_t ) std::max( atoi( args[ 2 ] ), 1 ) : 4096;
+
+	float FirstMs = 0.0f, SecondMs = 0.0f;
+	uint32_t Visible = 0, Indices = 0;
+
+	uint64_t FirstHash = AssignLights( LightCount, &FirstMs, &Visible, &Indices );
+	uint64_t SecondHash = AssignLights( LightCount, &SecondMs, &Visible, &Indices );
+
+	printf( "Clusters: %u lights, %u visible, %u indices, hash %016llx\n", LightCount, Visible, Indices, ( unsigned long long ) FirstHash );
+	printf( "Build: %.3f ms, %.3f ms\n", FirstMs, SecondMs );
+
+	if( FirstHash != SecondHash )
+	{
+		fprintf( stderr, "Runs assigned different lights!\n" );
+		return 2;
+	}
+
+	return 0;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Texture cooking
+
+// Smooth gradients with a little noise, the kind of content the encoders have to fit.
+static std::vector<uint8_t> BuildTestImage( uint32_t Size )
+{
+	std::vector<uint8_t> Pixels( ( size_t ) Size * Size * 4 );
+	uint32_t Seed = 1;
+
+	for( uint32_t y = 0; y < Size; y++ )
+	{
+		for( uint32_t x = 0; x < Size; x++ )
+		{
+			const float u = ( float ) x / ( float ) Size;
+			const float v = ( float ) y / ( float ) Size;
+
+			const float Values[ 4 ] = { u, v, 0.5f + 0.5f * std::sin( ( u + v ) * 12.0f ), 1.0f - u * v };
+
+			for( int Channel = 0; Channel < 4; Channel++ )
+			{
+				const float Noise = ( RandomFloat( Seed ) - 0.5f ) * 0.05f;
+				Pixels[ ( ( size_t ) y * Size + x ) * 4 + Channel ] = ( uint8_t ) std::round( glm::clamp( Values[ Channel ] + Noise, 0.0f, 1.0f ) * 255.0f );
+			}
+		}
+	}
+
+	return Pixels;
+}
+
+// Cooks the image twice and compares every mip, then decodes mip 0 and returns the RMS error against the source.
+// LDR errors are in 0-255 steps, HDR errors are relative to the source value.
+static float CookAndMeasure( const void* pPixels, uint32_t Size, bool HDR, Saturn::TextureUsage Usage, Saturn::ImageFormat* pFormat, bool* pDeterministic )
+{
+	Saturn::CookedTexture First = Saturn::TextureCooker::Cook( pPixels, Size, Size, HDR, Usage );
+	Saturn::CookedTexture Second = Saturn::TextureCooker::Cook( pPixels, Size, Size, HDR, Usage );
+
+	*pFormat = First.Format;
+	*pDeterministic = First.Mips.size() == Second.Mips.size();
+
+	for( size_t Mip = 0; Mip < First.Mips.size() && *pDeterministic; Mip++ )
+		*pDeterministic = First.Mips[ Mip ].Size == Second.Mips[ Mip ].Size && memcmp( First.Mips[ Mip ].Data, Second.Mips[ Mip ].Data, First.Mips[ Mip ].Size ) == 0;
+
+	// Only the channels the format stores.
+	const int Channels = First.Format == Saturn::ImageFormat::BC4 ? 1 : First.Format == Saturn::ImageFormat::BC7 ? 4 : 3;
+	const uint32_t BlockSize = Saturn::TextureCooker::GetBlockSize( First.Format );
+	const uint32_t BlocksX = ( Size + 3 ) / 4;
+
+	double Error = 0.0;
+	glm::vec4 Texels[ 16 ];
+
+	for( uint32_t by = 0; by < ( Size + 3 ) / 4; by++ )
+	{
+		for( uint32_t bx = 0; bx < BlocksX; bx++ )
+		{
+			Saturn::TextureCooker::DecodeBlock( First.Format, First.Mips[ 0 ].Data + ( ( size_t ) by * BlocksX + bx ) * BlockSize, Texels );
+
+			for( uint32_t t = 0; t < 16; t++ )
+			{
+				const uint32_t x = std::min( bx * 4 + t % 4, Size - 1 );
+				const uint32_t y = std::min( by * 4 + t / 4, Size - 1 );
+				const size_t Texel = ( size_t ) y * Size + x;
+
+				for( int Channel = 0; Channel < Channels; Channel++ )
+				{
+					float Delta;
+
+					if( HDR )
+					{
+						const float Source = ( ( const float* ) pPixels )[ Texel * 4 + Channel ];
+						Delta = ( Texels[ t ][ Channel ] - Source ) / std::max( Source, 1e-3f );
+					}
+					else
+					{
+						Delta = Texels[ t ][ Channel ] - ( float ) ( ( const uint8_t* ) pPixels )[ Texel * 4 + Channel ];
+					}
+
+					Error += ( double ) Delta * Delta;
+				}
+			}
+		}
+	}
+
+	First.Free();
+	Second.Free();
+
+	return ( float ) std::sqrt( Error / ( ( double ) BlocksX * BlocksX * 16 * Channels ) );
+}
+
+static int RunTextures( int count, char** args )
+{
+	uint32_t Size = count > 2 ? ( uint32_t ) std::max( atoi( args[ 2 ] ), 4 ) : 512;
+
+	std::vector<uint8_t> Pixels = BuildTestImage( Size );
+
+	// The same image scaled into an HDR range.
+	std::vector<float> HDRPixels( Pixels.size() );
+
+	for( size_t i = 0; i < Pixels.size(); i++ )
+		HDRPixels[ i ] = i % 4 == 3 ? 1.0f : ( float ) Pixels[ i ] / 255.0f * 16.0f;
+
+	// The test image has alpha, generic would pick BC3 so clear it for BC1.
+	std::vector<uint8_t> OpaquePixels = Pixels;
+
+	for( size_t i = 3; i < OpaquePixels.size(); i += 4 )
+		OpaquePixels[ i ] = 255;
+
+	struct TextureCase
+	{
+		const void* pPixels;
+		bool HDR;
+		Saturn::TextureUsage Usage;
+	};
+
+	const TextureCase Cases[] =
+	{
+		{ OpaquePixels.data(), false, Saturn::TextureUsage::Generic },
+		{ Pixels.data(), false, Saturn::TextureUsage::Mask },
+		{ Pixels.data(), false, Saturn::TextureUsage::Albedo },
+		{ HDRPixels.data(), true, Saturn::TextureUsage::HDR }
+	};
+
+	bool Deterministic = true;
+
+	printf( "Textures: %ux%u\n", Size, Size );
+
+	for( const TextureCase& rCase : Cases )
+	{
+		Saturn::ImageFormat Format = Saturn::ImageFormat::None;
+		bool Same = false;
+
+		Saturn::Timer CookTimer;
+
+		float Error = CookAndMeasure( rCase.pPixels, Size, rCase.HDR, rCase.Usage, &Format, &Same );
+
+		printf( "%-5s %.3f RMS error%s, %.3f ms for two cooks%s\n", Saturn::TextureCooker::FormatToString( Format ), Error,
+			rCase.HDR ? " (relative)" : "", CookTimer.ElapsedMilliseconds(), Same ? "" : ", runs differ" );
+
+		Deterministic &= Same;
+	}
+
+	if( !Deterministic )
+	{
+		fprintf( stderr, "Runs cooked different blocks!\n" );
+		return 2;
+	}
+
+	return 0;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Particles
+
+static uint64_t SimulateParticles( uint32_t EmitterCount, uint32_t Frames, float* pAverageMs, float* pWorstMs, uint32_t* pLiveParticles )
+{
+	Saturn::ParticleEmitterSettings Settings;
+	Settings.SpawnRate = 2000.0f;
+	Settings.MaxParticles = 10000;
+	Settings.SpawnRadius = 0.5f;
+	Settings.Drag = 0.1f;
+
+	std::vector<Saturn::Ref<Saturn::ParticleEmitter>> Emitters;
+	std::vector<Saturn::ParticleEmitterUpdate> Updates;
+
+	for( uint32_t i = 0; i < EmitterCount; i++ )
+	{
+		Emitters.push_back( Saturn::Ref<Saturn::ParticleEmitter>::Create( i + 1 ) );
+
+		// Spread the emitters away from the origin so the distance throttling is exercised as well.
+		Saturn::ParticleEmitterUpdate Update;
+		Update.pEmitter = Emitters.back().Get();
+		Update.pSettings = &Settings;
+		Update.Transform = glm::translate( glm::mat4( 1.0f ), glm::vec3( ( float ) i * 10.0f, 0.0f, 0.0f ) );
+		Update.CameraDistance = ( float ) i * 10.0f;
+
+		Updates.push_back( Update );
+	}
+
+	float TotalMs = 0.0f;
+	*pWorstMs = 0.0f;
+
+	for( uint32_t Frame = 0; Frame < Frames; Frame++ )
+	{
+		Saturn::Timer FrameTimer;
+
+		Saturn::ParticleSystem::Update( Updates, 1.0f / 60.0f );
+
+		float Ms = FrameTimer.ElapsedMilliseconds();
+		TotalMs += Ms;
+		*pWorstMs = std::max( *pWorstMs, Ms );
+	}
+
+	*pAverageMs = TotalMs / ( float ) std::max( Frames, 1u );
+	*pLiveParticles = 0;
+
+	uint64_t Hash = 14695981039346656037ull;
+
+	for( const auto& rEmitter : Emitters )
+	{
+		*pLiveParticles += rEmitter->GetCount();
+
+		Hash ^= rEmitter->GetHash();
+		Hash *= 1099511628211ull;
+	}
+
+	return Hash;
+}
+
+static int RunParticles( int count, char** args )
+{
+	uint32_t EmitterCount = count > 2 ? ( uint32_t ) std::max( atoi( args[ 2 ] ), 1 ) : 64;
+	uint32_t Frames = count > 3 ? ( uint32_t ) std::max( atoi( args[ 3 ] ), 1 ) : 600;
+
+	float AverageMs = 0.0f, WorstMs = 0.0f;
+	uint32_t LiveParticles = 0;
+
+	uint64_t FirstHash = SimulateParticles( EmitterCount, Frames, &AverageMs, &WorstMs, &LiveParticles );
+	uint64_t SecondHash = SimulateParticles( EmitterCount, Frames, &AverageMs, &WorstMs, &LiveParticles );
+
+	printf( "Particles: %u emitters, %u frames, %u live particles\n", EmitterCount, Frames, LiveParticles );
+	printf( "Update: %.3f ms average, %.3f ms worst\n", AverageMs, WorstMs );
+
+	if( FirstHash != SecondHash )
+	{
+		fprintf( stderr, "Runs simulated different particles!\n" );
+		return 2;
+	}
+
+	return 0;
+}
+
+int main( int count, char** args )
+{
+	if( count < 2 )
+	{
+		printf( "Usage: %s <capture> [iterations] [csv]\n", args[ 0 ] );
+		printf( "       %s --occlusion [boxes]\n", args[ 0 ] );
+		printf( "       %s --clusters [lights]\n", args[ 0 ] );
+		printf( "       %s --textures [size]\n", args[ 0 ] );
+		printf( "       %s --particles [emitters] [frames]\n", args[ 0 ] );
+		return 1;
+	}
+
+	if( strcmp( args[ 1 ], "--occlusion" ) == 0 )
+		return RunOcclusion( count, args );
+
+	if( strcmp( args[ 1 ], "--clusters" ) == 0 )
+		return RunClusters( count, args );
+
+	if( strcmp( args[ 1 ], "--textures" ) == 0 )
+		return RunTextures( count, args );
+
+	if( strcmp( args[ 1 ], "--particles" ) == 0 )
+		return RunParticles( count, args );
+
+	std::filesystem::path CapturePath = args[ 1 ];
+	uint32_t Iterations = count > 2 ? ( uint32_t ) std::max( atoi( args[ 2 ] ), 1 ) : 100;
+
+	Saturn::DrawListCapture Capture;
+
+	if( !Capture.Load( CapturePath ) )
+	{
+		fprintf( stderr, "Failed to load draw list capture %s\n", CapturePath.string().c_str() );
+		return 1;
+	}
+
+	Saturn::Ref<Saturn::DrawListReplay> Replay = Saturn::Ref<Saturn::DrawListReplay>::Create( Capture );
+
+	// The first frame grows every buffer, keep it out of the timings.
+	Replay->Run( 1 );
+
+	bool Deterministic = Replay->Run( Iterations );
+
+	printf( "%s", Replay->GetReport().c_str() );
+
+	if( count > 3 && !Replay->ExportTimings( args[ 3 ] ) )
+		fprintf( stderr, "Failed to write %s\n", args[ 3 ] );
+
+	if( !Deterministic )
+	{
+		fprintf( stderr, "Iterations built different commands!\n" );
+		return 2;
+	}
+
+	return 0;
+}
@@ -32,6 +32,7 @@
 #include "AssetManager.h"
 
 #include "Saturn/Vulkan/Renderer.h"
+#include "Saturn/Vulkan/VulkanContext.h"
 #include "Saturn/Vulkan/Mesh.h"
 #include "Saturn/Serialisation/AssetSerialisers.h"
 
@@ -48,10 +49,16 @@ namespace Saturn {
 		}
 		else
 			m_Material->Copy( material );
+
+		m_BindlessIndex = VulkanContext::Get().GetBindlessTable()->AllocateMaterial();
+		m_ValuesChanged = true;
 	}
 
 	MaterialAsset::~MaterialAsset()
 	{
+		// The table is destroyed with the device, assets that outlive it have nothing to release.
+		if( BindlessTable* pTable = VulkanContext::Get().GetBindlessTable() )
+			pTable->ReleaseMaterial( m_BindlessIndex );
 	}
 
 	void MaterialAsset::Default()
@@ -64,11 +71,22 @@ namespace Saturn {
 		m_Material->SetResource( "u_MetallicTexture", Renderer::Get().GetPinkTexture() );
 		m_Material->SetResource( "u_RoughnessTexture", Renderer::Get().GetPinkTexture() );
 
-		m_Material->Set<glm::vec3>( "u_Materials.AlbedoColor", { 1.0f, 1.0f, 1.0f } );
-		m_Material->Set<float>( "u_Materials.Metalness", 1.0f );
-		m_Material->Set<float>( "u_Materials.Roughness", 1.0f );
-		m_Material->Set<float>( "u_Materials.UseNormalMap", 0.0f );
-		m_Material->Set<float>( "u_Materials.Emissive", 0.0f );
+		m_BindlessMaterial = {};
+		m_ValuesChanged = true;
+	}
+
+	bool MaterialAsset::FindBindlessOffset( uint64_t NameHash, uint32_t& rOffset )
+	{
+		switch( NameHash )
+		{
+			case "u_Materials.AlbedoColor"_param:  rOffset = offsetof( BindlessMaterial, AlbedoColor );  return true;
+			case "u_Materials.UseNormalMap"_param: rOffset = offsetof( BindlessMaterial, UseNormalMap ); return true;
+			case "u_Materials.Metalness"_param:    rOffset = offsetof( BindlessMaterial, Metalness );    return true;
+			case "u_Materials.Roughness"_param:    rOffset = offsetof( BindlessMaterial, Roughness );    return true;
+			case "u_Materials.Emissive"_param:     rOffset = offsetof( BindlessMaterial, Emissive );     return true;
+		}
+
+		return false;
 	}
 
 	Saturn::Ref<Saturn::Texture2D> MaterialAsset::GetAlbeoMap()
@@ -93,42 +111,42 @@ namespace Saturn {
 
 	glm::vec3 MaterialAsset::GetAlbeoColor()
 	{
-		return m_Material->Get<glm::vec3>( "u_Materials.AlbedoColor" );
+		return m_BindlessMaterial.AlbedoColor;
 	}
 
 	void MaterialAsset::SetAlbeoColor( glm::vec3 color )
 	{
 		m_ValuesChanged = true;
 
-		m_Material->Set<glm::vec3>( "u_Materials.AlbedoColor", color );
+		m_BindlessMaterial.AlbedoColor = color;
 	}
 
 	void MaterialAsset::UseNormalMap( bool val )
 	{
 		m_ValuesChanged = true;
 
-		m_Material->Set<float>( "u_Materials.UseNormalMap", val );
+		m_BindlessMaterial.UseNormalMap = val ? 1.0f : 0.0f;
 	}
 
 	void MaterialAsset::SetRoughness( float val )
 	{
 		m_ValuesChanged = true;
 
-		m_Material->Set<float>( "u_Materials.Roughness", val );
+		m_BindlessMaterial.Roughness = val;
 	}
 
 	void MaterialAsset::SetMetalness( float val )
 	{
 		m_ValuesChanged = true;
 
-		m_Material->Set<float>( "u_Materials.Metalness", val );
+		m_BindlessMaterial.Metalness = val;
 	}
 
 	void MaterialAsset::SetEmissive( float val )
 	{
 		m_ValuesChanged = true;
 
-		m_Material->Set<float>( "u_Materials.Emissive", val );
+		m_BindlessMaterial.Emissive = val;
 	}
 
 	Saturn::Ref<Saturn::Texture2D> MaterialAsset::GetResource( const std::string& rName )
@@ -156,7 +174,7 @@ namespace Saturn {
 		// We don't want to default the texture because what if the user has only changed the normal map. And we'd be reseting all of the textures.
 	}
 
-	void MaterialAsset::Bind( const Ref< StaticMesh >& rMesh, Submesh& rSubmsh, Ref< Shader >& Shader, const VkWriteDescriptorSet& rStorageBufferWDS )
+	uint32_t MaterialAsset::UpdateBindless()
 	{
 		if( m_PendingMaterialChange )
 		{
@@ -165,86 +183,52 @@ namespace Saturn {
 			m_Material = m_PendingMaterialChange;
 
 			m_PendingMaterialChange = nullptr;
+
+			m_ValuesChanged = true;
 		}
 
-		for( auto& [name, texture] : m_PendingTextureChanges )
+		if( m_PendingTextureChanges.size() )
 		{
-			if( m_TextureCache[ name ].imageView == texture->GetDescriptorInfo().imageView )
+			for( auto& [name, texture] : m_PendingTextureChanges )
 			{
-				continue;
+				m_TextureCache[ name ] = texture->GetDescriptorInfo();
+				m_Material->SetResource( name, texture );
 			}
 
-			// Does not exists, add and update
-			m_TextureCache[ name ] = texture->GetDescriptorInfo();
-			m_Material->SetResource( name, texture );
+			m_PendingTextureChanges.clear();
+
+			m_ValuesChanged = true;
 		}
 
-		if( m_PendingTextureChanges.size() )
-			m_PendingTextureChanges.clear();
+		if( !m_ValuesChanged )
+			return m_BindlessIndex;
 
-		m_Material->RN_Update();
+		m_ValuesChanged = false;
 
-		uint32_t frame = Renderer::Get().GetCurrentFrame();
+		BindlessTable* pTable = VulkanContext::Get().GetBindlessTable();
 
-		VkDescriptorSet CurrentSet = m_Material->GetDescriptorSet( frame );
+		m_StreamedTextures.clear();
 
-		// Update material textures.
-		auto& textures = m_Material->GetTextures();
-		for( auto& [name, texture] : textures )
+		auto TextureSlot = [&]( const char* pName ) -> uint32_t
 		{
-			// Check if the texture even exists in the cache.
-			if( m_TextureCache.find( name ) == m_TextureCache.end() )
-			{
-				m_TextureCache[ name ] = texture->GetDescriptorInfo();
-			}
-			else
-			{
-				VkDescriptorImageInfo ImageInfo = m_TextureCache.at( name );
-
-				if( m_TextureCache.at( name ).imageView == ImageInfo.imageView || m_TextureCache.at( name ).sampler == ImageInfo.sampler )
-				{
-					// No need to update the descriptor set -- its the same.
-					continue;
-				}
-				else // If the image view has changed, update the cache.
-				{
-					m_TextureCache[ name ] = texture->GetDescriptorInfo();
-					Shader->WriteDescriptor( name, ImageInfo, m_Material->m_DescriptorSets[ frame ] );
-
-					continue;
-				}
-			}
+			Ref<Texture2D> texture = m_Material->GetResource( pName );
 
-			// Fallback, just write the descriptor.
-			VkDescriptorImageInfo ImageInfo = {};
-			ImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+			if( !texture )
+				texture = Renderer::Get().GetPinkTexture();
+			else if( texture->IsStreamed() )
+				m_StreamedTextures.push_back( texture );
 
-			if( textures[ name ] )
-			{
-				ImageInfo.imageView = textures[ name ]->GetImageView();
-				ImageInfo.sampler = textures[ name ]->GetSampler();
-			}
-			else
-			{
-				auto PinkTexture = Renderer::Get().GetPinkTexture();
+			return pTable->RegisterTexture( texture.Get() );
+		};
 
-				ImageInfo.imageView = PinkTexture->GetImageView();
-				ImageInfo.sampler = PinkTexture->GetSampler();
-			}
+		m_BindlessMaterial.AlbedoTexture    = TextureSlot( "u_AlbedoTexture" );
+		m_BindlessMaterial.NormalTexture    = TextureSlot( "u_NormalTexture" );
+		m_BindlessMaterial.MetallicTexture  = TextureSlot( "u_MetallicTexture" );
+		m_BindlessMaterial.RoughnessTexture = TextureSlot( "u_RoughnessTexture" );
 
-			Shader->WriteDescriptor( name, ImageInfo, m_Material->m_DescriptorSets[ frame ] );
-		}
+		pTable->SetMaterial( m_BindlessIndex, m_BindlessMaterial );
 
-		if( rStorageBufferWDS.dstBinding != 0 )
-		{
-			auto wds = rStorageBufferWDS;
-			m_Material->WriteDescriptor( wds );
-		}
-		
-		if( m_ValuesChanged ) 
-		{
-			m_ValuesChanged = false;
-		}
+		return m_BindlessIndex;
 	}
 
 	void MaterialAsset::Clean()
@@ -268,10 +252,13 @@ namespace Saturn {
 		for( auto&& [index, path] : m_VPendingTextureChanges )
 		{
 			auto fullPath = Project::GetActiveProject()->FilepathAbs( path );
-			texture = Ref<Texture2D>::Create( fullPath, AddressingMode::Repeat, false );
+			// Only the albedo holds colors, the other maps are filtered as data.
+			texture = Ref<Texture2D>::Create( fullPath, AddressingMode::Repeat, false, true, index == 0 );
 
 			m_Material->SetResource( IndexToTextureIndex[ index ], texture );
 		}
+
+		m_ValuesChanged = true;
 	}
 
 	void MaterialAsset::SetMaterial( const Ref<Material>& rMaterial )
@@ -279,24 +266,32 @@ namespace Saturn {
 		m_PendingMaterialChange = rMaterial;
 	}
 
+	void MaterialAsset::SetMaterial( const Ref<MaterialAsset>& rMaterialAsset )
+	{
+		m_PendingMaterialChange = rMaterialAsset->GetMaterial();
+
+		m_BindlessMaterial = rMaterialAsset->m_BindlessMaterial;
+		m_ValuesChanged = true;
+	}
+
 	float MaterialAsset::IsUsingNormalMap()
 	{
-		return m_Material->Get<float>( "u_Materials.UseNormalMap" );
+		return m_BindlessMaterial.UseNormalMap;
 	}
 
 	float MaterialAsset::GetRoughness()
 	{
-		return m_Material->Get<float>( "u_Materials.Roughness" );
+		return m_BindlessMaterial.Roughness;
 	}
 
 	float MaterialAsset::GetMetalness()
 	{
-		return m_Material->Get<float>( "u_Materials.Metalness" );
+		return m_BindlessMaterial.Metalness;
 	}
 
 	float MaterialAsset::GetEmissive()
 	{
-		return m_Material->Get<float>( "u_Materials.Emissive" );
+		return m_BindlessMaterial.Emissive;
 	}
 
 	void MaterialAsset::SetAlbeoMap( Ref<Texture2D>& rTexture )
@@ -350,6 +345,8 @@ namespace Saturn {
 
 	void MaterialAsset::ForceUpdate()
 	{
+		m_ValuesChanged = true;
+
 		for( auto& [name, texture] : m_PendingTextureChanges )
 		{
 			if( m_TextureCache[ name ].imageView == texture->GetDescriptorInfo().imageView )
@@ -363,6 +360,23 @@ namespace Saturn {
 		}
 	}
 
+	// Texture assets are streamed. Cooked textures load their mips straight out of the asset bundle, otherwise the decoded pixels build the mip tail and are freed afterwards.
+	// Uncooked HDR textures are always fully resident. SRGB is for color textures such as albedo.
+	static Ref<Texture2D> CreateTextureFromSource( const Ref<TextureSourceAsset>& rSource, bool SRGB )
+	{
+		if( rSource->IsCooked() )
+			return Ref<Texture2D>::Create( rSource->Path, rSource->GetFormat(), rSource->Width(), rSource->Height(), rSource->CreateMipLoader( SRGB ) );
+
+		if( rSource->IsHDR() )
+			return Ref<Texture2D>::Create( ImageFormat::RGBA8, rSource->Width(), rSource->Height(), rSource->TextureData().Data, false );
+
+		Ref<Texture2D> texture = Ref<Texture2D>::Create( rSource->Path, ImageFormat::RGBA8, rSource->Width(), rSource->Height(), rSource->CreateMipLoader( SRGB ), rSource->TextureData().Data, SRGB );
+
+		rSource->ReleaseTextureData();
+
+		return texture;
+	}
+
 	void MaterialAsset::SetAlbeoMap( UUID AssetID )
 	{
 		if( AssetID == 0 )
@@ -377,12 +391,7 @@ namespace Saturn {
 			Ref<TextureSourceAsset> sourceAsset = Ref<TextureSourceAsset>::Create( AssetManager::Get().FindAsset( AssetID )->Path );
 #endif
 
-			Ref<Texture2D> albedo = Ref<Texture2D>::Create(
-				ImageFormat::RGBA8,
-				sourceAsset->Width(),
-				sourceAsset->Height(),
-				sourceAsset->TextureData().Data,
-				false );
+			Ref<Texture2D> albedo = CreateTextureFromSource( sourceAsset, true );
 
 			m_PendingTextureChanges[ "u_AlbedoTexture" ] = albedo;
 		}
@@ -402,12 +411,7 @@ namespace Saturn {
 			Ref<TextureSourceAsset> sourceAsset = Ref<TextureSourceAsset>::Create( AssetManager::Get().FindAsset( AssetID )->Path );
 #endif
 
-			Ref<Texture2D> normalMap = Ref<Texture2D>::Create(
-				ImageFormat::RGBA8,
-				sourceAsset->Width(),
-				sourceAsset->Height(),
-				sourceAsset->TextureData().Data,
-				false );
+			Ref<Texture2D> normalMap = CreateTextureFromSource( sourceAsset, false );
 
 			m_PendingTextureChanges[ "u_NormalTexture" ] = normalMap;
 		}
@@ -427,12 +431,7 @@ namespace Saturn {
 			Ref<TextureSourceAsset> sourceAsset = Ref<TextureSourceAsset>::Create( AssetManager::Get().FindAsset( AssetID )->Path );
 #endif
 
-			Ref<Texture2D> metalness = Ref<Texture2D>::Create(
-				ImageFormat::RGBA8,
-				sourceAsset->Width(),
-				sourceAsset->Height(),
-				sourceAsset->TextureData().Data,
-				false );
+			Ref<Texture2D> metalness = CreateTextureFromSource( sourceAsset, false );
 
 			m_PendingTextureChanges[ "u_MetalnessTexture" ] = metalness;
 		}
@@ -452,12 +451,7 @@ namespace Saturn {
 			Ref<TextureSourceAsset> sourceAsset = Ref<TextureSourceAsset>::Create( AssetManager::Get().FindAsset( AssetID )->Path );
 #endif
 
-			Ref<Texture2D> roughness = Ref<Texture2D>::Create(
-				ImageFormat::RGBA8,
-				sourceAsset->Width(),
-				sourceAsset->Height(),
-				sourceAsset->TextureData().Data,
-				false );
+			Ref<Texture2D> roughness = CreateTextureFromSource( sourceAsset, false );
 
 			m_PendingTextureChanges[ "u_RoughnessTexture" ] = roughness;
 		}
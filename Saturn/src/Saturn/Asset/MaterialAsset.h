@@ -29,6 +29,7 @@
 #pragma once
 
 #include "Saturn/Vulkan/Material.h"
+#include "Saturn/Vulkan/BindlessTable.h"
 
 #include "Asset.h"
 
@@ -73,41 +74,82 @@ namespace Saturn {
 		Ref<Texture2D> GetResource( const std::string& rName );
 		void SetResource( const std::string& rName, const Ref<Texture2D>& rTexture );
 
+		// Handles to the "u_Materials" values point into the bindless entry, anything else is resolved by the material.
 		template<typename Ty>
-		Ty& Get( const std::string& rName ) 
+		MaterialParam<Ty> Resolve( uint64_t NameHash ) const
 		{
-			return m_Material->Get< Ty >( rName );
+			uint32_t Offset = 0;
+
+			if( FindBindlessOffset( NameHash, Offset ) )
+				return { .Storage = MaterialParamStorage::Bindless, .Index = 0, .Offset = Offset };
+
+			return m_Material->Resolve<Ty>( NameHash );
 		}
 
 		template<typename Ty>
-		void Set( const std::string& rName, const Ty& rValue )
+		Ty& Get( const MaterialParam<Ty>& rParam ) 
+		{
+			if( rParam.Storage == MaterialParamStorage::Bindless )
+				return *( Ty* ) ( ( uint8_t* ) &m_BindlessMaterial + rParam.Offset );
+
+			return m_Material->Get( rParam );
+		}
+
+		template<typename Ty>
+		void Set( const MaterialParam<Ty>& rParam, const Ty& rValue )
 		{
 			m_ValuesChanged = true;
 
-			m_Material->Set( rName, rValue );
+			if( rParam.Storage == MaterialParamStorage::Bindless )
+			{
+				memcpy( ( uint8_t* ) &m_BindlessMaterial + rParam.Offset, &rValue, sizeof( Ty ) );
+				return;
+			}
+
+			m_Material->Set( rParam, rValue );
+		}
+
+		template<typename Ty>
+		Ty& Get( const std::string& rName ) 
+		{
+			return Get( Resolve<Ty>( HashMaterialParam( rName ) ) );
+		}
+
+		template<typename Ty>
+		void Set( const std::string& rName, const Ty& rValue )
+		{
+			Set( Resolve<Ty>( HashMaterialParam( rName ) ), rValue );
 		}
 		
 		void Reset();
 
-		// Updates Uniform buffers, texture and storage buffers.
-		void Bind( const Ref< StaticMesh >& rMesh, Submesh& rSubmsh, Ref< Shader >& Shader, const VkWriteDescriptorSet& rStorageBufferWDS = VkWriteDescriptorSet{} );
+		// Applies pending changes and writes the material into the bindless table when anything has changed, returns the index to push for draws.
+		uint32_t UpdateBindless();
+
+		uint32_t GetBindlessIndex() const { return m_BindlessIndex; }
+
+		// The streamed textures of the material, gathered when it was last written into the bindless table so the renderer does not look them up by name every frame.
+		const std::vector< Ref<Texture2D> >& GetStreamedTextures() const { return m_StreamedTextures; }
 
 		void RT_Bind( const std::vector<std::vector<VkWriteDescriptorSet>>& rStorageBufferWDS = std::vector<std::vector<VkWriteDescriptorSet>>() );
 
 		void Clean();
 
-		Buffer GetPushConstantData() { return m_Material->m_PushConstantData; }
-
 		Ref<Material> GetMaterial() const { return m_Material; }
 
 		void ApplyChanges();
 		void SetMaterial( const Ref<Material>& rMaterial );
+		// Same as above but also copies the values (colors, roughness etc.) of the asset.
+		void SetMaterial( const Ref<MaterialAsset>& rMaterialAsset );
 
 		void SetName( const std::string& rName ) { return m_Material->SetName( rName ); }
 
 	private:
 		void Default();
 
+		// Material values live in the bindless entry, finds the offset of a "u_Materials" name in it.
+		static bool FindBindlessOffset( uint64_t NameHash, uint32_t& rOffset );
+
 	private:
 
 		// Used by MaterialAssetSerialiser & Material asset viewer (node editor)
@@ -129,6 +171,11 @@ namespace Saturn {
 
 		bool m_ValuesChanged = false;
 
+		BindlessMaterial m_BindlessMaterial;
+		uint32_t m_BindlessIndex = 0;
+
+		std::vector< Ref<Texture2D> > m_StreamedTextures;
+
 		std::unordered_map< std::string, VkDescriptorImageInfo > m_TextureCache;
 
 		Ref<Material> m_PendingMaterialChange = nullptr;
@@ -0,0 +1,881 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#include "sppch.h"
+#include "TextureCooker.h"
+
+#include "Saturn/Vulkan/MipGenerator.h"
+
+#include "Saturn/Core/JobSystem.h"
+#include "Saturn/Core/OptickProfiler.h"
+
+#include <algorithm>
+#include <array>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
+
+namespace Saturn {
+
+	// Block rows per job when encoding.
+	static constexpr uint32_t BlockRowsPerJob = 4;
+
+	// Albedo and generic textures hold sRGB colors, their mips are filtered in linear space.
+	static bool IsSRGB( TextureUsage Usage )
+	{
+		return Usage == TextureUsage::Albedo || Usage == TextureUsage::Generic;
+	}
+
+	// The sinc lobes can overshoot, pull every texel back into the range of its usage.
+	static void ClampTexels( FloatImage& rImage, TextureUsage Usage )
+	{
+		for( glm::vec4& rTexel : rImage.Pixels )
+		{
+			if( Usage == TextureUsage::HDR )
+			{
+				rTexel = glm::max( rTexel, glm::vec4( 0.0f ) );
+			}
+			else if( Usage == TextureUsage::Normal )
+			{
+				// Normals are filtered as vectors, not as colors.
+				glm::vec3 Normal = glm::vec3( rTexel );
+				const float Length = glm::length( Normal );
+
+				Normal = Length > 0.0f ? Normal / Length : glm::vec3( 0.0f, 0.0f, 1.0f );
+
+				rTexel = glm::vec4( Normal, glm::clamp( rTexel.w, 0.0f, 1.0f ) );
+			}
+			else
+			{
+				rTexel = glm::clamp( rTexel, glm::vec4( 0.0f ), glm::vec4( 1.0f ) );
+			}
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Block encoders, every encoder takes the 16 texels of a block in row order.
+
+	// Writes bits from the least significant bit up, the way every BC format lays out its fields.
+	struct BlockBitWriter
+	{
+		uint8_t* pBlock = nullptr;
+		uint32_t Position = 0;
+
+		void Write( uint32_t Value, uint32_t Bits )
+		{
+			for( uint32_t i = 0; i < Bits; i++, Position++ )
+			{
+				if( ( Value >> i ) & 1 )
+					pBlock[ Position >> 3 ] |= ( uint8_t ) ( 1u << ( Position & 7 ) );
+			}
+		}
+	};
+
+	// Principal axis of the texels through power iteration, the same number of iterations every time so the result is deterministic.
+	template<int N>
+	static glm::vec<N, float> PrincipalAxis( const glm::vec<N, float>* pTexels, const glm::vec<N, float>& rMean )
+	{
+		using Vec = glm::vec<N, float>;
+
+		float Covariance[ N ][ N ] = {};
+
+		for( int t = 0; t < 16; t++ )
+		{
+			const Vec Delta = pTexels[ t ] - rMean;
+
+			for( int i = 0; i < N; i++ )
+				for( int j = 0; j < N; j++ )
+					Covariance[ i ][ j ] += Delta[ i ] * Delta[ j ];
+		}
+
+		Vec Axis( 1.0f );
+
+		for( int Iteration = 0; Iteration < 8; Iteration++ )
+		{
+			Vec Next( 0.0f );
+
+			for( int i = 0; i < N; i++ )
+				for( int j = 0; j < N; j++ )
+					Next[ i ] += Covariance[ i ][ j ] * Axis[ j ];
+
+			const float Length = glm::length( Next );
+
+			if( Length < 1e-6f )
+				return Vec( 0.0f );
+
+			Axis = Next / Length;
+		}
+
+		return Axis;
+	}
+
+	// Endpoints are the texels' extent along the principal axis.
+	template<int N>
+	static void FitEndpoints( const glm::vec<N, float>* pTexels, glm::vec<N, float>& rLow, glm::vec<N, float>& rHigh )
+	{
+		using Vec = glm::vec<N, float>;
+
+		Vec Mean( 0.0f );
+
+		for( int t = 0; t < 16; t++ )
+			Mean += pTexels[ t ];
+
+		Mean /= 16.0f;
+
+		const Vec Axis = PrincipalAxis<N>( pTexels, Mean );
+
+		float Min = 0.0f;
+		float Max = 0.0f;
+
+		for( int t = 0; t < 16; t++ )
+		{
+			const float Projection = glm::dot( pTexels[ t ] - Mean, Axis );
+
+			Min = std::min( Min, Projection );
+			Max = std::max( Max, Projection );
+		}
+
+		rLow = Mean + Axis * Min;
+		rHigh = Mean + Axis * Max;
+	}
+
+	template<int N>
+	static uint32_t NearestIndex( const glm::vec<N, float>& rTexel, const glm::vec<N, float>* pPalette, uint32_t PaletteSize )
+	{
+		uint32_t Best = 0;
+		float BestError = FLT_MAX;
+
+		for( uint32_t i = 0; i < PaletteSize; i++ )
+		{
+			const glm::vec<N, float> Delta = rTexel - pPalette[ i ];
+			const float Error = glm::dot( Delta, Delta );
+
+			if( Error < BestError )
+			{
+				BestError = Error;
+				Best = i;
+			}
+		}
+
+		return Best;
+	}
+
+	static uint16_t PackRGB565( const glm::vec3& rColor )
+	{
+		const uint32_t R = ( uint32_t ) glm::clamp( std::round( rColor.r * 31.0f / 255.0f ), 0.0f, 31.0f );
+		const uint32_t G = ( uint32_t ) glm::clamp( std::round( rColor.g * 63.0f / 255.0f ), 0.0f, 63.0f );
+		const uint32_t B = ( uint32_t ) glm::clamp( std::round( rColor.b * 31.0f / 255.0f ), 0.0f, 31.0f );
+
+		return ( uint16_t ) ( ( R << 11 ) | ( G << 5 ) | B );
+	}
+
+	static glm::vec3 UnpackRGB565( uint16_t Color )
+	{
+		const uint32_t R = ( Color >> 11 ) & 31;
+		const uint32_t G = ( Color >> 5 ) & 63;
+		const uint32_t B = Color & 31;
+
+		return glm::vec3( ( R << 3 ) | ( R >> 2 ), ( G << 2 ) | ( G >> 4 ), ( B << 3 ) | ( B >> 2 ) );
+	}
+
+	// Texels are 0-255, always uses the four color mode so it is also the color half of BC3.
+	static void EncodeBC1( const glm::vec3* pTexels, uint8_t* pBlock )
+	{
+		glm::vec3 Low, High;
+		FitEndpoints<3>( pTexels, Low, High );
+
+		// Inset the endpoints a little, the extremes are rarely worth a palette entry.
+		const glm::vec3 Inset = ( High - Low ) / 16.0f;
+		Low += Inset;
+		High -= Inset;
+
+		uint16_t Color0 = PackRGB565( High );
+		uint16_t Color1 = PackRGB565( Low );
+
+		if( Color0 < Color1 )
+			std::swap( Color0, Color1 );
+
+		uint32_t Indices = 0;
+
+		if( Color0 != Color1 )
+		{
+			const glm::vec3 Endpoint0 = UnpackRGB565( Color0 );
+			const glm::vec3 Endpoint1 = UnpackRGB565( Color1 );
+
+			const glm::vec3 Palette[ 4 ] = { Endpoint0, Endpoint1, ( Endpoint0 * 2.0f + Endpoint1 ) / 3.0f, ( Endpoint0 + Endpoint1 * 2.0f ) / 3.0f };
+
+			for( uint32_t t = 0; t < 16; t++ )
+				Indices |= NearestIndex<3>( pTexels[ t ], Palette, 4 ) << ( t * 2 );
+		}
+
+		memcpy( pBlock, &Color0, 2 );
+		memcpy( pBlock + 2, &Color1, 2 );
+		memcpy( pBlock + 4, &Indices, 4 );
+	}
+
+	// Values are 0-255, always uses the eight value mode.
+	static void EncodeBC4( const float* pValues, uint8_t* pBlock )
+	{
+		float Min = pValues[ 0 ];
+		float Max = pValues[ 0 ];
+
+		for( uint32_t t = 1; t < 16; t++ )
+		{
+			Min = std::min( Min, pValues[ t ] );
+			Max = std::max( Max, pValues[ t ] );
+		}
+
+		const uint32_t Endpoint0 = ( uint32_t ) glm::clamp( std::round( Max ), 0.0f, 255.0f );
+		const uint32_t Endpoint1 = ( uint32_t ) glm::clamp( std::round( Min ), 0.0f, 255.0f );
+
+		pBlock[ 0 ] = ( uint8_t ) Endpoint0;
+		pBlock[ 1 ] = ( uint8_t ) Endpoint1;
+
+		uint64_t Indices = 0;
+
+		if( Endpoint0 != Endpoint1 )
+		{
+			float Palette[ 8 ] = { ( float ) Endpoint0, ( float ) Endpoint1 };
+
+			for( uint32_t i = 1; i < 7; i++ )
+				Palette[ i + 1 ] = ( float ) ( ( 7 - i ) * Endpoint0 + i * Endpoint1 ) / 7.0f;
+
+			for( uint32_t t = 0; t < 16; t++ )
+			{
+				uint64_t Best = 0;
+
+				for( uint32_t i = 1; i < 8; i++ )
+				{
+					if( std::abs( pValues[ t ] - Palette[ i ] ) < std::abs( pValues[ t ] - Palette[ Best ] ) )
+						Best = i;
+				}
+
+				Indices |= Best << ( t * 3 );
+			}
+		}
+
+		for( uint32_t i = 0; i < 6; i++ )
+			pBlock[ 2 + i ] = ( uint8_t ) ( Indices >> ( i * 8 ) );
+	}
+
+	static constexpr uint32_t FourBitWeights[ 16 ] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	// Texels are 0-255, mode 6 only: one subset, 7 bit RGBA endpoints with a p-bit each and 4 bit indices.
+	static void EncodeBC7( const glm::vec4* pTexels, uint8_t* pBlock )
+	{
+		glm::vec4 Low, High;
+		FitEndpoints<4>( pTexels, Low, High );
+
+		glm::vec4 Endpoints[ 2 ] = { glm::clamp( Low, 0.0f, 255.0f ), glm::clamp( High, 0.0f, 255.0f ) };
+
+		glm::uvec4 Quantised[ 2 ];
+		uint32_t PBits[ 2 ];
+		glm::vec4 Reconstructed[ 2 ];
+
+		// The p-bit is the shared lowest bit of every channel, keep whichever one is closer.
+		for( int e = 0; e < 2; e++ )
+		{
+			float BestError = FLT_MAX;
+
+			for( uint32_t p = 0; p < 2; p++ )
+			{
+				const glm::vec4 Value = glm::clamp( glm::round( ( Endpoints[ e ] - ( float ) p ) * 0.5f ), 0.0f, 127.0f );
+				const glm::vec4 Reconstruction = Value * 2.0f + ( float ) p;
+
+				const glm::vec4 Delta = Reconstruction - Endpoints[ e ];
+				const float Error = glm::dot( Delta, Delta );
+
+				if( Error < BestError )
+				{
+					BestError = Error;
+					Quantised[ e ] = glm::uvec4( Value );
+					PBits[ e ] = p;
+					Reconstructed[ e ] = Reconstruction;
+				}
+			}
+		}
+
+		glm::vec4 Palette[ 16 ];
+
+		for( uint32_t i = 0; i < 16; i++ )
+		{
+			const glm::uvec4 A = glm::uvec4( Reconstructed[ 0 ] );
+			const glm::uvec4 B = glm::uvec4( Reconstructed[ 1 ] );
+
+			Palette[ i ] = glm::vec4( ( A * ( 64u - FourBitWeights[ i ] ) + B * FourBitWeights[ i ] + 32u ) >> 6u );
+		}
+
+		uint32_t Indices[ 16 ];
+
+		for( uint32_t t = 0; t < 16; t++ )
+			Indices[ t ] = NearestIndex<4>( pTexels[ t ], Palette, 16 );
+
+		// The first index is stored without its top bit, swap the endpoints when it would be set.
+		if( Indices[ 0 ] & 8 )
+		{
+			std::swap( Quantised[ 0 ], Quantised[ 1 ] );
+			std::swap( PBits[ 0 ], PBits[ 1 ] );
+
+			for( uint32_t& rIndex : Indices )
+				rIndex = 15 - rIndex;
+		}
+
+		memset( pBlock, 0, 16 );
+
+		BlockBitWriter Writer{ pBlock };
+		Writer.Write( 1u << 6, 7 );
+
+		for( int Channel = 0; Channel < 4; Channel++ )
+		{
+			Writer.Write( Quantised[ 0 ][ Channel ], 7 );
+			Writer.Write( Quantised[ 1 ][ Channel ], 7 );
+		}
+
+		Writer.Write( PBits[ 0 ], 1 );
+		Writer.Write( PBits[ 1 ], 1 );
+
+		Writer.Write( Indices[ 0 ], 3 );
+
+		for( uint32_t t = 1; t < 16; t++ )
+			Writer.Write( Indices[ t ], 4 );
+	}
+
+	// BC6H interpolates the half float bit patterns scaled by 64 / 31, fitting happens in that space.
+	static float HalfToBC6HSpace( float Value )
+	{
+		const uint16_t Half = glm::packHalf1x16( glm::clamp( Value, 0.0f, 65504.0f ) );
+
+		return ( float ) Half * 64.0f / 31.0f;
+	}
+
+	static uint32_t UnquantiseBC6H( uint32_t Value )
+	{
+		if( Value == 0 )
+			return 0;
+
+		if( Value == 1023 )
+			return 0xFFFF;
+
+		return ( ( Value << 16 ) + 0x8000 ) >> 10;
+	}
+
+	// Texels are linear floats, mode 11 only: one region, 10 bit endpoints without deltas and 4 bit indices.
+	static void EncodeBC6H( const glm::vec3* pTexels, uint8_t* pBlock )
+	{
+		glm::vec3 Texels[ 16 ];
+
+		for( uint32_t t = 0; t < 16; t++ )
+			Texels[ t ] = glm::vec3( HalfToBC6HSpace( pTexels[ t ].r ), HalfToBC6HSpace( pTexels[ t ].g ), HalfToBC6HSpace( pTexels[ t ].b ) );
+
+		glm::vec3 Low, High;
+		FitEndpoints<3>( Texels, Low, High );
+
+		glm::uvec3 Quantised[ 2 ];
+		glm::uvec3 Unquantised[ 2 ];
+
+		const glm::vec3 Endpoints[ 2 ] = { Low, High };
+
+		for( int e = 0; e < 2; e++ )
+		{
+			for( int Channel = 0; Channel < 3; Channel++ )
+			{
+				Quantised[ e ][ Channel ] = ( uint32_t ) glm::clamp( std::round( ( Endpoints[ e ][ Channel ] - 32.0f ) / 64.0f ), 0.0f, 1023.0f );
+				Unquantised[ e ][ Channel ] = UnquantiseBC6H( Quantised[ e ][ Channel ] );
+			}
+		}
+
+		glm::vec3 Palette[ 16 ];
+
+		for( uint32_t i = 0; i < 16; i++ )
+			Palette[ i ] = glm::vec3( ( Unquantised[ 0 ] * ( 64u - FourBitWeights[ i ] ) + Unquantised[ 1 ] * FourBitWeights[ i ] + 32u ) >> 6u );
+
+		uint32_t Indices[ 16 ];
+
+		for( uint32_t t = 0; t < 16; t++ )
+			Indices[ t ] = NearestIndex<3>( Texels[ t ], Palette, 16 );
+
+		if( Indices[ 0 ] & 8 )
+		{
+			std::swap( Quantised[ 0 ], Quantised[ 1 ] );
+
+			for( uint32_t& rIndex : Indices )
+				rIndex = 15 - rIndex;
+		}
+
+		memset( pBlock, 0, 16 );
+
+		BlockBitWriter Writer{ pBlock };
+		Writer.Write( 0x03, 5 );
+
+		for( int e = 0; e < 2; e++ )
+		{
+			for( int Channel = 0; Channel < 3; Channel++ )
+				Writer.Write( Quantised[ e ][ Channel ], 10 );
+		}
+
+		Writer.Write( Indices[ 0 ], 3 );
+
+		for( uint32_t t = 1; t < 16; t++ )
+			Writer.Write( Indices[ t ], 4 );
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Block decoders, only used to measure the error of the encoders.
+
+	struct BlockBitReader
+	{
+		const uint8_t* pBlock = nullptr;
+		uint32_t Position = 0;
+
+		uint32_t Read( uint32_t Bits )
+		{
+			uint32_t Value = 0;
+
+			for( uint32_t i = 0; i < Bits; i++, Position++ )
+				Value |= ( uint32_t ) ( ( pBlock[ Position >> 3 ] >> ( Position & 7 ) ) & 1 ) << i;
+
+			return Value;
+		}
+	};
+
+	static void DecodeBC1( const uint8_t* pBlock, glm::vec4* pTexels )
+	{
+		uint16_t Color0, Color1;
+		uint32_t Indices;
+
+		memcpy( &Color0, pBlock, 2 );
+		memcpy( &Color1, pBlock + 2, 2 );
+		memcpy( &Indices, pBlock + 4, 4 );
+
+		const glm::vec3 Endpoint0 = UnpackRGB565( Color0 );
+		const glm::vec3 Endpoint1 = UnpackRGB565( Color1 );
+
+		glm::vec4 Palette[ 4 ] = { glm::vec4( Endpoint0, 255.0f ), glm::vec4( Endpoint1, 255.0f ) };
+
+		if( Color0 > Color1 )
+		{
+			Palette[ 2 ] = glm::vec4( ( Endpoint0 * 2.0f + Endpoint1 ) / 3.0f, 255.0f );
+			Palette[ 3 ] = glm::vec4( ( Endpoint0 + Endpoint1 * 2.0f ) / 3.0f, 255.0f );
+		}
+		else
+		{
+			Palette[ 2 ] = glm::vec4( ( Endpoint0 + Endpoint1 ) / 2.0f, 255.0f );
+			Palette[ 3 ] = glm::vec4( 0.0f );
+		}
+
+		for( uint32_t t = 0; t < 16; t++ )
+			pTexels[ t ] = Palette[ ( Indices >> ( t * 2 ) ) & 3 ];
+	}
+
+	static void DecodeBC4( const uint8_t* pBlock, float* pValues )
+	{
+		const uint32_t Endpoint0 = pBlock[ 0 ];
+		const uint32_t Endpoint1 = pBlock[ 1 ];
+
+		float Palette[ 8 ] = { ( float ) Endpoint0, ( float ) Endpoint1 };
+
+		if( Endpoint0 > Endpoint1 )
+		{
+			for( uint32_t i = 1; i < 7; i++ )
+				Palette[ i + 1 ] = ( float ) ( ( 7 - i ) * Endpoint0 + i * Endpoint1 ) / 7.0f;
+		}
+		else
+		{
+			for( uint32_t i = 1; i < 5; i++ )
+				Palette[ i + 1 ] = ( float ) ( ( 5 - i ) * Endpoint0 + i * Endpoint1 ) / 5.0f;
+
+			Palette[ 6 ] = 0.0f;
+			Palette[ 7 ] = 255.0f;
+		}
+
+		uint64_t Indices = 0;
+
+		for( uint32_t i = 0; i < 6; i++ )
+			Indices |= ( uint64_t ) pBlock[ 2 + i ] << ( i * 8 );
+
+		for( uint32_t t = 0; t < 16; t++ )
+			pValues[ t ] = Palette[ ( Indices >> ( t * 3 ) ) & 7 ];
+	}
+
+	// Mode 6 only, blocks in any other mode decode to zero.
+	static void DecodeBC7( const uint8_t* pBlock, glm::vec4* pTexels )
+	{
+		BlockBitReader Reader{ pBlock };
+
+		if( Reader.Read( 7 ) != ( 1u << 6 ) )
+		{
+			for( uint32_t t = 0; t < 16; t++ )
+				pTexels[ t ] = glm::vec4( 0.0f );
+
+			return;
+		}
+
+		glm::uvec4 Endpoints[ 2 ];
+
+		for( int Channel = 0; Channel < 4; Channel++ )
+		{
+			Endpoints[ 0 ][ Channel ] = Reader.Read( 7 ) << 1;
+			Endpoints[ 1 ][ Channel ] = Reader.Read( 7 ) << 1;
+		}
+
+		Endpoints[ 0 ] |= glm::uvec4( Reader.Read( 1 ) );
+		Endpoints[ 1 ] |= glm::uvec4( Reader.Read( 1 ) );
+
+		for( uint32_t t = 0; t < 16; t++ )
+		{
+			const uint32_t Weight = FourBitWeights[ Reader.Read( t == 0 ? 3 : 4 ) ];
+
+			pTexels[ t ] = glm::vec4( ( Endpoints[ 0 ] * ( 64u - Weight ) + Endpoints[ 1 ] * Weight + 32u ) >> 6u );
+		}
+	}
+
+	// Mode 11 only, blocks in any other mode decode to zero.
+	static void DecodeBC6H( const uint8_t* pBlock, glm::vec4* pTexels )
+	{
+		BlockBitReader Reader{ pBlock };
+
+		if( Reader.Read( 5 ) != 0x03 )
+		{
+			for( uint32_t t = 0; t < 16; t++ )
+				pTexels[ t ] = glm::vec4( 0.0f );
+
+			return;
+		}
+
+		glm::uvec3 Endpoints[ 2 ];
+
+		for( int e = 0; e < 2; e++ )
+		{
+			for( int Channel = 0; Channel < 3; Channel++ )
+				Endpoints[ e ][ Channel ] = UnquantiseBC6H( Reader.Read( 10 ) );
+		}
+
+		for( uint32_t t = 0; t < 16; t++ )
+		{
+			const uint32_t Weight = FourBitWeights[ Reader.Read( t == 0 ? 3 : 4 ) ];
+			const glm::uvec3 Value = ( Endpoints[ 0 ] * ( 64u - Weight ) + Endpoints[ 1 ] * Weight + 32u ) >> 6u;
+
+			// Undo the 64 / 31 scale to get back to the half float bit pattern.
+			for( int Channel = 0; Channel < 3; Channel++ )
+				pTexels[ t ][ Channel ] = glm::unpackHalf1x16( ( uint16_t ) ( ( Value[ Channel ] * 31 ) >> 6 ) );
+
+			pTexels[ t ].a = 1.0f;
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	static Buffer EncodeMip( const FloatImage& rImage, ImageFormat Format, TextureUsage Usage )
+	{
+		SAT_PF_EVENT();
+
+		const uint32_t BlocksX = ( rImage.Width + 3 ) / 4;
+		const uint32_t BlocksY = ( rImage.Height + 3 ) / 4;
+		const uint32_t BlockSize = TextureCooker::GetBlockSize( Format );
+
+		Buffer Result;
+		Result.Allocate( ( size_t ) BlocksX * BlocksY * BlockSize );
+
+		JobSystem::Get().ParallelFor( BlocksY, BlockRowsPerJob, [&]( uint32_t Begin, uint32_t End )
+			{
+				glm::vec4 Texels[ 16 ];
+
+				for( uint32_t by = Begin; by < End; by++ )
+				{
+					for( uint32_t bx = 0; bx < BlocksX; bx++ )
+					{
+						// Blocks that hang over the edge repeat the last row and column, those texels are never sampled.
+						for( uint32_t t = 0; t < 16; t++ )
+						{
+							const uint32_t x = std::min( bx * 4 + t % 4, rImage.Width - 1 );
+							const uint32_t y = std::min( by * 4 + t / 4, rImage.Height - 1 );
+
+							Texels[ t ] = rImage.At( x, y );
+						}
+
+						uint8_t* pBlock = Result.Data + ( ( size_t ) by * BlocksX + bx ) * BlockSize;
+
+						if( Format == ImageFormat::BC6H )
+						{
+							glm::vec3 Colors[ 16 ];
+
+							for( uint32_t t = 0; t < 16; t++ )
+								Colors[ t ] = glm::vec3( Texels[ t ] );
+
+							EncodeBC6H( Colors, pBlock );
+							continue;
+						}
+
+						// Everything else is encoded from 8 bit values, normals are stored as 0-1.
+						for( glm::vec4& rTexel : Texels )
+						{
+							if( Usage == TextureUsage::Normal )
+								rTexel = glm::vec4( glm::vec3( rTexel ) * 0.5f + 0.5f, rTexel.w );
+							else if( IsSRGB( Usage ) )
+								rTexel = glm::vec4( MipGenerator::LinearToSRGB( rTexel.r ), MipGenerator::LinearToSRGB( rTexel.g ), MipGenerator::LinearToSRGB( rTexel.b ), rTexel.a );
+
+							rTexel = glm::round( rTexel * 255.0f );
+						}
+
+						switch( Format )
+						{
+							case ImageFormat::BC1:
+							case ImageFormat::BC3:
+							{
+								glm::vec3 Colors[ 16 ];
+
+								for( uint32_t t = 0; t < 16; t++ )
+									Colors[ t ] = glm::vec3( Texels[ t ] );
+
+								if( Format == ImageFormat::BC3 )
+								{
+									float Alpha[ 16 ];
+
+									for( uint32_t t = 0; t < 16; t++ )
+										Alpha[ t ] = Texels[ t ].a;
+
+									EncodeBC4( Alpha, pBlock );
+									pBlock += 8;
+								}
+
+								EncodeBC1( Colors, pBlock );
+							} break;
+
+							case ImageFormat::BC4:
+							case ImageFormat::BC5:
+							{
+								float Red[ 16 ];
+								float Green[ 16 ];
+
+								for( uint32_t t = 0; t < 16; t++ )
+								{
+									Red[ t ] = Texels[ t ].r;
+									Green[ t ] = Texels[ t ].g;
+								}
+
+								EncodeBC4( Red, pBlock );
+
+								if( Format == ImageFormat::BC5 )
+									EncodeBC4( Green, pBlock + 8 );
+							} break;
+
+							case ImageFormat::BC7:
+								EncodeBC7( Texels, pBlock );
+								break;
+
+							default:
+								break;
+						}
+					}
+				}
+			} );
+
+		return Result;
+	}
+
+	void CookedTexture::Free()
+	{
+		for( Buffer& rMip : Mips )
+			rMip.Free();
+
+		Mips.clear();
+	}
+
+	CookedTexture TextureCooker::Cook( const void* pPixels, uint32_t Width, uint32_t Height, bool HDR, TextureUsage Usage )
+	{
+		SAT_PF_EVENT();
+
+		if( HDR )
+			Usage = TextureUsage::HDR;
+
+		FloatImage Image;
+		bool HasAlpha = false;
+
+		if( HDR )
+		{
+			Image.Width = Width;
+			Image.Height = Height;
+			Image.Pixels.resize( ( size_t ) Width * Height );
+
+			memcpy( Image.Pixels.data(), pPixels, Image.Pixels.size() * sizeof( glm::vec4 ) );
+		}
+		else
+		{
+			const uint8_t* pBytes = ( const uint8_t* ) pPixels;
+
+			for( size_t i = 0; i < ( size_t ) Width * Height && !HasAlpha; i++ )
+				HasAlpha = pBytes[ i * 4 + 3 ] != 255;
+
+			Image = MipGenerator::FromRGBA8( pBytes, Width, Height, IsSRGB( Usage ) );
+
+			if( Usage == TextureUsage::Normal )
+			{
+				for( glm::vec4& rTexel : Image.Pixels )
+					rTexel = glm::vec4( glm::vec3( rTexel ) * 2.0f - 1.0f, rTexel.w );
+
+				ClampTexels( Image, Usage );
+			}
+		}
+
+		CookedTexture Result;
+		Result.Format = GetFormat( Usage, HasAlpha );
+		Result.Width = Width;
+		Result.Height = Height;
+
+		const uint32_t MipCount = MipGenerator::GetMipCount( Width, Height );
+
+		Result.Mips.push_back( EncodeMip( Image, Result.Format, Usage ) );
+
+		// Every mip is filtered from the one before it.
+		for( uint32_t Mip = 1; Mip < MipCount; Mip++ )
+		{
+			Image = MipGenerator::Resample( Image, MipGenerator::GetMipExtent( Width, Mip ), MipGenerator::GetMipExtent( Height, Mip ), MipFilter::Kaiser );
+			ClampTexels( Image, Usage );
+
+			Result.Mips.push_back( EncodeMip( Image, Result.Format, Usage ) );
+		}
+
+		return Result;
+	}
+
+	void TextureCooker::DecodeBlock( ImageFormat Format, const uint8_t* pBlock, glm::vec4* pTexels )
+	{
+		switch( Format )
+		{
+			case ImageFormat::BC1:
+				DecodeBC1( pBlock, pTexels );
+				break;
+
+			case ImageFormat::BC3:
+			{
+				float Alpha[ 16 ];
+
+				DecodeBC4( pBlock, Alpha );
+				DecodeBC1( pBlock + 8, pTexels );
+
+				for( uint32_t t = 0; t < 16; t++ )
+					pTexels[ t ].a = Alpha[ t ];
+			} break;
+
+			case ImageFormat::BC4:
+			case ImageFormat::BC5:
+			{
+				float Red[ 16 ];
+				float Green[ 16 ] = {};
+
+				DecodeBC4( pBlock, Red );
+
+				if( Format == ImageFormat::BC5 )
+					DecodeBC4( pBlock + 8, Green );
+
+				for( uint32_t t = 0; t < 16; t++ )
+					pTexels[ t ] = glm::vec4( Red[ t ], Green[ t ], 0.0f, 255.0f );
+			} break;
+
+			case ImageFormat::BC6H:
+				DecodeBC6H( pBlock, pTexels );
+				break;
+
+			case ImageFormat::BC7:
+				DecodeBC7( pBlock, pTexels );
+				break;
+
+			default:
+				break;
+		}
+	}
+
+	ImageFormat TextureCooker::GetFormat( TextureUsage Usage, bool HasAlpha )
+	{
+		switch( Usage )
+		{
+			case TextureUsage::Albedo:
+				return ImageFormat::BC7;
+			case TextureUsage::Normal:
+				return ImageFormat::BC5;
+			case TextureUsage::Mask:
+				return ImageFormat::BC4;
+			case TextureUsage::HDR:
+				return ImageFormat::BC6H;
+
+			case TextureUsage::Generic:
+			default:
+				return HasAlpha ? ImageFormat::BC3 : ImageFormat::BC1;
+		}
+	}
+
+	uint32_t TextureCooker::GetBlockSize( ImageFormat Format )
+	{
+		switch( Format )
+		{
+			case ImageFormat::BC1:
+			case ImageFormat::BC4:
+				return 8;
+
+			case ImageFormat::BC3:
+			case ImageFormat::BC5:
+			case ImageFormat::BC6H:
+			case ImageFormat::BC7:
+				return 16;
+
+			default:
+				return 0;
+		}
+	}
+
+	const char* TextureCooker::UsageToString( TextureUsage Usage )
+	{
+		switch( Usage )
+		{
+			case TextureUsage::Generic: return "Generic";
+			case TextureUsage::Albedo: return "Albedo";
+			case TextureUsage::Normal: return "Normal";
+			case TextureUsage::Mask: return "Mask";
+			case TextureUsage::HDR: return "HDR";
+		}
+
+		return "Unknown";
+	}
+
+	const char* TextureCooker::FormatToString( ImageFormat Format )
+	{
+		switch( Format )
+		{
+			case ImageFormat::BC1: return "BC1";
+			case ImageFormat::BC3: return "BC3";
+			case ImageFormat::BC4: return "BC4";
+			case ImageFormat::BC5: return "BC5";
+			case ImageFormat::BC6H: return "BC6H";
+			case ImageFormat::BC7: return "BC7";
+			default: return "Uncompressed";
+		}
+	}
+}
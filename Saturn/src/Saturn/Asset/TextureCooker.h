@@ -0,0 +1,85 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#pragma once
+
+#include "Saturn/Core/Memory/Buffer.h"
+#include "Saturn/Vulkan/Image2D.h"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <cstdint>
+
+namespace Saturn {
+
+	// How a texture is sampled, picks the block compressed format it is cooked to.
+	enum class TextureUsage : uint8_t
+	{
+		Generic, // BC1, or BC3 when the texture has alpha.
+		Albedo,  // BC7
+		Normal,  // BC5, only X and Y are stored and the shader rebuilds Z.
+		Mask,    // BC4, single channel maps (metallic, roughness).
+		HDR      // BC6H, HDR textures always use this.
+	};
+
+	struct CookedTexture
+	{
+		ImageFormat Format = ImageFormat::None;
+
+		uint32_t Width = 0;
+		uint32_t Height = 0;
+
+		// The whole mip chain, mip 0 first, every mip holds its 4x4 blocks row by row.
+		std::vector<Buffer> Mips;
+
+		void Free();
+	};
+
+	// CPU only texture cooking for the asset bundle, does not touch any GPU resources so it can run headless.
+	// Builds the mip chain with a Kaiser filter and encodes every mip to a block compressed format that the runtime uploads as is.
+	// Blocks are encoded in parallel on the job system, every block only depends on its own texels so the output is the same no matter how the work is split.
+	class TextureCooker
+	{
+	public:
+		// pPixels is RGBA8, or RGBA32F when HDR is set.
+		static CookedTexture Cook( const void* pPixels, uint32_t Width, uint32_t Height, bool HDR, TextureUsage Usage );
+
+		static ImageFormat GetFormat( TextureUsage Usage, bool HasAlpha );
+
+		// Bytes per 4x4 block.
+		static uint32_t GetBlockSize( ImageFormat Format );
+
+		// Decodes one block written by Cook into 16 texels in row order, used to measure the error of the encoders.
+		// Only knows the modes the encoders write (BC7 mode 6, BC6H mode 11). Texels are 0-255, or linear floats for BC6H.
+		static void DecodeBlock( ImageFormat Format, const uint8_t* pBlock, glm::vec4* pTexels );
+
+		static const char* UsageToString( TextureUsage Usage );
+		static const char* FormatToString( ImageFormat Format );
+	};
+}
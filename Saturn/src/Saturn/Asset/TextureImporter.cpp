@@ -0,0 +1,260 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#include "sppch.h"
+#include "TextureImporter.h"
+
+#include "Saturn/Serialisation/ImageFileAux.h"
+
+#include "Saturn/Core/JobSystem.h"
+#include "Saturn/Core/OptickProfiler.h"
+#include "Saturn/Core/Timer.h"
+
+#include <stb_image.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+namespace Saturn {
+
+	static bool IsPowerOfTwo( uint32_t Value )
+	{
+		return Value != 0 && ( Value & ( Value - 1 ) ) == 0;
+	}
+
+	static uint32_t NearestPowerOfTwo( uint32_t Value )
+	{
+		return 1u << ( uint32_t ) std::round( std::log2( ( float ) Value ) );
+	}
+
+	void DecodedImage::Free()
+	{
+		if( pPixels )
+			stbi_image_free( pPixels );
+
+		pPixels = nullptr;
+	}
+
+	DecodedImage TextureImporter::Decode( const std::filesystem::path& rPath, bool Flip )
+	{
+		SAT_PF_EVENT();
+
+		const std::string Path = rPath.string();
+
+		// The flip flag is global in stb_image, other threads may be loading at the same time.
+		stbi_set_flip_vertically_on_load_thread( Flip );
+
+		DecodedImage Image;
+		Image.HDR = stbi_is_hdr( Path.c_str() );
+
+		int Width, Height, Channels;
+
+		if( Image.HDR )
+			Image.pPixels = stbi_loadf( Path.c_str(), &Width, &Height, &Channels, 4 );
+		else
+			Image.pPixels = stbi_load( Path.c_str(), &Width, &Height, &Channels, 4 );
+
+		if( !Image.pPixels )
+		{
+			SAT_CORE_WARN( "Failed to decode texture {0}: {1}", Path, stbi_failure_reason() );
+			return Image;
+		}
+
+		Image.Width = ( uint32_t ) Width;
+		Image.Height = ( uint32_t ) Height;
+
+		return Image;
+	}
+
+	std::vector<TextureImportResult> TextureImporter::Import( const std::vector<std::filesystem::path>& rPaths, const std::filesystem::path& rDestination, const TextureImportSettings& rSettings )
+	{
+		SAT_PF_EVENT();
+
+		Timer timer;
+
+		std::vector<TextureImportResult> Results( rPaths.size() );
+
+		// Files with the same stem would be written to the same file (resizing changes the extension) and get the same asset name, only the first one is imported.
+		// This has to happen before the jobs start, otherwise two jobs could write the same destination at once.
+		std::vector<uint32_t> Jobs;
+		std::unordered_map<std::string, uint32_t> Stems;
+
+		for( uint32_t i = 0; i < ( uint32_t ) rPaths.size(); i++ )
+		{
+			Results[ i ].Source = rPaths[ i ];
+
+			std::string Stem = rPaths[ i ].stem().string();
+			std::transform( Stem.begin(), Stem.end(), Stem.begin(), []( unsigned char c ) { return ( char ) std::tolower( c ); } );
+
+			auto [Itr, Inserted] = Stems.emplace( Stem, i );
+
+			if( !Inserted )
+			{
+				SAT_CORE_WARN( "Skipping {0}, {1} is imported under the same name", rPaths[ i ].string(), rPaths[ Itr->second ].string() );
+				continue;
+			}
+
+			Jobs.push_back( i );
+		}
+
+		// One file per batch, decoding is most of the work and files vary a lot in size.
+		JobSystem::Get().ParallelFor( ( uint32_t ) Jobs.size(), 1, [&]( uint32_t Begin, uint32_t End )
+			{
+				for( uint32_t i = Begin; i < End; i++ )
+					Results[ Jobs[ i ] ] = ImportFile( rPaths[ Jobs[ i ] ], rDestination, rSettings );
+			} );
+
+		const size_t Imported = std::count_if( Results.begin(), Results.end(), []( const TextureImportResult& rResult ) { return rResult.Imported; } );
+
+		SAT_CORE_INFO( "Imported {0} of {1} textures in {2}ms", Imported, rPaths.size(), timer.Elapsed() );
+
+		return Results;
+	}
+
+	TextureImportResult TextureImporter::ImportFile( const std::filesystem::path& rPath, const std::filesystem::path& rDestination, const TextureImportSettings& rSettings )
+	{
+		SAT_PF_EVENT();
+
+		TextureImportResult Result;
+		Result.Source = rPath;
+		Result.Destination = rDestination / rPath.filename();
+
+		// Only reads the header, files that do not need resizing are copied as they are.
+		int Width, Height, Channels;
+		if( !stbi_info( rPath.string().c_str(), &Width, &Height, &Channels ) )
+		{
+			SAT_CORE_WARN( "Skipping {0}, it is not a texture stb_image can decode", rPath.string() );
+			return Result;
+		}
+
+		std::error_code Error;
+
+		if( !rSettings.ResizeToPowerOfTwo || ( IsPowerOfTwo( Width ) && IsPowerOfTwo( Height ) ) )
+		{
+			if( rPath != Result.Destination )
+				std::filesystem::copy_file( rPath, Result.Destination, std::filesystem::copy_options::overwrite_existing, Error );
+
+			if( Error )
+				SAT_CORE_WARN( "Failed to copy {0}: {1}", rPath.string(), Error.message() );
+
+			Result.Imported = !Error;
+			return Result;
+		}
+
+		DecodedImage Image = Decode( rPath, false );
+
+		if( !Image )
+			return Result;
+
+		const uint32_t NewWidth = NearestPowerOfTwo( Image.Width );
+		const uint32_t NewHeight = NearestPowerOfTwo( Image.Height );
+
+		FloatImage Source;
+
+		if( Image.HDR )
+		{
+			Source.Width = Image.Width;
+			Source.Height = Image.Height;
+			Source.Pixels.resize( ( size_t ) Image.Width * Image.Height );
+
+			memcpy( Source.Pixels.data(), Image.pPixels, Source.Pixels.size() * sizeof( glm::vec4 ) );
+		}
+		else
+		{
+			Source = MipGenerator::FromRGBA8( ( const uint8_t* ) Image.pPixels, Image.Width, Image.Height, rSettings.SRGB );
+		}
+
+		Image.Free();
+
+		FloatImage Resized = MipGenerator::Resample( Source, NewWidth, NewHeight, rSettings.ResizeFilter );
+
+		if( Image.HDR )
+		{
+			// The sinc lobes can ring below zero.
+			for( glm::vec4& rTexel : Resized.Pixels )
+				rTexel = glm::max( rTexel, glm::vec4( 0.0f ) );
+
+			Result.Destination.replace_extension( ".hdr" );
+
+			Auxiliary::WriteImageFile( Result.Destination, Auxiliary::ImageFileType::HDR, NewWidth, NewHeight, 4, Resized.Pixels.data(), 0, false );
+		}
+		else
+		{
+			std::vector<uint8_t> Pixels( Resized.Pixels.size() * 4 );
+			MipGenerator::ToRGBA8( Resized, rSettings.SRGB, Pixels.data() );
+
+			Result.Destination.replace_extension( ".png" );
+
+			Auxiliary::WriteImageFile( Result.Destination, Auxiliary::ImageFileType::PNG, NewWidth, NewHeight, 4, Pixels.data(), NewWidth * 4, false );
+		}
+
+		SAT_CORE_INFO( "Resized {0} from {1}x{2} to {3}x{4}", rPath.string(), Image.Width, Image.Height, NewWidth, NewHeight );
+
+		Result.Imported = std::filesystem::exists( Result.Destination );
+		Result.Resized = true;
+
+		return Result;
+	}
+
+	std::vector<std::filesystem::path> TextureImporter::FindTextures( const std::filesystem::path& rDirectory, bool Recursive )
+	{
+		std::vector<std::filesystem::path> Paths;
+
+		auto Add = [&]( const std::filesystem::directory_entry& rEntry )
+		{
+			if( rEntry.is_regular_file() && IsTextureFile( rEntry.path() ) )
+				Paths.push_back( rEntry.path() );
+		};
+
+		if( Recursive )
+		{
+			for( const auto& rEntry : std::filesystem::recursive_directory_iterator( rDirectory ) )
+				Add( rEntry );
+		}
+		else
+		{
+			for( const auto& rEntry : std::filesystem::directory_iterator( rDirectory ) )
+				Add( rEntry );
+		}
+
+		// Directory order is not defined, keep imports reproducible.
+		std::sort( Paths.begin(), Paths.end() );
+
+		return Paths;
+	}
+
+	bool TextureImporter::IsTextureFile( const std::filesystem::path& rPath )
+	{
+		std::string Extension = rPath.extension().string();
+		std::transform( Extension.begin(), Extension.end(), Extension.begin(), []( unsigned char c ) { return ( char ) std::tolower( c ); } );
+
+		return Extension == ".png" || Extension == ".jpg" || Extension == ".jpeg" || Extension == ".tga" || Extension == ".bmp" || Extension == ".hdr";
+	}
+}
@@ -0,0 +1,92 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#pragma once
+
+#include "Saturn/Vulkan/MipGenerator.h"
+
+#include <filesystem>
+#include <vector>
+#include <cstdint>
+
+namespace Saturn {
+
+	struct TextureImportSettings
+	{
+		// Textures that are not a power of two are resampled to the nearest one and written out as PNG (HDR for HDR textures).
+		bool ResizeToPowerOfTwo = false;
+		MipFilter ResizeFilter = MipFilter::Kaiser;
+
+		// Resize the color channels in linear space, turn off for data textures (normals, masks).
+		bool SRGB = true;
+	};
+
+	struct TextureImportResult
+	{
+		std::filesystem::path Source;
+		// Where the texture was written, the extension changes when it was resized.
+		std::filesystem::path Destination;
+
+		bool Imported = false;
+		bool Resized = false;
+	};
+
+	// A decoded image, RGBA8 or RGBA32F when HDR is set. Owned by stb_image so it has to be freed with Free.
+	struct DecodedImage
+	{
+		uint32_t Width = 0;
+		uint32_t Height = 0;
+		bool HDR = false;
+
+		void* pPixels = nullptr;
+
+		void Free();
+
+		operator bool() const { return pPixels != nullptr; }
+	};
+
+	// Decodes and imports texture files without touching the GPU, so importing a folder can run on every core (or without a renderer at all).
+	class TextureImporter
+	{
+	public:
+		// Safe to call from any thread, the flip flag is set per thread.
+		static DecodedImage Decode( const std::filesystem::path& rPath, bool Flip );
+
+		// Copies every file into rDestination, every file is decoded and resized on its own job. The results are in the same order as the paths.
+		// When several files share a stem only the first one is imported, the others are returned as not imported.
+		static std::vector<TextureImportResult> Import( const std::vector<std::filesystem::path>& rPaths, const std::filesystem::path& rDestination, const TextureImportSettings& rSettings );
+
+		// Files in rDirectory with an extension stb_image can decode.
+		static std::vector<std::filesystem::path> FindTextures( const std::filesystem::path& rDirectory, bool Recursive );
+
+		static bool IsTextureFile( const std::filesystem::path& rPath );
+
+	private:
+		static TextureImportResult ImportFile( const std::filesystem::path& rPath, const std::filesystem::path& rDestination, const TextureImportSettings& rSettings );
+	};
+}
@@ -31,6 +31,9 @@
 
 #include "Saturn/Core/VirtualFS.h"
 #include "Saturn/Core/MemoryStream.h"
+#include "Saturn/Core/OptickProfiler.h"
+
+#include "Saturn/Vulkan/MipGenerator.h"
 
 #include <stb_image.h>
 
@@ -49,6 +52,9 @@ namespace Saturn {
 	TextureSourceAsset::~TextureSourceAsset()
 	{
 		m_TextureBuffer.Free();
+
+		for( Buffer& rMip : m_Mips )
+			rMip.Free();
 	}
 
 	void TextureSourceAsset::LoadRawTexture()
@@ -78,7 +84,9 @@ namespace Saturn {
 		m_Height = Height;
 		m_Channels = Channels;
 
-		uint32_t ImageSize = m_Width * m_Height * 4;
+		// stbi_loadf returns a float per channel.
+		uint32_t ImageSize = m_Width * m_Height * 4 * ( m_HDR ? sizeof( float ) : 1 );
+		m_Format = m_HDR ? ImageFormat::RGBA32F : ImageFormat::RGBA8;
 
 		m_TextureBuffer = Buffer::Copy( pTextureData, static_cast<size_t>( ImageSize ) );
 
@@ -86,6 +94,99 @@ namespace Saturn {
 #endif
 	}
 
+	void TextureSourceAsset::Cook( TextureUsage Usage )
+	{
+		SAT_PF_EVENT();
+
+		if( !m_TextureBuffer )
+			return;
+
+		Timer timer;
+
+		CookedTexture Cooked = TextureCooker::Cook( m_TextureBuffer.Data, m_Width, m_Height, m_HDR, Usage );
+
+		SAT_CORE_INFO( "Cooked texture {0} as {1} to {2} ({3} mips) in {4}ms", m_AbsolutePath.string(), TextureCooker::UsageToString( m_HDR ? TextureUsage::HDR : Usage ), TextureCooker::FormatToString( Cooked.Format ), Cooked.Mips.size(), timer.Elapsed() );
+
+		for( Buffer& rMip : m_Mips )
+			rMip.Free();
+
+		m_Format = Cooked.Format;
+		m_Mips = std::move( Cooked.Mips );
+
+		// The runtime only needs the cooked mips.
+		m_TextureBuffer.Free();
+	}
+
+	TextureMipLoader TextureSourceAsset::CreateMipLoader( bool SRGB ) const
+	{
+#if defined(SAT_DIST)
+		std::string MountBase = Project::GetActiveConfig().Name;
+		std::filesystem::path AssetPath = Path;
+
+		return [MountBase, AssetPath, SRGB]( uint32_t FirstMip, uint32_t EndMip ) -> std::vector<Buffer>
+			{
+				// The bundle keeps the file content for as long as it is mounted, only the pixels of this load are copied out of it.
+				Ref<VFile> file = VirtualFS::Get().FindFile( MountBase, AssetPath );
+
+				if( !file )
+					return {};
+
+				PakFileMemoryBuffer membuf( file->FileContent );
+				std::istream stream( &membuf );
+
+				uint32_t Width = 0, Height = 0, Channels = 0;
+				bool Flipped = false, HDR = false;
+
+				RawSerialisation::ReadObject( Width, stream );
+				RawSerialisation::ReadObject( Height, stream );
+				RawSerialisation::ReadObject( Channels, stream );
+				RawSerialisation::ReadObject( Flipped, stream );
+				RawSerialisation::ReadObject( HDR, stream );
+
+				ImageFormat Format = ImageFormat::RGBA8;
+				uint32_t MipCount = 0;
+
+				RawSerialisation::ReadObject( Format, stream );
+				RawSerialisation::ReadObject( MipCount, stream );
+
+				// Cooked mips are used as they are, the ones before FirstMip are skipped over.
+				if( Format != ImageFormat::RGBA8 && Format != ImageFormat::RGBA32F )
+				{
+					std::vector<Buffer> Mips;
+
+					for( uint32_t Mip = 0; Mip < std::min( EndMip, MipCount ); Mip++ )
+					{
+						if( Mip < FirstMip )
+						{
+							size_t Size = 0;
+							RawSerialisation::ReadObject( Size, stream );
+
+							stream.seekg( Size, std::ios::cur );
+
+							continue;
+						}
+
+						Mips.push_back( {} );
+						RawSerialisation::ReadSaturnBuffer( Mips.back(), stream );
+					}
+
+					return Mips;
+				}
+
+				Buffer Pixels;
+				RawSerialisation::ReadSaturnBuffer( Pixels, stream );
+
+				std::vector<Buffer> Mips = MipGenerator::GenerateMips( Pixels.Data, Width, Height, MipFilter::Box, SRGB, FirstMip, EndMip );
+
+				Pixels.Free();
+
+				return Mips;
+			};
+#else
+		return TextureStreamer::CreateFileLoader( m_AbsolutePath, m_Flipped, SRGB, m_Width, m_Height );
+#endif
+	}
+
 	void TextureSourceAsset::WriteToVFS()
 	{
 		std::filesystem::path out = Project::GetActiveProject()->GetTempDir();
@@ -102,8 +203,21 @@ namespace Saturn {
 		RawSerialisation::WriteObject( m_Flipped, stream );
 		RawSerialisation::WriteObject( m_HDR, stream );
 
-		// Buffer
-		RawSerialisation::WriteSaturnBuffer( m_TextureBuffer, stream );
+		RawSerialisation::WriteObject( m_Format, stream );
+
+		// Uncooked textures are written as one mip of decoded pixels.
+		uint32_t MipCount = IsCooked() ? ( uint32_t ) m_Mips.size() : 1;
+		RawSerialisation::WriteObject( MipCount, stream );
+
+		if( IsCooked() )
+		{
+			for( const Buffer& rMip : m_Mips )
+				RawSerialisation::WriteSaturnBuffer( rMip, stream );
+		}
+		else
+		{
+			RawSerialisation::WriteSaturnBuffer( m_TextureBuffer, stream );
+		}
 	}
 
 	void TextureSourceAsset::ReadFromVFS()
@@ -127,8 +241,14 @@ namespace Saturn {
 		RawSerialisation::ReadObject( m_Flipped, stream );
 		RawSerialisation::ReadObject( m_HDR, stream );
 
-		// Buffer
-		RawSerialisation::ReadSaturnBuffer( m_TextureBuffer, stream );
+		RawSerialisation::ReadObject( m_Format, stream );
+
+		uint32_t MipCount = 0;
+		RawSerialisation::ReadObject( MipCount, stream );
+
+		// Cooked mips stay in the file, the texture streamer reads the ones it needs through the mip loader.
+		if( !IsCooked() )
+			RawSerialisation::ReadSaturnBuffer( m_TextureBuffer, stream );
 #endif
 	}
 }
\ No newline at end of file
@@ -29,7 +29,9 @@
 #pragma once
 
 #include "Asset.h"
+#include "TextureCooker.h"
 #include "Saturn/Serialisation/RawSerialisation.h"
+#include "Saturn/Vulkan/TextureStreamer.h"
 
 namespace Saturn {
 
@@ -44,6 +46,9 @@ namespace Saturn {
 		void WriteToVFS();
 		void ReadFromVFS();
 
+		// Replaces the decoded pixels with a block compressed mip chain, called when the asset bundle is built.
+		void Cook( TextureUsage Usage );
+
 	public:
 		uint32_t Width() { return m_Width; }
 		uint32_t Height() { return m_Height; }
@@ -52,6 +57,20 @@ namespace Saturn {
 
 		Buffer TextureData() { return m_TextureBuffer; }
 
+		bool IsHDR() const { return m_HDR; }
+
+		// Cooked textures have their whole mip chain in Format, otherwise TextureData holds the decoded pixels.
+		// At runtime the cooked mips are not kept in memory, the mip loader reads them out of the asset's VFS file.
+		bool IsCooked() const { return m_Format != ImageFormat::RGBA8 && m_Format != ImageFormat::RGBA32F; }
+		ImageFormat GetFormat() const { return m_Format; }
+
+		// Loads the mips for the TextureStreamer, from the asset's VFS file in Dist or by decoding the source file again otherwise.
+		// SRGB builds RGBA8 mips in linear space, cooked mips are already built.
+		TextureMipLoader CreateMipLoader( bool SRGB ) const;
+
+		// Frees the decoded pixels once a streamed texture has its mip tail, the streamer reads them again through the mip loader.
+		void ReleaseTextureData() { m_TextureBuffer.Free(); }
+
 	public:
 		//////////////////////////////////////////////////////////////////////////
 		// Raw binary serialisation.
@@ -100,5 +119,8 @@ namespace Saturn {
 		bool m_FullyLoaded = false;
 
 		Buffer m_TextureBuffer;
+
+		ImageFormat m_Format = ImageFormat::RGBA8;
+		std::vector<Buffer> m_Mips;
 	};
 }
\ No newline at end of file
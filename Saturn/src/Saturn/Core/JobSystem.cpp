@@ -34,21 +34,29 @@
 
 namespace Saturn {
 
+	static thread_local uint32_t s_ThreadIndex = 0;
+
 	JobSystem::JobSystem()
 	{
-		SetMaxThreads( 2 );
+		// Leave room for the main thread and the render thread.
+		SetMaxThreads( glm::max( std::thread::hardware_concurrency(), 4u ) - 2 );
 		CreateThreads();
 	}
 
 	JobSystem::~JobSystem()
 	{
-		TerminateThreads();
+		Stop();
 	}
 
 	void JobSystem::Stop()
 	{
-		m_Running = false;
-	
+		{
+			std::unique_lock<std::mutex> Lock( m_Mutex );
+			m_Running = false;
+		}
+
+		m_JobAvailable.notify_all();
+
 		TerminateThreads();
 	}
 
@@ -69,63 +77,108 @@ namespace Saturn {
 
 		for( size_t i = 0; i < m_MaxThreads; i++ )
 		{
-			m_Threads[ i ] = std::thread( &JobSystem::ThreadRun, this );
+			m_Threads[ i ] = std::thread( &JobSystem::ThreadRun, this, ( uint32_t ) i + 1 );
 		}
 	}
 
 	void JobSystem::TerminateThreads()
 	{
-		size_t index = 0;
 		for( auto& rThread : m_Threads )
 		{
 			if( rThread.joinable() )
 			{
 				rThread.join();
 			}
+		}
 
-			m_Threads.erase( m_Threads.begin() + index );
-			index++;
+		m_Threads.clear();
+	}
+
+	void JobSystem::ParallelFor( uint32_t Count, uint32_t BatchSize, const std::function<void( uint32_t Begin, uint32_t End )>& rFunc )
+	{
+		if( Count == 0 )
+			return;
+
+		BatchSize = glm::max( BatchSize, 1u );
+		uint32_t BatchCount = ( Count + BatchSize - 1 ) / BatchSize;
+
+		if( BatchCount == 1 || m_Threads.empty() )
+		{
+			rFunc( 0, Count );
+			return;
 		}
+
+		struct ParallelForState
+		{
+			std::atomic<uint32_t> NextBatch = 0;
+			std::atomic<uint32_t> CompletedBatches = 0;
+		};
+
+		// Helper jobs can start after we have returned, they only touch the shared state once every batch has been taken.
+		auto State = std::make_shared<ParallelForState>();
+		const auto* pFunc = &rFunc;
+
+		auto RunBatches = [State, pFunc, Count, BatchSize, BatchCount]()
+		{
+			while( true )
+			{
+				uint32_t Batch = State->NextBatch.fetch_add( 1 );
+
+				if( Batch >= BatchCount )
+					break;
+
+				uint32_t Begin = Batch * BatchSize;
+				uint32_t End = glm::min( Begin + BatchSize, Count );
+
+				( *pFunc )( Begin, End );
+
+				State->CompletedBatches.fetch_add( 1, std::memory_order_release );
+			}
+		};
+
+		uint32_t HelperCount = glm::min( ( uint32_t ) m_Threads.size(), BatchCount - 1 );
+
+		for( uint32_t i = 0; i < HelperCount; i++ )
+			AddJob( RunBatches );
+
+		RunBatches();
+
+		while( State->CompletedBatches.load( std::memory_order_acquire ) < BatchCount )
+			std::this_thread::yield();
 	}
 
-	void JobSystem::ThreadRun()
+	uint32_t JobSystem::GetThreadIndex()
 	{
-		using namespace std::chrono_literals;
+		return s_ThreadIndex;
+	}
 
+	void JobSystem::ThreadRun( uint32_t ThreadIndex )
+	{
 		SetThreadDescription( GetCurrentThread(), L"JobSystemThread" );
 
+		s_ThreadIndex = ThreadIndex;
+
 		while( m_Running )
 		{
-			while( !m_Jobs.empty() )
+			Ref<Job> currentJob;
+
 			{
-				Ref<Job> currentJob;
-
-				m_Mutex.lock();
-
-				// Find any jobs that have not yet been done.
-				for( auto Itr = m_Jobs.begin(); Itr != m_Jobs.end(); ++Itr )
-				{
-					auto& rJob = *Itr;
-
-					if( rJob )
-					{
-						currentJob = rJob;
-						
-						// Make sure we remove it so that it cannot be executed again.
-						m_Jobs.erase( Itr );
-						break;
-					}
-				}
-
-				m_Mutex.unlock();
-
-				if( currentJob )
-				{
-					currentJob->ExecuteJob();
-				}
+				std::unique_lock<std::mutex> Lock( m_Mutex );
+
+				m_JobAvailable.wait( Lock, [this]() { return !m_Running || !m_Jobs.empty(); } );
+
+				if( !m_Running )
+					break;
+
+				// Make sure we remove it so that it cannot be executed again.
+				currentJob = m_Jobs.front();
+				m_Jobs.erase( m_Jobs.begin() );
 			}
 
-			std::this_thread::sleep_for( 1ms );
+			if( currentJob )
+			{
+				currentJob->ExecuteJob();
+			}
 		}
 	}
 
@@ -31,6 +31,9 @@
 #include "Job.h"
 #include "Base.h"
 
+#include <atomic>
+#include <condition_variable>
+#include <functional>
 #include <mutex>
 #include <thread>
 
@@ -50,22 +53,36 @@ namespace Saturn {
 		template<typename Func>
 		void AddJob( Func&& rrFunc )
 		{
-			std::unique_lock<std::mutex>( m_Mutex );
+			{
+				std::unique_lock<std::mutex> Lock( m_Mutex );
 
-			Ref<Job> newJob = Ref<Job>::Create( rrFunc );
-			m_Jobs.push_back( newJob );
+				Ref<Job> newJob = Ref<Job>::Create( std::forward<Func>( rrFunc ) );
+				m_Jobs.push_back( newJob );
+			}
+
+			m_JobAvailable.notify_one();
 		}
 
+		// Splits [0, Count) into batches of BatchSize and runs rFunc( Begin, End ) for every batch on the worker threads.
+		// The calling thread works on batches as well and only returns once every batch has finished.
+		void ParallelFor( uint32_t Count, uint32_t BatchSize, const std::function<void( uint32_t Begin, uint32_t End )>& rFunc );
+
+		size_t GetThreadCount() const { return m_Threads.size(); }
+
+		// 1 to GetThreadCount() on the job system's threads, 0 on any other thread.
+		static uint32_t GetThreadIndex();
+
 	private:
-		void ThreadRun();
+		void ThreadRun( uint32_t ThreadIndex );
 		void CreateThreads();
 		void TerminateThreads();
 
 	private:
-		bool m_Running = false;
+		std::atomic<bool> m_Running = false;
 		size_t m_MaxThreads = 0;
 
 		std::mutex m_Mutex;
+		std::condition_variable m_JobAvailable;
 		std::vector<std::thread> m_Threads;
 		std::vector<Ref<Job>> m_Jobs;
 	};
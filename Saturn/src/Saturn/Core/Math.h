@@ -30,8 +30,26 @@
 
 #include <glm/glm.hpp>
 
+#include <cstdint>
+
 namespace Saturn::Math {
 
+	// FNV-1a over whole values, used to notice when static geometry was added, removed or moved.
+	struct HashBuilder
+	{
+		size_t Hash = 14695981039346656037ull;
+
+		void Combine( size_t Value ) { Hash = ( Hash ^ Value ) * 1099511628211ull; }
+
+		// Hashes the bits of the matrix, so any change to the transform changes the hash.
+		void Combine( const glm::mat4& rTransform )
+		{
+			const uint32_t* pWords = reinterpret_cast< const uint32_t* >( &rTransform );
+			for( size_t i = 0; i < sizeof( glm::mat4 ) / sizeof( uint32_t ); i++ )
+				Combine( pWords[ i ] );
+		}
+	};
+
 	bool DecomposeTransform( const glm::mat4& transform, glm::vec3& translation, glm::vec3& rotation, glm::vec3& scale );
 
 	bool DecomposeTransform( const glm::mat4& transform, glm::vec3& translation, glm::quat& rotation, glm::vec3& scale );
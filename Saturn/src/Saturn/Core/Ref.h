@@ -28,21 +28,30 @@
 
 #pragma once
 
+#include <atomic>
 #include <type_traits>
 
 namespace Saturn {
 
+	// Reference counts are atomic, Refs are copied on the job system's threads (e.g. when recording command buffers).
 	class RefTarget
 	{
 	public:
+		RefTarget() = default;
+
+		// A copy is a new object, it does not share the references of the original.
+		RefTarget( const RefTarget& ) {}
+		RefTarget& operator=( const RefTarget& ) { return *this; }
+
 		void AddRef() const
 		{
-			m_RefCount++;
+			m_RefCount.fetch_add( 1, std::memory_order_relaxed );
 		}
 
-		void RemoveRef() const
+		// Returns the reference count after the reference was removed.
+		int RemoveRef() const
 		{
-			m_RefCount--;
+			return m_RefCount.fetch_sub( 1, std::memory_order_acq_rel ) - 1;
 		}
 
 		void AddWeakRef() const
@@ -59,8 +68,8 @@ namespace Saturn {
 		uint32_t GetWeakRefCount() const { return m_WeakRefCount; }
 
 	private:
-		mutable int m_RefCount = 0;
-		mutable int m_WeakRefCount = 0;
+		mutable std::atomic<int> m_RefCount = 0;
+		mutable std::atomic<int> m_WeakRefCount = 0;
 	};
 	
 	template<typename T>
@@ -333,9 +342,8 @@ namespace Saturn {
 		{
 			if( m_Pointer ) 
 			{
-				m_Pointer->RemoveRef();
-
-				if( m_Pointer->GetRefCount() == 0 ) 
+				// Only the thread that removed the last reference may delete the object.
+				if( m_Pointer->RemoveRef() == 0 ) 
 				{
 					delete m_Pointer;
 					m_Pointer = nullptr;
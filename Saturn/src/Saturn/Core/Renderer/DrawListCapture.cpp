@@ -0,0 +1,216 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#include "sppch.h"
+#include "DrawListCapture.h"
+
+#include "Saturn/Serialisation/RawSerialisation.h"
+
+#include <fstream>
+#include <type_traits>
+
+namespace Saturn {
+
+	static constexpr uint32_t s_CaptureMagic = 0x43444C53; // "SLDC"
+	static constexpr uint32_t s_CaptureVersion = 1;
+
+	// Meshes can be large, so arrays of plain data are written in one go instead of element by element.
+	template<typename Ty>
+	static void WriteArray( const std::vector<Ty>& rArray, std::ofstream& rStream )
+	{
+		static_assert( std::is_trivially_copyable_v<Ty> );
+
+		size_t Count = rArray.size();
+		RawSerialisation::WriteObject( Count, rStream );
+		rStream.write( reinterpret_cast< const char* >( rArray.data() ), Count * sizeof( Ty ) );
+	}
+
+	template<typename Ty>
+	static bool ReadArray( std::vector<Ty>& rArray, std::ifstream& rStream )
+	{
+		static_assert( std::is_trivially_copyable_v<Ty> );
+
+		size_t Count = 0;
+		RawSerialisation::ReadObject( Count, rStream );
+
+		if( !rStream || Count > ( size_t ) 1 << 32 )
+			return false;
+
+		rArray.resize( Count );
+		rStream.read( reinterpret_cast< char* >( rArray.data() ), Count * sizeof( Ty ) );
+
+		return ( bool ) rStream;
+	}
+
+	void DrawListCapture::Clear()
+	{
+		*this = DrawListCapture();
+	}
+
+	bool DrawListCapture::Save( const std::filesystem::path& rPath ) const
+	{
+		std::ofstream stream( rPath, std::ios::binary | std::ios::trunc );
+
+		if( !stream )
+			return false;
+
+		RawSerialisation::WriteObject( s_CaptureMagic, stream );
+		RawSerialisation::WriteObject( s_CaptureVersion, stream );
+
+		RawSerialisation::WriteObject( Width, stream );
+		RawSerialisation::WriteObject( Height, stream );
+		RawSerialisation::WriteMatrix4x4( View, stream );
+		RawSerialisation::WriteMatrix4x4( Projection, stream );
+		RawSerialisation::WriteVec3( CameraPosition, stream );
+		RawSerialisation::WriteObject( LodProjectionScale, stream );
+
+		RawSerialisation::WriteObject( Settings, stream );
+
+		RawSerialisation::WriteVec3( LightDirection, stream );
+		RawSerialisation::WriteVec3( LightRadiance, stream );
+		RawSerialisation::WriteObject( LightIntensity, stream );
+		WriteArray( PointLights, stream );
+
+		size_t MeshCount = Meshes.size();
+		RawSerialisation::WriteObject( MeshCount, stream );
+
+		for( const auto& rMesh : Meshes )
+		{
+			RawSerialisation::WriteObject( rMesh.ID, stream );
+			RawSerialisation::WriteObject( rMesh.Quantised, stream );
+			WriteArray( rMesh.Positions, stream );
+			WriteArray( rMesh.Indices, stream );
+
+			size_t SubmeshCount = rMesh.Submeshes.size();
+			RawSerialisation::WriteObject( SubmeshCount, stream );
+
+			for( const auto& rSubmesh : rMesh.Submeshes )
+			{
+				RawSerialisation::WriteMatrix4x4( rSubmesh.Transform, stream );
+				RawSerialisation::WriteVec3( rSubmesh.BoundingBox.Min, stream );
+				RawSerialisation::WriteVec3( rSubmesh.BoundingBox.Max, stream );
+				RawSerialisation::WriteObject( rSubmesh.BaseVertex, stream );
+				RawSerialisation::WriteObject( rSubmesh.BaseIndex, stream );
+				RawSerialisation::WriteObject( rSubmesh.IndexCount, stream );
+				RawSerialisation::WriteObject( rSubmesh.VertexCount, stream );
+				RawSerialisation::WriteObject( rSubmesh.MaterialIndex, stream );
+				WriteArray( rSubmesh.Lods, stream );
+			}
+		}
+
+		WriteArray( Submissions, stream );
+		WriteArray( PreviousLods, stream );
+
+		return ( bool ) stream;
+	}
+
+	bool DrawListCapture::Load( const std::filesystem::path& rPath )
+	{
+		Clear();
+
+		std::ifstream stream( rPath, std::ios::binary );
+
+		if( !stream )
+			return false;
+
+		uint32_t Magic = 0, Version = 0;
+		RawSerialisation::ReadObject( Magic, stream );
+		RawSerialisation::ReadObject( Version, stream );
+
+		if( Magic != s_CaptureMagic || Version != s_CaptureVersion )
+			return false;
+
+		RawSerialisation::ReadObject( Width, stream );
+		RawSerialisation::ReadObject( Height, stream );
+		RawSerialisation::ReadMatrix4x4( View, stream );
+		RawSerialisation::ReadMatrix4x4( Projection, stream );
+		RawSerialisation::ReadVec3( CameraPosition, stream );
+		RawSerialisation::ReadObject( LodProjectionScale, stream );
+
+		RawSerialisation::ReadObject( Settings, stream );
+
+		RawSerialisation::ReadVec3( LightDirection, stream );
+		RawSerialisation::ReadVec3( LightRadiance, stream );
+		RawSerialisation::ReadObject( LightIntensity, stream );
+
+		if( !ReadArray( PointLights, stream ) )
+			return false;
+
+		size_t MeshCount = 0;
+		RawSerialisation::ReadObject( MeshCount, stream );
+
+		if( !stream || MeshCount > ( size_t ) 1 << 32 )
+			return false;
+
+		Meshes.resize( MeshCount );
+
+		for( auto& rMesh : Meshes )
+		{
+			RawSerialisation::ReadObject( rMesh.ID, stream );
+			RawSerialisation::ReadObject( rMesh.Quantised, stream );
+
+			if( !ReadArray( rMesh.Positions, stream ) || !ReadArray( rMesh.Indices, stream ) )
+				return false;
+
+			size_t SubmeshCount = 0;
+			RawSerialisation::ReadObject( SubmeshCount, stream );
+
+			if( !stream || SubmeshCount > ( size_t ) 1 << 32 )
+				return false;
+
+			rMesh.Submeshes.resize( SubmeshCount );
+
+			for( auto& rSubmesh : rMesh.Submeshes )
+			{
+				RawSerialisation::ReadMatrix4x4( rSubmesh.Transform, stream );
+				RawSerialisation::ReadVec3( rSubmesh.BoundingBox.Min, stream );
+				RawSerialisation::ReadVec3( rSubmesh.BoundingBox.Max, stream );
+				RawSerialisation::ReadObject( rSubmesh.BaseVertex, stream );
+				RawSerialisation::ReadObject( rSubmesh.BaseIndex, stream );
+				RawSerialisation::ReadObject( rSubmesh.IndexCount, stream );
+				RawSerialisation::ReadObject( rSubmesh.VertexCount, stream );
+				RawSerialisation::ReadObject( rSubmesh.MaterialIndex, stream );
+
+				if( !ReadArray( rSubmesh.Lods, stream ) )
+					return false;
+			}
+		}
+
+		if( !ReadArray( Submissions, stream ) || !ReadArray( PreviousLods, stream ) )
+			return false;
+
+		// Submissions must point at a mesh that is in the capture.
+		for( const auto& rSubmission : Submissions )
+		{
+			if( rSubmission.Mesh >= Meshes.size() )
+				return false;
+		}
+
+		return true;
+	}
+}
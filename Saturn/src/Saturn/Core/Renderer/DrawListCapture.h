@@ -0,0 +1,164 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#pragma once
+
+#include "Saturn/Core/AABB/AABB.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <filesystem>
+#include <vector>
+
+namespace Saturn {
+
+	struct CapturedLod
+	{
+		uint32_t BaseIndex = 0;
+		uint32_t IndexCount = 0;
+		float Error = 0.0f;
+	};
+
+	struct CapturedSubmesh
+	{
+		glm::mat4 Transform = glm::mat4( 1.0f );
+		AABB BoundingBox;
+
+		uint32_t BaseVertex = 0;
+		uint32_t BaseIndex = 0;
+		uint32_t IndexCount = 0;
+		uint32_t VertexCount = 0;
+		uint32_t MaterialIndex = 0;
+
+		// Same as Submesh::Lods, LOD 0 is the submesh itself and is not stored.
+		std::vector<CapturedLod> Lods;
+
+		CapturedLod GetLod( uint32_t LodIndex ) const
+		{
+			if( LodIndex == 0 || Lods.empty() )
+				return { BaseIndex, IndexCount, 0.0f };
+
+			return Lods[ std::min( LodIndex, ( uint32_t ) Lods.size() ) - 1 ];
+		}
+
+		uint32_t GetLodCount() const { return ( uint32_t ) Lods.size() + 1; }
+
+		// Same as Submesh::GetDequantisationMatrix.
+		glm::mat4 GetDequantisationMatrix() const
+		{
+			glm::vec3 Extent = BoundingBox.Max - BoundingBox.Min;
+			float Scale = std::max( Extent.x, std::max( Extent.y, Extent.z ) );
+
+			if( Scale <= 0.0f )
+				Scale = 1.0f;
+
+			glm::mat4 Result( Scale );
+			Result[ 3 ] = glm::vec4( BoundingBox.Min, 1.0f );
+
+			return Result;
+		}
+	};
+
+	// The parts of a static mesh that the CPU side of the scene renderer reads, positions and indices are only used by the occlusion culling.
+	struct CapturedMesh
+	{
+		uint64_t ID = 0;
+		bool Quantised = false;
+
+		std::vector<glm::vec3> Positions;
+		std::vector<uint32_t> Indices;
+		std::vector<CapturedSubmesh> Submeshes;
+	};
+
+	struct CapturedSubmission
+	{
+		uint64_t Entity = 0;
+
+		// Index into DrawListCapture::Meshes.
+		uint32_t Mesh = 0;
+
+		// Material registries only tell draws apart, so they are stored as an index.
+		uint32_t Registry = 0;
+
+		glm::mat4 Transform = glm::mat4( 1.0f );
+
+		bool Occluder = false;
+		bool Static = false;
+		bool PhysicsCollider = false;
+	};
+
+	// Renderer settings that change what the CPU side of a frame does.
+	struct DrawListCaptureSettings
+	{
+		bool EnableLods = true;
+		float LodPixelError = 1.0f;
+		float LodHysteresis = 0.2f;
+
+		bool EnableOcclusionCulling = true;
+		bool AutomaticOccluders = true;
+		float OccluderScreenRadius = 128.0f;
+		uint32_t MaxOccluderTriangles = 100000;
+
+		uint32_t DrawsPerSecondary = 128;
+	};
+
+	// One frame of the scene renderer's input: the camera, the lights, the settings and every SubmitStaticMesh and SubmitPhysicsCollider call.
+	// The meshes are stored with the capture so it can be replayed without the project or a device.
+	struct DrawListCapture
+	{
+		uint32_t Width = 0;
+		uint32_t Height = 0;
+
+		glm::mat4 View = glm::mat4( 1.0f );
+		glm::mat4 Projection = glm::mat4( 1.0f );
+
+		glm::vec3 CameraPosition{};
+		float LodProjectionScale = 0.0f;
+
+		DrawListCaptureSettings Settings;
+
+		glm::vec3 LightDirection{};
+		glm::vec3 LightRadiance{};
+		float LightIntensity = 0.0f;
+
+		// World space position and the distance at which the light stops contributing, as the light culling sees them.
+		std::vector<glm::vec4> PointLights;
+
+		std::vector<CapturedMesh> Meshes;
+		std::vector<CapturedSubmission> Submissions;
+
+		// LOD that every submesh of the static mesh submissions used the frame before, in submission order. UINT32_MAX when it was not drawn.
+		std::vector<uint32_t> PreviousLods;
+
+		void Clear();
+
+		bool Save( const std::filesystem::path& rPath ) const;
+		bool Load( const std::filesystem::path& rPath );
+	};
+}
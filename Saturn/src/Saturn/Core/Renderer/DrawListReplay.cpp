@@ -0,0 +1,439 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#include "sppch.h"
+#include "DrawListReplay.h"
+
+#include "Saturn/Core/JobSystem.h"
+#include "Saturn/Core/OptickProfiler.h"
+#include "Saturn/Core/Timer.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <format>
+#include <fstream>
+#include <sstream>
+
+namespace Saturn {
+
+	size_t DrawListReplay::DrawKeyHash::operator()( const DrawKey& rKey ) const
+	{
+		size_t Hash = 14695981039346656037ull;
+		auto Combine = [&]( size_t Value ) { Hash = ( Hash ^ Value ) * 1099511628211ull; };
+
+		Combine( rKey.Mesh );
+		Combine( rKey.Registry );
+		Combine( rKey.SubmeshIndex );
+		Combine( rKey.LodIndex );
+		Combine( ( size_t ) rKey.ShadowOnly << 1 | ( size_t ) rKey.Static );
+
+		return Hash;
+	}
+
+	static uint64_t HashBytes( uint64_t Hash, const void* pData, size_t Size )
+	{
+		const uint8_t* pBytes = static_cast< const uint8_t* >( pData );
+
+		for( size_t i = 0; i < Size; i++ )
+			Hash = ( Hash ^ pBytes[ i ] ) * 1099511628211ull;
+
+		return Hash;
+	}
+
+	DrawListReplay::DrawListReplay( const DrawListCapture& rCapture )
+		: m_Capture( rCapture )
+	{
+		m_Culler = Ref<OcclusionCuller>::Create();
+		m_LightClusters = Ref<LightClusters>::Create();
+
+		const auto& rSettings = m_Capture.Settings;
+
+		m_SelectionSettings.CameraPosition = m_Capture.CameraPosition;
+		m_SelectionSettings.ProjectionScale = m_Capture.LodProjectionScale;
+		m_SelectionSettings.EnableLods = rSettings.EnableLods;
+		m_SelectionSettings.LodPixelError = rSettings.LodPixelError;
+		m_SelectionSettings.LodHysteresis = rSettings.LodHysteresis;
+		m_SelectionSettings.AutomaticOccluders = rSettings.AutomaticOccluders;
+		m_SelectionSettings.OccluderScreenRadius = rSettings.OccluderScreenRadius;
+		m_SelectionSettings.MaxOccluderTriangles = rSettings.MaxOccluderTriangles;
+	}
+
+	const char* DrawListReplay::GetStageName( ReplayStage Stage )
+	{
+		switch( Stage )
+		{
+			case ReplayStage::Submit:           return "Submit";
+			case ReplayStage::OcclusionCulling: return "OcclusionCulling";
+			case ReplayStage::DrawLists:        return "DrawLists";
+			case ReplayStage::LightCulling:     return "LightCulling";
+			case ReplayStage::BuildCommands:    return "BuildCommands";
+			default:                            return "Unknown";
+		}
+	}
+
+	bool DrawListReplay::Run( uint32_t Iterations )
+	{
+		SAT_PF_EVENT();
+
+		m_Iterations = std::max( Iterations, 1u );
+		m_Samples.resize( m_Iterations );
+
+		bool Deterministic = true;
+		uint64_t FirstHash = 0;
+
+		for( uint32_t i = 0; i < m_Iterations; i++ )
+		{
+			RunFrame( m_Samples[ i ] );
+
+			// Not part of any stage, the hash only checks that every iteration built the same commands.
+			uint64_t Hash = HashBytes( 14695981039346656037ull, m_Commands.data(), m_Commands.size() * sizeof( ReplayDrawCommand ) );
+			Hash = HashBytes( Hash, m_InstanceTransforms.data(), m_InstanceTransforms.size() * sizeof( glm::mat4 ) );
+
+			m_Stats.CommandHash = Hash;
+
+			if( i == 0 )
+				FirstHash = Hash;
+			else if( Hash != FirstHash )
+				Deterministic = false;
+		}
+
+		for( uint32_t Stage = 0; Stage < ( uint32_t ) ReplayStage::Count; Stage++ )
+		{
+			auto& rTiming = m_Timings[ Stage ];
+			rTiming.Min = FLT_MAX;
+			rTiming.Max = 0.0f;
+
+			float Total = 0.0f;
+
+			for( const auto& rSample : m_Samples )
+			{
+				rTiming.Min = std::min( rTiming.Min, rSample[ Stage ] );
+				rTiming.Max = std::max( rTiming.Max, rSample[ Stage ] );
+				Total += rSample[ Stage ];
+			}
+
+			rTiming.Average = Total / ( float ) m_Iterations;
+		}
+
+		return Deterministic;
+	}
+
+	void DrawListReplay::RunFrame( StageTimes& rStageTimes )
+	{
+		SAT_PF_EVENT();
+
+		m_Stats = {};
+
+		Timer StageTimer;
+
+		auto EndStage = [&]( ReplayStage Stage )
+		{
+			rStageTimes[ ( size_t ) Stage ] = StageTimer.ElapsedMilliseconds();
+			StageTimer.Reset();
+		};
+
+		Submit();
+		EndStage( ReplayStage::Submit );
+
+		CullStaticMeshes();
+		EndStage( ReplayStage::OcclusionCulling );
+
+		BuildDrawLists();
+		EndStage( ReplayStage::DrawLists );
+
+		CullLights();
+		EndStage( ReplayStage::LightCulling );
+
+		BuildCommands();
+		EndStage( ReplayStage::BuildCommands );
+	}
+
+	void DrawListReplay::Submit()
+	{
+		SAT_PF_EVENT();
+
+		m_PendingSubmeshes.clear();
+		m_DrawList.clear();
+		m_ShadowMapDrawList.clear();
+		m_PhysicsColliderDrawList.clear();
+
+		size_t LodHistory = 0;
+
+		for( uint32_t i = 0; i < ( uint32_t ) m_Capture.Submissions.size(); i++ )
+		{
+			const auto& rSubmission = m_Capture.Submissions[ i ];
+			const auto& rSubmeshes = m_Capture.Meshes[ rSubmission.Mesh ].Submeshes;
+
+			for( uint32_t Index = 0; Index < ( uint32_t ) rSubmeshes.size(); Index++ )
+			{
+				if( rSubmission.PhysicsCollider )
+				{
+					DrawKey Key = { rSubmission.Mesh, rSubmission.Registry, Index };
+					m_PhysicsColliderDrawList[ Key ].push_back( rSubmission.Transform * rSubmeshes[ Index ].Transform );
+
+					continue;
+				}
+
+				PendingSubmesh Submesh;
+				Submesh.Submission = i;
+				Submesh.SubmeshIndex = Index;
+				Submesh.Transform = rSubmission.Transform * rSubmeshes[ Index ].Transform;
+
+				uint32_t PreviousLod = LodHistory < m_Capture.PreviousLods.size() ? m_Capture.PreviousLods[ LodHistory ] : UINT32_MAX;
+				LodHistory++;
+
+				Submesh.LodIndex = StaticMeshSelection::SelectLod( rSubmeshes[ Index ], Submesh.Transform, PreviousLod, m_SelectionSettings );
+
+				m_PendingSubmeshes.push_back( Submesh );
+			}
+		}
+
+		m_Stats.Submeshes = ( uint32_t ) m_PendingSubmeshes.size();
+	}
+
+	void DrawListReplay::CullStaticMeshes()
+	{
+		SAT_PF_EVENT();
+
+		m_Visible.assign( m_PendingSubmeshes.size(), 1 );
+
+		const auto& rSettings = m_Capture.Settings;
+
+		if( !rSettings.EnableOcclusionCulling || m_PendingSubmeshes.empty() )
+			return;
+
+		auto& rCuller = *m_Culler;
+		rCuller.BeginFrame( m_Capture.Projection * m_Capture.View );
+
+		uint32_t OccluderTriangles = 0;
+
+		for( const auto& rPending : m_PendingSubmeshes )
+		{
+			const auto& rSubmission = m_Capture.Submissions[ rPending.Submission ];
+			const auto& rMesh = m_Capture.Meshes[ rSubmission.Mesh ];
+			const auto& rSubmesh = rMesh.Submeshes[ rPending.SubmeshIndex ];
+			CapturedLod Lod = rSubmesh.GetLod( rPending.LodIndex );
+
+			// Captures of meshes without CPU vertices have no positions, the same meshes are never occluders in the engine.
+			bool HasGeometry = rSubmesh.BaseVertex < rMesh.Positions.size() && ( size_t ) Lod.BaseIndex + Lod.IndexCount <= rMesh.Indices.size();
+
+			if( !HasGeometry || !StaticMeshSelection::SelectOccluder( rSubmesh, rPending.LodIndex, rPending.Transform, rSubmission.Occluder, OccluderTriangles, m_SelectionSettings ) )
+				continue;
+
+			rCuller.AddOccluder( &rMesh.Positions[ rSubmesh.BaseVertex ], sizeof( glm::vec3 ), rMesh.Indices.data() + Lod.BaseIndex, Lod.IndexCount, rPending.Transform );
+		}
+
+		rCuller.Rasterise();
+
+		JobSystem::Get().ParallelFor( ( uint32_t ) m_PendingSubmeshes.size(), 64, [&]( uint32_t Begin, uint32_t End )
+			{
+				for( uint32_t i = Begin; i < End; i++ )
+				{
+					const auto& rPending = m_PendingSubmeshes[ i ];
+					const auto& rMesh = m_Capture.Meshes[ m_Capture.Submissions[ rPending.Submission ].Mesh ];
+
+					m_Visible[ i ] = rCuller.IsVisible( rMesh.Submeshes[ rPending.SubmeshIndex ].BoundingBox, rPending.Transform );
+				}
+			} );
+
+		m_Stats.OcclusionTested = ( uint32_t ) m_PendingSubmeshes.size();
+		m_Stats.Occluders = rCuller.GetOccluderCount();
+		m_Stats.OccluderTriangles = rCuller.GetOccluderTriangles();
+	}
+
+	void DrawListReplay::BuildDrawLists()
+	{
+		SAT_PF_EVENT();
+
+		for( size_t i = 0; i < m_PendingSubmeshes.size(); i++ )
+		{
+			AddStaticSubmesh( m_PendingSubmeshes[ i ], m_Visible[ i ] );
+
+			if( !m_Visible[ i ] )
+				m_Stats.OcclusionCulled++;
+		}
+	}
+
+	void DrawListReplay::AddStaticSubmesh( const PendingSubmesh& rSubmesh, bool Visible )
+	{
+		const auto& rSubmission = m_Capture.Submissions[ rSubmesh.Submission ];
+		const auto& rMesh = m_Capture.Meshes[ rSubmission.Mesh ];
+		const auto& rMeshSubmesh = rMesh.Submeshes[ rSubmesh.SubmeshIndex ];
+
+		DrawKey Key = { rSubmission.Mesh, rSubmission.Registry, rSubmesh.SubmeshIndex, rSubmesh.LodIndex };
+		Key.Static = rSubmission.Static;
+
+		if( Visible )
+			m_Stats.Triangles += rMeshSubmesh.GetLod( rSubmesh.LodIndex ).IndexCount / 3;
+
+		const glm::mat4 Transform = StaticMeshSelection::GetInstanceTransform( rMeshSubmesh, rSubmesh.Transform, rMesh.Quantised );
+
+		StaticMeshSelection::AddToDrawLists( Key, Visible, m_DrawList, m_ShadowMapDrawList, [&]( std::vector<glm::mat4>& rTransforms ) { rTransforms.push_back( Transform ); } );
+	}
+
+	void DrawListReplay::CullLights()
+	{
+		SAT_PF_EVENT();
+
+		auto& rClusters = *m_LightClusters;
+		rClusters.Build( m_Capture.PointLights, m_Capture.View, m_Capture.Projection, m_Capture.Width, m_Capture.Height );
+
+		m_Stats.VisibleLights = ( uint32_t ) rClusters.GetVisibleLights().size();
+		m_Stats.LightIndices = rClusters.GetIndexCount();
+	}
+
+	void DrawListReplay::GatherDraws( const DrawList& rDrawList, std::vector<DrawListEntry>& rDraws )
+	{
+		rDraws.clear();
+		rDraws.reserve( rDrawList.size() );
+
+		for( const auto& [rKey, rTransforms] : rDrawList )
+			rDraws.push_back( { &rKey, &rTransforms } );
+	}
+
+	void DrawListReplay::BuildCommands()
+	{
+		SAT_PF_EVENT();
+
+		const uint32_t DrawsPerSecondary = std::max( m_Capture.Settings.DrawsPerSecondary, 1u );
+
+		GatherDraws( m_DrawList, m_Draws );
+		GatherDraws( m_ShadowMapDrawList, m_ShadowDraws );
+		GatherDraws( m_PhysicsColliderDrawList, m_ColliderDraws );
+
+		const std::vector<DrawListEntry>* Lists[] = { &m_Draws, &m_ShadowDraws, &m_ColliderDraws };
+
+		// Instances of a draw are next to each other in the instance buffer, like InstanceBuffer::GetOffset.
+		uint32_t CommandCount = 0;
+		uint32_t InstanceCount = 0;
+
+		for( const auto* pList : Lists )
+		{
+			CommandCount += ( uint32_t ) pList->size();
+			m_Stats.CommandBuffers += ( ( uint32_t ) pList->size() + DrawsPerSecondary - 1 ) / DrawsPerSecondary;
+
+			for( const auto& rDraw : *pList )
+				InstanceCount += ( uint32_t ) rDraw.second->size();
+		}
+
+		m_Commands.resize( CommandCount );
+		m_InstanceTransforms.resize( InstanceCount );
+
+		uint32_t FirstCommand = 0;
+		uint32_t FirstInstance = 0;
+
+		for( const auto* pList : Lists )
+		{
+			const auto& rDraws = *pList;
+
+			std::vector<uint32_t> FirstInstances( rDraws.size() );
+
+			for( size_t i = 0; i < rDraws.size(); i++ )
+			{
+				FirstInstances[ i ] = FirstInstance;
+				FirstInstance += ( uint32_t ) rDraws[ i ].second->size();
+			}
+
+			// One batch per secondary command buffer, as SecondaryCommandRecorder::RecordParallel would split them.
+			JobSystem::Get().ParallelFor( ( uint32_t ) rDraws.size(), DrawsPerSecondary, [&]( uint32_t Begin, uint32_t End )
+				{
+					for( uint32_t i = Begin; i < End; i++ )
+					{
+						const auto& [pKey, pTransforms] = rDraws[ i ];
+						const auto& rSubmesh = m_Capture.Meshes[ pKey->Mesh ].Submeshes[ pKey->SubmeshIndex ];
+						CapturedLod Lod = rSubmesh.GetLod( pKey->LodIndex );
+
+						ReplayDrawCommand& rCommand = m_Commands[ FirstCommand + i ];
+						rCommand.IndexCount = Lod.IndexCount;
+						rCommand.FirstIndex = Lod.BaseIndex;
+						rCommand.VertexOffset = ( int32_t ) rSubmesh.BaseVertex;
+						rCommand.InstanceCount = ( uint32_t ) pTransforms->size();
+						rCommand.FirstInstance = FirstInstances[ i ];
+						rCommand.Mesh = pKey->Mesh;
+						rCommand.Registry = pKey->Registry;
+						rCommand.MaterialIndex = rSubmesh.MaterialIndex;
+
+						std::copy( pTransforms->begin(), pTransforms->end(), m_InstanceTransforms.begin() + FirstInstances[ i ] );
+					}
+				} );
+
+			FirstCommand += ( uint32_t ) rDraws.size();
+		}
+
+		m_Stats.Draws = ( uint32_t ) m_Draws.size();
+		m_Stats.ShadowDraws = ( uint32_t ) m_ShadowDraws.size();
+		m_Stats.ColliderDraws = ( uint32_t ) m_ColliderDraws.size();
+		m_Stats.Instances = InstanceCount;
+	}
+
+	bool DrawListReplay::ExportTimings( const std::filesystem::path& rPath ) const
+	{
+		std::ofstream Stream( rPath, std::ios::trunc );
+
+		if( !Stream )
+			return false;
+
+		Stream << "Iteration,Stage,CPU (ms)\n";
+
+		for( size_t i = 0; i < m_Samples.size(); i++ )
+		{
+			for( uint32_t Stage = 0; Stage < ( uint32_t ) ReplayStage::Count; Stage++ )
+				Stream << i << "," << GetStageName( ( ReplayStage ) Stage ) << "," << m_Samples[ i ][ Stage ] << "\n";
+		}
+
+		return ( bool ) Stream;
+	}
+
+	std::string DrawListReplay::GetReport() const
+	{
+		std::stringstream Report;
+
+		Report << std::format( "{0} submissions, {1} meshes, {2} point lights, {3}x{4}, {5} iterations\n",
+			m_Capture.Submissions.size(), m_Capture.Meshes.size(), m_Capture.PointLights.size(), m_Capture.Width, m_Capture.Height, m_Iterations );
+
+		float Total = 0.0f;
+
+		for( uint32_t Stage = 0; Stage < ( uint32_t ) ReplayStage::Count; Stage++ )
+		{
+			const auto& rTiming = m_Timings[ Stage ];
+			Report << std::format( "  {0:<18} min {1:8.4f} ms  avg {2:8.4f} ms  max {3:8.4f} ms\n", GetStageName( ( ReplayStage ) Stage ), rTiming.Min, rTiming.Average, rTiming.Max );
+
+			Total += rTiming.Average;
+		}
+
+		Report << std::format( "  {0:<18} avg {1:8.4f} ms\n", "Total", Total );
+
+		const auto& rStats = m_Stats;
+		Report << std::format( "Submeshes: {0}, occlusion culled {1} / {2} ({3} occluders, {4} triangles)\n", rStats.Submeshes, rStats.OcclusionCulled, rStats.OcclusionTested, rStats.Occluders, rStats.OccluderTriangles );
+		Report << std::format( "Draws: {0} geometry, {1} shadow, {2} collider, {3} instances, {4} triangles, {5} secondary command buffers\n", rStats.Draws, rStats.ShadowDraws, rStats.ColliderDraws, rStats.Instances, rStats.Triangles, rStats.CommandBuffers );
+		Report << std::format( "Point lights: {0} visible, {1} cluster indices\n", rStats.VisibleLights, rStats.LightIndices );
+		Report << std::format( "Command hash: {0:016x}\n", rStats.CommandHash );
+
+		return Report.str();
+	}
+}
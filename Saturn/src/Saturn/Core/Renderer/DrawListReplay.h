@@ -0,0 +1,199 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#pragma once
+
+#include "DrawListCapture.h"
+#include "OcclusionCuller.h"
+#include "LightClusters.h"
+#include "StaticMeshSelection.h"
+
+#include "Saturn/Core/Ref.h"
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Saturn {
+
+	enum class ReplayStage : uint32_t
+	{
+		Submit,
+		OcclusionCulling,
+		DrawLists,
+		LightCulling,
+		BuildCommands,
+		Count
+	};
+
+	struct ReplayStageTiming
+	{
+		float Min = 0.0f;
+		float Average = 0.0f;
+		float Max = 0.0f;
+	};
+
+	// What the last replayed frame produced.
+	struct DrawListReplayStats
+	{
+		uint32_t Submeshes = 0;
+		uint32_t OcclusionTested = 0;
+		uint32_t OcclusionCulled = 0;
+		uint32_t Occluders = 0;
+		uint32_t OccluderTriangles = 0;
+
+		uint32_t Draws = 0;
+		uint32_t ShadowDraws = 0;
+		uint32_t ColliderDraws = 0;
+		uint32_t Instances = 0;
+		uint32_t Triangles = 0;
+		uint32_t CommandBuffers = 0;
+
+		uint32_t VisibleLights = 0;
+		uint32_t LightIndices = 0;
+
+		// Hash of every command and instance transform, the same capture must always give the same hash.
+		uint64_t CommandHash = 0;
+	};
+
+	// Draw command of the null backend, what SceneRenderer would pass to vkCmdDrawIndexed.
+	struct ReplayDrawCommand
+	{
+		uint32_t IndexCount = 0;
+		uint32_t FirstIndex = 0;
+		int32_t VertexOffset = 0;
+		uint32_t InstanceCount = 0;
+		uint32_t FirstInstance = 0;
+		uint32_t Mesh = 0;
+		uint32_t Registry = 0;
+		uint32_t MaterialIndex = 0;
+	};
+
+	// Replays a DrawListCapture through the CPU side of SceneRenderer: LOD selection, occlusion culling, the draw lists, light culling
+	// and command building. LODs, occluders and the draw lists come from StaticMeshSelection, the same code the scene renderer uses. Commands are built into a null backend so no device is needed, every frame starts from the captured LOD history
+	// so every iteration does exactly the same work.
+	class DrawListReplay : public RefTarget
+	{
+	public:
+		DrawListReplay( const DrawListCapture& rCapture );
+		~DrawListReplay() = default;
+
+		// Replays the frame Iterations times. Returns false when two iterations built different commands.
+		bool Run( uint32_t Iterations );
+
+		const ReplayStageTiming& GetTiming( ReplayStage Stage ) const { return m_Timings[ ( uint32_t ) Stage ]; }
+		const DrawListReplayStats& GetStats() const { return m_Stats; }
+
+		uint32_t GetIterations() const { return m_Iterations; }
+
+		const std::vector<ReplayDrawCommand>& GetCommands() const { return m_Commands; }
+
+		// One row per iteration and stage, in milliseconds.
+		bool ExportTimings( const std::filesystem::path& rPath ) const;
+
+		std::string GetReport() const;
+
+		static const char* GetStageName( ReplayStage Stage );
+
+	private:
+		struct PendingSubmesh
+		{
+			uint32_t Submission = 0;
+			uint32_t SubmeshIndex = 0;
+			uint32_t LodIndex = 0;
+			glm::mat4 Transform;
+		};
+
+		struct DrawKey
+		{
+			uint32_t Mesh = 0;
+			uint32_t Registry = 0;
+			uint32_t SubmeshIndex = 0;
+			uint32_t LodIndex = 0;
+			bool ShadowOnly = false;
+			bool Static = false;
+
+			bool operator==( const DrawKey& rOther ) const = default;
+		};
+
+		struct DrawKeyHash
+		{
+			size_t operator()( const DrawKey& rKey ) const;
+		};
+
+		using DrawList = std::unordered_map< DrawKey, std::vector<glm::mat4>, DrawKeyHash >;
+		using DrawListEntry = std::pair< const DrawKey*, const std::vector<glm::mat4>* >;
+		using StageTimes = std::array< float, ( size_t ) ReplayStage::Count >;
+
+	private:
+		void RunFrame( StageTimes& rStageTimes );
+
+		void Submit();
+		void CullStaticMeshes();
+		void BuildDrawLists();
+		void CullLights();
+		void BuildCommands();
+
+		// Same as SceneRenderer::GatherDraws, the commands follow the order of the draw list.
+		static void GatherDraws( const DrawList& rDrawList, std::vector<DrawListEntry>& rDraws );
+
+		void AddStaticSubmesh( const PendingSubmesh& rSubmesh, bool Visible );
+
+	private:
+		const DrawListCapture& m_Capture;
+		StaticMeshSelectionSettings m_SelectionSettings;
+
+		Ref<OcclusionCuller> m_Culler;
+		Ref<LightClusters> m_LightClusters;
+
+		std::vector<PendingSubmesh> m_PendingSubmeshes;
+		std::vector<uint8_t> m_Visible;
+
+		DrawList m_DrawList;
+		DrawList m_ShadowMapDrawList;
+		DrawList m_PhysicsColliderDrawList;
+
+		std::vector<DrawListEntry> m_Draws;
+		std::vector<DrawListEntry> m_ShadowDraws;
+		std::vector<DrawListEntry> m_ColliderDraws;
+
+		// Null backend, one command per draw and the instance transforms that the instance buffer would hold.
+		std::vector<ReplayDrawCommand> m_Commands;
+		std::vector<glm::mat4> m_InstanceTransforms;
+
+		std::vector<StageTimes> m_Samples;
+		ReplayStageTiming m_Timings[ ( uint32_t ) ReplayStage::Count ];
+
+		DrawListReplayStats m_Stats;
+		uint32_t m_Iterations = 0;
+	};
+}
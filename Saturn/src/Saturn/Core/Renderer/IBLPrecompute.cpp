@@ -0,0 +1,503 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#include "sppch.h"
+#include "IBLPrecompute.h"
+
+#include "Saturn/Core/JobSystem.h"
+#include "Saturn/Core/OptickProfiler.h"
+#include "Saturn/Vulkan/MipGenerator.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <format>
+
+namespace Saturn {
+
+	static constexpr uint32_t s_IBLCacheMagic = 0x4C424953; // SIBL
+	static constexpr uint32_t s_IBLCacheVersion = 1;
+
+	// Bump when the output of one of the generators changes so old cache entries stop matching.
+	static constexpr uint32_t s_SkyGeneratorVersion = 1;
+	static constexpr uint32_t s_BRDFGeneratorVersion = 1;
+
+	static constexpr uint32_t RowsPerJob = 16;
+
+	struct IBLCacheFileHeader
+	{
+		uint32_t Magic = s_IBLCacheMagic;
+		uint32_t Version = s_IBLCacheVersion;
+
+		uint64_t Key = 0;
+		uint32_t MipCount = 0;
+		uint32_t Padding = 0;
+		uint64_t DataSize = 0;
+		uint64_t DataHash = 0;
+	};
+
+	static uint64_t HashBytes( uint64_t Hash, const void* pData, size_t Size )
+	{
+		const uint8_t* pBytes = static_cast< const uint8_t* >( pData );
+
+		for( size_t i = 0; i < Size; i++ )
+			Hash = ( Hash ^ pBytes[ i ] ) * 1099511628211ull;
+
+		return Hash;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Preetham sky
+
+	// Same direction for every face texel as the cube map view.
+	static glm::vec3 GetCubeDirection( uint32_t Face, float u, float v )
+	{
+		switch( Face )
+		{
+			case 0: return glm::normalize( glm::vec3( 1.0f, v, -u ) );
+			case 1: return glm::normalize( glm::vec3( -1.0f, v, u ) );
+			case 2: return glm::normalize( glm::vec3( u, 1.0f, -v ) );
+			case 3: return glm::normalize( glm::vec3( u, -1.0f, v ) );
+			case 4: return glm::normalize( glm::vec3( u, v, 1.0f ) );
+			default: return glm::normalize( glm::vec3( -u, v, -1.0f ) );
+		}
+	}
+
+	struct PreethamModel
+	{
+		glm::vec3 A, B, C, D, E;
+		glm::vec3 Zenith; // Yxy
+		glm::vec3 SunDirection;
+		glm::vec3 ZenithPerez;
+
+		PreethamModel( float Turbidity, float Azimuth, float Inclination )
+		{
+			const float t = Turbidity;
+
+			A = glm::vec3( 0.1787f * t - 1.4630f, -0.0193f * t - 0.2592f, -0.0167f * t - 0.2608f );
+			B = glm::vec3( -0.3554f * t + 0.4275f, -0.0665f * t + 0.0008f, -0.0950f * t + 0.0092f );
+			C = glm::vec3( -0.0227f * t + 5.3251f, -0.0004f * t + 0.2125f, -0.0079f * t + 0.2102f );
+			D = glm::vec3( 0.1206f * t - 2.5771f, -0.0641f * t - 0.8989f, -0.0441f * t - 1.6537f );
+			E = glm::vec3( -0.0670f * t + 0.3703f, -0.0033f * t + 0.0452f, -0.0109f * t + 0.0529f );
+
+			SunDirection = glm::normalize( glm::vec3( std::sin( Inclination ) * std::cos( Azimuth ), std::cos( Inclination ), std::sin( Inclination ) * std::sin( Azimuth ) ) );
+
+			const float CosThetaS = std::max( SunDirection.y, 0.0f );
+			const float ThetaS = std::acos( CosThetaS );
+
+			const glm::vec3 T( t * t, t, 1.0f );
+			const glm::vec4 Theta( ThetaS * ThetaS * ThetaS, ThetaS * ThetaS, ThetaS, 1.0f );
+
+			const float Chi = ( 4.0f / 9.0f - t / 120.0f ) * ( 3.141592f - 2.0f * ThetaS );
+			Zenith.x = ( 4.0453f * t - 4.9710f ) * std::tan( Chi ) - 0.2155f * t + 2.4192f;
+
+			Zenith.y = glm::dot( T, glm::vec3(
+				glm::dot( Theta, glm::vec4( 0.00165f, -0.00375f, 0.00209f, 0.0f ) ),
+				glm::dot( Theta, glm::vec4( -0.02903f, 0.06377f, -0.03202f, 0.00394f ) ),
+				glm::dot( Theta, glm::vec4( 0.11693f, -0.21196f, 0.06052f, 0.25886f ) ) ) );
+
+			Zenith.z = glm::dot( T, glm::vec3(
+				glm::dot( Theta, glm::vec4( 0.00275f, -0.00610f, 0.00317f, 0.0f ) ),
+				glm::dot( Theta, glm::vec4( -0.04214f, 0.08970f, -0.04153f, 0.00516f ) ),
+				glm::dot( Theta, glm::vec4( 0.15346f, -0.26756f, 0.06670f, 0.26688f ) ) ) );
+
+			ZenithPerez = Perez( 1.0f, ThetaS, CosThetaS );
+		}
+
+		glm::vec3 Perez( float CosTheta, float Gamma, float CosGamma ) const
+		{
+			return ( 1.0f + A * glm::exp( B / CosTheta ) ) * ( 1.0f + C * glm::exp( D * Gamma ) + E * CosGamma * CosGamma );
+		}
+
+		glm::vec3 Evaluate( const glm::vec3& rDirection ) const
+		{
+			// The shader goes through acos, taking the cosine straight from the dot product keeps the horizon finite.
+			const float CosTheta = std::max( rDirection.y, 0.0f );
+			const float CosGamma = std::max( glm::dot( SunDirection, rDirection ), 0.0f );
+
+			const glm::vec3 Yxy = Zenith * Perez( CosTheta, std::acos( CosGamma ), CosGamma ) / ZenithPerez;
+
+			const glm::vec3 XYZ( Yxy.y * Yxy.x / Yxy.z, Yxy.x, ( 1.0f - Yxy.y - Yxy.z ) * Yxy.x / Yxy.z );
+
+			const glm::vec3 RGB(
+				glm::dot( XYZ, glm::vec3( 2.3706743f, -0.9000405f, -0.4706338f ) ),
+				glm::dot( XYZ, glm::vec3( -0.5138850f, 1.4253036f, 0.0885814f ) ),
+				glm::dot( XYZ, glm::vec3( 0.0052982f, -0.0146949f, 1.0093968f ) ) );
+
+			return RGB;
+		}
+	};
+
+	Buffer IBLPrecompute::GeneratePreethamSky( uint32_t Size, float Turbidity, float Azimuth, float Inclination )
+	{
+		SAT_PF_EVENT();
+
+		const PreethamModel Model( Turbidity, Azimuth, Inclination );
+
+		const size_t FaceTexels = ( size_t ) Size * Size;
+
+		Buffer Result;
+		Result.Allocate( FaceTexels * 6 * sizeof( glm::vec4 ) );
+
+		glm::vec4* pTexels = Result.As<glm::vec4>();
+
+		JobSystem::Get().ParallelFor( Size * 6, RowsPerJob, [&]( uint32_t Begin, uint32_t End )
+			{
+				for( uint32_t Row = Begin; Row < End; Row++ )
+				{
+					const uint32_t Face = Row / Size;
+					const uint32_t y = Row % Size;
+
+					const float v = 2.0f * ( 1.0f - ( float ) y / Size ) - 1.0f;
+
+					glm::vec4* pRow = pTexels + Face * FaceTexels + ( size_t ) y * Size;
+
+					for( uint32_t x = 0; x < Size; x++ )
+					{
+						const float u = 2.0f * ( ( float ) x / Size ) - 1.0f;
+
+						glm::vec3 Color = Model.Evaluate( GetCubeDirection( Face, u, v ) ) * 0.05f;
+
+						// Below the horizon the model blows up, a black texel is better than a NaN that spreads through every mip.
+						if( !std::isfinite( Color.r ) || !std::isfinite( Color.g ) || !std::isfinite( Color.b ) )
+							Color = glm::vec3( 0.0f );
+
+						pRow[ x ] = glm::vec4( Color, 1.0f );
+					}
+				}
+			} );
+
+		return Result;
+	}
+
+	void IBLPrecompute::BuildCubeMips( std::vector<Buffer>& rMips, uint32_t Size )
+	{
+		SAT_PF_EVENT();
+
+		if( rMips.empty() )
+			return;
+
+		const uint32_t MipCount = MipGenerator::GetMipCount( Size, Size );
+
+		for( uint32_t Mip = ( uint32_t ) rMips.size(); Mip < MipCount; Mip++ )
+		{
+			const uint32_t SrcSize = MipGenerator::GetMipExtent( Size, Mip - 1 );
+			const uint32_t DstSize = MipGenerator::GetMipExtent( Size, Mip );
+
+			const glm::vec4* pSrc = rMips[ Mip - 1 ].As<glm::vec4>();
+
+			Buffer Dst;
+			Dst.Allocate( ( size_t ) DstSize * DstSize * 6 * sizeof( glm::vec4 ) );
+
+			glm::vec4* pDst = Dst.As<glm::vec4>();
+
+			JobSystem::Get().ParallelFor( DstSize * 6, RowsPerJob, [&]( uint32_t Begin, uint32_t End )
+				{
+					for( uint32_t Row = Begin; Row < End; Row++ )
+					{
+						const uint32_t Face = Row / DstSize;
+						const uint32_t y = Row % DstSize;
+
+						const glm::vec4* pFace = pSrc + ( size_t ) Face * SrcSize * SrcSize;
+						const glm::vec4* pRow0 = pFace + ( size_t ) std::min( y * 2, SrcSize - 1 ) * SrcSize;
+						const glm::vec4* pRow1 = pFace + ( size_t ) std::min( y * 2 + 1, SrcSize - 1 ) * SrcSize;
+
+						glm::vec4* pResult = pDst + ( size_t ) Face * DstSize * DstSize + ( size_t ) y * DstSize;
+
+						for( uint32_t x = 0; x < DstSize; x++ )
+						{
+							const uint32_t x0 = std::min( x * 2, SrcSize - 1 );
+							const uint32_t x1 = std::min( x * 2 + 1, SrcSize - 1 );
+
+							pResult[ x ] = ( pRow0[ x0 ] + pRow0[ x1 ] + pRow1[ x0 ] + pRow1[ x1 ] ) * 0.25f;
+						}
+					}
+				} );
+
+			rMips.push_back( Dst );
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// BRDF LUT
+
+	static float RadicalInverse( uint32_t Bits )
+	{
+		Bits = ( Bits << 16u ) | ( Bits >> 16u );
+		Bits = ( ( Bits & 0x55555555u ) << 1u ) | ( ( Bits & 0xAAAAAAAAu ) >> 1u );
+		Bits = ( ( Bits & 0x33333333u ) << 2u ) | ( ( Bits & 0xCCCCCCCCu ) >> 2u );
+		Bits = ( ( Bits & 0x0F0F0F0Fu ) << 4u ) | ( ( Bits & 0xF0F0F0F0u ) >> 4u );
+		Bits = ( ( Bits & 0x00FF00FFu ) << 8u ) | ( ( Bits & 0xFF00FF00u ) >> 8u );
+
+		return ( float ) Bits * 2.3283064365386963e-10f;
+	}
+
+	// Split sum integration of GGX with Smith Schlick visibility (k = a / 2) over Hammersley points.
+	static glm::vec2 IntegrateBRDF( float NdotV, float Roughness, uint32_t SampleCount )
+	{
+		const glm::vec3 V( std::sqrt( 1.0f - NdotV * NdotV ), 0.0f, NdotV );
+
+		const float a = Roughness * Roughness;
+		const float k = a * 0.5f;
+
+		glm::vec2 Result( 0.0f );
+
+		for( uint32_t i = 0; i < SampleCount; i++ )
+		{
+			const float Phi = 2.0f * 3.14159265f * ( ( float ) i / SampleCount );
+			const float Xi = RadicalInverse( i );
+
+			const float CosTheta = std::sqrt( ( 1.0f - Xi ) / ( 1.0f + ( a * a - 1.0f ) * Xi ) );
+			const float SinTheta = std::sqrt( 1.0f - CosTheta * CosTheta );
+
+			const glm::vec3 H( SinTheta * std::cos( Phi ), SinTheta * std::sin( Phi ), CosTheta );
+			const float VdotH = glm::dot( V, H );
+			const glm::vec3 L = 2.0f * VdotH * H - V;
+
+			const float NdotL = L.z;
+
+			if( NdotL <= 0.0f )
+				continue;
+
+			const float NdotH = std::max( H.z, 0.0f );
+			const float VoH = std::max( VdotH, 0.0f );
+
+			const float G = ( NdotV / ( NdotV * ( 1.0f - k ) + k ) ) * ( NdotL / ( NdotL * ( 1.0f - k ) + k ) );
+			const float Visibility = G * VoH / ( NdotH * NdotV );
+			const float Fresnel = std::pow( 1.0f - VoH, 5.0f );
+
+			Result.x += ( 1.0f - Fresnel ) * Visibility;
+			Result.y += Fresnel * Visibility;
+		}
+
+		return Result / ( float ) SampleCount;
+	}
+
+	std::vector<Buffer> IBLPrecompute::GenerateBRDFLut( uint32_t Size, uint32_t SampleCount )
+	{
+		SAT_PF_EVENT();
+
+		std::vector<uint8_t> Pixels( ( size_t ) Size * Size * 4 );
+
+		JobSystem::Get().ParallelFor( Size, RowsPerJob, [&]( uint32_t Begin, uint32_t End )
+			{
+				for( uint32_t y = Begin; y < End; y++ )
+				{
+					const float NdotV = std::max( 1.0f - ( y + 0.5f ) / Size, 1e-3f );
+
+					for( uint32_t x = 0; x < Size; x++ )
+					{
+						const glm::vec2 ScaleBias = IntegrateBRDF( NdotV, ( x + 0.5f ) / Size, SampleCount );
+
+						uint8_t* pTexel = &Pixels[ ( ( size_t ) y * Size + x ) * 4 ];
+						pTexel[ 0 ] = ( uint8_t ) ( std::clamp( ScaleBias.x, 0.0f, 1.0f ) * 255.0f + 0.5f );
+						pTexel[ 1 ] = ( uint8_t ) ( std::clamp( ScaleBias.y, 0.0f, 1.0f ) * 255.0f + 0.5f );
+						pTexel[ 2 ] = 0;
+						pTexel[ 3 ] = 255;
+					}
+				}
+			} );
+
+		return MipGenerator::GenerateMips( Pixels.data(), Size, Size, MipFilter::Box, false );
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Cache
+
+	uint64_t IBLPrecompute::GetSkyKey( uint32_t Size, float Turbidity, float Azimuth, float Inclination )
+	{
+		uint64_t Key = 14695981039346656037ull;
+		Key = HashBytes( Key, &s_SkyGeneratorVersion, sizeof( uint32_t ) );
+		Key = HashBytes( Key, &Size, sizeof( uint32_t ) );
+		Key = HashBytes( Key, &Turbidity, sizeof( float ) );
+		Key = HashBytes( Key, &Azimuth, sizeof( float ) );
+		Key = HashBytes( Key, &Inclination, sizeof( float ) );
+
+		return Key;
+	}
+
+	uint64_t IBLPrecompute::GetBRDFLutKey( uint32_t Size, uint32_t SampleCount )
+	{
+		uint64_t Key = 14695981039346656037ull;
+		Key = HashBytes( Key, &s_BRDFGeneratorVersion, sizeof( uint32_t ) );
+		Key = HashBytes( Key, &Size, sizeof( uint32_t ) );
+		Key = HashBytes( Key, &SampleCount, sizeof( uint32_t ) );
+
+		return Key;
+	}
+
+	static std::filesystem::path GetCacheFilePath( const std::filesystem::path& rDirectory, const char* pName, uint64_t Key )
+	{
+		return rDirectory / std::format( "{0}_{1:016x}.ibl", pName, Key );
+	}
+
+	bool IBLPrecompute::LoadCache( const std::filesystem::path& rDirectory, const char* pName, uint64_t Key, std::vector<Buffer>& rMips )
+	{
+		SAT_PF_EVENT();
+
+		if( rDirectory.empty() )
+			return false;
+
+		const std::filesystem::path Path = GetCacheFilePath( rDirectory, pName, Key );
+
+		std::ifstream Stream( Path, std::ios::binary );
+
+		if( !Stream )
+			return false;
+
+		IBLCacheFileHeader Header;
+		Stream.read( reinterpret_cast< char* >( &Header ), sizeof( Header ) );
+
+		if( !Stream || Header.Magic != s_IBLCacheMagic || Header.Version != s_IBLCacheVersion || Header.Key != Key )
+			return false;
+
+		std::vector<Buffer> Mips;
+		uint64_t DataSize = 0;
+		uint64_t DataHash = 14695981039346656037ull;
+
+		for( uint32_t Mip = 0; Mip < Header.MipCount; Mip++ )
+		{
+			uint64_t Size = 0;
+			Stream.read( reinterpret_cast< char* >( &Size ), sizeof( uint64_t ) );
+
+			if( !Stream || DataSize + Size > Header.DataSize )
+				break;
+
+			Buffer Data;
+			Data.Allocate( ( size_t ) Size );
+			Stream.read( reinterpret_cast< char* >( Data.Data ), ( std::streamsize ) Size );
+
+			Mips.push_back( Data );
+
+			if( !Stream )
+				break;
+
+			DataSize += Size;
+			DataHash = HashBytes( DataHash, Data.Data, Data.Size );
+		}
+
+		// Truncated or partially written, regenerate it.
+		if( Mips.size() != Header.MipCount || DataSize != Header.DataSize || DataHash != Header.DataHash )
+		{
+			for( Buffer& rMip : Mips )
+				rMip.Free();
+
+			SAT_CORE_WARN( "IBL cache entry '{0}' is corrupt, ignoring it.", Path.string() );
+			return false;
+		}
+
+		rMips = std::move( Mips );
+
+		// Entries are evicted by age, a sky that is still being used should not be the first to go.
+		std::error_code Error;
+		std::filesystem::last_write_time( Path, std::filesystem::file_time_type::clock::now(), Error );
+
+		return true;
+	}
+
+	bool IBLPrecompute::SaveCache( const std::filesystem::path& rDirectory, const char* pName, uint64_t Key, const std::vector<Buffer>& rMips, uint32_t MaxEntries )
+	{
+		SAT_PF_EVENT();
+
+		if( rDirectory.empty() )
+			return false;
+
+		std::error_code Error;
+		std::filesystem::create_directories( rDirectory, Error );
+
+		const std::filesystem::path Path = GetCacheFilePath( rDirectory, pName, Key );
+
+		IBLCacheFileHeader Header;
+		Header.Key = Key;
+		Header.MipCount = ( uint32_t ) rMips.size();
+		Header.DataHash = 14695981039346656037ull;
+
+		for( const Buffer& rMip : rMips )
+		{
+			Header.DataSize += rMip.Size;
+			Header.DataHash = HashBytes( Header.DataHash, rMip.Data, rMip.Size );
+		}
+
+		// Write next to the real file first so a crash while saving never leaves a half written entry behind.
+		std::filesystem::path TempPath = Path;
+		TempPath += ".tmp";
+
+		{
+			std::ofstream Stream( TempPath, std::ios::binary | std::ios::trunc );
+
+			if( !Stream )
+			{
+				SAT_CORE_WARN( "Failed to save IBL cache entry '{0}'", Path.string() );
+				return false;
+			}
+
+			Stream.write( reinterpret_cast< const char* >( &Header ), sizeof( Header ) );
+
+			for( const Buffer& rMip : rMips )
+			{
+				const uint64_t Size = rMip.Size;
+
+				Stream.write( reinterpret_cast< const char* >( &Size ), sizeof( uint64_t ) );
+				Stream.write( reinterpret_cast< const char* >( rMip.Data ), rMip.Size );
+			}
+		}
+
+		std::filesystem::rename( TempPath, Path, Error );
+
+		if( Error )
+		{
+			SAT_CORE_WARN( "Failed to save IBL cache entry '{0}': {1}", Path.string(), Error.message() );
+			return false;
+		}
+
+		// Every sky the user tries would stay around forever otherwise, drop the oldest entries of the same kind.
+		const std::string Prefix = std::format( "{0}_", pName );
+		std::vector<std::filesystem::directory_entry> Entries;
+
+		for( const auto& rEntry : std::filesystem::directory_iterator( rDirectory, Error ) )
+		{
+			if( rEntry.path().extension() == ".ibl" && rEntry.path().filename().string().starts_with( Prefix ) )
+				Entries.push_back( rEntry );
+		}
+
+		if( Entries.size() <= MaxEntries )
+			return true;
+
+		std::sort( Entries.begin(), Entries.end(), []( const auto& rLeft, const auto& rRight )
+			{
+				return rLeft.last_write_time() > rRight.last_write_time();
+			} );
+
+		for( size_t i = MaxEntries; i < Entries.size(); i++ )
+			std::filesystem::remove( Entries[ i ].path(), Error );
+
+		return true;
+	}
+}
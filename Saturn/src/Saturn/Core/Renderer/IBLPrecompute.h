@@ -0,0 +1,64 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#pragma once
+
+#include "Saturn/Core/Memory/Buffer.h"
+
+#include <filesystem>
+#include <vector>
+#include <cstdint>
+
+namespace Saturn {
+
+	// CPU precomputation of the image based lighting inputs: the dynamic (Preetham) sky and the split sum BRDF lookup table.
+	// Both only depend on a few parameters, so they are cached on disk keyed by a hash of those parameters.
+	// Rows are split over the job system, it is safe to call from a job.
+	class IBLPrecompute
+	{
+	public:
+		// Most detailed mip of the sky as RGBA32F, the six faces one after another in +X, -X, +Y, -Y, +Z, -Z order.
+		static Buffer GeneratePreethamSky( uint32_t Size, float Turbidity, float Azimuth, float Inclination );
+
+		// Adds the rest of the chain to a cube map that only has its most detailed mip, every mip is a 2x2 average of the one before it.
+		static void BuildCubeMips( std::vector<Buffer>& rMips, uint32_t Size );
+
+		// RGBA8 with mips, R is the scale and G the bias that is applied to F0.
+		// x goes from a roughness of 0 to 1 and y from NdotV = 1 at the top to 0 at the bottom, the layout the shaders sample it with.
+		static std::vector<Buffer> GenerateBRDFLut( uint32_t Size, uint32_t SampleCount );
+
+		static uint64_t GetSkyKey( uint32_t Size, float Turbidity, float Azimuth, float Inclination );
+		static uint64_t GetBRDFLutKey( uint32_t Size, uint32_t SampleCount );
+
+		// Cache entries are stored in rDirectory as <Name>_<Key>.ibl.
+		static bool LoadCache( const std::filesystem::path& rDirectory, const char* pName, uint64_t Key, std::vector<Buffer>& rMips );
+
+		// Only the MaxEntries most recently written entries with the same name are kept.
+		static bool SaveCache( const std::filesystem::path& rDirectory, const char* pName, uint64_t Key, const std::vector<Buffer>& rMips, uint32_t MaxEntries );
+	};
+}
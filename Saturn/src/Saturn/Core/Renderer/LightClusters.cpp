@@ -0,0 +1,282 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#include "sppch.h"
+#include "LightClusters.h"
+
+#include "Saturn/Core/JobSystem.h"
+#include "Saturn/Core/OptickProfiler.h"
+
+#include <cmath>
+
+namespace Saturn {
+
+	LightClusters::LightClusters( uint32_t GridX, uint32_t GridY, uint32_t GridZ )
+	{
+		m_Header.GridSize = glm::uvec4( glm::max( GridX, 1u ), glm::max( GridY, 1u ), glm::max( GridZ, 1u ), 0u );
+	}
+
+	void LightClusters::UpdateClusterBounds( const glm::mat4& rProjection, uint32_t Width, uint32_t Height )
+	{
+		if( rProjection == m_BoundsProjection && Width == m_BoundsWidth && Height == m_BoundsHeight )
+			return;
+
+		m_BoundsProjection = rProjection;
+		m_BoundsWidth = Width;
+		m_BoundsHeight = Height;
+
+		// Near and far planes of a zero to one perspective projection.
+		m_Near = rProjection[ 3 ][ 2 ] / rProjection[ 2 ][ 2 ];
+		m_Far = rProjection[ 3 ][ 2 ] / ( rProjection[ 2 ][ 2 ] + 1.0f );
+
+		if( !( m_Near > 0.0f ) )
+			m_Near = 0.01f;
+
+		if( !std::isfinite( m_Far ) || m_Far <= m_Near )
+			m_Far = m_Near * 10000.0f;
+
+		const glm::uvec3 Grid = glm::uvec3( m_Header.GridSize );
+		const glm::vec2 ClusterSize = glm::ceil( glm::vec2( ( float ) Width, ( float ) Height ) / glm::vec2( Grid ) );
+
+		float LogRange = std::log( m_Far / m_Near );
+
+		m_Header.Slicing.x = ( float ) Grid.z / LogRange;
+		m_Header.Slicing.y = -( float ) Grid.z * std::log( m_Near ) / LogRange;
+		m_Header.Slicing.z = 1.0f / ClusterSize.x;
+		m_Header.Slicing.w = 1.0f / ClusterSize.y;
+
+		const float ScaleX = rProjection[ 0 ][ 0 ];
+		const float ScaleY = rProjection[ 1 ][ 1 ];
+
+		m_ClusterBounds.resize( ( size_t ) Grid.x * Grid.y * Grid.z );
+
+		for( uint32_t z = 0; z < Grid.z; z++ )
+		{
+			float Depths[ 2 ] =
+			{
+				m_Near * std::pow( m_Far / m_Near, ( float ) z / Grid.z ),
+				m_Near * std::pow( m_Far / m_Near, ( float ) ( z + 1 ) / Grid.z )
+			};
+
+			for( uint32_t y = 0; y < Grid.y; y++ )
+			{
+				for( uint32_t x = 0; x < Grid.x; x++ )
+				{
+					glm::vec2 MinNdc = glm::vec2( x, y ) * ClusterSize / glm::vec2( ( float ) Width, ( float ) Height ) * 2.0f - 1.0f;
+					glm::vec2 MaxNdc = glm::vec2( x + 1, y + 1 ) * ClusterSize / glm::vec2( ( float ) Width, ( float ) Height ) * 2.0f - 1.0f;
+
+					ClusterBounds& rBounds = m_ClusterBounds[ ( ( size_t ) z * Grid.y + y ) * Grid.x + x ];
+					rBounds.Min = glm::vec3( FLT_MAX );
+					rBounds.Max = glm::vec3( -FLT_MAX );
+
+					for( float Depth : Depths )
+					{
+						for( uint32_t i = 0; i < 4; i++ )
+						{
+							glm::vec2 Ndc = glm::vec2( ( i & 1 ) ? MaxNdc.x : MinNdc.x, ( i & 2 ) ? MaxNdc.y : MinNdc.y );
+							glm::vec3 Point = glm::vec3( Ndc.x * Depth / ScaleX, Ndc.y * Depth / ScaleY, -Depth );
+
+							rBounds.Min = glm::min( rBounds.Min, Point );
+							rBounds.Max = glm::max( rBounds.Max, Point );
+						}
+					}
+				}
+			}
+		}
+	}
+
+	void LightClusters::Build( const std::vector<glm::vec4>& rSpheres, const glm::mat4& rView, const glm::mat4& rProjection, uint32_t Width, uint32_t Height )
+	{
+		SAT_PF_EVENT();
+
+		Width = glm::max( Width, 1u );
+		Height = glm::max( Height, 1u );
+
+		UpdateClusterBounds( rProjection, Width, Height );
+
+		const glm::uvec3 Grid = glm::uvec3( m_Header.GridSize );
+		const uint32_t ClusterCount = GetClusterCount();
+
+		m_ClusterLights.resize( ClusterCount );
+
+		for( auto& rLights : m_ClusterLights )
+			rLights.clear();
+
+		const float ScaleX = rProjection[ 0 ][ 0 ];
+		const float ScaleY = rProjection[ 1 ][ 1 ];
+
+		// The side planes go through the camera, scale the plane distances so they are in view space units.
+		const float PlaneScaleX = 1.0f / std::sqrt( ScaleX * ScaleX + 1.0f );
+		const float PlaneScaleY = 1.0f / std::sqrt( ScaleY * ScaleY + 1.0f );
+
+		const glm::vec2 ScreenSize = glm::vec2( ( float ) Width, ( float ) Height );
+		const glm::vec2 ClusterScale = glm::vec2( m_Header.Slicing.z, m_Header.Slicing.w );
+
+		auto DepthToSlice = [&]( float Depth )
+		{
+			float Slice = std::floor( std::log( Depth ) * m_Header.Slicing.x + m_Header.Slicing.y );
+			return ( uint32_t ) glm::clamp( Slice, 0.0f, ( float ) Grid.z - 1.0f );
+		};
+
+		m_Candidates.resize( rSpheres.size() );
+		m_CandidateVisible.assign( rSpheres.size(), 0 );
+
+		// Frustum cull and find the range of clusters that every light could touch.
+		JobSystem::Get().ParallelFor( ( uint32_t ) rSpheres.size(), 256, [&]( uint32_t Begin, uint32_t End )
+			{
+				for( uint32_t i = Begin; i < End; i++ )
+				{
+					const float Radius = rSpheres[ i ].w;
+
+					if( Radius <= 0.0f )
+						continue;
+
+					const glm::vec3 Center = glm::vec3( rView * glm::vec4( glm::vec3( rSpheres[ i ] ), 1.0f ) );
+					const float Depth = -Center.z;
+
+					if( Depth + Radius < m_Near || Depth - Radius > m_Far )
+						continue;
+
+					if( ( std::abs( ScaleX ) * Center.x + Depth ) * PlaneScaleX < -Radius || ( -std::abs( ScaleX ) * Center.x + Depth ) * PlaneScaleX < -Radius )
+						continue;
+
+					if( ( std::abs( ScaleY ) * Center.y + Depth ) * PlaneScaleY < -Radius || ( -std::abs( ScaleY ) * Center.y + Depth ) * PlaneScaleY < -Radius )
+						continue;
+
+					VisibleLight& rLight = m_Candidates[ i ];
+					rLight.Center = Center;
+					rLight.Radius = Radius;
+
+					rLight.MinCluster = glm::uvec3( 0, 0, DepthToSlice( glm::max( Depth - Radius, m_Near ) ) );
+					rLight.MaxCluster = glm::uvec3( Grid.x - 1, Grid.y - 1, DepthToSlice( glm::min( Depth + Radius, m_Far ) ) );
+
+					// When the sphere is fully in front of the near plane the projection of its bounding box bounds it on screen.
+					if( Depth - Radius > m_Near )
+					{
+						glm::vec2 MinNdc = glm::vec2( FLT_MAX );
+						glm::vec2 MaxNdc = glm::vec2( -FLT_MAX );
+
+						for( uint32_t Corner = 0; Corner < 8; Corner++ )
+						{
+							glm::vec3 Point = Center + glm::vec3( ( Corner & 1 ) ? Radius : -Radius, ( Corner & 2 ) ? Radius : -Radius, ( Corner & 4 ) ? Radius : -Radius );
+							glm::vec2 Ndc = glm::vec2( ScaleX * Point.x, ScaleY * Point.y ) / -Point.z;
+
+							MinNdc = glm::min( MinNdc, Ndc );
+							MaxNdc = glm::max( MaxNdc, Ndc );
+						}
+
+						glm::vec2 MinTile = glm::floor( ( MinNdc * 0.5f + 0.5f ) * ScreenSize * ClusterScale );
+						glm::vec2 MaxTile = glm::floor( ( MaxNdc * 0.5f + 0.5f ) * ScreenSize * ClusterScale );
+
+						MinTile = glm::clamp( MinTile, glm::vec2( 0.0f ), glm::vec2( Grid.x - 1, Grid.y - 1 ) );
+						MaxTile = glm::clamp( MaxTile, glm::vec2( 0.0f ), glm::vec2( Grid.x - 1, Grid.y - 1 ) );
+
+						rLight.MinCluster.x = ( uint32_t ) MinTile.x;
+						rLight.MinCluster.y = ( uint32_t ) MinTile.y;
+						rLight.MaxCluster.x = ( uint32_t ) MaxTile.x;
+						rLight.MaxCluster.y = ( uint32_t ) MaxTile.y;
+					}
+
+					m_CandidateVisible[ i ] = 1;
+				}
+			} );
+
+		m_VisibleLights.clear();
+		m_VisibleLightData.clear();
+
+		for( uint32_t i = 0; i < ( uint32_t ) rSpheres.size(); i++ )
+		{
+			if( !m_CandidateVisible[ i ] )
+				continue;
+
+			m_VisibleLights.push_back( i );
+			m_VisibleLightData.push_back( m_Candidates[ i ] );
+		}
+
+		// Every slice owns its own clusters so they can be filled at the same time.
+		JobSystem::Get().ParallelFor( Grid.z, 1, [this]( uint32_t Begin, uint32_t End )
+			{
+				for( uint32_t Slice = Begin; Slice < End; Slice++ )
+					AssignSlice( Slice );
+			} );
+
+		m_IndexCount = 0;
+		m_MaxLightsPerCluster = 0;
+
+		for( const auto& rLights : m_ClusterLights )
+		{
+			m_IndexCount += ( uint32_t ) rLights.size();
+			m_MaxLightsPerCluster = glm::max( m_MaxLightsPerCluster, ( uint32_t ) rLights.size() );
+		}
+
+		m_ClusterData.resize( ( size_t ) ClusterCount * 2 + m_IndexCount );
+
+		uint32_t Offset = ClusterCount * 2;
+
+		for( uint32_t i = 0; i < ClusterCount; i++ )
+		{
+			const auto& rLights = m_ClusterLights[ i ];
+
+			m_ClusterData[ i * 2 + 0 ] = Offset;
+			m_ClusterData[ i * 2 + 1 ] = ( uint32_t ) rLights.size();
+
+			std::copy( rLights.begin(), rLights.end(), m_ClusterData.begin() + Offset );
+			Offset += ( uint32_t ) rLights.size();
+		}
+	}
+
+	void LightClusters::AssignSlice( uint32_t Slice )
+	{
+		const glm::uvec3 Grid = glm::uvec3( m_Header.GridSize );
+
+		for( uint32_t i = 0; i < ( uint32_t ) m_VisibleLightData.size(); i++ )
+		{
+			const VisibleLight& rLight = m_VisibleLightData[ i ];
+
+			if( Slice < rLight.MinCluster.z || Slice > rLight.MaxCluster.z )
+				continue;
+
+			const float RadiusSquared = rLight.Radius * rLight.Radius;
+
+			for( uint32_t y = rLight.MinCluster.y; y <= rLight.MaxCluster.y; y++ )
+			{
+				for( uint32_t x = rLight.MinCluster.x; x <= rLight.MaxCluster.x; x++ )
+				{
+					const uint32_t Cluster = ( Slice * Grid.y + y ) * Grid.x + x;
+					const ClusterBounds& rBounds = m_ClusterBounds[ Cluster ];
+
+					glm::vec3 Closest = glm::clamp( rLight.Center, rBounds.Min, rBounds.Max );
+					glm::vec3 Delta = Closest - rLight.Center;
+
+					if( glm::dot( Delta, Delta ) <= RadiusSquared )
+						m_ClusterLights[ Cluster ].push_back( i );
+				}
+			}
+		}
+	}
+}
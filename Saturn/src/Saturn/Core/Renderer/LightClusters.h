@@ -0,0 +1,118 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#pragma once
+
+#include "Saturn/Core/Ref.h"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+namespace Saturn {
+
+	// Must match LightClusterBuffer in the static mesh shader.
+	struct LightClusterHeader
+	{
+		// Clusters in x, y and z.
+		glm::uvec4 GridSize{};
+
+		// xy: maps log( view depth ) to a depth slice, zw: one over the size of a cluster in pixels.
+		glm::vec4 Slicing{};
+	};
+
+	// Clustered light assignment on the CPU.
+	// The view frustum is split into a 3D grid of froxels (screen tiles with exponential depth slices), every light that survives
+	// the frustum test is added to each froxel that its sphere touches. Depth slices are built at the same time on the job system.
+	// Perspective projections only.
+	class LightClusters : public RefTarget
+	{
+	public:
+		LightClusters( uint32_t GridX = 16, uint32_t GridY = 9, uint32_t GridZ = 24 );
+		~LightClusters() = default;
+
+		// Spheres are in world space, w is the distance at which the light stops contributing.
+		void Build( const std::vector<glm::vec4>& rSpheres, const glm::mat4& rView, const glm::mat4& rProjection, uint32_t Width, uint32_t Height );
+
+		const LightClusterHeader& GetHeader() const { return m_Header; }
+
+		// Indices of the lights that are inside the view, the cluster lists index into this list.
+		const std::vector<uint32_t>& GetVisibleLights() const { return m_VisibleLights; }
+
+		// Offset and count of every cluster, followed by the light indices of all clusters. Offsets are relative to the start of the data.
+		const std::vector<uint32_t>& GetClusterData() const { return m_ClusterData; }
+
+		uint32_t GetClusterCount() const { return m_Header.GridSize.x * m_Header.GridSize.y * m_Header.GridSize.z; }
+		uint32_t GetIndexCount() const { return m_IndexCount; }
+		uint32_t GetMaxLightsPerCluster() const { return m_MaxLightsPerCluster; }
+
+	private:
+		struct ClusterBounds
+		{
+			glm::vec3 Min;
+			glm::vec3 Max;
+		};
+
+		struct VisibleLight
+		{
+			glm::vec3 Center;
+			float Radius;
+
+			glm::uvec3 MinCluster;
+			glm::uvec3 MaxCluster;
+		};
+
+	private:
+		void UpdateClusterBounds( const glm::mat4& rProjection, uint32_t Width, uint32_t Height );
+		void AssignSlice( uint32_t Slice );
+
+	private:
+		LightClusterHeader m_Header;
+
+		float m_Near = 0.0f;
+		float m_Far = 0.0f;
+
+		// View space bounds of every cluster, only rebuilt when the projection or the size changes.
+		std::vector<ClusterBounds> m_ClusterBounds;
+		glm::mat4 m_BoundsProjection = glm::mat4( 0.0f );
+		uint32_t m_BoundsWidth = 0;
+		uint32_t m_BoundsHeight = 0;
+
+		std::vector<VisibleLight> m_Candidates;
+		std::vector<uint8_t> m_CandidateVisible;
+
+		std::vector<uint32_t> m_VisibleLights;
+		std::vector<VisibleLight> m_VisibleLightData;
+
+		std::vector<std::vector<uint32_t>> m_ClusterLights;
+		std::vector<uint32_t> m_ClusterData;
+
+		uint32_t m_IndexCount = 0;
+		uint32_t m_MaxLightsPerCluster = 0;
+	};
+}
@@ -0,0 +1,404 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#include "sppch.h"
+#include "OcclusionCuller.h"
+
+#include "Saturn/Core/JobSystem.h"
+#include "Saturn/Core/OptickProfiler.h"
+
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#define SAT_OCCLUSION_SSE2
+#include <emmintrin.h>
+#endif
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace Saturn {
+
+	// Bounds are tested with a slightly closer depth so that an occluder never hides itself because of rounding.
+	static constexpr float s_DepthBias = 1e-4f;
+
+	OcclusionCuller::OcclusionCuller( uint32_t Width, uint32_t Height )
+	{
+		Resize( Width, Height );
+	}
+
+	void OcclusionCuller::Resize( uint32_t Width, uint32_t Height )
+	{
+		m_TilesX = glm::max( ( Width + TileSize - 1 ) / TileSize, 1u );
+		m_TilesY = glm::max( ( Height + TileSize - 1 ) / TileSize, 1u );
+
+		m_Width = m_TilesX * TileSize;
+		m_Height = m_TilesY * TileSize;
+
+		m_Depth.assign( ( size_t ) m_Width * m_Height, 0.0f );
+		m_TileMinDepth.assign( ( size_t ) m_TilesX * m_TilesY, 0.0f );
+	}
+
+	void OcclusionCuller::BeginFrame( const glm::mat4& rViewProjection )
+	{
+		m_ViewProjection = rViewProjection;
+
+		std::fill( m_Depth.begin(), m_Depth.end(), 0.0f );
+		std::fill( m_TileMinDepth.begin(), m_TileMinDepth.end(), 0.0f );
+
+		m_Occluders.clear();
+
+		m_OccluderTriangles = 0;
+		m_RasterisedTriangles = 0;
+	}
+
+	void OcclusionCuller::AddOccluder( const void* pVertices, uint32_t Stride, const uint32_t* pIndices, uint32_t IndexCount, const glm::mat4& rTransform )
+	{
+		if( IndexCount < 3 )
+			return;
+
+		Occluder& rOccluder = m_Occluders.emplace_back();
+		rOccluder.pVertices = static_cast< const uint8_t* >( pVertices );
+		rOccluder.Stride = Stride;
+		rOccluder.pIndices = pIndices;
+		rOccluder.IndexCount = IndexCount;
+		rOccluder.Transform = rTransform;
+
+		m_OccluderTriangles += IndexCount / 3;
+	}
+
+	void OcclusionCuller::Rasterise()
+	{
+		SAT_PF_EVENT();
+
+		if( m_Occluders.empty() )
+			return;
+
+		// Every occluder is transformed into its own list so the setup does not need any locking.
+		m_Triangles.resize( m_Occluders.size() );
+
+		JobSystem::Get().ParallelFor( ( uint32_t ) m_Occluders.size(), 1, [this]( uint32_t Begin, uint32_t End )
+			{
+				for( uint32_t i = Begin; i < End; i++ )
+				{
+					m_Triangles[ i ].clear();
+					SetupOccluder( m_Occluders[ i ], m_Triangles[ i ] );
+				}
+			} );
+
+		for( size_t i = 0; i < m_Occluders.size(); i++ )
+			m_RasterisedTriangles += ( uint32_t ) m_Triangles[ i ].size();
+
+		// One band is one row of tiles, bands never share pixels so they can be rasterised at the same time.
+		JobSystem::Get().ParallelFor( m_TilesY, 1, [this]( uint32_t Begin, uint32_t End )
+			{
+				for( uint32_t Band = Begin; Band < End; Band++ )
+					RasteriseBand( Band );
+			} );
+	}
+
+	void OcclusionCuller::SetupOccluder( const Occluder& rOccluder, std::vector<ScreenTriangle>& rTriangles ) const
+	{
+		const glm::mat4 Mvp = m_ViewProjection * rOccluder.Transform;
+		const glm::vec2 ScreenSize = glm::vec2( ( float ) m_Width, ( float ) m_Height );
+
+		for( uint32_t i = 0; i + 2 < rOccluder.IndexCount; i += 3 )
+		{
+			glm::vec4 Clip[ 3 ];
+			bool Clipped = false;
+
+			for( uint32_t k = 0; k < 3; k++ )
+			{
+				const glm::vec3& rPosition = *reinterpret_cast< const glm::vec3* >( rOccluder.pVertices + ( size_t ) rOccluder.pIndices[ i + k ] * rOccluder.Stride );
+				Clip[ k ] = Mvp * glm::vec4( rPosition, 1.0f );
+
+				// In front of the near plane, we don't clip so just leave the triangle out. Occluders only have to be conservative.
+				if( Clip[ k ].z < 0.0f || Clip[ k ].w <= 0.0f )
+					Clipped = true;
+			}
+
+			if( Clipped )
+				continue;
+
+			// Completely outside of one side of the frustum.
+			if( ( Clip[ 0 ].x < -Clip[ 0 ].w && Clip[ 1 ].x < -Clip[ 1 ].w && Clip[ 2 ].x < -Clip[ 2 ].w ) ||
+				( Clip[ 0 ].x > Clip[ 0 ].w && Clip[ 1 ].x > Clip[ 1 ].w && Clip[ 2 ].x > Clip[ 2 ].w ) ||
+				( Clip[ 0 ].y < -Clip[ 0 ].w && Clip[ 1 ].y < -Clip[ 1 ].w && Clip[ 2 ].y < -Clip[ 2 ].w ) ||
+				( Clip[ 0 ].y > Clip[ 0 ].w && Clip[ 1 ].y > Clip[ 1 ].w && Clip[ 2 ].y > Clip[ 2 ].w ) )
+				continue;
+
+			ScreenTriangle Triangle;
+			float InvW[ 3 ];
+
+			for( uint32_t k = 0; k < 3; k++ )
+			{
+				InvW[ k ] = 1.0f / Clip[ k ].w;
+				Triangle.Vertices[ k ] = ( glm::vec2( Clip[ k ] ) * InvW[ k ] * 0.5f + 0.5f ) * ScreenSize;
+			}
+
+			glm::vec2 Edge1 = Triangle.Vertices[ 1 ] - Triangle.Vertices[ 0 ];
+			glm::vec2 Edge2 = Triangle.Vertices[ 2 ] - Triangle.Vertices[ 0 ];
+
+			float Area = Edge1.x * Edge2.y - Edge1.y * Edge2.x;
+
+			if( std::abs( Area ) < 1e-6f )
+				continue;
+
+			// Always counter clockwise, we don't know the winding after mirrored transforms so there is no back face culling.
+			if( Area < 0.0f )
+			{
+				std::swap( Triangle.Vertices[ 1 ], Triangle.Vertices[ 2 ] );
+				std::swap( InvW[ 1 ], InvW[ 2 ] );
+				std::swap( Edge1, Edge2 );
+				Area = -Area;
+			}
+
+			// Pixels are covered when their center is inside the triangle.
+			glm::vec2 Min = glm::min( Triangle.Vertices[ 0 ], glm::min( Triangle.Vertices[ 1 ], Triangle.Vertices[ 2 ] ) );
+			glm::vec2 Max = glm::max( Triangle.Vertices[ 0 ], glm::max( Triangle.Vertices[ 1 ], Triangle.Vertices[ 2 ] ) );
+
+			Triangle.MinX = glm::max( ( int ) std::ceil( Min.x - 0.5f ), 0 );
+			Triangle.MinY = glm::max( ( int ) std::ceil( Min.y - 0.5f ), 0 );
+			Triangle.MaxX = glm::min( ( int ) std::floor( Max.x - 0.5f ), ( int ) m_Width - 1 );
+			Triangle.MaxY = glm::min( ( int ) std::floor( Max.y - 0.5f ), ( int ) m_Height - 1 );
+
+			if( Triangle.MinX > Triangle.MaxX || Triangle.MinY > Triangle.MaxY )
+				continue;
+
+			// 1 / w is linear in screen space.
+			float DeltaDepth1 = InvW[ 1 ] - InvW[ 0 ];
+			float DeltaDepth2 = InvW[ 2 ] - InvW[ 0 ];
+
+			Triangle.DepthDx = ( DeltaDepth1 * Edge2.y - DeltaDepth2 * Edge1.y ) / Area;
+			Triangle.DepthDy = ( DeltaDepth2 * Edge1.x - DeltaDepth1 * Edge2.x ) / Area;
+			Triangle.DepthBase = InvW[ 0 ] - Triangle.DepthDx * Triangle.Vertices[ 0 ].x - Triangle.DepthDy * Triangle.Vertices[ 0 ].y;
+
+			rTriangles.push_back( Triangle );
+		}
+	}
+
+	void OcclusionCuller::RasteriseBand( uint32_t Band )
+	{
+		int BandMinY = ( int ) ( Band * TileSize );
+		int BandMaxY = BandMinY + ( int ) TileSize - 1;
+
+		for( const auto& rTriangles : m_Triangles )
+		{
+			for( const auto& rTriangle : rTriangles )
+			{
+				if( rTriangle.MaxY < BandMinY || rTriangle.MinY > BandMaxY )
+					continue;
+
+				RasteriseTriangle( rTriangle, glm::max( rTriangle.MinY, BandMinY ), glm::min( rTriangle.MaxY, BandMaxY ) );
+			}
+		}
+
+		// Build the tiles of this band.
+		for( uint32_t TileX = 0; TileX < m_TilesX; TileX++ )
+		{
+			float TileMin = FLT_MAX;
+
+			for( uint32_t y = 0; y < TileSize; y++ )
+			{
+				const float* pRow = &m_Depth[ ( size_t ) ( BandMinY + y ) * m_Width + TileX * TileSize ];
+
+				for( uint32_t x = 0; x < TileSize; x++ )
+					TileMin = glm::min( TileMin, pRow[ x ] );
+			}
+
+			m_TileMinDepth[ ( size_t ) Band * m_TilesX + TileX ] = TileMin;
+		}
+	}
+
+	void OcclusionCuller::RasteriseTriangle( const ScreenTriangle& rTriangle, int MinY, int MaxY )
+	{
+		// Edge i goes from vertex i to vertex i + 1, E( p ) = A * p.x + B * p.y + C is positive on the inside.
+		float A[ 3 ], B[ 3 ], C[ 3 ];
+
+		for( int i = 0; i < 3; i++ )
+		{
+			const glm::vec2& rFrom = rTriangle.Vertices[ i ];
+			const glm::vec2& rTo = rTriangle.Vertices[ ( i + 1 ) % 3 ];
+
+			A[ i ] = rFrom.y - rTo.y;
+			B[ i ] = rTo.x - rFrom.x;
+			C[ i ] = -A[ i ] * rFrom.x - B[ i ] * rFrom.y;
+		}
+
+		// Depth rows are a multiple of 4 wide so aligning the start keeps every group of 4 inside the row.
+		int StartX = rTriangle.MinX & ~3;
+
+		for( int y = MinY; y <= MaxY; y++ )
+		{
+			float* pRow = &m_Depth[ ( size_t ) y * m_Width ];
+
+			float PixelY = ( float ) y + 0.5f;
+			float PixelX = ( float ) StartX + 0.5f;
+
+			float Edge0 = A[ 0 ] * PixelX + B[ 0 ] * PixelY + C[ 0 ];
+			float Edge1 = A[ 1 ] * PixelX + B[ 1 ] * PixelY + C[ 1 ];
+			float Edge2 = A[ 2 ] * PixelX + B[ 2 ] * PixelY + C[ 2 ];
+			float Depth = rTriangle.DepthBase + rTriangle.DepthDx * PixelX + rTriangle.DepthDy * PixelY;
+
+#if defined( SAT_OCCLUSION_SSE2 )
+			const __m128 Lanes = _mm_set_ps( 3.0f, 2.0f, 1.0f, 0.0f );
+			const __m128 Zero = _mm_setzero_ps();
+
+			__m128 Edge0x4 = _mm_add_ps( _mm_set1_ps( Edge0 ), _mm_mul_ps( Lanes, _mm_set1_ps( A[ 0 ] ) ) );
+			__m128 Edge1x4 = _mm_add_ps( _mm_set1_ps( Edge1 ), _mm_mul_ps( Lanes, _mm_set1_ps( A[ 1 ] ) ) );
+			__m128 Edge2x4 = _mm_add_ps( _mm_set1_ps( Edge2 ), _mm_mul_ps( Lanes, _mm_set1_ps( A[ 2 ] ) ) );
+			__m128 Depthx4 = _mm_add_ps( _mm_set1_ps( Depth ), _mm_mul_ps( Lanes, _mm_set1_ps( rTriangle.DepthDx ) ) );
+
+			const __m128 Step0 = _mm_set1_ps( A[ 0 ] * 4.0f );
+			const __m128 Step1 = _mm_set1_ps( A[ 1 ] * 4.0f );
+			const __m128 Step2 = _mm_set1_ps( A[ 2 ] * 4.0f );
+			const __m128 DepthStep = _mm_set1_ps( rTriangle.DepthDx * 4.0f );
+
+			for( int x = StartX; x <= rTriangle.MaxX; x += 4 )
+			{
+				__m128 Inside = _mm_and_ps( _mm_and_ps( _mm_cmpge_ps( Edge0x4, Zero ), _mm_cmpge_ps( Edge1x4, Zero ) ), _mm_cmpge_ps( Edge2x4, Zero ) );
+
+				if( _mm_movemask_ps( Inside ) )
+				{
+					__m128 Current = _mm_loadu_ps( pRow + x );
+					__m128 Nearest = _mm_max_ps( Current, Depthx4 );
+
+					_mm_storeu_ps( pRow + x, _mm_or_ps( _mm_and_ps( Inside, Nearest ), _mm_andnot_ps( Inside, Current ) ) );
+				}
+
+				Edge0x4 = _mm_add_ps( Edge0x4, Step0 );
+				Edge1x4 = _mm_add_ps( Edge1x4, Step1 );
+				Edge2x4 = _mm_add_ps( Edge2x4, Step2 );
+				Depthx4 = _mm_add_ps( Depthx4, DepthStep );
+			}
+#else
+			for( int x = StartX; x <= rTriangle.MaxX; x++ )
+			{
+				if( Edge0 >= 0.0f && Edge1 >= 0.0f && Edge2 >= 0.0f )
+					pRow[ x ] = glm::max( pRow[ x ], Depth );
+
+				Edge0 += A[ 0 ];
+				Edge1 += A[ 1 ];
+				Edge2 += A[ 2 ];
+				Depth += rTriangle.DepthDx;
+			}
+#endif
+		}
+	}
+
+	bool OcclusionCuller::IsVisible( const AABB& rBounds, const glm::mat4& rTransform ) const
+	{
+		const glm::mat4 Mvp = m_ViewProjection * rTransform;
+
+		glm::vec4 Clip[ 8 ];
+
+		// One bit per frustum plane, a box is outside when all corners are outside of the same plane.
+		uint32_t OutsideAll = 0x3F;
+		bool CrossesNearPlane = false;
+
+		for( uint32_t i = 0; i < 8; i++ )
+		{
+			glm::vec3 Corner = glm::vec3( ( i & 1 ) ? rBounds.Max.x : rBounds.Min.x, ( i & 2 ) ? rBounds.Max.y : rBounds.Min.y, ( i & 4 ) ? rBounds.Max.z : rBounds.Min.z );
+			Clip[ i ] = Mvp * glm::vec4( Corner, 1.0f );
+
+			uint32_t Outside = 0;
+			Outside |= Clip[ i ].x < -Clip[ i ].w ? 0x01 : 0;
+			Outside |= Clip[ i ].x > Clip[ i ].w ? 0x02 : 0;
+			Outside |= Clip[ i ].y < -Clip[ i ].w ? 0x04 : 0;
+			Outside |= Clip[ i ].y > Clip[ i ].w ? 0x08 : 0;
+			Outside |= Clip[ i ].z < 0.0f ? 0x10 : 0;
+			Outside |= Clip[ i ].z > Clip[ i ].w ? 0x20 : 0;
+
+			OutsideAll &= Outside;
+
+			if( Clip[ i ].z < 0.0f || Clip[ i ].w <= 0.0f )
+				CrossesNearPlane = true;
+		}
+
+		if( OutsideAll )
+			return false;
+
+		// We can't project the box, but it's right in front of the camera anyway.
+		if( CrossesNearPlane )
+			return true;
+
+		const glm::vec2 ScreenSize = glm::vec2( ( float ) m_Width, ( float ) m_Height );
+
+		glm::vec2 Min = glm::vec2( FLT_MAX );
+		glm::vec2 Max = glm::vec2( -FLT_MAX );
+		float MinW = FLT_MAX;
+
+		for( uint32_t i = 0; i < 8; i++ )
+		{
+			glm::vec2 Screen = ( glm::vec2( Clip[ i ] ) / Clip[ i ].w * 0.5f + 0.5f ) * ScreenSize;
+
+			Min = glm::min( Min, Screen );
+			Max = glm::max( Max, Screen );
+			MinW = glm::min( MinW, Clip[ i ].w );
+		}
+
+		// Every pixel that the box touches.
+		int MinX = glm::max( ( int ) std::floor( Min.x ), 0 );
+		int MinY = glm::max( ( int ) std::floor( Min.y ), 0 );
+		int MaxX = glm::min( ( int ) std::floor( Max.x ), ( int ) m_Width - 1 );
+		int MaxY = glm::min( ( int ) std::floor( Max.y ), ( int ) m_Height - 1 );
+
+		if( MinX > MaxX || MinY > MaxY )
+			return false;
+
+		// Nearest point of the box, anything that is closer than this hides the box.
+		float BoundsDepth = ( 1.0f / MinW ) * ( 1.0f + s_DepthBias );
+
+		for( int TileY = MinY / ( int ) TileSize; TileY <= MaxY / ( int ) TileSize; TileY++ )
+		{
+			for( int TileX = MinX / ( int ) TileSize; TileX <= MaxX / ( int ) TileSize; TileX++ )
+			{
+				// Every pixel of the tile is closer than the box.
+				if( m_TileMinDepth[ ( size_t ) TileY * m_TilesX + TileX ] > BoundsDepth )
+					continue;
+
+				int BeginX = glm::max( MinX, TileX * ( int ) TileSize );
+				int EndX = glm::min( MaxX, TileX * ( int ) TileSize + ( int ) TileSize - 1 );
+				int BeginY = glm::max( MinY, TileY * ( int ) TileSize );
+				int EndY = glm::min( MaxY, TileY * ( int ) TileSize + ( int ) TileSize - 1 );
+
+				for( int y = BeginY; y <= EndY; y++ )
+				{
+					const float* pRow = &m_Depth[ ( size_t ) y * m_Width ];
+
+					for( int x = BeginX; x <= EndX; x++ )
+					{
+						if( pRow[ x ] <= BoundsDepth )
+							return true;
+					}
+				}
+			}
+		}
+
+		return false;
+	}
+}
@@ -0,0 +1,127 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#pragma once
+
+#include "Saturn/Core/Ref.h"
+#include "Saturn/Core/AABB/AABB.h"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+namespace Saturn {
+
+	// CPU software occlusion culling.
+	// Large occluders are rasterised into a low resolution depth buffer on the job system, bounding boxes are then tested against
+	// a hierarchy of 8x8 tiles of that buffer. Everything here runs on the CPU so it does not depend on a device or a frame.
+	// The buffer stores 1 / w of the nearest occluder (larger is closer, 0 is empty), which does not depend on the depth range of the projection.
+	class OcclusionCuller : public RefTarget
+	{
+	public:
+		static constexpr uint32_t TileSize = 8;
+
+	public:
+		// The size is rounded up to a multiple of TileSize.
+		OcclusionCuller( uint32_t Width = 256, uint32_t Height = 128 );
+		~OcclusionCuller() = default;
+
+		void Resize( uint32_t Width, uint32_t Height );
+
+		// Clears the depth buffer and the occluders of the last frame.
+		void BeginFrame( const glm::mat4& rViewProjection );
+
+		// pVertices points at the position of the first vertex, the indices are relative to that vertex. The data must stay alive until Rasterise returns.
+		void AddOccluder( const void* pVertices, uint32_t Stride, const uint32_t* pIndices, uint32_t IndexCount, const glm::mat4& rTransform );
+
+		// Rasterises every occluder and builds the tile hierarchy.
+		void Rasterise();
+
+		// Returns false when the transformed bounds are outside of the frustum or behind the occluders.
+		// Safe to call from multiple threads once Rasterise has returned.
+		bool IsVisible( const AABB& rBounds, const glm::mat4& rTransform ) const;
+
+		uint32_t GetWidth() const { return m_Width; }
+		uint32_t GetHeight() const { return m_Height; }
+
+		// 1 / w of the nearest occluder for every pixel, row major.
+		const std::vector<float>& GetDepth() const { return m_Depth; }
+
+		uint32_t GetOccluderCount() const { return ( uint32_t ) m_Occluders.size(); }
+		uint32_t GetOccluderTriangles() const { return m_OccluderTriangles; }
+		uint32_t GetRasterisedTriangles() const { return m_RasterisedTriangles; }
+
+	private:
+		struct Occluder
+		{
+			const uint8_t* pVertices = nullptr;
+			uint32_t Stride = 0;
+			const uint32_t* pIndices = nullptr;
+			uint32_t IndexCount = 0;
+			glm::mat4 Transform;
+		};
+
+		// A triangle in pixel space, counter clockwise, with 1 / w as an affine function of the pixel position.
+		struct ScreenTriangle
+		{
+			glm::vec2 Vertices[ 3 ];
+
+			// InvW = DepthBase + DepthDx * x + DepthDy * y
+			float DepthBase;
+			float DepthDx;
+			float DepthDy;
+
+			// Inclusive pixel bounds.
+			int MinX, MaxX, MinY, MaxY;
+		};
+
+	private:
+		void SetupOccluder( const Occluder& rOccluder, std::vector<ScreenTriangle>& rTriangles ) const;
+		void RasteriseBand( uint32_t Band );
+		void RasteriseTriangle( const ScreenTriangle& rTriangle, int MinY, int MaxY );
+
+	private:
+		uint32_t m_Width = 0;
+		uint32_t m_Height = 0;
+		uint32_t m_TilesX = 0;
+		uint32_t m_TilesY = 0;
+
+		glm::mat4 m_ViewProjection = glm::mat4( 1.0f );
+
+		std::vector<float> m_Depth;
+
+		// Smallest (furthest) value of every tile.
+		std::vector<float> m_TileMinDepth;
+
+		std::vector<Occluder> m_Occluders;
+		std::vector<std::vector<ScreenTriangle>> m_Triangles;
+
+		uint32_t m_OccluderTriangles = 0;
+		uint32_t m_RasterisedTriangles = 0;
+	};
+}
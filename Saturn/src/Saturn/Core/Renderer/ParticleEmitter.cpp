@@ -0,0 +1,324 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#include "sppch.h"
+#include "ParticleEmitter.h"
+
+#include "Saturn/Core/OptickProfiler.h"
+
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#define SAT_PARTICLES_SSE2
+#include <emmintrin.h>
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace Saturn {
+
+	static inline uint32_t PadToSimdWidth( uint32_t Count )
+	{
+		return ( Count + ParticleEmitter::SimdWidth - 1 ) & ~( ParticleEmitter::SimdWidth - 1 );
+	}
+
+	glm::vec4 ParticleEmitterSettings::EvaluateColor( float Time ) const
+	{
+		if( ColorKeys.empty() )
+			return glm::vec4( 1.0f );
+
+		if( Time <= ColorKeys.front().Time )
+			return ColorKeys.front().Color;
+
+		for( size_t i = 1; i < ColorKeys.size(); i++ )
+		{
+			const auto& rPrevious = ColorKeys[ i - 1 ];
+			const auto& rNext = ColorKeys[ i ];
+
+			if( Time <= rNext.Time )
+			{
+				float Range = std::max( rNext.Time - rPrevious.Time, 1e-6f );
+
+				return glm::mix( rPrevious.Color, rNext.Color, ( Time - rPrevious.Time ) / Range );
+			}
+		}
+
+		return ColorKeys.back().Color;
+	}
+
+	ParticleEmitter::ParticleEmitter( uint32_t Seed )
+		: m_RandomState( Seed ? Seed : 1 )
+	{
+	}
+
+	bool ParticleEmitter::Update( const ParticleEmitterSettings& rSettings, const glm::mat4& rTransform, float DeltaTime, float CameraDistance )
+	{
+		if( rSettings.CullDistance > 0.0f && CameraDistance > rSettings.CullDistance )
+		{
+			// Paused, the particles keep their state until the camera comes back.
+			m_Culled = true;
+			m_PendingTime = 0.0f;
+			m_FramesSinceUpdate = 0;
+
+			return false;
+		}
+
+		m_Culled = false;
+
+		float BudgetScale = 1.0f;
+		uint32_t Interval = 1;
+
+		if( rSettings.ThrottleDistance > 0.0f && CameraDistance > rSettings.ThrottleDistance )
+		{
+			float Ratio = rSettings.ThrottleDistance / CameraDistance;
+
+			// The screen area of the emitter falls off with the square of the distance.
+			BudgetScale = Ratio * Ratio;
+			Interval = std::min( ( uint32_t ) ( 1.0f / Ratio ), MaxThrottleFrames );
+		}
+
+		m_PendingTime += DeltaTime;
+		m_FramesSinceUpdate++;
+
+		if( m_FramesSinceUpdate < Interval )
+			return true;
+
+		Simulate( rSettings, rTransform, m_PendingTime, BudgetScale );
+
+		m_PendingTime = 0.0f;
+		m_FramesSinceUpdate = 0;
+
+		return true;
+	}
+
+	void ParticleEmitter::Simulate( const ParticleEmitterSettings& rSettings, const glm::mat4& rTransform, float DeltaTime, float BudgetScale )
+	{
+		SAT_PF_EVENT();
+
+		if( DeltaTime <= 0.0f )
+			return;
+
+		Reserve( std::max( rSettings.MaxParticles, m_Count ) );
+
+		uint32_t Budget = ( uint32_t ) std::ceil( ( float ) rSettings.MaxParticles * BudgetScale );
+
+		m_SpawnAccumulator += rSettings.SpawnRate * BudgetScale * DeltaTime;
+
+		uint32_t SpawnCount = ( uint32_t ) m_SpawnAccumulator;
+		m_SpawnAccumulator -= ( float ) SpawnCount;
+
+		SpawnCount = m_Count < Budget ? std::min( SpawnCount, Budget - m_Count ) : 0;
+
+		Spawn( rSettings, rTransform, SpawnCount, DeltaTime );
+		Integrate( rSettings, DeltaTime );
+		RemoveDead();
+	}
+
+	void ParticleEmitter::Clear()
+	{
+		m_Count = 0;
+		m_SpawnAccumulator = 0.0f;
+		m_PendingTime = 0.0f;
+		m_FramesSinceUpdate = 0;
+	}
+
+	uint64_t ParticleEmitter::GetHash() const
+	{
+		uint64_t Hash = 14695981039346656037ull;
+
+		auto HashFloat = [&]( float Value )
+		{
+			uint32_t Bits;
+			memcpy( &Bits, &Value, sizeof( Bits ) );
+
+			Hash ^= Bits;
+			Hash *= 1099511628211ull;
+		};
+
+		for( uint32_t i = 0; i < m_Count; i++ )
+		{
+			HashFloat( m_PositionX[ i ] );
+			HashFloat( m_PositionY[ i ] );
+			HashFloat( m_PositionZ[ i ] );
+			HashFloat( m_Age[ i ] );
+		}
+
+		return Hash;
+	}
+
+	void ParticleEmitter::Reserve( uint32_t Count )
+	{
+		const size_t Capacity = PadToSimdWidth( Count );
+
+		if( m_Age.size() >= Capacity )
+			return;
+
+		// The padding lanes are integrated as well, they only need to hold finite numbers.
+		for( auto* pArray : { &m_PositionX, &m_PositionY, &m_PositionZ, &m_VelocityX, &m_VelocityY, &m_VelocityZ, &m_Age, &m_AgeRate } )
+			pArray->resize( Capacity, 0.0f );
+	}
+
+	void ParticleEmitter::Spawn( const ParticleEmitterSettings& rSettings, const glm::mat4& rTransform, uint32_t Count, float DeltaTime )
+	{
+		if( Count == 0 )
+			return;
+
+		const glm::vec3 Origin = glm::vec3( rTransform[ 3 ] );
+
+		// Only the rotation of the emitter applies to the velocity, not its scale.
+		glm::mat3 Rotation( 1.0f );
+		for( int Axis = 0; Axis < 3; Axis++ )
+		{
+			glm::vec3 Column = glm::vec3( rTransform[ Axis ] );
+			float Length = glm::length( Column );
+
+			if( Length > 0.0f )
+				Rotation[ Axis ] = Column / Length;
+		}
+
+		const float MinLifetime = std::max( std::min( rSettings.MinLifetime, rSettings.MaxLifetime ), 1e-3f );
+		const float MaxLifetime = std::max( rSettings.MaxLifetime, MinLifetime );
+
+		for( uint32_t n = 0; n < Count; n++ )
+		{
+			glm::vec3 Offset( 0.0f );
+
+			if( rSettings.SpawnRadius > 0.0f )
+			{
+				do
+				{
+					Offset = glm::vec3( Random(), Random(), Random() ) * 2.0f - 1.0f;
+				} while( glm::dot( Offset, Offset ) > 1.0f );
+
+				Offset *= rSettings.SpawnRadius;
+			}
+
+			glm::vec3 Velocity = Rotation * glm::mix( rSettings.MinVelocity, rSettings.MaxVelocity, glm::vec3( Random(), Random(), Random() ) );
+			float AgeRate = 1.0f / glm::mix( MinLifetime, MaxLifetime, Random() );
+
+			// Spread the births over the step, Integrate then moves every particle by the whole step.
+			// Otherwise a throttled emitter would release all of its particles in one clump.
+			float BirthTime = DeltaTime * ( ( float ) n + 0.5f ) / ( float ) Count;
+			glm::vec3 Position = Origin + Offset - Velocity * BirthTime;
+
+			const uint32_t i = m_Count++;
+
+			m_PositionX[ i ] = Position.x;
+			m_PositionY[ i ] = Position.y;
+			m_PositionZ[ i ] = Position.z;
+
+			m_VelocityX[ i ] = Velocity.x;
+			m_VelocityY[ i ] = Velocity.y;
+			m_VelocityZ[ i ] = Velocity.z;
+
+			m_Age[ i ] = -BirthTime * AgeRate;
+			m_AgeRate[ i ] = AgeRate;
+		}
+	}
+
+	void ParticleEmitter::Integrate( const ParticleEmitterSettings& rSettings, float DeltaTime )
+	{
+		const uint32_t Count = PadToSimdWidth( m_Count );
+
+		const float Damping = std::max( 1.0f - rSettings.Drag * DeltaTime, 0.0f );
+		const glm::vec3 Acceleration = rSettings.Gravity * DeltaTime;
+
+#if defined( SAT_PARTICLES_SSE2 )
+		const __m128 Dt = _mm_set1_ps( DeltaTime );
+		const __m128 Damp = _mm_set1_ps( Damping );
+		const __m128 AccelerationX = _mm_set1_ps( Acceleration.x );
+		const __m128 AccelerationY = _mm_set1_ps( Acceleration.y );
+		const __m128 AccelerationZ = _mm_set1_ps( Acceleration.z );
+
+		for( uint32_t i = 0; i < Count; i += SimdWidth )
+		{
+			__m128 VelocityX = _mm_add_ps( _mm_mul_ps( _mm_loadu_ps( &m_VelocityX[ i ] ), Damp ), AccelerationX );
+			__m128 VelocityY = _mm_add_ps( _mm_mul_ps( _mm_loadu_ps( &m_VelocityY[ i ] ), Damp ), AccelerationY );
+			__m128 VelocityZ = _mm_add_ps( _mm_mul_ps( _mm_loadu_ps( &m_VelocityZ[ i ] ), Damp ), AccelerationZ );
+
+			_mm_storeu_ps( &m_VelocityX[ i ], VelocityX );
+			_mm_storeu_ps( &m_VelocityY[ i ], VelocityY );
+			_mm_storeu_ps( &m_VelocityZ[ i ], VelocityZ );
+
+			_mm_storeu_ps( &m_PositionX[ i ], _mm_add_ps( _mm_loadu_ps( &m_PositionX[ i ] ), _mm_mul_ps( VelocityX, Dt ) ) );
+			_mm_storeu_ps( &m_PositionY[ i ], _mm_add_ps( _mm_loadu_ps( &m_PositionY[ i ] ), _mm_mul_ps( VelocityY, Dt ) ) );
+			_mm_storeu_ps( &m_PositionZ[ i ], _mm_add_ps( _mm_loadu_ps( &m_PositionZ[ i ] ), _mm_mul_ps( VelocityZ, Dt ) ) );
+
+			_mm_storeu_ps( &m_Age[ i ], _mm_add_ps( _mm_loadu_ps( &m_Age[ i ] ), _mm_mul_ps( _mm_loadu_ps( &m_AgeRate[ i ] ), Dt ) ) );
+		}
+#else
+		for( uint32_t i = 0; i < Count; i++ )
+		{
+			m_VelocityX[ i ] = m_VelocityX[ i ] * Damping + Acceleration.x;
+			m_VelocityY[ i ] = m_VelocityY[ i ] * Damping + Acceleration.y;
+			m_VelocityZ[ i ] = m_VelocityZ[ i ] * Damping + Acceleration.z;
+
+			m_PositionX[ i ] += m_VelocityX[ i ] * DeltaTime;
+			m_PositionY[ i ] += m_VelocityY[ i ] * DeltaTime;
+			m_PositionZ[ i ] += m_VelocityZ[ i ] * DeltaTime;
+
+			m_Age[ i ] += m_AgeRate[ i ] * DeltaTime;
+		}
+#endif
+	}
+
+	void ParticleEmitter::RemoveDead()
+	{
+		for( uint32_t i = 0; i < m_Count; )
+		{
+			if( m_Age[ i ] < 1.0f )
+			{
+				i++;
+				continue;
+			}
+
+			const uint32_t Last = --m_Count;
+
+			m_PositionX[ i ] = m_PositionX[ Last ];
+			m_PositionY[ i ] = m_PositionY[ Last ];
+			m_PositionZ[ i ] = m_PositionZ[ Last ];
+
+			m_VelocityX[ i ] = m_VelocityX[ Last ];
+			m_VelocityY[ i ] = m_VelocityY[ Last ];
+			m_VelocityZ[ i ] = m_VelocityZ[ Last ];
+
+			m_Age[ i ] = m_Age[ Last ];
+			m_AgeRate[ i ] = m_AgeRate[ Last ];
+		}
+	}
+
+	float ParticleEmitter::Random()
+	{
+		// xorshift32, small and the same on every platform.
+		m_RandomState ^= m_RandomState << 13;
+		m_RandomState ^= m_RandomState >> 17;
+		m_RandomState ^= m_RandomState << 5;
+
+		return ( float ) ( m_RandomState >> 8 ) * ( 1.0f / 16777216.0f );
+	}
+}
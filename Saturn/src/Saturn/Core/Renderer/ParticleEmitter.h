@@ -0,0 +1,202 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#pragma once
+
+#include "Saturn/Core/Ref.h"
+#include "Saturn/Serialisation/RawSerialisation.h"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+namespace Saturn {
+
+	// Colour of a particle at a normalised age, 0 is born and 1 is dead.
+	struct ParticleColorKey
+	{
+		float Time = 0.0f;
+		glm::vec4 Color = { 1.0f, 1.0f, 1.0f, 1.0f };
+
+	public:
+		template<typename OStream>
+		static void Serialise( const ParticleColorKey& rObject, OStream& rStream )
+		{
+			RawSerialisation::WriteObject( rObject.Time, rStream );
+			RawSerialisation::WriteObject( rObject.Color, rStream );
+		}
+
+		template<typename IStream>
+		static void Deserialise( ParticleColorKey& rObject, IStream& rStream )
+		{
+			RawSerialisation::ReadObject( rObject.Time, rStream );
+			RawSerialisation::ReadObject( rObject.Color, rStream );
+		}
+	};
+
+	struct ParticleEmitterSettings
+	{
+		// Particles per second.
+		float SpawnRate = 50.0f;
+		// The budget, the emitter never has more live particles than this.
+		uint32_t MaxParticles = 1000;
+
+		float MinLifetime = 1.0f;
+		float MaxLifetime = 2.0f;
+
+		// Particles are born inside a sphere of this radius around the emitter.
+		float SpawnRadius = 0.0f;
+
+		// The start velocity is picked between these, relative to the rotation of the emitter.
+		glm::vec3 MinVelocity = { -1.0f, 2.0f, -1.0f };
+		glm::vec3 MaxVelocity = { 1.0f, 4.0f, 1.0f };
+
+		glm::vec3 Gravity = { 0.0f, -9.81f, 0.0f };
+		// Fraction of the velocity lost every second.
+		float Drag = 0.0f;
+
+		float StartSize = 0.25f;
+		float EndSize = 0.0f;
+
+		// Sorted by time, the colour is interpolated between the keys.
+		std::vector<ParticleColorKey> ColorKeys = { { 0.0f, { 1.0f, 1.0f, 1.0f, 1.0f } }, { 1.0f, { 1.0f, 1.0f, 1.0f, 0.0f } } };
+
+		// Past this distance from the camera the emitter is updated less often and its budget shrinks with the distance.
+		float ThrottleDistance = 50.0f;
+		// Past this distance the emitter is paused and not drawn.
+		float CullDistance = 200.0f;
+
+		glm::vec4 EvaluateColor( float Time ) const;
+
+	public:
+		template<typename OStream>
+		static void Serialise( const ParticleEmitterSettings& rObject, OStream& rStream )
+		{
+			RawSerialisation::WriteObject( rObject.SpawnRate, rStream );
+			RawSerialisation::WriteObject( rObject.MaxParticles, rStream );
+			RawSerialisation::WriteObject( rObject.MinLifetime, rStream );
+			RawSerialisation::WriteObject( rObject.MaxLifetime, rStream );
+			RawSerialisation::WriteObject( rObject.SpawnRadius, rStream );
+			RawSerialisation::WriteObject( rObject.MinVelocity, rStream );
+			RawSerialisation::WriteObject( rObject.MaxVelocity, rStream );
+			RawSerialisation::WriteObject( rObject.Gravity, rStream );
+			RawSerialisation::WriteObject( rObject.Drag, rStream );
+			RawSerialisation::WriteObject( rObject.StartSize, rStream );
+			RawSerialisation::WriteObject( rObject.EndSize, rStream );
+			RawSerialisation::WriteVector( rObject.ColorKeys, rStream );
+			RawSerialisation::WriteObject( rObject.ThrottleDistance, rStream );
+			RawSerialisation::WriteObject( rObject.CullDistance, rStream );
+		}
+
+		template<typename IStream>
+		static void Deserialise( ParticleEmitterSettings& rObject, IStream& rStream )
+		{
+			RawSerialisation::ReadObject( rObject.SpawnRate, rStream );
+			RawSerialisation::ReadObject( rObject.MaxParticles, rStream );
+			RawSerialisation::ReadObject( rObject.MinLifetime, rStream );
+			RawSerialisation::ReadObject( rObject.MaxLifetime, rStream );
+			RawSerialisation::ReadObject( rObject.SpawnRadius, rStream );
+			RawSerialisation::ReadObject( rObject.MinVelocity, rStream );
+			RawSerialisation::ReadObject( rObject.MaxVelocity, rStream );
+			RawSerialisation::ReadObject( rObject.Gravity, rStream );
+			RawSerialisation::ReadObject( rObject.Drag, rStream );
+			RawSerialisation::ReadObject( rObject.StartSize, rStream );
+			RawSerialisation::ReadObject( rObject.EndSize, rStream );
+			RawSerialisation::ReadVector( rObject.ColorKeys, rStream );
+			RawSerialisation::ReadObject( rObject.ThrottleDistance, rStream );
+			RawSerialisation::ReadObject( rObject.CullDistance, rStream );
+		}
+	};
+
+	// CPU particle simulation for one emitter.
+	// Particles are stored as a structure of arrays padded to SimdWidth so four particles are integrated at once, dead particles are swapped with the last one.
+	// Nothing here depends on a device, the same seed and the same inputs always give the same particles.
+	class ParticleEmitter : public RefTarget
+	{
+	public:
+		static constexpr uint32_t SimdWidth = 4;
+		// Throttled emitters are updated at least every MaxThrottleFrames frames.
+		static constexpr uint32_t MaxThrottleFrames = 4;
+
+	public:
+		ParticleEmitter( uint32_t Seed = 1 );
+		~ParticleEmitter() = default;
+
+		// Throttles the emitter by its distance to the camera then simulates it.
+		// Returns false when the emitter is past its cull distance and should not be drawn.
+		bool Update( const ParticleEmitterSettings& rSettings, const glm::mat4& rTransform, float DeltaTime, float CameraDistance );
+
+		// Spawns new particles and moves every live particle by DeltaTime. BudgetScale scales both the spawn rate and the budget.
+		void Simulate( const ParticleEmitterSettings& rSettings, const glm::mat4& rTransform, float DeltaTime, float BudgetScale = 1.0f );
+
+		void Clear();
+
+		uint32_t GetCount() const { return m_Count; }
+		bool IsCulled() const { return m_Culled; }
+
+		glm::vec3 GetPosition( uint32_t Index ) const { return { m_PositionX[ Index ], m_PositionY[ Index ], m_PositionZ[ Index ] }; }
+		// Normalised, 0 is born and 1 is dead.
+		float GetAge( uint32_t Index ) const { return m_Age[ Index ]; }
+
+		// Hash of every live particle, used to check that a simulation is deterministic.
+		uint64_t GetHash() const;
+
+	private:
+		void Reserve( uint32_t Count );
+		void Spawn( const ParticleEmitterSettings& rSettings, const glm::mat4& rTransform, uint32_t Count, float DeltaTime );
+		void Integrate( const ParticleEmitterSettings& rSettings, float DeltaTime );
+		void RemoveDead();
+
+		// Uniform in [0, 1).
+		float Random();
+
+	private:
+		std::vector<float> m_PositionX;
+		std::vector<float> m_PositionY;
+		std::vector<float> m_PositionZ;
+
+		std::vector<float> m_VelocityX;
+		std::vector<float> m_VelocityY;
+		std::vector<float> m_VelocityZ;
+
+		// The age is normalised so the colour and the size need no divide, AgeRate is 1 / lifetime.
+		std::vector<float> m_Age;
+		std::vector<float> m_AgeRate;
+
+		uint32_t m_Count = 0;
+
+		float m_SpawnAccumulator = 0.0f;
+
+		// Time that has passed while the emitter was throttled.
+		float m_PendingTime = 0.0f;
+		uint32_t m_FramesSinceUpdate = 0;
+		bool m_Culled = false;
+
+		uint32_t m_RandomState = 1;
+	};
+}
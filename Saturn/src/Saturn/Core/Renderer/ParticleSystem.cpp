@@ -0,0 +1,116 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#include "sppch.h"
+#include "ParticleSystem.h"
+
+#include "Saturn/Core/JobSystem.h"
+#include "Saturn/Core/OptickProfiler.h"
+
+#include "Saturn/Vulkan/Renderer2D.h"
+
+namespace Saturn {
+
+	void ParticleSystem::Update( std::vector<ParticleEmitterUpdate>& rEmitters, float DeltaTime )
+	{
+		SAT_PF_EVENT();
+
+		JobSystem::Get().ParallelFor( ( uint32_t ) rEmitters.size(), 1, [&]( uint32_t Begin, uint32_t End )
+			{
+				for( uint32_t i = Begin; i < End; i++ )
+				{
+					auto& rUpdate = rEmitters[ i ];
+
+					rUpdate.Visible = rUpdate.pEmitter->Update( *rUpdate.pSettings, rUpdate.Transform, DeltaTime, rUpdate.CameraDistance );
+				}
+			} );
+	}
+
+	uint32_t ParticleSystem::Submit( const std::vector<ParticleEmitterUpdate>& rEmitters )
+	{
+		SAT_PF_EVENT();
+
+		struct ParticleRange
+		{
+			const ParticleEmitterUpdate* pUpdate = nullptr;
+			uint32_t First = 0;
+
+			Renderer2D::QuadRange Quads;
+		};
+
+		std::vector<ParticleRange> Ranges;
+		uint32_t Submitted = 0;
+
+		// Reserving is not thread safe, an emitter may need several ranges when it crosses the end of a buffer.
+		for( const auto& rUpdate : rEmitters )
+		{
+			if( !rUpdate.Visible )
+				continue;
+
+			const uint32_t Count = rUpdate.pEmitter->GetCount();
+
+			for( uint32_t First = 0; First < Count; )
+			{
+				auto Quads = Renderer2D::Get().AllocateQuads( nullptr, Count - First );
+				if( Quads.Count == 0 )
+					break;
+
+				Ranges.push_back( { &rUpdate, First, Quads } );
+
+				First += Quads.Count;
+				Submitted += Quads.Count;
+			}
+		}
+
+		JobSystem::Get().ParallelFor( ( uint32_t ) Ranges.size(), 1, [&]( uint32_t Begin, uint32_t End )
+			{
+				for( uint32_t i = Begin; i < End; i++ )
+				{
+					const auto& rRange = Ranges[ i ];
+					const auto& rSettings = *rRange.pUpdate->pSettings;
+					const ParticleEmitter* pEmitter = rRange.pUpdate->pEmitter;
+
+					for( uint32_t q = 0; q < rRange.Quads.Count; q++ )
+					{
+						const uint32_t Particle = rRange.First + q;
+						const float Age = glm::clamp( pEmitter->GetAge( Particle ), 0.0f, 1.0f );
+						const float Size = glm::mix( rSettings.StartSize, rSettings.EndSize, Age );
+
+						QuadInstance& rQuad = rRange.Quads.pQuads[ q ];
+						rQuad.Position = pEmitter->GetPosition( Particle );
+						rQuad.TextureIndex = rRange.Quads.TextureIndex;
+						rQuad.Color = rSettings.EvaluateColor( Age );
+						rQuad.AxisX = glm::vec4( Size, 0.0f, 0.0f, 1.0f );
+						rQuad.AxisY = glm::vec4( 0.0f, Size, 0.0f, 1.0f );
+					}
+				}
+			} );
+
+		return Submitted;
+	}
+}
@@ -0,0 +1,59 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#pragma once
+
+#include "ParticleEmitter.h"
+
+#include <vector>
+
+namespace Saturn {
+
+	struct ParticleEmitterUpdate
+	{
+		ParticleEmitter* pEmitter = nullptr;
+		const ParticleEmitterSettings* pSettings = nullptr;
+
+		glm::mat4 Transform = glm::mat4( 1.0f );
+		float CameraDistance = 0.0f;
+
+		// Written by Update, false when the emitter is past its cull distance.
+		bool Visible = false;
+	};
+
+	class ParticleSystem
+	{
+	public:
+		// Updates every emitter on the job system, one emitter per job.
+		static void Update( std::vector<ParticleEmitterUpdate>& rEmitters, float DeltaTime );
+
+		// Writes the live particles of every visible emitter into the billboard batches of the 2D renderer.
+		// The quads are reserved in order and then filled on the job system. Returns the number of particles submitted.
+		static uint32_t Submit( const std::vector<ParticleEmitterUpdate>& rEmitters );
+	};
+}
@@ -0,0 +1,167 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+
+namespace Saturn {
+
+	// What SceneRenderer picks LODs and occluders with. DrawListReplay fills it from the capture so a replay makes the same choices as the frame it recorded.
+	struct StaticMeshSelectionSettings
+	{
+		glm::vec3 CameraPosition{};
+		// Pixels per world unit at a distance of one, zero when the projection is not known yet.
+		float ProjectionScale = 0.0f;
+
+		bool EnableLods = true;
+		float LodPixelError = 1.0f;
+		float LodHysteresis = 0.2f;
+
+		bool AutomaticOccluders = true;
+		float OccluderScreenRadius = 128.0f;
+		uint32_t MaxOccluderTriangles = 100000;
+	};
+
+	// LOD selection, occluder selection and draw list building for static submeshes.
+	// Written against anything that looks like a Submesh (BoundingBox, GetLod, GetLodCount, Lods and GetDequantisationMatrix), so the engine's submeshes and the captured ones share the same code.
+	namespace StaticMeshSelection {
+
+		inline float MaxScale( const glm::mat4& rTransform )
+		{
+			return glm::max( glm::length( glm::vec3( rTransform[ 0 ] ) ), glm::max( glm::length( glm::vec3( rTransform[ 1 ] ) ), glm::length( glm::vec3( rTransform[ 2 ] ) ) ) );
+		}
+
+		// PreviousLod is the LOD the instance had last frame, UINT32_MAX when it was not drawn.
+		template<typename SubmeshTy>
+		uint32_t SelectLod( const SubmeshTy& rSubmesh, const glm::mat4& rTransform, uint32_t PreviousLod, const StaticMeshSelectionSettings& rSettings )
+		{
+			if( !rSettings.EnableLods || rSubmesh.Lods.empty() || rSettings.ProjectionScale <= 0.0f )
+				return 0;
+
+			glm::vec3 Center = ( rSubmesh.BoundingBox.Min + rSubmesh.BoundingBox.Max ) * 0.5f;
+			float Radius = glm::length( rSubmesh.BoundingBox.Max - rSubmesh.BoundingBox.Min ) * 0.5f;
+
+			glm::vec3 WorldCenter = glm::vec3( rTransform * glm::vec4( Center, 1.0f ) );
+			float WorldRadius = Radius * MaxScale( rTransform );
+			float Distance = glm::length( WorldCenter - rSettings.CameraPosition );
+
+			// Camera is inside the bounds.
+			if( Distance <= WorldRadius )
+				return 0;
+
+			// LOD errors are relative to the bounding radius, this is the radius on screen in pixels.
+			float ScreenRadius = WorldRadius * rSettings.ProjectionScale / Distance;
+
+			float Threshold = rSettings.LodPixelError;
+			float Hysteresis = rSettings.LodHysteresis;
+
+			// LOD errors always increase, find the coarsest LOD that is under the threshold and the coarsest one that is clearly under it.
+			uint32_t Target = 0;
+			uint32_t Coarser = 0;
+
+			for( uint32_t i = 1; i < rSubmesh.GetLodCount(); i++ )
+			{
+				float PixelError = rSubmesh.GetLod( i ).Error * ScreenRadius;
+
+				if( PixelError <= Threshold )
+					Target = i;
+
+				if( PixelError <= Threshold * ( 1.0f - Hysteresis ) )
+					Coarser = i;
+			}
+
+			uint32_t Lod = Target;
+
+			if( PreviousLod != UINT32_MAX )
+			{
+				Lod = glm::min( PreviousLod, rSubmesh.GetLodCount() - 1 );
+
+				// Only switch to a coarser LOD when it is clearly good enough, and only switch back when the current LOD is clearly too coarse.
+				if( Coarser > Lod )
+					Lod = Coarser;
+				else if( rSubmesh.GetLod( Lod ).Error * ScreenRadius > Threshold * ( 1.0f + Hysteresis ) )
+					Lod = Target;
+			}
+
+			return Lod;
+		}
+
+		// Whether the submesh is rasterised into the occlusion buffer, Marked is set for meshes the user flagged as occluders.
+		// The LOD that was selected for the view is already within a pixel of the full mesh, so that is what gets rasterised.
+		// rOccluderTriangles is what the occluders picked so far use, the submesh is added to it when it is picked.
+		template<typename SubmeshTy>
+		bool SelectOccluder( const SubmeshTy& rSubmesh, uint32_t LodIndex, const glm::mat4& rTransform, bool Marked, uint32_t& rOccluderTriangles, const StaticMeshSelectionSettings& rSettings )
+		{
+			bool Occluder = Marked;
+
+			if( !Occluder && rSettings.AutomaticOccluders && rSettings.ProjectionScale > 0.0f )
+			{
+				float Radius = glm::length( rSubmesh.BoundingBox.Max - rSubmesh.BoundingBox.Min ) * 0.5f;
+
+				glm::vec3 Center = glm::vec3( rTransform * glm::vec4( ( rSubmesh.BoundingBox.Min + rSubmesh.BoundingBox.Max ) * 0.5f, 1.0f ) );
+				float Distance = glm::max( glm::length( Center - rSettings.CameraPosition ), 0.001f );
+
+				Occluder = Radius * MaxScale( rTransform ) * rSettings.ProjectionScale / Distance >= rSettings.OccluderScreenRadius;
+			}
+
+			const uint32_t Triangles = rSubmesh.GetLod( LodIndex ).IndexCount / 3;
+
+			if( !Occluder || rOccluderTriangles + Triangles > rSettings.MaxOccluderTriangles )
+				return false;
+
+			rOccluderTriangles += Triangles;
+
+			return true;
+		}
+
+		// The transform the instance buffer holds for a submesh instance, quantised positions are relative to the submesh bounds.
+		template<typename SubmeshTy>
+		glm::mat4 GetInstanceTransform( const SubmeshTy& rSubmesh, const glm::mat4& rTransform, bool Quantised )
+		{
+			return Quantised ? rTransform * rSubmesh.GetDequantisationMatrix() : rTransform;
+		}
+
+		// Puts a submesh instance into the draw lists: visible instances are drawn, every instance casts shadows.
+		// Culled instances are kept in their own ShadowOnly batch so the visible batch stays contiguous.
+		// rAdd is called with the entry of every list the instance goes into.
+		template<typename KeyTy, typename DrawListTy, typename AddFn>
+		void AddToDrawLists( KeyTy& rKey, bool Visible, DrawListTy& rDrawList, DrawListTy& rShadowDrawList, AddFn&& rAdd )
+		{
+			rKey.ShadowOnly = !Visible;
+
+			if( Visible )
+				rAdd( rDrawList[ rKey ] );
+
+			// Meshes outside of the view can still cast shadows into it.
+			rAdd( rShadowDrawList[ rKey ] );
+		}
+	}
+}
@@ -51,6 +51,7 @@ namespace Saturn::Auxiliary {
 			static std::filesystem::path s_GLTFBinPath = "";
 			static std::filesystem::path s_OriginalMeshPath = "";
 			static bool s_UseBinFile = true;
+			static MeshOptimisationSettings s_OptimisationSettings;
 
 			ImGui::BeginVertical( "##inputv" );
 
@@ -99,6 +100,11 @@ namespace Saturn::Auxiliary {
 				ImGui::EndVertical();
 			}
 
+			if( ImGui::CollapsingHeader( "Optimisation" ) )
+			{
+				DrawMeshOptimisationSettings( s_OptimisationSettings );
+			}
+
 			ImGui::BeginHorizontal( "##actionsH" );
 
 			if( ImGui::Button( "Create" ) )
@@ -130,6 +136,7 @@ namespace Saturn::Auxiliary {
 
 				auto& meshPath = assetPath.replace_extension( s_OriginalMeshPath.extension() );
 				staticMesh->SetFilepath( meshPath.string() );
+				staticMesh->GetOptimisationSettings() = s_OptimisationSettings;
 
 				// Save the mesh asset
 				StaticMeshAssetSerialiser sma;
@@ -167,6 +174,37 @@ namespace Saturn::Auxiliary {
 		return PopupModified;
 	}
 
+	bool DrawMeshOptimisationSettings( MeshOptimisationSettings& rSettings )
+	{
+		bool Changed = false;
+
+		Changed |= ImGui::Checkbox( "Optimise mesh", &rSettings.Enabled );
+
+		Changed |= ImGui::Checkbox( "Weld vertices", &rSettings.WeldVertices );
+		Changed |= ImGui::DragFloat( "Weld epsilon", &rSettings.WeldEpsilon, 0.0001f, 0.0f, 1.0f, "%.5f" );
+
+		Changed |= ImGui::Checkbox( "Vertex cache", &rSettings.OptimiseVertexCache );
+
+		Changed |= ImGui::Checkbox( "Overdraw", &rSettings.OptimiseOverdraw );
+		Changed |= ImGui::DragFloat( "Overdraw threshold", &rSettings.OverdrawThreshold, 0.01f, 1.0f, 3.0f );
+
+		Changed |= ImGui::Checkbox( "Vertex fetch", &rSettings.OptimiseVertexFetch );
+
+		int LodCount = ( int ) rSettings.LodCount;
+		if( ImGui::SliderInt( "LOD count", &LodCount, 0, 8 ) )
+		{
+			rSettings.LodCount = ( uint32_t ) LodCount;
+			Changed = true;
+		}
+
+		Changed |= ImGui::DragFloat( "LOD triangle ratio", &rSettings.LodTriangleRatio, 0.01f, 0.05f, 0.95f );
+		Changed |= ImGui::DragFloat( "LOD target error", &rSettings.LodTargetError, 0.001f, 0.0f, 1.0f, "%.3f" );
+
+		Changed |= ImGui::Checkbox( "Quantise vertices", &rSettings.QuantiseVertices );
+
+		return Changed;
+	}
+
 	bool DrawImportSoundPopup( bool* pOpen, const std::filesystem::path& rImportTargetPath, std::filesystem::path& rDefaultPath )
 	{
 		bool PopupModified = false;
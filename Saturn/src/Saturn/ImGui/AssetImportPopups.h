@@ -30,9 +30,16 @@
 
 #include <filesystem>
 
+namespace Saturn {
+	struct MeshOptimisationSettings;
+}
+
 namespace Saturn::Auxiliary {
 
 	[[nodiscard]] extern bool DrawImportMeshPopup( bool* pOpen, const std::filesystem::path& rImportTargetPath );
 	[[nodiscard]] extern bool DrawImportSoundPopup( bool* pOpen, const std::filesystem::path& rImportTargetPath, std::filesystem::path& rDefaultPath );
 
+	// Returns true if any setting was changed.
+	extern bool DrawMeshOptimisationSettings( MeshOptimisationSettings& rSettings );
+
 }
\ No newline at end of file
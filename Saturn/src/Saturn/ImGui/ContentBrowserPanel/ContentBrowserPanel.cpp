@@ -285,18 +285,7 @@ namespace Saturn {
 				std::filesystem::path path = result;
 
 				if( path.extension() == ".png" || path.extension() == ".tga" || path.extension() == ".jpeg" || path.extension() == ".jpg" )
-				{
-					auto id = AssetManager::Get().CreateAsset( AssetType::Texture );
-
-					auto asset = AssetManager::Get().FindAsset( id );
-
-					std::filesystem::copy_file( path, m_CurrentPath / path.filename() );
-
-					asset->SetAbsolutePath( m_CurrentPath / path.filename() );
-
-					AssetRegistrySerialiser ars;
-					ars.Serialise( AssetManager::Get().GetAssetRegistry() );
-				}
+					ImportTextures( { path } );
 
 				// Meshes
 				if( path.extension() == ".fbx" || path.extension() == ".gltf" )
@@ -315,6 +304,18 @@ namespace Saturn {
 				}
 			}
 
+			if( ImGui::MenuItem( "Texture Folder" ) )
+			{
+				std::filesystem::path folder = Application::Get().OpenFolder();
+
+				if( !folder.empty() && std::filesystem::is_directory( folder ) )
+					ImportTextures( TextureImporter::FindTextures( folder, false ) );
+			}
+
+			ImGui::Separator();
+
+			ImGui::MenuItem( "Resize Textures To Power Of Two", nullptr, &m_TextureImportSettings.ResizeToPowerOfTwo );
+
 			ImGui::EndMenu();
 		}
 
@@ -925,6 +926,35 @@ namespace Saturn {
 	//////////////////////////////////////////////////////////////////////////
 	// POPUPS
 
+	void ContentBrowserPanel::ImportTextures( const std::vector<std::filesystem::path>& rPaths )
+	{
+		if( rPaths.empty() )
+			return;
+
+		std::vector<TextureImportResult> results = TextureImporter::Import( rPaths, m_CurrentPath, m_TextureImportSettings );
+
+		// Assets are created here on the main thread once every texture has been imported.
+		for( const auto& rResult : results )
+		{
+			if( !rResult.Imported )
+				continue;
+
+			// Re-importing a texture overwrites the file, keep the asset (and its ID) that already points at it.
+			const std::filesystem::path RelativePath = std::filesystem::relative( rResult.Destination, Project::GetActiveProject()->GetRootDir() );
+
+			if( AssetManager::Get().FindAsset( RelativePath ) )
+				continue;
+
+			auto id = AssetManager::Get().CreateAsset( AssetType::Texture );
+
+			auto asset = AssetManager::Get().FindAsset( id );
+			asset->SetAbsolutePath( rResult.Destination );
+		}
+
+		AssetRegistrySerialiser ars;
+		ars.Serialise( AssetManager::Get().GetAssetRegistry() );
+	}
+
 	void ContentBrowserPanel::DrawImportSoundPopup() 
 	{
 		if( m_AssetImportType != AssetType::Sound )
@@ -33,6 +33,7 @@
 #include "Saturn/Vulkan/Texture.h"
 
 #include "Saturn/Asset/Asset.h"
+#include "Saturn/Asset/TextureImporter.h"
 
 #include "ContentBrowserItem.h"
 
@@ -95,6 +96,9 @@ namespace Saturn {
 		void DrawImportSoundPopup();
 		void DrawImportMeshPopup();
 
+		// Imports the textures into the current folder in parallel and registers them as texture assets.
+		void ImportTextures( const std::vector<std::filesystem::path>& rPaths );
+
 		void GetContentFiles( bool clear );
 		void GetSourceFiles( bool clear );
 
@@ -121,6 +125,7 @@ namespace Saturn {
 		bool m_ShowAssetImportPopup = false;
 		AssetType m_AssetImportType = AssetType::Unknown;
 		std::filesystem::path m_ImportAssetPath;
+		TextureImportSettings m_TextureImportSettings;
 		
 		// Popup data
 		std::string m_ClassInstanceName;
@@ -0,0 +1,346 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#include "sppch.h"
+#include "InstancePainter.h"
+
+#include "ImGuiAuxiliary.h"
+
+#include "Saturn/Core/Math.h"
+
+#include <glm/gtx/quaternion.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/constants.hpp>
+
+namespace Saturn {
+
+	static constexpr float s_MaxRayDistance = 10000.0f;
+
+	static bool IntersectBounds( const AABB& rBounds, const glm::vec3& rOrigin, const glm::vec3& rDirection, float MaxDistance )
+	{
+		float Near = 0.0f;
+		float Far = MaxDistance;
+
+		for( int Axis = 0; Axis < 3; Axis++ )
+		{
+			if( glm::abs( rDirection[ Axis ] ) < 1e-8f )
+			{
+				if( rOrigin[ Axis ] < rBounds.Min[ Axis ] || rOrigin[ Axis ] > rBounds.Max[ Axis ] )
+					return false;
+
+				continue;
+			}
+
+			float Inverse = 1.0f / rDirection[ Axis ];
+			float T0 = ( rBounds.Min[ Axis ] - rOrigin[ Axis ] ) * Inverse;
+			float T1 = ( rBounds.Max[ Axis ] - rOrigin[ Axis ] ) * Inverse;
+
+			if( T0 > T1 )
+				std::swap( T0, T1 );
+
+			Near = glm::max( Near, T0 );
+			Far = glm::min( Far, T1 );
+
+			if( Near > Far )
+				return false;
+		}
+
+		return true;
+	}
+
+	// Moller-Trumbore, both sides of the triangle are hit.
+	static bool IntersectTriangle( const glm::vec3& rOrigin, const glm::vec3& rDirection, const glm::vec3& rV0, const glm::vec3& rV1, const glm::vec3& rV2, float& rDistance )
+	{
+		glm::vec3 Edge1 = rV1 - rV0;
+		glm::vec3 Edge2 = rV2 - rV0;
+
+		glm::vec3 P = glm::cross( rDirection, Edge2 );
+		float Determinant = glm::dot( Edge1, P );
+
+		if( glm::abs( Determinant ) < 1e-12f )
+			return false;
+
+		float InverseDeterminant = 1.0f / Determinant;
+
+		glm::vec3 T = rOrigin - rV0;
+		float U = glm::dot( T, P ) * InverseDeterminant;
+
+		if( U < 0.0f || U > 1.0f )
+			return false;
+
+		glm::vec3 Q = glm::cross( T, Edge1 );
+		float V = glm::dot( rDirection, Q ) * InverseDeterminant;
+
+		if( V < 0.0f || U + V > 1.0f )
+			return false;
+
+		rDistance = glm::dot( Edge2, Q ) * InverseDeterminant;
+
+		return rDistance > 0.0f;
+	}
+
+	InstancePainter::InstancePainter()
+		: m_Random( std::random_device{}() )
+	{
+	}
+
+	bool InstancePainter::Raycast( Scene* pScene, const glm::vec3& rOrigin, const glm::vec3& rDirection, float MaxDistance, glm::vec3& rPosition, glm::vec3& rNormal )
+	{
+		float Closest = MaxDistance;
+		bool Hit = false;
+
+		for( auto& rEntity : pScene->GetAllEntitiesWith<StaticMeshComponent>() )
+		{
+			const auto& rMesh = rEntity->GetComponent<StaticMeshComponent>().Mesh;
+
+			if( !rMesh || rMesh->Vertices().empty() )
+				continue;
+
+			const glm::mat4 EntityTransform = pScene->GetTransformRelativeToParent( rEntity );
+
+			const auto& rVertices = rMesh->Vertices();
+			const uint32_t* pIndices = reinterpret_cast< const uint32_t* >( rMesh->Indices().data() );
+
+			for( const Submesh& rSubmesh : rMesh->Submeshes() )
+			{
+				const glm::mat4 Transform = EntityTransform * rSubmesh.Transform;
+				const glm::mat4 InverseTransform = glm::inverse( Transform );
+
+				// The direction is not normalised so distances along the ray stay in world units.
+				glm::vec3 Origin = glm::vec3( InverseTransform * glm::vec4( rOrigin, 1.0f ) );
+				glm::vec3 Direction = glm::mat3( InverseTransform ) * rDirection;
+
+				if( !IntersectBounds( rSubmesh.BoundingBox, Origin, Direction, Closest ) )
+					continue;
+
+				for( uint32_t i = 0; i + 2 < rSubmesh.IndexCount; i += 3 )
+				{
+					const uint32_t* pTriangle = pIndices + rSubmesh.BaseIndex + i;
+
+					const glm::vec3& rV0 = rVertices[ rSubmesh.BaseVertex + pTriangle[ 0 ] ].Position;
+					const glm::vec3& rV1 = rVertices[ rSubmesh.BaseVertex + pTriangle[ 1 ] ].Position;
+					const glm::vec3& rV2 = rVertices[ rSubmesh.BaseVertex + pTriangle[ 2 ] ].Position;
+
+					float Distance = 0.0f;
+
+					if( !IntersectTriangle( Origin, Direction, rV0, rV1, rV2, Distance ) || Distance >= Closest )
+						continue;
+
+					Closest = Distance;
+					Hit = true;
+
+					rPosition = rOrigin + rDirection * Distance;
+					rNormal = glm::normalize( glm::transpose( glm::inverse( glm::mat3( Transform ) ) ) * glm::cross( rV1 - rV0, rV2 - rV0 ) );
+
+					if( glm::dot( rNormal, rDirection ) > 0.0f )
+						rNormal = -rNormal;
+				}
+			}
+		}
+
+		return Hit;
+	}
+
+	bool InstancePainter::AddInstance( Scene* pScene, Ref<Entity> Target, const glm::vec3& rPosition, const glm::vec3& rNormal, bool CheckSpacing )
+	{
+		auto& rComponent = Target->GetComponent<InstancedStaticMeshComponent>();
+
+		const glm::mat4 EntityTransform = pScene->GetTransformRelativeToParent( Target );
+
+		if( CheckSpacing && m_Settings.MinSpacing > 0.0f )
+		{
+			for( const auto& rInstance : rComponent.Instances )
+			{
+				if( glm::distance( glm::vec3( EntityTransform * glm::vec4( rInstance.Position, 1.0f ) ), rPosition ) < m_Settings.MinSpacing )
+					return false;
+			}
+		}
+
+		std::uniform_real_distribution<float> Unit( 0.0f, 1.0f );
+
+		float Yaw = m_Settings.RandomYaw ? Unit( m_Random ) * glm::two_pi<float>() : 0.0f;
+		float Scale = glm::mix( m_Settings.MinScale, m_Settings.MaxScale, Unit( m_Random ) );
+
+		glm::quat Rotation = glm::angleAxis( Yaw, TransformComponent::Up );
+
+		if( m_Settings.AlignToNormal )
+			Rotation = glm::rotation( TransformComponent::Up, rNormal ) * Rotation;
+
+		glm::mat4 World = glm::translate( glm::mat4( 1.0f ), rPosition ) * glm::toMat4( Rotation ) * glm::scale( glm::mat4( 1.0f ), glm::vec3( Scale ) );
+
+		// Instances are stored relative to the entity.
+		MeshInstance Instance;
+		Math::DecomposeTransform( glm::inverse( EntityTransform ) * World, Instance.Position, Instance.Rotation, Instance.Scale );
+
+		rComponent.Instances.push_back( Instance );
+
+		return true;
+	}
+
+	uint32_t InstancePainter::EraseInstances( Scene* pScene, Ref<Entity> Target, const glm::vec3& rCenter )
+	{
+		auto& rInstances = Target->GetComponent<InstancedStaticMeshComponent>().Instances;
+
+		const glm::mat4 EntityTransform = pScene->GetTransformRelativeToParent( Target );
+		const size_t Count = rInstances.size();
+
+		std::erase_if( rInstances, [&]( const MeshInstance& rInstance )
+			{
+				return glm::distance( glm::vec3( EntityTransform * glm::vec4( rInstance.Position, 1.0f ) ), rCenter ) < m_Settings.Radius;
+			} );
+
+		return ( uint32_t ) ( Count - rInstances.size() );
+	}
+
+	bool InstancePainter::Stroke( Scene* pScene, Ref<Entity> Target, const glm::vec3& rOrigin, const glm::vec3& rDirection, bool Erase )
+	{
+		if( !Target || !Target->HasComponent<InstancedStaticMeshComponent>() )
+			return false;
+
+		glm::vec3 Position;
+		glm::vec3 Normal;
+
+		if( !Raycast( pScene, rOrigin, rDirection, s_MaxRayDistance, Position, Normal ) )
+			return false;
+
+		// Dabs are spaced by half of the radius along the stroke.
+		if( m_Stroking && glm::distance( Position, m_LastDab ) < m_Settings.Radius * 0.5f )
+			return false;
+
+		m_Stroking = true;
+		m_LastDab = Position;
+
+		bool Changed = false;
+
+		if( Erase )
+		{
+			Changed = EraseInstances( pScene, Target, Position ) > 0;
+		}
+		else
+		{
+			// Pick random points on the disc under the brush and drop them onto the surface.
+			glm::vec3 Tangent = glm::normalize( glm::cross( Normal, glm::abs( Normal.y ) < 0.99f ? TransformComponent::Up : TransformComponent::Right ) );
+			glm::vec3 Bitangent = glm::cross( Normal, Tangent );
+
+			std::uniform_real_distribution<float> Unit( 0.0f, 1.0f );
+
+			for( int i = 0; i < m_Settings.Density; i++ )
+			{
+				float Radius = m_Settings.Radius * glm::sqrt( Unit( m_Random ) );
+				float Angle = Unit( m_Random ) * glm::two_pi<float>();
+
+				glm::vec3 Candidate = Position + ( Tangent * glm::cos( Angle ) + Bitangent * glm::sin( Angle ) ) * Radius;
+
+				glm::vec3 HitPosition;
+				glm::vec3 HitNormal;
+
+				if( Raycast( pScene, Candidate + Normal * m_Settings.Radius, -Normal, m_Settings.Radius * 2.0f, HitPosition, HitNormal ) )
+					Changed |= AddInstance( pScene, Target, HitPosition, HitNormal );
+			}
+		}
+
+		if( Changed )
+			Target->GetComponent<InstancedStaticMeshComponent>().MarkDirty();
+
+		return Changed;
+	}
+
+	uint32_t InstancePainter::Scatter( Scene* pScene, Ref<Entity> Target, float Extent, uint32_t Count )
+	{
+		const glm::vec3 Center = glm::vec3( pScene->GetTransformRelativeToParent( Target )[ 3 ] );
+
+		std::uniform_real_distribution<float> Offset( -Extent, Extent );
+
+		uint32_t Added = 0;
+
+		for( uint32_t i = 0; i < Count; i++ )
+		{
+			glm::vec3 Position = Center + glm::vec3( Offset( m_Random ), 0.0f, Offset( m_Random ) );
+			glm::vec3 Normal = TransformComponent::Up;
+
+			// Nothing below, keep it at the height of the entity.
+			Raycast( pScene, Position + TransformComponent::Up * Extent, -TransformComponent::Up, Extent * 2.0f, Position, Normal );
+
+			if( AddInstance( pScene, Target, Position, Normal, false ) )
+				Added++;
+		}
+
+		if( Added )
+			Target->GetComponent<InstancedStaticMeshComponent>().MarkDirty();
+
+		return Added;
+	}
+
+	bool InstancePainter::DrawSettings( Scene* pScene, Ref<Entity> Target )
+	{
+		auto& rComponent = Target->GetComponent<InstancedStaticMeshComponent>();
+
+		bool Changed = false;
+
+		ImGui::Text( "Instances: %zu", rComponent.Instances.size() );
+
+		if( ImGui::Checkbox( "Paint (hold shift to erase)", &m_Active ) )
+			m_Stroking = false;
+
+		Auxiliary::DrawFloatControl( "Brush Radius", m_Settings.Radius, 0.1f, 100.0f );
+		Auxiliary::DrawIntControl( "Density", m_Settings.Density, 1, 100 );
+		Auxiliary::DrawFloatControl( "Min Spacing", m_Settings.MinSpacing, 0.0f, 50.0f );
+		Auxiliary::DrawFloatControl( "Min Scale", m_Settings.MinScale, 0.01f, 10.0f );
+		Auxiliary::DrawFloatControl( "Max Scale", m_Settings.MaxScale, 0.01f, 10.0f );
+		Auxiliary::DrawBoolControl( "Random Yaw", m_Settings.RandomYaw );
+		Auxiliary::DrawBoolControl( "Align To Normal", m_Settings.AlignToNormal );
+
+		Auxiliary::DrawIntControl( "Scatter Count", m_Settings.ScatterCount, 1, 100000 );
+		Auxiliary::DrawFloatControl( "Scatter Extent", m_Settings.ScatterExtent, 1.0f, 1000.0f );
+
+		if( ImGui::Button( "Add Instance" ) )
+		{
+			rComponent.Instances.emplace_back();
+			rComponent.MarkDirty();
+
+			Changed = true;
+		}
+
+		ImGui::SameLine();
+
+		if( ImGui::Button( "Scatter" ) )
+			Changed |= Scatter( pScene, Target, m_Settings.ScatterExtent, ( uint32_t ) m_Settings.ScatterCount ) > 0;
+
+		ImGui::SameLine();
+
+		if( ImGui::Button( "Clear" ) )
+		{
+			rComponent.Instances.clear();
+			rComponent.MarkDirty();
+
+			Changed = true;
+		}
+
+		return Changed;
+	}
+}
@@ -0,0 +1,100 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#pragma once
+
+#include "Saturn/Scene/Entity.h"
+#include "Saturn/Scene/Scene.h"
+
+#include <glm/glm.hpp>
+
+#include <random>
+
+namespace Saturn {
+
+	// Editor brush that places instances of an InstancedStaticMeshComponent onto the static meshes of the scene.
+	// Rays are tested against the CPU copy of the mesh triangles so painting works without the physics scene.
+	class InstancePainter
+	{
+	public:
+		struct Settings
+		{
+			float Radius = 5.0f;
+
+			// Instances that are tried per dab.
+			int Density = 8;
+
+			// No instance is added closer than this to another one.
+			float MinSpacing = 1.0f;
+
+			float MinScale = 0.8f;
+			float MaxScale = 1.2f;
+
+			bool RandomYaw = true;
+			bool AlignToNormal = false;
+
+			// Used by Scatter, the extent is the half size of the square around the entity.
+			int ScatterCount = 1000;
+			float ScatterExtent = 50.0f;
+		};
+
+	public:
+		InstancePainter();
+		~InstancePainter() = default;
+
+		// Brush settings and the buttons that add instances, returns true when the instances changed.
+		bool DrawSettings( Scene* pScene, Ref<Entity> Target );
+
+		// Called every frame while the mouse is held in the viewport, returns true when the instances changed.
+		bool Stroke( Scene* pScene, Ref<Entity> Target, const glm::vec3& rOrigin, const glm::vec3& rDirection, bool Erase );
+		void EndStroke() { m_Stroking = false; }
+
+		bool IsActive() const { return m_Active; }
+		void SetActive( bool Active ) { m_Active = Active; m_Stroking = false; }
+
+		// Drops Count instances at random points around the entity onto the meshes below.
+		uint32_t Scatter( Scene* pScene, Ref<Entity> Target, float Extent, uint32_t Count );
+
+		// Closest hit of the ray with the static meshes of the scene.
+		static bool Raycast( Scene* pScene, const glm::vec3& rOrigin, const glm::vec3& rDirection, float MaxDistance, glm::vec3& rPosition, glm::vec3& rNormal );
+
+	private:
+		// Spacing is checked against every instance, Scatter skips it so large counts stay fast.
+		bool AddInstance( Scene* pScene, Ref<Entity> Target, const glm::vec3& rPosition, const glm::vec3& rNormal, bool CheckSpacing = true );
+		uint32_t EraseInstances( Scene* pScene, Ref<Entity> Target, const glm::vec3& rCenter );
+
+	private:
+		Settings m_Settings;
+
+		bool m_Active = false;
+		bool m_Stroking = false;
+		glm::vec3 m_LastDab{};
+
+		std::mt19937 m_Random;
+	};
+}
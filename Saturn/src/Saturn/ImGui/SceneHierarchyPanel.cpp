@@ -208,6 +208,8 @@ namespace Saturn {
 		{
 			DrawAddComponents<StaticMeshComponent>( "Static Mesh", m_SelectionContexts[ 0 ] );
 
+			DrawAddComponents<InstancedStaticMeshComponent>( "Instanced Static Mesh", m_SelectionContexts[ 0 ] );
+
 			DrawAddComponents<ScriptComponent>( "Script", m_SelectionContexts[ 0 ] );
 
 			DrawAddComponents<CameraComponent>( "Camera", m_SelectionContexts[ 0 ] );
@@ -232,6 +234,8 @@ namespace Saturn {
 			
 			DrawAddComponents<AudioListenerComponent>( "Audio Listener", m_SelectionContexts[ 0 ] );
 
+			DrawAddComponents<ParticleEmitterComponent>( "Particle Emitter", m_SelectionContexts[ 0 ] );
+
 			ImGui::EndPopup();
 		}
 	}
@@ -414,6 +418,42 @@ namespace Saturn {
 
 			modified |= Auxiliary::DrawVec3Control( "Scale", tc.Scale, 1.0f );
 
+			// Static and stationary entities are never expected to move at runtime, so their transforms, physics bodies and shadows can be cached.
+			ImGui::Columns( 2 );
+			ImGui::SetColumnWidth( 0, 100.0f );
+
+			ImGui::Text( "Mobility" );
+
+			ImGui::NextColumn();
+
+			if( ImGui::BeginCombo( "##mobility", MobilityToString( tc.Mobility ) ) )
+			{
+				constexpr Mobility Values[] = { Mobility::Static, Mobility::Stationary, Mobility::Movable };
+
+				for( Mobility Value : Values )
+				{
+					bool IsSelected = tc.Mobility == Value;
+
+					if( ImGui::Selectable( MobilityToString( Value ), IsSelected ) )
+					{
+						tc.Mobility = Value;
+						modified = true;
+					}
+
+					if( IsSelected )
+						ImGui::SetItemDefaultFocus();
+				}
+
+				ImGui::EndCombo();
+			}
+
+			ImGui::Columns( 1 );
+
+			if( m_Context->WasMovedAtRuntime( entity->GetUUID() ) )
+			{
+				ImGui::TextColored( ImVec4( 1.0f, 0.8f, 0.0f, 1.0f ), "This entity is %s but was moved at runtime.", MobilityToString( tc.Mobility ) );
+			}
+
 			if( modified ) m_Context->MarkDirty();
 		} );
 
@@ -500,6 +540,54 @@ namespace Saturn {
 			ImGui::PopItemWidth();
 			ImGui::NextColumn();
 
+			modified |= Auxiliary::DrawBoolControl( "Occluder", mc.Occluder );
+
+			if( modified ) m_Context->MarkDirty();
+		} );
+
+		DrawComponent<InstancedStaticMeshComponent>( "Instanced Static Mesh", entity, [&]( auto& imc )
+		{
+			bool modified = false;
+			bool open = false;
+
+			ImGui::Columns( 3 );
+			ImGui::SetColumnWidth( 0, 100 );
+			ImGui::SetColumnWidth( 1, 300 );
+			ImGui::SetColumnWidth( 2, 40 );
+			ImGui::Text( "File Path" );
+			ImGui::NextColumn();
+			ImGui::PushItemWidth( -1 );
+
+			if( Auxiliary::ImageButton( EditorIcons::GetIcon( "Inspect" ), ImVec2( 24, 24 ) ) )
+			{
+				open = !open;
+				m_CurrentFinderType = AssetType::StaticMesh;
+
+				if( imc.Mesh )
+					m_CurrentAssetID = imc.Mesh->ID;
+			}
+
+			ImGui::SameLine();
+
+			if( imc.Mesh )
+				ImGui::InputText( "##instancedmeshfilepath", ( char* ) imc.Mesh->Name.c_str(), 256, ImGuiInputTextFlags_ReadOnly );
+			else
+				ImGui::InputText( "##instancedmeshfilepath", ( char* ) "", 256, ImGuiInputTextFlags_ReadOnly );
+
+			if( Auxiliary::DrawAssetFinder( m_CurrentFinderType, &open, m_CurrentAssetID ) && m_CurrentFinderType == AssetType::StaticMesh )
+			{
+				imc.Mesh = AssetManager::Get().GetAssetAs<StaticMesh>( m_CurrentAssetID );
+				imc.MarkDirty();
+
+				modified = true;
+			}
+
+			ImGui::PopItemWidth();
+			ImGui::Columns( 1 );
+
+			modified |= Auxiliary::DrawBoolControl( "Cast Shadows", imc.CastShadows );
+			modified |= m_InstancePainter.DrawSettings( m_Context.Get(), entity );
+
 			if( modified ) m_Context->MarkDirty();
 		} );
 
@@ -943,6 +1031,78 @@ namespace Saturn {
 
 			if( modified ) m_Context->MarkDirty();
 		} );
+
+		DrawComponent<ParticleEmitterComponent>( "Particle Emitter", entity, [&]( auto& pec )
+		{
+			bool modified = false;
+			auto& rSettings = pec.Settings;
+
+			int maxParticles = ( int ) rSettings.MaxParticles;
+
+			modified =  Auxiliary::DrawFloatControl( "Spawn Rate", rSettings.SpawnRate, 0.0f, 10000.0f );
+
+			if( Auxiliary::DrawIntControl( "Budget", maxParticles, 0, 100000 ) )
+			{
+				rSettings.MaxParticles = ( uint32_t ) std::max( maxParticles, 0 );
+				modified = true;
+			}
+
+			modified |= Auxiliary::DrawFloatControl( "Min Lifetime", rSettings.MinLifetime, 0.0f, 60.0f );
+			modified |= Auxiliary::DrawFloatControl( "Max Lifetime", rSettings.MaxLifetime, 0.0f, 60.0f );
+			modified |= Auxiliary::DrawFloatControl( "Spawn Radius", rSettings.SpawnRadius, 0.0f, 100.0f );
+			modified |= Auxiliary::DrawVec3Control( "Min Velocity", rSettings.MinVelocity );
+			modified |= Auxiliary::DrawVec3Control( "Max Velocity", rSettings.MaxVelocity );
+			modified |= Auxiliary::DrawVec3Control( "Gravity", rSettings.Gravity );
+			modified |= Auxiliary::DrawFloatControl( "Drag", rSettings.Drag, 0.0f, 10.0f );
+			modified |= Auxiliary::DrawFloatControl( "Start Size", rSettings.StartSize, 0.0f, 100.0f );
+			modified |= Auxiliary::DrawFloatControl( "End Size", rSettings.EndSize, 0.0f, 100.0f );
+			modified |= Auxiliary::DrawFloatControl( "Throttle Distance", rSettings.ThrottleDistance, 0.0f, 10000.0f );
+			modified |= Auxiliary::DrawFloatControl( "Cull Distance", rSettings.CullDistance, 0.0f, 10000.0f );
+
+			ImGui::Text( "Colour over lifetime" );
+
+			for( size_t i = 0; i < rSettings.ColorKeys.size(); )
+			{
+				auto& rKey = rSettings.ColorKeys[ i ];
+
+				ImGui::PushID( ( int ) i );
+
+				ImGui::SetNextItemWidth( 60.0f );
+				modified |= ImGui::DragFloat( "##Time", &rKey.Time, 0.01f, 0.0f, 1.0f );
+				ImGui::SameLine();
+				modified |= ImGui::ColorEdit4( "##Color", &rKey.Color.x, ImGuiColorEditFlags_NoInputs );
+				ImGui::SameLine();
+
+				bool remove = ImGui::Button( "-" );
+
+				ImGui::PopID();
+
+				if( remove )
+				{
+					rSettings.ColorKeys.erase( rSettings.ColorKeys.begin() + i );
+					modified = true;
+				}
+				else
+				{
+					i++;
+				}
+			}
+
+			if( ImGui::Button( "Add Colour Key" ) )
+			{
+				rSettings.ColorKeys.push_back( { 1.0f, glm::vec4( 1.0f ) } );
+				modified = true;
+			}
+
+			if( modified )
+			{
+				std::sort( rSettings.ColorKeys.begin(), rSettings.ColorKeys.end(), []( const ParticleColorKey& a, const ParticleColorKey& b ) { return a.Time < b.Time; } );
+
+				m_Context->MarkDirty();
+			}
+
+			ImGui::Text( "Live particles: %u", m_Context->GetParticleCount( entity->GetUUID() ) );
+		} );
 	}
 
 	template<typename T, typename UIFunction>
@@ -33,6 +33,7 @@
 #include "Saturn/Scene/Scene.h"
 
 #include "Panel/Panel.h"
+#include "InstancePainter.h"
 #include "Saturn/Vulkan/Texture.h"
 
 #include <functional>
@@ -84,6 +85,8 @@ namespace Saturn {
 
 		void SetIsPrefabScene( bool value ) { m_IsPrefabScene = value; }
 
+		InstancePainter& GetInstancePainter() { return m_InstancePainter; }
+
 		void AddID( UUID ID ) { m_CustomID = ID; }
 		void SetName( const std::string& rName ) { m_WindowName = rName; }
 
@@ -122,6 +125,7 @@ namespace Saturn {
 		};
 
 		CopyComponentData m_CopyComponentData{};
+		InstancePainter m_InstancePainter;
 		ImGuiTextFilter m_EntityTextFilter{};
 		bool m_Searching = false;
 
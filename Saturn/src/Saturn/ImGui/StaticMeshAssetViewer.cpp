@@ -35,6 +35,7 @@
 #include "Saturn/Vulkan/SceneRenderer.h"
 
 #include "Saturn/ImGui/ImGuiAuxiliary.h"
+#include "Saturn/ImGui/AssetImportPopups.h"
 #include "Saturn/Scene/Components.h"
 
 #include "Saturn/Physics/PhysicsCooking.h"
@@ -181,6 +182,68 @@ namespace Saturn {
 			Auxiliary::EndTreeNode();
 		}
 
+		if( Auxiliary::TreeNode( "Optimisation" ) )
+		{
+			const auto& rReport = m_Mesh->GetOptimisationReport();
+
+			ImGui::Columns( 3 );
+
+			ImGui::Text( "" );
+			ImGui::NextColumn();
+			ImGui::Text( "Before" );
+			ImGui::NextColumn();
+			ImGui::Text( "After" );
+			ImGui::NextColumn();
+
+			ImGui::Text( "ACMR" );
+			ImGui::NextColumn();
+			ImGui::Text( "%.3f", rReport.Before.ACMR );
+			ImGui::NextColumn();
+			ImGui::Text( "%.3f", rReport.After.ACMR );
+			ImGui::NextColumn();
+
+			ImGui::Text( "ATVR" );
+			ImGui::NextColumn();
+			ImGui::Text( "%.3f", rReport.Before.ATVR );
+			ImGui::NextColumn();
+			ImGui::Text( "%.3f", rReport.After.ATVR );
+			ImGui::NextColumn();
+
+			ImGui::Text( "Vertices" );
+			ImGui::NextColumn();
+			ImGui::Text( "%u", rReport.Before.Vertices );
+			ImGui::NextColumn();
+			ImGui::Text( "%u", rReport.After.Vertices );
+			ImGui::NextColumn();
+
+			ImGui::Columns( 1 );
+
+			ImGui::Text( "Vertex buffer: %.2f KB (%s)", ( float ) m_Mesh->GetVertexBufferSize() / 1024.0f, m_Mesh->IsQuantised() ? "Quantised" : "Full precision" );
+
+			// Settings are only used when the mesh is imported.
+			Auxiliary::DrawMeshOptimisationSettings( m_Mesh->GetOptimisationSettings() );
+
+			ImGui::Text( "Save and reload the project to apply optimisation changes." );
+
+			Auxiliary::EndTreeNode();
+		}
+
+		if( Auxiliary::TreeNode( "LODs" ) )
+		{
+			for( const auto& rSubmesh : m_Mesh->Submeshes() )
+			{
+				ImGui::Text( "%s", rSubmesh.MeshName.c_str() );
+
+				for( uint32_t i = 0; i < rSubmesh.GetLodCount(); i++ )
+				{
+					SubmeshLod Lod = rSubmesh.GetLod( i );
+					ImGui::BulletText( "LOD %u: %u triangles, error %.4f", i, Lod.IndexCount / 3, Lod.Error );
+				}
+			}
+
+			Auxiliary::EndTreeNode();
+		}
+
 		ImGui::End();
 
 		ImGui::Begin( "##Toolbar" );
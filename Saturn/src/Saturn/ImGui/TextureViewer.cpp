@@ -30,6 +30,9 @@
 #include "TextureViewer.h"
 
 #include "Saturn/Asset/AssetManager.h"
+#include "Saturn/Project/Project.h"
+#include "Saturn/Vulkan/VulkanContext.h"
+#include "Saturn/Vulkan/TextureStreamer.h"
 
 #include "ImGuiAuxiliary.h"
 
@@ -75,6 +78,31 @@ namespace Saturn {
 		ImGui::Text( "Texture Size" );
 		ImGui::InputText( "##textureSize", ( char* ) sizeText.c_str(), sizeText.size(), ImGuiInputTextFlags_ReadOnly );
 
+		ImGui::Spring();
+
+		// The viewer has its own copy of the texture, the one materials sample is the streamed one.
+		TextureStreamer* pStreamer = VulkanContext::Get().GetTextureStreamer();
+		Ref<Texture2D> streamed = pStreamer ? pStreamer->FindTexture( Project::GetActiveProject()->FilepathAbs( m_Asset->Path ) ) : nullptr;
+
+		std::string mipText;
+
+		if( streamed )
+		{
+			uint32_t residentMip = streamed->GetResidentMip();
+
+			mipText = std::format( "{0} mips, resident from {1} ({2}x{3}, {4:.2f} MB), requested {5}",
+				streamed->GetMipCount(), residentMip,
+				std::max( streamed->Width() >> residentMip, 1 ), std::max( streamed->Height() >> residentMip, 1 ),
+				( float ) streamed->GetResidentSize() / ( 1024.0f * 1024.0f ), streamed->GetRequestedMip() );
+		}
+		else
+		{
+			mipText = std::format( "{0} mips, fully resident (not streamed)", m_Texture->GetMipCount() );
+		}
+
+		ImGui::Text( "Mip Residency" );
+		ImGui::InputText( "##textureMips", ( char* ) mipText.c_str(), mipText.size(), ImGuiInputTextFlags_ReadOnly );
+
 		ImGui::EndVertical();
 
 		ImGui::EndHorizontal();
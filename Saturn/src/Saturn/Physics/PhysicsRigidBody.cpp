@@ -40,6 +40,16 @@ namespace Saturn {
 		TransformComponent& tc = entity->GetComponent<TransformComponent>();
 		RigidbodyComponent& rb = entity->GetComponent<RigidbodyComponent>();
 
+		m_Static = HasFixedTransform( tc.Mobility );
+
+		if( m_Static )
+		{
+			m_Actor = PhysicsFoundation::Get().GetPhysics().createRigidStatic( Auxiliary::GLMTransformToPx( tc.GetTransform() ) );
+			m_Actor->setActorFlag( physx::PxActorFlag::eVISUALIZATION, true );
+
+			return;
+		}
+
 		physx::PxRigidDynamic* pBody = PhysicsFoundation::Get().GetPhysics().createRigidDynamic( Auxiliary::GLMTransformToPx( tc.GetTransform() ) );
 		
 		m_Actor = pBody;
@@ -104,7 +114,7 @@ namespace Saturn {
 				// PhysX requires all non-kinematic dynamic rigid bodies with the flag eSIMULATION_SHAPE to be kinematic.
 				auto& rb = m_Entity->GetComponent<RigidbodyComponent>();
 				
-				if( !rb.IsKinematic )
+				if( !rb.IsKinematic && !m_Static )
 				{
 					SAT_CORE_WARN( "PhysX requires all non-kinematic dynamic rigid bodies with the flag eSIMULATION_SHAPE to be kinematic!" );
 					SAT_CORE_WARN( "This happened because you are using a Triangle mesh shape!" );
@@ -156,6 +166,9 @@ namespace Saturn {
 
 	void PhysicsRigidBody::SetKinematic( bool val )
 	{
+		if( m_Static )
+			return;
+
 		physx::PxRigidDynamic* pBody = ( physx::PxRigidDynamic* ) m_Actor;
 		pBody->setRigidBodyFlag( physx::PxRigidBodyFlag::eKINEMATIC, val );
 
@@ -164,24 +177,36 @@ namespace Saturn {
 
 	void PhysicsRigidBody::SetMass( float val )
 	{
+		if( m_Static )
+			return;
+
 		physx::PxRigidDynamic* pBody = ( physx::PxRigidDynamic* ) m_Actor;
 		pBody->setMass( val );
 	}
 
 	void PhysicsRigidBody::SetLinearDrag( float value )
 	{
+		if( m_Static )
+			return;
+
 		physx::PxRigidDynamic* pBody = ( physx::PxRigidDynamic* ) m_Actor;
 		pBody->setLinearDamping( value );
 	}
 
 	float PhysicsRigidBody::GetLinearDrag()
 	{
+		if( m_Static )
+			return 0.0f;
+
 		physx::PxRigidDynamic* pBody = ( physx::PxRigidDynamic* ) m_Actor;
 		return pBody->getLinearDamping();
 	}
 
 	void PhysicsRigidBody::ApplyForce( glm::vec3 ForceAmount, ForceMode Type )
 	{
+		if( m_Static )
+			return;
+
 		physx::PxRigidDynamic* pBody = ( physx::PxRigidDynamic* ) m_Actor;
 
 		pBody->addForce( Auxiliary::GLMToPx( ForceAmount ), ( physx::PxForceMode::Enum ) Type );
@@ -260,6 +285,9 @@ namespace Saturn {
 		else
 			m_LockFlags &= ~flags;
 
+		if( m_Static )
+			return;
+
 		physx::PxRigidDynamic* pBody = ( physx::PxRigidDynamic* ) m_Actor;
 
 		pBody->setRigidDynamicLockFlag( ( physx::PxRigidDynamicLockFlag::Enum ) flags, value );
@@ -55,6 +55,9 @@ namespace Saturn {
 
 		bool IsKiniematic() { return m_Kinematic; }
 
+		// Static and stationary entities use a static actor, these never move and have no mass or forces.
+		bool IsStatic() const { return m_Static; }
+
 		glm::vec3 GetPosition();
 		glm::vec3 GetRotation();
 		glm::mat4 GetTransform();
@@ -84,6 +87,7 @@ namespace Saturn {
 		Ref<Entity> m_Entity;
 
 		bool m_Kinematic = false;
+		bool m_Static = false;
 
 		Ref<PhysicsShape> m_Shape;
 
@@ -114,6 +114,8 @@ namespace Saturn {
 
 		auto rView = m_Scene->GetAllEntitiesWith<RigidbodyComponent>();
 
+		std::vector<physx::PxRigidActor*> StaticActors;
+
 		for( auto& rEntity : rView )
 		{
 			auto& rb = rEntity->GetComponent<RigidbodyComponent>();
@@ -121,8 +123,27 @@ namespace Saturn {
 			rb.Rigidbody = new PhysicsRigidBody( rEntity );
 			rb.Rigidbody->CreateShape();
 
-			// Maybe we could use addActors?
-			AddToScene( rb.Rigidbody->GetActor() );
+			if( rb.Rigidbody->IsStatic() )
+				StaticActors.push_back( &rb.Rigidbody->GetActor() );
+			else
+				AddToScene( rb.Rigidbody->GetActor() );
+		}
+
+		// Static actors never move, build their scene query tree once up front instead of inserting them one by one into the tree that is refit every frame.
+		if( StaticActors.size() )
+		{
+			physx::PxPruningStructure* pPruningStructure = PhysicsFoundation::Get().GetPhysics().createPruningStructure( StaticActors.data(), ( physx::PxU32 ) StaticActors.size() );
+
+			if( pPruningStructure )
+			{
+				m_PhysicsScene->addActors( *pPruningStructure );
+				pPruningStructure->release();
+			}
+			else
+			{
+				for( auto* pActor : StaticActors )
+					AddToScene( *pActor );
+			}
 		}
 	}
 
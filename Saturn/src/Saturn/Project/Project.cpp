@@ -40,6 +40,9 @@
 #include "Saturn/Core/StringAuxiliary.h"
 #include "Saturn/Core/Process.h"
 
+#include "Saturn/Vulkan/VulkanContext.h"
+#include "Saturn/Vulkan/PipelineCache.h"
+
 #include "SharedGlobals.h"
 
 namespace Saturn {
@@ -82,7 +85,16 @@ namespace Saturn {
 
 	void Project::SetActiveProject( const Ref<Project>& rProject )
 	{
+		PipelineCache* pPipelineCache = VulkanContext::Get().GetPipelineCache();
+
+		// Keep what the old project compiled before its cache path goes away.
+		if( pPipelineCache && s_ActiveProject )
+			pPipelineCache->Save( PipelineCache::GetProjectCachePath() );
+
 		s_ActiveProject = rProject;
+
+		if( pPipelineCache && s_ActiveProject )
+			pPipelineCache->Merge( PipelineCache::GetProjectCachePath() );
 	}
 
 	std::filesystem::path Project::FindProjectDir( const std::string& rName )
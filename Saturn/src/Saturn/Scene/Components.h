@@ -37,12 +37,15 @@
 #include "Saturn/Core/Math.h"
 
 #include "Saturn/Vulkan/Mesh.h"
+#include "Saturn/Vulkan/InstanceClusterTree.h"
 
 #include "Saturn/Core/UUID.h"
 
 #include "EntityVisibility.h"
+#include "EntityMobility.h"
 
 #include "Saturn/Core/Renderer/SceneCamera.h"
+#include "Saturn/Core/Renderer/ParticleEmitter.h"
 
 #include <string>
 
@@ -62,6 +65,8 @@ namespace Saturn {
 		glm::vec3  Position ={ 0.0f , 0.0f, 0.0f };
 		glm::vec3  Scale	={ 1.0f , 1.0f, 1.0f };
 
+		Saturn::Mobility Mobility = Saturn::Mobility::Movable;
+
 		static constexpr glm::vec3 Up ={ 0.0f, 1.0f, 0.0f };
 		static constexpr glm::vec3 Right ={ 1.0f, 0.0f, 0.0f };
 		static constexpr glm::vec3 Forward ={ 0.0f, 0.0f, -1.0f };
@@ -144,6 +149,12 @@ namespace Saturn {
 		// We always want to store our own material registry because there will be one in the asset however that is global for all of the same meshes in the scene and what if we want to just locally change one asset.
 		Ref<Saturn::MaterialRegistry> MaterialRegistry;
 
+		// Always rasterise this mesh into the occlusion buffer so that it can hide the meshes behind it (i.e. walls and floors).
+		bool Occluder = false;
+
+		// Not serialised, set when the mesh was merged into the scene's static geometry while the asset bundle was built. The merged geometry draws it instead.
+		bool Merged = false;
+
 		StaticMeshComponent() = default;
 		StaticMeshComponent( const StaticMeshComponent& other ) = default;
 		StaticMeshComponent( Ref<Saturn::StaticMesh>& rMesh )
@@ -152,6 +163,33 @@ namespace Saturn {
 		operator Ref<Saturn::StaticMesh>() { return Mesh; }
 	};
 
+	// Draws one mesh many times from a single entity (i.e. foliage and debris), instances are culled per cluster and rendered with the mesh's materials.
+	struct InstancedStaticMeshComponent
+	{
+		Ref<Saturn::StaticMesh> Mesh;
+
+		// Relative to the entity.
+		std::vector<MeshInstance> Instances;
+
+		bool CastShadows = true;
+
+		// Not serialised, built from the instances when the mesh is rendered.
+		Ref<InstanceClusterTree> Clusters;
+		bool ClustersDirty = true;
+
+		// Must be called after the instances have been changed.
+		void MarkDirty() { ClustersDirty = true; }
+
+		void UpdateClusters()
+		{
+			if( !ClustersDirty && Clusters && Clusters->GetMeshID() == Mesh->ID )
+				return;
+
+			Clusters = Ref<InstanceClusterTree>::Create( Mesh, Instances );
+			ClustersDirty = false;
+		}
+	};
+
 	struct DirectionalLightComponent
 	{
 		glm::vec3 Radiance = { 1.0f, 1.0f, 1.0f };
@@ -309,6 +347,14 @@ namespace Saturn {
 		BillboardComponent( UUID id ) : AssetID( id ) {  }
 	};
 
+	struct ParticleEmitterComponent
+	{
+		ParticleEmitterSettings Settings;
+
+		ParticleEmitterComponent() = default;
+		ParticleEmitterComponent( const ParticleEmitterComponent& other ) = default;
+	};
+
 	template<typename... V>
 	struct ComponentGroup {};
 
@@ -323,11 +369,11 @@ namespace Saturn {
 	};
 
 	using AllComponents = ComponentGroup<TransformComponent, TagComponent, IdComponent, RelationshipComponent, PrefabComponent,
-		StaticMeshComponent, 
+		StaticMeshComponent, InstancedStaticMeshComponent,
 		DirectionalLightComponent, SkylightComponent, PointLightComponent,
 		CameraComponent,
 		BoxColliderComponent, SphereColliderComponent, CapsuleColliderComponent, MeshColliderComponent, RigidbodyComponent,
 		ScriptComponent, 
 		AudioPlayerComponent, AudioListenerComponent,
-		BillboardComponent>;
+		BillboardComponent, ParticleEmitterComponent>;
 }
\ No newline at end of file
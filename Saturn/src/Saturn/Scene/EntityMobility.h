@@ -0,0 +1,65 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#pragma once
+
+namespace Saturn {
+
+	// How an entity is allowed to change at runtime, systems use this to cache work for things that never move.
+	// The values are serialised, so new values must be added at the end.
+	enum class Mobility
+	{
+		// The transform never changes once the scene is running, i.e. level geometry.
+		// World transforms and physics bodies are built once and the shadow maps cache it.
+		Static = 0,
+		// Anything can change at any time.
+		Movable = 1,
+		// The transform never changes but everything else can, e.g. a lamp that can be switched off or a door frame that can be hidden.
+		// Same as static except it is not baked into the static shadow cache.
+		Stationary = 2
+	};
+
+	inline const char* MobilityToString( Mobility Value )
+	{
+		switch( Value )
+		{
+			case Mobility::Static:     return "Static";
+			case Mobility::Stationary: return "Stationary";
+			case Mobility::Movable:    return "Movable";
+		}
+
+		return "Unknown";
+	}
+
+	// Static and stationary entities never move at runtime.
+	inline bool HasFixedTransform( Mobility Value )
+	{
+		return Value != Mobility::Movable;
+	}
+
+}
@@ -31,6 +31,7 @@
 
 #include "Entity.h"
 #include "Components.h"
+#include "StaticGeometryMerger.h"
 
 #include "Saturn/Vulkan/SceneRenderer.h"
 #include "Saturn/Vulkan/Renderer2D.h"
@@ -43,6 +44,7 @@
 #include "Saturn/Core/VirtualFS.h"
 #include "Saturn/Core/MemoryStream.h"
 #include "Saturn/Core/Renderer/SceneFlyCamera.h"
+#include "Saturn/Core/Renderer/ParticleSystem.h"
 
 #include "Saturn/Physics/PhysicsScene.h"
 #include "Saturn/Physics/PhysicsRigidBody.h"
@@ -124,6 +126,8 @@ namespace Saturn {
 
 		m_EntityIDMap.clear();
 		m_Registry.clear();
+
+		m_ParticleEmitters.clear();
 	}
 
 	// TODO: We don't want to search for the main camera entity every frame.
@@ -195,6 +199,10 @@ namespace Saturn {
 				entity->OnUpdate( ts );
 			}
 
+#if !defined(SAT_DIST)
+			ValidateFixedTransforms();
+#endif
+
 			UpdateAudioListeners();
 		}
 	}
@@ -214,6 +222,11 @@ namespace Saturn {
 		for( auto& entity : rigidBodies )
 		{
 			auto& rb = entity->GetComponent<RigidbodyComponent>();
+
+			// Static bodies are never moved by the simulation.
+			if( rb.Rigidbody->IsStatic() )
+				continue;
+
 			rb.Rigidbody->SyncTransfrom();
 		}
 	}
@@ -225,6 +238,8 @@ namespace Saturn {
 		m_RendererCamera.Camera = rCamera;
 		m_RendererCamera.ViewMatrix = rCamera.ViewMatrix();
 
+		// Set the camera before submitting meshes, LODs are selected when meshes are submitted.
+		rSceneRenderer.SetCamera( m_RendererCamera );
 		Renderer2D::Get().SetCamera( m_RendererCamera );
 		Renderer2D::Get().PreRender();
 
@@ -365,19 +380,37 @@ namespace Saturn {
 
 				auto transform = GetTransformRelativeToParent( entity );
 
-				if( meshComponent.Mesh )
+				if( meshComponent.Mesh && !meshComponent.Merged )
 				{
 					Ref<MaterialRegistry> targetMaterialRegistry = meshComponent.Mesh->GetMaterialRegistry();
 			
 					if( meshComponent.MaterialRegistry && meshComponent.MaterialRegistry->HasAnyOverrides() )
 						targetMaterialRegistry = meshComponent.MaterialRegistry;
 
-					rSceneRenderer.SubmitStaticMesh( entity, meshComponent.Mesh, targetMaterialRegistry, transform );
+					rSceneRenderer.SubmitStaticMesh( entity, meshComponent.Mesh, targetMaterialRegistry, transform, meshComponent.Occluder, entity->GetComponent<TransformComponent>().Mobility );
 				}
 			}
 		}
 
-		rSceneRenderer.SetCamera( m_RendererCamera );
+		// Instanced static meshes
+		{
+			auto entities = GetAllEntitiesWith<InstancedStaticMeshComponent>();
+
+			for( auto& entity : entities )
+			{
+				auto& rInstancedMesh = entity->GetComponent<InstancedStaticMeshComponent>();
+
+				if( !rInstancedMesh.Mesh || rInstancedMesh.Instances.empty() )
+					continue;
+
+				rInstancedMesh.UpdateClusters();
+
+				rSceneRenderer.SubmitInstancedStaticMesh( entity, rInstancedMesh.Mesh, rInstancedMesh.Mesh->GetMaterialRegistry(), rInstancedMesh.Clusters, GetTransformRelativeToParent( entity ), rInstancedMesh.CastShadows, entity->GetComponent<TransformComponent>().Mobility );
+			}
+		}
+
+		// Particles
+		UpdateParticles( ts );
 	}
 
 	void Scene::OnRenderRuntime( Timestep ts, SceneRenderer& rSceneRenderer )
@@ -434,6 +467,26 @@ namespace Saturn {
 			}
 		}
 
+		// Check twice because we are always going to have to set the projection
+		if( m_MainCameraEntity )
+		{
+			auto& rCamera = m_MainCameraEntity->GetComponent<CameraComponent>().Camera;
+			rCamera.SetViewportSize( rSceneRenderer.Width(), rSceneRenderer.Height() );
+			auto view = glm::inverse( GetTransformRelativeToParent( m_MainCameraEntity ) );
+			
+			m_RendererCamera.Camera = rCamera;
+			m_RendererCamera.ViewMatrix = view;
+		}
+		else
+		{
+			// TODO:
+		}
+
+		// Set the camera before submitting meshes, LODs are selected when meshes are submitted.
+		rSceneRenderer.SetCamera( m_RendererCamera );
+		Renderer2D::Get().SetCamera( m_RendererCamera );
+		Renderer2D::Get().PreRender();
+
 		// Static meshes
 		{
 			auto entities = GetAllEntitiesWith<StaticMeshComponent>();
@@ -442,6 +495,10 @@ namespace Saturn {
 			{
 				auto& meshComponent = entity->GetComponent<StaticMeshComponent>();
 
+				// Drawn by the merged static geometry.
+				if( meshComponent.Merged )
+					continue;
+
 				auto transform = GetTransformRelativeToParent( entity );
 
 				Ref<MaterialRegistry> targetMaterialRegistry = meshComponent.Mesh->GetMaterialRegistry();
@@ -450,27 +507,75 @@ namespace Saturn {
 					targetMaterialRegistry = meshComponent.MaterialRegistry;
 
 				if( meshComponent.Mesh )
-					rSceneRenderer.SubmitStaticMesh( entity, meshComponent.Mesh, targetMaterialRegistry, transform );
+					rSceneRenderer.SubmitStaticMesh( entity, meshComponent.Mesh, targetMaterialRegistry, transform, meshComponent.Occluder, entity->GetComponent<TransformComponent>().Mobility );
 			}
 		}
 
-		// Check twice because we are always going to have to set the projection
-		if( m_MainCameraEntity )
+		// Instanced static meshes
 		{
-			auto& rCamera = m_MainCameraEntity->GetComponent<CameraComponent>().Camera;
-			rCamera.SetViewportSize( rSceneRenderer.Width(), rSceneRenderer.Height() );
-			auto view = glm::inverse( GetTransformRelativeToParent( m_MainCameraEntity ) );
-			
-			m_RendererCamera.Camera = rCamera;
-			m_RendererCamera.ViewMatrix = view;
+			auto entities = GetAllEntitiesWith<InstancedStaticMeshComponent>();
+
+			for( auto& entity : entities )
+			{
+				auto& rInstancedMesh = entity->GetComponent<InstancedStaticMeshComponent>();
+
+				if( !rInstancedMesh.Mesh || rInstancedMesh.Instances.empty() )
+					continue;
+
+				rInstancedMesh.UpdateClusters();
+
+				rSceneRenderer.SubmitInstancedStaticMesh( entity, rInstancedMesh.Mesh, rInstancedMesh.Mesh->GetMaterialRegistry(), rInstancedMesh.Clusters, GetTransformRelativeToParent( entity ), rInstancedMesh.CastShadows, entity->GetComponent<TransformComponent>().Mobility );
+			}
 		}
-		else
+
+		// Particles
+		UpdateParticles( ts );
+	}
+
+	void Scene::UpdateParticles( Timestep ts )
+	{
+		SAT_PF_EVENT();
+
+		auto entities = GetAllEntitiesWith<ParticleEmitterComponent>();
+
+		// The emitters live in the scene and not in the component so that copies of the scene never share particles.
+		std::unordered_map<UUID, Ref<ParticleEmitter>> Emitters;
+		std::vector<ParticleEmitterUpdate> Updates;
+		Updates.reserve( entities.size() );
+
+		const glm::vec3 CameraPosition = glm::vec3( glm::inverse( m_RendererCamera.ViewMatrix )[ 3 ] );
+
+		for( auto& entity : entities )
 		{
-			// TODO:
+			auto& rParticles = entity->GetComponent<ParticleEmitterComponent>();
+
+			Ref<ParticleEmitter> Emitter = m_ParticleEmitters[ entity->GetUUID() ];
+			if( !Emitter )
+				Emitter = Ref<ParticleEmitter>::Create( ( uint32_t ) ( ( uint64_t ) entity->GetUUID() ^ ( ( uint64_t ) entity->GetUUID() >> 32 ) ) );
+
+			Emitters[ entity->GetUUID() ] = Emitter;
+
+			ParticleEmitterUpdate EmitterUpdate;
+			EmitterUpdate.pEmitter = Emitter.Get();
+			EmitterUpdate.pSettings = &rParticles.Settings;
+			EmitterUpdate.Transform = GetTransformRelativeToParent( entity );
+			EmitterUpdate.CameraDistance = glm::distance( CameraPosition, glm::vec3( EmitterUpdate.Transform[ 3 ] ) );
+
+			Updates.push_back( EmitterUpdate );
 		}
 
-		rSceneRenderer.SetCamera( m_RendererCamera );
-		Renderer2D::Get().SetCamera( m_RendererCamera );
+		// Emitters of deleted entities are dropped here.
+		m_ParticleEmitters = std::move( Emitters );
+
+		ParticleSystem::Update( Updates, ts.Seconds() );
+		ParticleSystem::Submit( Updates );
+	}
+
+	uint32_t Scene::GetParticleCount( UUID EntityID ) const
+	{
+		auto Itr = m_ParticleEmitters.find( EntityID );
+
+		return Itr != m_ParticleEmitters.end() ? Itr->second->GetCount() : 0;
 	}
 
 	Ref<Entity> Scene::CreateEntityWithIDScript( UUID uuid, const std::string& name /*= "" */, const std::string& rScriptName )
@@ -518,6 +623,14 @@ namespace Saturn {
 	{
 		SAT_PF_EVENT();
 
+		if( RuntimeRunning )
+		{
+			auto Itr = m_FixedTransforms.find( entity->GetUUID() );
+
+			if( Itr != m_FixedTransforms.end() )
+				return Itr->second.World;
+		}
+
 		glm::mat4 transform( 1.0f );
 
 		const UUID& rParentID = entity->GetParent();
@@ -548,6 +661,93 @@ namespace Saturn {
 		return tc;
 	}
 
+	bool Scene::HasFixedTransform( Ref<Entity> entity )
+	{
+		if( !Saturn::HasFixedTransform( entity->GetComponent<TransformComponent>().Mobility ) )
+			return false;
+
+		const UUID& rParentID = entity->GetParent();
+
+		if( rParentID != 0 )
+		{
+			Ref<Entity> parent = FindEntityByID( rParentID );
+			if( parent )
+				return HasFixedTransform( parent );
+		}
+
+		return true;
+	}
+
+	void Scene::CacheFixedTransforms()
+	{
+		SAT_PF_EVENT();
+
+		m_FixedTransforms.clear();
+
+#if !defined(SAT_DIST)
+		m_MovedFixedEntities.clear();
+#endif
+
+		for( auto&& [id, entity] : m_EntityIDMap )
+		{
+			auto& rTransform = entity->GetComponent<TransformComponent>();
+
+			if( !Saturn::HasFixedTransform( rTransform.Mobility ) )
+				continue;
+
+			if( !HasFixedTransform( entity ) )
+			{
+				SAT_CORE_WARN( "Entity '{0}' is {1} but has a movable parent, it will be treated as movable.", entity->GetName(), MobilityToString( rTransform.Mobility ) );
+				continue;
+			}
+
+			m_FixedTransforms[ entity->GetUUID() ] = { GetTransformRelativeToParent( entity ), rTransform.Position, rTransform.GetRotation(), rTransform.Scale, entity };
+		}
+	}
+
+	void Scene::InvalidateFixedTransform( Ref<Entity> entity )
+	{
+		m_FixedTransforms.erase( entity->GetUUID() );
+
+		// Children inherit the transform so their cached world transform is wrong as well.
+		for( const auto& rChildID : entity->GetChildren() )
+		{
+			Ref<Entity> child = FindEntityByID( rChildID );
+			if( child )
+				InvalidateFixedTransform( child );
+		}
+	}
+
+#if !defined(SAT_DIST)
+	// Compiled out of Dist, shipped games are expected to respect mobility and the check is not free.
+	void Scene::ValidateFixedTransforms()
+	{
+		SAT_PF_EVENT();
+
+		std::vector<Ref<Entity>> MovedEntities;
+
+		for( const auto& [id, rFixed] : m_FixedTransforms )
+		{
+			const auto& rTransform = rFixed.Owner->GetComponent<TransformComponent>();
+
+			if( Saturn::HasFixedTransform( rTransform.Mobility ) && rTransform.Position == rFixed.Position && rTransform.GetRotation() == rFixed.Rotation && rTransform.Scale == rFixed.Scale )
+				continue;
+
+			MovedEntities.push_back( rFixed.Owner );
+		}
+
+		for( auto& entity : MovedEntities )
+		{
+			SAT_CORE_WARN( "Entity '{0}' is {1} but was moved or changed mobility at runtime, it will be treated as movable until the runtime is restarted.", entity->GetName(), MobilityToString( entity->GetComponent<TransformComponent>().Mobility ) );
+
+			// Keep it correct on screen, the cache is only an optimisation.
+			InvalidateFixedTransform( entity );
+
+			m_MovedFixedEntities.insert( entity->GetUUID() );
+		}
+	}
+#endif
+
 	bool Scene::Raycast( const glm::vec3& Origin, const glm::vec3& Direction, float MaxDistance, RaycastHitResult* pOut )
 	{
 		if( m_PhysicsScene )
@@ -608,13 +808,13 @@ namespace Saturn {
 
 		// Without TagComponent, IdComponent, RelationshipComponent
 		using DesiredComponents = ComponentGroup<TransformComponent, PrefabComponent,
-			StaticMeshComponent,
+			StaticMeshComponent, InstancedStaticMeshComponent,
 			DirectionalLightComponent, SkylightComponent, PointLightComponent,
 			CameraComponent,
 			BoxColliderComponent, SphereColliderComponent, CapsuleColliderComponent, MeshColliderComponent, RigidbodyComponent,
 			ScriptComponent,
 			AudioPlayerComponent, AudioListenerComponent,
-			BillboardComponent>;
+			BillboardComponent, ParticleEmitterComponent>;
 
 		CopyComponentIfExists( DesiredComponents{}, newEntity->GetHandle(), entity->GetHandle(), m_Registry );
 
@@ -664,6 +864,8 @@ namespace Saturn {
 			}
 		}
 
+		m_FixedTransforms.erase( entity->GetUUID() );
+
 		m_EntityIDMap.erase( entity->GetHandle() );
 		m_Registry.destroy( entity->GetHandle() );
 		
@@ -716,6 +918,9 @@ namespace Saturn {
 			entity->BeginPlay();
 		}
 
+		// After BeginPlay so that scripts can still place static entities.
+		CacheFixedTransforms();
+
 		StartAudioPlayers();
 
 		// Init new scene camera
@@ -818,6 +1023,8 @@ namespace Saturn {
 
 		m_MainCameraEntity = nullptr;
 
+		m_FixedTransforms.clear();
+
 		RuntimeRunning = false;
 	}
 
@@ -858,6 +1065,12 @@ namespace Saturn {
 
 		SerialiseInternal( stream );
 
+		bool HasMergedGeometry = m_MergedStaticGeometry;
+		RawSerialisation::WriteObject( HasMergedGeometry, stream );
+
+		if( HasMergedGeometry )
+			MergedStaticGeometry::Serialise( *m_MergedStaticGeometry.Get(), stream );
+
 		stream.close();
 	}
 	
@@ -903,6 +1116,52 @@ namespace Saturn {
 		/////////////////////////////////////
 
 		DeserialiseInternal( stream );
+
+		bool HasMergedGeometry = false;
+		RawSerialisation::ReadObject( HasMergedGeometry, stream );
+
+		if( HasMergedGeometry )
+		{
+			m_MergedStaticGeometry = Ref<MergedStaticGeometry>::Create();
+			MergedStaticGeometry::Deserialise( *m_MergedStaticGeometry.Get(), stream );
+
+			CreateMergedStaticGeometry();
+		}
+	}
+
+	void Scene::SetMergedStaticGeometry( const Ref<MergedStaticGeometry>& rGeometry )
+	{
+		m_MergedStaticGeometry = rGeometry;
+	}
+
+	void Scene::CreateMergedStaticGeometry()
+	{
+		// Entities are created in the active scene.
+		Scene* ActiveScene = GActiveScene;
+		GActiveScene = this;
+
+		Ref<StaticMesh> Mesh = StaticGeometryMerger::CreateMesh( *m_MergedStaticGeometry.Get() );
+
+		Ref<Entity> MergedEntity = Ref<Entity>::Create();
+		MergedEntity->SetName( "Merged Static Geometry" );
+		MergedEntity->GetComponent<TransformComponent>().Mobility = Mobility::Static;
+
+		auto& rMeshComponent = MergedEntity->AddComponent<StaticMeshComponent>();
+		rMeshComponent.Mesh = Mesh;
+		rMeshComponent.MaterialRegistry = Ref<MaterialRegistry>::Create( Mesh );
+
+		// The entities keep their mesh for physics and gameplay, they are just not drawn.
+		for( const UUID& rID : m_MergedStaticGeometry->SourceEntities )
+		{
+			Ref<Entity> SourceEntity = FindEntityByID( rID );
+
+			if( SourceEntity && SourceEntity->HasComponent<StaticMeshComponent>() )
+				SourceEntity->GetComponent<StaticMeshComponent>().Merged = true;
+		}
+
+		GActiveScene = ActiveScene;
+
+		SAT_CORE_INFO( "Merged static geometry: {0} draws in {1} clusters", m_MergedStaticGeometry->SourceDrawCount, m_MergedStaticGeometry->Clusters.size() );
 	}
 
 	template<typename IStream>
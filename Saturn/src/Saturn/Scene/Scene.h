@@ -44,6 +44,8 @@
 
 #include "entt.hpp"
 
+#include <unordered_set>
+
 #if defined( SAT_ENABLE_GAMETHREAD )
 #include <shared_mutex>
 #endif
@@ -56,6 +58,8 @@ namespace Saturn {
 	class SClass;
 	class SceneRenderer;
 	class PlayerInputController;
+	class MergedStaticGeometry;
+	class ParticleEmitter;
 
 	struct TransformComponent;
 	struct RaycastHitResult;
@@ -207,11 +211,30 @@ namespace Saturn {
 		[[nodiscard]] Ref<Entity> FindEntityByTag( const std::string& tag );
 		[[nodiscard]] Ref<Entity> FindEntityByID( const UUID& id );
 
+		// Static and stationary entities return the world transform that was cached when the runtime started.
 		glm::mat4 GetTransformRelativeToParent( Ref<Entity> entity );
 		TransformComponent GetWorldSpaceTransform( Ref<Entity> entity );
 
+		// True when the entity and all of its parents can not move.
+		[[nodiscard]] bool HasFixedTransform( Ref<Entity> entity );
+
+		// Static or stationary entities that were moved while the runtime was running.
+#if !defined(SAT_DIST)
+		[[nodiscard]] bool WasMovedAtRuntime( const UUID& rID ) const { return m_MovedFixedEntities.contains( rID ); }
+#else
+		[[nodiscard]] bool WasMovedAtRuntime( const UUID& rID ) const { return false; }
+#endif
+
 		[[nodiscard]] bool Raycast( const glm::vec3& Origin, const glm::vec3& Direction, float MaxDistance, RaycastHitResult* pOut );
 
+		// Static props that were merged when the asset bundle was built, null when nothing was merged.
+		// Set before the scene is serialised into the bundle, the mesh is created when the bundled scene is loaded.
+		void SetMergedStaticGeometry( const Ref<MergedStaticGeometry>& rGeometry );
+		const Ref<MergedStaticGeometry>& GetMergedStaticGeometry() const { return m_MergedStaticGeometry; }
+
+		// Live particles of an entity's emitter, 0 if it has not been simulated yet.
+		uint32_t GetParticleCount( UUID EntityID ) const;
+
 	public:
 		void CopyScene( Ref<Scene>& NewScene );
 		void Empty();
@@ -246,6 +269,13 @@ namespace Saturn {
 		void DestroyAudioPlayers();
 		void UpdateAudioListeners();
 
+	private:
+		void CacheFixedTransforms();
+		void ValidateFixedTransforms();
+		void InvalidateFixedTransform( Ref<Entity> entity );
+
+	public:
+
 #if defined(SAT_DEBUG) || defined(SAT_RELEASE)
 		void MarkDirty() { m_Dirty = true; }
 		void CleanDirty() { m_Dirty = false; }
@@ -272,6 +302,11 @@ namespace Saturn {
 		template<typename IStream>
 		void DeserialiseInternal( IStream& rStream );
 
+		void CreateMergedStaticGeometry();
+
+		// Simulates every particle emitter and submits them to the 2D renderer, the camera must be set.
+		void UpdateParticles( Timestep ts );
+
 	protected:
 		void OnEntityCreated( Ref<Entity> entity );
 
@@ -344,6 +379,30 @@ namespace Saturn {
 
 		RendererCamera m_RendererCamera;
 
+		struct FixedTransform
+		{
+			glm::mat4 World;
+
+			// What the transform component held when it was cached, compared directly so checking for moves does not rebuild any matrices.
+			glm::vec3 Position;
+			glm::quat Rotation;
+			glm::vec3 Scale;
+
+			// So the check only visits fixed entities instead of the whole scene.
+			Ref<Entity> Owner;
+		};
+
+		// Transforms of entities that can not move, built when the runtime starts.
+		std::unordered_map<UUID, FixedTransform> m_FixedTransforms;
+
+		Ref<MergedStaticGeometry> m_MergedStaticGeometry = nullptr;
+
+		std::unordered_map<UUID, Ref<ParticleEmitter>> m_ParticleEmitters;
+
+#if !defined(SAT_DIST)
+		std::unordered_set<UUID> m_MovedFixedEntities;
+#endif
+
 		// TODO: Change raw pointer to Ref?
 		PhysicsScene* m_PhysicsScene = nullptr;
 
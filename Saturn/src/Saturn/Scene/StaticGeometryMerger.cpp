@@ -0,0 +1,406 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#include "sppch.h"
+#include "StaticGeometryMerger.h"
+
+#include "Scene.h"
+#include "Entity.h"
+#include "Components.h"
+
+#include "Saturn/Asset/AssetManager.h"
+#include "Saturn/Serialisation/RawSerialisation.h"
+#include "Saturn/Core/OptickProfiler.h"
+
+#include <map>
+#include <set>
+#include <tuple>
+
+namespace Saturn {
+
+	std::vector<UUID> MergedStaticGeometry::FindEntities( uint32_t Cluster ) const
+	{
+		std::vector<UUID> Result;
+
+		for( size_t i = 0; i < SourceClusters.size(); i++ )
+		{
+			if( SourceClusters[ i ] == Cluster )
+				Result.push_back( SourceEntities[ i ] );
+		}
+
+		return Result;
+	}
+
+	std::vector<uint32_t> MergedStaticGeometry::FindClusters( const UUID& rEntity ) const
+	{
+		std::vector<uint32_t> Result;
+
+		for( size_t i = 0; i < SourceEntities.size(); i++ )
+		{
+			if( ( uint64_t ) SourceEntities[ i ] == ( uint64_t ) rEntity )
+				Result.push_back( SourceClusters[ i ] );
+		}
+
+		return Result;
+	}
+
+	void MergedStaticGeometry::Serialise( const MergedStaticGeometry& rObject, std::ofstream& rStream )
+	{
+		RawSerialisation::WriteVector( rObject.Vertices, rStream );
+		RawSerialisation::WriteVector( rObject.Indices, rStream );
+		RawSerialisation::WriteVector( rObject.Clusters, rStream );
+		RawSerialisation::WriteVector( rObject.Materials, rStream );
+
+		RawSerialisation::WriteObject( rObject.QuantiseVertices, rStream );
+
+		RawSerialisation::WriteVector( rObject.SourceEntities, rStream );
+		RawSerialisation::WriteVector( rObject.SourceClusters, rStream );
+
+		RawSerialisation::WriteObject( rObject.SourceDrawCount, rStream );
+	}
+
+	void MergedStaticGeometry::Deserialise( MergedStaticGeometry& rObject, std::istream& rStream )
+	{
+		RawSerialisation::ReadVector( rObject.Vertices, rStream );
+		RawSerialisation::ReadVector( rObject.Indices, rStream );
+		RawSerialisation::ReadVector( rObject.Clusters, rStream );
+		RawSerialisation::ReadVector( rObject.Materials, rStream );
+
+		RawSerialisation::ReadObject( rObject.QuantiseVertices, rStream );
+
+		RawSerialisation::ReadVector( rObject.SourceEntities, rStream );
+		RawSerialisation::ReadVector( rObject.SourceClusters, rStream );
+
+		RawSerialisation::ReadObject( rObject.SourceDrawCount, rStream );
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	namespace {
+
+		// One submesh of a placed mesh.
+		struct MergePiece
+		{
+			UUID Entity;
+			Ref<StaticMesh> Mesh;
+			// The registry the scene renders the mesh with.
+			Ref<MaterialRegistry> Registry;
+			uint32_t SubmeshIndex = 0;
+			glm::mat4 Transform;
+			uint32_t MaterialIndex = 0;
+		};
+
+		glm::vec3 SafeNormalize( const glm::vec3& rValue )
+		{
+			float Length = glm::length( rValue );
+
+			return Length > 0.0f ? rValue / Length : rValue;
+		}
+
+		float GetMaxScale( const glm::mat4& rTransform )
+		{
+			return glm::max( glm::length( glm::vec3( rTransform[ 0 ] ) ), glm::max( glm::length( glm::vec3( rTransform[ 1 ] ) ), glm::length( glm::vec3( rTransform[ 2 ] ) ) ) );
+		}
+
+		float GetRadius( const AABB& rBounds )
+		{
+			return glm::length( rBounds.Max - rBounds.Min ) * 0.5f;
+		}
+	}
+
+	static void BuildCluster( const std::vector<const MergePiece*>& rPieces, MergedStaticGeometry& rGeometry )
+	{
+		const uint32_t ClusterIndex = ( uint32_t ) rGeometry.Clusters.size();
+
+		Submesh Cluster = {};
+		Cluster.BaseVertex = ( uint32_t ) rGeometry.Vertices.size();
+		Cluster.BaseIndex = ( uint32_t ) rGeometry.Indices.size() * 3;
+		Cluster.MaterialIndex = rPieces[ 0 ]->MaterialIndex;
+		Cluster.Transform = glm::mat4( 1.0f );
+		Cluster.NodeName = std::format( "Cluster {0}", ClusterIndex );
+		Cluster.BoundingBox.Min = glm::vec3( std::numeric_limits<float>::max() );
+		Cluster.BoundingBox.Max = glm::vec3( std::numeric_limits<float>::lowest() );
+
+		// Where the vertices of each piece start, relative to the cluster.
+		std::vector<uint32_t> VertexOffsets;
+		VertexOffsets.reserve( rPieces.size() );
+
+		uint32_t LodCount = 1;
+
+		for( const MergePiece* pPiece : rPieces )
+		{
+			const Submesh& rSubmesh = pPiece->Mesh->Submeshes()[ pPiece->SubmeshIndex ];
+			const auto& rVertices = pPiece->Mesh->Vertices();
+
+			VertexOffsets.push_back( ( uint32_t ) rGeometry.Vertices.size() - Cluster.BaseVertex );
+			LodCount = std::max( LodCount, rSubmesh.GetLodCount() );
+
+			const glm::mat3 Basis = glm::mat3( pPiece->Transform );
+			const glm::mat3 NormalMatrix = glm::transpose( glm::inverse( Basis ) );
+
+			for( uint32_t i = 0; i < rSubmesh.VertexCount; i++ )
+			{
+				StaticVertex Vertex = rVertices[ rSubmesh.BaseVertex + i ];
+
+				Vertex.Position = glm::vec3( pPiece->Transform * glm::vec4( Vertex.Position, 1.0f ) );
+				Vertex.Normal = SafeNormalize( NormalMatrix * Vertex.Normal );
+				Vertex.Tangent = SafeNormalize( Basis * Vertex.Tangent );
+				Vertex.Binormal = SafeNormalize( Basis * Vertex.Binormal );
+
+				Cluster.BoundingBox.Min = glm::min( Cluster.BoundingBox.Min, Vertex.Position );
+				Cluster.BoundingBox.Max = glm::max( Cluster.BoundingBox.Max, Vertex.Position );
+
+				rGeometry.Vertices.push_back( Vertex );
+			}
+
+			// Pieces of one entity are next to each other, only add the entity once per cluster.
+			if( rGeometry.SourceEntities.empty() || ( uint64_t ) rGeometry.SourceEntities.back() != ( uint64_t ) pPiece->Entity || rGeometry.SourceClusters.back() != ClusterIndex )
+			{
+				rGeometry.SourceEntities.push_back( pPiece->Entity );
+				rGeometry.SourceClusters.push_back( ClusterIndex );
+			}
+		}
+
+		Cluster.VertexCount = ( uint32_t ) rGeometry.Vertices.size() - Cluster.BaseVertex;
+
+		const float ClusterRadius = GetRadius( Cluster.BoundingBox );
+
+		// LOD n of the cluster is LOD n of every piece (or the coarsest one it has), the error is the largest error of any piece relative to the cluster bounds.
+		for( uint32_t Lod = 0; Lod < LodCount; Lod++ )
+		{
+			SubmeshLod ClusterLod = {};
+			ClusterLod.BaseIndex = ( uint32_t ) rGeometry.Indices.size() * 3;
+
+			for( size_t p = 0; p < rPieces.size(); p++ )
+			{
+				const MergePiece* pPiece = rPieces[ p ];
+				const Submesh& rSubmesh = pPiece->Mesh->Submeshes()[ pPiece->SubmeshIndex ];
+				const SubmeshLod PieceLod = rSubmesh.GetLod( Lod );
+
+				const uint32_t* pSource = reinterpret_cast< const uint32_t* >( pPiece->Mesh->Indices().data() ) + PieceLod.BaseIndex;
+
+				// Mirrored transforms flip the winding.
+				const bool Flip = glm::determinant( glm::mat3( pPiece->Transform ) ) < 0.0f;
+
+				for( uint32_t i = 0; i + 2 < PieceLod.IndexCount; i += 3 )
+				{
+					Index Triangle = { pSource[ i ], pSource[ i + 1 ], pSource[ i + 2 ] };
+
+					if( Flip )
+						std::swap( Triangle.V2, Triangle.V3 );
+
+					Triangle.V1 += VertexOffsets[ p ];
+					Triangle.V2 += VertexOffsets[ p ];
+					Triangle.V3 += VertexOffsets[ p ];
+
+					rGeometry.Indices.push_back( Triangle );
+				}
+
+				if( ClusterRadius > 0.0f )
+				{
+					float PieceRadius = GetRadius( rSubmesh.BoundingBox ) * GetMaxScale( pPiece->Transform );
+					ClusterLod.Error = std::max( ClusterLod.Error, PieceLod.Error * PieceRadius / ClusterRadius );
+				}
+			}
+
+			ClusterLod.IndexCount = ( uint32_t ) rGeometry.Indices.size() * 3 - ClusterLod.BaseIndex;
+
+			if( Lod == 0 )
+				Cluster.IndexCount = ClusterLod.IndexCount;
+			else
+				Cluster.Lods.push_back( ClusterLod );
+		}
+
+		rGeometry.Clusters.push_back( Cluster );
+	}
+
+	Ref<MergedStaticGeometry> StaticGeometryMerger::Merge( Scene* pScene )
+	{
+		SAT_PF_EVENT();
+
+		Ref<MergedStaticGeometry> Geometry = Ref<MergedStaticGeometry>::Create();
+
+		// Sorted by ID so the same scene always gives the same clusters.
+		std::map<uint64_t, Ref<Entity>> Entities;
+
+		for( auto& rEntity : pScene->GetAllEntitiesWith<StaticMeshComponent>() )
+			Entities[ ( uint64_t ) rEntity->GetUUID() ] = rEntity;
+
+		std::vector<MergePiece> Pieces;
+		std::unordered_map<uint64_t, uint32_t> MaterialIndices;
+
+		// Instances of every submesh draw, these are what the renderer would draw instanced.
+		using DrawKey = std::tuple<uint64_t, const MaterialRegistry*, uint32_t>;
+		std::map<DrawKey, uint32_t> DrawInstances;
+
+		for( auto& [ID, rEntity] : Entities )
+		{
+			auto& rMeshComponent = rEntity->GetComponent<StaticMeshComponent>();
+			Ref<StaticMesh> Mesh = rMeshComponent.Mesh;
+
+			if( !Mesh || Mesh->Vertices().empty() || rMeshComponent.Occluder || rEntity->HasComponent<ScriptComponent>() )
+				continue;
+
+			if( rEntity->GetComponent<TransformComponent>().Mobility != Mobility::Static || !pScene->HasFixedTransform( rEntity ) )
+				continue;
+
+			// Same registry that the scene renders with.
+			Ref<MaterialRegistry> Registry = Mesh->GetMaterialRegistry();
+
+			if( rMeshComponent.MaterialRegistry && rMeshComponent.MaterialRegistry->HasAnyOverrides() )
+				Registry = rMeshComponent.MaterialRegistry;
+
+			// Every submesh needs a material asset, otherwise the whole entity is left as it is.
+			bool HasMaterials = true;
+
+			for( const auto& rSubmesh : Mesh->Submeshes() )
+			{
+				if( rSubmesh.MaterialIndex >= Registry->GetMaterials().size() || !Registry->GetMaterials()[ rSubmesh.MaterialIndex ] )
+					HasMaterials = false;
+			}
+
+			if( !HasMaterials )
+				continue;
+
+			glm::mat4 Transform = pScene->GetTransformRelativeToParent( rEntity );
+
+			for( uint32_t i = 0; i < ( uint32_t ) Mesh->Submeshes().size(); i++ )
+			{
+				const Submesh& rSubmesh = Mesh->Submeshes()[ i ];
+				const Ref<MaterialAsset>& rMaterial = Registry->GetMaterials()[ rSubmesh.MaterialIndex ];
+
+				auto [Itr, Inserted] = MaterialIndices.try_emplace( ( uint64_t ) rMaterial->ID, ( uint32_t ) Geometry->Materials.size() );
+
+				if( Inserted )
+					Geometry->Materials.push_back( rMaterial->ID );
+
+				MergePiece& rPiece = Pieces.emplace_back();
+				rPiece.Entity = rEntity->GetUUID();
+				rPiece.Mesh = Mesh;
+				rPiece.Registry = Registry;
+				rPiece.SubmeshIndex = i;
+				rPiece.Transform = Transform * rSubmesh.Transform;
+				rPiece.MaterialIndex = Itr->second;
+
+				DrawInstances[ { ( uint64_t ) Mesh->ID, Registry.Get(), i } ]++;
+			}
+		}
+
+		// Entities with a submesh that is already drawn instanced are left as they are, an entity is either merged completely or not at all.
+		std::set<uint64_t> SkippedEntities;
+
+		for( const MergePiece& rPiece : Pieces )
+		{
+			if( DrawInstances[ { ( uint64_t ) rPiece.Mesh->ID, rPiece.Registry.Get(), rPiece.SubmeshIndex } ] > MaxInstancesToMerge )
+				SkippedEntities.insert( ( uint64_t ) rPiece.Entity );
+		}
+
+		// Group the pieces by material and by the cell their centre is in.
+		using ClusterKey = std::tuple<uint32_t, int32_t, int32_t, int32_t>;
+		std::map<ClusterKey, std::vector<const MergePiece*>> Groups;
+
+		bool AllQuantised = true;
+		std::set<DrawKey> SourceDraws;
+
+		for( size_t i = 0; i < Pieces.size(); i++ )
+		{
+			const MergePiece& rPiece = Pieces[ i ];
+			const Submesh& rSubmesh = rPiece.Mesh->Submeshes()[ rPiece.SubmeshIndex ];
+
+			if( SkippedEntities.contains( ( uint64_t ) rPiece.Entity ) )
+				continue;
+
+			SourceDraws.insert( { ( uint64_t ) rPiece.Mesh->ID, rPiece.Registry.Get(), rPiece.SubmeshIndex } );
+
+			glm::vec3 Centre = ( rSubmesh.BoundingBox.Min + rSubmesh.BoundingBox.Max ) * 0.5f;
+			glm::vec3 Cell = glm::floor( glm::vec3( rPiece.Transform * glm::vec4( Centre, 1.0f ) ) / ClusterSize );
+
+			Groups[ { rPiece.MaterialIndex, ( int32_t ) Cell.x, ( int32_t ) Cell.y, ( int32_t ) Cell.z } ].push_back( &rPiece );
+
+			AllQuantised = AllQuantised && rPiece.Mesh->IsQuantised();
+		}
+
+		if( Groups.empty() )
+			return nullptr;
+
+		for( const auto& [Key, rPieces] : Groups )
+		{
+			std::vector<const MergePiece*> ClusterPieces;
+			uint32_t ClusterVertices = 0;
+
+			for( const MergePiece* pPiece : rPieces )
+			{
+				uint32_t VertexCount = pPiece->Mesh->Submeshes()[ pPiece->SubmeshIndex ].VertexCount;
+
+				if( !ClusterPieces.empty() && ClusterVertices + VertexCount > MaxClusterVertices )
+				{
+					BuildCluster( ClusterPieces, *Geometry.Get() );
+
+					ClusterPieces.clear();
+					ClusterVertices = 0;
+				}
+
+				ClusterPieces.push_back( pPiece );
+				ClusterVertices += VertexCount;
+			}
+
+			BuildCluster( ClusterPieces, *Geometry.Get() );
+		}
+
+		Geometry->SourceDrawCount = ( uint32_t ) SourceDraws.size();
+		Geometry->QuantiseVertices = AllQuantised;
+
+		// Nothing to gain when every material is only used by props that are far apart.
+		if( Geometry->Clusters.size() >= Geometry->SourceDrawCount )
+			return nullptr;
+
+		return Geometry;
+	}
+
+	Ref<StaticMesh> StaticGeometryMerger::CreateMesh( MergedStaticGeometry& rGeometry )
+	{
+		std::vector<Ref<MaterialAsset>> Materials( rGeometry.Materials.size() );
+
+		for( size_t i = 0; i < rGeometry.Materials.size(); i++ )
+		{
+			Materials[ i ] = AssetManager::Get().GetAssetAs<MaterialAsset>( rGeometry.Materials[ i ] );
+
+			// Same as a mesh with a missing material.
+			if( !Materials[ i ] )
+				Materials[ i ] = Ref<MaterialAsset>::Create( nullptr );
+		}
+
+		Ref<StaticMesh> Mesh = Ref<StaticMesh>::Create( std::move( rGeometry.Vertices ), std::move( rGeometry.Indices ), rGeometry.Clusters, Materials, rGeometry.QuantiseVertices );
+		Mesh->Name = "Merged Static Geometry";
+
+		rGeometry.Vertices.clear();
+		rGeometry.Indices.clear();
+
+		return Mesh;
+	}
+}
@@ -0,0 +1,90 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#pragma once
+
+#include "Saturn/Core/Base.h"
+#include "Saturn/Core/UUID.h"
+#include "Saturn/Vulkan/Mesh.h"
+
+#include <vector>
+#include <fstream>
+
+namespace Saturn {
+
+	class Scene;
+
+	// Static mesh geometry of a scene that was merged when the asset bundle was built.
+	// The geometry is baked into world space, every submesh is one cluster of props that share a material and are close to each other, so each cluster is one draw that is still culled on its own.
+	class MergedStaticGeometry : public RefTarget
+	{
+	public:
+		std::vector<StaticVertex> Vertices;
+		std::vector<Index> Indices;
+
+		// One submesh per cluster, the material index is an index into Materials.
+		std::vector<Submesh> Clusters;
+		std::vector<UUID> Materials;
+
+		bool QuantiseVertices = false;
+
+		// Which entities were merged into which cluster, one entry for every entity and cluster pair.
+		std::vector<UUID> SourceEntities;
+		std::vector<uint32_t> SourceClusters;
+
+		// Instanced draws the merged entities needed before they were merged.
+		uint32_t SourceDrawCount = 0;
+
+	public:
+		// Entities that were merged into a cluster and the clusters an entity was merged into, for picking and debugging.
+		std::vector<UUID> FindEntities( uint32_t Cluster ) const;
+		std::vector<uint32_t> FindClusters( const UUID& rEntity ) const;
+
+		static void Serialise( const MergedStaticGeometry& rObject, std::ofstream& rStream );
+		static void Deserialise( MergedStaticGeometry& rObject, std::istream& rStream );
+	};
+
+	// Bundle time pass that merges the static props of a scene into fewer draws.
+	// Only entities that have static mobility (and static parents), no script and are not occluders are merged, occluders are usually large walls and floors that the occlusion culler needs on their own.
+	// Meshes that are placed many times are skipped as they are already drawn instanced and merging them would copy their vertices for every instance.
+	class StaticGeometryMerger
+	{
+	public:
+		// Props are grouped into cells of this size (in world units) by the centre of their bounds.
+		static constexpr float ClusterSize = 32.0f;
+		static constexpr uint32_t MaxClusterVertices = 256 * 1024;
+		static constexpr uint32_t MaxInstancesToMerge = 32;
+
+	public:
+		// Returns null when there was nothing worth merging.
+		static Ref<MergedStaticGeometry> Merge( Scene* pScene );
+
+		// Creates the mesh that draws every cluster, the vertices and indices are moved into it.
+		static Ref<StaticMesh> CreateMesh( MergedStaticGeometry& rGeometry );
+	};
+}
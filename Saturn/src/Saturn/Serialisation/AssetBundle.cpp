@@ -46,9 +46,12 @@
 #include "Saturn/Asset/PhysicsMaterialAsset.h"
 
 #include "Saturn/Serialisation/SceneSerialiser.h"
+#include "Saturn/Scene/StaticGeometryMerger.h"
 
 #include <zlib.h>
 
+#include <set>
+
 namespace Saturn {
 
 	struct AssetBundleHeader
@@ -111,11 +114,13 @@ namespace Saturn {
 		// THREAD-TRANSTION, Block main thread
 		Application::Get().SuspendMainThreadCV();
 
+		std::unordered_map<AssetID, TextureUsage> TextureUsages = CollectTextureUsages( AssetBundleRegistry );
+
 		for( auto& [id, asset] : AssetBundleRegistry->GetAssetMap() )
 		{
 			SAT_CORE_INFO( "Dumping asset to disk: {0}", asset->Name );
 
-			RTDumpAsset( asset, AssetBundleRegistry );
+			RTDumpAsset( asset, AssetBundleRegistry, TextureUsages );
 
 			std::filesystem::path p = ActiveProject->GetTempDir() / std::to_string( id );
 			asset->Type == AssetType::Sound ? p.replace_extension( ".vfsn" ) : p.replace_extension( ".vfs" );
@@ -135,6 +140,17 @@ namespace Saturn {
 			SceneSerialiser serialiser( scene );
 			serialiser.Deserialise();
 
+			// Static props that share a material are merged into fewer draws, the runtime only loads the result.
+			Ref<MergedStaticGeometry> MergedGeometry = StaticGeometryMerger::Merge( scene.Get() );
+
+			if( MergedGeometry )
+			{
+				std::set<uint64_t> MergedEntities( MergedGeometry->SourceEntities.begin(), MergedGeometry->SourceEntities.end() );
+
+				SAT_CORE_INFO( "Merged static geometry of scene {0}: {1} entities, {2} draws before, {3} draws after", asset->Name, MergedEntities.size(), MergedGeometry->SourceDrawCount, MergedGeometry->Clusters.size() );
+			}
+
+			scene->SetMergedStaticGeometry( MergedGeometry );
 			scene->SerialiseData();
 		}
 
@@ -280,7 +296,49 @@ namespace Saturn {
 		return AssetBundleResult::Success;
 	}
 
-	void AssetBundle::RTDumpAsset( const Ref<Asset>& rAsset, Ref<AssetRegistry>& AssetBundleRegistry )
+	std::unordered_map<AssetID, TextureUsage> AssetBundle::CollectTextureUsages( Ref<AssetRegistry>& AssetBundleRegistry )
+	{
+		std::unordered_map<AssetID, TextureUsage> TextureUsages;
+
+		auto addUsage = [&]( Ref<Texture2D> texture, TextureUsage usage )
+			{
+				if( !texture )
+					return;
+
+				// Same lookup as the raw material serialiser.
+				auto path = std::filesystem::relative( texture->GetPath(), Project::GetActiveProject()->GetRootDir() );
+				Ref<Asset> textureAsset = AssetManager::Get().FindAsset( path );
+
+				if( !textureAsset )
+					return;
+
+				auto [Itr, Inserted] = TextureUsages.try_emplace( textureAsset->ID, usage );
+
+				// Used in more than one way, BC7 keeps every channel.
+				if( !Inserted && Itr->second != usage )
+					Itr->second = TextureUsage::Albedo;
+			};
+
+		for( auto& [id, asset] : AssetBundleRegistry->GetAssetMap() )
+		{
+			if( asset->Type != AssetType::Material )
+				continue;
+
+			Ref<MaterialAsset> materialAsset = AssetManager::Get().GetAssetAs<MaterialAsset>( AssetBundleRegistry, id );
+
+			if( !materialAsset )
+				continue;
+
+			addUsage( materialAsset->GetAlbeoMap(), TextureUsage::Albedo );
+			addUsage( materialAsset->GetNormalMap(), TextureUsage::Normal );
+			addUsage( materialAsset->GetMetallicMap(), TextureUsage::Mask );
+			addUsage( materialAsset->GetRoughnessMap(), TextureUsage::Mask );
+		}
+
+		return TextureUsages;
+	}
+
+	void AssetBundle::RTDumpAsset( const Ref<Asset>& rAsset, Ref<AssetRegistry>& AssetBundleRegistry, const std::unordered_map<AssetID, TextureUsage>& rTextureUsages )
 	{
 		UUID id = rAsset->ID;
 		AssetManager& rAssetManager = AssetManager::Get();
@@ -299,6 +357,10 @@ namespace Saturn {
 				sourceAsset->Path = rAsset->Path;
 				sourceAsset->ID = rAsset->ID;
 
+				// Textures that no material uses (i.e. UI) are cooked as generic color.
+				auto usageItr = rTextureUsages.find( rAsset->ID );
+				sourceAsset->Cook( usageItr != rTextureUsages.end() ? usageItr->second : TextureUsage::Generic );
+
 				sourceAsset->WriteToVFS();
 			} break;
 
@@ -29,6 +29,7 @@
 #pragma once
 
 #include "Saturn/Asset/AssetRegistry.h"
+#include "Saturn/Asset/TextureCooker.h"
 
 #include "Saturn/ImGui/JobProgress.h"
 
@@ -82,7 +83,10 @@ namespace Saturn {
 		[[nodiscard]] static AssetBundleResult ReadBundle();
 
 	private:
-		static void RTDumpAsset( const Ref<Asset>& rAsset, Ref<AssetRegistry>& AssetBundleRegistry );
+		static void RTDumpAsset( const Ref<Asset>& rAsset, Ref<AssetRegistry>& AssetBundleRegistry, const std::unordered_map<AssetID, TextureUsage>& rTextureUsages );
+
+		// Which material slots every texture is used in, textures are cooked to a format that fits their usage.
+		static std::unordered_map<AssetID, TextureUsage> CollectTextureUsages( Ref<AssetRegistry>& AssetBundleRegistry );
 	};
 
 }
\ No newline at end of file
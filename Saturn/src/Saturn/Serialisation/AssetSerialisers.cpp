@@ -136,7 +136,7 @@ namespace Saturn {
 		if( AssetManager::Get().DoesAssetIDExist( albedoID ) )
 		{
 			Ref<Asset> rAsset = AssetManager::Get().FindAsset( albedoID );
-			texture = Ref<Texture2D>::Create( Project::GetActiveProject()->FilepathAbs( rAsset->Path ), AddressingMode::Repeat );
+			texture = Ref<Texture2D>::Create( Project::GetActiveProject()->FilepathAbs( rAsset->Path ), AddressingMode::Repeat, true, true, true );
 
 			materialAsset->SetAlbeoMap( texture );
 		}
@@ -149,7 +149,7 @@ namespace Saturn {
 		if( AssetManager::Get().DoesAssetIDExist( normalID ) )
 		{
 			Ref<Asset> rAsset = AssetManager::Get().FindAsset( normalID );
-			texture = Ref<Texture2D>::Create( Project::GetActiveProject()->FilepathAbs( rAsset->Path ), AddressingMode::Repeat );
+			texture = Ref<Texture2D>::Create( Project::GetActiveProject()->FilepathAbs( rAsset->Path ), AddressingMode::Repeat, true, true );
 
 			materialAsset->SetNormalMap( texture );
 		}
@@ -162,7 +162,7 @@ namespace Saturn {
 		if( AssetManager::Get().DoesAssetIDExist( metallicID ) )
 		{
 			Ref<Asset> rAsset = AssetManager::Get().FindAsset( metallicID );
-			texture = Ref<Texture2D>::Create( Project::GetActiveProject()->FilepathAbs( rAsset->Path ), AddressingMode::Repeat );
+			texture = Ref<Texture2D>::Create( Project::GetActiveProject()->FilepathAbs( rAsset->Path ), AddressingMode::Repeat, true, true );
 
 			materialAsset->SetMetallicMap( texture );
 		}
@@ -176,7 +176,7 @@ namespace Saturn {
 		if( AssetManager::Get().DoesAssetIDExist( roughnessID ) )
 		{
 			Ref<Asset> rAsset = AssetManager::Get().FindAsset( roughnessID );
-			texture = Ref<Texture2D>::Create( Project::GetActiveProject()->FilepathAbs( rAsset->Path ), AddressingMode::Repeat );
+			texture = Ref<Texture2D>::Create( Project::GetActiveProject()->FilepathAbs( rAsset->Path ), AddressingMode::Repeat, true, true );
 
 			materialAsset->SetRoughnessMap( texture );
 		}
@@ -340,6 +340,25 @@ namespace Saturn {
 
 		out << YAML::Key << "Physics Material ID" << YAML::Value << (int)mesh->GetPhysicsMaterial();
 
+		const auto& rSettings = mesh->GetOptimisationSettings();
+
+		out << YAML::Key << "Optimisation" << YAML::Value;
+		out << YAML::BeginMap;
+
+		out << YAML::Key << "Enabled" << YAML::Value << rSettings.Enabled;
+		out << YAML::Key << "Weld Vertices" << YAML::Value << rSettings.WeldVertices;
+		out << YAML::Key << "Weld Epsilon" << YAML::Value << rSettings.WeldEpsilon;
+		out << YAML::Key << "Vertex Cache" << YAML::Value << rSettings.OptimiseVertexCache;
+		out << YAML::Key << "Overdraw" << YAML::Value << rSettings.OptimiseOverdraw;
+		out << YAML::Key << "Overdraw Threshold" << YAML::Value << rSettings.OverdrawThreshold;
+		out << YAML::Key << "Vertex Fetch" << YAML::Value << rSettings.OptimiseVertexFetch;
+		out << YAML::Key << "LOD Count" << YAML::Value << rSettings.LodCount;
+		out << YAML::Key << "LOD Triangle Ratio" << YAML::Value << rSettings.LodTriangleRatio;
+		out << YAML::Key << "LOD Target Error" << YAML::Value << rSettings.LodTargetError;
+		out << YAML::Key << "Quantise Vertices" << YAML::Value << rSettings.QuantiseVertices;
+
+		out << YAML::EndMap;
+
 		out << YAML::EndMap;
 
 		out << YAML::EndMap;
@@ -369,8 +388,25 @@ namespace Saturn {
 		auto shapeType = meshData[ "Attached Shape" ].as<int>( 0 );
 		auto physicsMaterial = meshData[ "Physics Material ID" ].as<uint64_t>( 0 );
 
+		MeshOptimisationSettings OptimisationSettings;
+
+		if( auto optimisation = meshData[ "Optimisation" ] )
+		{
+			OptimisationSettings.Enabled = optimisation[ "Enabled" ].as<bool>( true );
+			OptimisationSettings.WeldVertices = optimisation[ "Weld Vertices" ].as<bool>( true );
+			OptimisationSettings.WeldEpsilon = optimisation[ "Weld Epsilon" ].as<float>( 0.0f );
+			OptimisationSettings.OptimiseVertexCache = optimisation[ "Vertex Cache" ].as<bool>( true );
+			OptimisationSettings.OptimiseOverdraw = optimisation[ "Overdraw" ].as<bool>( true );
+			OptimisationSettings.OverdrawThreshold = optimisation[ "Overdraw Threshold" ].as<float>( 1.05f );
+			OptimisationSettings.OptimiseVertexFetch = optimisation[ "Vertex Fetch" ].as<bool>( true );
+			OptimisationSettings.LodCount = optimisation[ "LOD Count" ].as<uint32_t>( 3 );
+			OptimisationSettings.LodTriangleRatio = optimisation[ "LOD Triangle Ratio" ].as<float>( 0.5f );
+			OptimisationSettings.LodTargetError = optimisation[ "LOD Target Error" ].as<float>( 0.02f );
+			OptimisationSettings.QuantiseVertices = optimisation[ "Quantise Vertices" ].as<bool>( false );
+		}
+
 		auto realMeshPath = Project::GetActiveProject()->FilepathAbs( filepath );
-		auto mesh = Ref<StaticMesh>::Create( realMeshPath.string() );
+		auto mesh = Ref<StaticMesh>::Create( realMeshPath.string(), OptimisationSettings );
 
 		mesh->SetAttachedShape( (ShapeType)shapeType );
 		mesh->SetPhysicsMaterial( physicsMaterial );
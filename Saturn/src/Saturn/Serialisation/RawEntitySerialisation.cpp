@@ -83,6 +83,7 @@ namespace Saturn {
 				RawSerialisation::WriteVec3( tc.Position, rStream );
 				RawSerialisation::WriteVec3( tc.GetRotationEuler(), rStream );
 				RawSerialisation::WriteVec3( tc.Scale, rStream );
+				RawSerialisation::WriteObject( tc.Mobility, rStream );
 			} );
 
 
@@ -124,6 +125,8 @@ namespace Saturn {
 
 				if( HasRegistry )
 					MaterialRegistry::Serialise( mc.MaterialRegistry, rStream );
+
+				RawSerialisation::WriteObject( mc.Occluder, rStream );
 			} );
 
 		// Script Component
@@ -248,6 +251,27 @@ namespace Saturn {
 				RawSerialisation::WriteObject( alc.ConeInnerAngle, rStream );
 				RawSerialisation::WriteObject( alc.ConeOuterAngle, rStream );
 			} );
+
+		// Instanced Mesh Component
+		WriteComponent<InstancedStaticMeshComponent>( rEntity, rStream, [&]()
+			{
+				auto& imc = rEntity->GetComponent< InstancedStaticMeshComponent >();
+
+				AssetID ID = 0;
+
+				if( imc.Mesh )
+					ID = imc.Mesh->ID;
+
+				RawSerialisation::WriteObject( ID, rStream );
+				RawSerialisation::WriteObject( imc.CastShadows, rStream );
+				RawSerialisation::WriteVector( imc.Instances, rStream );
+			} );
+
+		// Particle Emitter Component
+		WriteComponent<ParticleEmitterComponent>( rEntity, rStream, [&]()
+			{
+				ParticleEmitterSettings::Serialise( rEntity->GetComponent< ParticleEmitterComponent >().Settings, rStream );
+			} );
 	}
 
 	void RawEntitySerialisation::DeserialiseEntity( Ref<Entity>& rEntity, std::istream& rStream )
@@ -273,6 +297,7 @@ namespace Saturn {
 				RawSerialisation::ReadVec3( tc.Position, rStream );
 				RawSerialisation::ReadVec3( rotation, rStream );
 				RawSerialisation::ReadVec3( tc.Scale, rStream );
+				RawSerialisation::ReadObject( tc.Mobility, rStream );
 
 				tc.SetRotation( rotation );
 			} );
@@ -316,6 +341,8 @@ namespace Saturn {
 				if( HasRegistry )
 					MaterialRegistry::Deserialise( mc.MaterialRegistry, rStream );
 
+				RawSerialisation::ReadObject( mc.Occluder, rStream );
+
 				if( ID != 0 )
 				{
 					// Load Mesh
@@ -452,6 +479,29 @@ namespace Saturn {
 				RawSerialisation::ReadObject( alc.ConeInnerAngle, rStream );
 				RawSerialisation::ReadObject( alc.ConeOuterAngle, rStream );
 			} );
+
+		// Instanced Mesh Component
+		ReadComponent<InstancedStaticMeshComponent>( rEntity, rStream, [&]()
+			{
+				auto& imc = rEntity->GetComponent< InstancedStaticMeshComponent >();
+
+				AssetID ID = 0;
+
+				RawSerialisation::ReadObject( ID, rStream );
+				RawSerialisation::ReadObject( imc.CastShadows, rStream );
+				RawSerialisation::ReadVector( imc.Instances, rStream );
+
+				if( ID != 0 )
+					imc.Mesh = AssetManager::Get().GetAssetAs<StaticMesh>( ID );
+
+				imc.MarkDirty();
+			} );
+
+		// Particle Emitter Component
+		ReadComponent<ParticleEmitterComponent>( rEntity, rStream, [&]()
+			{
+				ParticleEmitterSettings::Deserialise( rEntity->GetComponent< ParticleEmitterComponent >().Settings, rStream );
+			} );
 	}
 
 }
\ No newline at end of file
@@ -62,6 +62,7 @@ namespace Saturn {
 			rEmitter << YAML::Key << "Rotation" << YAML::Value << glm::degrees( tc.GetRotationEuler() );
 			rEmitter << YAML::Key << "Quaternion" << YAML::Value << tc.GetRotation();
 			rEmitter << YAML::Key << "Scale" << YAML::Value << tc.Scale;
+			rEmitter << YAML::Key << "Mobility" << YAML::Value << ( int ) tc.Mobility;
 
 			rEmitter << YAML::EndMap;
 		}
@@ -151,6 +152,37 @@ namespace Saturn {
 
 			rEmitter << YAML::EndMap;
 
+			rEmitter << YAML::Key << "Occluder" << YAML::Value << mc.Occluder;
+
+			rEmitter << YAML::EndMap;
+		}
+
+		// Instanced Mesh Component
+		if( entity->HasComponent<InstancedStaticMeshComponent>() )
+		{
+			rEmitter << YAML::Key << "InstancedMeshComponent";
+			rEmitter << YAML::BeginMap;
+
+			auto& imc = entity->GetComponent< InstancedStaticMeshComponent >();
+
+			rEmitter << YAML::Key << "Asset" << YAML::Value << ( imc.Mesh ? ( uint64_t ) imc.Mesh->ID : 0 );
+			rEmitter << YAML::Key << "CastShadows" << YAML::Value << imc.CastShadows;
+
+			// One flow sequence per instance (position, rotation, scale), scenes can hold thousands of instances.
+			rEmitter << YAML::Key << "Instances";
+			rEmitter << YAML::BeginSeq;
+
+			for( const auto& rInstance : imc.Instances )
+			{
+				rEmitter << YAML::Flow << YAML::BeginSeq;
+				rEmitter << rInstance.Position.x << rInstance.Position.y << rInstance.Position.z;
+				rEmitter << rInstance.Rotation.w << rInstance.Rotation.x << rInstance.Rotation.y << rInstance.Rotation.z;
+				rEmitter << rInstance.Scale.x << rInstance.Scale.y << rInstance.Scale.z;
+				rEmitter << YAML::EndSeq;
+			}
+
+			rEmitter << YAML::EndSeq;
+
 			rEmitter << YAML::EndMap;
 		}
 
@@ -337,6 +369,44 @@ namespace Saturn {
 			rEmitter << YAML::EndMap;
 		}
 
+		// Particle Emitter Component
+		if( entity->HasComponent<ParticleEmitterComponent>() )
+		{
+			rEmitter << YAML::Key << "ParticleEmitterComponent";
+			rEmitter << YAML::BeginMap;
+
+			auto& rSettings = entity->GetComponent< ParticleEmitterComponent >().Settings;
+
+			rEmitter << YAML::Key << "SpawnRate"        << YAML::Value << rSettings.SpawnRate;
+			rEmitter << YAML::Key << "MaxParticles"     << YAML::Value << rSettings.MaxParticles;
+			rEmitter << YAML::Key << "MinLifetime"      << YAML::Value << rSettings.MinLifetime;
+			rEmitter << YAML::Key << "MaxLifetime"      << YAML::Value << rSettings.MaxLifetime;
+			rEmitter << YAML::Key << "SpawnRadius"      << YAML::Value << rSettings.SpawnRadius;
+			rEmitter << YAML::Key << "MinVelocity"      << YAML::Value << rSettings.MinVelocity;
+			rEmitter << YAML::Key << "MaxVelocity"      << YAML::Value << rSettings.MaxVelocity;
+			rEmitter << YAML::Key << "Gravity"          << YAML::Value << rSettings.Gravity;
+			rEmitter << YAML::Key << "Drag"             << YAML::Value << rSettings.Drag;
+			rEmitter << YAML::Key << "StartSize"        << YAML::Value << rSettings.StartSize;
+			rEmitter << YAML::Key << "EndSize"          << YAML::Value << rSettings.EndSize;
+			rEmitter << YAML::Key << "ThrottleDistance" << YAML::Value << rSettings.ThrottleDistance;
+			rEmitter << YAML::Key << "CullDistance"     << YAML::Value << rSettings.CullDistance;
+
+			rEmitter << YAML::Key << "ColorKeys";
+			rEmitter << YAML::BeginSeq;
+
+			for( const auto& rKey : rSettings.ColorKeys )
+			{
+				rEmitter << YAML::BeginMap;
+				rEmitter << YAML::Key << "Time"  << YAML::Value << rKey.Time;
+				rEmitter << YAML::Key << "Color" << YAML::Value << rKey.Color;
+				rEmitter << YAML::EndMap;
+			}
+
+			rEmitter << YAML::EndSeq;
+
+			rEmitter << YAML::EndMap;
+		}
+
 		rEmitter << YAML::EndMap;
 	}
 
@@ -393,6 +463,7 @@ namespace Saturn {
 				//t.SetRotation( tc[ "Quaternion" ].as< glm::quat >() );
 
 				t.Scale = tc[ "Scale" ].as< glm::vec3 >();
+				t.Mobility = ( Mobility ) tc[ "Mobility" ].as< int >( ( int ) Mobility::Movable );
 			}
 
 			auto mc = entity[ "MeshComponent" ];
@@ -402,6 +473,8 @@ namespace Saturn {
 
 				auto id = mc[ "Asset" ].as<uint64_t>( 0 );
 
+				m.Occluder = mc[ "Occluder" ].as<bool>( false );
+
 				if( id != 0 ) 
 				{
 					auto mesh = AssetManager::Get().GetAssetAs<StaticMesh>( id );
@@ -442,6 +515,38 @@ namespace Saturn {
 				}
 			}
 
+			auto imc = entity[ "InstancedMeshComponent" ];
+			if( imc )
+			{
+				auto& im = DeserialisedEntity->AddComponent< InstancedStaticMeshComponent >();
+
+				auto id = imc[ "Asset" ].as<uint64_t>( 0 );
+
+				if( id != 0 )
+					im.Mesh = AssetManager::Get().GetAssetAs<StaticMesh>( id );
+
+				im.CastShadows = imc[ "CastShadows" ].as<bool>( true );
+
+				auto instances = imc[ "Instances" ];
+				if( instances )
+				{
+					im.Instances.reserve( instances.size() );
+
+					for( auto instance : instances )
+					{
+						if( instance.size() != 10 )
+							continue;
+
+						MeshInstance& rInstance = im.Instances.emplace_back();
+						rInstance.Position = { instance[ 0 ].as<float>(), instance[ 1 ].as<float>(), instance[ 2 ].as<float>() };
+						rInstance.Rotation = glm::quat( instance[ 3 ].as<float>(), instance[ 4 ].as<float>(), instance[ 5 ].as<float>(), instance[ 6 ].as<float>() );
+						rInstance.Scale = { instance[ 7 ].as<float>(), instance[ 8 ].as<float>(), instance[ 9 ].as<float>() };
+					}
+				}
+
+				im.MarkDirty();
+			}
+
 			auto rcNode = entity[ "RelationshipComponent" ];
 			auto& rc = DeserialisedEntity->GetComponent<RelationshipComponent>();
 			rc.Parent = rcNode[ "Parent" ] ? rcNode[ "Parent" ].as<uint64_t>() : 0;
@@ -592,6 +697,36 @@ namespace Saturn {
 				al.ConeInnerAngle = alc[ "ConeInner" ].as< float >( 0.0f );
 				al.ConeOuterAngle = alc[ "ConeOuter" ].as< float >( 0.0f );
 			}
+
+			auto pec = entity[ "ParticleEmitterComponent" ];
+			if( pec )
+			{
+				auto& rSettings = DeserialisedEntity->AddComponent< ParticleEmitterComponent >().Settings;
+				const ParticleEmitterSettings Defaults;
+
+				rSettings.SpawnRate        = pec[ "SpawnRate" ].as< float >( Defaults.SpawnRate );
+				rSettings.MaxParticles     = pec[ "MaxParticles" ].as< uint32_t >( Defaults.MaxParticles );
+				rSettings.MinLifetime      = pec[ "MinLifetime" ].as< float >( Defaults.MinLifetime );
+				rSettings.MaxLifetime      = pec[ "MaxLifetime" ].as< float >( Defaults.MaxLifetime );
+				rSettings.SpawnRadius      = pec[ "SpawnRadius" ].as< float >( Defaults.SpawnRadius );
+				rSettings.MinVelocity      = pec[ "MinVelocity" ].as< glm::vec3 >( Defaults.MinVelocity );
+				rSettings.MaxVelocity      = pec[ "MaxVelocity" ].as< glm::vec3 >( Defaults.MaxVelocity );
+				rSettings.Gravity          = pec[ "Gravity" ].as< glm::vec3 >( Defaults.Gravity );
+				rSettings.Drag             = pec[ "Drag" ].as< float >( Defaults.Drag );
+				rSettings.StartSize        = pec[ "StartSize" ].as< float >( Defaults.StartSize );
+				rSettings.EndSize          = pec[ "EndSize" ].as< float >( Defaults.EndSize );
+				rSettings.ThrottleDistance = pec[ "ThrottleDistance" ].as< float >( Defaults.ThrottleDistance );
+				rSettings.CullDistance     = pec[ "CullDistance" ].as< float >( Defaults.CullDistance );
+
+				auto keys = pec[ "ColorKeys" ];
+				if( keys )
+				{
+					rSettings.ColorKeys.clear();
+
+					for( auto key : keys )
+						rSettings.ColorKeys.push_back( { key[ "Time" ].as< float >( 0.0f ), key[ "Color" ].as< glm::vec4 >( glm::vec4( 1.0f ) ) } );
+				}
+			}
 		}
 	}
 
@@ -0,0 +1,363 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#include "sppch.h"
+#include "BindlessTable.h"
+
+#include "VulkanContext.h"
+#include "VulkanAllocator.h"
+#include "VulkanDebug.h"
+#include "Texture.h"
+
+#include "Saturn/Core/OptickProfiler.h"
+
+namespace Saturn {
+
+	BindlessTable::BindlessTable()
+	{
+		VkDevice Device = VulkanContext::Get().GetDevice();
+		auto pAllocator = VulkanContext::Get().GetVulkanAllocator();
+
+		VkPhysicalDeviceDescriptorIndexingProperties IndexingProperties = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES };
+
+		VkPhysicalDeviceProperties2 Properties = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2 };
+		Properties.pNext = &IndexingProperties;
+
+		vkGetPhysicalDeviceProperties2( VulkanContext::Get().GetPhysicalDevice(), &Properties );
+
+		m_TextureCapacity = std::min( MaxTextures, IndexingProperties.maxDescriptorSetUpdateAfterBindSampledImages );
+		m_TextureCapacity = std::min( m_TextureCapacity, IndexingProperties.maxPerStageDescriptorUpdateAfterBindSampledImages );
+
+		// Set layout.
+		std::array<VkDescriptorSetLayoutBinding, 2> Bindings = {};
+		Bindings[ 0 ].binding = TextureBinding;
+		Bindings[ 0 ].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		Bindings[ 0 ].descriptorCount = m_TextureCapacity;
+		Bindings[ 0 ].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+		Bindings[ 1 ].binding = MaterialBinding;
+		Bindings[ 1 ].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		Bindings[ 1 ].descriptorCount = 1;
+		Bindings[ 1 ].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+		// Textures can be written while the set is bound, slots that are not used by a draw do not need to be valid.
+		std::array<VkDescriptorBindingFlags, 2> BindingFlags = {
+			VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_VARIABLE_DESCRIPTOR_COUNT_BIT,
+			0
+		};
+
+		VkDescriptorSetLayoutBindingFlagsCreateInfo BindingFlagsInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO };
+		BindingFlagsInfo.bindingCount = ( uint32_t ) BindingFlags.size();
+		BindingFlagsInfo.pBindingFlags = BindingFlags.data();
+
+		VkDescriptorSetLayoutCreateInfo LayoutInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO };
+		LayoutInfo.pNext = &BindingFlagsInfo;
+		LayoutInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+		LayoutInfo.bindingCount = ( uint32_t ) Bindings.size();
+		LayoutInfo.pBindings = Bindings.data();
+
+		VK_CHECK( vkCreateDescriptorSetLayout( Device, &LayoutInfo, nullptr, &m_SetLayout ) );
+		SetDebugUtilsObjectName( "Bindless Set Layout", ( uint64_t ) m_SetLayout, VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT );
+
+		// Pool, one set per frame in flight.
+		std::array<VkDescriptorPoolSize, 2> PoolSizes = {};
+		PoolSizes[ 0 ] = { .type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, .descriptorCount = m_TextureCapacity * MAX_FRAMES_IN_FLIGHT };
+		PoolSizes[ 1 ] = { .type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, .descriptorCount = MAX_FRAMES_IN_FLIGHT };
+
+		VkDescriptorPoolCreateInfo PoolInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO };
+		PoolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+		PoolInfo.maxSets = MAX_FRAMES_IN_FLIGHT;
+		PoolInfo.poolSizeCount = ( uint32_t ) PoolSizes.size();
+		PoolInfo.pPoolSizes = PoolSizes.data();
+
+		VK_CHECK( vkCreateDescriptorPool( Device, &PoolInfo, nullptr, &m_DescriptorPool ) );
+
+		for( uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++ )
+		{
+			VkDescriptorSetVariableDescriptorCountAllocateInfo VariableCountInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_VARIABLE_DESCRIPTOR_COUNT_ALLOCATE_INFO };
+			VariableCountInfo.descriptorSetCount = 1;
+			VariableCountInfo.pDescriptorCounts = &m_TextureCapacity;
+
+			VkDescriptorSetAllocateInfo AllocateInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
+			AllocateInfo.pNext = &VariableCountInfo;
+			AllocateInfo.descriptorPool = m_DescriptorPool;
+			AllocateInfo.descriptorSetCount = 1;
+			AllocateInfo.pSetLayouts = &m_SetLayout;
+
+			VK_CHECK( vkAllocateDescriptorSets( Device, &AllocateInfo, &m_DescriptorSets[ i ] ) );
+
+			// Material buffer.
+			VkBufferCreateInfo BufferInfo = { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+			BufferInfo.size = sizeof( BindlessMaterial ) * MaxMaterials;
+			BufferInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+			BufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+			auto Allocation = pAllocator->AllocateBuffer( BufferInfo, VMA_MEMORY_USAGE_CPU_TO_GPU, &m_MaterialBuffers[ i ] );
+			m_pMaterialData[ i ] = pAllocator->MapMemory< BindlessMaterial >( Allocation );
+
+			SetDebugUtilsObjectName( std::format( "Bindless Materials {0}", i ), ( uint64_t ) m_MaterialBuffers[ i ], VK_OBJECT_TYPE_BUFFER );
+
+			VkDescriptorBufferInfo BufferDescriptor = { .buffer = m_MaterialBuffers[ i ], .offset = 0, .range = VK_WHOLE_SIZE };
+
+			VkWriteDescriptorSet Write = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+			Write.dstSet = m_DescriptorSets[ i ];
+			Write.dstBinding = MaterialBinding;
+			Write.descriptorCount = 1;
+			Write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			Write.pBufferInfo = &BufferDescriptor;
+
+			vkUpdateDescriptorSets( Device, 1, &Write, 0, nullptr );
+		}
+
+		m_Materials.reserve( MaxMaterials );
+
+		SAT_CORE_INFO( "Bindless table: {0} texture slots, {1} material slots", m_TextureCapacity, MaxMaterials );
+	}
+
+	BindlessTable::~BindlessTable()
+	{
+		Terminate();
+	}
+
+	void BindlessTable::Terminate()
+	{
+		if( !m_SetLayout )
+			return;
+
+		VkDevice Device = VulkanContext::Get().GetDevice();
+		auto pAllocator = VulkanContext::Get().GetVulkanAllocator();
+
+		for( uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++ )
+		{
+			pAllocator->UnmapMemory( pAllocator->GetAllocationFromBuffer( m_MaterialBuffers[ i ] ) );
+			pAllocator->DestroyBuffer( m_MaterialBuffers[ i ] );
+
+			m_MaterialBuffers[ i ] = nullptr;
+			m_pMaterialData[ i ] = nullptr;
+		}
+
+		vkDestroyDescriptorPool( Device, m_DescriptorPool, nullptr );
+		vkDestroyDescriptorSetLayout( Device, m_SetLayout, nullptr );
+
+		m_DescriptorPool = nullptr;
+		m_SetLayout = nullptr;
+
+		m_TextureSlots.clear();
+
+		for( auto& rWrites : m_PendingTextureWrites )
+			rWrites.clear();
+	}
+
+	uint32_t BindlessTable::RegisterTexture( Texture2D* pTexture )
+	{
+		std::lock_guard<std::mutex> Lock( m_Mutex );
+
+		auto Itr = m_TextureSlots.find( pTexture );
+
+		if( Itr != m_TextureSlots.end() )
+		{
+			// The texture was recreated (i.e. new data or mips), point the slot at the new view.
+			if( Itr->second.ImageView != pTexture->GetImageView() )
+			{
+				Itr->second.ImageView = pTexture->GetImageView();
+				WriteTexture( Itr->second.Slot, pTexture );
+			}
+
+			return Itr->second.Slot;
+		}
+
+		uint32_t Slot = 0;
+
+		if( m_FreeTextureSlots.size() )
+		{
+			Slot = m_FreeTextureSlots.back();
+			m_FreeTextureSlots.pop_back();
+		}
+		else
+		{
+			SAT_CORE_ASSERT( m_TextureCount < m_TextureCapacity, "Bindless texture table is full!" );
+
+			Slot = m_TextureCount++;
+		}
+
+		m_TextureSlots[ pTexture ] = { .Slot = Slot, .ImageView = pTexture->GetImageView() };
+
+		WriteTexture( Slot, pTexture );
+
+		return Slot;
+	}
+
+	void BindlessTable::ReleaseTexture( Texture2D* pTexture )
+	{
+		std::lock_guard<std::mutex> Lock( m_Mutex );
+
+		auto Itr = m_TextureSlots.find( pTexture );
+
+		if( Itr == m_TextureSlots.end() )
+			return;
+
+		const uint32_t Slot = Itr->second.Slot;
+
+		// The image view is about to be destroyed, writes that have not happened yet must not reference it.
+		for( auto& rWrites : m_PendingTextureWrites )
+			std::erase_if( rWrites, [Slot]( const TextureWrite& rWrite ) { return rWrite.Slot == Slot; } );
+
+		m_PendingTextureFrees.push_back( { .Index = Slot, .RetireFrame = m_FrameNumber + MAX_FRAMES_IN_FLIGHT } );
+		m_TextureSlots.erase( Itr );
+	}
+
+	void BindlessTable::RefreshTexture( Texture2D* pTexture )
+	{
+		std::lock_guard<std::mutex> Lock( m_Mutex );
+
+		auto Itr = m_TextureSlots.find( pTexture );
+
+		if( Itr == m_TextureSlots.end() || Itr->second.ImageView == pTexture->GetImageView() )
+			return;
+
+		Itr->second.ImageView = pTexture->GetImageView();
+		WriteTexture( Itr->second.Slot, pTexture );
+	}
+
+	uint32_t BindlessTable::AllocateMaterial()
+	{
+		std::lock_guard<std::mutex> Lock( m_Mutex );
+
+		uint32_t Index = 0;
+
+		if( m_FreeMaterials.size() )
+		{
+			Index = m_FreeMaterials.back();
+			m_FreeMaterials.pop_back();
+		}
+		else
+		{
+			SAT_CORE_ASSERT( m_MaterialCount < MaxMaterials, "Bindless material table is full!" );
+
+			Index = m_MaterialCount++;
+			m_Materials.emplace_back();
+		}
+
+		return Index;
+	}
+
+	void BindlessTable::ReleaseMaterial( uint32_t Index )
+	{
+		std::lock_guard<std::mutex> Lock( m_Mutex );
+
+		m_PendingMaterialFrees.push_back( { .Index = Index, .RetireFrame = m_FrameNumber + MAX_FRAMES_IN_FLIGHT } );
+	}
+
+	void BindlessTable::SetMaterial( uint32_t Index, const BindlessMaterial& rMaterial )
+	{
+		std::lock_guard<std::mutex> Lock( m_Mutex );
+
+		m_Materials[ Index ] = rMaterial;
+		m_MaterialVersion++;
+	}
+
+	void BindlessTable::Update( uint32_t Frame )
+	{
+		SAT_PF_EVENT();
+
+		std::lock_guard<std::mutex> Lock( m_Mutex );
+
+		if( Frame != m_CurrentFrame )
+			m_FrameNumber++;
+
+		m_CurrentFrame = Frame;
+
+		// Anything released MAX_FRAMES_IN_FLIGHT frames ago can no longer be referenced by a frame on the GPU.
+		auto Recycle = [this]( std::vector<PendingFree>& rPending, std::vector<uint32_t>& rFree )
+		{
+			std::erase_if( rPending, [&]( const PendingFree& rEntry )
+				{
+					if( m_FrameNumber < rEntry.RetireFrame )
+						return false;
+
+					rFree.push_back( rEntry.Index );
+					return true;
+				} );
+		};
+
+		Recycle( m_PendingTextureFrees, m_FreeTextureSlots );
+		Recycle( m_PendingMaterialFrees, m_FreeMaterials );
+
+		// The GPU is done with this frame's set, catch it up with the textures that changed while it was in flight.
+		if( m_PendingTextureWrites[ Frame ].size() )
+		{
+			std::vector<VkWriteDescriptorSet> Writes( m_PendingTextureWrites[ Frame ].size() );
+
+			for( size_t i = 0; i < Writes.size(); i++ )
+			{
+				Writes[ i ] = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+				Writes[ i ].dstSet = m_DescriptorSets[ Frame ];
+				Writes[ i ].dstBinding = TextureBinding;
+				Writes[ i ].dstArrayElement = m_PendingTextureWrites[ Frame ][ i ].Slot;
+				Writes[ i ].descriptorCount = 1;
+				Writes[ i ].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+				Writes[ i ].pImageInfo = &m_PendingTextureWrites[ Frame ][ i ].ImageInfo;
+			}
+
+			vkUpdateDescriptorSets( VulkanContext::Get().GetDevice(), ( uint32_t ) Writes.size(), Writes.data(), 0, nullptr );
+
+			m_PendingTextureWrites[ Frame ].clear();
+		}
+
+		if( m_FrameVersions[ Frame ] == m_MaterialVersion )
+			return;
+
+		memcpy( m_pMaterialData[ Frame ], m_Materials.data(), m_Materials.size() * sizeof( BindlessMaterial ) );
+
+		m_FrameVersions[ Frame ] = m_MaterialVersion;
+	}
+
+	void BindlessTable::WriteTexture( uint32_t Slot, Texture2D* pTexture )
+	{
+		VkDescriptorImageInfo ImageInfo = {};
+		ImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		ImageInfo.imageView = pTexture->GetImageView();
+		ImageInfo.sampler = pTexture->GetSampler();
+
+		VkWriteDescriptorSet Write = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+		Write.dstSet = m_DescriptorSets[ m_CurrentFrame ];
+		Write.dstBinding = TextureBinding;
+		Write.dstArrayElement = Slot;
+		Write.descriptorCount = 1;
+		Write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		Write.pImageInfo = &ImageInfo;
+
+		vkUpdateDescriptorSets( VulkanContext::Get().GetDevice(), 1, &Write, 0, nullptr );
+
+		for( uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++ )
+		{
+			if( i != m_CurrentFrame )
+				m_PendingTextureWrites[ i ].push_back( { .Slot = Slot, .ImageInfo = ImageInfo } );
+		}
+	}
+}
@@ -0,0 +1,162 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#pragma once
+
+#include "Base.h"
+
+#include <glm/glm.hpp>
+
+#include <vulkan.h>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace Saturn {
+
+	class Texture2D;
+
+	// Matches "MaterialData" in shader_new.glsl (std430), one entry per material asset.
+	struct BindlessMaterial
+	{
+		glm::vec3 AlbedoColor = glm::vec3( 1.0f );
+		float UseNormalMap = 0.0f;
+
+		float Metalness = 1.0f;
+		float Roughness = 1.0f;
+		float Emissive = 0.0f;
+
+		// Slots in the bindless texture array.
+		uint32_t AlbedoTexture = 0;
+		uint32_t NormalTexture = 0;
+		uint32_t MetallicTexture = 0;
+		uint32_t RoughnessTexture = 0;
+
+		uint32_t Padding = 0;
+	};
+
+	static_assert( sizeof( BindlessMaterial ) == 48, "BindlessMaterial must match the std430 layout of MaterialData." );
+
+	// Global descriptor table that holds every resident texture and every material.
+	// Textures are written once into a partially bound sampler array, materials are stored in a storage buffer that references textures by slot.
+	// Shaders that declare set 2 share this layout, a draw only has to push the index of its material.
+	class BindlessTable
+	{
+	public:
+		static constexpr uint32_t SetIndex = 2;
+		static constexpr uint32_t TextureBinding = 0;
+		static constexpr uint32_t MaterialBinding = 1;
+
+		static constexpr uint32_t MaxTextures = 4096;
+		static constexpr uint32_t MaxMaterials = 4096;
+
+	public:
+		BindlessTable();
+		~BindlessTable();
+
+		void Terminate();
+
+		// Returns the slot of the texture, the texture is written into the table the first time it is seen or when its image view has changed.
+		uint32_t RegisterTexture( Texture2D* pTexture );
+		// Called when the texture is destroyed, the slot is reused once the frames that could still sample it have finished.
+		void ReleaseTexture( Texture2D* pTexture );
+		// Points the slot of an already registered texture at its current image view, textures without a slot are left alone.
+		void RefreshTexture( Texture2D* pTexture );
+
+		uint32_t AllocateMaterial();
+		void ReleaseMaterial( uint32_t Index );
+		void SetMaterial( uint32_t Index, const BindlessMaterial& rMaterial );
+
+		// Copies changed materials into the buffer of this frame, applies texture writes that were waiting for this frame and recycles slots that are no longer in use, call before recording draws.
+		void Update( uint32_t Frame );
+
+		VkDescriptorSetLayout GetSetLayout() { return m_SetLayout; }
+		VkDescriptorSet GetDescriptorSet( uint32_t Frame ) { return m_DescriptorSets[ Frame ]; }
+
+		uint32_t GetTextureCount() const { return m_TextureCount; }
+		uint32_t GetMaterialCount() const { return m_MaterialCount; }
+
+	private:
+		void WriteTexture( uint32_t Slot, Texture2D* pTexture );
+
+	private:
+		VkDescriptorSetLayout m_SetLayout = nullptr;
+		VkDescriptorPool m_DescriptorPool = nullptr;
+
+		VkDescriptorSet m_DescriptorSets[ MAX_FRAMES_IN_FLIGHT ]{};
+
+		// One material buffer per frame so the CPU never writes into a buffer the GPU is reading.
+		VkBuffer m_MaterialBuffers[ MAX_FRAMES_IN_FLIGHT ]{};
+		BindlessMaterial* m_pMaterialData[ MAX_FRAMES_IN_FLIGHT ]{};
+		uint64_t m_FrameVersions[ MAX_FRAMES_IN_FLIGHT ]{};
+
+		std::vector<BindlessMaterial> m_Materials;
+		uint64_t m_MaterialVersion = 1;
+
+		struct TextureSlot
+		{
+			uint32_t Slot = 0;
+			VkImageView ImageView = nullptr;
+		};
+
+		std::unordered_map<Texture2D*, TextureSlot> m_TextureSlots;
+
+		struct TextureWrite
+		{
+			uint32_t Slot = 0;
+			VkDescriptorImageInfo ImageInfo = {};
+		};
+
+		// Only the set of the current frame is written straight away, the sets of the other frames may still be used by the GPU.
+		// Their writes wait here until that frame comes around in Update.
+		std::vector<TextureWrite> m_PendingTextureWrites[ MAX_FRAMES_IN_FLIGHT ];
+
+		uint32_t m_TextureCount = 0;
+		uint32_t m_MaterialCount = 0;
+		uint32_t m_TextureCapacity = MaxTextures;
+
+		std::vector<uint32_t> m_FreeTextureSlots;
+		std::vector<uint32_t> m_FreeMaterials;
+
+		struct PendingFree
+		{
+			uint32_t Index = 0;
+			uint64_t RetireFrame = 0;
+		};
+
+		// Slots released during a frame, they are only free again once every frame that could still reference them has finished.
+		// Update can be called more than once per frame, so this counts frames rather than relying on the frame index coming around.
+		std::vector<PendingFree> m_PendingTextureFrees;
+		std::vector<PendingFree> m_PendingMaterialFrees;
+
+		uint32_t m_CurrentFrame = 0;
+		uint64_t m_FrameNumber = 0;
+
+		std::mutex m_Mutex;
+	};
+}
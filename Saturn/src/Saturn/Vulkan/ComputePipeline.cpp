@@ -31,6 +31,8 @@
 
 #include "VulkanContext.h"
 #include "VulkanDebug.h"
+#include "PipelineCache.h"
+#include "UploadManager.h"
 
 namespace Saturn {
 
@@ -71,7 +73,10 @@ namespace Saturn {
 
 	void ComputePipeline::Execute( VkDescriptorSet DescriptorSet, uint32_t X, uint32_t Y, uint32_t Z )
 	{
-		vkCmdBindDescriptorSets( m_CommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_PipelineLayout, 0, 1, &DescriptorSet, 0, nullptr );
+		uint32_t DynamicOffsets[ Shader::MaxDynamicOffsets ];
+		uint32_t DynamicOffsetCount = m_ComputeShader->GetDynamicOffsets( 0, DynamicOffsets );
+
+		vkCmdBindDescriptorSets( m_CommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_PipelineLayout, 0, 1, &DescriptorSet, DynamicOffsetCount, DynamicOffsets );
 
 		vkCmdDispatch( m_CommandBuffer, X, Y, Z );
 	}
@@ -92,6 +97,10 @@ namespace Saturn {
 
 		vkEndCommandBuffer( m_CommandBuffer );
 
+		// The compute queue is not ordered with the upload batches, make sure anything this dispatch reads has landed.
+		UploadManager* pUploadManager = VulkanContext::Get().GetUploadManager();
+		pUploadManager->Wait( pUploadManager->Flush() );
+
 		if( !s_ComputeFence )
 		{
 			VkFenceCreateInfo FenceCreateInfo = { VK_STRUCTURE_TYPE_FENCE_CREATE_INFO };
@@ -107,7 +116,10 @@ namespace Saturn {
 		Info.commandBufferCount = 1;
 		Info.pCommandBuffers = &m_CommandBuffer;
 
-		VK_CHECK( vkQueueSubmit( ComputeQueue, 1, &Info, s_ComputeFence ) );
+		{
+			std::lock_guard<std::mutex> QueueLock( VulkanContext::Get().GetQueueMutex() );
+			VK_CHECK( vkQueueSubmit( ComputeQueue, 1, &Info, s_ComputeFence ) );
+		}
 
 		// Wait for shader execution.
 		vkWaitForFences( LogicalDevice, 1, &s_ComputeFence, VK_TRUE, UINT64_MAX );
@@ -166,7 +178,7 @@ namespace Saturn {
 		ComputePipelineCreateInfo.layout = m_PipelineLayout;
 		ComputePipelineCreateInfo.stage = ShaderStage;
 
-		VK_CHECK( vkCreateComputePipelines( VulkanContext::Get().GetDevice(), nullptr, 1, &ComputePipelineCreateInfo, nullptr, &m_Pipeline ) );
+		VK_CHECK( vkCreateComputePipelines( VulkanContext::Get().GetDevice(), VulkanContext::Get().GetPipelineCache()->GetThreadCache(), 1, &ComputePipelineCreateInfo, nullptr, &m_Pipeline ) );
 
 		vkDestroyShaderModule( VulkanContext::Get().GetDevice(), ShaderModule, nullptr );
 
@@ -106,9 +106,9 @@ namespace Saturn {
 		vkUpdateDescriptorSets( VulkanContext::Get().GetDevice(), (uint32_t)WriteDescriptorSets.size(), WriteDescriptorSets.data(), 0, nullptr );
 	}
 
-	void DescriptorSet::Bind( VkCommandBuffer CommandBuffer, VkPipelineLayout PipelineLayout )
+	void DescriptorSet::Bind( VkCommandBuffer CommandBuffer, VkPipelineLayout PipelineLayout, uint32_t DynamicOffsetCount, const uint32_t* pDynamicOffsets )
 	{
-		vkCmdBindDescriptorSets( CommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, PipelineLayout, 0, 1, &m_Set, 0, nullptr );
+		vkCmdBindDescriptorSets( CommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, PipelineLayout, 0, 1, &m_Set, DynamicOffsetCount, pDynamicOffsets );
 	}
 
 	void DescriptorSet::Allocate()
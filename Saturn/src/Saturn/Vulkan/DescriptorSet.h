@@ -122,7 +122,8 @@ namespace Saturn {
 		void Write( VkDescriptorBufferInfo BufferInfo, VkDescriptorImageInfo ImageInfo );
 		void Write( std::vector< VkWriteDescriptorSet > WriteDescriptorSets );
 
-		void Bind( VkCommandBuffer CommandBuffer, VkPipelineLayout PipelineLayout );
+		// Sets with uniform buffers need their dynamic offsets, see Shader::GetDynamicOffsets.
+		void Bind( VkCommandBuffer CommandBuffer, VkPipelineLayout PipelineLayout, uint32_t DynamicOffsetCount = 0, const uint32_t* pDynamicOffsets = nullptr );
 		
 		uint32_t GetSetIndex() const { return m_Specification.SetIndex; }
 
@@ -0,0 +1,246 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#include "sppch.h"
+#include "DynamicSkyBuilder.h"
+
+#include "Saturn/Core/App.h"
+#include "Saturn/Core/JobSystem.h"
+#include "Saturn/Core/OptickProfiler.h"
+#include "Saturn/Core/Timer.h"
+#include "Saturn/Core/Renderer/IBLPrecompute.h"
+#include "Saturn/Project/Project.h"
+
+#include <thread>
+
+namespace Saturn {
+
+	DynamicSkyBuilder::DynamicSkyBuilder()
+	{
+	}
+
+	DynamicSkyBuilder::~DynamicSkyBuilder()
+	{
+		Terminate();
+	}
+
+	void DynamicSkyBuilder::Terminate()
+	{
+		// The job writes its result into the builder.
+		while( m_JobInFlight )
+			std::this_thread::yield();
+
+		std::lock_guard<std::mutex> Lock( m_Mutex );
+
+		FreeMips( m_FinishedMips );
+		FreeMips( m_UploadMips );
+
+		m_Finished = false;
+		m_HasRequest = false;
+		m_Uploading = nullptr;
+
+		for( auto& rMap : m_Retired )
+			rMap = nullptr;
+	}
+
+	Ref<TextureCube> DynamicSkyBuilder::Build( const DynamicSkyParameters& rParameters )
+	{
+		SAT_PF_EVENT();
+
+		std::vector<Buffer> Mips = LoadOrGenerate( rParameters );
+
+		Ref<TextureCube> Map = Ref<TextureCube>::Create( ImageFormat::RGBA32F, CubeSize );
+
+		for( uint32_t Mip = 0; Mip < ( uint32_t ) Mips.size(); Mip++ )
+		{
+			const size_t FaceSize = Mips[ Mip ].Size / 6;
+
+			for( uint32_t Face = 0; Face < 6; Face++ )
+				Map->UploadFace( Mip, Face, Mips[ Mip ].Data + Face * FaceSize, FaceSize );
+		}
+
+		FreeMips( Mips );
+
+		return Map;
+	}
+
+	void DynamicSkyBuilder::Request( const DynamicSkyParameters& rParameters )
+	{
+		m_Request = rParameters;
+		m_HasRequest = true;
+	}
+
+	Ref<TextureCube> DynamicSkyBuilder::Update( uint32_t Frame, Ref<TextureCube> Current )
+	{
+		SAT_PF_EVENT();
+
+		// The last time this frame index was used has finished, nothing can sample the map retired back then.
+		m_Retired[ Frame ] = nullptr;
+
+		{
+			std::lock_guard<std::mutex> Lock( m_Mutex );
+
+			if( m_Finished )
+			{
+				m_Finished = false;
+
+				// Nobody wants this sky any more.
+				if( m_HasRequest )
+				{
+					FreeMips( m_FinishedMips );
+				}
+				else
+				{
+					FreeMips( m_UploadMips );
+
+					m_UploadMips = std::move( m_FinishedMips );
+					m_FinishedMips.clear();
+
+					m_Uploading = Ref<TextureCube>::Create( ImageFormat::RGBA32F, CubeSize );
+					m_UploadMip = 0;
+					m_UploadFace = 0;
+				}
+			}
+		}
+
+		if( m_HasRequest && !m_JobInFlight )
+		{
+			m_HasRequest = false;
+
+			// A half uploaded map is of no use once the sky has changed again.
+			m_Uploading = nullptr;
+			FreeMips( m_UploadMips );
+
+			StartJob( m_Request );
+		}
+
+		if( !m_Uploading )
+			return Current;
+
+		VkDeviceSize Uploaded = 0;
+
+		while( m_UploadMip < ( uint32_t ) m_UploadMips.size() && Uploaded < UploadBudget )
+		{
+			const Buffer& rMip = m_UploadMips[ m_UploadMip ];
+			const size_t FaceSize = rMip.Size / 6;
+
+			m_Uploading->UploadFace( m_UploadMip, m_UploadFace, rMip.Data + m_UploadFace * FaceSize, FaceSize );
+
+			Uploaded += FaceSize;
+
+			if( ++m_UploadFace == 6 )
+			{
+				m_UploadFace = 0;
+				m_UploadMip++;
+			}
+		}
+
+		if( m_UploadMip < ( uint32_t ) m_UploadMips.size() )
+			return Current;
+
+		FreeMips( m_UploadMips );
+
+		m_Retired[ Frame ] = Current;
+
+		Ref<TextureCube> Result = m_Uploading;
+		m_Uploading = nullptr;
+
+		return Result;
+	}
+
+	void DynamicSkyBuilder::StartJob( const DynamicSkyParameters& rParameters )
+	{
+		m_JobInFlight = true;
+
+		JobSystem::Get().AddJob( [this, rParameters]()
+			{
+				SAT_PF_EVENT();
+
+				std::vector<Buffer> Mips = LoadOrGenerate( rParameters );
+
+				{
+					std::lock_guard<std::mutex> Lock( m_Mutex );
+
+					FreeMips( m_FinishedMips );
+
+					m_FinishedMips = std::move( Mips );
+					m_Finished = true;
+				}
+
+				m_JobInFlight = false;
+			} );
+	}
+
+	std::vector<Buffer> DynamicSkyBuilder::LoadOrGenerate( const DynamicSkyParameters& rParameters )
+	{
+		SAT_PF_EVENT();
+
+		Timer BuildTimer;
+
+		const std::filesystem::path Directory = GetCacheDirectory();
+		const uint64_t Key = IBLPrecompute::GetSkyKey( CubeSize, rParameters.Turbidity, rParameters.Azimuth, rParameters.Inclination );
+
+		std::vector<Buffer> Mips;
+
+		if( IBLPrecompute::LoadCache( Directory, "Sky", Key, Mips ) && Mips.size() == 1 && Mips[ 0 ].Size == ( size_t ) CubeSize * CubeSize * 6 * 4 * sizeof( float ) )
+		{
+			IBLPrecompute::BuildCubeMips( Mips, CubeSize );
+
+			SAT_CORE_INFO( "Loaded dynamic sky from the cache in {0:.2f} ms", BuildTimer.ElapsedMilliseconds() );
+
+			return Mips;
+		}
+
+		FreeMips( Mips );
+
+		Mips.push_back( IBLPrecompute::GeneratePreethamSky( CubeSize, rParameters.Turbidity, rParameters.Azimuth, rParameters.Inclination ) );
+
+		IBLPrecompute::SaveCache( Directory, "Sky", Key, Mips, MaxCachedSkies );
+		IBLPrecompute::BuildCubeMips( Mips, CubeSize );
+
+		SAT_CORE_INFO( "Generated dynamic sky in {0:.2f} ms", BuildTimer.ElapsedMilliseconds() );
+
+		return Mips;
+	}
+
+	void DynamicSkyBuilder::FreeMips( std::vector<Buffer>& rMips )
+	{
+		for( Buffer& rMip : rMips )
+			rMip.Free();
+
+		rMips.clear();
+	}
+
+	std::filesystem::path DynamicSkyBuilder::GetCacheDirectory()
+	{
+		if( const auto& rProject = Project::GetActiveProject() )
+			return rProject->GetFullCachePath() / "IBL";
+
+		return Application::Get().GetAppDataFolder() / "IBL";
+	}
+}
@@ -0,0 +1,107 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#pragma once
+
+#include "Base.h"
+#include "Texture.h"
+#include "Saturn/Core/Memory/Buffer.h"
+
+#include <array>
+#include <atomic>
+#include <filesystem>
+#include <mutex>
+#include <vector>
+
+namespace Saturn {
+
+	struct DynamicSkyParameters
+	{
+		float Turbidity = 0.0f;
+		float Azimuth = 0.0f;
+		float Inclination = 0.0f;
+	};
+
+	// Builds the environment map of the dynamic (Preetham) sky without stalling the frame.
+	// The sky is generated on the job system and cached on disk by its parameters, a sky that was used before is only loaded again.
+	// The finished map is uploaded a few faces per frame into a new cube map, the scene keeps the old one until every face is on the GPU.
+	class DynamicSkyBuilder : public RefTarget
+	{
+	public:
+		static constexpr uint32_t CubeSize = 512;
+		// Skies kept in the cache, only the most detailed mip of each is stored and the rest is rebuilt when it is loaded.
+		static constexpr uint32_t MaxCachedSkies = 4;
+		static constexpr VkDeviceSize UploadBudget = 8ull * 1024 * 1024;
+
+	public:
+		DynamicSkyBuilder();
+		~DynamicSkyBuilder();
+
+		void Terminate();
+
+		// Loads or generates the sky on this thread, for when there is nothing to show yet.
+		Ref<TextureCube> Build( const DynamicSkyParameters& rParameters );
+
+		// Starts building the sky in the background, a newer request replaces one that has not finished yet.
+		void Request( const DynamicSkyParameters& rParameters );
+
+		// Uploads the next faces of a finished sky, returns the new map once all of it has been uploaded. Call once the frame's fence has been waited on.
+		Ref<TextureCube> Update( uint32_t Frame, Ref<TextureCube> Current );
+
+		bool IsBuilding() const { return m_HasRequest || m_JobInFlight || m_Uploading; }
+
+		// The project cache when a project is open, otherwise the engine's app data folder.
+		static std::filesystem::path GetCacheDirectory();
+
+	private:
+		static std::vector<Buffer> LoadOrGenerate( const DynamicSkyParameters& rParameters );
+		static void FreeMips( std::vector<Buffer>& rMips );
+
+		void StartJob( const DynamicSkyParameters& rParameters );
+
+	private:
+		DynamicSkyParameters m_Request;
+		bool m_HasRequest = false;
+
+		// Written by the job.
+		std::vector<Buffer> m_FinishedMips;
+		bool m_Finished = false;
+		std::atomic<bool> m_JobInFlight = false;
+
+		// The sky that is being uploaded and the next face to upload.
+		Ref<TextureCube> m_Uploading = nullptr;
+		std::vector<Buffer> m_UploadMips;
+		uint32_t m_UploadMip = 0;
+		uint32_t m_UploadFace = 0;
+
+		// Maps a frame could still be sampling, released when that frame comes around again.
+		std::array<Ref<TextureCube>, MAX_FRAMES_IN_FLIGHT> m_Retired;
+
+		std::mutex m_Mutex;
+	};
+}
@@ -0,0 +1,253 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#include "sppch.h"
+#include "GPUProfiler.h"
+
+#include "VulkanContext.h"
+#include "VulkanDebug.h"
+
+#include "Saturn/Core/OptickProfiler.h"
+
+namespace Saturn {
+
+	static constexpr uint32_t s_InvalidScope = ~0u;
+
+	GPUProfiler::GPUProfiler()
+	{
+		VkDevice Device = VulkanContext::Get().GetDevice();
+		VkPhysicalDevice PhysicalDevice = VulkanContext::Get().GetPhysicalDevice();
+
+		VkPhysicalDeviceProperties Properties = {};
+		vkGetPhysicalDeviceProperties( PhysicalDevice, &Properties );
+
+		uint32_t FamilyCount = 0;
+		vkGetPhysicalDeviceQueueFamilyProperties( PhysicalDevice, &FamilyCount, nullptr );
+
+		std::vector<VkQueueFamilyProperties> Families( FamilyCount );
+		vkGetPhysicalDeviceQueueFamilyProperties( PhysicalDevice, &FamilyCount, Families.data() );
+
+		const uint32_t ValidBits = Families[ VulkanContext::Get().GetQueueFamilyIndices().GraphicsFamily.value() ].timestampValidBits;
+
+		if( ValidBits == 0 || Properties.limits.timestampPeriod == 0.0f )
+		{
+			SAT_CORE_WARN( "The graphics queue does not support timestamps, GPU pass times will not be available." );
+			return;
+		}
+
+		m_TimestampPeriod = Properties.limits.timestampPeriod;
+		m_TimestampMask = ValidBits >= 64 ? ~0ull : ( 1ull << ValidBits ) - 1;
+
+		VkQueryPoolCreateInfo QueryPoolInfo = { VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO };
+		QueryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+		QueryPoolInfo.queryCount = MaxScopes * 2;
+
+		for( uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++ )
+		{
+			VK_CHECK( vkCreateQueryPool( Device, &QueryPoolInfo, nullptr, &m_Frames[ i ].QueryPool ) );
+
+			SetDebugUtilsObjectName( std::format( "GPU Profiler Query Pool ({0})", i ), ( uint64_t ) m_Frames[ i ].QueryPool, VK_OBJECT_TYPE_QUERY_POOL );
+		}
+	}
+
+	GPUProfiler::~GPUProfiler()
+	{
+		VkDevice Device = VulkanContext::Get().GetDevice();
+
+		for( auto& rFrame : m_Frames )
+		{
+			if( rFrame.QueryPool )
+				vkDestroyQueryPool( Device, rFrame.QueryPool, nullptr );
+
+			rFrame.QueryPool = nullptr;
+		}
+
+#if defined( TRACY_ENABLE )
+		for( auto& rZone : m_TracyZones )
+			rZone.reset();
+
+		if( m_TracyContext )
+		{
+			TracyVkDestroy( m_TracyContext );
+			m_TracyContext = nullptr;
+		}
+
+		if( m_TracyCommandBuffer )
+			vkFreeCommandBuffers( Device, VulkanContext::Get().GetCommandPool(), 1, &m_TracyCommandBuffer );
+#endif
+	}
+
+	void GPUProfiler::BeginFrame( VkCommandBuffer CommandBuffer, uint32_t Frame )
+	{
+		SAT_PF_EVENT();
+
+		if( !IsSupported() )
+			return;
+
+		SAT_CORE_ASSERT( m_OpenScopeCount == 0, "GPU profiler scopes were not ended!" );
+		m_OpenScopeCount = 0;
+
+		FrameQueries& rFrame = m_Frames[ Frame ];
+
+		ResolveFrame( rFrame );
+
+		rFrame.Scopes.clear();
+		rFrame.QueryCount = 0;
+
+		vkCmdResetQueryPool( CommandBuffer, rFrame.QueryPool, 0, MaxScopes * 2 );
+
+		m_pCurrentFrame = &rFrame;
+
+#if defined( TRACY_ENABLE )
+		if( m_TracyZonesEnabled && !m_TracyContext )
+		{
+			// Tracy records and submits its own calibration commands, so it needs a command buffer that is not the frame's.
+			VkCommandBufferAllocateInfo AllocateInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO };
+			AllocateInfo.commandPool = VulkanContext::Get().GetCommandPool();
+			AllocateInfo.commandBufferCount = 1;
+			AllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+
+			VK_CHECK( vkAllocateCommandBuffers( VulkanContext::Get().GetDevice(), &AllocateInfo, &m_TracyCommandBuffer ) );
+
+			m_TracyContext = TracyVkContext( VulkanContext::Get().GetPhysicalDevice(), VulkanContext::Get().GetDevice(), VulkanContext::Get().GetGraphicsQueue(), m_TracyCommandBuffer );
+		}
+
+		if( m_TracyContext )
+			TracyVkCollect( m_TracyContext, CommandBuffer );
+#endif
+	}
+
+	void GPUProfiler::ResolveFrame( FrameQueries& rFrame )
+	{
+		// Nothing was recorded the last time this frame index was used.
+		if( rFrame.QueryCount == 0 )
+			return;
+
+		// Each query is followed by its availability.
+		std::array<uint64_t, MaxScopes * 2 * 2> Timestamps = {};
+
+		VkResult Result = vkGetQueryPoolResults( VulkanContext::Get().GetDevice(), rFrame.QueryPool, 0, rFrame.QueryCount,
+			rFrame.QueryCount * 2 * sizeof( uint64_t ), Timestamps.data(), 2 * sizeof( uint64_t ),
+			VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT );
+
+		if( Result != VK_SUCCESS && Result != VK_NOT_READY )
+			return;
+
+		m_Results.clear();
+
+		for( const auto& rScope : rFrame.Scopes )
+		{
+			if( rScope.BeginQuery == s_InvalidScope )
+				continue;
+
+			GPUScopeTime& rTime = m_Results.emplace_back();
+			rTime.Name = rScope.Name;
+			rTime.Depth = rScope.Depth;
+
+			const uint64_t* pBegin = &Timestamps[ rScope.BeginQuery * 2 ];
+			const uint64_t* pEnd = &Timestamps[ rScope.EndQuery * 2 ];
+
+			if( !pBegin[ 1 ] || !pEnd[ 1 ] )
+				continue;
+
+			const uint64_t Ticks = ( ( pEnd[ 0 ] & m_TimestampMask ) - ( pBegin[ 0 ] & m_TimestampMask ) ) & m_TimestampMask;
+
+			rTime.Milliseconds = ( float ) ( ( double ) Ticks * m_TimestampPeriod / 1000000.0 );
+		}
+	}
+
+	void GPUProfiler::BeginScope( VkCommandBuffer CommandBuffer, const char* pName )
+	{
+		if( !IsSupported() || !m_pCurrentFrame )
+			return;
+
+		SAT_CORE_ASSERT( m_OpenScopeCount < MaxDepth, "GPU profiler scopes are nested too deep!" );
+
+		FrameQueries& rFrame = *m_pCurrentFrame;
+
+		ScopeRecord& rScope = rFrame.Scopes.emplace_back();
+		rScope.Name = pName;
+		rScope.Depth = m_OpenScopeCount;
+
+		// Out of queries, keep the scope so that EndScope still matches but don't measure it.
+		if( rFrame.QueryCount + 2 > MaxScopes * 2 )
+		{
+			rScope.BeginQuery = s_InvalidScope;
+			rScope.EndQuery = s_InvalidScope;
+		}
+		else
+		{
+			rScope.BeginQuery = rFrame.QueryCount++;
+			rScope.EndQuery = rFrame.QueryCount++;
+
+			vkCmdWriteTimestamp( CommandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, rFrame.QueryPool, rScope.BeginQuery );
+		}
+
+#if defined( TRACY_ENABLE )
+		if( m_TracyContext && m_TracyZonesEnabled )
+		{
+			const char* pFile = __FILE__;
+			const char* pFunction = __FUNCTION__;
+
+			m_TracyZones[ m_OpenScopeCount ].emplace( m_TracyContext, __LINE__, pFile, strlen( pFile ), pFunction, strlen( pFunction ), pName, strlen( pName ), CommandBuffer, true );
+		}
+#endif
+
+		m_OpenScopes[ m_OpenScopeCount++ ] = ( uint32_t ) rFrame.Scopes.size() - 1;
+	}
+
+	void GPUProfiler::EndScope( VkCommandBuffer CommandBuffer )
+	{
+		if( !IsSupported() || !m_pCurrentFrame || m_OpenScopeCount == 0 )
+			return;
+
+		FrameQueries& rFrame = *m_pCurrentFrame;
+
+		m_OpenScopeCount--;
+
+		const ScopeRecord& rScope = rFrame.Scopes[ m_OpenScopes[ m_OpenScopeCount ] ];
+
+		if( rScope.EndQuery != s_InvalidScope )
+			vkCmdWriteTimestamp( CommandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, rFrame.QueryPool, rScope.EndQuery );
+
+#if defined( TRACY_ENABLE )
+		m_TracyZones[ m_OpenScopeCount ].reset();
+#endif
+	}
+
+	float GPUProfiler::GetTime( const std::string& rName ) const
+	{
+		for( const auto& rResult : m_Results )
+		{
+			if( rResult.Name == rName )
+				return rResult.Milliseconds;
+		}
+
+		return 0.0f;
+	}
+}
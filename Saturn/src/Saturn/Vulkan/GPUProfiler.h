@@ -0,0 +1,149 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#pragma once
+
+#include "Base.h"
+
+#include <vulkan.h>
+
+#if defined( TRACY_ENABLE )
+#include <tracy/TracyVulkan.hpp>
+#endif
+
+#include <array>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace Saturn {
+
+	struct GPUScopeTime
+	{
+		std::string Name;
+		// How many scopes this scope is nested in.
+		uint32_t Depth = 0;
+		float Milliseconds = 0.0f;
+	};
+
+	// Measures how long passes take on the GPU with timestamp queries, CPU timers only measure how long it took to record the commands.
+	// Every frame in flight has its own query pool, the results of a frame are read back the next time that frame index begins (its fence has been waited on by then) so reading never stalls.
+	// Scopes must begin and end outside of a render pass or both inside the same one, and may be nested.
+	// When Tracy is enabled the scopes can also be sent to Tracy as GPU zones.
+	class GPUProfiler : public RefTarget
+	{
+	public:
+		static constexpr uint32_t MaxScopes = 64;
+		static constexpr uint32_t MaxDepth = 8;
+
+	public:
+		GPUProfiler();
+		~GPUProfiler();
+
+		// Resolves the results of the last time Frame was used and resets its queries, must be called outside of a render pass.
+		void BeginFrame( VkCommandBuffer CommandBuffer, uint32_t Frame );
+
+		void BeginScope( VkCommandBuffer CommandBuffer, const char* pName );
+		void EndScope( VkCommandBuffer CommandBuffer );
+
+		// Results in the order the scopes began, from the most recent frame that has finished on the GPU.
+		const std::vector<GPUScopeTime>& GetResults() const { return m_Results; }
+
+		// Time of the first scope with this name in the last resolved frame, 0 if it was not measured.
+		float GetTime( const std::string& rName ) const;
+
+		bool IsSupported() const { return m_TimestampPeriod > 0.0f; }
+
+		// Only has an effect when Tracy is enabled, the Tracy context is created the first time this is turned on.
+		void SetTracyZonesEnabled( bool Enabled ) { m_TracyZonesEnabled = Enabled; }
+		bool GetTracyZonesEnabled() const { return m_TracyZonesEnabled; }
+
+	private:
+		struct ScopeRecord
+		{
+			std::string Name;
+			uint32_t Depth = 0;
+			uint32_t BeginQuery = 0;
+			uint32_t EndQuery = 0;
+		};
+
+		struct FrameQueries
+		{
+			VkQueryPool QueryPool = nullptr;
+			std::vector<ScopeRecord> Scopes;
+			uint32_t QueryCount = 0;
+		};
+
+		void ResolveFrame( FrameQueries& rFrame );
+
+	private:
+		std::array<FrameQueries, MAX_FRAMES_IN_FLIGHT> m_Frames;
+		FrameQueries* m_pCurrentFrame = nullptr;
+
+		// Indices into the current frame's scopes of the scopes that have not ended yet.
+		std::array<uint32_t, MaxDepth> m_OpenScopes = {};
+		uint32_t m_OpenScopeCount = 0;
+
+		// Nanoseconds per timestamp tick, zero when the graphics queue does not support timestamps.
+		float m_TimestampPeriod = 0.0f;
+		uint64_t m_TimestampMask = ~0ull;
+
+		std::vector<GPUScopeTime> m_Results;
+
+		bool m_TracyZonesEnabled = false;
+
+#if defined( TRACY_ENABLE )
+		TracyVkCtx m_TracyContext = nullptr;
+		VkCommandBuffer m_TracyCommandBuffer = nullptr;
+
+		std::array<std::optional<tracy::VkCtxScope>, MaxDepth> m_TracyZones;
+#endif
+	};
+
+	// Measures everything recorded into the command buffer while the object is alive.
+	class ScopedGPUTimer
+	{
+	public:
+		ScopedGPUTimer( Ref<GPUProfiler>& rProfiler, VkCommandBuffer CommandBuffer, const char* pName )
+			: m_pProfiler( rProfiler.Get() ), m_CommandBuffer( CommandBuffer )
+		{
+			if( m_pProfiler )
+				m_pProfiler->BeginScope( m_CommandBuffer, pName );
+		}
+
+		~ScopedGPUTimer()
+		{
+			if( m_pProfiler )
+				m_pProfiler->EndScope( m_CommandBuffer );
+		}
+
+	private:
+		GPUProfiler* m_pProfiler = nullptr;
+		VkCommandBuffer m_CommandBuffer = nullptr;
+	};
+}
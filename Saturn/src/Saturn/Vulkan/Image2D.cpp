@@ -32,6 +32,7 @@
 #include "VulkanContext.h"
 #include "VulkanDebug.h"
 #include "VulkanImageAux.h"
+#include "UploadManager.h"
 
 namespace Saturn {
 
@@ -47,20 +48,42 @@ namespace Saturn {
 
 	Image2D::~Image2D()
 	{
-		vkDestroyImage( VulkanContext::Get().GetDevice(), m_Image, nullptr );
-		vkDestroySampler( VulkanContext::Get().GetDevice(), m_Sampler, nullptr );
-		vkFreeMemory( VulkanContext::Get().GetDevice(), m_Memory, nullptr );
-		vkDestroyImageView( VulkanContext::Get().GetDevice(), m_ImageView, nullptr );
+		Release();
+	}
 
-		for( size_t i = 0; i < m_ArrayLevels; i++ )
+	void Image2D::Release()
+	{
+		VkImage Image = m_Image;
+		VkSampler Sampler = m_Sampler;
+		VkDeviceMemory Memory = m_Memory;
+		VkImageView ImageView = m_ImageView;
+		std::vector<VkImageView> ImageViews( m_ImageViews.begin(), m_ImageViews.begin() + m_ArrayLevels );
+
+		auto DestroyFunc = [=]()
 		{
-			vkDestroyImageView( VulkanContext::Get().GetDevice(), m_ImageViews[ i ], nullptr );
+			vkDestroyImage( VulkanContext::Get().GetDevice(), Image, nullptr );
+			vkDestroySampler( VulkanContext::Get().GetDevice(), Sampler, nullptr );
+			vkFreeMemory( VulkanContext::Get().GetDevice(), Memory, nullptr );
+			vkDestroyImageView( VulkanContext::Get().GetDevice(), ImageView, nullptr );
+
+			for( VkImageView View : ImageViews )
+				vkDestroyImageView( VulkanContext::Get().GetDevice(), View, nullptr );
+		};
+
+		// The upload may still be copying into the image.
+		if( UploadManager* pUploadManager = VulkanContext::Get().GetUploadManager() )
+			pUploadManager->DestroyAfter( m_UploadTicket, std::move( DestroyFunc ) );
+		else
+			DestroyFunc();
+
+		for( size_t i = 0; i < m_ArrayLevels; i++ )
 			m_ImageViews[ i ] = nullptr;
-		}
 
 		m_Image = nullptr;
+		m_ImageView = nullptr;
 		m_Sampler = nullptr;
 		m_Memory = nullptr;
+		m_UploadTicket = 0;
 	}
 
 	void Image2D::SetDebugName( const std::string& rName )
@@ -70,13 +93,7 @@ namespace Saturn {
 
 	void Image2D::Resize( uint32_t Width, uint32_t Height )
 	{
-		vkDestroyImage( VulkanContext::Get().GetDevice(), m_Image, nullptr );
-		vkDestroySampler( VulkanContext::Get().GetDevice(), m_Sampler, nullptr );
-		vkDestroyImageView( VulkanContext::Get().GetDevice(), m_ImageView, nullptr );
-		vkFreeMemory( VulkanContext::Get().GetDevice(), m_Memory, nullptr );
-
-		for( size_t i = 0; i < m_ArrayLevels; i++ )
-			vkDestroyImageView( VulkanContext::Get().GetDevice(), m_ImageViews[ i ], nullptr );
+		Release();
 
 		m_Width = Width;
 		m_Height = Height;
@@ -100,7 +117,7 @@ namespace Saturn {
 		if( IsColorFormat( m_Format ) )
 			ImageCreateInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
 		else
-			ImageCreateInfo.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+			ImageCreateInfo.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
 
 		if( m_MSAASamples > VK_SAMPLE_COUNT_1_BIT )
 		{
@@ -125,40 +142,20 @@ namespace Saturn {
 		VK_CHECK( vkAllocateMemory( VulkanContext::Get().GetDevice(), &MemoryAllocateInfo, nullptr, &m_Memory ) );
 		VK_CHECK( vkBindImageMemory( VulkanContext::Get().GetDevice(), m_Image, m_Memory, 0 ) );
 
-		if( m_pData ) 
-		{
-			// TRANSITION: Initial layout to VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL
-			TransitionImageLayout( VulkanFormat( m_Format ), VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL );
-
-			VkBuffer ImgBuffer;
-
-			VkDeviceSize ImageSize = m_Width * m_Height * 4;
-
-			VkBufferCreateInfo BufferCreateInfo = { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
-			BufferCreateInfo.size = m_DataSize;
-			BufferCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-			BufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-
-			auto pAllocator = VulkanContext::Get().GetVulkanAllocator();
-			auto BufferAlloc = pAllocator->AllocateBuffer( BufferCreateInfo, VMA_MEMORY_USAGE_CPU_ONLY, &ImgBuffer );
-
-			void* pDstData = pAllocator->MapMemory<void*>( BufferAlloc );
-
-			memcpy( pDstData, m_pData, m_DataSize );
-
-			pAllocator->UnmapMemory( BufferAlloc );
-
-			CopyBufferToImage( ImgBuffer );
-
-			// TRANSITION: VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL to descriptor image layout.
-			TransitionImageLayout( VulkanFormat( m_Format ), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, m_DescriptorImageInfo.imageLayout );
-		}
-
 		if( IsColorFormat( m_Format ) )
 			m_DescriptorImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 		else
 			m_DescriptorImageInfo.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
 
+		if( m_pData ) 
+		{
+			VkImageAspectFlags Aspect = IsColorFormat( m_Format ) ? VK_IMAGE_ASPECT_COLOR_BIT : VK_IMAGE_ASPECT_DEPTH_BIT;
+
+			// Batched with the other uploads, ends in the descriptor image layout.
+			m_UploadTicket = VulkanContext::Get().GetUploadManager()->UploadImage( m_Image, m_pData, m_DataSize, { m_Width, m_Height, 1 }, Aspect, 
+				m_DescriptorImageInfo.imageLayout, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT );
+		}
+
 		// Create base image view & sampler.
 		VkImageViewCreateInfo ImageViewCreateInfo = { VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO };
 		ImageViewCreateInfo.image = m_Image;
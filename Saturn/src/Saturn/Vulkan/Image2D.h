@@ -28,6 +28,8 @@
 
 #pragma once
 
+#include "UploadManager.h"
+
 #include <vulkan.h>
 
 namespace Saturn {
@@ -48,6 +50,14 @@ namespace Saturn {
 		DEPTH32F = 7,
 		DEPTH24STENCIL8 = 8,
 
+		// Block compressed, only used for textures cooked by the TextureCooker.
+		BC1 = 9,
+		BC3 = 10,
+		BC4 = 11,
+		BC5 = 12,
+		BC6H = 13,
+		BC7 = 14,
+
 		Depth = DEPTH32F
 	};
 
@@ -85,6 +95,8 @@ namespace Saturn {
 
 	private:
 		void Create();
+		// Frees the image once its upload has completed.
+		void Release();
 		void CopyBufferToImage( VkBuffer Buffer );
 		
 		// Internal TransitionImageLayout
@@ -111,6 +123,8 @@ namespace Saturn {
 		void* m_pData;
 		size_t m_DataSize;
 
+		UploadTicket m_UploadTicket = 0;
+
 		VkDescriptorImageInfo m_DescriptorImageInfo;
 	};
 }
\ No newline at end of file
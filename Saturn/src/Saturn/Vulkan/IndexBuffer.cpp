@@ -32,6 +32,7 @@
 #include "VulkanContext.h"
 
 #include "VulkanDebug.h"
+#include "UploadManager.h"
 
 #include <cassert>
 
@@ -66,26 +67,9 @@ namespace Saturn {
 
 		uint32_t BufferSize = (uint32_t)m_Size;
 
-		VkBuffer StagingBuffer;
-		
 		auto pAllocator = VulkanContext::Get().GetVulkanAllocator();
 
-		VkBufferCreateInfo BufferCreateInfo = { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
-		BufferCreateInfo.size = BufferSize;
-		BufferCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-		BufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-
-		auto rBufferAlloc = pAllocator->AllocateBuffer( BufferCreateInfo, VMA_MEMORY_USAGE_CPU_TO_GPU, &StagingBuffer );
-
-		uint8_t* dstData = pAllocator->MapMemory< uint8_t >( rBufferAlloc );
-
-		memcpy( dstData, m_pData, BufferSize );
-
-		pAllocator->UnmapMemory( rBufferAlloc );
-
-		//////////////////////////////////////////////////////////////////////////
-
-		// Create the vertex buffer.
+		// Create the index buffer.
 		VkBufferCreateInfo IndexBufferCreateInfo = { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
 		IndexBufferCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
 		IndexBufferCreateInfo.size = BufferSize;
@@ -94,27 +78,26 @@ namespace Saturn {
 		
 		SetDebugUtilsObjectName( "Index Buffer", ( uint64_t ) m_Buffer, VK_OBJECT_TYPE_BUFFER );
 
-		// Copy buffer
-		{
-			auto CommandBuffer = VulkanContext::Get().BeginSingleTimeCommands();
-
-			VkBufferCopy CopyRegion{};
-			CopyRegion.size = BufferSize;
-
-			vkCmdCopyBuffer( CommandBuffer, StagingBuffer, m_Buffer, 1, &CopyRegion );
-
-			VulkanContext::Get().EndSingleTimeCommands( CommandBuffer );
-		}
-
-		pAllocator->DestroyBuffer( StagingBuffer );
+		// The copy is batched with the other uploads, it will be done before the next frame is submitted.
+		m_UploadTicket = VulkanContext::Get().GetUploadManager()->UploadBuffer( m_Buffer, m_pData, BufferSize, 0, VK_ACCESS_INDEX_READ_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT );
 	}
 
 	void IndexBuffer::Destroy()
 	{
 		if( m_Buffer != nullptr )
-			VulkanContext::Get().GetVulkanAllocator()->DestroyBuffer( m_Buffer );
+		{
+			VkBuffer Buffer = m_Buffer;
+			auto DestroyFunc = [Buffer]() { VulkanContext::Get().GetVulkanAllocator()->DestroyBuffer( Buffer ); };
+
+			// The upload may still be copying into the buffer.
+			if( UploadManager* pUploadManager = VulkanContext::Get().GetUploadManager() )
+				pUploadManager->DestroyAfter( m_UploadTicket, std::move( DestroyFunc ) );
+			else
+				DestroyFunc();
+		}
 
 		m_Buffer = nullptr;
+		m_UploadTicket = 0;
 	}
 
 }
\ No newline at end of file
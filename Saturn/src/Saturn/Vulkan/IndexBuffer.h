@@ -31,6 +31,7 @@
 #include "Base.h"
 
 #include "VulkanAllocator.h"
+#include "UploadManager.h"
 
 #include <vulkan.h>
 #include <string>
@@ -69,5 +70,8 @@ namespace Saturn {
 
 		VkBuffer m_Buffer = nullptr ;
 		VmaAllocation m_Allocation = nullptr;
+
+		// The batch that copies m_pData into the buffer, the buffer is not freed before it completes.
+		UploadTicket m_UploadTicket = 0;
 	};
 }
\ No newline at end of file
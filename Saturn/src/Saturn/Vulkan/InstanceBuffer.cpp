@@ -0,0 +1,464 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#include "sppch.h"
+#include "InstanceBuffer.h"
+
+#include "VulkanContext.h"
+#include "VulkanDebug.h"
+#include "Renderer.h"
+
+#include "Saturn/Core/OptickProfiler.h"
+
+namespace Saturn {
+
+	static constexpr uint32_t s_MinBatchCapacity = 16;
+	static constexpr uint32_t s_MinStagingSlots = 256;
+
+	InstanceBuffer::InstanceBuffer( uint32_t InitialCapacity /*= 1024 */ )
+	{
+		m_Capacity = std::max( InitialCapacity, s_MinBatchCapacity );
+
+		m_VertexBuffer = Ref<VertexBuffer>::Create( 
+			sizeof( TransformBufferData ) * m_Capacity, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_GPU_ONLY );
+
+		m_FreeBlocks.push_back( { 0, m_Capacity } );
+
+		m_StagingBuffers.resize( MAX_FRAMES_IN_FLIGHT );
+		m_RetiredBuffers.resize( MAX_FRAMES_IN_FLIGHT );
+	}
+
+	InstanceBuffer::~InstanceBuffer()
+	{
+		for( uint32_t i = 0; i < ( uint32_t ) m_StagingBuffers.size(); i++ )
+			DestroyStagingBuffer( i );
+
+		m_StagingBuffers.clear();
+		m_RetiredBuffers.clear();
+		m_PendingRetire.clear();
+		m_Batches.clear();
+
+		m_GrowSource = nullptr;
+		m_VertexBuffer = nullptr;
+	}
+
+	void InstanceBuffer::Submit( UUID Owner, const StaticMeshKey& rKey, const glm::mat4& rTransform )
+	{
+		TransformBufferData Data;
+		Data.TransfromBufferR[ 0 ] = { rTransform[ 0 ][ 0 ], rTransform[ 1 ][ 0 ], rTransform[ 2 ][ 0 ], rTransform[ 3 ][ 0 ] };
+		Data.TransfromBufferR[ 1 ] = { rTransform[ 0 ][ 1 ], rTransform[ 1 ][ 1 ], rTransform[ 2 ][ 1 ], rTransform[ 3 ][ 1 ] };
+		Data.TransfromBufferR[ 2 ] = { rTransform[ 0 ][ 2 ], rTransform[ 1 ][ 2 ], rTransform[ 2 ][ 2 ], rTransform[ 3 ][ 2 ] };
+
+		auto& rBatch = m_Batches[ rKey ];
+
+		auto Itr = rBatch.OwnerToSlot.find( Owner );
+		if( Itr != rBatch.OwnerToSlot.end() )
+		{
+			auto& rSlot = rBatch.Slots[ Itr->second ];
+			rSlot.LastFrame = m_FrameIndex;
+
+			// Same transform as last frame, nothing to upload.
+			if( memcmp( &rSlot.Data, &Data, sizeof( TransformBufferData ) ) == 0 )
+				return;
+
+			rSlot.Data = Data;
+			MarkDirty( rBatch, Itr->second );
+
+			return;
+		}
+
+		if( rBatch.Slots.size() == rBatch.Block.Capacity )
+			GrowBatch( rBatch );
+
+		uint32_t LocalSlot = ( uint32_t ) rBatch.Slots.size();
+
+		auto& rSlot = rBatch.Slots.emplace_back();
+		rSlot.Owner = Owner;
+		rSlot.LastFrame = m_FrameIndex;
+		rSlot.Data = Data;
+
+		rBatch.OwnerToSlot[ Owner ] = LocalSlot;
+		MarkDirty( rBatch, LocalSlot );
+
+		m_LiveCount++;
+	}
+
+	void InstanceBuffer::Flush( VkCommandBuffer CommandBuffer )
+	{
+		SAT_PF_EVENT();
+
+		uint32_t frame = Renderer::Get().GetCurrentFrame();
+
+		// The fence for this frame has been waited on, anything we retired last time we were on this frame is no longer in use.
+		m_RetiredBuffers[ frame ].clear();
+
+		m_UploadedSlots = 0;
+		m_CopyRegions = 0;
+
+		m_DirtyGlobalSlots.clear();
+
+		for( auto Itr = m_Batches.begin(); Itr != m_Batches.end(); )
+		{
+			auto& rBatch = Itr->second;
+
+			ReleaseUnused( rBatch );
+
+			if( rBatch.Slots.empty() )
+			{
+				if( rBatch.Block.Capacity )
+					FreeBlock( rBatch.Block );
+
+				Itr = m_Batches.erase( Itr );
+				continue;
+			}
+
+			for( uint32_t LocalSlot : rBatch.DirtySlots )
+			{
+				// Slot may of been released after it was marked.
+				if( LocalSlot >= rBatch.Slots.size() || !rBatch.Slots[ LocalSlot ].Dirty )
+					continue;
+
+				rBatch.Slots[ LocalSlot ].Dirty = false;
+				m_DirtyGlobalSlots.push_back( { rBatch.Block.FirstSlot + LocalSlot, &rBatch.Slots[ LocalSlot ].Data } );
+			}
+
+			rBatch.DirtySlots.clear();
+
+			Itr++;
+		}
+
+		bool RecordedCopy = false;
+
+		if( m_GrowSource )
+		{
+			RecordGrowCopy( CommandBuffer );
+			RecordedCopy = true;
+		}
+
+		if( !m_DirtyGlobalSlots.empty() )
+		{
+			std::sort( m_DirtyGlobalSlots.begin(), m_DirtyGlobalSlots.end(), []( const auto& a, const auto& b ) { return a.first < b.first; } );
+
+			uint32_t DirtyCount = ( uint32_t ) m_DirtyGlobalSlots.size();
+
+			if( m_StagingBuffers[ frame ].SlotCount < DirtyCount )
+				CreateStagingBuffer( frame, std::max( DirtyCount, m_StagingBuffers[ frame ].SlotCount * 2 ) );
+
+			auto& rStaging = m_StagingBuffers[ frame ];
+
+			// Write the dirty slots packed into the staging buffer, neighbouring slots are merged into one copy region.
+			m_Regions.clear();
+
+			for( uint32_t i = 0; i < DirtyCount; i++ )
+			{
+				const auto& [GlobalSlot, pData] = m_DirtyGlobalSlots[ i ];
+
+				rStaging.pData[ i ] = *pData;
+
+				if( i > 0 && GlobalSlot == m_DirtyGlobalSlots[ i - 1 ].first + 1 )
+				{
+					m_Regions.back().size += sizeof( TransformBufferData );
+					continue;
+				}
+
+				VkBufferCopy& rRegion = m_Regions.emplace_back();
+				rRegion.srcOffset = i * sizeof( TransformBufferData );
+				rRegion.dstOffset = ( VkDeviceSize ) GlobalSlot * sizeof( TransformBufferData );
+				rRegion.size = sizeof( TransformBufferData );
+			}
+
+			// Wait for the previous frames to finish reading the instance data (and for the grow copy) before we write to it.
+			VkMemoryBarrier Barrier = { VK_STRUCTURE_TYPE_MEMORY_BARRIER };
+			Barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			Barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+			vkCmdPipelineBarrier( CommandBuffer,
+				VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+				0, 1, &Barrier, 0, nullptr, 0, nullptr );
+
+			vkCmdCopyBuffer( CommandBuffer, rStaging.Buffer, m_VertexBuffer->GetBuffer(), ( uint32_t ) m_Regions.size(), m_Regions.data() );
+
+			m_UploadedSlots = DirtyCount;
+			m_CopyRegions = ( uint32_t ) m_Regions.size();
+
+			RecordedCopy = true;
+		}
+
+		if( RecordedCopy )
+		{
+			VkMemoryBarrier Barrier = { VK_STRUCTURE_TYPE_MEMORY_BARRIER };
+			Barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			Barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
+
+			vkCmdPipelineBarrier( CommandBuffer,
+				VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+				0, 1, &Barrier, 0, nullptr, 0, nullptr );
+		}
+
+		for( auto& rBuffer : m_PendingRetire )
+			m_RetiredBuffers[ frame ].push_back( rBuffer );
+
+		m_PendingRetire.clear();
+
+		m_FrameIndex++;
+	}
+
+	void InstanceBuffer::Clear()
+	{
+		m_Batches.clear();
+
+		m_FreeBlocks.clear();
+		m_FreeBlocks.push_back( { 0, m_Capacity } );
+
+		m_LiveCount = 0;
+	}
+
+	uint32_t InstanceBuffer::GetOffset( const StaticMeshKey& rKey ) const
+	{
+		auto Itr = m_Batches.find( rKey );
+
+		if( Itr == m_Batches.end() )
+			return 0;
+
+		return Itr->second.Block.FirstSlot * ( uint32_t ) sizeof( TransformBufferData );
+	}
+
+	uint32_t InstanceBuffer::GetInstanceCount( const StaticMeshKey& rKey ) const
+	{
+		auto Itr = m_Batches.find( rKey );
+
+		if( Itr == m_Batches.end() )
+			return 0;
+
+		return ( uint32_t ) Itr->second.Slots.size();
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Slot allocation
+
+	InstanceBuffer::InstanceBlock InstanceBuffer::AllocateBlock( uint32_t Count )
+	{
+		// First fit.
+		for( auto Itr = m_FreeBlocks.begin(); Itr != m_FreeBlocks.end(); Itr++ )
+		{
+			if( Itr->Capacity < Count )
+				continue;
+
+			InstanceBlock Block = { Itr->FirstSlot, Count };
+
+			Itr->FirstSlot += Count;
+			Itr->Capacity -= Count;
+
+			if( Itr->Capacity == 0 )
+				m_FreeBlocks.erase( Itr );
+
+			return Block;
+		}
+
+		Grow( m_Capacity + Count );
+
+		return AllocateBlock( Count );
+	}
+
+	void InstanceBuffer::FreeBlock( const InstanceBlock& rBlock )
+	{
+		auto Itr = std::lower_bound( m_FreeBlocks.begin(), m_FreeBlocks.end(), rBlock.FirstSlot,
+			[]( const InstanceBlock& rFree, uint32_t FirstSlot ) { return rFree.FirstSlot < FirstSlot; } );
+
+		Itr = m_FreeBlocks.insert( Itr, rBlock );
+
+		// Merge with the next block.
+		auto Next = Itr + 1;
+		if( Next != m_FreeBlocks.end() && Itr->FirstSlot + Itr->Capacity == Next->FirstSlot )
+		{
+			Itr->Capacity += Next->Capacity;
+			Itr = m_FreeBlocks.erase( Next ) - 1;
+		}
+
+		// Merge with the previous block.
+		if( Itr != m_FreeBlocks.begin() )
+		{
+			auto Prev = Itr - 1;
+
+			if( Prev->FirstSlot + Prev->Capacity == Itr->FirstSlot )
+			{
+				Prev->Capacity += Itr->Capacity;
+				m_FreeBlocks.erase( Itr );
+			}
+		}
+	}
+
+	void InstanceBuffer::Grow( uint32_t MinCapacity )
+	{
+		SAT_PF_EVENT();
+
+		uint32_t OldCapacity = m_Capacity;
+		m_Capacity = std::max( MinCapacity, m_Capacity * 2 );
+
+		// Only the buffer that was valid at the last flush has any data worth keeping.
+		if( !m_GrowSource )
+		{
+			m_GrowSource = m_VertexBuffer;
+			m_GrowSourceCapacity = OldCapacity;
+		}
+		else
+		{
+			m_PendingRetire.push_back( m_VertexBuffer );
+		}
+
+		m_VertexBuffer = Ref<VertexBuffer>::Create(
+			sizeof( TransformBufferData ) * m_Capacity, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_GPU_ONLY );
+
+		FreeBlock( { OldCapacity, m_Capacity - OldCapacity } );
+
+		SAT_CORE_INFO( "Instance buffer grew from {0} to {1} slots", OldCapacity, m_Capacity );
+	}
+
+	void InstanceBuffer::RecordGrowCopy( VkCommandBuffer CommandBuffer )
+	{
+		VkBufferCopy Region{};
+		Region.size = ( VkDeviceSize ) m_GrowSourceCapacity * sizeof( TransformBufferData );
+
+		// The old buffer was written by the uploads of earlier frames.
+		VkBufferMemoryBarrier Barrier = { VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER };
+		Barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		Barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+		Barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		Barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		Barrier.buffer = m_GrowSource->GetBuffer();
+		Barrier.offset = 0;
+		Barrier.size = VK_WHOLE_SIZE;
+
+		vkCmdPipelineBarrier( CommandBuffer,
+			VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+			0, 0, nullptr, 1, &Barrier, 0, nullptr );
+
+		vkCmdCopyBuffer( CommandBuffer, m_GrowSource->GetBuffer(), m_VertexBuffer->GetBuffer(), 1, &Region );
+
+		m_PendingRetire.push_back( m_GrowSource );
+
+		m_GrowSource = nullptr;
+		m_GrowSourceCapacity = 0;
+	}
+
+	void InstanceBuffer::GrowBatch( InstanceBatch& rBatch )
+	{
+		uint32_t NewCapacity = std::max( s_MinBatchCapacity, rBatch.Block.Capacity * 2 );
+
+		if( rBatch.Block.Capacity )
+			FreeBlock( rBatch.Block );
+
+		rBatch.Block = AllocateBlock( NewCapacity );
+
+		// The batch moved, every slot has to be uploaded again.
+		for( uint32_t i = 0; i < ( uint32_t ) rBatch.Slots.size(); i++ )
+			MarkDirty( rBatch, i );
+	}
+
+	void InstanceBuffer::ReleaseUnused( InstanceBatch& rBatch )
+	{
+		uint32_t i = 0;
+		while( i < ( uint32_t ) rBatch.Slots.size() )
+		{
+			if( rBatch.Slots[ i ].LastFrame == m_FrameIndex )
+			{
+				i++;
+				continue;
+			}
+
+			// Not submitted this frame, move the last slot into this one to keep the block tightly packed.
+			rBatch.OwnerToSlot.erase( rBatch.Slots[ i ].Owner );
+
+			uint32_t Last = ( uint32_t ) rBatch.Slots.size() - 1;
+
+			if( i != Last )
+			{
+				rBatch.Slots[ i ] = rBatch.Slots[ Last ];
+				rBatch.Slots[ i ].Dirty = false;
+				rBatch.OwnerToSlot[ rBatch.Slots[ i ].Owner ] = i;
+
+				MarkDirty( rBatch, i );
+			}
+
+			rBatch.Slots.pop_back();
+
+			m_LiveCount--;
+		}
+	}
+
+	void InstanceBuffer::MarkDirty( InstanceBatch& rBatch, uint32_t LocalSlot )
+	{
+		auto& rSlot = rBatch.Slots[ LocalSlot ];
+
+		if( rSlot.Dirty )
+			return;
+
+		rSlot.Dirty = true;
+		rBatch.DirtySlots.push_back( LocalSlot );
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Staging
+
+	void InstanceBuffer::CreateStagingBuffer( uint32_t Frame, uint32_t SlotCount )
+	{
+		DestroyStagingBuffer( Frame );
+
+		SlotCount = std::max( SlotCount, s_MinStagingSlots );
+
+		auto pAllocator = VulkanContext::Get().GetVulkanAllocator();
+		auto& rStaging = m_StagingBuffers[ Frame ];
+
+		VkBufferCreateInfo BufferCreateInfo = { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+		BufferCreateInfo.size = ( VkDeviceSize ) SlotCount * sizeof( TransformBufferData );
+		BufferCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+		BufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+		rStaging.Allocation = pAllocator->AllocateBuffer( BufferCreateInfo, VMA_MEMORY_USAGE_CPU_TO_GPU, &rStaging.Buffer );
+		SetDebugUtilsObjectName( "Instance Staging Buffer", ( uint64_t ) rStaging.Buffer, VK_OBJECT_TYPE_BUFFER );
+
+		// Persistently mapped, unmapped when the buffer is destroyed.
+		rStaging.pData = pAllocator->MapMemory< TransformBufferData >( rStaging.Allocation );
+		rStaging.SlotCount = SlotCount;
+	}
+
+	void InstanceBuffer::DestroyStagingBuffer( uint32_t Frame )
+	{
+		auto& rStaging = m_StagingBuffers[ Frame ];
+
+		if( rStaging.Buffer == VK_NULL_HANDLE )
+			return;
+
+		auto pAllocator = VulkanContext::Get().GetVulkanAllocator();
+
+		pAllocator->UnmapMemory( rStaging.Allocation );
+		pAllocator->DestroyBuffer( rStaging.Buffer );
+
+		rStaging = {};
+	}
+}
@@ -0,0 +1,206 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#pragma once
+
+#include "Base.h"
+#include "VertexBuffer.h"
+
+#include "Saturn/Core/UUID.h"
+#include "Saturn/Asset/MaterialAsset.h"
+
+#include <glm/glm.hpp>
+#include <vulkan.h>
+
+#include <unordered_map>
+#include <vector>
+
+namespace Saturn {
+
+	struct StaticMeshKey
+	{
+		AssetID MeshID;
+		Ref<MaterialRegistry> Registry;
+
+		uint32_t SubmeshIndex;
+		uint32_t LodIndex;
+
+		// Transforms of the selected physics colliders, kept apart so the outline pass only draws the colliders.
+		bool Collider = false;
+
+		// Instances that were culled from the camera but still cast shadows, kept in their own batch so the visible batch stays contiguous.
+		bool ShadowOnly = false;
+
+		// Instances of static entities, the shadow maps cache these so they are kept apart from the movable instances.
+		bool Static = false;
+
+		// Instances that must not be drawn into the shadow maps, the shadow draws take the first instances of a key's block so they cannot share it with casters.
+		bool CastShadows = true;
+
+		StaticMeshKey( AssetID meshID, Ref<MaterialRegistry> materialReg, uint32_t submeshIndex, uint32_t lodIndex = 0 ) : MeshID( meshID ), SubmeshIndex( submeshIndex ), LodIndex( lodIndex ) { Registry = materialReg; }
+
+		bool operator==( const StaticMeshKey& rKey )
+		{
+			return ( MeshID == rKey.MeshID && Registry == rKey.Registry && SubmeshIndex == rKey.SubmeshIndex && LodIndex == rKey.LodIndex && Collider == rKey.Collider && ShadowOnly == rKey.ShadowOnly && Static == rKey.Static && CastShadows == rKey.CastShadows );
+		}
+
+		bool operator==( const StaticMeshKey& rKey ) const
+		{
+			return ( MeshID == rKey.MeshID && Registry == rKey.Registry && SubmeshIndex == rKey.SubmeshIndex && LodIndex == rKey.LodIndex && Collider == rKey.Collider && ShadowOnly == rKey.ShadowOnly && Static == rKey.Static && CastShadows == rKey.CastShadows );
+		}
+	};
+
+	// Data that gets sent to the vertex shader.
+	// The last row of an affine transform is always (0, 0, 0, 1) so we only store the first three rows.
+	struct TransformBufferData
+	{
+		glm::vec4 TransfromBufferR[ 3 ];
+	};
+}
+
+namespace std {
+
+	template<>
+	struct hash< Saturn::StaticMeshKey >
+	{
+		size_t operator()( const Saturn::StaticMeshKey& rKey ) const
+		{
+			return rKey.Registry->GetID() ^ rKey.MeshID ^ rKey.SubmeshIndex ^ ( ( size_t ) rKey.LodIndex << 24 ) ^ ( ( size_t ) rKey.Collider << 23 ) ^ ( ( size_t ) rKey.ShadowOnly << 31 ) ^ ( ( size_t ) rKey.Static << 30 ) ^ ( ( size_t ) !rKey.CastShadows << 29 );
+		}
+	};
+}
+
+namespace Saturn {
+
+	// A persistent, device local buffer of instance transforms.
+	// Every entity-submesh owns a stable slot for as long as it keeps being submitted, all slots of a StaticMeshKey live in one contiguous block
+	// so a key can still be drawn with a single instanced draw call.
+	// Only slots that changed are copied from the per-frame staging buffer, so a static scene uploads nothing.
+	class InstanceBuffer : public RefTarget
+	{
+	public:
+		InstanceBuffer( uint32_t InitialCapacity = 1024 );
+		~InstanceBuffer();
+
+		// Marks the instance as alive for this frame and updates the cached transform if it has changed.
+		void Submit( UUID Owner, const StaticMeshKey& rKey, const glm::mat4& rTransform );
+
+		// Releases every instance that was not submitted this frame and records the copies for all dirty slots.
+		// Must be called outside of a render pass, before any draw that reads the buffer.
+		void Flush( VkCommandBuffer CommandBuffer );
+
+		// Removes every instance, the next Flush will upload all instances that are submitted again.
+		void Clear();
+
+		// Offset in bytes of the first instance of the key, used when binding the buffer.
+		uint32_t GetOffset( const StaticMeshKey& rKey ) const;
+		uint32_t GetInstanceCount( const StaticMeshKey& rKey ) const;
+
+		Ref<VertexBuffer> GetVertexBuffer() { return m_VertexBuffer; }
+
+		uint32_t GetCapacity() const { return m_Capacity; }
+		uint32_t GetLiveCount() const { return m_LiveCount; }
+		uint32_t GetUploadedSlots() const { return m_UploadedSlots; }
+		uint32_t GetCopyRegions() const { return m_CopyRegions; }
+
+	private:
+		struct InstanceSlot
+		{
+			UUID Owner = 0;
+			uint64_t LastFrame = 0;
+			bool Dirty = false;
+			TransformBufferData Data{};
+		};
+
+		struct InstanceBlock
+		{
+			uint32_t FirstSlot = 0;
+			uint32_t Capacity = 0;
+		};
+
+		struct InstanceBatch
+		{
+			InstanceBlock Block;
+
+			std::vector<InstanceSlot> Slots;
+			std::unordered_map<UUID, uint32_t> OwnerToSlot;
+
+			// Local slot indices that need to be uploaded.
+			std::vector<uint32_t> DirtySlots;
+		};
+
+	private:
+		InstanceBlock AllocateBlock( uint32_t Count );
+		void FreeBlock( const InstanceBlock& rBlock );
+
+		void Grow( uint32_t MinCapacity );
+		void RecordGrowCopy( VkCommandBuffer CommandBuffer );
+		void GrowBatch( InstanceBatch& rBatch );
+		void ReleaseUnused( InstanceBatch& rBatch );
+		void MarkDirty( InstanceBatch& rBatch, uint32_t LocalSlot );
+
+		void CreateStagingBuffer( uint32_t Frame, uint32_t SlotCount );
+		void DestroyStagingBuffer( uint32_t Frame );
+
+	private:
+		struct StagingBuffer
+		{
+			VkBuffer Buffer = VK_NULL_HANDLE;
+			VmaAllocation Allocation = nullptr;
+			TransformBufferData* pData = nullptr;
+			uint32_t SlotCount = 0;
+		};
+
+		Ref<VertexBuffer> m_VertexBuffer = nullptr;
+
+		// Old buffers may still be read by frames in flight, keep them alive until we come back around to the same frame.
+		std::vector<std::vector<Ref<VertexBuffer>>> m_RetiredBuffers;
+
+		std::vector<StagingBuffer> m_StagingBuffers;
+
+		std::unordered_map<StaticMeshKey, InstanceBatch> m_Batches;
+
+		// Sorted by FirstSlot, neighbours are always coalesced.
+		std::vector<InstanceBlock> m_FreeBlocks;
+
+		// Buffer that held the valid data before we grew, copied into the new buffer on the next flush.
+		Ref<VertexBuffer> m_GrowSource = nullptr;
+		uint32_t m_GrowSourceCapacity = 0;
+		std::vector<Ref<VertexBuffer>> m_PendingRetire;
+
+		std::vector<VkBufferCopy> m_Regions;
+		std::vector<std::pair<uint32_t, const TransformBufferData*>> m_DirtyGlobalSlots;
+
+		uint32_t m_Capacity = 0;
+		uint32_t m_LiveCount = 0;
+		uint32_t m_UploadedSlots = 0;
+		uint32_t m_CopyRegions = 0;
+
+		uint64_t m_FrameIndex = 1;
+	};
+}
@@ -0,0 +1,156 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#include "sppch.h"
+#include "InstanceClusterTree.h"
+
+#include "Mesh.h"
+
+#include "Saturn/Core/OptickProfiler.h"
+#include "Saturn/Core/Math.h"
+
+namespace Saturn {
+
+	static AABB TransformBounds( const AABB& rBounds, const glm::mat4& rTransform )
+	{
+		// Transform the center and extend it by the absolute basis, this is the same as transforming all eight corners.
+		glm::vec3 Center = glm::vec3( rTransform * glm::vec4( ( rBounds.Min + rBounds.Max ) * 0.5f, 1.0f ) );
+		glm::vec3 HalfExtent = ( rBounds.Max - rBounds.Min ) * 0.5f;
+
+		glm::vec3 Extent = glm::abs( glm::vec3( rTransform[ 0 ] ) ) * HalfExtent.x
+			+ glm::abs( glm::vec3( rTransform[ 1 ] ) ) * HalfExtent.y
+			+ glm::abs( glm::vec3( rTransform[ 2 ] ) ) * HalfExtent.z;
+
+		return AABB( Center - Extent, Center + Extent );
+	}
+
+	InstanceClusterTree::InstanceClusterTree( const Ref<StaticMesh>& rMesh, const std::vector<MeshInstance>& rInstances )
+	{
+		SAT_PF_EVENT();
+
+		m_MeshID = rMesh->ID;
+
+		// Bounds of the whole mesh.
+		AABB MeshBounds( glm::vec3( std::numeric_limits<float>::max() ), glm::vec3( std::numeric_limits<float>::lowest() ) );
+
+		for( const auto& rSubmesh : rMesh->Submeshes() )
+		{
+			AABB Bounds = TransformBounds( rSubmesh.BoundingBox, rSubmesh.Transform );
+
+			MeshBounds.Min = glm::min( MeshBounds.Min, Bounds.Min );
+			MeshBounds.Max = glm::max( MeshBounds.Max, Bounds.Max );
+		}
+
+		if( rInstances.empty() || rMesh->Submeshes().empty() )
+			return;
+
+		const uint32_t InstanceCount = ( uint32_t ) rInstances.size();
+
+		std::vector<glm::mat4> Transforms( InstanceCount );
+		std::vector<AABB> InstanceBounds( InstanceCount );
+		std::vector<uint32_t> Order( InstanceCount );
+
+		for( uint32_t i = 0; i < InstanceCount; i++ )
+		{
+			Transforms[ i ] = rInstances[ i ].GetTransform();
+			InstanceBounds[ i ] = TransformBounds( MeshBounds, Transforms[ i ] );
+			Order[ i ] = i;
+		}
+
+		m_Nodes.reserve( ( InstanceCount / LeafSize + 1 ) * 2 );
+
+		BuildNode( Order, InstanceBounds, 0, InstanceCount );
+
+		m_Bounds = m_Nodes[ 0 ].Bounds;
+
+		m_Transforms.resize( InstanceCount );
+		m_SourceIndices = std::move( Order );
+
+		Math::HashBuilder Hash;
+		Hash.Combine( ( size_t ) m_MeshID );
+
+		for( uint32_t i = 0; i < InstanceCount; i++ )
+		{
+			m_Transforms[ i ] = Transforms[ m_SourceIndices[ i ] ];
+			Hash.Combine( m_Transforms[ i ] );
+		}
+
+		m_Hash = Hash.Hash;
+	}
+
+	void InstanceClusterTree::BuildNode( std::vector<uint32_t>& rOrder, const std::vector<AABB>& rInstanceBounds, uint32_t First, uint32_t Count )
+	{
+		const uint32_t NodeIndex = ( uint32_t ) m_Nodes.size();
+		m_Nodes.emplace_back();
+
+		AABB Bounds( glm::vec3( std::numeric_limits<float>::max() ), glm::vec3( std::numeric_limits<float>::lowest() ) );
+		AABB CenterBounds = Bounds;
+
+		for( uint32_t i = First; i < First + Count; i++ )
+		{
+			const AABB& rBounds = rInstanceBounds[ rOrder[ i ] ];
+			glm::vec3 Center = ( rBounds.Min + rBounds.Max ) * 0.5f;
+
+			Bounds.Min = glm::min( Bounds.Min, rBounds.Min );
+			Bounds.Max = glm::max( Bounds.Max, rBounds.Max );
+
+			CenterBounds.Min = glm::min( CenterBounds.Min, Center );
+			CenterBounds.Max = glm::max( CenterBounds.Max, Center );
+		}
+
+		m_Nodes[ NodeIndex ].Bounds = Bounds;
+
+		if( Count <= LeafSize )
+		{
+			m_Nodes[ NodeIndex ].First = First;
+			m_Nodes[ NodeIndex ].Count = Count;
+			m_Nodes[ NodeIndex ].Skip = NodeIndex + 1;
+
+			m_LeafCount++;
+
+			return;
+		}
+
+		// Split at the median along the longest axis of the centers.
+		glm::vec3 Extent = CenterBounds.Max - CenterBounds.Min;
+		int Axis = Extent.x > Extent.y ? ( Extent.x > Extent.z ? 0 : 2 ) : ( Extent.y > Extent.z ? 1 : 2 );
+
+		uint32_t Half = Count / 2;
+
+		std::nth_element( rOrder.begin() + First, rOrder.begin() + First + Half, rOrder.begin() + First + Count, [&]( uint32_t a, uint32_t b )
+			{
+				return rInstanceBounds[ a ].Min[ Axis ] + rInstanceBounds[ a ].Max[ Axis ] < rInstanceBounds[ b ].Min[ Axis ] + rInstanceBounds[ b ].Max[ Axis ];
+			} );
+
+		BuildNode( rOrder, rInstanceBounds, First, Half );
+		BuildNode( rOrder, rInstanceBounds, First + Half, Count - Half );
+
+		// The vector may have grown, do not hold on to a reference.
+		m_Nodes[ NodeIndex ].Skip = ( uint32_t ) m_Nodes.size();
+	}
+}
@@ -0,0 +1,160 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#pragma once
+
+#include "Saturn/Core/Ref.h"
+#include "Saturn/Core/AABB/AABB.h"
+#include "Saturn/Asset/Asset.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtx/quaternion.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <vector>
+
+namespace Saturn {
+
+	class StaticMesh;
+
+	// One placement of an instanced mesh, relative to the entity that owns it.
+	struct MeshInstance
+	{
+		glm::vec3 Position = { 0.0f, 0.0f, 0.0f };
+		glm::quat Rotation = { 1.0f, 0.0f, 0.0f, 0.0f };
+		glm::vec3 Scale = { 1.0f, 1.0f, 1.0f };
+
+		glm::mat4 GetTransform() const
+		{
+			return glm::translate( glm::mat4( 1.0f ), Position )
+				* glm::toMat4( Rotation )
+				* glm::scale( glm::mat4( 1.0f ), Scale );
+		}
+
+	public:
+		template<typename OStream>
+		static void Serialise( const MeshInstance& rObject, OStream& rStream )
+		{
+			RawSerialisation::WriteObject( rObject.Position, rStream );
+			RawSerialisation::WriteObject( rObject.Rotation, rStream );
+			RawSerialisation::WriteObject( rObject.Scale, rStream );
+		}
+
+		template<typename IStream>
+		static void Deserialise( MeshInstance& rObject, IStream& rStream )
+		{
+			RawSerialisation::ReadObject( rObject.Position, rStream );
+			RawSerialisation::ReadObject( rObject.Rotation, rStream );
+			RawSerialisation::ReadObject( rObject.Scale, rStream );
+		}
+	};
+
+	// Bounding volume hierarchy over the instances of an instanced mesh, so thousands of instances can be culled a cluster at a time.
+	// Instances are reordered so every leaf owns a contiguous range, nodes are stored depth first so a subtree is a contiguous range of nodes.
+	// Everything is relative to the entity, the tree only has to be rebuilt when the instances change.
+	class InstanceClusterTree : public RefTarget
+	{
+	public:
+		static constexpr uint32_t LeafSize = 64;
+
+		struct Node
+		{
+			AABB Bounds;
+
+			// Range of instances, Count is 0 for inner nodes.
+			uint32_t First = 0;
+			uint32_t Count = 0;
+
+			// Index of the node after this subtree.
+			uint32_t Skip = 0;
+		};
+
+	public:
+		InstanceClusterTree( const Ref<StaticMesh>& rMesh, const std::vector<MeshInstance>& rInstances );
+		~InstanceClusterTree() = default;
+
+		// Walks the tree, IsVisible is called with the bounds of every node that is reached. 
+		// Leaf is called with every leaf, the leaves of culled subtrees are passed with Visible set to false.
+		template<typename VisibleFunc, typename LeafFunc>
+		void Traverse( VisibleFunc&& rrIsVisible, LeafFunc&& rrLeaf ) const
+		{
+			uint32_t i = 0;
+
+			while( i < ( uint32_t ) m_Nodes.size() )
+			{
+				const Node& rNode = m_Nodes[ i ];
+
+				if( !rrIsVisible( rNode.Bounds ) )
+				{
+					for( uint32_t j = i; j < rNode.Skip; j++ )
+					{
+						if( m_Nodes[ j ].Count )
+							rrLeaf( m_Nodes[ j ], false );
+					}
+
+					i = rNode.Skip;
+					continue;
+				}
+
+				if( rNode.Count )
+					rrLeaf( rNode, true );
+
+				i++;
+			}
+		}
+
+		// Transform of the instance relative to the entity, indices are in tree order.
+		const glm::mat4& GetTransform( uint32_t Index ) const { return m_Transforms[ Index ]; }
+
+		// Index of the instance in the component, stays the same as long as the instances are not removed.
+		uint32_t GetSourceIndex( uint32_t Index ) const { return m_SourceIndices[ Index ]; }
+
+		const std::vector<Node>& GetNodes() const { return m_Nodes; }
+		const AABB& GetBounds() const { return m_Bounds; }
+
+		AssetID GetMeshID() const { return m_MeshID; }
+		uint32_t GetInstanceCount() const { return ( uint32_t ) m_Transforms.size(); }
+		uint32_t GetLeafCount() const { return m_LeafCount; }
+
+		// Changes when any instance moves, used by the static shadow cache.
+		size_t GetHash() const { return m_Hash; }
+
+	private:
+		void BuildNode( std::vector<uint32_t>& rOrder, const std::vector<AABB>& rInstanceBounds, uint32_t First, uint32_t Count );
+
+	private:
+		std::vector<Node> m_Nodes;
+		std::vector<glm::mat4> m_Transforms;
+		std::vector<uint32_t> m_SourceIndices;
+
+		AABB m_Bounds;
+		AssetID m_MeshID = 0;
+		uint32_t m_LeafCount = 0;
+		size_t m_Hash = 0;
+	};
+}
@@ -32,6 +32,7 @@
 #include "DescriptorSet.h"
 #include "Renderer.h"
 #include "Texture.h"
+#include "BindlessTable.h"
 
 #include "VulkanContext.h"
 
@@ -58,6 +59,10 @@ namespace Saturn {
 
 		for( auto&& texture : m_Shader->GetTextures() )
 		{
+			// Bindless textures are owned by the bindless table.
+			if( texture.Set == BindlessTable::SetIndex )
+				continue;
+
 			m_Textures[ texture.Name ] = nullptr;
 		}
 
@@ -67,6 +72,8 @@ namespace Saturn {
 			m_Uniforms.push_back( { rUniform.Name, rUniform.Location, rUniform.DataType, rUniform.Size, rUniform.Offset, rUniform.IsPushConstantData } );
 		}
 
+		BuildUniformLookup();
+
 		uint32_t Size = 0;
 
 		for( auto& rUniform : m_Uniforms )
@@ -105,6 +112,7 @@ namespace Saturn {
 
 		m_Textures = rOther->m_Textures;
 		m_Uniforms = rOther->m_Uniforms;
+		m_UniformLookup = rOther->m_UniformLookup;
 
 		m_Name = rOther->GetName();
 		m_AnyValueChanged = rOther->HasAnyValueChanged();
@@ -128,7 +136,10 @@ namespace Saturn {
 		uint32_t frame = Renderer::Get().GetCurrentFrame();
 		VkDescriptorSet Set = m_DescriptorSets[ frame ];
 
-		vkCmdBindDescriptorSets( CommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, Layout, 0, 1, &Set, 0, nullptr );
+		uint32_t DynamicOffsets[ Shader::MaxDynamicOffsets ];
+		uint32_t DynamicOffsetCount = m_Shader->GetDynamicOffsets( 0, DynamicOffsets );
+
+		vkCmdBindDescriptorSets( CommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, Layout, 0, 1, &Set, DynamicOffsetCount, DynamicOffsets );
 	}
 
 	void Material::RN_Update()
@@ -204,4 +215,69 @@ namespace Saturn {
 
 		vkUpdateDescriptorSets( VulkanContext::Get().GetDevice(), 1, &rWDS, 0, nullptr );
 	}
-}
\ No newline at end of file
+
+	void Material::BuildUniformLookup()
+	{
+		m_UniformLookup.clear();
+
+		for( uint32_t i = 0; i < ( uint32_t ) m_Uniforms.size(); i++ )
+			m_UniformLookup[ HashMaterialParam( m_Uniforms[ i ].Name ) ] = i;
+	}
+
+	MaterialParamBenchmark Material::BenchmarkParameters( const Ref< Saturn::Shader >& rShader, uint32_t Iterations )
+	{
+		MaterialParamBenchmark Result;
+		Result.Iterations = Iterations;
+
+		Ref<Material> material = Ref<Material>::Create( rShader, "Parameter Benchmark" );
+
+		// The last parameter is the worst case for the linear search.
+		auto Itr = std::find_if( material->m_Uniforms.rbegin(), material->m_Uniforms.rend(), []( const auto& rUniform ) { return rUniform.Size >= sizeof( uint32_t ); } );
+
+		if( Itr == material->m_Uniforms.rend() )
+			return Result;
+
+		const std::string Name = Itr->Name;
+		Result.Parameter = Name;
+
+		Timer BenchmarkTimer;
+
+		for( uint32_t i = 0; i < Iterations; i++ )
+		{
+			for( auto& rUniform : material->m_Uniforms )
+			{
+				if( rUniform.Name == Name )
+				{
+					Buffer& rData = rUniform.IsPushConstantData ? material->m_PushConstantData : rUniform.Data;
+					rData.Write( ( uint8_t* ) &i, sizeof( uint32_t ), rUniform.IsPushConstantData ? rUniform.Offset : 0 );
+
+					break;
+				}
+			}
+		}
+
+		Result.LinearSearchMs = BenchmarkTimer.ElapsedMilliseconds();
+
+		BenchmarkTimer.Reset();
+
+		for( uint32_t i = 0; i < Iterations; i++ )
+			material->Set<uint32_t>( Name, i );
+
+		Result.HashedNameMs = BenchmarkTimer.ElapsedMilliseconds();
+
+		BenchmarkTimer.Reset();
+
+		MaterialParam<uint32_t> Param = material->Resolve<uint32_t>( Name );
+
+		for( uint32_t i = 0; i < Iterations; i++ )
+			material->Set( Param, i );
+
+		Result.HandleMs = BenchmarkTimer.ElapsedMilliseconds();
+
+		// Keep the writes observable so they are not optimised out.
+		SAT_CORE_INFO( "Material parameter benchmark ({0}, {1} iterations): linear {2:.3f} ms, hashed name {3:.3f} ms, handle {4:.3f} ms, last value {5}", 
+			Name, Iterations, Result.LinearSearchMs, Result.HashedNameMs, Result.HandleMs, material->Get( Param ) );
+
+		return Result;
+	}
+}
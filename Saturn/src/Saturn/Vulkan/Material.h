@@ -32,12 +32,66 @@
 #include "Shader.h"
 
 #include <string>
+#include <string_view>
 
 namespace Saturn {
 
 	class Submesh;
 	class MaterialInstance;
 
+	// FNV-1a, constexpr so names written in code are hashed by the compiler (see operator""_param).
+	constexpr uint64_t HashMaterialParam( std::string_view Name )
+	{
+		uint64_t Hash = 14695981039346656037ull;
+
+		for( char c : Name )
+		{
+			Hash ^= ( uint8_t ) c;
+			Hash *= 1099511628211ull;
+		}
+
+		return Hash;
+	}
+
+	consteval uint64_t operator""_param( const char* pName, size_t Length )
+	{
+		return HashMaterialParam( std::string_view( pName, Length ) );
+	}
+
+	enum class MaterialParamStorage : uint8_t
+	{
+		None,
+		Uniform,
+		PushConstant,
+		// Value lives in the material asset's bindless entry.
+		Bindless
+	};
+
+	// Handle to a material parameter, resolved once from the shader reflection.
+	// Handles stay valid for every material that uses the same shader, setting a value through one is a write at a known offset.
+	template<typename Ty>
+	struct MaterialParam
+	{
+		MaterialParamStorage Storage = MaterialParamStorage::None;
+		uint32_t Index = 0;
+		uint32_t Offset = 0;
+
+		bool IsValid() const { return Storage != MaterialParamStorage::None; }
+	};
+
+	struct MaterialParamBenchmark
+	{
+		uint32_t Iterations = 0;
+		std::string Parameter;
+
+		// Linear search over the uniforms comparing names, how parameters used to be found.
+		float LinearSearchMs = 0.0f;
+		// Name hashed at runtime and looked up, what Set/Get with a string do now.
+		float HashedNameMs = 0.0f;
+		// Pre-resolved handle.
+		float HandleMs = 0.0f;
+	};
+
 	class Material : public RefTarget
 	{
 	public:
@@ -58,51 +112,80 @@ namespace Saturn {
 		void SetResource( const std::string& Name, const Ref< Saturn::Texture2D >& Texture, uint32_t Index );
 
 		template<typename Ty>
-		void Set( const std::string& Name, const Ty& Value ) 
+		MaterialParam<Ty> Resolve( uint64_t NameHash ) const
+		{
+			auto Itr = m_UniformLookup.find( NameHash );
+
+			if( Itr == m_UniformLookup.end() )
+				return {};
+
+			const auto& rUniform = m_Uniforms[ Itr->second ];
+
+			SAT_CORE_ASSERT( sizeof( Ty ) <= rUniform.Size, "Material parameter type is larger than the uniform!" );
+
+			if( rUniform.IsPushConstantData )
+				return { .Storage = MaterialParamStorage::PushConstant, .Index = Itr->second, .Offset = rUniform.Offset };
+
+			// Every uniform owns a buffer the size of the member.
+			return { .Storage = MaterialParamStorage::Uniform, .Index = Itr->second, .Offset = 0 };
+		}
+
+		template<typename Ty>
+		MaterialParam<Ty> Resolve( std::string_view Name ) const
 		{
-			for ( auto& Uniform : m_Uniforms )
+			return Resolve<Ty>( HashMaterialParam( Name ) );
+		}
+
+		template<typename Ty>
+		void Set( const MaterialParam<Ty>& rParam, const Ty& Value )
+		{
+			switch( rParam.Storage )
 			{
-				if ( Uniform.Name == Name )
-				{
-					if( Uniform.IsPushConstantData )
-					{
-						m_PushConstantData.Write( ( uint8_t* ) &Value, Uniform.Size, Uniform.Offset );
-					}
-					else
-					{
-						Uniform.Data.Write( ( uint8_t* ) &Value, Uniform.Size, Uniform.Offset );
-					}
-					
-					m_AnyValueChanged = true;
+				case MaterialParamStorage::PushConstant:
+					memcpy( m_PushConstantData.Data + rParam.Offset, &Value, sizeof( Ty ) );
+					break;
 
+				case MaterialParamStorage::Uniform:
+					memcpy( m_Uniforms[ rParam.Index ].Data.Data + rParam.Offset, &Value, sizeof( Ty ) );
 					break;
-				}
+
+				default:
+					return;
 			}
+
+			m_AnyValueChanged = true;
 		}
-		
+
 		template<typename Ty>
-		Ty& Get( const std::string& Name ) 
+		Ty& Get( const MaterialParam<Ty>& rParam )
 		{
-			auto Itr = std::find_if( m_Uniforms.begin(), m_Uniforms.end(), 
-				[&]( auto& uniform ) { return uniform.Name == Name; } 
-			);
-
-			if( Itr != m_Uniforms.end() )
+			switch( rParam.Storage )
 			{
-				auto& Uniform = *( Itr );
-
-				if( Uniform.IsPushConstantData )
-				{
-					return m_PushConstantData.Read< Ty >( Uniform.Offset );
-				}
-				else
-				{
-					return Uniform.Data.Read< Ty >( Uniform.Offset );
-				}
+				case MaterialParamStorage::PushConstant:
+					return m_PushConstantData.Read< Ty >( rParam.Offset );
+
+				case MaterialParamStorage::Uniform:
+					return m_Uniforms[ rParam.Index ].Data.Read< Ty >( rParam.Offset );
+
+				default:
+					break;
 			}
 
 			return *( Ty* )nullptr;
 		}
+
+		// Prefer resolving a handle once, these hash the name on every call.
+		template<typename Ty>
+		void Set( const std::string& Name, const Ty& Value ) 
+		{
+			Set( Resolve<Ty>( Name ), Value );
+		}
+		
+		template<typename Ty>
+		Ty& Get( const std::string& Name ) 
+		{
+			return Get( Resolve<Ty>( Name ) );
+		}
 		
 		Ref< Texture2D > GetResource( const std::string& Name );
 
@@ -112,6 +195,9 @@ namespace Saturn {
 
 		void SetName( const std::string& rName ) { m_Name = rName; }
 
+		// Times setting the last parameter of the shader by name and by handle.
+		static MaterialParamBenchmark BenchmarkParameters( const Ref< Saturn::Shader >& rShader, uint32_t Iterations );
+
 	public:
 
 		Ref< Saturn::Shader >& GetShader() { return m_Shader; }
@@ -126,6 +212,8 @@ namespace Saturn {
 
 		void WriteDescriptor( VkWriteDescriptorSet& rWDS );
 
+		void BuildUniformLookup();
+
 	private:
 		std::string m_Name = "";
 		Ref< Saturn::Shader > m_Shader;
@@ -135,6 +223,8 @@ namespace Saturn {
 		Buffer m_PushConstantData;
 		
 		std::vector< ShaderUniform > m_Uniforms;
+		// Name hash -> index in m_Uniforms.
+		std::unordered_map< uint64_t, uint32_t > m_UniformLookup;
 		std::unordered_map< std::string, Ref<Texture2D> > m_Textures;
 
 		// Binding Name -> Textures
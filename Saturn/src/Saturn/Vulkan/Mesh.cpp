@@ -28,6 +28,7 @@
 
 #include "sppch.h"
 #include "Mesh.h"
+#include "MeshSimplifier.h"
 
 #include "VulkanContext.h"
 #include "Renderer.h"
@@ -41,6 +42,8 @@
 #include "Saturn/Asset/MaterialAsset.h"
 #include "Saturn/Asset/AssetImporter.h"
 
+#include "Saturn/Core/OptickProfiler.h"
+
 #include <glm/ext/matrix_transform.hpp>
 #include <glm/gtc/quaternion.hpp>
 
@@ -100,8 +103,8 @@ namespace Saturn {
 
 	//////////////////////////////////////////////////////////////////////////
 
-	StaticMesh::StaticMesh( const std::string& rFilepath )
-		: m_FilePath( rFilepath )
+	StaticMesh::StaticMesh( const std::string& rFilepath, const MeshOptimisationSettings& rOptimisationSettings )
+		: m_FilePath( rFilepath ), m_OptimisationSettings( rOptimisationSettings )
 	{
 #if !defined(SAT_DIST)
 		AssimpLog::Initialize();
@@ -148,6 +151,58 @@ namespace Saturn {
 		m_MaterialsAssets.clear();
 	}
 
+	StaticMesh::StaticMesh( std::vector<StaticVertex> Vertices, std::vector<Index> Indices, std::vector<Submesh> Submeshes, const std::vector< Ref< MaterialAsset > >& rMaterials, bool QuantiseVertices )
+		: m_Vertices( std::move( Vertices ) ), m_Submeshes( std::move( Submeshes ) ), m_Indices( std::move( Indices ) )
+	{
+		m_VertexCount = ( uint32_t ) m_Vertices.size();
+		m_IndicesCount = ( uint32_t ) m_Indices.size() * 3;
+
+		m_Transform = glm::mat4( 1.0f );
+		m_InverseTransform = glm::mat4( 1.0f );
+
+		m_OptimisationSettings.QuantiseVertices = QuantiseVertices;
+
+		CreateVertexBuffer();
+		m_IndexBuffer = Ref<IndexBuffer>::Create( m_Indices.data(), m_Indices.size() * sizeof( Index ) );
+
+		m_MeshShader = ShaderLibrary::Get().Find( "shader_new" );
+		m_BaseMaterial = Ref< Material >::Create( m_MeshShader, "Base Material" );
+		m_MaterialRegistry = Ref<MaterialRegistry>::Create();
+
+		m_MaterialsAssets = rMaterials;
+
+		for( auto& rMaterialAsset : m_MaterialsAssets )
+			m_MaterialRegistry->AddAsset( rMaterialAsset );
+
+		m_MaterialRegistry->SetMesh( this );
+	}
+
+	void StaticMesh::CreateVertexBuffer()
+	{
+		m_QuantisedVertexBuffer = m_OptimisationSettings.QuantiseVertices;
+
+		if( !m_QuantisedVertexBuffer )
+		{
+			m_VertexBuffer = Ref<VertexBuffer>::Create( m_Vertices.data(), ( uint32_t ) ( m_Vertices.size() * sizeof( StaticVertex ) ) );
+			return;
+		}
+
+		// Every submesh is quantised inside its own bounds.
+		std::vector<QuantisedStaticVertex> Vertices( m_Vertices.size() );
+
+		for( const auto& rSubmesh : m_Submeshes )
+		{
+			MeshOptimiser::QuantiseVertices( m_Vertices.data() + rSubmesh.BaseVertex, rSubmesh.VertexCount, rSubmesh.GetDequantisationMatrix(), Vertices.data() + rSubmesh.BaseVertex );
+		}
+
+		m_VertexBuffer = Ref<VertexBuffer>::Create( Vertices.data(), ( uint32_t ) ( Vertices.size() * sizeof( QuantisedStaticVertex ) ) );
+	}
+
+	size_t StaticMesh::GetVertexBufferSize() const
+	{
+		return m_Vertices.size() * ( IsQuantised() ? sizeof( QuantisedStaticVertex ) : sizeof( StaticVertex ) );
+	}
+
 #if !defined(SAT_DIST)
 	void StaticMesh::CreateVertices()
 	{
@@ -212,12 +267,123 @@ namespace Saturn {
 			}
 		}
 
-		m_VertexBuffer = Ref<VertexBuffer>::Create( m_Vertices.data(), ( uint32_t ) ( m_Vertices.size() * sizeof( StaticVertex ) ) );
+		OptimiseSubmeshes();
+		GenerateLods();
+
+		CreateVertexBuffer();
 		m_IndexBuffer = Ref<IndexBuffer>::Create( m_Indices.data(), m_Indices.size() * sizeof( Index ) );
 
 		TraverseNodes( m_Scene->mRootNode );
 	}
 
+	void StaticMesh::OptimiseSubmeshes()
+	{
+		SAT_PF_EVENT();
+
+		m_OptimisationReport = {};
+
+		std::vector<StaticVertex> Vertices;
+		std::vector<Index> Indices;
+		Vertices.reserve( m_Vertices.size() );
+		Indices.reserve( m_Indices.size() );
+
+		for( auto& rSubmesh : m_Submeshes )
+		{
+			std::vector<StaticVertex> SubmeshVertices( m_Vertices.begin() + rSubmesh.BaseVertex, m_Vertices.begin() + rSubmesh.BaseVertex + rSubmesh.VertexCount );
+
+			// Index is three indices, BaseIndex and IndexCount are in single indices.
+			std::vector<uint32_t> SubmeshIndices( rSubmesh.IndexCount );
+			memcpy( SubmeshIndices.data(), m_Indices.data() + rSubmesh.BaseIndex / 3, rSubmesh.IndexCount * sizeof( uint32_t ) );
+
+			m_OptimisationReport.Before.Accumulate( MeshOptimiser::AnalyseVertexCache( SubmeshIndices, SubmeshVertices.size() ) );
+
+			MeshOptimiser::Optimise( SubmeshVertices, SubmeshIndices, m_OptimisationSettings );
+
+			m_OptimisationReport.After.Accumulate( MeshOptimiser::AnalyseVertexCache( SubmeshIndices, SubmeshVertices.size() ) );
+
+			rSubmesh.BaseVertex = ( uint32_t ) Vertices.size();
+			rSubmesh.BaseIndex = ( uint32_t ) Indices.size() * 3;
+			rSubmesh.VertexCount = ( uint32_t ) SubmeshVertices.size();
+			rSubmesh.IndexCount = ( uint32_t ) SubmeshIndices.size();
+
+			Vertices.insert( Vertices.end(), SubmeshVertices.begin(), SubmeshVertices.end() );
+
+			size_t FirstTriangle = Indices.size();
+			Indices.resize( FirstTriangle + SubmeshIndices.size() / 3 );
+			memcpy( Indices.data() + FirstTriangle, SubmeshIndices.data(), SubmeshIndices.size() * sizeof( uint32_t ) );
+		}
+
+		m_Vertices = std::move( Vertices );
+		m_Indices = std::move( Indices );
+
+		m_VertexCount = ( uint32_t ) m_Vertices.size();
+		m_IndicesCount = ( uint32_t ) m_Indices.size() * 3;
+
+		SAT_CORE_INFO( "Optimised mesh {0}: ACMR {1:.3f} -> {2:.3f}, ATVR {3:.3f} -> {4:.3f}", m_FilePath, 
+			m_OptimisationReport.Before.ACMR, m_OptimisationReport.After.ACMR, m_OptimisationReport.Before.ATVR, m_OptimisationReport.After.ATVR );
+	}
+
+	void StaticMesh::GenerateLods()
+	{
+		SAT_PF_EVENT();
+
+		if( !m_OptimisationSettings.Enabled || m_OptimisationSettings.LodCount == 0 )
+			return;
+
+		uint32_t LodTriangles = 0;
+
+		for( auto& rSubmesh : m_Submeshes )
+		{
+			rSubmesh.Lods.clear();
+
+			float Radius = glm::length( rSubmesh.BoundingBox.Max - rSubmesh.BoundingBox.Min ) * 0.5f;
+
+			if( Radius <= 0.0f || rSubmesh.IndexCount == 0 )
+				continue;
+
+			std::vector<StaticVertex> SubmeshVertices( m_Vertices.begin() + rSubmesh.BaseVertex, m_Vertices.begin() + rSubmesh.BaseVertex + rSubmesh.VertexCount );
+
+			std::vector<uint32_t> Source( rSubmesh.IndexCount );
+			memcpy( Source.data(), m_Indices.data() + rSubmesh.BaseIndex / 3, rSubmesh.IndexCount * sizeof( uint32_t ) );
+
+			float Error = 0.0f;
+
+			// Every LOD is simplified from the previous one, the LOD index ranges are placed after all of the submeshes.
+			for( uint32_t i = 0; i < m_OptimisationSettings.LodCount; i++ )
+			{
+				size_t TargetIndexCount = ( size_t ) ( ( Source.size() / 3 ) * m_OptimisationSettings.LodTriangleRatio ) * 3;
+
+				std::vector<uint32_t> Result;
+				float LodError = MeshSimplifier::Simplify( SubmeshVertices, Source, Result, TargetIndexCount, m_OptimisationSettings.LodTargetError * Radius );
+
+				// Not worth another LOD if we could not remove at least 10% of the triangles.
+				if( Result.empty() || Result.size() * 10 > Source.size() * 9 )
+					break;
+
+				MeshOptimiser::OptimiseVertexCache( Result, SubmeshVertices.size() );
+
+				Error += LodError / Radius;
+
+				SubmeshLod& rLod = rSubmesh.Lods.emplace_back();
+				rLod.BaseIndex = ( uint32_t ) m_Indices.size() * 3;
+				rLod.IndexCount = ( uint32_t ) Result.size();
+				rLod.Error = Error;
+
+				size_t FirstTriangle = m_Indices.size();
+				m_Indices.resize( FirstTriangle + Result.size() / 3 );
+				memcpy( m_Indices.data() + FirstTriangle, Result.data(), Result.size() * sizeof( uint32_t ) );
+
+				LodTriangles += rLod.IndexCount / 3;
+
+				Source = std::move( Result );
+			}
+		}
+
+		m_IndicesCount = ( uint32_t ) m_Indices.size() * 3;
+
+		SAT_CORE_INFO( "Generated LODs for mesh {0}: {1} extra triangles", m_FilePath, LodTriangles );
+	}
+
 	void StaticMesh::TraverseNodes( aiNode* node, const glm::mat4& parentTransform /*= glm::mat4( 1.0f )*/, uint32_t level /*= 0 */ )
 	{
 		glm::mat4 transform = parentTransform * Mat4FromAssimpMat4( node->mTransformation );
@@ -443,8 +609,6 @@ namespace Saturn {
 				aiString RoughnessTexturePath;
 				bool HasRoughnessTexture = material->GetTexture( aiTextureType_SHININESS, 0, &RoughnessTexturePath ) == AI_SUCCESS;
 
-				materialAsset->Set( "u_Materials.Roughness", roughness );
-
 				materialAsset->SetRoughness( roughness );
 
 				if( HasRoughnessTexture )
@@ -564,6 +728,8 @@ namespace Saturn {
 		RawSerialisation::WriteVector( m_Vertices, rStream );
 		RawSerialisation::WriteVector( m_Submeshes, rStream );
 
+		RawSerialisation::WriteObject( m_OptimisationSettings.QuantiseVertices, rStream );
+
 		RawSerialisation::WriteMatrix4x4( m_Transform, rStream );
 		RawSerialisation::WriteMatrix4x4( m_InverseTransform, rStream );
 
@@ -586,10 +752,12 @@ namespace Saturn {
 		RawSerialisation::ReadVector( m_Vertices, rStream );
 		RawSerialisation::ReadVector( m_Submeshes, rStream );
 
+		RawSerialisation::ReadObject( m_OptimisationSettings.QuantiseVertices, rStream );
+
 		RawSerialisation::ReadMatrix4x4( m_Transform, rStream );
 		RawSerialisation::ReadMatrix4x4( m_InverseTransform, rStream );
 
-		m_VertexBuffer = Ref<VertexBuffer>::Create( m_Vertices.data(), ( uint32_t ) ( m_Vertices.size() * sizeof( StaticVertex ) ) );
+		CreateVertexBuffer();
 		m_IndexBuffer = Ref<IndexBuffer>::Create( m_Indices.data(), m_Indices.size() * sizeof( Index ) );
 
 		m_MeshShader = ShaderLibrary::Get().Find( "shader_new" );
@@ -35,6 +35,7 @@
 #include "VertexBuffer.h"
 #include "IndexBuffer.h"
 #include "Material.h"
+#include "MeshOptimiser.h"
 
 #include "Saturn/Asset/MaterialAsset.h"
 
@@ -47,6 +48,7 @@
 #include <utility>
 #include <memory>
 #include <unordered_map>
+#include <algorithm>
 #include <glm/glm.hpp>
 
 #if !defined(SAT_DIST)
@@ -60,6 +62,16 @@ struct aiScene;
 
 namespace Saturn {
 
+	// A reduced version of a submesh, it uses the same vertices as the submesh but has its own index range.
+	struct SubmeshLod
+	{
+		uint32_t BaseIndex = 0;
+		uint32_t IndexCount = 0;
+
+		// Simplification error relative to the radius of the submesh bounds.
+		float Error = 0.0f;
+	};
+
 	class Submesh
 	{
 	public:
@@ -73,7 +85,36 @@ namespace Saturn {
 		AABB BoundingBox;
 
 		std::string NodeName, MeshName;
+
+		// LOD 0 is the submesh itself, so Lods[ 0 ] is LOD 1.
+		std::vector<SubmeshLod> Lods;
 	public:
+		uint32_t GetLodCount() const { return ( uint32_t ) Lods.size() + 1; }
+
+		// Returns the index range and error of a LOD, LOD 0 is the full detail submesh.
+		SubmeshLod GetLod( uint32_t LodIndex ) const
+		{
+			if( LodIndex == 0 || Lods.empty() )
+				return { BaseIndex, IndexCount, 0.0f };
+
+			return Lods[ std::min( LodIndex, ( uint32_t ) Lods.size() ) - 1 ];
+		}
+
+		// Maps quantised positions (0 to 1) back to mesh space, uses the largest extent of the bounds on every axis so normals are only scaled uniformly.
+		glm::mat4 GetDequantisationMatrix() const
+		{
+			glm::vec3 Extent = BoundingBox.Max - BoundingBox.Min;
+			float Scale = std::max( Extent.x, std::max( Extent.y, Extent.z ) );
+
+			if( Scale <= 0.0f )
+				Scale = 1.0f;
+
+			glm::mat4 Result( Scale );
+			Result[ 3 ] = glm::vec4( BoundingBox.Min, 1.0f );
+
+			return Result;
+		}
+
 		bool operator==( const Submesh& other ) const
 		{
 			return BaseVertex == other.BaseVertex && BaseIndex == other.BaseIndex && MaterialIndex == other.MaterialIndex && IndexCount == other.IndexCount && VertexCount == other.VertexCount && NodeName == other.NodeName && MeshName == other.MeshName;
@@ -94,6 +135,8 @@ namespace Saturn {
 
 			RawSerialisation::WriteString( rObject.NodeName, rStream );
 			RawSerialisation::WriteString( rObject.MeshName, rStream );
+
+			RawSerialisation::WriteVector( rObject.Lods, rStream );
 		}
 
 		template<typename IStream>
@@ -110,6 +153,8 @@ namespace Saturn {
 
 			rObject.NodeName = RawSerialisation::ReadString( rStream );
 			rObject.MeshName = RawSerialisation::ReadString( rStream );
+
+			RawSerialisation::ReadVector( rObject.Lods, rStream );
 		}
 	};
 
@@ -136,7 +181,9 @@ namespace Saturn {
 	{
 	public:
 		StaticMesh() {}
-		StaticMesh( const std::string& rFilepath );
+		StaticMesh( const std::string& rFilepath, const MeshOptimisationSettings& rOptimisationSettings = MeshOptimisationSettings() );
+		// Creates a mesh from geometry that was already processed, i.e. static geometry that was merged when the asset bundle was built.
+		StaticMesh( std::vector<StaticVertex> Vertices, std::vector<Index> Indices, std::vector<Submesh> Submeshes, const std::vector< Ref< MaterialAsset > >& rMaterials, bool QuantiseVertices );
 		virtual ~StaticMesh();
 
 		std::string& FilePath() { return m_FilePath; }
@@ -173,15 +220,29 @@ namespace Saturn {
 		Ref<MaterialRegistry>& GetMaterialRegistry() { return m_MaterialRegistry; }
 		const Ref<MaterialRegistry>& GetMaterialRegistry() const { return m_MaterialRegistry; }
 
+		// Optimisation settings are used when the mesh is imported, changing them only takes effect when the mesh is loaded again.
+		MeshOptimisationSettings& GetOptimisationSettings() { return m_OptimisationSettings; }
+		const MeshOptimisationSettings& GetOptimisationSettings() const { return m_OptimisationSettings; }
+
+		const MeshOptimisationReport& GetOptimisationReport() const { return m_OptimisationReport; }
+
+		// True when the vertex buffer holds QuantisedStaticVertex, the CPU side vertices are always full precision.
+		bool IsQuantised() const { return m_QuantisedVertexBuffer; }
+		size_t GetVertexBufferSize() const;
+
 	public:
 		void SerialiseData( std::ofstream& rStream );
 		void DeserialiseData( std::istream& rStream );
 
 	private:
+		void CreateVertexBuffer();
+
 #if !defined(SAT_DIST)
 		void TraverseNodes( aiNode* node, const glm::mat4& parentTransform = glm::mat4( 1.0f ), uint32_t level = 0 );
 		void CreateVertices();
 		void CreateMaterials();
+		void OptimiseSubmeshes();
+		void GenerateLods();
 #endif
 	private:
 		Ref<VertexBuffer> m_VertexBuffer;
@@ -209,6 +270,12 @@ namespace Saturn {
 
 		Ref<MaterialRegistry> m_MaterialRegistry;
 
+		MeshOptimisationSettings m_OptimisationSettings;
+		MeshOptimisationReport m_OptimisationReport;
+
+		// Format of the current vertex buffer, the settings can change before the mesh is reloaded.
+		bool m_QuantisedVertexBuffer = false;
+
 #if !defined(SAT_DIST)
 		std::unique_ptr<Assimp::Importer> m_Importer;
 		const aiScene* m_Scene = nullptr;
@@ -0,0 +1,590 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#include "sppch.h"
+#include "MeshOptimiser.h"
+
+#include "Saturn/Core/OptickProfiler.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <unordered_map>
+
+#include <glm/gtc/packing.hpp>
+
+namespace Saturn {
+
+	void MeshOptimisationStats::Accumulate( const MeshOptimisationStats& rOther )
+	{
+		Triangles += rOther.Triangles;
+		Vertices += rOther.Vertices;
+		CacheMisses += rOther.CacheMisses;
+
+		ACMR = Triangles ? ( float ) CacheMisses / ( float ) Triangles : 0.0f;
+		ATVR = Vertices ? ( float ) CacheMisses / ( float ) Vertices : 0.0f;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void MeshOptimiser::Optimise( std::vector<StaticVertex>& rVertices, std::vector<uint32_t>& rIndices, const MeshOptimisationSettings& rSettings )
+	{
+		SAT_PF_EVENT();
+
+		if( !rSettings.Enabled || rIndices.empty() )
+			return;
+
+		if( rSettings.WeldVertices )
+			WeldVertices( rVertices, rIndices, rSettings.WeldEpsilon );
+
+		if( rSettings.OptimiseVertexCache )
+			OptimiseVertexCache( rIndices, rVertices.size() );
+
+		// Overdraw sorting works on the vertex cache order, so it must come after.
+		if( rSettings.OptimiseOverdraw )
+			OptimiseOverdraw( rIndices, rVertices, rSettings.OverdrawThreshold );
+
+		if( rSettings.OptimiseVertexFetch )
+			OptimiseVertexFetch( rVertices, rIndices );
+	}
+
+	MeshOptimisationStats MeshOptimiser::AnalyseVertexCache( const std::vector<uint32_t>& rIndices, size_t VertexCount, uint32_t CacheSize /*= 16 */ )
+	{
+		MeshOptimisationStats Stats;
+
+		// A vertex is in the cache if it was added less than CacheSize misses ago.
+		std::vector<uint32_t> Timestamps( VertexCount, 0 );
+		uint32_t Time = CacheSize + 1;
+
+		for( uint32_t Index : rIndices )
+		{
+			if( Timestamps[ Index ] == 0 )
+				Stats.Vertices++;
+
+			if( Time - Timestamps[ Index ] > CacheSize )
+			{
+				Timestamps[ Index ] = Time++;
+				Stats.CacheMisses++;
+			}
+		}
+
+		Stats.Triangles = ( uint32_t ) rIndices.size() / 3;
+
+		Stats.ACMR = Stats.Triangles ? ( float ) Stats.CacheMisses / ( float ) Stats.Triangles : 0.0f;
+		Stats.ATVR = Stats.Vertices ? ( float ) Stats.CacheMisses / ( float ) Stats.Vertices : 0.0f;
+
+		return Stats;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Welding
+
+	static constexpr size_t s_VertexComponents = sizeof( StaticVertex ) / sizeof( float );
+
+	using WeldKey = std::array<int64_t, s_VertexComponents>;
+
+	struct WeldKeyHash
+	{
+		size_t operator()( const WeldKey& rKey ) const
+		{
+			// FNV-1a
+			uint64_t Hash = 14695981039346656037ull;
+
+			for( int64_t Value : rKey )
+			{
+				Hash ^= ( uint64_t ) Value;
+				Hash *= 1099511628211ull;
+			}
+
+			return ( size_t ) Hash;
+		}
+	};
+
+	static WeldKey MakeWeldKey( const StaticVertex& rVertex, float Epsilon )
+	{
+		float Components[ s_VertexComponents ];
+		memcpy( Components, &rVertex, sizeof( StaticVertex ) );
+
+		WeldKey Key;
+
+		for( size_t i = 0; i < s_VertexComponents; i++ )
+		{
+			if( Epsilon > 0.0f )
+			{
+				Key[ i ] = ( int64_t ) std::floor( Components[ i ] / Epsilon + 0.5f );
+			}
+			else
+			{
+				// Treat -0.0 and 0.0 as the same value.
+				float Value = Components[ i ] == 0.0f ? 0.0f : Components[ i ];
+
+				uint32_t Bits;
+				memcpy( &Bits, &Value, sizeof( uint32_t ) );
+
+				Key[ i ] = Bits;
+			}
+		}
+
+		return Key;
+	}
+
+	void MeshOptimiser::WeldVertices( std::vector<StaticVertex>& rVertices, std::vector<uint32_t>& rIndices, float Epsilon )
+	{
+		SAT_PF_EVENT();
+
+		std::unordered_map<WeldKey, uint32_t, WeldKeyHash> UniqueVertices;
+		UniqueVertices.reserve( rVertices.size() );
+
+		std::vector<uint32_t> Remap( rVertices.size() );
+		std::vector<StaticVertex> Welded;
+		Welded.reserve( rVertices.size() );
+
+		for( size_t i = 0; i < rVertices.size(); i++ )
+		{
+			auto [Itr, Inserted] = UniqueVertices.try_emplace( MakeWeldKey( rVertices[ i ], Epsilon ), ( uint32_t ) Welded.size() );
+
+			if( Inserted )
+				Welded.push_back( rVertices[ i ] );
+
+			Remap[ i ] = Itr->second;
+		}
+
+		if( Welded.size() == rVertices.size() )
+			return;
+
+		for( uint32_t& rIndex : rIndices )
+			rIndex = Remap[ rIndex ];
+
+		rVertices = std::move( Welded );
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Vertex cache (Tom Forsyth, "Linear-Speed Vertex Cache Optimisation")
+
+	static constexpr uint32_t s_ForsythCacheSize = 32;
+
+	static float ForsythVertexScore( int CachePosition, uint32_t RemainingTriangles )
+	{
+		// No triangles left that use this vertex.
+		if( RemainingTriangles == 0 )
+			return -1.0f;
+
+		float Score = 0.0f;
+
+		if( CachePosition >= 0 )
+		{
+			// The last triangle used these vertices, we don't want to favour them too much as that would make strips.
+			if( CachePosition < 3 )
+			{
+				Score = 0.75f;
+			}
+			else
+			{
+				const float Scaler = 1.0f / ( s_ForsythCacheSize - 3 );
+				Score = std::pow( 1.0f - ( CachePosition - 3 ) * Scaler, 1.5f );
+			}
+		}
+
+		// Favour vertices with only a few triangles left so we don't leave lone triangles behind.
+		Score += 2.0f / std::sqrt( ( float ) RemainingTriangles );
+
+		return Score;
+	}
+
+	void MeshOptimiser::OptimiseVertexCache( std::vector<uint32_t>& rIndices, size_t VertexCount )
+	{
+		SAT_PF_EVENT();
+
+		const uint32_t TriangleCount = ( uint32_t ) rIndices.size() / 3;
+
+		if( TriangleCount == 0 )
+			return;
+
+		// Build vertex -> triangle adjacency.
+		std::vector<uint32_t> Remaining( VertexCount, 0 );
+		for( uint32_t Index : rIndices )
+			Remaining[ Index ]++;
+
+		std::vector<uint32_t> AdjacencyOffsets( VertexCount + 1, 0 );
+		for( size_t i = 0; i < VertexCount; i++ )
+			AdjacencyOffsets[ i + 1 ] = AdjacencyOffsets[ i ] + Remaining[ i ];
+
+		std::vector<uint32_t> Adjacency( rIndices.size() );
+		{
+			std::vector<uint32_t> Fill( AdjacencyOffsets.begin(), AdjacencyOffsets.end() - 1 );
+
+			for( uint32_t t = 0; t < TriangleCount; t++ )
+			{
+				for( uint32_t k = 0; k < 3; k++ )
+					Adjacency[ Fill[ rIndices[ t * 3 + k ] ]++ ] = t;
+			}
+		}
+
+		std::vector<int> CachePositions( VertexCount, -1 );
+		std::vector<float> VertexScores( VertexCount );
+
+		for( size_t i = 0; i < VertexCount; i++ )
+			VertexScores[ i ] = ForsythVertexScore( -1, Remaining[ i ] );
+
+		std::vector<float> TriangleScores( TriangleCount );
+		std::vector<bool> Emitted( TriangleCount, false );
+
+		for( uint32_t t = 0; t < TriangleCount; t++ )
+		{
+			TriangleScores[ t ] = VertexScores[ rIndices[ t * 3 + 0 ] ] + VertexScores[ rIndices[ t * 3 + 1 ] ] + VertexScores[ rIndices[ t * 3 + 2 ] ];
+		}
+
+		std::vector<uint32_t> Result;
+		Result.reserve( rIndices.size() );
+
+		std::vector<uint32_t> Cache;
+		std::vector<uint32_t> NewCache;
+		Cache.reserve( s_ForsythCacheSize + 3 );
+		NewCache.reserve( s_ForsythCacheSize + 3 );
+
+		uint32_t BestTriangle = ( uint32_t ) ( std::max_element( TriangleScores.begin(), TriangleScores.end() ) - TriangleScores.begin() );
+		uint32_t InputCursor = 0;
+
+		for( uint32_t EmittedCount = 0; EmittedCount < TriangleCount; EmittedCount++ )
+		{
+			// Nothing in the cache is connected to anything left, fall back to the next triangle in input order.
+			if( BestTriangle == UINT32_MAX )
+			{
+				while( Emitted[ InputCursor ] )
+					InputCursor++;
+
+				BestTriangle = InputCursor;
+			}
+
+			const uint32_t* pTriangle = &rIndices[ BestTriangle * 3 ];
+
+			Result.insert( Result.end(), pTriangle, pTriangle + 3 );
+			Emitted[ BestTriangle ] = true;
+
+			// Remove the triangle from the vertex adjacency.
+			for( uint32_t k = 0; k < 3; k++ )
+			{
+				uint32_t Vertex = pTriangle[ k ];
+
+				uint32_t* pBegin = &Adjacency[ AdjacencyOffsets[ Vertex ] ];
+				uint32_t* pEnd = pBegin + Remaining[ Vertex ];
+				uint32_t* pFound = std::find( pBegin, pEnd, BestTriangle );
+
+				std::swap( *pFound, *( pEnd - 1 ) );
+				Remaining[ Vertex ]--;
+			}
+
+			// Push the triangle vertices to the front of the cache.
+			NewCache.clear();
+			NewCache.insert( NewCache.end(), pTriangle, pTriangle + 3 );
+
+			for( uint32_t Vertex : Cache )
+			{
+				if( Vertex != pTriangle[ 0 ] && Vertex != pTriangle[ 1 ] && Vertex != pTriangle[ 2 ] )
+					NewCache.push_back( Vertex );
+			}
+
+			// Vertices that fell out of the cache.
+			for( size_t i = s_ForsythCacheSize; i < NewCache.size(); i++ )
+			{
+				CachePositions[ NewCache[ i ] ] = -1;
+				VertexScores[ NewCache[ i ] ] = ForsythVertexScore( -1, Remaining[ NewCache[ i ] ] );
+			}
+
+			if( NewCache.size() > s_ForsythCacheSize )
+				NewCache.resize( s_ForsythCacheSize );
+
+			std::swap( Cache, NewCache );
+
+			for( size_t i = 0; i < Cache.size(); i++ )
+			{
+				CachePositions[ Cache[ i ] ] = ( int ) i;
+				VertexScores[ Cache[ i ] ] = ForsythVertexScore( ( int ) i, Remaining[ Cache[ i ] ] );
+			}
+
+			// Only triangles touching the cache can of changed score, pick the best one from those.
+			BestTriangle = UINT32_MAX;
+			float BestScore = -FLT_MAX;
+
+			for( uint32_t Vertex : Cache )
+			{
+				for( uint32_t a = 0; a < Remaining[ Vertex ]; a++ )
+				{
+					uint32_t Triangle = Adjacency[ AdjacencyOffsets[ Vertex ] + a ];
+
+					float Score = VertexScores[ rIndices[ Triangle * 3 + 0 ] ] + VertexScores[ rIndices[ Triangle * 3 + 1 ] ] + VertexScores[ rIndices[ Triangle * 3 + 2 ] ];
+					TriangleScores[ Triangle ] = Score;
+
+					if( Score > BestScore )
+					{
+						BestScore = Score;
+						BestTriangle = Triangle;
+					}
+				}
+			}
+		}
+
+		rIndices = std::move( Result );
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Overdraw (Sander, Nehab & Barczak, "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw")
+
+	static constexpr uint32_t s_OverdrawCacheSize = 16;
+
+	// Returns the number of misses for the triangle and updates the FIFO cache timestamps.
+	static uint32_t SimulateTriangle( const uint32_t* pTriangle, std::vector<uint32_t>& rTimestamps, uint32_t& rTime )
+	{
+		uint32_t Misses = 0;
+
+		for( uint32_t k = 0; k < 3; k++ )
+		{
+			if( rTime - rTimestamps[ pTriangle[ k ] ] > s_OverdrawCacheSize )
+			{
+				rTimestamps[ pTriangle[ k ] ] = rTime++;
+				Misses++;
+			}
+		}
+
+		return Misses;
+	}
+
+	void MeshOptimiser::OptimiseOverdraw( std::vector<uint32_t>& rIndices, const std::vector<StaticVertex>& rVertices, float Threshold )
+	{
+		SAT_PF_EVENT();
+
+		const uint32_t TriangleCount = ( uint32_t ) rIndices.size() / 3;
+
+		if( TriangleCount < 2 )
+			return;
+
+		std::vector<uint32_t> Timestamps( rVertices.size(), 0 );
+		uint32_t Time = s_OverdrawCacheSize + 1;
+
+		// Hard boundaries, every time the cache was fully flushed (all three vertices missed) we can start a new cluster without costing anything.
+		std::vector<uint32_t> HardClusters;
+
+		for( uint32_t t = 0; t < TriangleCount; t++ )
+		{
+			uint32_t Misses = SimulateTriangle( &rIndices[ t * 3 ], Timestamps, Time );
+
+			if( t == 0 || Misses == 3 )
+				HardClusters.push_back( t );
+		}
+
+		// Soft boundaries, split the hard clusters further while staying under the threshold ACMR of the cluster.
+		std::vector<uint32_t> Clusters;
+
+		for( size_t c = 0; c < HardClusters.size(); c++ )
+		{
+			uint32_t Begin = HardClusters[ c ];
+			uint32_t End = c + 1 < HardClusters.size() ? HardClusters[ c + 1 ] : TriangleCount;
+
+			// Time always moves forward, moving it past the cache size is the same as a cache flush.
+			Time += s_OverdrawCacheSize + 1;
+
+			uint32_t ClusterMisses = 0;
+			for( uint32_t t = Begin; t < End; t++ )
+				ClusterMisses += SimulateTriangle( &rIndices[ t * 3 ], Timestamps, Time );
+
+			float ClusterThreshold = Threshold * ( float ) ClusterMisses / ( float ) ( End - Begin );
+
+			Time += s_OverdrawCacheSize + 1;
+
+			uint32_t SoftBegin = Begin;
+			uint32_t SoftMisses = 0;
+
+			Clusters.push_back( Begin );
+
+			for( uint32_t t = Begin; t < End; t++ )
+			{
+				SoftMisses += SimulateTriangle( &rIndices[ t * 3 ], Timestamps, Time );
+
+				if( t + 1 < End && ( float ) SoftMisses <= ClusterThreshold * ( float ) ( t + 1 - SoftBegin ) )
+				{
+					Clusters.push_back( t + 1 );
+
+					SoftBegin = t + 1;
+					SoftMisses = 0;
+
+					Time += s_OverdrawCacheSize + 1;
+				}
+			}
+		}
+
+		// Mesh centroid.
+		glm::vec3 MeshCentroid( 0.0f );
+		for( uint32_t Index : rIndices )
+			MeshCentroid += rVertices[ Index ].Position;
+
+		MeshCentroid /= ( float ) rIndices.size();
+
+		// Sort key: how much the cluster faces away from the center of the mesh, clusters on the outside are drawn first.
+		const uint32_t ClusterCount = ( uint32_t ) Clusters.size();
+		std::vector<float> SortKeys( ClusterCount );
+
+		for( uint32_t c = 0; c < ClusterCount; c++ )
+		{
+			uint32_t Begin = Clusters[ c ];
+			uint32_t End = c + 1 < ClusterCount ? Clusters[ c + 1 ] : TriangleCount;
+
+			glm::vec3 Centroid( 0.0f );
+			glm::vec3 Normal( 0.0f );
+			float Area = 0.0f;
+
+			for( uint32_t t = Begin; t < End; t++ )
+			{
+				const glm::vec3& A = rVertices[ rIndices[ t * 3 + 0 ] ].Position;
+				const glm::vec3& B = rVertices[ rIndices[ t * 3 + 1 ] ].Position;
+				const glm::vec3& C = rVertices[ rIndices[ t * 3 + 2 ] ].Position;
+
+				glm::vec3 TriangleNormal = glm::cross( B - A, C - A );
+				float TriangleArea = glm::length( TriangleNormal );
+
+				Centroid += ( A + B + C ) * ( TriangleArea / 3.0f );
+				Normal += TriangleNormal;
+				Area += TriangleArea;
+			}
+
+			if( Area > 0.0f )
+				Centroid /= Area;
+
+			float NormalLength = glm::length( Normal );
+
+			if( NormalLength > 0.0f )
+				Normal /= NormalLength;
+
+			SortKeys[ c ] = glm::dot( Centroid - MeshCentroid, Normal );
+		}
+
+		std::vector<uint32_t> Order( ClusterCount );
+		std::iota( Order.begin(), Order.end(), 0 );
+
+		std::stable_sort( Order.begin(), Order.end(), [&]( uint32_t a, uint32_t b ) { return SortKeys[ a ] > SortKeys[ b ]; } );
+
+		std::vector<uint32_t> Result;
+		Result.reserve( rIndices.size() );
+
+		for( uint32_t c : Order )
+		{
+			uint32_t Begin = Clusters[ c ];
+			uint32_t End = c + 1 < ClusterCount ? Clusters[ c + 1 ] : TriangleCount;
+
+			Result.insert( Result.end(), rIndices.begin() + Begin * 3, rIndices.begin() + End * 3 );
+		}
+
+		rIndices = std::move( Result );
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Vertex fetch
+
+	void MeshOptimiser::OptimiseVertexFetch( std::vector<StaticVertex>& rVertices, std::vector<uint32_t>& rIndices )
+	{
+		SAT_PF_EVENT();
+
+		std::vector<uint32_t> Remap( rVertices.size(), UINT32_MAX );
+		std::vector<StaticVertex> Result;
+		Result.reserve( rVertices.size() );
+
+		// Vertices are laid out in the order they are first used, unused vertices are dropped.
+		for( uint32_t& rIndex : rIndices )
+		{
+			if( Remap[ rIndex ] == UINT32_MAX )
+			{
+				Remap[ rIndex ] = ( uint32_t ) Result.size();
+				Result.push_back( rVertices[ rIndex ] );
+			}
+
+			rIndex = Remap[ rIndex ];
+		}
+
+		rVertices = std::move( Result );
+	}
+
+	static glm::vec2 OctahedralEncode( const glm::vec3& rVector )
+	{
+		float Length = std::abs( rVector.x ) + std::abs( rVector.y ) + std::abs( rVector.z );
+
+		// Zero vectors (missing tangents) decode to +Z.
+		if( Length <= 0.0f )
+			return glm::vec2( 0.0f );
+
+		glm::vec3 Normal = rVector / Length;
+		glm::vec2 Result( Normal.x, Normal.y );
+
+		// Fold the lower hemisphere over the diagonals.
+		if( Normal.z < 0.0f )
+		{
+			Result.x = ( 1.0f - std::abs( Normal.y ) ) * ( Normal.x >= 0.0f ? 1.0f : -1.0f );
+			Result.y = ( 1.0f - std::abs( Normal.x ) ) * ( Normal.y >= 0.0f ? 1.0f : -1.0f );
+		}
+
+		return Result;
+	}
+
+	void MeshOptimiser::QuantiseVertices( const StaticVertex* pVertices, size_t Count, const glm::mat4& rDequantisation, QuantisedStaticVertex* pResult )
+	{
+		SAT_PF_EVENT();
+
+		glm::vec3 Origin = glm::vec3( rDequantisation[ 3 ] );
+		float InverseScale = 1.0f / rDequantisation[ 0 ][ 0 ];
+
+		for( size_t i = 0; i < Count; i++ )
+		{
+			const StaticVertex& rVertex = pVertices[ i ];
+			QuantisedStaticVertex& rResult = pResult[ i ];
+
+			glm::vec3 Position = glm::clamp( ( rVertex.Position - Origin ) * InverseScale, glm::vec3( 0.0f ), glm::vec3( 1.0f ) );
+
+			rResult.Position[ 0 ] = glm::packUnorm1x16( Position.x );
+			rResult.Position[ 1 ] = glm::packUnorm1x16( Position.y );
+			rResult.Position[ 2 ] = glm::packUnorm1x16( Position.z );
+			rResult.Position[ 3 ] = 0;
+
+			glm::vec2 Normal = OctahedralEncode( rVertex.Normal );
+			glm::vec2 Tangent = OctahedralEncode( rVertex.Tangent );
+
+			rResult.Normal[ 0 ] = ( int16_t ) glm::packSnorm1x16( Normal.x );
+			rResult.Normal[ 1 ] = ( int16_t ) glm::packSnorm1x16( Normal.y );
+			rResult.Tangent[ 0 ] = ( int16_t ) glm::packSnorm1x16( Tangent.x );
+			rResult.Tangent[ 1 ] = ( int16_t ) glm::packSnorm1x16( Tangent.y );
+
+			// The binormal is cross( Normal, Tangent ) * Sign.
+			bool Flipped = glm::dot( glm::cross( rVertex.Normal, rVertex.Tangent ), rVertex.Binormal ) < 0.0f;
+
+			rResult.BinormalSign[ 0 ] = Flipped ? -32767 : 32767;
+			rResult.BinormalSign[ 1 ] = 0;
+
+			rResult.Texcoord[ 0 ] = glm::packHalf1x16( rVertex.Texcoord.x );
+			rResult.Texcoord[ 1 ] = glm::packHalf1x16( rVertex.Texcoord.y );
+		}
+	}
+}
@@ -0,0 +1,105 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#pragma once
+
+#include "VertexBuffer.h"
+
+#include <vector>
+#include <cstdint>
+
+namespace Saturn {
+
+	// Per mesh asset settings, saved in the static mesh asset file.
+	struct MeshOptimisationSettings
+	{
+		bool Enabled = true;
+
+		// Merge vertices that are the same, when the epsilon is zero only bitwise identical vertices are merged.
+		bool WeldVertices = true;
+		float WeldEpsilon = 0.0f;
+
+		// Reorder triangles for the post-transform vertex cache.
+		bool OptimiseVertexCache = true;
+
+		// Reorder clusters of triangles front to back, the threshold is how much worse the ACMR is allowed to get (1.05 = 5%).
+		bool OptimiseOverdraw = true;
+		float OverdrawThreshold = 1.05f;
+
+		// Reorder vertices in the order they are first used by the index buffer.
+		bool OptimiseVertexFetch = true;
+
+		// Number of reduced LODs to generate per submesh, not counting the full detail mesh.
+		// Each LOD targets LodTriangleRatio of the triangles of the previous one and may not move the surface by more than LodTargetError (relative to the submesh size).
+		uint32_t LodCount = 3;
+		float LodTriangleRatio = 0.5f;
+		float LodTargetError = 0.02f;
+
+		// Upload QuantisedStaticVertex instead of StaticVertex, this is a vertex format choice so it is not affected by Enabled.
+		bool QuantiseVertices = false;
+	};
+
+	struct MeshOptimisationStats
+	{
+		uint32_t Triangles = 0;
+		uint32_t Vertices = 0;
+		uint32_t CacheMisses = 0;
+
+		// Average cache miss ratio (misses per triangle), 0.5 is the best, 3.0 is the worst.
+		float ACMR = 0.0f;
+		// Average transform to vertex ratio (misses per vertex), 1.0 is the best.
+		float ATVR = 0.0f;
+
+		void Accumulate( const MeshOptimisationStats& rOther );
+	};
+
+	struct MeshOptimisationReport
+	{
+		MeshOptimisationStats Before;
+		MeshOptimisationStats After;
+	};
+
+	// CPU only mesh optimisation, does not touch any GPU resources so it can be used without a renderer.
+	// All functions work on a single submesh, indices must be local to the vertex array.
+	class MeshOptimiser
+	{
+	public:
+		static void Optimise( std::vector<StaticVertex>& rVertices, std::vector<uint32_t>& rIndices, const MeshOptimisationSettings& rSettings );
+
+		// Simulates a FIFO post-transform cache.
+		static MeshOptimisationStats AnalyseVertexCache( const std::vector<uint32_t>& rIndices, size_t VertexCount, uint32_t CacheSize = 16 );
+
+		static void WeldVertices( std::vector<StaticVertex>& rVertices, std::vector<uint32_t>& rIndices, float Epsilon );
+		static void OptimiseVertexCache( std::vector<uint32_t>& rIndices, size_t VertexCount );
+		static void OptimiseOverdraw( std::vector<uint32_t>& rIndices, const std::vector<StaticVertex>& rVertices, float Threshold );
+		static void OptimiseVertexFetch( std::vector<StaticVertex>& rVertices, std::vector<uint32_t>& rIndices );
+
+		// Positions are mapped with the inverse of the dequantisation matrix, which must be a uniform scale and a translation.
+		static void QuantiseVertices( const StaticVertex* pVertices, size_t Count, const glm::mat4& rDequantisation, QuantisedStaticVertex* pResult );
+	};
+}
@@ -0,0 +1,418 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#include "sppch.h"
+#include "MeshSimplifier.h"
+
+#include "Saturn/Core/OptickProfiler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+namespace Saturn {
+
+	// Border planes are weighted so that the border of an open mesh keeps its shape.
+	static constexpr float s_BorderWeight = 10.0f;
+	static constexpr uint32_t s_MaxPasses = 100;
+
+	struct Quadric
+	{
+		double A00 = 0.0, A11 = 0.0, A22 = 0.0;
+		double A01 = 0.0, A02 = 0.0, A12 = 0.0;
+		double B0 = 0.0, B1 = 0.0, B2 = 0.0;
+		double C = 0.0;
+		double Weight = 0.0;
+
+		void AddPlane( const glm::vec3& rNormal, float Distance, float PlaneWeight )
+		{
+			const double x = rNormal.x, y = rNormal.y, z = rNormal.z, d = Distance, w = PlaneWeight;
+
+			A00 += w * x * x; A11 += w * y * y; A22 += w * z * z;
+			A01 += w * x * y; A02 += w * x * z; A12 += w * y * z;
+			B0 += w * x * d; B1 += w * y * d; B2 += w * z * d;
+			C += w * d * d;
+			Weight += w;
+		}
+
+		Quadric operator+( const Quadric& rOther ) const
+		{
+			Quadric Result;
+			Result.A00 = A00 + rOther.A00; Result.A11 = A11 + rOther.A11; Result.A22 = A22 + rOther.A22;
+			Result.A01 = A01 + rOther.A01; Result.A02 = A02 + rOther.A02; Result.A12 = A12 + rOther.A12;
+			Result.B0 = B0 + rOther.B0; Result.B1 = B1 + rOther.B1; Result.B2 = B2 + rOther.B2;
+			Result.C = C + rOther.C;
+			Result.Weight = Weight + rOther.Weight;
+
+			return Result;
+		}
+
+		// Weighted mean of the squared distances to all planes.
+		double Error( const glm::vec3& rPoint ) const
+		{
+			const double x = rPoint.x, y = rPoint.y, z = rPoint.z;
+
+			double Result = A00 * x * x + A11 * y * y + A22 * z * z
+				+ 2.0 * ( A01 * x * y + A02 * x * z + A12 * y * z )
+				+ 2.0 * ( B0 * x + B1 * y + B2 * z )
+				+ C;
+
+			return std::abs( Result ) / std::max( Weight, 1e-12 );
+		}
+	};
+
+	enum class VertexKind : uint8_t
+	{
+		Manifold,
+		Border,
+		// Attribute seams and non-manifold vertices.
+		Locked
+	};
+
+	struct Collapse
+	{
+		uint32_t From;
+		uint32_t To;
+		double Cost;
+	};
+
+	static uint64_t EdgeKey( uint32_t a, uint32_t b )
+	{
+		return ( ( uint64_t ) a << 32 ) | b;
+	}
+
+	static void BuildEdgeCounts( const std::vector<uint32_t>& rIndices, const std::vector<uint32_t>& rCanonical, std::unordered_map<uint64_t, uint32_t>& rEdges )
+	{
+		rEdges.clear();
+		rEdges.reserve( rIndices.size() );
+
+		for( size_t i = 0; i < rIndices.size(); i += 3 )
+		{
+			for( uint32_t e = 0; e < 3; e++ )
+			{
+				uint32_t a = rCanonical[ rIndices[ i + e ] ];
+				uint32_t b = rCanonical[ rIndices[ i + ( e + 1 ) % 3 ] ];
+
+				rEdges[ EdgeKey( a, b ) ]++;
+			}
+		}
+	}
+
+	static bool IsBorderEdge( const std::unordered_map<uint64_t, uint32_t>& rEdges, uint32_t a, uint32_t b )
+	{
+		// An edge is on the border when only one side of it has a triangle.
+		bool Forward = rEdges.find( EdgeKey( a, b ) ) != rEdges.end();
+		bool Backward = rEdges.find( EdgeKey( b, a ) ) != rEdges.end();
+
+		return Forward != Backward;
+	}
+
+	float MeshSimplifier::Simplify( const std::vector<StaticVertex>& rVertices, const std::vector<uint32_t>& rIndices, std::vector<uint32_t>& rResult, size_t TargetIndexCount, float TargetError )
+	{
+		SAT_PF_EVENT();
+
+		rResult = rIndices;
+
+		if( rIndices.size() <= TargetIndexCount || rVertices.empty() )
+			return 0.0f;
+
+		const uint32_t VertexCount = ( uint32_t ) rVertices.size();
+
+		// Vertices that share a position (attribute seams) map to the same canonical vertex.
+		std::vector<uint32_t> Canonical( VertexCount );
+		std::vector<uint32_t> GroupSize( VertexCount, 0 );
+		{
+			struct PositionHash
+			{
+				size_t operator()( const glm::vec3& rPosition ) const
+				{
+					// -0 and 0 compare equal, so they must hash the same as well.
+					glm::vec3 Position = rPosition;
+					for( int Axis = 0; Axis < 3; Axis++ )
+					{
+						if( Position[ Axis ] == 0.0f )
+							Position[ Axis ] = 0.0f;
+					}
+
+					uint32_t Bits[ 3 ];
+					memcpy( Bits, &Position, sizeof( Bits ) );
+
+					return ( ( size_t ) Bits[ 0 ] * 73856093 ) ^ ( ( size_t ) Bits[ 1 ] * 19349663 ) ^ ( ( size_t ) Bits[ 2 ] * 83492791 );
+				}
+			};
+
+			std::unordered_map<glm::vec3, uint32_t, PositionHash> Positions;
+			Positions.reserve( VertexCount );
+
+			for( uint32_t v = 0; v < VertexCount; v++ )
+			{
+				auto [Itr, Inserted] = Positions.try_emplace( rVertices[ v ].Position, v );
+				Canonical[ v ] = Itr->second;
+				GroupSize[ Itr->second ]++;
+			}
+		}
+
+		std::unordered_map<uint64_t, uint32_t> Edges;
+		BuildEdgeCounts( rIndices, Canonical, Edges );
+
+		std::vector<VertexKind> Kinds( VertexCount, VertexKind::Manifold );
+
+		for( uint32_t v = 0; v < VertexCount; v++ )
+		{
+			if( GroupSize[ Canonical[ v ] ] > 1 )
+				Kinds[ v ] = VertexKind::Locked;
+		}
+
+		for( const auto& [Key, Count] : Edges )
+		{
+			uint32_t a = ( uint32_t ) ( Key >> 32 );
+			uint32_t b = ( uint32_t ) ( Key & 0xFFFFFFFF );
+
+			// Non-manifold edge.
+			if( Count > 1 )
+			{
+				Kinds[ a ] = VertexKind::Locked;
+				Kinds[ b ] = VertexKind::Locked;
+			}
+			else if( Edges.find( EdgeKey( b, a ) ) == Edges.end() )
+			{
+				if( Kinds[ a ] == VertexKind::Manifold ) Kinds[ a ] = VertexKind::Border;
+				if( Kinds[ b ] == VertexKind::Manifold ) Kinds[ b ] = VertexKind::Border;
+			}
+		}
+
+		// Build the quadrics, they are stored on the canonical vertex.
+		std::vector<Quadric> Quadrics( VertexCount );
+
+		for( size_t i = 0; i < rIndices.size(); i += 3 )
+		{
+			const glm::vec3& P0 = rVertices[ rIndices[ i + 0 ] ].Position;
+			const glm::vec3& P1 = rVertices[ rIndices[ i + 1 ] ].Position;
+			const glm::vec3& P2 = rVertices[ rIndices[ i + 2 ] ].Position;
+
+			glm::vec3 Normal = glm::cross( P1 - P0, P2 - P0 );
+			float Area = glm::length( Normal );
+
+			if( Area <= 0.0f )
+				continue;
+
+			Normal /= Area;
+
+			for( uint32_t k = 0; k < 3; k++ )
+				Quadrics[ Canonical[ rIndices[ i + k ] ] ].AddPlane( Normal, -glm::dot( Normal, P0 ), Area );
+
+			for( uint32_t e = 0; e < 3; e++ )
+			{
+				uint32_t a = Canonical[ rIndices[ i + e ] ];
+				uint32_t b = Canonical[ rIndices[ i + ( e + 1 ) % 3 ] ];
+
+				if( Edges.find( EdgeKey( b, a ) ) != Edges.end() )
+					continue;
+
+				// Plane going through the border edge perpendicular to the triangle.
+				const glm::vec3& Pa = rVertices[ a ].Position;
+				const glm::vec3& Pb = rVertices[ b ].Position;
+
+				glm::vec3 Edge = Pb - Pa;
+				float EdgeLength = glm::length( Edge );
+
+				if( EdgeLength <= 0.0f )
+					continue;
+
+				glm::vec3 BorderNormal = glm::cross( Edge, Normal ) / EdgeLength;
+				float Weight = EdgeLength * EdgeLength * s_BorderWeight;
+
+				Quadrics[ a ].AddPlane( BorderNormal, -glm::dot( BorderNormal, Pa ), Weight );
+				Quadrics[ b ].AddPlane( BorderNormal, -glm::dot( BorderNormal, Pa ), Weight );
+			}
+		}
+
+		const double MaxCost = ( double ) TargetError * ( double ) TargetError;
+		double ResultError = 0.0;
+
+		std::vector<Collapse> Collapses;
+		std::vector<uint32_t> Remap( VertexCount );
+		std::vector<bool> PassLocked( VertexCount );
+		std::vector<uint32_t> AdjacencyOffsets( VertexCount + 1 );
+		std::vector<uint32_t> Adjacency;
+
+		for( uint32_t Pass = 0; Pass < s_MaxPasses && rResult.size() > TargetIndexCount; Pass++ )
+		{
+			BuildEdgeCounts( rResult, Canonical, Edges );
+
+			// Vertex -> triangle adjacency for the current result.
+			std::fill( AdjacencyOffsets.begin(), AdjacencyOffsets.end(), 0 );
+			for( uint32_t Index : rResult )
+				AdjacencyOffsets[ Index + 1 ]++;
+
+			for( uint32_t v = 0; v < VertexCount; v++ )
+				AdjacencyOffsets[ v + 1 ] += AdjacencyOffsets[ v ];
+
+			Adjacency.resize( rResult.size() );
+			{
+				std::vector<uint32_t> Fill( AdjacencyOffsets.begin(), AdjacencyOffsets.end() - 1 );
+
+				for( uint32_t i = 0; i < ( uint32_t ) rResult.size(); i++ )
+					Adjacency[ Fill[ rResult[ i ] ]++ ] = i / 3;
+			}
+
+			// Gather every valid collapse.
+			Collapses.clear();
+
+			for( size_t i = 0; i < rResult.size(); i += 3 )
+			{
+				for( uint32_t e = 0; e < 3; e++ )
+				{
+					uint32_t a = rResult[ i + e ];
+					uint32_t b = rResult[ i + ( e + 1 ) % 3 ];
+
+					for( uint32_t Direction = 0; Direction < 2; Direction++ )
+					{
+						uint32_t From = Direction ? b : a;
+						uint32_t To = Direction ? a : b;
+
+						if( Kinds[ From ] == VertexKind::Locked )
+							continue;
+
+						// Border vertices may only slide along the border.
+						if( Kinds[ From ] == VertexKind::Border &&
+							( Kinds[ To ] != VertexKind::Border || !IsBorderEdge( Edges, Canonical[ From ], Canonical[ To ] ) ) )
+							continue;
+
+						double Cost = ( Quadrics[ Canonical[ From ] ] + Quadrics[ Canonical[ To ] ] ).Error( rVertices[ To ].Position );
+
+						if( Cost <= MaxCost )
+							Collapses.push_back( { From, To, Cost } );
+					}
+				}
+			}
+
+			if( Collapses.empty() )
+				break;
+
+			std::sort( Collapses.begin(), Collapses.end(), []( const Collapse& a, const Collapse& b ) { return a.Cost < b.Cost; } );
+
+			for( uint32_t v = 0; v < VertexCount; v++ )
+				Remap[ v ] = v;
+
+			std::fill( PassLocked.begin(), PassLocked.end(), false );
+
+			size_t RemainingIndices = rResult.size();
+			uint32_t Applied = 0;
+
+			for( const Collapse& rCollapse : Collapses )
+			{
+				if( RemainingIndices <= TargetIndexCount )
+					break;
+
+				if( PassLocked[ rCollapse.From ] || PassLocked[ rCollapse.To ] )
+					continue;
+
+				const glm::vec3& Target = rVertices[ rCollapse.To ].Position;
+
+				// Reject the collapse if any triangle would flip.
+				bool Flips = false;
+				uint32_t Degenerate = 0;
+
+				for( uint32_t a = AdjacencyOffsets[ rCollapse.From ]; a < AdjacencyOffsets[ rCollapse.From + 1 ]; a++ )
+				{
+					const uint32_t* pTriangle = &rResult[ Adjacency[ a ] * 3 ];
+
+					if( pTriangle[ 0 ] == rCollapse.To || pTriangle[ 1 ] == rCollapse.To || pTriangle[ 2 ] == rCollapse.To )
+					{
+						Degenerate++;
+						continue;
+					}
+
+					glm::vec3 Before[ 3 ], After[ 3 ];
+					for( uint32_t k = 0; k < 3; k++ )
+					{
+						Before[ k ] = rVertices[ pTriangle[ k ] ].Position;
+						After[ k ] = pTriangle[ k ] == rCollapse.From ? Target : Before[ k ];
+					}
+
+					glm::vec3 NormalBefore = glm::cross( Before[ 1 ] - Before[ 0 ], Before[ 2 ] - Before[ 0 ] );
+					glm::vec3 NormalAfter = glm::cross( After[ 1 ] - After[ 0 ], After[ 2 ] - After[ 0 ] );
+
+					if( glm::dot( NormalBefore, NormalAfter ) <= 0.0f )
+					{
+						Flips = true;
+						break;
+					}
+				}
+
+				if( Flips )
+					continue;
+
+				Remap[ rCollapse.From ] = rCollapse.To;
+				Quadrics[ Canonical[ rCollapse.To ] ] = Quadrics[ Canonical[ rCollapse.To ] ] + Quadrics[ Canonical[ rCollapse.From ] ];
+
+				ResultError = std::max( ResultError, rCollapse.Cost );
+				RemainingIndices -= Degenerate * 3;
+				Applied++;
+
+				// Neighbours can not move this pass, otherwise the flip test above would be wrong.
+				PassLocked[ rCollapse.From ] = true;
+				PassLocked[ rCollapse.To ] = true;
+
+				for( uint32_t a = AdjacencyOffsets[ rCollapse.From ]; a < AdjacencyOffsets[ rCollapse.From + 1 ]; a++ )
+				{
+					const uint32_t* pTriangle = &rResult[ Adjacency[ a ] * 3 ];
+
+					for( uint32_t k = 0; k < 3; k++ )
+						PassLocked[ pTriangle[ k ] ] = true;
+				}
+			}
+
+			if( Applied == 0 )
+				break;
+
+			// Apply the collapses and remove the triangles that became degenerate.
+			size_t Write = 0;
+
+			for( size_t i = 0; i < rResult.size(); i += 3 )
+			{
+				uint32_t a = Remap[ rResult[ i + 0 ] ];
+				uint32_t b = Remap[ rResult[ i + 1 ] ];
+				uint32_t c = Remap[ rResult[ i + 2 ] ];
+
+				if( a == b || b == c || a == c )
+					continue;
+
+				rResult[ Write++ ] = a;
+				rResult[ Write++ ] = b;
+				rResult[ Write++ ] = c;
+			}
+
+			rResult.resize( Write );
+		}
+
+		return ( float ) std::sqrt( ResultError );
+	}
+}
@@ -0,0 +1,48 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#pragma once
+
+#include "VertexBuffer.h"
+
+#include <vector>
+#include <cstdint>
+
+namespace Saturn {
+
+	// Quadric error metric edge-collapse simplifier (Garland & Heckbert).
+	// Vertices are only ever collapsed on to other existing vertices so the result can share the vertex buffer of the source mesh.
+	// Vertices on attribute seams are locked and border vertices can only slide along the border.
+	class MeshSimplifier
+	{
+	public:
+		// Returns the error of the result as a distance in mesh space.
+		// Stops when the index count is at or below the target or when the next collapse would be above the target error (in mesh space).
+		static float Simplify( const std::vector<StaticVertex>& rVertices, const std::vector<uint32_t>& rIndices, std::vector<uint32_t>& rResult, size_t TargetIndexCount, float TargetError );
+	};
+}
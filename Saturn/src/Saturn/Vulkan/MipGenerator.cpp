@@ -0,0 +1,435 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#include "sppch.h"
+#include "MipGenerator.h"
+
+#include "Saturn/Core/JobSystem.h"
+#include "Saturn/Core/OptickProfiler.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+
+#include <glm/gtc/constants.hpp>
+
+#if defined( _M_X64 ) || defined( __SSE2__ )
+#define SAT_MIP_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace Saturn {
+
+	// Radius of the Kaiser filter in destination texels.
+	static constexpr float FilterRadius = 3.0f;
+	static constexpr float KaiserAlpha = 4.0f;
+
+	static constexpr uint32_t RowsPerJob = 16;
+
+	// Linear to sRGB is a table lookup indexed by the linear value, big enough that the dark end (where sRGB is steepest) stays within a step.
+	static constexpr uint32_t LinearTableSize = 16384;
+
+	struct SRGBTables
+	{
+		std::array<float, 256> ToLinear;
+		std::array<uint8_t, LinearTableSize> ToSRGB;
+
+		SRGBTables()
+		{
+			for( uint32_t i = 0; i < 256; i++ )
+				ToLinear[ i ] = MipGenerator::SRGBToLinear( i / 255.0f );
+
+			for( uint32_t i = 0; i < LinearTableSize; i++ )
+				ToSRGB[ i ] = ( uint8_t ) ( MipGenerator::LinearToSRGB( i / ( float ) ( LinearTableSize - 1 ) ) * 255.0f + 0.5f );
+		}
+	};
+
+	static const SRGBTables& GetSRGBTables()
+	{
+		static SRGBTables s_Tables;
+		return s_Tables;
+	}
+
+	static uint8_t QuantiseUNorm( float Value )
+	{
+		return ( uint8_t ) ( std::clamp( Value, 0.0f, 1.0f ) * 255.0f + 0.5f );
+	}
+
+	static uint8_t QuantiseSRGB( const SRGBTables& rTables, float Value )
+	{
+		return rTables.ToSRGB[ ( uint32_t ) ( std::clamp( Value, 0.0f, 1.0f ) * ( LinearTableSize - 1 ) + 0.5f ) ];
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Filters
+
+	static float BesselI0( float x )
+	{
+		// Power series, converges quickly for the range the window uses.
+		float Sum = 1.0f;
+		float Term = 1.0f;
+		const float HalfX = x * 0.5f;
+
+		for( int k = 1; k < 20; k++ )
+		{
+			Term *= ( HalfX / k ) * ( HalfX / k );
+			Sum += Term;
+		}
+
+		return Sum;
+	}
+
+	static float KaiserWindowedSinc( float x )
+	{
+		if( std::abs( x ) >= FilterRadius )
+			return 0.0f;
+
+		const float Sinc = x == 0.0f ? 1.0f : std::sin( glm::pi<float>() * x ) / ( glm::pi<float>() * x );
+
+		const float t = x / FilterRadius;
+		const float Window = BesselI0( KaiserAlpha * std::sqrt( 1.0f - t * t ) ) / BesselI0( KaiserAlpha );
+
+		return Sinc * Window;
+	}
+
+	// Texels outside of the image wrap around, textures are sampled with repeat addressing.
+	static uint32_t Wrap( int32_t i, uint32_t Size )
+	{
+		const int32_t Mod = i % ( int32_t ) Size;
+
+		return ( uint32_t ) ( Mod < 0 ? Mod + ( int32_t ) Size : Mod );
+	}
+
+	struct FilterTaps
+	{
+		// Source texels, already wrapped.
+		std::vector<uint32_t> Indices;
+		std::vector<float> Weights;
+	};
+
+	// The source texels and their weights for every destination texel along one axis.
+	static std::vector<FilterTaps> BuildFilterTaps( uint32_t SrcSize, uint32_t DstSize, MipFilter Filter )
+	{
+		const float Scale = ( float ) SrcSize / ( float ) DstSize;
+		// When upscaling the filter stays one source texel wide.
+		const float Support = std::max( Scale, 1.0f );
+		const float Radius = Filter == MipFilter::Box ? Support * 0.5f : FilterRadius * Support;
+
+		std::vector<FilterTaps> Taps( DstSize );
+
+		for( uint32_t x = 0; x < DstSize; x++ )
+		{
+			const float Center = ( x + 0.5f ) * Scale;
+
+			const int32_t First = ( int32_t ) std::floor( Center - Radius );
+			const int32_t Last = ( int32_t ) std::ceil( Center + Radius );
+
+			FilterTaps& rTaps = Taps[ x ];
+			float Sum = 0.0f;
+
+			for( int32_t i = First; i < Last; i++ )
+			{
+				// A box weighs every texel by how much of it the footprint covers.
+				const float Weight = Filter == MipFilter::Box
+					? std::min( i + 1.0f, Center + Radius ) - std::max( ( float ) i, Center - Radius )
+					: KaiserWindowedSinc( ( i + 0.5f - Center ) / Support );
+
+				if( Weight == 0.0f )
+					continue;
+
+				rTaps.Indices.push_back( Wrap( i, SrcSize ) );
+				rTaps.Weights.push_back( Weight );
+				Sum += Weight;
+			}
+
+			for( float& rWeight : rTaps.Weights )
+				rWeight /= Sum;
+		}
+
+		return Taps;
+	}
+
+	static glm::vec4 WeightedSum( const glm::vec4* pRow, const FilterTaps& rTaps )
+	{
+#if defined( SAT_MIP_SSE2 )
+		__m128 Sum = _mm_setzero_ps();
+
+		for( size_t i = 0; i < rTaps.Weights.size(); i++ )
+			Sum = _mm_add_ps( Sum, _mm_mul_ps( _mm_loadu_ps( &pRow[ rTaps.Indices[ i ] ].x ), _mm_set1_ps( rTaps.Weights[ i ] ) ) );
+
+		glm::vec4 Result;
+		_mm_storeu_ps( &Result.x, Sum );
+
+		return Result;
+#else
+		glm::vec4 Sum( 0.0f );
+
+		for( size_t i = 0; i < rTaps.Weights.size(); i++ )
+			Sum += pRow[ rTaps.Indices[ i ] ] * rTaps.Weights[ i ];
+
+		return Sum;
+#endif
+	}
+
+	// Columns are filtered a whole row at a time so every read stays sequential.
+	static void AccumulateRow( glm::vec4* pDst, const glm::vec4* pSrc, uint32_t Count, float Weight )
+	{
+#if defined( SAT_MIP_SSE2 )
+		const __m128 Scale = _mm_set1_ps( Weight );
+
+		for( uint32_t x = 0; x < Count; x++ )
+			_mm_storeu_ps( &pDst[ x ].x, _mm_add_ps( _mm_loadu_ps( &pDst[ x ].x ), _mm_mul_ps( _mm_loadu_ps( &pSrc[ x ].x ), Scale ) ) );
+#else
+		for( uint32_t x = 0; x < Count; x++ )
+			pDst[ x ] += pSrc[ x ] * Weight;
+#endif
+	}
+
+	// 2x2 box filter straight on 8 bit texels, odd rows and columns are dropped the same way a GPU blit drops them.
+	// A side that is already one texel wide reads its only texel twice.
+	static void DownsampleRGBA8( const uint8_t* pSrc, uint32_t SrcWidth, uint32_t SrcHeight, uint8_t* pDst, uint32_t DstWidth, uint32_t DstHeight, bool SRGB )
+	{
+		const SRGBTables& rTables = GetSRGBTables();
+
+		JobSystem::Get().ParallelFor( DstHeight, RowsPerJob, [&]( uint32_t Begin, uint32_t End )
+			{
+				for( uint32_t y = Begin; y < End; y++ )
+				{
+					const uint8_t* pRow0 = pSrc + ( size_t ) std::min( y * 2, SrcHeight - 1 ) * SrcWidth * 4;
+					const uint8_t* pRow1 = pSrc + ( size_t ) std::min( y * 2 + 1, SrcHeight - 1 ) * SrcWidth * 4;
+
+					for( uint32_t x = 0; x < DstWidth; x++ )
+					{
+						const size_t x0 = ( size_t ) std::min( x * 2, SrcWidth - 1 ) * 4;
+						const size_t x1 = ( size_t ) std::min( x * 2 + 1, SrcWidth - 1 ) * 4;
+
+						const uint8_t* pTexels[ 4 ] = { pRow0 + x0, pRow0 + x1, pRow1 + x0, pRow1 + x1 };
+						uint8_t* pResult = pDst + ( ( size_t ) y * DstWidth + x ) * 4;
+
+						if( SRGB )
+						{
+							glm::vec4 Sum( 0.0f );
+
+							for( const uint8_t* pTexel : pTexels )
+								Sum += glm::vec4( rTables.ToLinear[ pTexel[ 0 ] ], rTables.ToLinear[ pTexel[ 1 ] ], rTables.ToLinear[ pTexel[ 2 ] ], pTexel[ 3 ] / 255.0f );
+
+							Sum *= 0.25f;
+
+							pResult[ 0 ] = QuantiseSRGB( rTables, Sum.r );
+							pResult[ 1 ] = QuantiseSRGB( rTables, Sum.g );
+							pResult[ 2 ] = QuantiseSRGB( rTables, Sum.b );
+							pResult[ 3 ] = QuantiseUNorm( Sum.a );
+							continue;
+						}
+
+#if defined( SAT_MIP_SSE2 )
+						// All four channels at once, widened to 16 bits so the sum can not overflow.
+						const __m128i Zero = _mm_setzero_si128();
+						__m128i Sum = _mm_set1_epi16( 2 );
+
+						for( const uint8_t* pTexel : pTexels )
+						{
+							int32_t Packed;
+							memcpy( &Packed, pTexel, 4 );
+
+							Sum = _mm_add_epi16( Sum, _mm_unpacklo_epi8( _mm_cvtsi32_si128( Packed ), Zero ) );
+						}
+
+						const int32_t Average = _mm_cvtsi128_si32( _mm_packus_epi16( _mm_srli_epi16( Sum, 2 ), Zero ) );
+						memcpy( pResult, &Average, 4 );
+#else
+						for( uint32_t c = 0; c < 4; c++ )
+							pResult[ c ] = ( uint8_t ) ( ( pTexels[ 0 ][ c ] + pTexels[ 1 ][ c ] + pTexels[ 2 ][ c ] + pTexels[ 3 ][ c ] + 2 ) / 4 );
+#endif
+					}
+				}
+			} );
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	std::vector<Buffer> MipGenerator::GenerateMips( const uint8_t* pPixels, uint32_t Width, uint32_t Height, MipFilter Filter, bool SRGB, uint32_t FirstMip, uint32_t EndMip )
+	{
+		SAT_PF_EVENT();
+
+		EndMip = std::min( EndMip, GetMipCount( Width, Height ) );
+
+		std::vector<Buffer> Mips;
+		Mips.reserve( EndMip > FirstMip ? EndMip - FirstMip : 0 );
+
+		if( FirstMip == 0 && EndMip > 0 )
+			Mips.push_back( Buffer::Copy( pPixels, ( size_t ) Width * Height * 4 ) );
+
+		if( Filter == MipFilter::Box )
+		{
+			Buffer Level;
+			const uint8_t* pLevel = pPixels;
+
+			for( uint32_t Mip = 1; Mip < EndMip; Mip++ )
+			{
+				Buffer Next;
+				Next.Allocate( ( size_t ) GetMipExtent( Width, Mip ) * GetMipExtent( Height, Mip ) * 4 );
+
+				DownsampleRGBA8( pLevel, GetMipExtent( Width, Mip - 1 ), GetMipExtent( Height, Mip - 1 ), Next.Data, GetMipExtent( Width, Mip ), GetMipExtent( Height, Mip ), SRGB );
+
+				// Levels before FirstMip are only needed to build the next one.
+				if( Mip - 1 < FirstMip )
+					Level.Free();
+
+				Level = Next;
+				pLevel = Level.Data;
+
+				if( Mip >= FirstMip )
+					Mips.push_back( Level );
+			}
+
+			if( EndMip > 0 && EndMip - 1 < FirstMip )
+				Level.Free();
+		}
+		else
+		{
+			FloatImage Level;
+
+			for( uint32_t Mip = 1; Mip < EndMip; Mip++ )
+			{
+				Level = Mip == 1
+					? Resample( FromRGBA8( pPixels, Width, Height, SRGB ), GetMipExtent( Width, Mip ), GetMipExtent( Height, Mip ), Filter )
+					: Resample( Level, GetMipExtent( Width, Mip ), GetMipExtent( Height, Mip ), Filter );
+
+				if( Mip < FirstMip )
+					continue;
+
+				Buffer Result;
+				Result.Allocate( Level.Pixels.size() * 4 );
+
+				ToRGBA8( Level, SRGB, Result.Data );
+
+				Mips.push_back( Result );
+			}
+		}
+
+		return Mips;
+	}
+
+	FloatImage MipGenerator::Resample( const FloatImage& rSource, uint32_t Width, uint32_t Height, MipFilter Filter )
+	{
+		SAT_PF_EVENT();
+
+		const std::vector<FilterTaps> ColumnTaps = BuildFilterTaps( rSource.Width, Width, Filter );
+		const std::vector<FilterTaps> RowTaps = BuildFilterTaps( rSource.Height, Height, Filter );
+
+		// Rows first, then columns.
+		FloatImage Horizontal;
+		Horizontal.Width = Width;
+		Horizontal.Height = rSource.Height;
+		Horizontal.Pixels.resize( ( size_t ) Width * rSource.Height );
+
+		JobSystem::Get().ParallelFor( rSource.Height, RowsPerJob, [&]( uint32_t Begin, uint32_t End )
+			{
+				for( uint32_t y = Begin; y < End; y++ )
+				{
+					const glm::vec4* pRow = &rSource.Pixels[ ( size_t ) y * rSource.Width ];
+
+					for( uint32_t x = 0; x < Width; x++ )
+						Horizontal.At( x, y ) = WeightedSum( pRow, ColumnTaps[ x ] );
+				}
+			} );
+
+		FloatImage Result;
+		Result.Width = Width;
+		Result.Height = Height;
+		Result.Pixels.resize( ( size_t ) Width * Height, glm::vec4( 0.0f ) );
+
+		JobSystem::Get().ParallelFor( Height, RowsPerJob, [&]( uint32_t Begin, uint32_t End )
+			{
+				for( uint32_t y = Begin; y < End; y++ )
+				{
+					const FilterTaps& rTaps = RowTaps[ y ];
+
+					for( size_t i = 0; i < rTaps.Weights.size(); i++ )
+						AccumulateRow( &Result.At( 0, y ), &Horizontal.At( 0, rTaps.Indices[ i ] ), Width, rTaps.Weights[ i ] );
+				}
+			} );
+
+		return Result;
+	}
+
+	FloatImage MipGenerator::FromRGBA8( const uint8_t* pPixels, uint32_t Width, uint32_t Height, bool SRGB )
+	{
+		const SRGBTables& rTables = GetSRGBTables();
+
+		FloatImage Image;
+		Image.Width = Width;
+		Image.Height = Height;
+		Image.Pixels.resize( ( size_t ) Width * Height );
+
+		for( size_t i = 0; i < Image.Pixels.size(); i++ )
+		{
+			const uint8_t* pTexel = pPixels + i * 4;
+
+			if( SRGB )
+				Image.Pixels[ i ] = glm::vec4( rTables.ToLinear[ pTexel[ 0 ] ], rTables.ToLinear[ pTexel[ 1 ] ], rTables.ToLinear[ pTexel[ 2 ] ], pTexel[ 3 ] / 255.0f );
+			else
+				Image.Pixels[ i ] = glm::vec4( pTexel[ 0 ], pTexel[ 1 ], pTexel[ 2 ], pTexel[ 3 ] ) / 255.0f;
+		}
+
+		return Image;
+	}
+
+	void MipGenerator::ToRGBA8( const FloatImage& rImage, bool SRGB, uint8_t* pResult )
+	{
+		const SRGBTables& rTables = GetSRGBTables();
+
+		for( size_t i = 0; i < rImage.Pixels.size(); i++ )
+		{
+			const glm::vec4& rTexel = rImage.Pixels[ i ];
+			uint8_t* pTexel = pResult + i * 4;
+
+			for( int c = 0; c < 3; c++ )
+				pTexel[ c ] = SRGB ? QuantiseSRGB( rTables, rTexel[ c ] ) : QuantiseUNorm( rTexel[ c ] );
+
+			pTexel[ 3 ] = QuantiseUNorm( rTexel.a );
+		}
+	}
+
+	uint32_t MipGenerator::GetMipCount( uint32_t Width, uint32_t Height )
+	{
+		return ( uint32_t ) std::floor( std::log2( std::min( Width, Height ) ) ) + 1;
+	}
+
+	float MipGenerator::SRGBToLinear( float Value )
+	{
+		return Value <= 0.04045f ? Value / 12.92f : std::pow( ( Value + 0.055f ) / 1.055f, 2.4f );
+	}
+
+	float MipGenerator::LinearToSRGB( float Value )
+	{
+		return Value <= 0.0031308f ? Value * 12.92f : 1.055f * std::pow( Value, 1.0f / 2.4f ) - 0.055f;
+	}
+}
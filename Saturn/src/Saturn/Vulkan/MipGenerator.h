@@ -0,0 +1,79 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#pragma once
+
+#include "Saturn/Core/Memory/Buffer.h"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <cstdint>
+
+namespace Saturn {
+
+	enum class MipFilter : uint8_t
+	{
+		Box,   // 2x2 average, works on 8 bit texels and is the fastest.
+		Kaiser // Kaiser windowed sinc, sharper mips with less aliasing, filters in float.
+	};
+
+	// Float RGBA image, resampling happens in float and the result is only quantised at the end.
+	struct FloatImage
+	{
+		uint32_t Width = 0;
+		uint32_t Height = 0;
+		std::vector<glm::vec4> Pixels;
+
+		glm::vec4& At( uint32_t x, uint32_t y ) { return Pixels[ ( size_t ) y * Width + x ]; }
+		const glm::vec4& At( uint32_t x, uint32_t y ) const { return Pixels[ ( size_t ) y * Width + x ]; }
+	};
+
+	// CPU only mip generation and resampling, shared by texture loading, the texture streamer, the importer and the cooker so they all build the same mips.
+	// When SRGB is set the color channels are filtered in linear space and encoded back to sRGB, alpha is always linear.
+	// Rows are split over the job system, it is safe to call from a job.
+	class MipGenerator
+	{
+	public:
+		// Mips from FirstMip up to (not including) EndMip as RGBA8, every mip is filtered from the one before it.
+		// The chain is as long as Texture::GetMipMapLevels, it ends when the smaller side reaches one texel.
+		static std::vector<Buffer> GenerateMips( const uint8_t* pPixels, uint32_t Width, uint32_t Height, MipFilter Filter, bool SRGB, uint32_t FirstMip = 0, uint32_t EndMip = UINT32_MAX );
+
+		// Separable resample to any size, used for mips and for resizing on import. Texels outside of the image wrap around.
+		static FloatImage Resample( const FloatImage& rSource, uint32_t Width, uint32_t Height, MipFilter Filter );
+
+		static FloatImage FromRGBA8( const uint8_t* pPixels, uint32_t Width, uint32_t Height, bool SRGB );
+		static void ToRGBA8( const FloatImage& rImage, bool SRGB, uint8_t* pResult );
+
+		static uint32_t GetMipCount( uint32_t Width, uint32_t Height );
+		static uint32_t GetMipExtent( uint32_t Extent, uint32_t Mip ) { return Extent >> Mip > 1 ? Extent >> Mip : 1; }
+
+		static float SRGBToLinear( float Value );
+		static float LinearToSRGB( float Value );
+	};
+}
@@ -296,7 +296,7 @@ namespace Saturn {
 		Create( m_PassSpec );
 	}
 
-	void Pass::BeginPass( VkCommandBuffer CommandBuffer, VkFramebuffer Framebuffer, VkExtent2D Extent )
+	void Pass::BeginPass( VkCommandBuffer CommandBuffer, VkFramebuffer Framebuffer, VkExtent2D Extent, VkSubpassContents Contents )
 	{
 		m_CommandBuffer = CommandBuffer;
 		
@@ -307,7 +307,7 @@ namespace Saturn {
 		RenderPassBeginInfo.pClearValues = m_ClearValues.data();
 		RenderPassBeginInfo.clearValueCount = ( uint32_t )m_ClearValues.size();
 		
-		vkCmdBeginRenderPass( m_CommandBuffer, &RenderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE );
+		vkCmdBeginRenderPass( m_CommandBuffer, &RenderPassBeginInfo, Contents );
 	}
 
 	void Pass::EndPass()
@@ -63,7 +63,8 @@ namespace Saturn {
 		void Terminate();
 		void Recreate();
 
-		void BeginPass( VkCommandBuffer CommandBuffer, VkFramebuffer Framebuffer, VkExtent2D Extent );
+		// Use VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS when the pass is recorded by a SecondaryCommandRecorder.
+		void BeginPass( VkCommandBuffer CommandBuffer, VkFramebuffer Framebuffer, VkExtent2D Extent, VkSubpassContents Contents = VK_SUBPASS_CONTENTS_INLINE );
 		void EndPass();
 		
 		operator VkRenderPass() { return m_Pass; }
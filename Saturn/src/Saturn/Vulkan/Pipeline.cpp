@@ -34,6 +34,7 @@
 
 #include "VulkanContext.h"
 #include "VulkanDebug.h"
+#include "PipelineCache.h"
 
 namespace Saturn {
 
@@ -405,7 +406,7 @@ namespace Saturn {
 		PipelineCreateInfo.pStages             = ShaderStages.data();
 		PipelineCreateInfo.stageCount          = ( uint32_t ) ShaderStages.size();
 		
-		VK_CHECK( vkCreateGraphicsPipelines( VulkanContext::Get().GetDevice(), 0, 1, &PipelineCreateInfo, nullptr, &m_Pipeline ) );
+		VK_CHECK( vkCreateGraphicsPipelines( VulkanContext::Get().GetDevice(), VulkanContext::Get().GetPipelineCache()->GetThreadCache(), 1, &PipelineCreateInfo, nullptr, &m_Pipeline ) );
 
 		SetDebugUtilsObjectName( m_Specification.Name, ( uint64_t )m_Pipeline, VK_OBJECT_TYPE_PIPELINE );
 
@@ -0,0 +1,261 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#include "sppch.h"
+#include "PipelineCache.h"
+
+#include "VulkanContext.h"
+
+#include "Saturn/Core/App.h"
+#include "Saturn/Project/Project.h"
+
+namespace Saturn {
+
+	static constexpr uint32_t s_PipelineCacheMagic = 0x43504C53; // "SLPC"
+	static constexpr uint32_t s_PipelineCacheVersion = 1;
+
+	struct PipelineCacheFileHeader
+	{
+		uint32_t Magic = s_PipelineCacheMagic;
+		uint32_t Version = s_PipelineCacheVersion;
+
+		uint32_t VendorID = 0;
+		uint32_t DeviceID = 0;
+		uint32_t DriverVersion = 0;
+		uint8_t PipelineCacheUUID[ VK_UUID_SIZE ] = {};
+
+		uint64_t DataSize = 0;
+		uint64_t DataHash = 0;
+	};
+
+	// Catches truncated or partially written files, the driver does not always validate the data itself.
+	static uint64_t HashCacheData( const uint8_t* pData, size_t Size )
+	{
+		uint64_t Hash = 14695981039346656037ull;
+
+		for( size_t i = 0; i < Size; i++ )
+			Hash = ( Hash ^ pData[ i ] ) * 1099511628211ull;
+
+		return Hash;
+	}
+
+	PipelineCache::PipelineCache()
+	{
+		m_MainThread = std::this_thread::get_id();
+
+		vkGetPhysicalDeviceProperties( VulkanContext::Get().GetPhysicalDevice(), &m_DeviceProperties );
+
+		VkPipelineCacheCreateInfo CreateInfo = { VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO };
+		VK_CHECK( vkCreatePipelineCache( VulkanContext::Get().GetDevice(), &CreateInfo, nullptr, &m_Cache ) );
+	}
+
+	PipelineCache::~PipelineCache()
+	{
+		Terminate();
+	}
+
+	void PipelineCache::Terminate()
+	{
+		VkDevice Device = VulkanContext::Get().GetDevice();
+
+		std::lock_guard<std::mutex> Lock( m_Mutex );
+
+		for( auto& [id, Cache] : m_ThreadCaches )
+			vkDestroyPipelineCache( Device, Cache, nullptr );
+
+		m_ThreadCaches.clear();
+
+		if( m_Cache )
+			vkDestroyPipelineCache( Device, m_Cache, nullptr );
+
+		m_Cache = VK_NULL_HANDLE;
+	}
+
+	VkPipelineCache PipelineCache::GetThreadCache()
+	{
+		std::thread::id ThreadID = std::this_thread::get_id();
+
+		if( ThreadID == m_MainThread )
+			return m_Cache;
+
+		std::lock_guard<std::mutex> Lock( m_Mutex );
+
+		auto Itr = m_ThreadCaches.find( ThreadID );
+
+		if( Itr != m_ThreadCaches.end() )
+			return Itr->second;
+
+		VkPipelineCache Cache = VK_NULL_HANDLE;
+
+		VkPipelineCacheCreateInfo CreateInfo = { VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO };
+		VK_CHECK( vkCreatePipelineCache( VulkanContext::Get().GetDevice(), &CreateInfo, nullptr, &Cache ) );
+
+		m_ThreadCaches[ ThreadID ] = Cache;
+
+		return Cache;
+	}
+
+	void PipelineCache::MergeThreadCaches()
+	{
+		std::lock_guard<std::mutex> Lock( m_Mutex );
+
+		if( m_ThreadCaches.empty() )
+			return;
+
+		std::vector<VkPipelineCache> Caches;
+		for( auto& [id, Cache] : m_ThreadCaches )
+			Caches.push_back( Cache );
+
+		VK_CHECK( vkMergePipelineCaches( VulkanContext::Get().GetDevice(), m_Cache, ( uint32_t ) Caches.size(), Caches.data() ) );
+	}
+
+	bool PipelineCache::IsCompatible( const std::vector<uint8_t>& rData ) const
+	{
+		if( rData.size() < sizeof( PipelineCacheFileHeader ) )
+			return false;
+
+		PipelineCacheFileHeader Header;
+		memcpy( &Header, rData.data(), sizeof( Header ) );
+
+		if( Header.Magic != s_PipelineCacheMagic || Header.Version != s_PipelineCacheVersion )
+			return false;
+
+		if( Header.VendorID != m_DeviceProperties.vendorID || Header.DeviceID != m_DeviceProperties.deviceID || Header.DriverVersion != m_DeviceProperties.driverVersion )
+			return false;
+
+		if( memcmp( Header.PipelineCacheUUID, m_DeviceProperties.pipelineCacheUUID, VK_UUID_SIZE ) != 0 )
+			return false;
+
+		if( Header.DataSize != rData.size() - sizeof( Header ) )
+			return false;
+
+		return Header.DataHash == HashCacheData( rData.data() + sizeof( Header ), ( size_t ) Header.DataSize );
+	}
+
+	bool PipelineCache::Merge( const std::filesystem::path& rPath )
+	{
+		if( rPath.empty() || !std::filesystem::exists( rPath ) )
+			return false;
+
+		std::ifstream Stream( rPath, std::ios::binary | std::ios::ate );
+
+		if( !Stream )
+			return false;
+
+		std::vector<uint8_t> FileData( ( size_t ) Stream.tellg() );
+
+		Stream.seekg( 0 );
+		Stream.read( reinterpret_cast< char* >( FileData.data() ), FileData.size() );
+
+		if( !IsCompatible( FileData ) )
+		{
+			SAT_CORE_WARN( "Pipeline cache '{0}' was written by a different device or driver or is corrupt, ignoring it.", rPath.string() );
+			return false;
+		}
+
+		VkPipelineCacheCreateInfo CreateInfo = { VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO };
+		CreateInfo.initialDataSize = FileData.size() - sizeof( PipelineCacheFileHeader );
+		CreateInfo.pInitialData = FileData.data() + sizeof( PipelineCacheFileHeader );
+
+		VkDevice Device = VulkanContext::Get().GetDevice();
+		VkPipelineCache LoadedCache = VK_NULL_HANDLE;
+
+		if( vkCreatePipelineCache( Device, &CreateInfo, nullptr, &LoadedCache ) != VK_SUCCESS )
+			return false;
+
+		VK_CHECK( vkMergePipelineCaches( Device, m_Cache, 1, &LoadedCache ) );
+
+		vkDestroyPipelineCache( Device, LoadedCache, nullptr );
+
+		SAT_CORE_INFO( "Loaded pipeline cache '{0}' ({1} KB)", rPath.string(), CreateInfo.initialDataSize / 1024 );
+
+		return true;
+	}
+
+	void PipelineCache::Save( const std::filesystem::path& rPath )
+	{
+		if( rPath.empty() || !m_Cache )
+			return;
+
+		MergeThreadCaches();
+
+		VkDevice Device = VulkanContext::Get().GetDevice();
+
+		size_t DataSize = 0;
+		VK_CHECK( vkGetPipelineCacheData( Device, m_Cache, &DataSize, nullptr ) );
+
+		std::vector<uint8_t> Data( DataSize );
+		VK_CHECK( vkGetPipelineCacheData( Device, m_Cache, &DataSize, Data.data() ) );
+
+		PipelineCacheFileHeader Header;
+		Header.VendorID = m_DeviceProperties.vendorID;
+		Header.DeviceID = m_DeviceProperties.deviceID;
+		Header.DriverVersion = m_DeviceProperties.driverVersion;
+		memcpy( Header.PipelineCacheUUID, m_DeviceProperties.pipelineCacheUUID, VK_UUID_SIZE );
+		Header.DataSize = DataSize;
+		Header.DataHash = HashCacheData( Data.data(), DataSize );
+
+		std::filesystem::create_directories( rPath.parent_path() );
+
+		// Write next to the real file first so a crash while saving never leaves a half written cache behind.
+		std::filesystem::path TempPath = rPath;
+		TempPath += ".tmp";
+
+		{
+			std::ofstream Stream( TempPath, std::ios::binary | std::ios::trunc );
+
+			if( !Stream )
+			{
+				SAT_CORE_WARN( "Failed to save pipeline cache to '{0}'", rPath.string() );
+				return;
+			}
+
+			Stream.write( reinterpret_cast< const char* >( &Header ), sizeof( Header ) );
+			Stream.write( reinterpret_cast< const char* >( Data.data() ), DataSize );
+		}
+
+		std::error_code Error;
+		std::filesystem::rename( TempPath, rPath, Error );
+
+		if( Error )
+			SAT_CORE_WARN( "Failed to save pipeline cache to '{0}': {1}", rPath.string(), Error.message() );
+	}
+
+	std::filesystem::path PipelineCache::GetEngineCachePath()
+	{
+		return Application::Get().GetAppDataFolder() / "PipelineCache.bin";
+	}
+
+	std::filesystem::path PipelineCache::GetProjectCachePath()
+	{
+		if( const auto& rProject = Project::GetActiveProject() )
+			return rProject->GetFullCachePath() / "PipelineCache.bin";
+
+		return {};
+	}
+}
@@ -0,0 +1,75 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#pragma once
+
+#include <vulkan.h>
+
+#include <filesystem>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace Saturn {
+
+	// Keeps the driver's compiled pipelines between launches.
+	// Each thread that creates pipelines gets its own VkPipelineCache so they never contend, the thread caches are merged into the main cache when it is saved.
+	// Files are tagged with the device and driver that wrote them and anything that does not match is ignored, the driver would reject it anyway.
+	class PipelineCache
+	{
+	public:
+		PipelineCache();
+		~PipelineCache();
+
+		// Cache that pipelines created on the calling thread should use.
+		VkPipelineCache GetThreadCache();
+
+		// Adds the pipelines from a cache file into the main cache, returns false if the file was missing or written by a different device or driver.
+		bool Merge( const std::filesystem::path& rPath );
+		void Save( const std::filesystem::path& rPath );
+
+		void Terminate();
+
+		static std::filesystem::path GetEngineCachePath();
+		static std::filesystem::path GetProjectCachePath();
+
+	private:
+		void MergeThreadCaches();
+		bool IsCompatible( const std::vector<uint8_t>& rData ) const;
+
+	private:
+		VkPipelineCache m_Cache = VK_NULL_HANDLE;
+
+		std::thread::id m_MainThread;
+		std::unordered_map<std::thread::id, VkPipelineCache> m_ThreadCaches;
+		std::mutex m_Mutex;
+
+		VkPhysicalDeviceProperties m_DeviceProperties = {};
+	};
+}
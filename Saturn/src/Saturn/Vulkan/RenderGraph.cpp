@@ -0,0 +1,755 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#include "sppch.h"
+#include "RenderGraph.h"
+
+#include "VulkanContext.h"
+#include "VulkanDebug.h"
+#include "VulkanImageAux.h"
+#include "Image2D.h"
+#include "Texture.h"
+#include "GPUProfiler.h"
+
+#include "Saturn/Core/OptickProfiler.h"
+
+#include <imgui.h>
+
+#include <algorithm>
+#include <sstream>
+
+namespace Saturn {
+
+	static constexpr VkAccessFlags s_WriteAccess = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+
+	struct RenderGraphUsageInfo
+	{
+		VkPipelineStageFlags Stages = 0;
+		VkAccessFlags Access = 0;
+		// Undefined means the image's resting layout.
+		VkImageLayout Layout = VK_IMAGE_LAYOUT_UNDEFINED;
+	};
+
+	static RenderGraphUsageInfo GetUsageInfo( RenderGraphUsage Usage, bool Write )
+	{
+		switch( Usage )
+		{
+			case RenderGraphUsage::ColorAttachment:
+				return { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | ( Write ? VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT : 0u ) };
+
+			case RenderGraphUsage::DepthAttachment:
+				return { VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | ( Write ? VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT : 0u ) };
+
+			case RenderGraphUsage::FragmentSampled:
+				return { VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT };
+
+			case RenderGraphUsage::ComputeSampled:
+				return { VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT };
+
+			case RenderGraphUsage::ComputeStorage:
+				return { VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | ( Write ? VK_ACCESS_SHADER_WRITE_BIT : 0u ), VK_IMAGE_LAYOUT_GENERAL };
+
+			case RenderGraphUsage::TransferSrc:
+				return { VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL };
+
+			case RenderGraphUsage::TransferDst:
+				return { VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL };
+		}
+
+		return {};
+	}
+
+	static const char* UsageToString( RenderGraphUsage Usage )
+	{
+		switch( Usage )
+		{
+			case RenderGraphUsage::ColorAttachment: return "Color attachment";
+			case RenderGraphUsage::DepthAttachment: return "Depth attachment";
+			case RenderGraphUsage::FragmentSampled: return "Fragment sampled";
+			case RenderGraphUsage::ComputeSampled:  return "Compute sampled";
+			case RenderGraphUsage::ComputeStorage:  return "Compute storage";
+			case RenderGraphUsage::TransferSrc:     return "Transfer source";
+			case RenderGraphUsage::TransferDst:     return "Transfer destination";
+		}
+
+		return "Unknown";
+	}
+
+	static VkImageAspectFlags GetFormatAspect( VkFormat Format )
+	{
+		switch( Format )
+		{
+			case VK_FORMAT_D16_UNORM:
+			case VK_FORMAT_D32_SFLOAT:
+				return VK_IMAGE_ASPECT_DEPTH_BIT;
+
+			case VK_FORMAT_D16_UNORM_S8_UINT:
+			case VK_FORMAT_D24_UNORM_S8_UINT:
+			case VK_FORMAT_D32_SFLOAT_S8_UINT:
+				return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+		}
+
+		return VK_IMAGE_ASPECT_COLOR_BIT;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Builder
+	//////////////////////////////////////////////////////////////////////////
+
+	RenderGraphResource RenderGraphBuilder::CreateImage( const std::string& rName, const RenderGraphImageDesc& rDesc )
+	{
+		auto& rImage = m_pGraph->m_Images.emplace_back();
+		rImage.Name = rName;
+		rImage.Desc = rDesc;
+		rImage.Aspect = GetFormatAspect( rDesc.Format );
+
+		// Storage images stay in general, the other images rest in the layout they are sampled in.
+		if( rDesc.Usage & VK_IMAGE_USAGE_STORAGE_BIT )
+			rImage.RestingLayout = VK_IMAGE_LAYOUT_GENERAL;
+		else if( rImage.Aspect & VK_IMAGE_ASPECT_DEPTH_BIT )
+			rImage.RestingLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+		else
+			rImage.RestingLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+		return ( RenderGraphResource ) m_pGraph->m_Images.size() - 1;
+	}
+
+	void RenderGraphBuilder::Read( RenderGraphResource Resource, RenderGraphUsage Usage )
+	{
+		auto& rAccesses = m_pGraph->m_Passes[ m_PassIndex ].Accesses;
+
+		for( const auto& rAccess : rAccesses )
+		{
+			if( rAccess.Resource == Resource && rAccess.Usage == Usage )
+				return;
+		}
+
+		rAccesses.push_back( { Resource, Usage, false } );
+	}
+
+	void RenderGraphBuilder::Write( RenderGraphResource Resource, RenderGraphUsage Usage )
+	{
+		auto& rAccesses = m_pGraph->m_Passes[ m_PassIndex ].Accesses;
+
+		// A read and a write with the same usage (i.e. a loaded attachment) is one access.
+		for( auto& rAccess : rAccesses )
+		{
+			if( rAccess.Resource == Resource && rAccess.Usage == Usage )
+			{
+				rAccess.Write = true;
+				return;
+			}
+		}
+
+		rAccesses.push_back( { Resource, Usage, true } );
+	}
+
+	void RenderGraphBuilder::SetSideEffect()
+	{
+		m_pGraph->m_Passes[ m_PassIndex ].SideEffect = true;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Graph
+	//////////////////////////////////////////////////////////////////////////
+
+	RenderGraph::~RenderGraph()
+	{
+		Reset();
+	}
+
+	void RenderGraph::Reset()
+	{
+		DestroyTransients();
+
+		m_Passes.clear();
+		m_Images.clear();
+
+		m_Compiled = false;
+	}
+
+	RenderGraphResource RenderGraph::ImportImage( const std::string& rName, VkImage Image, VkImageAspectFlags Aspect, VkImageLayout RestingLayout )
+	{
+		auto& rImage = m_Images.emplace_back();
+		rImage.Name = rName;
+		rImage.Image = Image;
+		rImage.Aspect = Aspect;
+		rImage.RestingLayout = RestingLayout;
+		rImage.Imported = true;
+
+		return ( RenderGraphResource ) m_Images.size() - 1;
+	}
+
+	RenderGraphResource RenderGraph::ImportImage( const std::string& rName, Ref<Image2D>& rImage )
+	{
+		return ImportImage( rName, rImage->GetImage(), GetFormatAspect( VulkanFormat( rImage->GetImageFormat() ) ), rImage->GetDescriptorInfo().imageLayout );
+	}
+
+	RenderGraphResource RenderGraph::ImportImage( const std::string& rName, Ref<Texture2D>& rTexture )
+	{
+		// Textures are never depth images.
+		return ImportImage( rName, rTexture->GetImage(), VK_IMAGE_ASPECT_COLOR_BIT, rTexture->GetDescriptorInfo().imageLayout );
+	}
+
+	void RenderGraph::MarkOutput( RenderGraphResource Resource )
+	{
+		m_Images[ Resource ].Output = true;
+	}
+
+	void RenderGraph::AddPass( const std::string& rName, const SetupFunc& rSetup, ExecuteFunc&& rrExecute, ConditionFunc&& rrCondition )
+	{
+		SAT_CORE_ASSERT( !m_Compiled, "Passes can't be added to a compiled render graph, call Reset first!" );
+
+		auto& rPass = m_Passes.emplace_back();
+		rPass.Name = rName;
+		rPass.Execute = std::move( rrExecute );
+		rPass.Condition = std::move( rrCondition );
+
+		RenderGraphBuilder Builder( this, ( uint32_t ) m_Passes.size() - 1 );
+		rSetup( Builder );
+	}
+
+	void RenderGraph::Compile()
+	{
+		SAT_PF_EVENT();
+
+		DestroyTransients();
+
+		CullPasses();
+		ComputeLifetimes();
+		AllocateTransients();
+
+		m_Compiled = true;
+
+		const size_t CulledPasses = std::count_if( m_Passes.begin(), m_Passes.end(), []( const RenderGraphPass& rPass ) { return rPass.Culled; } );
+
+		SAT_CORE_INFO( "Render graph compiled: {0} passes ({1} culled), transient images use {2} KB ({3} KB without aliasing)", m_Passes.size(), CulledPasses, m_AliasedMemory / 1024, m_TransientMemory / 1024 );
+	}
+
+	void RenderGraph::CullPasses()
+	{
+		// Walk the passes backwards, a pass is needed when it has side effects or writes something a later needed pass reads.
+		std::vector<bool> Needed( m_Images.size() );
+
+		for( size_t i = 0; i < m_Images.size(); i++ )
+			Needed[ i ] = m_Images[ i ].Output;
+
+		for( auto it = m_Passes.rbegin(); it != m_Passes.rend(); ++it )
+		{
+			auto& rPass = *it;
+
+			bool Keep = rPass.SideEffect;
+
+			for( const auto& rAccess : rPass.Accesses )
+			{
+				if( rAccess.Write && Needed[ rAccess.Resource ] )
+					Keep = true;
+			}
+
+			rPass.Culled = !Keep;
+
+			if( !Keep )
+				continue;
+
+			for( const auto& rAccess : rPass.Accesses )
+			{
+				// Attachments that are loaded are read as well.
+				const bool Loads = rAccess.Write && ( rAccess.Usage == RenderGraphUsage::ColorAttachment || rAccess.Usage == RenderGraphUsage::DepthAttachment );
+
+				if( !rAccess.Write || Loads )
+					Needed[ rAccess.Resource ] = true;
+			}
+		}
+	}
+
+	void RenderGraph::ComputeLifetimes()
+	{
+		for( auto& rImage : m_Images )
+		{
+			rImage.FirstPass = ~0u;
+			rImage.LastPass = 0;
+		}
+
+		for( uint32_t i = 0; i < ( uint32_t ) m_Passes.size(); i++ )
+		{
+			if( m_Passes[ i ].Culled )
+				continue;
+
+			for( const auto& rAccess : m_Passes[ i ].Accesses )
+			{
+				auto& rImage = m_Images[ rAccess.Resource ];
+
+				rImage.FirstPass = std::min( rImage.FirstPass, i );
+				rImage.LastPass = std::max( rImage.LastPass, i );
+			}
+		}
+	}
+
+	void RenderGraph::AllocateTransients()
+	{
+		VkDevice Device = VulkanContext::Get().GetDevice();
+
+		std::vector<RenderGraphResource> Transients;
+
+		for( RenderGraphResource i = 0; i < ( RenderGraphResource ) m_Images.size(); i++ )
+		{
+			auto& rImage = m_Images[ i ];
+
+			// Not imported and used by at least one pass that was not culled.
+			if( rImage.Imported || rImage.FirstPass == ~0u )
+				continue;
+
+			VkImageCreateInfo ImageCreateInfo = { VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO };
+			ImageCreateInfo.imageType = VK_IMAGE_TYPE_2D;
+			ImageCreateInfo.format = rImage.Desc.Format;
+			ImageCreateInfo.extent = { rImage.Desc.Width, rImage.Desc.Height, 1 };
+			ImageCreateInfo.mipLevels = rImage.Desc.MipLevels;
+			ImageCreateInfo.arrayLayers = 1;
+			ImageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+			ImageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+			ImageCreateInfo.usage = rImage.Desc.Usage;
+			ImageCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+			ImageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+			VK_CHECK( vkCreateImage( Device, &ImageCreateInfo, nullptr, &rImage.Image ) );
+			SetDebugUtilsObjectName( rImage.Name, ( uint64_t ) rImage.Image, VK_OBJECT_TYPE_IMAGE );
+
+			vkGetImageMemoryRequirements( Device, rImage.Image, &rImage.MemoryRequirements );
+
+			m_TransientMemory += rImage.MemoryRequirements.size;
+
+			Transients.push_back( i );
+		}
+
+		// Place the largest images first so the smaller ones fit in the blocks that already exist.
+		std::sort( Transients.begin(), Transients.end(), [&]( RenderGraphResource a, RenderGraphResource b )
+			{
+				return m_Images[ a ].MemoryRequirements.size > m_Images[ b ].MemoryRequirements.size;
+			} );
+
+		for( RenderGraphResource Resource : Transients )
+		{
+			auto& rImage = m_Images[ Resource ];
+
+			uint32_t BlockIndex = ~0u;
+
+			for( uint32_t i = 0; i < ( uint32_t ) m_MemoryBlocks.size() && BlockIndex == ~0u; i++ )
+			{
+				const auto& rBlock = m_MemoryBlocks[ i ];
+
+				if( ( rBlock.Requirements.memoryTypeBits & rImage.MemoryRequirements.memoryTypeBits ) == 0 )
+					continue;
+
+				const bool Overlaps = std::any_of( rBlock.Images.begin(), rBlock.Images.end(), [&]( RenderGraphResource Other )
+					{
+						const auto& rOther = m_Images[ Other ];
+						return rImage.FirstPass <= rOther.LastPass && rOther.FirstPass <= rImage.LastPass;
+					} );
+
+				if( !Overlaps )
+					BlockIndex = i;
+			}
+
+			if( BlockIndex == ~0u )
+			{
+				BlockIndex = ( uint32_t ) m_MemoryBlocks.size();
+				m_MemoryBlocks.emplace_back().Requirements.memoryTypeBits = ~0u;
+			}
+
+			// Every image is bound at the start of the block, so the block only has to be as large and as aligned as its largest image.
+			auto& rBlock = m_MemoryBlocks[ BlockIndex ];
+			rBlock.Requirements.size = std::max( rBlock.Requirements.size, rImage.MemoryRequirements.size );
+			rBlock.Requirements.alignment = std::max( rBlock.Requirements.alignment, rImage.MemoryRequirements.alignment );
+			rBlock.Requirements.memoryTypeBits &= rImage.MemoryRequirements.memoryTypeBits;
+			rBlock.Images.push_back( Resource );
+
+			rImage.MemoryBlock = BlockIndex;
+		}
+
+		auto pAllocator = VulkanContext::Get().GetVulkanAllocator();
+
+		for( auto& rBlock : m_MemoryBlocks )
+		{
+			rBlock.Allocation = pAllocator->AllocateMemory( rBlock.Requirements, VMA_MEMORY_USAGE_GPU_ONLY );
+
+			m_AliasedMemory += rBlock.Requirements.size;
+		}
+
+		for( RenderGraphResource Resource : Transients )
+		{
+			auto& rImage = m_Images[ Resource ];
+
+			pAllocator->BindImageMemory( m_MemoryBlocks[ rImage.MemoryBlock ].Allocation, rImage.Image );
+
+			VkImageViewCreateInfo ImageViewCreateInfo = { VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO };
+			ImageViewCreateInfo.image = rImage.Image;
+			ImageViewCreateInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+			ImageViewCreateInfo.format = rImage.Desc.Format;
+			// Views can only have the depth aspect.
+			ImageViewCreateInfo.subresourceRange = { rImage.Aspect & ~VK_IMAGE_ASPECT_STENCIL_BIT, 0, rImage.Desc.MipLevels, 0, 1 };
+
+			VK_CHECK( vkCreateImageView( Device, &ImageViewCreateInfo, nullptr, &rImage.ImageView ) );
+			SetDebugUtilsObjectName( rImage.Name, ( uint64_t ) rImage.ImageView, VK_OBJECT_TYPE_IMAGE_VIEW );
+
+			rImage.MipImageViews.resize( rImage.Desc.MipLevels );
+
+			for( uint32_t Mip = 0; Mip < rImage.Desc.MipLevels; Mip++ )
+			{
+				ImageViewCreateInfo.subresourceRange.baseMipLevel = Mip;
+				ImageViewCreateInfo.subresourceRange.levelCount = 1;
+
+				VK_CHECK( vkCreateImageView( Device, &ImageViewCreateInfo, nullptr, &rImage.MipImageViews[ Mip ] ) );
+			}
+
+			VkSamplerCreateInfo SamplerCreateInfo = { VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO };
+			SamplerCreateInfo.maxAnisotropy = 1.0f;
+			SamplerCreateInfo.magFilter = VK_FILTER_LINEAR;
+			SamplerCreateInfo.minFilter = VK_FILTER_LINEAR;
+			SamplerCreateInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+			SamplerCreateInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+			SamplerCreateInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+			SamplerCreateInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+			SamplerCreateInfo.compareOp = VK_COMPARE_OP_NEVER;
+			SamplerCreateInfo.minLod = 0.0f;
+			SamplerCreateInfo.maxLod = ( float ) rImage.Desc.MipLevels;
+			SamplerCreateInfo.borderColor = VK_BORDER_COLOR_FLOAT_OPAQUE_WHITE;
+
+			VK_CHECK( vkCreateSampler( Device, &SamplerCreateInfo, nullptr, &rImage.Sampler ) );
+		}
+	}
+
+	void RenderGraph::DestroyTransients()
+	{
+		VkDevice Device = VulkanContext::Get().GetDevice();
+
+		for( auto& rImage : m_Images )
+		{
+			if( rImage.Imported )
+				continue;
+
+			for( VkImageView View : rImage.MipImageViews )
+				vkDestroyImageView( Device, View, nullptr );
+
+			if( rImage.ImageView )
+				vkDestroyImageView( Device, rImage.ImageView, nullptr );
+
+			if( rImage.Sampler )
+				vkDestroySampler( Device, rImage.Sampler, nullptr );
+
+			if( rImage.Image )
+				vkDestroyImage( Device, rImage.Image, nullptr );
+
+			rImage.MipImageViews.clear();
+			rImage.ImageView = nullptr;
+			rImage.Sampler = nullptr;
+			rImage.Image = nullptr;
+			rImage.MemoryBlock = ~0u;
+		}
+
+		for( auto& rBlock : m_MemoryBlocks )
+			VulkanContext::Get().GetVulkanAllocator()->FreeMemory( rBlock.Allocation );
+
+		m_MemoryBlocks.clear();
+
+		m_TransientMemory = 0;
+		m_AliasedMemory = 0;
+	}
+
+	void RenderGraph::AddBarrier( RenderGraphImage& rImage, RenderGraphUsage Usage, bool Write, std::vector<VkImageMemoryBarrier>& rBarriers, VkPipelineStageFlags& rSrcStages, VkPipelineStageFlags& rDstStages )
+	{
+		const RenderGraphUsageInfo Info = GetUsageInfo( Usage, Write );
+		const VkImageLayout Layout = Info.Layout == VK_IMAGE_LAYOUT_UNDEFINED ? rImage.RestingLayout : Info.Layout;
+
+		ResourceState& rState = rImage.State;
+		MemoryBlock* pBlock = rImage.Imported ? nullptr : &m_MemoryBlocks[ rImage.MemoryBlock ];
+
+		// Reads after reads don't need a barrier as long as the layout stays the same.
+		const bool LayoutChange = rState.Layout != Layout;
+		const bool Hazard = rState.Written || ( Write && rState.Stages );
+
+		if( !LayoutChange && !Hazard )
+		{
+			rState.Stages |= Info.Stages;
+			rState.Access |= Info.Access;
+		}
+		else
+		{
+			VkPipelineStageFlags SrcStages = rState.Stages;
+			VkAccessFlags SrcAccess = rState.Written ? ( rState.Access & s_WriteAccess ) : 0;
+
+			// First use of a transient image this frame, wait for the last image that used the memory.
+			if( pBlock && rState.Stages == 0 )
+			{
+				SrcStages = pBlock->Stages;
+				SrcAccess = pBlock->Access;
+			}
+
+			VkImageMemoryBarrier Barrier = { VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
+			Barrier.srcAccessMask = SrcAccess;
+			Barrier.dstAccessMask = Info.Access;
+			Barrier.oldLayout = rState.Layout;
+			Barrier.newLayout = Layout;
+			Barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			Barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			Barrier.image = rImage.Image;
+			Barrier.subresourceRange = { rImage.Aspect, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS };
+
+			rBarriers.push_back( Barrier );
+
+			rSrcStages |= SrcStages ? SrcStages : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+			rDstStages |= Info.Stages;
+
+			rState.Layout = Layout;
+			rState.Stages = Info.Stages;
+			rState.Access = Info.Access;
+		}
+
+		rState.Written = Write;
+
+		if( pBlock )
+		{
+			pBlock->Stages = rState.Stages;
+			pBlock->Access = rState.Access & s_WriteAccess;
+		}
+	}
+
+	void RenderGraph::Execute( VkCommandBuffer CommandBuffer, GPUProfiler* pProfiler )
+	{
+		SAT_PF_EVENT();
+
+		SAT_CORE_ASSERT( m_Compiled, "Render graph must be compiled before it can be executed!" );
+
+		// Imported images start in their resting layout, the contents of transient images are discarded every frame.
+		for( auto& rImage : m_Images )
+			rImage.State = { rImage.Imported ? rImage.RestingLayout : VK_IMAGE_LAYOUT_UNDEFINED };
+
+		std::vector<VkImageMemoryBarrier> Barriers;
+
+		for( auto& rPass : m_Passes )
+		{
+			if( rPass.Culled || ( rPass.Condition && !rPass.Condition() ) )
+				continue;
+
+			Barriers.clear();
+
+			VkPipelineStageFlags SrcStages = 0;
+			VkPipelineStageFlags DstStages = 0;
+
+			for( const auto& rAccess : rPass.Accesses )
+				AddBarrier( m_Images[ rAccess.Resource ], rAccess.Usage, rAccess.Write, Barriers, SrcStages, DstStages );
+
+			if( !Barriers.empty() )
+				vkCmdPipelineBarrier( CommandBuffer, SrcStages, DstStages, 0, 0, nullptr, 0, nullptr, ( uint32_t ) Barriers.size(), Barriers.data() );
+
+			CmdBeginDebugLabel( CommandBuffer, rPass.Name );
+
+			if( pProfiler )
+				pProfiler->BeginScope( CommandBuffer, rPass.Name.c_str() );
+
+			rPass.Execute( CommandBuffer );
+
+			if( pProfiler )
+				pProfiler->EndScope( CommandBuffer );
+
+			CmdEndDebugLabel( CommandBuffer );
+		}
+
+		// Put the imported images back in the layout everything outside of the graph expects.
+		Barriers.clear();
+
+		VkPipelineStageFlags SrcStages = 0;
+
+		for( auto& rImage : m_Images )
+		{
+			if( !rImage.Imported || rImage.State.Layout == rImage.RestingLayout )
+				continue;
+
+			VkImageMemoryBarrier Barrier = { VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
+			Barrier.srcAccessMask = rImage.State.Written ? ( rImage.State.Access & s_WriteAccess ) : 0;
+			Barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+			Barrier.oldLayout = rImage.State.Layout;
+			Barrier.newLayout = rImage.RestingLayout;
+			Barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			Barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			Barrier.image = rImage.Image;
+			Barrier.subresourceRange = { rImage.Aspect, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS };
+
+			Barriers.push_back( Barrier );
+			SrcStages |= rImage.State.Stages;
+		}
+
+		if( !Barriers.empty() )
+			vkCmdPipelineBarrier( CommandBuffer, SrcStages, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, ( uint32_t ) Barriers.size(), Barriers.data() );
+	}
+
+	VkImage RenderGraph::GetImage( RenderGraphResource Resource ) const
+	{
+		return m_Images[ Resource ].Image;
+	}
+
+	VkImageView RenderGraph::GetImageView( RenderGraphResource Resource ) const
+	{
+		return m_Images[ Resource ].ImageView;
+	}
+
+	VkImageView RenderGraph::GetMipImageView( RenderGraphResource Resource, uint32_t Mip ) const
+	{
+		return m_Images[ Resource ].MipImageViews[ Mip ];
+	}
+
+	VkDescriptorImageInfo RenderGraph::GetDescriptorInfo( RenderGraphResource Resource ) const
+	{
+		const auto& rImage = m_Images[ Resource ];
+
+		return { rImage.Sampler, rImage.ImageView, rImage.RestingLayout };
+	}
+
+	const RenderGraphImageDesc& RenderGraph::GetImageDesc( RenderGraphResource Resource ) const
+	{
+		return m_Images[ Resource ].Desc;
+	}
+
+	std::pair<uint32_t, uint32_t> RenderGraph::GetMipSize( RenderGraphResource Resource, uint32_t Mip ) const
+	{
+		const auto& rDesc = m_Images[ Resource ].Desc;
+
+		return { std::max( rDesc.Width >> Mip, 1u ), std::max( rDesc.Height >> Mip, 1u ) };
+	}
+
+	bool RenderGraph::IsPassCulled( const std::string& rName ) const
+	{
+		for( const auto& rPass : m_Passes )
+		{
+			if( rPass.Name == rName )
+				return rPass.Culled;
+		}
+
+		return true;
+	}
+
+	std::string RenderGraph::ToGraphviz() const
+	{
+		std::stringstream Stream;
+
+		Stream << "digraph RenderGraph {\n";
+		Stream << "\trankdir=LR;\n";
+
+		for( size_t i = 0; i < m_Images.size(); i++ )
+		{
+			const auto& rImage = m_Images[ i ];
+
+			Stream << "\timage" << i << " [shape=ellipse, label=\"" << rImage.Name << "\"";
+
+			if( !rImage.Imported )
+				Stream << ", style=dashed";
+
+			if( rImage.Output )
+				Stream << ", peripheries=2";
+
+			Stream << "];\n";
+		}
+
+		for( size_t i = 0; i < m_Passes.size(); i++ )
+		{
+			const auto& rPass = m_Passes[ i ];
+
+			Stream << "\tpass" << i << " [shape=box, label=\"" << rPass.Name << "\"";
+
+			if( rPass.Culled )
+				Stream << ", style=dotted, fontcolor=gray";
+
+			Stream << "];\n";
+
+			for( const auto& rAccess : rPass.Accesses )
+			{
+				const char* pUsage = UsageToString( rAccess.Usage );
+
+				if( rAccess.Write )
+					Stream << "\tpass" << i << " -> image" << rAccess.Resource << " [label=\"" << pUsage << "\", color=red];\n";
+				else
+					Stream << "\timage" << rAccess.Resource << " -> pass" << i << " [label=\"" << pUsage << "\"];\n";
+			}
+		}
+
+		Stream << "}\n";
+
+		return Stream.str();
+	}
+
+	bool RenderGraph::ExportGraphviz( const std::filesystem::path& rPath ) const
+	{
+		std::ofstream Stream( rPath, std::ios::trunc );
+
+		if( !Stream )
+		{
+			SAT_CORE_WARN( "Failed to open {0} to export the render graph!", rPath.string() );
+			return false;
+		}
+
+		Stream << ToGraphviz();
+
+		SAT_CORE_INFO( "Exported render graph to {0}", rPath.string() );
+
+		return true;
+	}
+
+	void RenderGraph::ImGuiRender()
+	{
+		ImGui::Text( "Transient images: %.2f MB (%.2f MB without aliasing)", m_AliasedMemory / ( 1024.0f * 1024.0f ), m_TransientMemory / ( 1024.0f * 1024.0f ) );
+
+		for( size_t i = 0; i < m_Passes.size(); i++ )
+		{
+			const auto& rPass = m_Passes[ i ];
+
+			if( rPass.Culled )
+				ImGui::PushStyleColor( ImGuiCol_Text, ImGui::GetStyleColorVec4( ImGuiCol_TextDisabled ) );
+
+			const bool Open = ImGui::TreeNode( ( void* ) i, "%s%s", rPass.Name.c_str(), rPass.Culled ? " (culled)" : "" );
+
+			if( rPass.Culled )
+				ImGui::PopStyleColor();
+
+			if( !Open )
+				continue;
+
+			for( const auto& rAccess : rPass.Accesses )
+			{
+				const auto& rImage = m_Images[ rAccess.Resource ];
+
+				ImGui::BulletText( "%s %s (%s)%s", rAccess.Write ? "Writes" : "Reads", rImage.Name.c_str(), UsageToString( rAccess.Usage ), rImage.Imported ? "" : " [transient]" );
+			}
+
+			ImGui::TreePop();
+		}
+
+		if( ImGui::Button( "Export Graphviz" ) )
+		{
+			ExportGraphviz( "RenderGraph.dot" );
+		}
+	}
+}
@@ -0,0 +1,240 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#pragma once
+
+#include "Base.h"
+
+#include "VulkanAllocator.h"
+
+#include <vulkan.h>
+
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace Saturn {
+
+	class Image2D;
+	class Texture2D;
+	class GPUProfiler;
+
+	using RenderGraphResource = uint32_t;
+	constexpr RenderGraphResource InvalidRenderGraphResource = ~0u;
+
+	// How a pass uses an image, the graph derives the layouts, stages and access masks from this.
+	// Attachment layouts are handled by the render pass, every render pass in the engine starts and ends in the image's resting layout.
+	enum class RenderGraphUsage
+	{
+		ColorAttachment,
+		DepthAttachment,
+		FragmentSampled,
+		ComputeSampled,
+		ComputeStorage,
+		TransferSrc,
+		TransferDst
+	};
+
+	// Images that only live for part of the frame, they are created by the graph and can share memory with other transient images.
+	struct RenderGraphImageDesc
+	{
+		VkFormat Format = VK_FORMAT_UNDEFINED;
+		uint32_t Width = 0;
+		uint32_t Height = 0;
+		uint32_t MipLevels = 1;
+		VkImageUsageFlags Usage = VK_IMAGE_USAGE_SAMPLED_BIT;
+	};
+
+	class RenderGraph;
+
+	// Passed to a pass's setup function to declare what the pass reads and writes.
+	class RenderGraphBuilder
+	{
+	public:
+		RenderGraphResource CreateImage( const std::string& rName, const RenderGraphImageDesc& rDesc );
+
+		void Read( RenderGraphResource Resource, RenderGraphUsage Usage );
+		void Write( RenderGraphResource Resource, RenderGraphUsage Usage );
+
+		// The pass is never culled, for passes that write to something the graph does not know about (i.e. buffers or the swapchain).
+		void SetSideEffect();
+
+	private:
+		RenderGraphBuilder( RenderGraph* pGraph, uint32_t PassIndex ) : m_pGraph( pGraph ), m_PassIndex( PassIndex ) {}
+
+	private:
+		RenderGraph* m_pGraph = nullptr;
+		uint32_t m_PassIndex = 0;
+
+		friend class RenderGraph;
+	};
+
+	// Runs passes in the order they were added.
+	// Passes declare the images they read and write, the graph then:
+	// * Culls passes whose writes are never read and that do not write an output or have side effects.
+	// * Records the image barriers between passes, the state of every image is tracked while executing so passes that are skipped at runtime are handled.
+	// * Places transient images that are never alive at the same time in the same memory.
+	// Compile must be called again whenever the passes or the imported images change (i.e. after a resize).
+	class RenderGraph : public RefTarget
+	{
+	public:
+		using SetupFunc = std::function<void( RenderGraphBuilder& )>;
+		using ExecuteFunc = std::function<void( VkCommandBuffer )>;
+		// Checked every frame, the pass is skipped when it returns false.
+		using ConditionFunc = std::function<bool()>;
+
+	public:
+		RenderGraph() = default;
+		~RenderGraph();
+
+		// Removes every pass and resource and destroys the transient images.
+		void Reset();
+
+		// RestingLayout is the layout the image is in between passes, the graph puts the image back in this layout at the end of the frame.
+		RenderGraphResource ImportImage( const std::string& rName, VkImage Image, VkImageAspectFlags Aspect, VkImageLayout RestingLayout );
+		RenderGraphResource ImportImage( const std::string& rName, Ref<Image2D>& rImage );
+		RenderGraphResource ImportImage( const std::string& rName, Ref<Texture2D>& rTexture );
+
+		// Outputs are read outside of the graph (i.e. by the editor viewport), passes writing to them are never culled.
+		void MarkOutput( RenderGraphResource Resource );
+
+		void AddPass( const std::string& rName, const SetupFunc& rSetup, ExecuteFunc&& rrExecute, ConditionFunc&& rrCondition = nullptr );
+
+		void Compile();
+		void Execute( VkCommandBuffer CommandBuffer, GPUProfiler* pProfiler = nullptr );
+
+		// Only valid for transient images after Compile.
+		VkImage GetImage( RenderGraphResource Resource ) const;
+		VkImageView GetImageView( RenderGraphResource Resource ) const;
+		VkImageView GetMipImageView( RenderGraphResource Resource, uint32_t Mip ) const;
+		VkDescriptorImageInfo GetDescriptorInfo( RenderGraphResource Resource ) const;
+		const RenderGraphImageDesc& GetImageDesc( RenderGraphResource Resource ) const;
+		std::pair<uint32_t, uint32_t> GetMipSize( RenderGraphResource Resource, uint32_t Mip ) const;
+
+		bool IsPassCulled( const std::string& rName ) const;
+
+		// Memory the transient images would need on their own and the memory they use with aliasing.
+		VkDeviceSize GetTransientMemory() const { return m_TransientMemory; }
+		VkDeviceSize GetAliasedMemory() const { return m_AliasedMemory; }
+
+		// Graphviz dot source of the graph, passes are boxes and images are ellipses.
+		std::string ToGraphviz() const;
+		bool ExportGraphviz( const std::filesystem::path& rPath ) const;
+
+		void ImGuiRender();
+
+	private:
+		struct ResourceAccess
+		{
+			RenderGraphResource Resource = InvalidRenderGraphResource;
+			RenderGraphUsage Usage = RenderGraphUsage::FragmentSampled;
+			bool Write = false;
+		};
+
+		struct RenderGraphPass
+		{
+			std::string Name;
+			std::vector<ResourceAccess> Accesses;
+
+			ExecuteFunc Execute;
+			ConditionFunc Condition;
+
+			bool SideEffect = false;
+			bool Culled = false;
+		};
+
+		// Where the image is between passes while executing.
+		struct ResourceState
+		{
+			VkImageLayout Layout = VK_IMAGE_LAYOUT_UNDEFINED;
+			VkPipelineStageFlags Stages = 0;
+			VkAccessFlags Access = 0;
+			bool Written = false;
+		};
+
+		struct RenderGraphImage
+		{
+			std::string Name;
+
+			VkImage Image = nullptr;
+			VkImageAspectFlags Aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+			VkImageLayout RestingLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+			bool Imported = false;
+			bool Output = false;
+
+			// Transient only.
+			RenderGraphImageDesc Desc;
+			VkImageView ImageView = nullptr;
+			std::vector<VkImageView> MipImageViews;
+			VkSampler Sampler = nullptr;
+			VkMemoryRequirements MemoryRequirements = {};
+			uint32_t MemoryBlock = ~0u;
+
+			// First and last pass that uses the image after culling.
+			uint32_t FirstPass = ~0u;
+			uint32_t LastPass = 0;
+
+			ResourceState State;
+		};
+
+		// Memory shared by transient images whose lifetimes don't overlap.
+		// Blocks come from VMA so they share its device memory blocks, the images are bound manually because VMA only aliases what the caller binds.
+		struct MemoryBlock
+		{
+			VmaAllocation Allocation = nullptr;
+			VkMemoryRequirements Requirements = {};
+
+			std::vector<RenderGraphResource> Images;
+
+			// Last use of any image in the block this frame, the next image has to wait for it before it can reuse the memory.
+			VkPipelineStageFlags Stages = 0;
+			VkAccessFlags Access = 0;
+		};
+
+		void CullPasses();
+		void ComputeLifetimes();
+		void AllocateTransients();
+		void DestroyTransients();
+
+		void AddBarrier( RenderGraphImage& rImage, RenderGraphUsage Usage, bool Write, std::vector<VkImageMemoryBarrier>& rBarriers, VkPipelineStageFlags& rSrcStages, VkPipelineStageFlags& rDstStages );
+
+	private:
+		std::vector<RenderGraphPass> m_Passes;
+		std::vector<RenderGraphImage> m_Images;
+		std::vector<MemoryBlock> m_MemoryBlocks;
+
+		VkDeviceSize m_TransientMemory = 0;
+		VkDeviceSize m_AliasedMemory = 0;
+
+		bool m_Compiled = false;
+
+		friend class RenderGraphBuilder;
+	};
+}
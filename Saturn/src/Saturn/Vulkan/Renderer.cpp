@@ -32,6 +32,10 @@
 #include "Saturn/Core/Renderer/RenderThread.h"
 
 #include "VulkanDebug.h"
+#include "UploadManager.h"
+#include "BindlessTable.h"
+#include "TextureStreamer.h"
+#include "UniformBufferRing.h"
 #include "DescriptorSet.h"
 #include "Shader.h"
 #include "Framebuffer.h"
@@ -106,6 +110,8 @@ namespace Saturn {
 		{
 			m_RendererDescriptorPools[i] = Ref<DescriptorPool>::Create( PoolSizes, 100000 );
 		}
+
+		m_SecondaryRecorder = Ref<SecondaryCommandRecorder>::Create();
 	}
 	
 	void Renderer::Terminate()
@@ -139,6 +145,8 @@ namespace Saturn {
 
 		m_ShaderReloadedCB.clear();
 
+		m_SecondaryRecorder = nullptr;
+
 		m_PinkTextureCube->Terminate();
 		m_PinkTextureCube = nullptr;
 
@@ -156,7 +164,12 @@ namespace Saturn {
 		Pipeline->Bind( CommandBuffer );
 		
 		if( rDescriptorSet )
-			rDescriptorSet->Bind( CommandBuffer, Pipeline->GetPipelineLayout() );
+		{
+			uint32_t DynamicOffsets[ Shader::MaxDynamicOffsets ];
+			uint32_t DynamicOffsetCount = Pipeline->GetShader()->GetDynamicOffsets( rDescriptorSet->GetSetIndex(), DynamicOffsets );
+
+			rDescriptorSet->Bind( CommandBuffer, Pipeline->GetPipelineLayout(), DynamicOffsetCount, DynamicOffsets );
+		}
 
 		VertexBuffer->Bind( CommandBuffer );
 		IndexBuffer->Bind( CommandBuffer );
@@ -173,7 +186,7 @@ namespace Saturn {
 		vkCmdEndRenderPass( CommandBuffer );
 	}
 	
-	void Renderer::RenderMeshWithoutMaterial( VkCommandBuffer CommandBuffer, Ref<Saturn::Pipeline> Pipeline, Ref<StaticMesh> mesh, uint32_t count, Ref<VertexBuffer> transformVB, uint32_t TransformOffset, uint32_t SubmeshIndex, Buffer additionalData )
+	void Renderer::RenderMeshWithoutMaterial( VkCommandBuffer CommandBuffer, Ref<Saturn::Pipeline> Pipeline, Ref<StaticMesh> mesh, uint32_t count, Ref<VertexBuffer> transformVB, uint32_t TransformOffset, uint32_t SubmeshIndex, uint32_t LodIndex, Buffer additionalData )
 	{	
 		SAT_PF_EVENT();
 
@@ -183,6 +196,7 @@ namespace Saturn {
 			PushConstant.Write( additionalData.Data, additionalData.Size, 0 );
 
 		auto& rSubmesh = mesh->Submeshes()[ SubmeshIndex ];
+		SubmeshLod Lod = rSubmesh.GetLod( LodIndex );
 		{ 
 			mesh->GetVertexBuffer()->Bind( CommandBuffer );
 
@@ -198,9 +212,12 @@ namespace Saturn {
 				vkCmdPushConstants( CommandBuffer, Pipeline->GetPipelineLayout(), VK_SHADER_STAGE_VERTEX_BIT, 0, ( uint32_t ) PushConstant.Size, PushConstant.Data );
 			}
 			
-			Pipeline->GetDescriptorSet( ShaderType::Vertex, 0 )->Bind( CommandBuffer, Pipeline->GetPipelineLayout() );
+			uint32_t DynamicOffsets[ Shader::MaxDynamicOffsets ];
+			uint32_t DynamicOffsetCount = Pipeline->GetShader()->GetDynamicOffsets( 0, DynamicOffsets );
+
+			Pipeline->GetDescriptorSet( ShaderType::Vertex, 0 )->Bind( CommandBuffer, Pipeline->GetPipelineLayout(), DynamicOffsetCount, DynamicOffsets );
 
-			vkCmdDrawIndexed( CommandBuffer, rSubmesh.IndexCount, count, rSubmesh.BaseIndex, rSubmesh.BaseVertex, 0 );
+			vkCmdDrawIndexed( CommandBuffer, Lod.IndexCount, count, Lod.BaseIndex, rSubmesh.BaseVertex, 0 );
 		}
 
 		PushConstant.Free();
@@ -215,11 +232,11 @@ namespace Saturn {
 	{
 	}
 	
-	const std::vector<VkWriteDescriptorSet>& Renderer::GetStorageBufferWriteDescriptors( Ref<StorageBufferSet>& rStorageBufferSet, Ref<MaterialAsset>& rMaterialAsset )
+	const std::vector<VkWriteDescriptorSet>& Renderer::GetStorageBufferWriteDescriptors( Ref<StorageBufferSet>& rStorageBufferSet, Ref<Shader>& rShader )
 	{
 		SAT_PF_EVENT();
 
-		Ref<Shader> shader = rMaterialAsset->GetMaterial()->GetShader();
+		Ref<Shader> shader = rShader;
 		std::string shaderName = shader->GetName();
 		
 		if( m_StorageBufferSets.find( m_FrameCount ) != m_StorageBufferSets.end() ) 
@@ -235,38 +252,74 @@ namespace Saturn {
 
 		// Does not exist, add and create.
 		auto& descriptorSet = shader->GetShaderDescriptorSet( 0 );
+		auto& wd = m_StorageBufferSets[ m_FrameCount ][ shaderName ];
 
-		for( auto&& [binding, sb] : descriptorSet.StorageBuffers )
+		// One write per storage buffer, using the buffer of the current frame.
+		for( auto&& [binding, storage] : descriptorSet.StorageBuffers )
 		{
-			auto& wd = m_StorageBufferSets[ m_FrameCount ][ shaderName ];
+			Ref<StorageBuffer> sb = rStorageBufferSet->Get( 0, binding, m_FrameCount );
 
-			for( size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++ )
-			{
-				Ref<StorageBuffer> sb = rStorageBufferSet->Get( 0, binding, m_FrameCount );
-				
-				VkWriteDescriptorSet wds = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
-				wds.descriptorCount = 1;
-				wds.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-				wds.pBufferInfo = &sb->GetBufferInfo();
-				wds.dstBinding = sb->GetBinding();
-				// We don't know the descriptor set yet so we don't set it. It will be updated when we bind the material.
-
-				wd.push_back( wds );
-			}
+			VkWriteDescriptorSet wds = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+			wds.descriptorCount = 1;
+			wds.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			wds.pBufferInfo = &sb->GetBufferInfo();
+			wds.dstBinding = sb->GetBinding();
+			// We don't know the descriptor set yet so we don't set it. It will be updated when we bind the material.
+
+			wd.push_back( wds );
 		}
 
 		return m_StorageBufferSets[ m_FrameCount ][ shaderName ];
 	}
 
-	void Renderer::SubmitMesh( 
-		VkCommandBuffer CommandBuffer, Ref< Saturn::Pipeline > Pipeline, Ref< StaticMesh > mesh, 
-		Ref<StorageBufferSet>& rStorageBufferSet, Ref< MaterialRegistry > materialRegistry, 
-		uint32_t SubmeshIndex, uint32_t count, Ref<VertexBuffer> transformData, uint32_t transformOffset )
+	Renderer::StaticMeshResources Renderer::PrepareStaticMeshResources( Ref< Saturn::Pipeline > Pipeline, Ref<StorageBufferSet>& rStorageBufferSet )
 	{
 		SAT_PF_EVENT();
 
 		Ref<Shader> Shader = Pipeline->GetShader();
 
+		// Set 0 only holds per frame data, so one set is shared by every draw instead of one per material.
+		VkDescriptorSet FrameSet = Shader->AllocateDescriptorSet( 0, true );
+		Shader->WriteAllUBs( FrameSet );
+
+		for( const auto& rWDS : GetStorageBufferWriteDescriptors( rStorageBufferSet, Shader ) )
+		{
+			VkWriteDescriptorSet wds = rWDS;
+			wds.dstSet = FrameSet;
+
+			vkUpdateDescriptorSets( VulkanContext::Get().GetDevice(), 1, &wds, 0, nullptr );
+		}
+
+		// Descriptor set 0, for per frame data.
+		// Descriptor set 1, for environment data.
+		// Descriptor set 2, bindless textures and materials.
+		return {
+			FrameSet,
+			m_RendererDescriptorSets[ m_FrameCount ],
+			VulkanContext::Get().GetBindlessTable()->GetDescriptorSet( m_FrameCount )
+		};
+	}
+
+	void Renderer::BindStaticMeshResources( VkCommandBuffer CommandBuffer, Ref< Saturn::Pipeline > Pipeline, const StaticMeshResources& rResources )
+	{
+		// Offsets for every set being bound, in set order.
+		uint32_t DynamicOffsets[ Shader::MaxDynamicOffsets ];
+		uint32_t DynamicOffsetCount = 0;
+
+		for( uint32_t Set = 0; Set < ( uint32_t ) rResources.size(); Set++ )
+			DynamicOffsetCount += Pipeline->GetShader()->GetDynamicOffsets( Set, DynamicOffsets + DynamicOffsetCount );
+
+		vkCmdBindDescriptorSets( CommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+			Pipeline->GetPipelineLayout(), 0, ( uint32_t ) rResources.size(), rResources.data(), DynamicOffsetCount, DynamicOffsets );
+	}
+
+	void Renderer::SubmitMesh( 
+		VkCommandBuffer CommandBuffer, Ref< Saturn::Pipeline > Pipeline, Ref< StaticMesh > mesh, 
+		Ref< MaterialRegistry > materialRegistry, 
+		uint32_t SubmeshIndex, uint32_t count, Ref<VertexBuffer> transformData, uint32_t transformOffset, uint32_t LodIndex )
+	{
+		SAT_PF_EVENT();
+
 		VkDeviceSize transformOffsets[ 1 ] = { transformOffset };
 
 		mesh->GetVertexBuffer()->Bind( CommandBuffer );
@@ -279,25 +332,13 @@ namespace Saturn {
 		{
 			auto& rMaterialAsset = materialRegistry->GetMaterials()[ rSubmesh.MaterialIndex ];
 
-			const auto& StorageWriteDescriptors = GetStorageBufferWriteDescriptors( rStorageBufferSet, rMaterialAsset );
-
-			rMaterialAsset->Bind( mesh, rSubmesh, Shader, StorageWriteDescriptors[ m_FrameCount ] );
-
-			VkDescriptorSet Set = rMaterialAsset->GetMaterial()->GetDescriptorSet( m_FrameCount );
+			uint32_t MaterialIndex = rMaterialAsset->GetBindlessIndex();
 
-			vkCmdPushConstants( CommandBuffer, Pipeline->GetPipelineLayout(), VK_SHADER_STAGE_FRAGMENT_BIT, 0, ( uint32_t ) rMaterialAsset->GetPushConstantData().Size, rMaterialAsset->GetPushConstantData().Data );
+			vkCmdPushConstants( CommandBuffer, Pipeline->GetPipelineLayout(), VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof( uint32_t ), &MaterialIndex );
 
-			// Descriptor set 0, for material texture data.
-			// Descriptor set 1, for environment data.
-			std::array<VkDescriptorSet, 2> DescriptorSets = {
-				Set,
-				m_RendererDescriptorSets[ m_FrameCount ]
-			};
+			SubmeshLod Lod = rSubmesh.GetLod( LodIndex );
 
-			vkCmdBindDescriptorSets( CommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
-				Pipeline->GetPipelineLayout(), 0, ( uint32_t ) DescriptorSets.size(), DescriptorSets.data(), 0, nullptr );
-
-			vkCmdDrawIndexed( CommandBuffer, rSubmesh.IndexCount, count, rSubmesh.BaseIndex, rSubmesh.BaseVertex, 0 );
+			vkCmdDrawIndexed( CommandBuffer, Lod.IndexCount, count, Lod.BaseIndex, rSubmesh.BaseVertex, 0 );
 		}
 	}
 
@@ -391,6 +432,16 @@ namespace Saturn {
 		// Reset current fence.
 		VK_CHECK( vkResetFences( LogicalDevice, 1, &m_FlightFences[ m_FrameCount ] ) );
 
+		// The GPU is done with this frame, bindless slots released the last time it was recorded can be reused.
+		VulkanContext::Get().GetBindlessTable()->Update( m_FrameCount );
+
+		// After the bindless table so that textures which get a new image are written into this frame's set.
+		VulkanContext::Get().GetTextureStreamer()->Update( m_FrameCount );
+
+		VulkanContext::Get().GetUniformBufferRing()->BeginFrame( m_FrameCount );
+
+		m_SecondaryRecorder->BeginFrame( m_FrameCount );
+
 		// Acquire next image.
 		uint32_t ImageIndex = -1;
 		VulkanContext::Get().GetSwapchain().AcquireNextImage( UINT32_MAX, m_AcquireSemaphore, VK_NULL_HANDLE, &ImageIndex );
@@ -412,6 +463,9 @@ namespace Saturn {
 
 		VK_CHECK( vkEndCommandBuffer( m_CommandBuffer ) );
 
+		// Submit any pending uploads first, the frame may use resources that were created this frame.
+		VulkanContext::Get().GetUploadManager()->Flush();
+
 		// Rendering Queue
 		VkPipelineStageFlags WaitStage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
 
@@ -431,7 +485,10 @@ namespace Saturn {
 		VK_CHECK( vkResetFences( LogicalDevice, 1, &m_FlightFences[ m_FrameCount ] ) );
 
 		// Use current fence to be signaled.
-		VK_CHECK( vkQueueSubmit( VulkanContext::Get().GetGraphicsQueue(), 1, &SubmitInfo, m_FlightFences[ m_FrameCount ] ) );
+		{
+			std::lock_guard<std::mutex> QueueLock( VulkanContext::Get().GetQueueMutex() );
+			VK_CHECK( vkQueueSubmit( VulkanContext::Get().GetGraphicsQueue(), 1, &SubmitInfo, m_FlightFences[ m_FrameCount ] ) );
+		}
 
 		// Present info.
 		VkPresentInfoKHR PresentInfo = { VK_STRUCTURE_TYPE_PRESENT_INFO_KHR };
@@ -445,7 +502,11 @@ namespace Saturn {
 		
 		m_QueuePresentTimer.Reset();
 
-		VkResult Result = vkQueuePresentKHR( VulkanContext::Get().GetGraphicsQueue(), &PresentInfo );
+		VkResult Result;
+		{
+			std::lock_guard<std::mutex> QueueLock( VulkanContext::Get().GetQueueMutex() );
+			Result = vkQueuePresentKHR( VulkanContext::Get().GetGraphicsQueue(), &PresentInfo );
+		}
 
 		if( Result == VK_ERROR_OUT_OF_DATE_KHR ) 
 		{
@@ -455,12 +516,16 @@ namespace Saturn {
 
 			PresentInfo.pSwapchains = &VulkanContext::Get().GetSwapchain().GetSwapchain();
 
+			std::lock_guard<std::mutex> QueueLock( VulkanContext::Get().GetQueueMutex() );
 			VK_CHECK( vkQueuePresentKHR( VulkanContext::Get().GetGraphicsQueue(), &PresentInfo ) );
 		}
 
 		m_QueuePresentTime = m_QueuePresentTimer.ElapsedMilliseconds();
 
-		VK_CHECK( vkQueueWaitIdle( VulkanContext::Get().GetPresentQueue() ) );
+		{
+			std::lock_guard<std::mutex> QueueLock( VulkanContext::Get().GetQueueMutex() );
+			VK_CHECK( vkQueueWaitIdle( VulkanContext::Get().GetPresentQueue() ) );
+		}
 
 		vkFreeCommandBuffers( LogicalDevice, VulkanContext::Get().GetCommandPool(), 1, &m_CommandBuffer );
 
@@ -469,7 +534,7 @@ namespace Saturn {
 		m_EndFrameTime = m_EndFrameTimer.ElapsedMilliseconds() - m_QueuePresentTime;
 
 		// Clear storage buffer sets. Reallocated next frame.
-		// Not ideal but for now we will do this as in the LightCulling pass we resize the buffer every frame meaning we have to update our cache.
+		// Not ideal but for now we will do this as the light buffers grow with the scene, a resized buffer has a new handle meaning we have to update our cache.
 		m_StorageBufferSets.clear();
 	}
 
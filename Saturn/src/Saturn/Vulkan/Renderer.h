@@ -31,6 +31,7 @@
 #include "VulkanContext.h"
 #include "EnvironmentMap.h"
 #include "StorageBufferSet.h"
+#include "SecondaryCommandRecorder.h"
 
 namespace Saturn {
 
@@ -63,16 +64,26 @@ namespace Saturn {
 		void BeginRenderPass( VkCommandBuffer CommandBuffer, Pass& rPass );
 		void EndRenderPass( VkCommandBuffer CommandBuffer );
 
-		void RenderMeshWithoutMaterial( VkCommandBuffer CommandBuffer, Ref<Saturn::Pipeline> Pipeline, Ref<StaticMesh> mesh, uint32_t count, Ref<VertexBuffer> transformVB, uint32_t TransformOffset, uint32_t SubmeshIndex, Buffer additionalData = Buffer() );
+		void RenderMeshWithoutMaterial( VkCommandBuffer CommandBuffer, Ref<Saturn::Pipeline> Pipeline, Ref<StaticMesh> mesh, uint32_t count, Ref<VertexBuffer> transformVB, uint32_t TransformOffset, uint32_t SubmeshIndex, uint32_t LodIndex, Buffer additionalData = Buffer() );
 
 		// Static mesh
 		void RenderSubmesh( VkCommandBuffer CommandBuffer, Ref<Saturn::Pipeline> Pipeline, Ref< StaticMesh > mesh, Submesh& rSubmsh, const glm::mat4 transform );
 
+		// The per frame data (set 0), the environment (set 1) and the bindless table (set 2), bound once for all static mesh draws that follow.
+		using StaticMeshResources = std::array<VkDescriptorSet, 3>;
+
+		// Allocates and writes the per frame set, descriptor sets are not allocated on the job system so this has to be called before the draws are recorded.
+		StaticMeshResources PrepareStaticMeshResources( Ref< Saturn::Pipeline > Pipeline, Ref<StorageBufferSet>& rStorageBufferSet );
+
+		// Only records the bind, safe to call from any thread.
+		void BindStaticMeshResources( VkCommandBuffer CommandBuffer, Ref< Saturn::Pipeline > Pipeline, const StaticMeshResources& rResources );
+
+		// Materials must have been updated (MaterialAsset::UpdateBindless) before this is called, only the material index is pushed.
 		void SubmitMesh( VkCommandBuffer CommandBuffer, Ref< Saturn::Pipeline > Pipeline, Ref< StaticMesh > mesh,
-			Ref<StorageBufferSet>& rStorageBufferSet, Ref< MaterialRegistry > materialRegistry, uint32_t SubmeshIndex, uint32_t count,
-			Ref<VertexBuffer> transformData, uint32_t transformOffset );
+			Ref< MaterialRegistry > materialRegistry, uint32_t SubmeshIndex, uint32_t count,
+			Ref<VertexBuffer> transformData, uint32_t transformOffset, uint32_t LodIndex = 0 );
 
-		const std::vector<VkWriteDescriptorSet>& GetStorageBufferWriteDescriptors( Ref<StorageBufferSet>& rStorageBufferSet, Ref<MaterialAsset>& rMaterialAsset );
+		const std::vector<VkWriteDescriptorSet>& GetStorageBufferWriteDescriptors( Ref<StorageBufferSet>& rStorageBufferSet, Ref<Shader>& rShader );
 
 		void SetSceneEnvironment( Ref<Image2D> ShadowMap, Ref<EnvironmentMap> Environment, Ref<Texture2D> BDRF );
 
@@ -114,6 +125,9 @@ namespace Saturn {
 	public:
 		VkCommandBuffer ActiveCommandBuffer() { return m_CommandBuffer; };
 
+		// Records render pass contents into secondary command buffers on the job system, they are executed in ActiveCommandBuffer.
+		Ref<SecondaryCommandRecorder>& GetSecondaryRecorder() { return m_SecondaryRecorder; }
+
 	private:
 		
 		void Init();
@@ -134,6 +148,8 @@ namespace Saturn {
 
 		VkCommandBuffer m_CommandBuffer = nullptr;
 
+		Ref< SecondaryCommandRecorder > m_SecondaryRecorder;
+
 		Timer m_BeginFrameTimer;
 		float m_BeginFrameTime = 0.0f;
 
@@ -38,14 +38,15 @@
 
 namespace Saturn {
 
-	static constexpr uint32_t s_MaxQuads = 20000;
-	static constexpr uint32_t s_MaxVertices = s_MaxQuads * 4;
-	static constexpr uint32_t s_MaxIndices = s_MaxQuads * 6;
+	// Size of one ring buffer, when one is full the batch continues in the next one.
+	static constexpr uint32_t s_QuadsPerBuffer = 16384;
 	static constexpr uint32_t s_MaxTextureSlots = 32;
 
-	static constexpr uint32_t s_MaxLines = 2000;
-	static constexpr uint32_t s_MaxLineVertices = s_MaxLines * 2;
-	static constexpr uint32_t s_MaxLineIndices = s_MaxLines * 6;
+	static constexpr uint32_t s_LineVerticesPerBuffer = 32768;
+
+	// Batches per secondary command buffer, the batches are recorded on the job system.
+	static constexpr uint32_t s_QuadBatchesPerSecondary = 16;
+	static constexpr uint32_t s_LineBatchesPerSecondary = 16;
 
 	void Renderer2D::Init()
 	{
@@ -55,58 +56,14 @@ namespace Saturn {
 		m_Width = Application::Get().GetWindow()->GetWidth();
 		m_Height = Application::Get().GetWindow()->GetHeight();
 
-		// Setup Quads
-		m_QuadVertexPositions.push_back( { -0.5f, -0.5f, 0.0f, 1.0f } );
-		m_QuadVertexPositions.push_back( { -0.5f,  0.5f, 0.0f, 1.0f } );
-		m_QuadVertexPositions.push_back( { 0.5f,  0.5f, 0.0f, 1.0f } );
-		m_QuadVertexPositions.push_back( { 0.5f, -0.5f, 0.0f, 1.0f } );
-
-		// Setup vertex buffer
-		m_QuadVertexBuffers.resize( MAX_FRAMES_IN_FLIGHT );
-		m_LineVertexBuffers.resize( MAX_FRAMES_IN_FLIGHT );
-
-		m_CurrentQuadBase.resize( MAX_FRAMES_IN_FLIGHT );
-		m_CurrentLineBase.resize( MAX_FRAMES_IN_FLIGHT );
-
-		for( int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++ )
-		{
-			m_QuadVertexBuffers[ i ] = Ref<VertexBuffer>::Create( s_MaxVertices * sizeof( QuadDrawCommand ) );
-			m_CurrentQuadBase[ i ] = new QuadDrawCommand[ s_MaxVertices ];
-
-			m_LineVertexBuffers[ i ] = Ref<VertexBuffer>::Create( s_MaxLineVertices * sizeof( LineDrawCommand ) );
-			m_CurrentLineBase[ i ] = new LineDrawCommand[ s_MaxLineVertices ];
-		}
-
-		// Setup Index Buffer
-		uint32_t* quadBuffer = new uint32_t[ s_MaxIndices ];
-
-		uint32_t offset = 0;
+		// Setup Quads, every instance is drawn from the same four corners.
+		glm::vec2 QuadCorners[] = { { -0.5f, -0.5f }, { -0.5f,  0.5f }, { 0.5f,  0.5f }, { 0.5f, -0.5f } };
+		m_QuadCornerBuffer = Ref<VertexBuffer>::Create( QuadCorners, sizeof( QuadCorners ) );
 
-		for( uint32_t i = 0; i < s_MaxIndices; i += 6 )
-		{
-			quadBuffer[ i + 0 ] = offset + 0;
-			quadBuffer[ i + 1 ] = offset + 1;
-			quadBuffer[ i + 2 ] = offset + 2;
-
-			quadBuffer[ i + 3 ] = offset + 2;
-			quadBuffer[ i + 4 ] = offset + 3;
-			quadBuffer[ i + 5 ] = offset + 0;
-
-			offset += 4;
-		}
-
-		m_QuadIndexBuffer = Ref<IndexBuffer>::Create( quadBuffer, s_MaxIndices );
-		delete[] quadBuffer;
+		uint32_t QuadIndices[] = { 0, 1, 2, 2, 3, 0 };
+		m_QuadIndexBuffer = Ref<IndexBuffer>::Create( QuadIndices, sizeof( QuadIndices ) );
 
-		uint32_t* pLineBuffer = new uint32_t[ s_MaxLineIndices ];
-		for( uint32_t i = 0; i < s_MaxLineIndices; i++ )
-			pLineBuffer[ i ] = i;
-
-		m_LineIndexBuffer = Ref<IndexBuffer>::Create( pLineBuffer, s_MaxLineIndices );
-		delete[] pLineBuffer;
-
-		// Setup Textures
-		m_Textures[ 0 ] = Renderer::Get().GetPinkTexture();
+		m_Frames.resize( MAX_FRAMES_IN_FLIGHT );
 
 		// Construct a temporary render pass this is be changed when the scene renderer is ready.
 		PassSpecification PassSpec;
@@ -117,6 +74,8 @@ namespace Saturn {
 		m_TargetRenderPass = m_TempRenderPass;
 
 		LateInit();
+
+		PreRender();
 	}
 
 	void Renderer2D::LateInit( Ref<Pass> targetPass /*= nullptr */, Ref<Framebuffer> targetFramebuffer /*= nullptr*/ )
@@ -158,10 +117,13 @@ namespace Saturn {
 		PipelineSpec.FrontFace = VK_FRONT_FACE_CLOCKWISE;
 		PipelineSpec.UseDepthTest = true;
 		PipelineSpec.VertexLayout = {
-			{ ShaderDataType::Float3, "a_Position" },
+			{ ShaderDataType::Float2, "a_Corner" },
+		};
+		PipelineSpec.InstanceLayout = {
+			{ ShaderDataType::Float4, "a_Position" },
 			{ ShaderDataType::Float4, "a_Color" },
-			{ ShaderDataType::Float2, "a_TexCoord" },
-			{ ShaderDataType::Float, "a_TextureIndex" },
+			{ ShaderDataType::Float4, "a_AxisX" },
+			{ ShaderDataType::Float4, "a_AxisY" },
 		};
 
 		m_QuadPipeline = Ref<Pipeline>::Create( PipelineSpec );
@@ -175,21 +137,20 @@ namespace Saturn {
 			{ ShaderDataType::Float3, "a_Position" },
 			{ ShaderDataType::Float4, "a_Color" }
 		};
+		PipelineSpec.InstanceLayout = {};
 
 		m_LinePipeline = Ref<Pipeline>::Create( PipelineSpec );
 	}
 
 	void Renderer2D::Reset()
 	{
-		uint32_t frame = Renderer::Get().GetCurrentFrame();
-
-		m_CurrentQuad = m_CurrentQuadBase[ frame ];
-		m_QuadIndexCount = 0;
+		auto& rFrame = m_Frames[ m_Frame ];
 
-		m_CurrentLine = m_CurrentLineBase[ frame ];
-		m_LineVertexCount = 0;
+		rFrame.QuadBatches.clear();
+		rFrame.LineBatches.clear();
 
-		m_CurrentTextureSlot = 1;
+		m_pQuadBase = nullptr;
+		m_pLineBase = nullptr;
 	}
 
 	void Renderer2D::Terminate()
@@ -200,25 +161,18 @@ namespace Saturn {
 		m_TargetFramebuffer = nullptr;
 		m_QuadPipeline = nullptr;
 		m_TargetRenderPass = nullptr;
+		m_QuadCornerBuffer = nullptr;
 		m_QuadIndexBuffer = nullptr;
 		m_QuadShader = nullptr;
 		m_QuadMaterial = nullptr;
 		m_LinePipeline = nullptr;
 		m_LineShader = nullptr;
 		m_LineMaterial = nullptr;
-		m_LineIndexBuffer = nullptr;
-
-		m_QuadVertexBuffers.clear();
-		m_LineVertexBuffers.clear();
-
-		for( auto& texture : m_Textures )
-			texture = nullptr;
 
-		for( auto buffer : m_CurrentQuadBase )
-			delete[] buffer;
+		m_Frames.clear();
 
-		for( auto buffer : m_CurrentLineBase )
-			delete[] buffer;
+		m_pQuadBase = nullptr;
+		m_pLineBase = nullptr;
 	}
 
 	void Renderer2D::SetViewportSize( uint32_t w, uint32_t h )
@@ -250,8 +204,25 @@ namespace Saturn {
 	void Renderer2D::RenderAll()
 	{
 		VkExtent2D Extent = { m_Width, m_Height };
+		VkFramebuffer Framebuffer = m_TargetFramebuffer->GetVulkanFramebuffer();
 
-		m_TargetRenderPass->BeginPass( m_CommandBuffer, m_TargetFramebuffer->GetVulkanFramebuffer(), Extent );
+		auto& rRecorder = Renderer::Get().GetSecondaryRecorder();
+
+		m_TargetRenderPass->BeginPass( m_CommandBuffer, Framebuffer, Extent, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS );
+		rRecorder->BeginRenderPass( m_TargetRenderPass->GetVulkanPass(), Framebuffer );
+
+		m_LastDrawCalls = 0;
+
+		RenderAllQuads();
+		RenderAllLines();
+
+		rRecorder->EndRenderPass( m_CommandBuffer );
+		m_TargetRenderPass->EndPass();
+	}
+
+	void Renderer2D::SetViewportAndScissor( VkCommandBuffer CommandBuffer )
+	{
+		VkExtent2D Extent = { m_Width, m_Height };
 
 		VkViewport Viewport = {};
 		Viewport.x = 0;
@@ -263,60 +234,90 @@ namespace Saturn {
 
 		VkRect2D Scissor = { .offset = { 0,0 }, .extent = Extent };
 
-		vkCmdSetScissor( m_CommandBuffer, 0, 1, &Scissor );
-		vkCmdSetViewport( m_CommandBuffer, 0, 1, &Viewport );
-
-		RenderAllQuads();
-		RenderAllLines();
-
-		m_TargetRenderPass->EndPass();
+		vkCmdSetScissor( CommandBuffer, 0, 1, &Scissor );
+		vkCmdSetViewport( CommandBuffer, 0, 1, &Viewport );
 	}
 
 	void Renderer2D::RenderAllQuads()
 	{
 		uint32_t frame = Renderer::Get().GetCurrentFrame();
+		auto& rFrame = m_Frames[ frame ];
 
 		struct QuadMatricesObject
 		{
 			glm::mat4 ViewProjection = glm::mat4( 1.0f );
+			glm::vec4 CameraRight = glm::vec4( 1.0f, 0.0f, 0.0f, 0.0f );
+			glm::vec4 CameraUp = glm::vec4( 0.0f, 1.0f, 0.0f, 0.0f );
 		} u_Matrices;
 
 		u_Matrices.ViewProjection = m_CameraViewProjection;
+		u_Matrices.CameraRight = glm::vec4( m_CameraView[ 0 ][ 0 ], m_CameraView[ 1 ][ 0 ], m_CameraView[ 2 ][ 0 ], 0.0f );
+		u_Matrices.CameraUp = glm::vec4( m_CameraView[ 0 ][ 1 ], m_CameraView[ 1 ][ 1 ], m_CameraView[ 2 ][ 1 ], 0.0f );
 
 		m_QuadShader->UploadUB( ShaderType::Vertex, 0, 0, &u_Matrices, sizeof( u_Matrices ) );
 
-		uint32_t dataSize = ( uint32_t ) ( ( uint8_t* ) m_CurrentQuad - ( uint8_t* ) m_CurrentQuadBase[ frame ] );
-		if( dataSize )
+		m_LastQuadCount = 0;
+
+		if( rFrame.QuadBatches.empty() )
+			return;
+
+		// Descriptor sets are allocated here, the secondaries only bind them.
+		std::vector< std::pair< const QuadBatch*, VkDescriptorSet > > Batches;
+
+		for( const auto& rBatch : rFrame.QuadBatches )
 		{
-			m_QuadVertexBuffers[ frame ]->Reallocate( m_CurrentQuadBase[ frame ], dataSize );
+			if( rBatch.InstanceCount == 0 )
+				continue;
 
-			for( uint32_t i = 0; i < m_Textures.size(); i++ )
+			// Unused slots still have to point at a valid image.
+			for( uint32_t i = 0; i < s_MaxTextureSlots; i++ )
 			{
-				if( m_Textures[ i ] )
-					m_QuadMaterial->SetResource( "u_InputTexture", m_Textures[ i ], i );
+				if( i < rBatch.Textures.size() && rBatch.Textures[ i ] )
+					m_QuadMaterial->SetResource( "u_InputTexture", rBatch.Textures[ i ], i );
 				else
 					m_QuadMaterial->SetResource( "u_InputTexture", Renderer::Get().GetPinkTexture(), i );
 			}
 
+			// Every bind allocates a new descriptor set, so each batch keeps its own textures.
 			m_QuadMaterial->Bind( m_CommandBuffer, m_QuadShader );
-			m_QuadMaterial->BindDS( m_CommandBuffer, m_QuadPipeline->GetPipelineLayout() );
 
-			m_QuadPipeline->Bind( m_CommandBuffer );
+			Batches.push_back( { &rBatch, m_QuadMaterial->GetDescriptorSet( frame ) } );
 
-			m_QuadIndexBuffer->Bind( m_CommandBuffer );
+			m_LastQuadCount += rBatch.InstanceCount;
+			m_LastDrawCalls++;
+		}
 
-			m_QuadVertexBuffers[ frame ]->Bind( m_CommandBuffer );
+		std::array< uint32_t, Shader::MaxDynamicOffsets > QuadOffsets;
+		uint32_t QuadOffsetCount = m_QuadShader->GetDynamicOffsets( 0, QuadOffsets.data() );
 
-			glm::mat4 transform = glm::mat4( 1.0f );
-			vkCmdPushConstants( m_CommandBuffer, m_QuadPipeline->GetPipelineLayout(), VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof( glm::mat4 ), &transform );
+		Renderer::Get().GetSecondaryRecorder()->RecordParallel( ( uint32_t ) Batches.size(), s_QuadBatchesPerSecondary, [&]( VkCommandBuffer CommandBuffer, uint32_t Begin, uint32_t End )
+			{
+				SetViewportAndScissor( CommandBuffer );
 
-			vkCmdDrawIndexed( m_CommandBuffer, m_QuadIndexCount, 1, 0, 0, 0 );
-		}
+				m_QuadPipeline->Bind( CommandBuffer );
+				m_QuadIndexBuffer->Bind( CommandBuffer );
+
+				VkDeviceSize CornerOffset = 0;
+				m_QuadCornerBuffer->Bind( CommandBuffer, 0, &CornerOffset );
+
+				for( uint32_t i = Begin; i < End; i++ )
+				{
+					const auto& [pBatch, Set] = Batches[ i ];
+
+					vkCmdBindDescriptorSets( CommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_QuadPipeline->GetPipelineLayout(), 0, 1, &Set, QuadOffsetCount, QuadOffsets.data() );
+
+					VkDeviceSize InstanceOffset = 0;
+					rFrame.QuadBuffers[ pBatch->Buffer ]->Bind( CommandBuffer, 1, &InstanceOffset );
+
+					vkCmdDrawIndexed( CommandBuffer, 6, pBatch->InstanceCount, 0, 0, pBatch->FirstInstance );
+				}
+			} );
 	}
 
 	void Renderer2D::RenderAllLines()
 	{
 		uint32_t frame = Renderer::Get().GetCurrentFrame();
+		auto& rFrame = m_Frames[ frame ];
 
 		struct QuadMatricesObject
 		{
@@ -327,187 +328,268 @@ namespace Saturn {
 
 		m_LineShader->UploadUB( ShaderType::Vertex, 0, 0, &u_Matrices, sizeof( u_Matrices ) );
 
-		uint32_t dataSize = ( uint32_t ) ( ( uint8_t* ) m_CurrentLine - ( uint8_t* ) m_CurrentLineBase[ frame ] );
-		if( dataSize )
-		{
-			m_LineVertexBuffers[ frame ]->Reallocate( m_CurrentLineBase[ frame ], dataSize );
+		m_LastLineCount = 0;
 
-			m_LineMaterial->Bind( m_CommandBuffer, m_LineShader );
-			m_LineMaterial->BindDS( m_CommandBuffer, m_LinePipeline->GetPipelineLayout() );
+		if( rFrame.LineBatches.empty() )
+			return;
+
+		m_LineMaterial->Bind( m_CommandBuffer, m_LineShader );
 
-			m_LinePipeline->Bind( m_CommandBuffer );
+		VkDescriptorSet LineSet = m_LineMaterial->GetDescriptorSet( frame );
 
-			m_LineIndexBuffer->Bind( m_CommandBuffer );
+		std::array< uint32_t, Shader::MaxDynamicOffsets > LineOffsets;
+		uint32_t LineOffsetCount = m_LineShader->GetDynamicOffsets( 0, LineOffsets.data() );
 
-			m_LineVertexBuffers[ frame ]->Bind( m_CommandBuffer );
+		for( const auto& rBatch : rFrame.LineBatches )
+		{
+			if( rBatch.VertexCount == 0 )
+				continue;
 
-			vkCmdDrawIndexed( m_CommandBuffer, m_LineVertexCount, 1, 0, 0, 0 );
+			m_LastLineCount += rBatch.VertexCount / 2;
+			m_LastDrawCalls++;
 		}
+
+		Renderer::Get().GetSecondaryRecorder()->RecordParallel( ( uint32_t ) rFrame.LineBatches.size(), s_LineBatchesPerSecondary, [&]( VkCommandBuffer CommandBuffer, uint32_t Begin, uint32_t End )
+			{
+				SetViewportAndScissor( CommandBuffer );
+
+				vkCmdBindDescriptorSets( CommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_LinePipeline->GetPipelineLayout(), 0, 1, &LineSet, LineOffsetCount, LineOffsets.data() );
+
+				m_LinePipeline->Bind( CommandBuffer );
+
+				for( uint32_t i = Begin; i < End; i++ )
+				{
+					const auto& rBatch = rFrame.LineBatches[ i ];
+
+					if( rBatch.VertexCount == 0 )
+						continue;
+
+					rFrame.LineBuffers[ rBatch.Buffer ]->Bind( CommandBuffer );
+
+					vkCmdDraw( CommandBuffer, rBatch.VertexCount, 1, 0, 0 );
+				}
+			} );
 	}
 
-	void Renderer2D::SubmitQuad( const glm::mat4& transform, const glm::vec4& color )
+	//////////////////////////////////////////////////////////////////////////
+	// BATCHING
+
+	void Renderer2D::StartQuadBatch()
 	{
-		// One quad has 4 vertices so we need to submit them one by one.
-		glm::vec2 TexCoord[] = { { 0.0f, 0.0f }, { 1.0f, 0.0f }, { 1.0f, 1.0f }, { 0.0f, 1.0f } };
+		auto& rFrame = m_Frames[ m_Frame ];
 
-		for( size_t i = 0; i < 4; i++ )
+		QuadBatch Batch;
+		Batch.Textures.push_back( Renderer::Get().GetPinkTexture() );
+
+		if( !rFrame.QuadBatches.empty() )
 		{
-			m_CurrentQuad->Position = transform * m_QuadVertexPositions[ i ];
-			m_CurrentQuad->Color = color;
-			m_CurrentQuad->TexCoord = TexCoord[ i ];
+			const auto& rLast = rFrame.QuadBatches.back();
+
+			Batch.Buffer = rLast.Buffer;
+			Batch.FirstInstance = rLast.FirstInstance + rLast.InstanceCount;
+		}
 
-			m_CurrentQuad++;
+		// Out of space, continue in the next buffer of the ring.
+		if( Batch.FirstInstance >= s_QuadsPerBuffer )
+		{
+			Batch.Buffer++;
+			Batch.FirstInstance = 0;
 		}
 
-		m_QuadIndexCount += 6;
+		if( Batch.Buffer >= rFrame.QuadBuffers.size() )
+			rFrame.QuadBuffers.push_back( Ref<VertexBuffer>::Create( s_QuadsPerBuffer * sizeof( QuadInstance ) ) );
+
+		m_pQuadBase = static_cast< QuadInstance* >( rFrame.QuadBuffers[ Batch.Buffer ]->GetPersistentMapping() );
+
+		rFrame.QuadBatches.push_back( std::move( Batch ) );
 	}
 
-	void Renderer2D::SubmitQuad( const glm::vec3& position, const glm::vec4& color, const glm::vec2& size )
+	void Renderer2D::StartLineBatch()
 	{
-		glm::vec2 TexCoord[] = { { 0.0f, 0.0f }, { 1.0f, 0.0f }, { 1.0f, 1.0f }, { 0.0f, 1.0f } };
+		auto& rFrame = m_Frames[ m_Frame ];
 
-		glm::mat4 transform = glm::translate( glm::mat4( 1.0f ), position )
-			* glm::scale( glm::mat4( 1.0f ), { size.x, size.y, 1.0f } );
+		LineBatch Batch;
+		Batch.Buffer = ( uint32_t ) rFrame.LineBatches.size();
 
-		for( size_t i = 0; i < 4; i++ )
-		{
-			m_CurrentQuad->Position = transform * m_QuadVertexPositions[ i ];
-			m_CurrentQuad->Color = color;
-			m_CurrentQuad->TexCoord = TexCoord[ i ];
-			m_CurrentQuad->TextureIndex = 0;
+		if( Batch.Buffer >= rFrame.LineBuffers.size() )
+			rFrame.LineBuffers.push_back( Ref<VertexBuffer>::Create( s_LineVerticesPerBuffer * sizeof( LineDrawCommand ) ) );
 
-			m_CurrentQuad++;
-		}
+		m_pLineBase = static_cast< LineDrawCommand* >( rFrame.LineBuffers[ Batch.Buffer ]->GetPersistentMapping() );
 
-		m_QuadIndexCount += 6;
+		rFrame.LineBatches.push_back( Batch );
 	}
 
-	void Renderer2D::SubmitQuadTextured( const glm::mat4& transform, const glm::vec4& color, const Ref<Texture2D>& rTexture )
+	uint32_t Renderer2D::FindOrAddTexture( const Ref<Texture2D>& rTexture )
 	{
-		// One quad has 4 vertexes so we need to submit them one by one.
-		glm::vec2 TexCoord[] = { { 0.0f, 0.0f }, { 1.0f, 0.0f }, { 1.0f, 1.0f }, { 0.0f, 1.0f } };
+		auto& rTextures = m_Frames[ m_Frame ].QuadBatches.back().Textures;
 
-		int textureID = 0;
-		for( uint32_t i = 1; i < m_CurrentTextureSlot; i++ )
+		for( uint32_t i = 1; i < rTextures.size(); i++ )
 		{
-			if( m_Textures[ i ] == rTexture ) 
-			{
-				textureID = i;
-				break;
-			}
+			if( rTextures[ i ] == rTexture )
+				return i;
 		}
 
-		if( textureID == 0 )
-		{
-			if( m_CurrentTextureSlot >= s_MaxTextureSlots )
-				Reset();
+		rTextures.push_back( rTexture );
 
-			textureID = m_CurrentTextureSlot;
-			m_Textures[ textureID ] = rTexture;
-			m_CurrentTextureSlot++;
-		}
+		return ( uint32_t ) rTextures.size() - 1;
+	}
+
+	QuadInstance* Renderer2D::AllocateQuad( const Ref<Texture2D>& rTexture )
+	{
+		if( m_Frames.empty() )
+			return nullptr;
 
-		for( size_t i = 0; i < 4; i++ )
+		auto& rBatches = m_Frames[ m_Frame ].QuadBatches;
+
+		if( rBatches.empty() )
+			StartQuadBatch();
+
+		// Flush when the buffer is full or when the texture would not fit in this batch.
 		{
-			m_CurrentQuad->Position = transform * m_QuadVertexPositions[ i ];
-			m_CurrentQuad->Color = color;
-			m_CurrentQuad->TexCoord = TexCoord[ i ];
-			m_CurrentQuad->TextureIndex = (float)textureID;
+			const auto& rBatch = rBatches.back();
 
-			m_CurrentQuad++;
+			bool BufferFull = rBatch.FirstInstance + rBatch.InstanceCount >= s_QuadsPerBuffer;
+			bool SlotsFull = rTexture && rBatch.Textures.size() >= s_MaxTextureSlots && std::find( rBatch.Textures.begin(), rBatch.Textures.end(), rTexture ) == rBatch.Textures.end();
+
+			if( BufferFull || SlotsFull )
+				StartQuadBatch();
 		}
 
-		m_QuadIndexCount += 6;
+		auto& rBatch = rBatches.back();
+
+		uint32_t TextureIndex = rTexture ? FindOrAddTexture( rTexture ) : 0;
+
+		QuadInstance* pQuad = m_pQuadBase + rBatch.FirstInstance + rBatch.InstanceCount;
+		pQuad->TextureIndex = ( float ) TextureIndex;
+
+		rBatch.InstanceCount++;
+
+		return pQuad;
 	}
 
-	void Renderer2D::SubmitBillboard( const glm::vec3& position, const glm::vec4& color, const glm::vec2& rSize )
+	Renderer2D::QuadRange Renderer2D::AllocateQuads( const Ref<Texture2D>& rTexture, uint32_t MaxCount )
 	{
-		glm::vec2 TexCoord[] = { { 0.0f, 0.0f }, { 1.0f, 0.0f }, { 1.0f, 1.0f }, { 0.0f, 1.0f } };
+		QuadRange Range;
 
-		glm::vec3 CamRight = { m_CameraView[ 0 ][ 0 ], m_CameraView[ 1 ][ 0 ], m_CameraView[ 2 ][ 0 ] };
-		glm::vec3 CamUp = { m_CameraView[ 0 ][ 1 ], m_CameraView[ 1 ][ 1 ], m_CameraView[ 2 ][ 1 ] };
+		if( MaxCount == 0 )
+			return Range;
 
-		for( size_t i = 0; i < 4; i++ )
-		{
-			m_CurrentQuad->Position = position + CamRight * ( m_QuadVertexPositions[ i ].x ) * rSize.x + CamUp * m_QuadVertexPositions[ i ].y * rSize.y;
-			m_CurrentQuad->Color = color;
-			m_CurrentQuad->TexCoord = TexCoord[ i ];
-			m_CurrentQuad->TextureIndex = 1;
+		// The first quad goes through AllocateQuad so that the batch and the texture slot are set up the same way.
+		QuadInstance* pFirst = AllocateQuad( rTexture );
+		if( !pFirst )
+			return Range;
 
-			m_CurrentQuad++;
-		}
+		auto& rBatch = m_Frames[ m_Frame ].QuadBatches.back();
+
+		uint32_t Available = s_QuadsPerBuffer - ( rBatch.FirstInstance + rBatch.InstanceCount );
+		uint32_t Extra = std::min( MaxCount - 1, Available );
+
+		rBatch.InstanceCount += Extra;
+
+		Range.pQuads = pFirst;
+		Range.Count = Extra + 1;
+		Range.TextureIndex = rTexture ? ( float ) FindOrAddTexture( rTexture ) : 0.0f;
 
-		m_QuadIndexCount += 6;
+		return Range;
 	}
 
-	void Renderer2D::SubmitBillboardTextured( const glm::vec3& position, const glm::vec4& color, const Ref<Texture2D>& rTexture, const glm::vec2& rSize )
+	LineDrawCommand* Renderer2D::AllocateLine()
 	{
-		constexpr glm::vec2 TexCoord[] = { { 0.0f, 1.0f }, { 0.0f, 0.0f }, { 1.0f, 0.0f }, { 1.0f, 1.0f } };
+		if( m_Frames.empty() )
+			return nullptr;
 
-		glm::vec3 CamRight = { m_CameraView[ 0 ][ 0 ], m_CameraView[ 1 ][ 0 ], m_CameraView[ 2 ][ 0 ] };
-		glm::vec3 CamUp = { m_CameraView[ 0 ][ 1 ], m_CameraView[ 1 ][ 1 ], m_CameraView[ 2 ][ 1 ] };
+		auto& rBatches = m_Frames[ m_Frame ].LineBatches;
 
-		int textureID = 0;
-		for( uint32_t i = 1; i < m_CurrentTextureSlot; i++ )
-		{
-			if( m_Textures[ i ] == rTexture )
-			{
-				textureID = i;
-				break;
-			}
-		}
+		if( rBatches.empty() || rBatches.back().VertexCount + 2 > s_LineVerticesPerBuffer )
+			StartLineBatch();
 
-		if( textureID == 0 )
-		{
-			if( m_CurrentTextureSlot >= s_MaxTextureSlots )
-				Reset();
+		auto& rBatch = rBatches.back();
 
-			textureID = m_CurrentTextureSlot;
-			m_Textures[ textureID ] = rTexture;
-			m_CurrentTextureSlot++;
-		}
+		LineDrawCommand* pLine = m_pLineBase + rBatch.VertexCount;
+		rBatch.VertexCount += 2;
 
-		for( size_t i = 0; i < 4; i++ )
-		{
-			m_CurrentQuad->Position = position + CamRight * ( m_QuadVertexPositions[ i ].x ) * rSize.x + CamUp * m_QuadVertexPositions[ i ].y * rSize.y;
-			m_CurrentQuad->Color = color;
-			m_CurrentQuad->TexCoord = TexCoord[ i ];
-			m_CurrentQuad->TextureIndex = (float)textureID;
+		return pLine;
+	}
 
-			m_CurrentQuad++;
-		}
+	//////////////////////////////////////////////////////////////////////////
+	// SUBMISSION
 
-		m_QuadIndexCount += 6;
+	void Renderer2D::SubmitQuad( const glm::mat4& transform, const glm::vec4& color )
+	{
+		QuadInstance* pQuad = AllocateQuad( nullptr );
+		if( !pQuad )
+			return;
+
+		pQuad->Position = glm::vec3( transform[ 3 ] );
+		pQuad->Color = color;
+		pQuad->AxisX = glm::vec4( glm::vec3( transform[ 0 ] ), 0.0f );
+		pQuad->AxisY = glm::vec4( glm::vec3( transform[ 1 ] ), 0.0f );
 	}
 
-	void Renderer2D::SubmitLine( const glm::vec3& rStart, const glm::vec3& rEnd, const glm::vec4& rColor )
+	void Renderer2D::SubmitQuad( const glm::vec3& position, const glm::vec4& color, const glm::vec2& size )
 	{
-		m_CurrentLine->Position = rStart;
-		m_CurrentLine->Color = rColor;
-	
-		m_CurrentLine++;
-	
-		m_CurrentLine->Position = rEnd;
-		m_CurrentLine->Color = rColor;
+		QuadInstance* pQuad = AllocateQuad( nullptr );
+		if( !pQuad )
+			return;
 
-		m_CurrentLine++;
+		pQuad->Position = position;
+		pQuad->Color = color;
+		pQuad->AxisX = glm::vec4( size.x, 0.0f, 0.0f, 0.0f );
+		pQuad->AxisY = glm::vec4( 0.0f, size.y, 0.0f, 0.0f );
+	}
+
+	void Renderer2D::SubmitQuadTextured( const glm::mat4& transform, const glm::vec4& color, const Ref<Texture2D>& rTexture )
+	{
+		QuadInstance* pQuad = AllocateQuad( rTexture );
+		if( !pQuad )
+			return;
 
-		m_LineVertexCount += 2;
+		pQuad->Position = glm::vec3( transform[ 3 ] );
+		pQuad->Color = color;
+		pQuad->AxisX = glm::vec4( glm::vec3( transform[ 0 ] ), 0.0f );
+		pQuad->AxisY = glm::vec4( glm::vec3( transform[ 1 ] ), 0.0f );
 	}
 
-	void Renderer2D::SubmitLine( const glm::vec3& rStart, const glm::vec3& rEnd, const glm::vec4& rColor, float Thinkness )
+	void Renderer2D::SubmitBillboard( const glm::vec3& position, const glm::vec4& color, const glm::vec2& rSize )
+	{
+		QuadInstance* pQuad = AllocateQuad( nullptr );
+		if( !pQuad )
+			return;
+
+		pQuad->Position = position;
+		pQuad->Color = color;
+		pQuad->AxisX = glm::vec4( rSize.x, 0.0f, 0.0f, 1.0f );
+		pQuad->AxisY = glm::vec4( 0.0f, rSize.y, 0.0f, 1.0f );
+	}
+
+	void Renderer2D::SubmitBillboardTextured( const glm::vec3& position, const glm::vec4& color, const Ref<Texture2D>& rTexture, const glm::vec2& rSize )
 	{
-		m_CurrentLine->Position = rStart;
-		m_CurrentLine->Color = rColor;
+		QuadInstance* pQuad = AllocateQuad( rTexture );
+		if( !pQuad )
+			return;
 
-		m_CurrentLine++;
+		pQuad->Position = position;
+		pQuad->Color = color;
+		pQuad->AxisX = glm::vec4( rSize.x, 0.0f, 0.0f, 1.0f );
+		pQuad->AxisY = glm::vec4( 0.0f, rSize.y, 0.0f, 1.0f );
+	}
 
-		m_CurrentLine->Position = rEnd;
-		m_CurrentLine->Color = rColor;
+	void Renderer2D::SubmitLine( const glm::vec3& rStart, const glm::vec3& rEnd, const glm::vec4& rColor )
+	{
+		LineDrawCommand* pLine = AllocateLine();
+		if( !pLine )
+			return;
+
+		pLine[ 0 ].Position = rStart;
+		pLine[ 0 ].Color = rColor;
 
-		m_CurrentLine++;
+		pLine[ 1 ].Position = rEnd;
+		pLine[ 1 ].Color = rColor;
+	}
 
-		m_LineVertexCount += 2;
+	void Renderer2D::SubmitLine( const glm::vec3& rStart, const glm::vec3& rEnd, const glm::vec4& rColor, float Thinkness )
+	{
+		SubmitLine( rStart, rEnd, rColor );
 	}
 
 	void Renderer2D::SetCamera( const RendererCamera& rRendererCamera )
@@ -518,13 +600,12 @@ namespace Saturn {
 
 	void Renderer2D::PreRender()
 	{
-		uint32_t frame = Renderer::Get().GetCurrentFrame();
-		
-		m_QuadIndexCount = 0;
-		m_CurrentQuad = m_CurrentQuadBase[ frame ];
+		if( m_Frames.empty() )
+			return;
+
+		m_Frame = Renderer::Get().GetCurrentFrame();
 
-		m_LineVertexCount = 0;
-		m_CurrentLine = m_CurrentLineBase[ frame ];
+		Reset();
 	}
 
 	void Renderer2D::Render()
@@ -532,7 +613,7 @@ namespace Saturn {
 		m_CommandBuffer = Renderer::Get().ActiveCommandBuffer();
 
 		// First, check if we have a render pass.
-		if( !m_TargetRenderPass || !m_CurrentQuad || !m_CurrentLine )
+		if( !m_TargetRenderPass || m_Frames.empty() )
 		{
 			return;
 		}
@@ -544,4 +625,4 @@ namespace Saturn {
 		CmdEndDebugLabel( m_CommandBuffer );
 	}
 
-}
\ No newline at end of file
+}
@@ -39,14 +39,19 @@
 
 namespace Saturn {
 
-	struct QuadDrawCommand
+	// One quad or billboard, the vertex shader expands it into the four corners.
+	struct QuadInstance
 	{
+		// Centre of the quad.
 		glm::vec3 Position;
-		glm::vec4 Color;
-		
-		// TexCoord is calculated before we render.
-		glm::vec2 TexCoord;
 		float TextureIndex;
+
+		glm::vec4 Color;
+
+		// Edges of the quad in world space, w is 1 for billboards.
+		// Billboards face the camera so they only store their size, in AxisX.x and AxisY.y.
+		glm::vec4 AxisX;
+		glm::vec4 AxisY;
 	};
 
 	struct LineDrawCommand
@@ -78,6 +83,17 @@ namespace Saturn {
 		void SubmitLine( const glm::vec3& rStart, const glm::vec3& rEnd, const glm::vec4& rColor );
 		void SubmitLine( const glm::vec3& rStart, const glm::vec3& rEnd, const glm::vec4& rColor, float Thinkness );
 
+		struct QuadRange
+		{
+			QuadInstance* pQuads = nullptr;
+			uint32_t Count = 0;
+			float TextureIndex = 0.0f;
+		};
+
+		// Reserves up to MaxCount consecutive quads for the caller to fill in, i.e. from the job system.
+		// The range ends early at the end of a buffer, call again for the rest. Must be called from the thread that submits.
+		QuadRange AllocateQuads( const Ref<Texture2D>& rTexture, uint32_t MaxCount );
+
 		void SetCamera( const RendererCamera& rRendererCamera );
 
 		void PreRender();
@@ -86,6 +102,10 @@ namespace Saturn {
 		void Terminate();
 		void SetViewportSize( uint32_t w, uint32_t h );
 
+		uint32_t GetQuadCount() const { return m_LastQuadCount; }
+		uint32_t GetLineCount() const { return m_LastLineCount; }
+		uint32_t GetDrawCalls() const { return m_LastDrawCalls; }
+
 	private:
 		void LateInit( Ref<Pass> targetPass = nullptr, Ref<Framebuffer> framebuffer = nullptr);
 		void Reset();
@@ -94,32 +114,63 @@ namespace Saturn {
 		void RenderAllQuads();
 		void RenderAllLines();
 
+		// The quads and lines are recorded into secondary command buffers, which don't inherit the primary's dynamic state.
+		void SetViewportAndScissor( VkCommandBuffer CommandBuffer );
+
+		QuadInstance* AllocateQuad( const Ref<Texture2D>& rTexture );
+		LineDrawCommand* AllocateLine();
+
+		uint32_t FindOrAddTexture( const Ref<Texture2D>& rTexture );
+		void StartQuadBatch();
+		void StartLineBatch();
+
 	private:
 		Ref<Pass> m_TargetRenderPass = nullptr;
 		Ref<Pass> m_TempRenderPass = nullptr;
 
 		//////////////////////////////////////////////////////////////////////////
-		// QUADS
-		std::vector<glm::vec4> m_QuadVertexPositions;
-		std::vector< Ref<VertexBuffer> > m_QuadVertexBuffers;
-		std::vector< QuadDrawCommand* > m_CurrentQuadBase;
-		
-		QuadDrawCommand* m_CurrentQuad = nullptr;
-		uint32_t m_QuadIndexCount = 0;
+		// BATCHES
 
-		//////////////////////////////////////////////////////////////////////////
-		// LINES
-		std::vector< Ref<VertexBuffer> > m_LineVertexBuffers;
-		std::vector< LineDrawCommand* > m_CurrentLineBase;
-		
-		LineDrawCommand* m_CurrentLine = nullptr;
-		uint32_t m_LineVertexCount = 0;
+		// Consecutive instances in one buffer that share a set of textures, drawn with one instanced draw call.
+		struct QuadBatch
+		{
+			uint32_t Buffer = 0;
+			uint32_t FirstInstance = 0;
+			uint32_t InstanceCount = 0;
 
-		//////////////////////////////////////////////////////////////////////////
+			// Slot 0 is always the default texture.
+			std::vector< Ref<Texture2D> > Textures;
+		};
+
+		struct LineBatch
+		{
+			uint32_t Buffer = 0;
+			uint32_t VertexCount = 0;
+		};
+
+		// Everything that was submitted for one frame in flight.
+		// Buffers are persistently mapped and only ever grow, so a frame reuses the buffers that the same frame used last time around the ring.
+		struct FrameData
+		{
+			std::vector< Ref<VertexBuffer> > QuadBuffers;
+			std::vector< Ref<VertexBuffer> > LineBuffers;
+
+			std::vector< QuadBatch > QuadBatches;
+			std::vector< LineBatch > LineBatches;
+		};
 
-		std::array<Ref<Texture2D>, 32> m_Textures;
-		uint32_t m_DefaultTextureSlot = 1;
-		uint32_t m_CurrentTextureSlot = 0;
+		std::vector< FrameData > m_Frames;
+
+		uint32_t m_Frame = 0;
+
+		QuadInstance* m_pQuadBase = nullptr;
+		LineDrawCommand* m_pLineBase = nullptr;
+
+		uint32_t m_LastQuadCount = 0;
+		uint32_t m_LastLineCount = 0;
+		uint32_t m_LastDrawCalls = 0;
+
+		//////////////////////////////////////////////////////////////////////////
 
 		glm::mat4 m_CameraView = glm::mat4( 1.0f );
 		glm::mat4 m_CameraViewProjection = glm::mat4( 1.0f );
@@ -139,13 +190,13 @@ namespace Saturn {
 
 		// Quad
 		Ref<Pipeline> m_QuadPipeline = nullptr;
+		Ref<VertexBuffer> m_QuadCornerBuffer = nullptr;
 		Ref<IndexBuffer> m_QuadIndexBuffer = nullptr;
 		Ref<Shader> m_QuadShader = nullptr;
 		Ref<Material> m_QuadMaterial = nullptr;
 
 		// Lines
 		Ref<Pipeline> m_LinePipeline = nullptr;
-		Ref<IndexBuffer> m_LineIndexBuffer = nullptr;
 		Ref<Shader> m_LineShader = nullptr;
 		Ref<Material> m_LineMaterial = nullptr;
 	};
@@ -30,16 +30,23 @@
 #include "SceneRenderer.h"
 
 #include "Saturn/Core/Renderer/RenderThread.h"
+#include "Saturn/Core/JobSystem.h"
+#include "Saturn/Core/Math.h"
 
 #include "VulkanContext.h"
 #include "VulkanDebug.h"
 #include "Texture.h"
 #include "Mesh.h"
 #include "Material.h"
+#include "BindlessTable.h"
+#include "TextureStreamer.h"
+#include "UniformBufferRing.h"
 #include "ComputePipeline.h"
 #include "Renderer2D.h"
+#include "MipGenerator.h"
 #include "Saturn/ImGui/ImGuiAuxiliary.h"
 #include "Saturn/Core/Memory/Buffer.h"
+#include "Saturn/Core/Renderer/IBLPrecompute.h"
 
 #include "Saturn/Core/OptickProfiler.h"
 
@@ -55,6 +62,26 @@ constexpr auto SHADOW_MAP_SIZE = 4096.0f;
 
 namespace Saturn {
 
+	// Quantised static meshes use the same shaders with a different vertex layout, shader_new decodes the normals when QUANTISED_VERTICES is set.
+	static const VkBool32 s_QuantisedVertices = VK_TRUE;
+	static const VkSpecializationMapEntry s_QuantisedVerticesEntry = { 0, 0, sizeof( VkBool32 ) };
+
+	static void SetQuantisedVertexLayout( PipelineSpecification& rSpec )
+	{
+		rSpec.Name += " (Quantised)";
+		rSpec.VertexLayout = {
+			{ ShaderDataType::UShort4Norm, "a_Position" },
+			{ ShaderDataType::Short2Norm, "a_Normal" },
+			{ ShaderDataType::Short2Norm, "a_Tangent" },
+			{ ShaderDataType::Short2Norm, "a_Binormal" },
+			{ ShaderDataType::Half2, "a_TexCoord" }
+		};
+
+		rSpec.SpecializationInfo = { 1, &s_QuantisedVerticesEntry, sizeof( VkBool32 ), &s_QuantisedVertices };
+		rSpec.UseSpecializationInfo = true;
+		rSpec.SpecializationStage = ShaderType::Vertex;
+	}
+
 	//////////////////////////////////////////////////////////////////////////
 
 	SceneRenderer::SceneRenderer( SceneRendererFlags flags )
@@ -81,7 +108,8 @@ namespace Saturn {
 			return;
 
 		m_RendererData.StorageBufferSet = Ref<StorageBufferSet>::Create( 0, 0 );
-		m_RendererData.StorageBufferSet->Create( 0, 14 ); // Create Light culling buffer.
+		m_RendererData.StorageBufferSet->CreatePerFrame( 0, 13 ); // Visible point lights.
+		m_RendererData.StorageBufferSet->CreatePerFrame( 0, 14 ); // Light clusters.
 
 		m_RendererData.IsSwapchainTarget = HasFlag( SceneRendererFlag_SwapchainTarget );
 
@@ -121,9 +149,9 @@ namespace Saturn {
 		}
 
 		m_RendererData.SceneEnvironment = Ref<EnvironmentMap>::Create();
+		m_RendererData.SkyBuilder = Ref<DynamicSkyBuilder>::Create();
 
-		// TODO: Package BRDF texture into AssetBundle in dist
-		m_RendererData.BRDFLUT_Texture = Ref<Texture2D>::Create( "content/textures/BRDF_LUT.tga", AddressingMode::Repeat, false );
+		m_RendererData.BRDFLUT_Texture = CreateBRDFLut();
 
 		m_RendererData.SSAOPassTimer.Reset();
 		m_RendererData.SSAOPassTimer.Stop();
@@ -131,14 +159,10 @@ namespace Saturn {
 		m_RendererData.AOCompositeTimer.Reset();
 		m_RendererData.AOCompositeTimer.Stop();
 
-		constexpr size_t TransformCount = static_cast<size_t>( 1024 ) * 10;
-		m_RendererData.SubmeshTransformData.resize( MAX_FRAMES_IN_FLIGHT );
-		
-		for( uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++ )
-		{
-			m_RendererData.SubmeshTransformData[ i ].VertexBuffer = Ref<VertexBuffer>::Create( sizeof( TransformBufferData ) * TransformCount );
-			m_RendererData.SubmeshTransformData[ i ].pData = new TransformBufferData[ TransformCount ];
-		}
+		m_RendererData.InstanceTransforms = Ref<InstanceBuffer>::Create( 1024 * 10 );
+		m_RendererData.OcclusionBuffer = Ref<OcclusionCuller>::Create();
+		m_RendererData.PointLightClusters = Ref<LightClusters>::Create();
+		m_RendererData.GPUTimer = Ref<GPUProfiler>::Create();
 
 		//////////////////////////////////////////////////////////////////////////
 
@@ -148,6 +172,8 @@ namespace Saturn {
 			Renderer2D::Get().SetInitialRenderPass( m_RendererData.LateCompositePass, m_RendererData.LateCompositeFramebuffer );
 		}
 
+		BuildRenderGraph();
+
 		Renderer::Get().AddShaderReloadCB( SAT_BIND_EVENT_FN( OnShaderReloaded ) );
 	}
 
@@ -209,7 +235,10 @@ namespace Saturn {
 		}
 
 		if( m_RendererData.StaticMeshPipeline )
+		{
 			m_RendererData.StaticMeshPipeline = nullptr;
+			m_RendererData.QuantisedStaticMeshPipeline = nullptr;
+		}
 
 		PipelineSpecification PipelineSpec = {};
 		PipelineSpec.Width = m_RendererData.Width;
@@ -229,12 +258,14 @@ namespace Saturn {
 			{ ShaderDataType::Float4, "a_TransformBufferR1" },
 			{ ShaderDataType::Float4, "a_TransformBufferR2" },
 			{ ShaderDataType::Float4, "a_TransformBufferR3" },
-			{ ShaderDataType::Float4, "a_TransformBufferR4" },
 		};
 		PipelineSpec.CullMode = CullMode::Back;
 		PipelineSpec.FrontFace = VK_FRONT_FACE_CLOCKWISE;
 
 		m_RendererData.StaticMeshPipeline = Ref< Pipeline >::Create( PipelineSpec );
+
+		SetQuantisedVertexLayout( PipelineSpec );
+		m_RendererData.QuantisedStaticMeshPipeline = Ref< Pipeline >::Create( PipelineSpec );
 	}
 
 	void SceneRenderer::InitDirShadowMap()
@@ -242,6 +273,7 @@ namespace Saturn {
 		m_RendererData.ShadowCascades.resize( SHADOW_CASCADE_COUNT );
 		m_RendererData.DirShadowMapPasses.resize( SHADOW_CASCADE_COUNT );
 		m_RendererData.DirShadowMapPipelines.resize( SHADOW_CASCADE_COUNT );
+		m_RendererData.QuantisedDirShadowMapPipelines.resize( SHADOW_CASCADE_COUNT );
 
 		if( !m_RendererData.DirShadowMapShader )
 		{
@@ -264,28 +296,42 @@ namespace Saturn {
 		PipelineSpec.InstanceLayout = {
 			{ ShaderDataType::Float4, "a_TransformBufferR1" },
 			{ ShaderDataType::Float4, "a_TransformBufferR2" },
-			{ ShaderDataType::Float4, "a_TransformBufferR3" },
-			{ ShaderDataType::Float4, "a_TransformBufferR4" }
+			{ ShaderDataType::Float4, "a_TransformBufferR3" }
 		};
 		PipelineSpec.CullMode = CullMode::Back;
 		PipelineSpec.HasColorAttachment = false;
 		PipelineSpec.FrontFace = VK_FRONT_FACE_CLOCKWISE;
 		PipelineSpec.RequestDescriptorSets = { ShaderType::Vertex, 0 };
 
+		PipelineSpecification QuantisedPipelineSpec = PipelineSpec;
+		SetQuantisedVertexLayout( QuantisedPipelineSpec );
+
 		// Layered image
 		Ref<Image2D> shadowImage = Ref<Image2D>::Create( ImageFormat::DEPTH32F, ( uint32_t ) SHADOW_MAP_SIZE, ( uint32_t ) SHADOW_MAP_SIZE, 4 );
 		shadowImage->SetDebugName( "Layered shadow image" );
 
+		// Static casters only, same layout as the shadow image.
+		Ref<Image2D> staticShadowImage = Ref<Image2D>::Create( ImageFormat::DEPTH32F, ( uint32_t ) SHADOW_MAP_SIZE, ( uint32_t ) SHADOW_MAP_SIZE, 4 );
+		staticShadowImage->SetDebugName( "Layered static shadow image" );
+
+		m_RendererData.ShadowImage = shadowImage;
+		m_RendererData.StaticShadowImage = staticShadowImage;
+
 		FramebufferSpecification FBSpec = {};
 		FBSpec.Width = ( uint32_t ) SHADOW_MAP_SIZE;
 		FBSpec.Height = ( uint32_t ) SHADOW_MAP_SIZE;
 		FBSpec.ArrayLevels = SHADOW_CASCADE_COUNT;
-		FBSpec.ExistingImages[0] = shadowImage;
 
 		PassSpecification PassSpec = {};
 		PassSpec.Name = "Dir Shadow Map";
 		PassSpec.Attachments = { ImageFormat::Depth };
 
+		PassSpecification LoadPassSpec = PassSpec;
+		LoadPassSpec.Name = "Dir Shadow Map (Load)";
+		LoadPassSpec.LoadDepth = true;
+
+		m_RendererData.DirShadowMapLoadPass = Ref<Pass>::Create( LoadPassSpec );
+
 		for( size_t i = 0; i < SHADOW_CASCADE_COUNT; i++ )
 		{
 			m_RendererData.DirShadowMapPasses[ i ] = Ref<Pass>::Create( PassSpec );
@@ -294,10 +340,16 @@ namespace Saturn {
 			FBSpec.ExistingImageLayer = ( uint32_t ) i;
 
 			PipelineSpec.RenderPass = m_RendererData.DirShadowMapPasses[ i ];
+			QuantisedPipelineSpec.RenderPass = m_RendererData.DirShadowMapPasses[ i ];
 
+			FBSpec.ExistingImages[ 0 ] = shadowImage;
 			m_RendererData.ShadowCascades[ i ].Framebuffer = Ref<Framebuffer>::Create( FBSpec );
 
+			FBSpec.ExistingImages[ 0 ] = staticShadowImage;
+			m_RendererData.ShadowCascades[ i ].StaticFramebuffer = Ref<Framebuffer>::Create( FBSpec );
+
 			m_RendererData.DirShadowMapPipelines[ i ] = Ref< Pipeline >::Create( PipelineSpec );
+			m_RendererData.QuantisedDirShadowMapPipelines[ i ] = Ref< Pipeline >::Create( QuantisedPipelineSpec );
 		}
 	}
 
@@ -334,12 +386,12 @@ namespace Saturn {
 		if( !m_RendererData.PreDepthShader )
 		{
 			m_RendererData.PreDepthShader = ShaderLibrary::Get().FindOrLoad( "PreDepth", "content/shaders/PreDepth.glsl" );
-			m_RendererData.LightCullingShader = ShaderLibrary::Get().FindOrLoad( "LightCulling", "content/shaders/LightCulling.glsl" );
 		}
 
 		if( m_RendererData.PreDepthPipeline ) 
 		{
 			m_RendererData.PreDepthPipeline = nullptr;
+			m_RendererData.QuantisedPreDepthPipeline = nullptr;
 		}
 
 		PipelineSpecification PipelineSpec = {};
@@ -364,26 +416,13 @@ namespace Saturn {
 		PipelineSpec.InstanceLayout = {
 			{ ShaderDataType::Float4, "a_TransformBufferR1" },
 			{ ShaderDataType::Float4, "a_TransformBufferR2" },
-			{ ShaderDataType::Float4, "a_TransformBufferR3" },
-			{ ShaderDataType::Float4, "a_TransformBufferR4" }
+			{ ShaderDataType::Float4, "a_TransformBufferR3" }
 		};
 
 		m_RendererData.PreDepthPipeline = Ref<Pipeline>::Create( PipelineSpec );
 
-		//////////////////////////////////////////////////////////////////////////
-		// Light culling
-		//////////////////////////////////////////////////////////////////////////
-		if( m_RendererData.LightCullingPipeline )
-			m_RendererData.LightCullingPipeline = nullptr;
-
-		m_RendererData.LightCullingPipeline = Ref<ComputePipeline>::Create( m_RendererData.LightCullingShader );
-
-		if( m_RendererData.LightCullingDescriptorSet )
-			m_RendererData.LightCullingDescriptorSet = nullptr;
-
-		m_RendererData.LightCullingDescriptorSet = m_RendererData.LightCullingShader->CreateDescriptorSet( 0 );
-
-		m_RendererData.LightCullingShader->WriteDescriptor( "u_PreDepth", m_RendererData.PreDepthFramebuffer->GetDepthAttachmentsResource()->GetDescriptorInfo(), m_RendererData.LightCullingDescriptorSet->GetVulkanSet() );
+		SetQuantisedVertexLayout( PipelineSpec );
+		m_RendererData.QuantisedPreDepthPipeline = Ref<Pipeline>::Create( PipelineSpec );
 	}
 
 	void SceneRenderer::InitSceneComposite()
@@ -424,7 +463,7 @@ namespace Saturn {
 			m_RendererData.SC_DescriptorSet = m_RendererData.SceneCompositeShader->CreateDescriptorSet( 0 );
 
 		m_RendererData.SceneCompositeShader->WriteDescriptor( "u_GeometryPassTexture", m_RendererData.GeometryFramebuffer->GetColorAttachmentsResources()[ 0 ]->GetDescriptorInfo(), m_RendererData.SC_DescriptorSet->GetVulkanSet() );
-		m_RendererData.SceneCompositeShader->WriteDescriptor( "u_BloomTexture", m_RendererData.BloomTextures[ 2 ]->GetDescriptorInfo(), m_RendererData.SC_DescriptorSet->GetVulkanSet() );
+		// The bloom texture is written once the render graph is compiled.
 		m_RendererData.SceneCompositeShader->WriteDescriptor( "u_BloomDirtTexture", m_RendererData.BloomDirtTexture->GetDescriptorInfo(), m_RendererData.SC_DescriptorSet->GetVulkanSet() );
 		m_RendererData.SceneCompositeShader->WriteDescriptor( "u_DepthTexture", m_RendererData.GeometryFramebuffer->GetDepthAttachmentsResource()->GetDescriptorInfo(), m_RendererData.SC_DescriptorSet->GetVulkanSet() );
 
@@ -504,7 +543,10 @@ namespace Saturn {
 		}
 
 		if( m_RendererData.PhysicsOutlinePipeline )
+		{
 			m_RendererData.PhysicsOutlinePipeline = nullptr;
+			m_RendererData.QuantisedPhysicsOutlinePipeline = nullptr;
+		}
 
 		PipelineSpecification PipelineSpec = {};
 		PipelineSpec.Width = m_RendererData.Width;
@@ -527,11 +569,13 @@ namespace Saturn {
 		PipelineSpec.InstanceLayout = {
 			{ ShaderDataType::Float4, "a_TransformBufferR1" },
 			{ ShaderDataType::Float4, "a_TransformBufferR2" },
-			{ ShaderDataType::Float4, "a_TransformBufferR3" },
-			{ ShaderDataType::Float4, "a_TransformBufferR4" }
+			{ ShaderDataType::Float4, "a_TransformBufferR3" }
 		};
 
 		m_RendererData.PhysicsOutlinePipeline = Ref<Pipeline>::Create( PipelineSpec );
+
+		SetQuantisedVertexLayout( PipelineSpec );
+		m_RendererData.QuantisedPhysicsOutlinePipeline = Ref<Pipeline>::Create( PipelineSpec );
 	}
 
 	void SceneRenderer::InitBloom()
@@ -548,11 +592,8 @@ namespace Saturn {
 		glm::uvec2 bs = ( viewportSize + 1u ) / 2u;
 		bs += m_RendererData.BloomWorkSize - bs % m_RendererData.BloomWorkSize;
 
-		for( uint32_t i = 0; i < 3; i++ )
-		{
-			m_RendererData.BloomTextures[ i ] = Ref<Texture2D>::Create( ImageFormat::RGBA32F, bs.x, bs.y, nullptr, true );
-			m_RendererData.BloomTextures[ i ]->SetDebugName( "Bloom Texture: " + std::to_string( i ) );
-		}
+		// The images themselves are created by the render graph.
+		m_RendererData.BloomSize = bs;
 
 		m_RendererData.BloomDirtTexture = Renderer::Get().GetPinkTexture();
 
@@ -608,7 +649,7 @@ namespace Saturn {
 	{
 	}
 
-	void SceneRenderer::RenderGrid()
+	void SceneRenderer::RenderGrid( VkCommandBuffer CommandBuffer )
 	{
 		SAT_PF_EVENT();
 
@@ -625,19 +666,15 @@ namespace Saturn {
 		GridMatricesObject.Res = 0.025f;
 		GridMatricesObject.Scale = 16.025f;
 
-		auto Data = m_RendererData.GridShader->MapUB( ShaderType::All, 0, 0 );
-
-		memcpy( Data, &GridMatricesObject, sizeof( GridMatricesObject ) );
-
-		m_RendererData.GridShader->UnmapUB( ShaderType::All, 0, 0 );
+		m_RendererData.GridShader->UploadUB( ShaderType::All, 0, 0, &GridMatricesObject, sizeof( GridMatricesObject ) );
 
 		m_RendererData.GridShader->WriteAllUBs( m_RendererData.GridDescriptorSet );
 
 		Renderer::Get().SubmitFullscreenQuad(
-			m_RendererData.CommandBuffer, m_RendererData.GridPipeline, m_RendererData.GridDescriptorSet, m_RendererData.QuadIndexBuffer, m_RendererData.QuadVertexBuffer );
+			CommandBuffer, m_RendererData.GridPipeline, m_RendererData.GridDescriptorSet, m_RendererData.QuadIndexBuffer, m_RendererData.QuadVertexBuffer );
 	}
 
-	void SceneRenderer::RenderSkybox()
+	void SceneRenderer::RenderSkybox( VkCommandBuffer CommandBuffer )
 	{
 		SAT_PF_EVENT();
 
@@ -664,8 +701,6 @@ namespace Saturn {
 		// Skybox values where set, but check if out textures exist or update them accordingly.
 		CheckInvalidSkybox();
 
-		VkCommandBuffer CommandBuffer = m_RendererData.CommandBuffer;
-
 		auto pAllocator = VulkanContext::Get().GetVulkanAllocator();
 		auto& UBs = m_RendererData.SkyboxDescriptorSet;
 
@@ -817,24 +852,33 @@ namespace Saturn {
 			}
 			radius = std::ceil( radius * 16.0f ) / 16.0f;
 
-			glm::vec3 maxExtents = glm::vec3( radius );
-			glm::vec3 minExtents = -maxExtents;
+			// Keep the last radius while it still covers the slice, small float changes would otherwise invalidate the static shadow cache.
+			float lastRadius = m_RendererData.ShadowCascades[ i ].Radius;
+			if( lastRadius >= radius && lastRadius - radius < 0.25f )
+				radius = lastRadius;
 
 			glm::vec3 lightDir = -Direction;
-			glm::mat4 lightViewMatrix = glm::lookAt( frustumCenter - lightDir * -minExtents.z, frustumCenter, glm::vec3( 0.0f, 0.0f, 1.0f ) );
-			glm::mat4 lightOrthoMatrix = glm::ortho( minExtents.x, maxExtents.x, minExtents.y, maxExtents.y, 0.0f + -15.0f, maxExtents.z - minExtents.z + 15.0f );
+			glm::mat4 lightViewMatrix = glm::lookAt( glm::vec3( 0.0f ), lightDir, glm::vec3( 0.0f, 0.0f, 1.0f ) );
+
+			// Keep the cascade on a fixed light space grid. x and y snap to whole texels, this avoids shimmering and lets the static cache scroll.
+			// Depth snaps to steps of the radius so that the depth range only changes after the camera moved far along the light.
+			glm::vec3 lightCenter = glm::vec3( lightViewMatrix * glm::vec4( frustumCenter, 1.0f ) );
+			float texelSize = ( radius * 2.0f ) / SHADOW_MAP_SIZE;
+
+			glm::ivec3 origin;
+			origin.x = ( int ) std::floor( lightCenter.x / texelSize );
+			origin.y = ( int ) std::floor( lightCenter.y / texelSize );
+			origin.z = ( int ) std::floor( -lightCenter.z / radius );
+
+			float left = origin.x * texelSize - radius;
+			float bottom = origin.y * texelSize - radius;
+			float nearDepth = origin.z * radius - radius - 15.0f;
+			float farDepth = ( origin.z + 1 ) * radius + radius + 15.0f;
 
-			// Offset to texel space to avoid shimmering (from https://stackoverflow.com/questions/33499053/cascaded-shadow-map-shimmering)
-			glm::mat4 shadowMatrix = lightOrthoMatrix * lightViewMatrix;
-			float ShadowMapResolution = SHADOW_MAP_SIZE;
-			glm::vec4 shadowOrigin = ( shadowMatrix * glm::vec4( 0.0f, 0.0f, 0.0f, 1.0f ) ) * ShadowMapResolution / 2.0f;
-			glm::vec4 roundedOrigin = glm::round( shadowOrigin );
-			glm::vec4 roundOffset = roundedOrigin - shadowOrigin;
-			roundOffset = roundOffset * 2.0f / ShadowMapResolution;
-			roundOffset.z = 0.0f;
-			roundOffset.w = 0.0f;
+			glm::mat4 lightOrthoMatrix = glm::ortho( left, left + radius * 2.0f, bottom, bottom + radius * 2.0f, nearDepth, farDepth );
 
-			lightOrthoMatrix[ 3 ] += roundOffset;
+			m_RendererData.ShadowCascades[ i ].Origin = origin;
+			m_RendererData.ShadowCascades[ i ].Radius = radius;
 
 			// Store split distance and matrix in cascade
 			m_RendererData.ShadowCascades[ i ].SplitDepth = ( NEAR_CLIP + splitDist * CLIP_RANGE ) * -1.0f;
@@ -895,20 +939,13 @@ namespace Saturn {
 
 		// Create skybox shader.
 
-		if( !m_RendererData.SkyboxShader && !m_RendererData.PreethamShader )
-		{
+		if( !m_RendererData.SkyboxShader )
 			m_RendererData.SkyboxShader = ShaderLibrary::Get().FindOrLoad( "Skybox", "content/shaders/Skybox.glsl" );
-			m_RendererData.PreethamShader = ShaderLibrary::Get().FindOrLoad( "Skybox_Compute", "content/shaders/Skybox_Compute.glsl" );
-		}
 
 		if( !m_RendererData.SkyboxDescriptorSet )
 			m_RendererData.SkyboxDescriptorSet = m_RendererData.SkyboxShader->CreateDescriptorSet( 0 );
 
-		if( !m_RendererData.PreethamDescriptorSet )
-			m_RendererData.PreethamDescriptorSet = m_RendererData.PreethamShader->CreateDescriptorSet( 0 );
-
 		m_RendererData.SkyboxShader->WriteAllUBs( m_RendererData.SkyboxDescriptorSet );
-		m_RendererData.PreethamShader->WriteAllUBs( m_RendererData.PreethamDescriptorSet );
 
 		if( m_RendererData.SkyboxPipeline )
 			m_RendererData.SkyboxPipeline = nullptr;
@@ -955,15 +992,53 @@ namespace Saturn {
 
 			ImGui::Text( "Renderer::BeginFrame: %.2f ms", FrameTimings.first );
 
-			ImGui::Text( "SceneRenderer::PreDepthPass: %.2f ms", m_RendererData.PreDepthTimer.ElapsedMilliseconds() );
+			auto& rGPUTimer = m_RendererData.GPUTimer;
+
+			ImGui::Text( "SceneRenderer::PreDepthPass: %.2f ms (GPU: %.2f ms)", m_RendererData.PreDepthTimer.ElapsedMilliseconds(), rGPUTimer->GetTime( "PreDepth" ) );
+
+			ImGui::Text( "SceneRenderer::ShadowMapPass: %.2f ms (GPU: %.2f ms)", shadowPassTime, rGPUTimer->GetTime( "ShadowMap" ) );
+
+			if( m_RendererData.EnableShadows && m_RendererData.EnableStaticShadowCache )
+			{
+				ImGui::Text( "Shadow cascades: %u rebuilt, %u scrolled, %u reused", m_RendererData.ShadowCascadesRebuilt, m_RendererData.ShadowCascadesScrolled, m_RendererData.ShadowCascadesReused );
+			}
+
+			ImGui::Text( "SceneRenderer::LightCulling: %.4f ms (GPU: %.4f ms)", m_RendererData.LightCullingTimer.ElapsedMilliseconds(), rGPUTimer->GetTime( "LightCulling" ) );
+
+			ImGui::Text( "Renderer2D: %u quads, %u lines, %u draw calls", Renderer2D::Get().GetQuadCount(), Renderer2D::Get().GetLineCount(), Renderer2D::Get().GetDrawCalls() );
+
+			ImGui::Text( "Secondary command buffers: %u", Renderer::Get().GetSecondaryRecorder()->GetSecondaryCount() );
+
+			UniformBufferRing* pUniformRing = VulkanContext::Get().GetUniformBufferRing();
+			ImGui::Text( "Uniform data: %.1f KB last frame, %.1f KB peak (%.0f KB per frame)", ( float ) pUniformRing->GetLastFrameBytes() / 1024.0f, ( float ) pUniformRing->GetPeakFrameBytes() / 1024.0f, ( float ) UniformBufferRing::FrameSize / 1024.0f );
+
+			if( const auto& rClusters = m_RendererData.PointLightClusters )
+			{
+				ImGui::Text( "Point lights: %u / %u visible", ( uint32_t ) rClusters->GetVisibleLights().size(), ( uint32_t ) m_RendererData.PointLightSpheres.size() );
+				ImGui::Text( "Light clusters: %u indices in %u clusters (max %u per cluster)", rClusters->GetIndexCount(), rClusters->GetClusterCount(), rClusters->GetMaxLightsPerCluster() );
+			}
+
+			ImGui::Text( "SceneRenderer::GeometryPass: %.2f ms (GPU: %.2f ms)", m_RendererData.GeometryPassTimer.ElapsedMilliseconds(), rGPUTimer->GetTime( "Geometry" ) );
 
-			ImGui::Text( "SceneRenderer::ShadowMapPass: %.2f ms", shadowPassTime );
+			ImGui::Text( "SceneRenderer::BlomPass: %.3f ms (GPU: %.3f ms)", m_RendererData.BloomTimer.ElapsedMilliseconds(), rGPUTimer->GetTime( "Bloom" ) + rGPUTimer->GetTime( "BloomUpsample" ) );
 
-			ImGui::Text( "SceneRenderer::LightCulling: %.4f ms", m_RendererData.LightCullingTimer.ElapsedMilliseconds() );
+			if( const auto& rInstances = m_RendererData.InstanceTransforms )
+			{
+				ImGui::Text( "Instance slots: %u / %u", rInstances->GetLiveCount(), rInstances->GetCapacity() );
+				ImGui::Text( "Instance uploads: %u slots (%u bytes) in %u copies", rInstances->GetUploadedSlots(), rInstances->GetUploadedSlots() * ( uint32_t ) sizeof( TransformBufferData ), rInstances->GetCopyRegions() );
+			}
 
-			ImGui::Text( "SceneRenderer::GeometryPass: %.2f ms", m_RendererData.GeometryPassTimer.ElapsedMilliseconds() );
+			ImGui::Text( "Static mesh triangles: %u (%u without LODs)", m_RendererData.LastLodTriangles, m_RendererData.LastFullDetailTriangles );
+
+			if( m_RendererData.EnableOcclusionCulling )
+			{
+				const auto& rCuller = m_RendererData.OcclusionBuffer;
+				ImGui::Text( "Occlusion culling: %u / %u submeshes culled in %.2f ms", m_RendererData.LastOcclusionCulled, m_RendererData.LastOcclusionTested, m_RendererData.LastOcclusionTime );
+				ImGui::Text( "Occluders: %u (%u / %u triangles rasterised)", rCuller->GetOccluderCount(), rCuller->GetRasterisedTriangles(), rCuller->GetOccluderTriangles() );
+			}
 
-			ImGui::Text( "SceneRenderer::BlomPass: %.3f ms", m_RendererData.BloomTimer.ElapsedMilliseconds() );
+			if( m_RendererData.LastInstancesTested )
+				ImGui::Text( "Instanced meshes: %u / %u instances culled", m_RendererData.LastInstancesCulled, m_RendererData.LastInstancesTested );
 
 			ImGui::Text( "Renderer::EndFrame - Queue Present: %.2f ms", Renderer::Get().GetQueuePresentTime() );
 
@@ -977,6 +1052,52 @@ namespace Saturn {
 				m_RendererData.SceneCompositeFramebuffer->Screenshot( 0, "SceneComp.png" );
 			}
 
+			if( Auxiliary::TreeNode( "GPU pass times", false ) )
+			{
+				if( !rGPUTimer->IsSupported() )
+					ImGui::Text( "Timestamps are not supported on the graphics queue." );
+
+				for( const auto& rResult : rGPUTimer->GetResults() )
+				{
+					ImGui::Indent( rResult.Depth * 10.0f + 1.0f );
+					ImGui::Text( "%s: %.3f ms", rResult.Name.c_str(), rResult.Milliseconds );
+					ImGui::Unindent( rResult.Depth * 10.0f + 1.0f );
+				}
+
+				ImGui::Checkbox( "Record pass times", &m_RendererData.RecordPassTimings );
+
+				ImGui::SameLine();
+				ImGui::Text( "(%u samples)", ( uint32_t ) m_RendererData.PassTimingCapture.size() );
+
+				if( ImGui::Button( "Export CSV" ) )
+				{
+					ExportPassTimings( "PassTimings.csv" );
+				}
+
+				ImGui::SameLine();
+
+				if( ImGui::Button( "Capture draw list" ) )
+				{
+					CaptureDrawList( "DrawList.satcap" );
+				}
+
+#if defined( TRACY_ENABLE )
+				bool TracyZones = rGPUTimer->GetTracyZonesEnabled();
+
+				if( ImGui::Checkbox( "Tracy GPU zones", &TracyZones ) )
+					rGPUTimer->SetTracyZonesEnabled( TracyZones );
+#endif
+
+				Auxiliary::EndTreeNode();
+			}
+
+			if( Auxiliary::TreeNode( "Render graph", false ) )
+			{
+				m_RendererData.Graph->ImGuiRender();
+
+				Auxiliary::EndTreeNode();
+			}
+
 			Auxiliary::EndTreeNode();
 		}
 
@@ -999,6 +1120,12 @@ namespace Saturn {
 
 				ImGui::Checkbox( "Enable shadows", &m_RendererData.EnableShadows );
 
+				if( ImGui::Checkbox( "Cache static shadows", &m_RendererData.EnableStaticShadowCache ) )
+				{
+					for( auto& rCascade : m_RendererData.ShadowCascades )
+						rCascade.StaticCacheValid = false;
+				}
+
 				static int index = 0;
 				auto framebuffer = m_RendererData.ShadowCascades[ index ].Framebuffer->GetDepthAttachmentsResource();
 
@@ -1013,18 +1140,63 @@ namespace Saturn {
 
 			if( Auxiliary::TreeNode( "Bloom settings", false ) )
 			{
-				static int index = 0;
-				static int MipIndex = 0;
-				auto& img = m_RendererData.BloomTextures[ index ];
+				// Every bloom image is a render graph transient and shares its memory, so there is nothing to preview here.
+				ImGui::Text( "Bloom images: %u x %u", m_RendererData.BloomSize.x, m_RendererData.BloomSize.y );
 
-				ImGui::SliderInt( "##bloom_tex", &index, 0, 2 );
-				ImGui::SliderInt( "##mip", &MipIndex, 0, img->GetMipMapLevels() - 2 );
+				ImGui::SliderFloat( "##dirtint", &m_RendererData.BloomDirtIntensity, 0, 1000.0f );
 
-				float size = ImGui::GetContentRegionAvail().x;
+				Auxiliary::EndTreeNode();
+			}
 
-				Auxiliary::Image( img, MipIndex, { size, size }, { 0, 1 }, { 1, 0 } );
+			if( Auxiliary::TreeNode( "LOD settings", false ) )
+			{
+				ImGui::Checkbox( "Enable LODs", &m_RendererData.EnableLods );
+				ImGui::DragFloat( "Pixel error", &m_RendererData.LodPixelError, 0.05f, 0.0f, 64.0f );
+				ImGui::DragFloat( "Hysteresis", &m_RendererData.LodHysteresis, 0.01f, 0.0f, 0.9f );
 
-				ImGui::SliderFloat( "##dirtint", &m_RendererData.BloomDirtIntensity, 0, 1000.0f );
+				Auxiliary::EndTreeNode();
+			}
+
+			if( Auxiliary::TreeNode( "Command recording", false ) )
+			{
+				auto& rRecorder = Renderer::Get().GetSecondaryRecorder();
+
+				bool Parallel = rRecorder->IsParallel();
+				if( ImGui::Checkbox( "Parallel recording", &Parallel ) )
+					rRecorder->SetParallel( Parallel );
+
+				int DrawsPerSecondary = ( int ) m_RendererData.DrawsPerSecondary;
+				if( ImGui::DragInt( "Draws per secondary", &DrawsPerSecondary, 1.0f, 1, 4096 ) )
+					m_RendererData.DrawsPerSecondary = ( uint32_t ) DrawsPerSecondary;
+
+				Auxiliary::EndTreeNode();
+			}
+
+			if( Auxiliary::TreeNode( "Texture streaming", false ) )
+			{
+				TextureStreamer* pStreamer = VulkanContext::Get().GetTextureStreamer();
+
+				ImGui::Checkbox( "Request mips from screen size", &m_RendererData.EnableTextureStreaming );
+				ImGui::DragFloat( "Mip bias", &m_RendererData.TextureMipBias, 0.05f, -4.0f, 8.0f );
+
+				int BudgetMB = ( int ) ( pStreamer->GetBudget() / ( 1024 * 1024 ) );
+				if( ImGui::DragInt( "VRAM budget (MB)", &BudgetMB, 8.0f, 16, 16384 ) )
+					pStreamer->SetBudget( ( VkDeviceSize ) BudgetMB * 1024 * 1024 );
+
+				ImGui::Text( "%u streamed textures, %.1f MB resident, %u loads in flight", pStreamer->GetTextureCount(), ( float ) pStreamer->GetResidentBytes() / ( 1024.0f * 1024.0f ), pStreamer->GetLoadsInFlight() );
+
+				Auxiliary::EndTreeNode();
+			}
+
+			if( Auxiliary::TreeNode( "Occlusion culling", false ) )
+			{
+				ImGui::Checkbox( "Enable occlusion culling", &m_RendererData.EnableOcclusionCulling );
+				ImGui::Checkbox( "Automatic occluders", &m_RendererData.AutomaticOccluders );
+				ImGui::DragFloat( "Occluder screen radius", &m_RendererData.OccluderScreenRadius, 1.0f, 0.0f, 4096.0f );
+
+				int MaxTriangles = ( int ) m_RendererData.MaxOccluderTriangles;
+				if( ImGui::DragInt( "Max occluder triangles", &MaxTriangles, 100.0f, 0, 1000000 ) )
+					m_RendererData.MaxOccluderTriangles = ( uint32_t ) MaxTriangles;
 
 				Auxiliary::EndTreeNode();
 			}
@@ -1066,234 +1238,588 @@ namespace Saturn {
 		}
 	}
 
-	void SceneRenderer::SubmitStaticMesh( Ref<Entity> entity, Ref< StaticMesh > mesh, Ref<MaterialRegistry> materialRegistry, const glm::mat4& transform )
+	void SceneRenderer::SubmitStaticMesh( Ref<Entity> entity, Ref< StaticMesh > mesh, Ref<MaterialRegistry> materialRegistry, const glm::mat4& transform, bool Occluder, Mobility MeshMobility )
 	{
 		SAT_PF_EVENT();
 
-		auto& id = mesh->ID;
+		if( m_CapturingDrawList )
+			CaptureSubmission( entity, mesh, materialRegistry, transform, Occluder, MeshMobility == Mobility::Static, false );
 
 		auto& submeshes = mesh->Submeshes();
 		for( size_t i = 0; i < submeshes.size(); i++ )
 		{
-			StaticMeshKey key = { mesh->ID, materialRegistry, (uint32_t)i };
+			PendingSubmesh Submesh;
+			Submesh.entity = entity;
+			Submesh.Mesh = mesh;
+			Submesh.Registry = materialRegistry;
+			Submesh.SubmeshIndex = ( uint32_t ) i;
+			Submesh.Transform = transform * submeshes[ i ].Transform;
+			Submesh.Occluder = Occluder;
+			Submesh.Static = MeshMobility == Mobility::Static;
 
-			glm::mat4 submeshTransform = transform * submeshes[ i ].Transform;
+			size_t InstanceID = ( size_t ) entity->GetUUID() ^ ( ( size_t ) mesh->ID << 1 ) ^ ( i << 48 );
 
-			auto& command = m_DrawList[ key ];
-			command.entity = entity;
-			command.Mesh = mesh;
-			command.SubmeshIndex = ( uint32_t ) i;
-			command.Instances++;
+			// The replay needs the LOD history to pick the same LODs.
+			if( m_CapturingDrawList )
+			{
+				auto Itr = m_PreviousLods.find( InstanceID );
+				m_DrawListCapture.PreviousLods.push_back( Itr != m_PreviousLods.end() ? Itr->second : UINT32_MAX );
+			}
 
-			auto& shadow = m_ShadowMapDrawList[ key ];
-			shadow.entity = entity;
-			shadow.Mesh = mesh;
-			shadow.SubmeshIndex = ( uint32_t ) i;
-			shadow.Instances++;
+			Submesh.LodIndex = SelectLod( submeshes[ i ], Submesh.Transform, InstanceID );
 
-			auto& data = m_RendererData.MeshTransforms[ key ].Data.emplace_back();
-			data.TransfromBufferR[ 0 ] = {
-				submeshTransform[ 0 ][ 0 ], submeshTransform[ 1 ][ 0 ], submeshTransform[ 2 ][ 0 ], submeshTransform[ 3 ][ 0 ]
-			};
-			data.TransfromBufferR[ 1 ] = {
-				submeshTransform[ 0 ][ 1 ], submeshTransform[ 1 ][ 1 ], submeshTransform[ 2 ][ 1 ], submeshTransform[ 3 ][ 1 ]
-			};
-			data.TransfromBufferR[ 2 ] = {
-				submeshTransform[ 0 ][ 2 ], submeshTransform[ 1 ][ 2 ], submeshTransform[ 2 ][ 2 ], submeshTransform[ 3 ][ 2 ]
-			};
-			data.TransfromBufferR[ 3 ] = {
-				submeshTransform[ 0 ][ 3 ], submeshTransform[ 1 ][ 3 ], submeshTransform[ 2 ][ 3 ], submeshTransform[ 3 ][ 3 ]
-			};
+			// Visibility is only known once every occluder has been submitted.
+			if( m_RendererData.EnableOcclusionCulling )
+				m_PendingSubmeshes.push_back( Submesh );
+			else
+				AddStaticSubmesh( Submesh, true );
 		}
 	}
 
-	void SceneRenderer::SubmitPhysicsCollider( Ref<Entity> entity, Ref< StaticMesh > mesh, Ref<MaterialRegistry> materialRegistry, const glm::mat4& transform )
+	void SceneRenderer::SubmitInstancedStaticMesh( Ref<Entity> entity, Ref< StaticMesh > mesh, Ref<MaterialRegistry> materialRegistry, Ref<InstanceClusterTree> clusters, const glm::mat4& transform, bool CastShadows, Mobility MeshMobility )
 	{
 		SAT_PF_EVENT();
 
-		auto& id = mesh->ID;
-		auto& submeshes = mesh->Submeshes();
-		for( size_t i = 0; i < submeshes.size(); i++ )
-		{
-			StaticMeshKey key = { mesh->ID, materialRegistry, ( uint32_t ) i };
+		if( !clusters || clusters->GetInstanceCount() == 0 )
+			return;
 
-			auto& command = m_PhysicsColliderDrawList[ key ];
-			command.entity = entity;
-			command.Mesh = mesh;
-			command.SubmeshIndex = ( uint32_t ) i;
-			command.Instances++;
-		}
+		PendingInstancedMesh& rPending = m_PendingInstancedMeshes.emplace_back();
+		rPending.entity = entity;
+		rPending.Mesh = mesh;
+		rPending.Registry = materialRegistry;
+		rPending.Clusters = clusters;
+		rPending.Transform = transform;
+		rPending.CastShadows = CastShadows;
+		rPending.Static = MeshMobility == Mobility::Static;
 	}
 
-	void SceneRenderer::SetViewportSize( uint32_t w, uint32_t h )
+	// Identifies a static shadow caster and where it is, the per frame sum of these tells the shadow cache when a static caster was added, removed or moved.
+	static size_t HashShadowCaster( const PendingSubmesh& rSubmesh )
 	{
-		if( m_RendererData.Width != w && m_RendererData.Height != h )
-		{
-			m_RendererData.Width = w;
-			m_RendererData.Height = h;
-			m_RendererData.Resized = true;
-		}
+		Math::HashBuilder Hash;
+		Hash.Combine( ( size_t ) rSubmesh.entity->GetUUID() );
+		Hash.Combine( ( size_t ) rSubmesh.Mesh->ID );
+		Hash.Combine( rSubmesh.SubmeshIndex );
+		Hash.Combine( rSubmesh.Transform );
+
+		return Hash.Hash;
 	}
 
-	void SceneRenderer::Recreate()
+	void SceneRenderer::AddStaticSubmesh( const PendingSubmesh& rSubmesh, bool Visible )
 	{
-		InitPreDepth();
-
-		InitGeometryPass();
-
-		InitSceneComposite();
-		InitLateComposite();
-		InitPhysicsOutline();
-		
-		InitTexturePass();
+		const Submesh& rMeshSubmesh = rSubmesh.Mesh->Submeshes()[ rSubmesh.SubmeshIndex ];
 
-		const glm::uvec2 viewportSize = { m_RendererData.Width, m_RendererData.Height };
+		StaticMeshKey key = { rSubmesh.Mesh->ID, rSubmesh.Registry, rSubmesh.SubmeshIndex, rSubmesh.LodIndex };
+		key.Static = rSubmesh.Static;
 
-		glm::uvec2 bs = ( viewportSize + 1u ) / 2u;
-		bs += m_RendererData.BloomWorkSize - bs % m_RendererData.BloomWorkSize;
+		if( rSubmesh.Static )
+			m_RendererData.StaticCasterHash += HashShadowCaster( rSubmesh );
 
-		for( uint32_t i = 0; i < 3; i++ )
+		if( Visible )
 		{
-			m_RendererData.BloomTextures[ i ]->Terminate();
+			m_RendererData.LodTriangles += rMeshSubmesh.GetLod( rSubmesh.LodIndex ).IndexCount / 3;
+			m_RendererData.FullDetailTriangles += rMeshSubmesh.IndexCount / 3;
 
-			m_RendererData.BloomTextures[ i ] = Ref<Texture2D>::Create( ImageFormat::RGBA32F, bs.x, bs.y, nullptr, true );
-			m_RendererData.BloomTextures[ i ]->SetDebugName( "Bloom Texture: " + std::to_string( i ) );
+			RequestTextureMips( rSubmesh );
 		}
 
-		constexpr uint32_t TILE_SIZE = 16;
-		glm::uvec2 Viewport = { m_RendererData.Width, m_RendererData.Height };
-		glm::uvec2 Size = Viewport;
-		Size += TILE_SIZE - Viewport % TILE_SIZE;
+		StaticMeshSelection::AddToDrawLists( key, Visible, m_DrawList, m_ShadowMapDrawList, [&]( DrawCommand& rCommand )
+			{
+				rCommand.entity = rSubmesh.entity;
+				rCommand.Mesh = rSubmesh.Mesh;
+				rCommand.SubmeshIndex = rSubmesh.SubmeshIndex;
+				rCommand.LodIndex = rSubmesh.LodIndex;
+				rCommand.Instances++;
+			} );
 
-		m_RendererData.LightCullingWorkGroups = { Size / TILE_SIZE, 1 };
+		const glm::mat4 Transform = StaticMeshSelection::GetInstanceTransform( rMeshSubmesh, rSubmesh.Transform, rSubmesh.Mesh->IsQuantised() );
 
-		float size = m_RendererData.LightCullingWorkGroups.x * m_RendererData.LightCullingWorkGroups.y * 4.0f * 1024.0f;
-		m_RendererData.StorageBufferSet->Resize( 0, 14, ( size_t ) size );
+		m_RendererData.InstanceTransforms->Submit( rSubmesh.entity->GetUUID(), key, Transform );
+	}
 
-		m_RendererData.SceneCompositeShader->WriteDescriptor( "u_BloomTexture", m_RendererData.BloomTextures[ 2 ]->GetDescriptorInfo(), m_RendererData.SC_DescriptorSet->GetVulkanSet() );
+	void SceneRenderer::RequestTextureMips( const PendingSubmesh& rSubmesh )
+	{
+		TextureStreamer* pStreamer = VulkanContext::Get().GetTextureStreamer();
 
-		CreateSkyboxComponents();
-		CreateGridComponents();
+		if( !m_RendererData.EnableTextureStreaming || !pStreamer || m_RendererData.LodProjectionScale <= 0.0f )
+			return;
 
-		Renderer2D::Get().SetInitialRenderPass( m_RendererData.LateCompositePass, m_RendererData.LateCompositeFramebuffer );
-	}
+		const Submesh& rMeshSubmesh = rSubmesh.Mesh->Submeshes()[ rSubmesh.SubmeshIndex ];
+		const glm::mat4& rTransform = rSubmesh.Transform;
 
-	//////////////////////////////////////////////////////////////////////////
-	// RENDERER SHADER 
-	//////////////////////////////////////////////////////////////////////////
+		glm::vec3 Center = ( rMeshSubmesh.BoundingBox.Min + rMeshSubmesh.BoundingBox.Max ) * 0.5f;
+		float Radius = glm::length( rMeshSubmesh.BoundingBox.Max - rMeshSubmesh.BoundingBox.Min ) * 0.5f;
 
-	// Vertex, Binding 1
-	struct LightData
-	{
-		glm::mat4 LightMatrix[ 4 ];
-	};
+		glm::vec3 WorldCenter = glm::vec3( rTransform * glm::vec4( Center, 1.0f ) );
+		float WorldRadius = Radius * StaticMeshSelection::MaxScale( rTransform );
+		float Distance = glm::length( WorldCenter - m_RendererData.LodCameraPosition );
 
-	// Fragment, Binding 2
-	struct SceneData
-	{
-		DirLight Lights;
-		glm::vec3 CameraPosition;
-	};
+		// Assume the texture is spread over the submesh once, so the diameter on screen is how many texels across can be seen.
+		// Inside the bounds the submesh can cover the whole screen.
+		float ScreenDiameter = Distance <= WorldRadius ? ( float ) glm::max( m_RendererData.Width, m_RendererData.Height ) : 2.0f * WorldRadius * m_RendererData.LodProjectionScale / Distance;
+		ScreenDiameter = glm::max( ScreenDiameter, 1.0f );
 
-	// Fragment, Binding 3
-	struct ShadowData
-	{
-		glm::vec4 CascadeSplits;
-	};
+		auto& rMaterial = rSubmesh.Registry->GetMaterials()[ rMeshSubmesh.MaterialIndex ];
 
-	void SceneRenderer::GeometryPass()
+		for( const Ref<Texture2D>& rTexture : rMaterial->GetStreamedTextures() )
+		{
+			float TexelsPerPixel = ( float ) glm::max( rTexture->Width(), rTexture->Height() ) / ScreenDiameter;
+			float Mip = glm::floor( glm::log2( glm::max( TexelsPerPixel, 1.0f ) ) + m_RendererData.TextureMipBias );
+
+			m_TextureRequests.push_back( { .pTexture = rTexture.Get(), .Mip = ( uint32_t ) glm::max( Mip, 0.0f ), .ScreenCoverage = ScreenDiameter } );
+		}
+	}
+
+	void SceneRenderer::CullStaticMeshes()
 	{
 		SAT_PF_EVENT();
 
-		m_RendererData.GeometryPassTimer.Reset();
+		if( m_PendingSubmeshes.empty() )
+			return;
 
-		VkExtent2D Extent = { m_RendererData.Width, m_RendererData.Height };
+		Timer CullTimer;
 
-		// Begin geometry pass.
-		m_RendererData.GeometryPass->BeginPass( m_RendererData.CommandBuffer, m_RendererData.GeometryFramebuffer->GetVulkanFramebuffer(), Extent );
+		auto& rCuller = *m_RendererData.OcclusionBuffer;
+		rCuller.BeginFrame( m_RendererData.CurrentCamera.Camera.ProjectionMatrix() * m_RendererData.CurrentCamera.ViewMatrix );
 
-		VkViewport Viewport = {};
-		Viewport.x = 0;
-		Viewport.y = 0;
-		Viewport.width = ( float ) m_RendererData.Width;
-		Viewport.height = ( float ) m_RendererData.Height;
-		Viewport.minDepth = 0.0f;
-		Viewport.maxDepth = 1.0f;
+		// Pick the occluders.
+		const StaticMeshSelectionSettings Settings = GetSelectionSettings();
+		uint32_t OccluderTriangles = 0;
 
-		VkRect2D Scissor = { .offset = { 0, 0 }, .extent = Extent };
+		for( const auto& rPending : m_PendingSubmeshes )
+		{
+			const Submesh& rSubmesh = rPending.Mesh->Submeshes()[ rPending.SubmeshIndex ];
+			const auto& rVertices = rPending.Mesh->Vertices();
 
-		vkCmdSetScissor( m_RendererData.CommandBuffer, 0, 1, &Scissor );
-		vkCmdSetViewport( m_RendererData.CommandBuffer, 0, 1, &Viewport );
+			if( rVertices.empty() || !StaticMeshSelection::SelectOccluder( rSubmesh, rPending.LodIndex, rPending.Transform, rPending.Occluder, OccluderTriangles, Settings ) )
+				continue;
 
-		//////////////////////////////////////////////////////////////////////////
-		// Actual geometry pass.
-		//////////////////////////////////////////////////////////////////////////
+			SubmeshLod Lod = rSubmesh.GetLod( rPending.LodIndex );
+			const uint32_t* pIndices = reinterpret_cast< const uint32_t* >( rPending.Mesh->Indices().data() ) + Lod.BaseIndex;
 
-		CmdBeginDebugLabel( m_RendererData.CommandBuffer, "Skybox" );
+			rCuller.AddOccluder( &rVertices[ rSubmesh.BaseVertex ].Position, sizeof( StaticVertex ), pIndices, Lod.IndexCount, rPending.Transform );
+		}
 
-		RenderSkybox();
+		rCuller.Rasterise();
+		m_OcclusionBufferReady = true;
 
-		CmdEndDebugLabel( m_RendererData.CommandBuffer );
+		std::vector<uint8_t> Visible( m_PendingSubmeshes.size() );
 
-		CmdBeginDebugLabel( m_RendererData.CommandBuffer, "Grid" );
+		JobSystem::Get().ParallelFor( ( uint32_t ) m_PendingSubmeshes.size(), 64, [&]( uint32_t Begin, uint32_t End )
+			{
+				for( uint32_t i = Begin; i < End; i++ )
+				{
+					const auto& rPending = m_PendingSubmeshes[ i ];
+					Visible[ i ] = rCuller.IsVisible( rPending.Mesh->Submeshes()[ rPending.SubmeshIndex ].BoundingBox, rPending.Transform );
+				}
+			} );
 
-		RenderGrid();
+		for( size_t i = 0; i < m_PendingSubmeshes.size(); i++ )
+		{
+			AddStaticSubmesh( m_PendingSubmeshes[ i ], Visible[ i ] );
 
-		CmdEndDebugLabel( m_RendererData.CommandBuffer );
+			if( !Visible[ i ] )
+				m_RendererData.OcclusionCulled++;
+		}
 
-		CmdBeginDebugLabel( m_RendererData.CommandBuffer, "Static meshes" );
-		
-		// Set environment resource.
-		Renderer::Get().SetSceneEnvironment( m_RendererData.ShadowCascades[ 0 ].Framebuffer->GetDepthAttachmentsResource(), m_RendererData.SceneEnvironment, m_RendererData.BRDFLUT_Texture );
+		m_RendererData.OcclusionTested += ( uint32_t ) m_PendingSubmeshes.size();
+		m_PendingSubmeshes.clear();
 
-		RenderStaticMeshes();
+		m_RendererData.LastOcclusionTime = CullTimer.ElapsedMilliseconds();
+	}
 
-		CmdEndDebugLabel( m_RendererData.CommandBuffer );
+	// Used for the clusters when there is no occlusion buffer this frame.
+	static bool IsInFrustum( const AABB& rBounds, const glm::mat4& rLocalToClip )
+	{
+		// Outside when every corner is outside of the same plane.
+		uint32_t OutsideMask = 0x3F;
 
-		//////////////////////////////////////////////////////////////////////////
+		for( uint32_t i = 0; i < 8; i++ )
+		{
+			glm::vec3 Corner = { i & 1 ? rBounds.Max.x : rBounds.Min.x, i & 2 ? rBounds.Max.y : rBounds.Min.y, i & 4 ? rBounds.Max.z : rBounds.Min.z };
+			glm::vec4 Clip = rLocalToClip * glm::vec4( Corner, 1.0f );
 
-		// End geometry pass.
-		m_RendererData.GeometryPass->EndPass();
+			uint32_t Mask = 0;
+			Mask |= Clip.x < -Clip.w ? 1 : 0;
+			Mask |= Clip.x > Clip.w ? 2 : 0;
+			Mask |= Clip.y < -Clip.w ? 4 : 0;
+			Mask |= Clip.y > Clip.w ? 8 : 0;
+			Mask |= Clip.z < 0.0f ? 16 : 0;
+			Mask |= Clip.z > Clip.w ? 32 : 0;
 
-		m_RendererData.GeometryPassTimer.Stop();
+			OutsideMask &= Mask;
+		}
+
+		return OutsideMask == 0;
 	}
 
-	void SceneRenderer::RenderStaticMeshes()
+	void SceneRenderer::AddInstancedStaticMeshes()
 	{
-		uint32_t frame = Renderer::Get().GetCurrentFrame();
+		SAT_PF_EVENT();
 
-		Ref< Shader > StaticMeshShader = m_RendererData.StaticMeshShader;
+		if( m_PendingInstancedMeshes.empty() )
+			return;
 
-		// u_Matrices
-		RendererData::StaticMeshMatrices u_Matrices = {};
-		u_Matrices.View = m_RendererData.CurrentCamera.ViewMatrix;
-		u_Matrices.ViewProjection = m_RendererData.CurrentCamera.Camera.ProjectionMatrix() * m_RendererData.CurrentCamera.ViewMatrix;
+		const glm::mat4 ViewProjection = m_RendererData.CurrentCamera.Camera.ProjectionMatrix() * m_RendererData.CurrentCamera.ViewMatrix;
+		const bool UseOcclusion = m_RendererData.EnableOcclusionCulling && m_OcclusionBufferReady;
+		const OcclusionCuller& rCuller = *m_RendererData.OcclusionBuffer;
 
-		LightData u_LightData = {};
-		RendererData::PointLights u_Lights;
+		// Instances per key, the draw lists are only touched once per key.
+		std::unordered_map< StaticMeshKey, uint32_t > VisibleInstances;
+		std::unordered_map< StaticMeshKey, uint32_t > ShadowInstances;
 
-		u_Lights.nbLights = int( m_pScene->m_Lights.PointLights.size() );
+		for( const PendingInstancedMesh& rPending : m_PendingInstancedMeshes )
+		{
+			const auto& rSubmeshes = rPending.Mesh->Submeshes();
+			const InstanceClusterTree& rClusters = *rPending.Clusters;
+			const glm::mat4 LocalToClip = ViewProjection * rPending.Transform;
+			const uint64_t EntityID = rPending.entity->GetUUID();
 
-		memcpy( u_Lights.Lights, m_pScene->m_Lights.PointLights.data(), m_pScene->m_Lights.GetPointLightSize() );
+			VisibleInstances.clear();
+			ShadowInstances.clear();
 
-		SceneData u_SceneData = {};
-		ShadowData u_ShadowData = {};
+			// Every instance is a static caster, hash the whole tree once.
+			if( rPending.Static && rPending.CastShadows )
+			{
+				Math::HashBuilder Hash;
+				Hash.Combine( ( size_t ) EntityID );
+				Hash.Combine( rClusters.GetHash() );
+				Hash.Combine( rPending.Transform );
 
-		struct DebugData
-		{
-			int TilesCountX;
-		} u_DebugData = {};
+				m_RendererData.StaticCasterHash += Hash.Hash;
+			}
 
-		u_DebugData.TilesCountX = ( int ) m_RendererData.LightCullingWorkGroups.x;
+			auto IsVisible = [&]( const AABB& rBounds )
+				{
+					return UseOcclusion ? rCuller.IsVisible( rBounds, rPending.Transform ) : IsInFrustum( rBounds, LocalToClip );
+				};
 
-		auto dirLight = m_pScene->m_Lights.DirectionalLights[ 0 ];
+			rClusters.Traverse( IsVisible, [&]( const InstanceClusterTree::Node& rLeaf, bool Visible )
+				{
+					m_RendererData.InstancesTested += rLeaf.Count;
 
-		auto invView = glm::inverse( u_Matrices.View );
+					if( !Visible )
+						m_RendererData.InstancesCulled += rLeaf.Count;
 
-		u_SceneData.CameraPosition = invView[ 3 ];
-		u_SceneData.Lights = { .Direction = dirLight.Direction, .Radiance = dirLight.Radiance, .Multiplier = dirLight.Intensity };
+					if( !Visible && !rPending.CastShadows )
+						return;
 
-		if( m_RendererData.EnableShadows )
+					// The closest instance of the cluster asks for the texture mips.
+					uint32_t Closest = rLeaf.First;
+					float ClosestDistance = std::numeric_limits<float>::max();
+
+					for( uint32_t i = rLeaf.First; i < rLeaf.First + rLeaf.Count; i++ )
+					{
+						const glm::mat4 InstanceTransform = rPending.Transform * rClusters.GetTransform( i );
+
+						// Stable for as long as the instance is not removed, so the slot in the instance buffer and the LOD history are kept.
+						const UUID Owner = EntityID ^ ( ( uint64_t ) ( rClusters.GetSourceIndex( i ) + 1 ) * 0x9E3779B97F4A7C15ull );
+
+						if( Visible )
+						{
+							float Distance = glm::length( glm::vec3( InstanceTransform[ 3 ] ) - m_RendererData.LodCameraPosition );
+
+							if( Distance < ClosestDistance )
+							{
+								ClosestDistance = Distance;
+								Closest = i;
+							}
+						}
+
+						for( uint32_t Index = 0; Index < ( uint32_t ) rSubmeshes.size(); Index++ )
+						{
+							const Submesh& rSubmesh = rSubmeshes[ Index ];
+							glm::mat4 Transform = InstanceTransform * rSubmesh.Transform;
+
+							size_t InstanceID = ( size_t ) Owner ^ ( ( size_t ) rPending.Mesh->ID << 1 ) ^ ( ( size_t ) Index << 48 );
+
+							// Culled instances only cast shadows, the coarsest LOD is enough.
+							uint32_t Lod = Visible ? SelectLod( rSubmesh, Transform, InstanceID ) : rSubmesh.GetLodCount() - 1;
+
+							StaticMeshKey Key = { rPending.Mesh->ID, rPending.Registry, Index, Lod };
+							Key.ShadowOnly = !Visible;
+							Key.Static = rPending.Static;
+							Key.CastShadows = rPending.CastShadows;
+
+							if( Visible )
+							{
+								m_RendererData.LodTriangles += rSubmesh.GetLod( Lod ).IndexCount / 3;
+								m_RendererData.FullDetailTriangles += rSubmesh.IndexCount / 3;
+
+								VisibleInstances[ Key ]++;
+							}
+
+							if( rPending.CastShadows )
+								ShadowInstances[ Key ]++;
+
+							// Quantised positions are relative to the submesh bounds.
+							if( rPending.Mesh->IsQuantised() )
+								Transform = Transform * rSubmesh.GetDequantisationMatrix();
+
+							m_RendererData.InstanceTransforms->Submit( Owner, Key, Transform );
+						}
+					}
+
+					if( !Visible )
+						return;
+
+					for( uint32_t Index = 0; Index < ( uint32_t ) rSubmeshes.size(); Index++ )
+					{
+						PendingSubmesh Submesh;
+						Submesh.entity = rPending.entity;
+						Submesh.Mesh = rPending.Mesh;
+						Submesh.Registry = rPending.Registry;
+						Submesh.SubmeshIndex = Index;
+						Submesh.Transform = rPending.Transform * rClusters.GetTransform( Closest ) * rSubmeshes[ Index ].Transform;
+
+						RequestTextureMips( Submesh );
+					}
+				} );
+
+			auto AddCommands = [&]( std::unordered_map< StaticMeshKey, DrawCommand >& rDrawList, const std::unordered_map< StaticMeshKey, uint32_t >& rInstances )
+				{
+					for( auto&& [Key, Count] : rInstances )
+					{
+						auto& rCommand = rDrawList[ Key ];
+						rCommand.entity = rPending.entity;
+						rCommand.Mesh = rPending.Mesh;
+						rCommand.SubmeshIndex = Key.SubmeshIndex;
+						rCommand.LodIndex = Key.LodIndex;
+						rCommand.Instances += Count;
+					}
+				};
+
+			AddCommands( m_DrawList, VisibleInstances );
+			AddCommands( m_ShadowMapDrawList, ShadowInstances );
+		}
+
+		m_PendingInstancedMeshes.clear();
+	}
+
+	StaticMeshSelectionSettings SceneRenderer::GetSelectionSettings() const
+	{
+		StaticMeshSelectionSettings Settings;
+		Settings.CameraPosition = m_RendererData.LodCameraPosition;
+		Settings.ProjectionScale = m_RendererData.LodProjectionScale;
+		Settings.EnableLods = m_RendererData.EnableLods;
+		Settings.LodPixelError = m_RendererData.LodPixelError;
+		Settings.LodHysteresis = m_RendererData.LodHysteresis;
+		Settings.AutomaticOccluders = m_RendererData.AutomaticOccluders;
+		Settings.OccluderScreenRadius = m_RendererData.OccluderScreenRadius;
+		Settings.MaxOccluderTriangles = m_RendererData.MaxOccluderTriangles;
+
+		return Settings;
+	}
+
+	uint32_t SceneRenderer::SelectLod( const Submesh& rSubmesh, const glm::mat4& rTransform, size_t InstanceID )
+	{
+		auto Itr = m_PreviousLods.find( InstanceID );
+
+		const uint32_t Lod = StaticMeshSelection::SelectLod( rSubmesh, rTransform, Itr != m_PreviousLods.end() ? Itr->second : UINT32_MAX, GetSelectionSettings() );
+		m_CurrentLods[ InstanceID ] = Lod;
+
+		return Lod;
+	}
+
+	void SceneRenderer::SubmitPhysicsCollider( Ref<Entity> entity, Ref< StaticMesh > mesh, Ref<MaterialRegistry> materialRegistry, const glm::mat4& transform )
+	{
+		SAT_PF_EVENT();
+
+		if( m_CapturingDrawList )
+			CaptureSubmission( entity, mesh, materialRegistry, transform, false, false, true );
+
+		auto& id = mesh->ID;
+		auto& submeshes = mesh->Submeshes();
+		for( size_t i = 0; i < submeshes.size(); i++ )
+		{
+			StaticMeshKey key = { mesh->ID, materialRegistry, ( uint32_t ) i };
+			key.Collider = true;
+
+			auto& command = m_PhysicsColliderDrawList[ key ];
+			command.entity = entity;
+			command.Mesh = mesh;
+			command.SubmeshIndex = ( uint32_t ) i;
+			command.Instances++;
+
+			glm::mat4 Transform = transform * submeshes[ i ].Transform;
+
+			// Quantised positions are relative to the submesh bounds.
+			if( mesh->IsQuantised() )
+				Transform = Transform * submeshes[ i ].GetDequantisationMatrix();
+
+			m_RendererData.InstanceTransforms->Submit( entity->GetUUID(), key, Transform );
+		}
+	}
+
+	void SceneRenderer::SetViewportSize( uint32_t w, uint32_t h )
+	{
+		if( m_RendererData.Width != w && m_RendererData.Height != h )
+		{
+			m_RendererData.Width = w;
+			m_RendererData.Height = h;
+			m_RendererData.Resized = true;
+		}
+	}
+
+	void SceneRenderer::Recreate()
+	{
+		InitPreDepth();
+
+		InitGeometryPass();
+
+		InitSceneComposite();
+		InitLateComposite();
+		InitPhysicsOutline();
+		
+		InitTexturePass();
+
+		const glm::uvec2 viewportSize = { m_RendererData.Width, m_RendererData.Height };
+
+		glm::uvec2 bs = ( viewportSize + 1u ) / 2u;
+		bs += m_RendererData.BloomWorkSize - bs % m_RendererData.BloomWorkSize;
+
+		m_RendererData.BloomSize = bs;
+
+		CreateSkyboxComponents();
+		CreateGridComponents();
+
+		Renderer2D::Get().SetInitialRenderPass( m_RendererData.LateCompositePass, m_RendererData.LateCompositeFramebuffer );
+
+		// The framebuffer images are new and the bloom images have a new size.
+		BuildRenderGraph();
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// RENDERER SHADER 
+	//////////////////////////////////////////////////////////////////////////
+
+	// Vertex, Binding 1
+	struct LightData
+	{
+		glm::mat4 LightMatrix[ 4 ];
+	};
+
+	// Fragment, Binding 2
+	struct SceneData
+	{
+		DirLight Lights;
+		glm::vec3 CameraPosition;
+	};
+
+	// Fragment, Binding 3
+	struct ShadowData
+	{
+		glm::vec4 CascadeSplits;
+	};
+
+	// Secondary command buffers don't inherit the dynamic state of the primary.
+	static void SetViewportAndScissor( VkCommandBuffer CommandBuffer, VkExtent2D Extent )
+	{
+		VkViewport Viewport = {};
+		Viewport.x = 0;
+		Viewport.y = 0;
+		Viewport.width = ( float ) Extent.width;
+		Viewport.height = ( float ) Extent.height;
+		Viewport.minDepth = 0.0f;
+		Viewport.maxDepth = 1.0f;
+
+		VkRect2D Scissor = { .offset = { 0, 0 }, .extent = Extent };
+
+		vkCmdSetViewport( CommandBuffer, 0, 1, &Viewport );
+		vkCmdSetScissor( CommandBuffer, 0, 1, &Scissor );
+	}
+
+	// Flattens a draw list so that it can be split into batches, deleted entities are skipped here so that the job system's threads never look at them.
+	void SceneRenderer::GatherDraws( const std::unordered_map< StaticMeshKey, DrawCommand >& rDrawList, std::vector< DrawListEntry >& rDraws )
+	{
+		rDraws.clear();
+		rDraws.reserve( rDrawList.size() );
+
+		for( const auto& [key, Cmd] : rDrawList )
+		{
+			// Entity may of been deleted.
+			if( !Cmd.entity )
+				continue;
+
+			rDraws.push_back( { &key, &Cmd } );
+		}
+	}
+
+	void SceneRenderer::GeometryPass()
+	{
+		SAT_PF_EVENT();
+
+		m_RendererData.GeometryPassTimer.Reset();
+
+		VkExtent2D Extent = { m_RendererData.Width, m_RendererData.Height };
+		VkFramebuffer Framebuffer = m_RendererData.GeometryFramebuffer->GetVulkanFramebuffer();
+
+		auto& rRecorder = Renderer::Get().GetSecondaryRecorder();
+
+		// Begin geometry pass, everything inside of it is recorded into secondary command buffers.
+		m_RendererData.GeometryPass->BeginPass( m_RendererData.CommandBuffer, Framebuffer, Extent, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS );
+		rRecorder->BeginRenderPass( m_RendererData.GeometryPass->GetVulkanPass(), Framebuffer );
+
+		//////////////////////////////////////////////////////////////////////////
+		// Actual geometry pass.
+		//////////////////////////////////////////////////////////////////////////
+
+		// The skybox and the grid write descriptors so they are recorded on this thread.
+		rRecorder->Record( [&]( VkCommandBuffer CommandBuffer )
+			{
+				SetViewportAndScissor( CommandBuffer, Extent );
+
+				CmdBeginDebugLabel( CommandBuffer, "Skybox" );
+
+				RenderSkybox( CommandBuffer );
+
+				CmdEndDebugLabel( CommandBuffer );
+
+				CmdBeginDebugLabel( CommandBuffer, "Grid" );
+
+				RenderGrid( CommandBuffer );
+
+				CmdEndDebugLabel( CommandBuffer );
+			} );
+
+		// Set environment resource.
+		Renderer::Get().SetSceneEnvironment( m_RendererData.ShadowCascades[ 0 ].Framebuffer->GetDepthAttachmentsResource(), m_RendererData.SceneEnvironment, m_RendererData.BRDFLUT_Texture );
+
+		RenderStaticMeshes();
+
+		//////////////////////////////////////////////////////////////////////////
+
+		// End geometry pass.
+		rRecorder->EndRenderPass( m_RendererData.CommandBuffer );
+		m_RendererData.GeometryPass->EndPass();
+
+		m_RendererData.GeometryPassTimer.Stop();
+	}
+
+	void SceneRenderer::RenderStaticMeshes()
+	{
+		uint32_t frame = Renderer::Get().GetCurrentFrame();
+
+		Ref< Shader > StaticMeshShader = m_RendererData.StaticMeshShader;
+
+		// u_Matrices
+		RendererData::StaticMeshMatrices u_Matrices = {};
+		u_Matrices.View = m_RendererData.CurrentCamera.ViewMatrix;
+		u_Matrices.ViewProjection = m_RendererData.CurrentCamera.Camera.ProjectionMatrix() * m_RendererData.CurrentCamera.ViewMatrix;
+
+		LightData u_LightData = {};
+
+		SceneData u_SceneData = {};
+		ShadowData u_ShadowData = {};
+
+		auto dirLight = m_pScene->m_Lights.DirectionalLights[ 0 ];
+
+		auto invView = glm::inverse( u_Matrices.View );
+
+		u_SceneData.CameraPosition = invView[ 3 ];
+		u_SceneData.Lights = { .Direction = dirLight.Direction, .Radiance = dirLight.Radiance, .Multiplier = dirLight.Intensity };
+
+		if( m_RendererData.EnableShadows )
 		{
 			for( int i = 0; i < SHADOW_CASCADE_COUNT; i++ )
 			{
@@ -1307,24 +1833,106 @@ namespace Saturn {
 
 		StaticMeshShader->UploadUB( ShaderType::Fragment, 0, 2, &u_SceneData, sizeof( u_SceneData ) );
 		StaticMeshShader->UploadUB( ShaderType::Fragment, 0, 3, &u_ShadowData, sizeof( u_ShadowData ) );
-		StaticMeshShader->UploadUB( ShaderType::Fragment, 0, 12, &u_DebugData, sizeof( u_DebugData ) );
-
-		//StaticMeshShader->UploadUB( ShaderType::Fragment, 0, 13, &u_Lights, sizeof( u_Lights ) );
-		StaticMeshShader->UploadUB( ShaderType::Fragment, 0, 13, &u_Lights, 16ull + sizeof( PointLight ) * u_Lights.nbLights );
 
+		// Write changed materials into the bindless table before any draw is recorded, draws only push the material index.
 		for( auto&& [key, Cmd] : m_DrawList )
 		{
-			// Entity may of been deleted.
 			if( !Cmd.entity )
 				continue;
 
-			const auto& rTransformData = m_RendererData.MeshTransforms[ key ];
-
-			// Render Submesh
-			Renderer::Get().SubmitMesh( m_RendererData.CommandBuffer,
-				m_RendererData.StaticMeshPipeline,
-				Cmd.Mesh, m_RendererData.StorageBufferSet, key.Registry, Cmd.SubmeshIndex, Cmd.Instances, m_RendererData.SubmeshTransformData[ frame ].VertexBuffer, rTransformData.Offset );
+			Submesh& rSubmesh = Cmd.Mesh->Submeshes()[ Cmd.SubmeshIndex ];
+			key.Registry->GetMaterials()[ rSubmesh.MaterialIndex ]->UpdateBindless();
 		}
+
+		VulkanContext::Get().GetBindlessTable()->Update( frame );
+
+		Renderer& rRenderer = Renderer::Get();
+
+		// Both static mesh pipelines are created from the same shader so their layouts are compatible.
+		const Renderer::StaticMeshResources Resources = rRenderer.PrepareStaticMeshResources( m_RendererData.StaticMeshPipeline, m_RendererData.StorageBufferSet );
+
+		std::vector< DrawListEntry > Draws;
+		GatherDraws( m_DrawList, Draws );
+
+		VkExtent2D Extent = { m_RendererData.Width, m_RendererData.Height };
+
+		rRenderer.GetSecondaryRecorder()->RecordParallel( ( uint32_t ) Draws.size(), m_RendererData.DrawsPerSecondary, [&]( VkCommandBuffer CommandBuffer, uint32_t Begin, uint32_t End )
+			{
+				CmdBeginDebugLabel( CommandBuffer, "Static meshes" );
+
+				SetViewportAndScissor( CommandBuffer, Extent );
+
+				rRenderer.BindStaticMeshResources( CommandBuffer, m_RendererData.StaticMeshPipeline, Resources );
+
+				const auto& rInstances = m_RendererData.InstanceTransforms;
+
+				for( uint32_t i = Begin; i < End; i++ )
+				{
+					const auto& [pKey, pCmd] = Draws[ i ];
+
+					// Render Submesh
+					rRenderer.SubmitMesh( CommandBuffer,
+						pCmd->Mesh->IsQuantised() ? m_RendererData.QuantisedStaticMeshPipeline : m_RendererData.StaticMeshPipeline,
+						pCmd->Mesh, pKey->Registry, pCmd->SubmeshIndex, rInstances->GetInstanceCount( *pKey ), rInstances->GetVertexBuffer(), rInstances->GetOffset( *pKey ), pCmd->LodIndex );
+				}
+
+				CmdEndDebugLabel( CommandBuffer );
+			} );
+	}
+
+	// Copies a region of one layer of a shadow image into the same layer of another shadow image.
+	// Both images are left in the read only depth layout that the shadow passes use, the destination outside of the region is undefined.
+	static void CopyShadowLayer( VkCommandBuffer CommandBuffer, Ref<Image2D> Src, Ref<Image2D> Dst, uint32_t Layer, VkOffset2D SrcOffset, VkOffset2D DstOffset, VkExtent2D Extent )
+	{
+		VkImageSubresourceRange Range = { .aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT, .baseMipLevel = 0, .levelCount = 1, .baseArrayLayer = Layer, .layerCount = 1 };
+
+		std::array<VkImageMemoryBarrier, 2> Barriers{};
+		Barriers[ 0 ] = { VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
+		Barriers[ 0 ].srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+		Barriers[ 0 ].dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+		Barriers[ 0 ].oldLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+		Barriers[ 0 ].newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		Barriers[ 0 ].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		Barriers[ 0 ].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		Barriers[ 0 ].image = Src->GetImage();
+		Barriers[ 0 ].subresourceRange = Range;
+
+		Barriers[ 1 ] = Barriers[ 0 ];
+		Barriers[ 1 ].dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		Barriers[ 1 ].oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		Barriers[ 1 ].newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		Barriers[ 1 ].image = Dst->GetImage();
+
+		vkCmdPipelineBarrier( CommandBuffer,
+			VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+			VK_PIPELINE_STAGE_TRANSFER_BIT,
+			0, 0, nullptr, 0, nullptr, ( uint32_t ) Barriers.size(), Barriers.data() );
+
+		VkImageCopy CopyRegion{};
+		CopyRegion.srcSubresource = { .aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT, .mipLevel = 0, .baseArrayLayer = Layer, .layerCount = 1 };
+		CopyRegion.dstSubresource = CopyRegion.srcSubresource;
+		CopyRegion.srcOffset = { SrcOffset.x, SrcOffset.y, 0 };
+		CopyRegion.dstOffset = { DstOffset.x, DstOffset.y, 0 };
+		CopyRegion.extent = { Extent.width, Extent.height, 1 };
+
+		vkCmdCopyImage( CommandBuffer,
+			Src->GetImage(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+			Dst->GetImage(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &CopyRegion );
+
+		Barriers[ 0 ].srcAccessMask = 0;
+		Barriers[ 0 ].dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT | VK_ACCESS_SHADER_READ_BIT;
+		Barriers[ 0 ].oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		Barriers[ 0 ].newLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+
+		Barriers[ 1 ].srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		Barriers[ 1 ].dstAccessMask = Barriers[ 0 ].dstAccessMask;
+		Barriers[ 1 ].oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		Barriers[ 1 ].newLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+
+		vkCmdPipelineBarrier( CommandBuffer,
+			VK_PIPELINE_STAGE_TRANSFER_BIT,
+			VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+			0, 0, nullptr, 0, nullptr, ( uint32_t ) Barriers.size(), Barriers.data() );
 	}
 
 	void SceneRenderer::DirShadowMapPass()
@@ -1334,34 +1942,16 @@ namespace Saturn {
 		if( !m_RendererData.EnableShadows )
 			return;
 
-		auto pAllocator = VulkanContext::Get().GetVulkanAllocator();
-		VkExtent2D Extent = { ( uint32_t ) SHADOW_MAP_SIZE, ( uint32_t ) SHADOW_MAP_SIZE };
 		VkCommandBuffer CommandBuffer = m_RendererData.CommandBuffer;
-		uint32_t frame = Renderer::Get().GetCurrentFrame();
 
-		std::array<VkClearValue, 2> ClearColors{};
-		ClearColors[ 0 ].depthStencil = { 1.0f, 0 };
-
-		VkRenderPassBeginInfo RenderPassBeginInfo = { VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO };
-		RenderPassBeginInfo.renderArea.extent = Extent;
-		RenderPassBeginInfo.pClearValues = ClearColors.data();
-		RenderPassBeginInfo.clearValueCount = ( uint32_t ) ClearColors.size();
-
-		VkViewport Viewport = {};
-		Viewport.x = 0;
-		Viewport.y = 0;
-		Viewport.width = SHADOW_MAP_SIZE;
-		Viewport.height = SHADOW_MAP_SIZE;
-		Viewport.minDepth = 0.0f;
-		Viewport.maxDepth = 1.0f;
-
-		VkRect2D Scissor = { .offset = { 0, 0 }, .extent = Extent };
+		const int32_t Size = ( int32_t ) SHADOW_MAP_SIZE;
+		const VkExtent2D Extent = { ( uint32_t ) Size, ( uint32_t ) Size };
 
 		//////////////////////////////////////////////////////////////////////////
 
-		Ref< Shader > ShadowShader = m_RendererData.DirShadowMapShader;
+		glm::vec3 LightDirection = m_pScene->m_Lights.DirectionalLights[ 0 ].Direction;
 
-		UpdateCascades( m_pScene->m_Lights.DirectionalLights[ 0 ].Direction );
+		UpdateCascades( LightDirection );
 
 		// u_Matrices
 		struct UB_Matrices
@@ -1376,73 +1966,205 @@ namespace Saturn {
 			u_Matrices.ViewProjection[ i ] = m_RendererData.ShadowCascades[ i ].ViewProjection;
 		}
 
-		auto pData = m_RendererData.DirShadowMapShader->MapUB( ShaderType::Vertex, 0, 0 );
+		m_RendererData.DirShadowMapShader->UploadUB( ShaderType::Vertex, 0, 0, &u_Matrices, sizeof( u_Matrices ) );
 
-		memcpy( pData, &u_Matrices, sizeof( u_Matrices ) );
+		// Any change to a static caster (added, removed or moved in the editor) invalidates every cascade.
+		bool StaticCastersChanged = m_RendererData.StaticCasterHash != m_RendererData.CachedStaticCasterHash;
+		m_RendererData.CachedStaticCasterHash = m_RendererData.StaticCasterHash;
 
-		m_RendererData.DirShadowMapShader->UnmapUB( ShaderType::Vertex, 0, 0 );
+		m_RendererData.ShadowCascadesRebuilt = 0;
+		m_RendererData.ShadowCascadesScrolled = 0;
+		m_RendererData.ShadowCascadesReused = 0;
 
-		for( int i = 0; i < SHADOW_CASCADE_COUNT; i++ )
+		for( uint32_t i = 0; i < SHADOW_CASCADE_COUNT; i++ )
 		{
 			m_RendererData.ShadowMapTimers[ i ].Reset();
 
-			RenderPassBeginInfo.framebuffer = m_RendererData.ShadowCascades[ i ].Framebuffer->GetVulkanFramebuffer();
-			RenderPassBeginInfo.renderPass = m_RendererData.DirShadowMapPasses[ i ]->GetVulkanPass();
 			m_RendererData.DirShadowMapPipelines[ i ]->GetShader()->WriteAllUBs( m_RendererData.DirShadowMapPipelines[ i ]->GetDescriptorSet( ShaderType::Vertex, 0 ) );
+			m_RendererData.QuantisedDirShadowMapPipelines[ i ]->GetShader()->WriteAllUBs( m_RendererData.QuantisedDirShadowMapPipelines[ i ]->GetDescriptorSet( ShaderType::Vertex, 0 ) );
 
-			// Begin directional shadow map pass.
-			CmdBeginDebugLabel( CommandBuffer, "ShadowMap" );
-			vkCmdBeginRenderPass( CommandBuffer, &RenderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE );
+			ShadowCascade& rCascade = m_RendererData.ShadowCascades[ i ];
 
-			vkCmdSetViewport( m_RendererData.CommandBuffer, 0, 1, &Viewport );
-			vkCmdSetScissor( m_RendererData.CommandBuffer, 0, 1, &Scissor );
+			if( !m_RendererData.EnableStaticShadowCache )
+			{
+				rCascade.StaticCacheValid = false;
+
+				RenderShadowCasters( i, m_RendererData.DirShadowMapPasses[ i ], rCascade.Framebuffer, ShadowCasters::All );
+
+				m_RendererData.ShadowMapTimers[ i ].Stop();
+				continue;
+			}
 
-			for( auto&& [key, Cmd] : m_ShadowMapDrawList )
+			// How many texels the cascade moved since the static casters were rendered.
+			glm::ivec2 Scroll = glm::ivec2( rCascade.Origin ) - glm::ivec2( rCascade.CachedOrigin );
+
+			bool CanReuse = rCascade.StaticCacheValid && !StaticCastersChanged
+				&& rCascade.Origin.z == rCascade.CachedOrigin.z && rCascade.Radius == rCascade.CachedRadius && LightDirection == rCascade.CachedLightDirection
+				&& std::abs( Scroll.x ) < Size / 2 && std::abs( Scroll.y ) < Size / 2;
+
+			if( !CanReuse )
 			{
-				// Entity may of been deleted.
-				if( !Cmd.entity )
-					continue;
+				RenderShadowCasters( i, m_RendererData.DirShadowMapPasses[ i ], rCascade.StaticFramebuffer, ShadowCasters::Static );
+
+				CopyShadowLayer( CommandBuffer, m_RendererData.StaticShadowImage, m_RendererData.ShadowImage, i, {}, {}, Extent );
+
+				m_RendererData.ShadowCascadesRebuilt++;
+			}
+			else if( Scroll.x != 0 || Scroll.y != 0 )
+			{
+				// Move the part that is still inside the cascade, then only render the strips that came into view.
+				VkOffset2D SrcOffset = { glm::max( Scroll.x, 0 ), glm::max( Scroll.y, 0 ) };
+				VkOffset2D DstOffset = { glm::max( -Scroll.x, 0 ), glm::max( -Scroll.y, 0 ) };
+				VkExtent2D CopyExtent = { ( uint32_t ) ( Size - std::abs( Scroll.x ) ), ( uint32_t ) ( Size - std::abs( Scroll.y ) ) };
+
+				CopyShadowLayer( CommandBuffer, m_RendererData.StaticShadowImage, m_RendererData.ShadowImage, i, SrcOffset, DstOffset, CopyExtent );
+
+				std::vector<VkRect2D> Strips;
+
+				if( Scroll.x > 0 )
+					Strips.push_back( { { Size - Scroll.x, 0 }, { ( uint32_t ) Scroll.x, Extent.height } } );
+				else if( Scroll.x < 0 )
+					Strips.push_back( { { 0, 0 }, { ( uint32_t ) -Scroll.x, Extent.height } } );
 
-				// Pass in the cascade index.
-				Buffer AdditionalData( sizeof( uint32_t ), &i );
+				if( Scroll.y > 0 )
+					Strips.push_back( { { 0, Size - Scroll.y }, { Extent.width, ( uint32_t ) Scroll.y } } );
+				else if( Scroll.y < 0 )
+					Strips.push_back( { { 0, 0 }, { Extent.width, ( uint32_t ) -Scroll.y } } );
 
-				const auto& rTransformData = m_RendererData.MeshTransforms[ key ];
+				RenderShadowCasters( i, m_RendererData.DirShadowMapLoadPass, rCascade.Framebuffer, ShadowCasters::Static, Strips );
 
-				Renderer::Get().RenderMeshWithoutMaterial( CommandBuffer, m_RendererData.DirShadowMapPipelines[ i ], Cmd.Mesh, Cmd.Instances, m_RendererData.SubmeshTransformData[ frame ].VertexBuffer, rTransformData.Offset, Cmd.SubmeshIndex, AdditionalData );
+				// The shadow map now only has the static casters, keep it as the new cache.
+				CopyShadowLayer( CommandBuffer, m_RendererData.ShadowImage, m_RendererData.StaticShadowImage, i, {}, {}, Extent );
+
+				m_RendererData.ShadowCascadesScrolled++;
 			}
+			else
+			{
+				CopyShadowLayer( CommandBuffer, m_RendererData.StaticShadowImage, m_RendererData.ShadowImage, i, {}, {}, Extent );
+
+				m_RendererData.ShadowCascadesReused++;
+			}
+
+			rCascade.StaticCacheValid = true;
+			rCascade.CachedOrigin = rCascade.Origin;
+			rCascade.CachedRadius = rCascade.Radius;
+			rCascade.CachedLightDirection = LightDirection;
 
-			vkCmdEndRenderPass( CommandBuffer );
-			CmdEndDebugLabel( CommandBuffer );
+			// Movable casters on top of the static depth.
+			RenderShadowCasters( i, m_RendererData.DirShadowMapLoadPass, rCascade.Framebuffer, ShadowCasters::Movable );
 
 			m_RendererData.ShadowMapTimers[ i ].Stop();
 		}
 	}
 
-	void SceneRenderer::PreDepthPass()
+	void SceneRenderer::RenderShadowCasters( uint32_t Cascade, Ref< Pass > ShadowPass, Ref< Framebuffer > ShadowFramebuffer, ShadowCasters Casters, const std::vector<VkRect2D>& rRegions )
 	{
-		SAT_PF_EVENT();
-
-		m_RendererData.PreDepthTimer.Reset();
+		VkCommandBuffer CommandBuffer = m_RendererData.CommandBuffer;
+		VkExtent2D Extent = { ( uint32_t ) SHADOW_MAP_SIZE, ( uint32_t ) SHADOW_MAP_SIZE };
 
-		uint32_t frame = Renderer::Get().GetCurrentFrame();
+		Renderer& rRenderer = Renderer::Get();
+		auto& rRecorder = rRenderer.GetSecondaryRecorder();
 
-		VkExtent2D Extent = { m_RendererData.Width,m_RendererData.Height };
-		VkCommandBuffer CommandBuffer = m_RendererData.CommandBuffer;
+		std::array<VkClearValue, 2> ClearColors{};
+		ClearColors[ 0 ].depthStencil = { 1.0f, 0 };
 
-		m_RendererData.PreDepthPass->BeginPass( CommandBuffer, m_RendererData.PreDepthFramebuffer->GetVulkanFramebuffer(), Extent );
+		VkRenderPassBeginInfo RenderPassBeginInfo = { VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO };
+		RenderPassBeginInfo.renderArea.extent = Extent;
+		RenderPassBeginInfo.pClearValues = ClearColors.data();
+		RenderPassBeginInfo.clearValueCount = ( uint32_t ) ClearColors.size();
+		RenderPassBeginInfo.framebuffer = ShadowFramebuffer->GetVulkanFramebuffer();
+		RenderPassBeginInfo.renderPass = ShadowPass->GetVulkanPass();
 
 		VkViewport Viewport = {};
 		Viewport.x = 0;
 		Viewport.y = 0;
-		Viewport.width = ( float ) m_RendererData.Width;
-		Viewport.height = ( float ) m_RendererData.Height;
+		Viewport.width = SHADOW_MAP_SIZE;
+		Viewport.height = SHADOW_MAP_SIZE;
 		Viewport.minDepth = 0.0f;
 		Viewport.maxDepth = 1.0f;
 
-		VkRect2D Scissor = { .offset = { 0, 0 }, .extent = Extent };
+		// Begin directional shadow map pass, the casters are recorded into secondary command buffers.
+		CmdBeginDebugLabel( CommandBuffer, "ShadowMap" );
+		vkCmdBeginRenderPass( CommandBuffer, &RenderPassBeginInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS );
+
+		rRecorder->BeginRenderPass( RenderPassBeginInfo.renderPass, RenderPassBeginInfo.framebuffer );
+
+		std::vector<VkRect2D> Regions = rRegions;
+
+		// Regions are re-rendered from scratch so they have to be cleared first.
+		if( Regions.size() )
+		{
+			VkClearAttachment ClearAttachment = {};
+			ClearAttachment.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+			ClearAttachment.clearValue.depthStencil = { 1.0f, 0 };
+
+			std::vector<VkClearRect> ClearRects;
+			for( const auto& rRegion : Regions )
+				ClearRects.push_back( { .rect = rRegion, .baseArrayLayer = 0, .layerCount = 1 } );
+
+			rRecorder->Record( [&]( VkCommandBuffer Secondary )
+				{
+					vkCmdClearAttachments( Secondary, 1, &ClearAttachment, ( uint32_t ) ClearRects.size(), ClearRects.data() );
+				} );
+		}
+		else
+		{
+			Regions.push_back( { .offset = { 0, 0 }, .extent = Extent } );
+		}
+
+		// Pass in the cascade index.
+		Buffer AdditionalData( sizeof( uint32_t ), &Cascade );
+
+		std::vector< DrawListEntry > Draws;
+		GatherDraws( m_ShadowMapDrawList, Draws );
+
+		std::erase_if( Draws, [Casters]( const DrawListEntry& rDraw )
+			{
+				return ( Casters == ShadowCasters::Static && !rDraw.first->Static ) || ( Casters == ShadowCasters::Movable && rDraw.first->Static );
+			} );
+
+		rRecorder->RecordParallel( ( uint32_t ) Draws.size(), m_RendererData.DrawsPerSecondary, [&]( VkCommandBuffer Secondary, uint32_t Begin, uint32_t End )
+			{
+				vkCmdSetViewport( Secondary, 0, 1, &Viewport );
+
+				const auto& rInstances = m_RendererData.InstanceTransforms;
+
+				for( const auto& rScissor : Regions )
+				{
+					vkCmdSetScissor( Secondary, 0, 1, &rScissor );
+
+					for( uint32_t i = Begin; i < End; i++ )
+					{
+						const auto& [pKey, pCmd] = Draws[ i ];
+
+						const auto& rPipeline = pCmd->Mesh->IsQuantised() ? m_RendererData.QuantisedDirShadowMapPipelines[ Cascade ] : m_RendererData.DirShadowMapPipelines[ Cascade ];
+
+						rRenderer.RenderMeshWithoutMaterial( Secondary, rPipeline, pCmd->Mesh, rInstances->GetInstanceCount( *pKey ), rInstances->GetVertexBuffer(), rInstances->GetOffset( *pKey ), pCmd->SubmeshIndex, pCmd->LodIndex, AdditionalData );
+					}
+				}
+			} );
+
+		rRecorder->EndRenderPass( CommandBuffer );
+
+		vkCmdEndRenderPass( CommandBuffer );
+		CmdEndDebugLabel( CommandBuffer );
+	}
+
+	void SceneRenderer::PreDepthPass()
+	{
+		SAT_PF_EVENT();
+
+		m_RendererData.PreDepthTimer.Reset();
 
-		vkCmdSetViewport( CommandBuffer, 0, 1, &Viewport );
-		vkCmdSetScissor( CommandBuffer, 0, 1, &Scissor );
+		VkExtent2D Extent = { m_RendererData.Width,m_RendererData.Height };
+		VkCommandBuffer CommandBuffer = m_RendererData.CommandBuffer;
+		VkFramebuffer Framebuffer = m_RendererData.PreDepthFramebuffer->GetVulkanFramebuffer();
+
+		Renderer& rRenderer = Renderer::Get();
+		auto& rRecorder = rRenderer.GetSecondaryRecorder();
+
+		m_RendererData.PreDepthPass->BeginPass( CommandBuffer, Framebuffer, Extent, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS );
+		rRecorder->BeginRenderPass( m_RendererData.PreDepthPass->GetVulkanPass(), Framebuffer );
 
 		// u_Matrices
 		struct UB_Matrices
@@ -1455,17 +2177,28 @@ namespace Saturn {
 		m_RendererData.PreDepthShader->UploadUB( ShaderType::Vertex, 0, 0, &u_Matrices, sizeof( u_Matrices ) );
 
 		m_RendererData.PreDepthShader->WriteAllUBs( m_RendererData.PreDepthPipeline->GetDescriptorSet( ShaderType::Vertex, 0 ) );
+		m_RendererData.PreDepthShader->WriteAllUBs( m_RendererData.QuantisedPreDepthPipeline->GetDescriptorSet( ShaderType::Vertex, 0 ) );
 
-		for( auto&& [key, Cmd]: m_DrawList )
-		{
-			// Entity may of been deleted.
-			if( !Cmd.entity )
-				continue;
+		std::vector< DrawListEntry > Draws;
+		GatherDraws( m_DrawList, Draws );
+
+		rRecorder->RecordParallel( ( uint32_t ) Draws.size(), m_RendererData.DrawsPerSecondary, [&]( VkCommandBuffer Secondary, uint32_t Begin, uint32_t End )
+			{
+				SetViewportAndScissor( Secondary, Extent );
 
-			const auto& rTransformData = m_RendererData.MeshTransforms[ key ];
+				const auto& rInstances = m_RendererData.InstanceTransforms;
 
-			Renderer::Get().RenderMeshWithoutMaterial( CommandBuffer, m_RendererData.PreDepthPipeline, Cmd.Mesh, Cmd.Instances, m_RendererData.SubmeshTransformData[ frame ].VertexBuffer, rTransformData.Offset, Cmd.SubmeshIndex );
-		}
+				for( uint32_t i = Begin; i < End; i++ )
+				{
+					const auto& [pKey, pCmd] = Draws[ i ];
+
+					const auto& rPipeline = pCmd->Mesh->IsQuantised() ? m_RendererData.QuantisedPreDepthPipeline : m_RendererData.PreDepthPipeline;
+
+					rRenderer.RenderMeshWithoutMaterial( Secondary, rPipeline, pCmd->Mesh, rInstances->GetInstanceCount( *pKey ), rInstances->GetVertexBuffer(), rInstances->GetOffset( *pKey ), pCmd->SubmeshIndex, pCmd->LodIndex );
+				}
+			} );
+
+		rRecorder->EndRenderPass( CommandBuffer );
 
 		m_RendererData.PreDepthPass->EndPass();
 		m_RendererData.PreDepthTimer.Stop();
@@ -1541,12 +2274,15 @@ namespace Saturn {
 		m_RendererData.PhysicsOutlineShader->UploadUB( ShaderType::Vertex, 0, 0, &u_Matrices, sizeof( u_Matrices ) );
 
 		m_RendererData.PhysicsOutlineShader->WriteAllUBs( m_RendererData.PhysicsOutlinePipeline->GetDescriptorSet( ShaderType::Vertex, 0 ) );
+		m_RendererData.PhysicsOutlineShader->WriteAllUBs( m_RendererData.QuantisedPhysicsOutlinePipeline->GetDescriptorSet( ShaderType::Vertex, 0 ) );
 
 		for( auto& [key, Cmd] : m_PhysicsColliderDrawList )
 		{
-			const auto& rTransformData = m_RendererData.MeshTransforms[ key ];
+			const auto& rInstances = m_RendererData.InstanceTransforms;
+			const auto& rPipeline = Cmd.Mesh->IsQuantised() ? m_RendererData.QuantisedPhysicsOutlinePipeline : m_RendererData.PhysicsOutlinePipeline;
 
-			Renderer::Get().RenderMeshWithoutMaterial( CommandBuffer, m_RendererData.PhysicsOutlinePipeline, Cmd.Mesh, Cmd.Instances, m_RendererData.SubmeshTransformData[ frame ].VertexBuffer, rTransformData.Offset, Cmd.SubmeshIndex );
+			// The colliders have their own block, the outline itself is always full detail.
+			Renderer::Get().RenderMeshWithoutMaterial( CommandBuffer, rPipeline, Cmd.Mesh, Cmd.Instances, rInstances->GetVertexBuffer(), rInstances->GetOffset( key ), Cmd.SubmeshIndex, 0 );
 		}
 
 		m_RendererData.LateCompositePass->EndPass();
@@ -1597,118 +2333,89 @@ namespace Saturn {
 
 		m_RendererData.LightCullingTimer.Reset();
 
-		if( m_RendererData.LightCullingWorkGroups.x == 0 ) 
-		{
-			constexpr uint32_t TILE_SIZE = 16;
-			glm::uvec2 Viewport = { m_RendererData.Width, m_RendererData.Height };
-			glm::uvec2 Size = Viewport;
-			Size += TILE_SIZE - Viewport % TILE_SIZE;
-
-			m_RendererData.LightCullingWorkGroups = { Size / TILE_SIZE, 1 };
+		const auto& rPointLights = m_pScene->m_Lights.PointLights;
 
-			float size = m_RendererData.LightCullingWorkGroups.x * m_RendererData.LightCullingWorkGroups.y * 4.0f * 1024.0f;
-			m_RendererData.StorageBufferSet->Resize( 0, 14, ( size_t ) size );
-		}
-
-		// UBs
-		RendererData::PointLights u_Lights;
+		// The shader attenuates point lights by 1 - d^2 / ( Radius^2 * 10 ), so they stop contributing at Radius * sqrt( 10 ).
+		const float RangeScale = std::sqrt( 10.0f );
 
-		struct
-		{
-			glm::vec2 FullResolution;
-		} u_ScreenData{};
+		auto& rSpheres = m_RendererData.PointLightSpheres;
+		rSpheres.resize( rPointLights.size() );
 
-		struct
-		{
-			glm::mat4 ViewProjection;
-			glm::mat4 Projection;
-			glm::mat4 View;
-			glm::mat4 InvP;
-		} u_Matrices{};
+		for( size_t i = 0; i < rPointLights.size(); i++ )
+			rSpheres[ i ] = glm::vec4( rPointLights[ i ].Position, rPointLights[ i ].Radius * RangeScale );
 
-		u_Matrices.ViewProjection = m_RendererData.CurrentCamera.Camera.ProjectionMatrix() * m_RendererData.CurrentCamera.ViewMatrix;
-		u_Matrices.Projection = m_RendererData.CurrentCamera.Camera.ProjectionMatrix();
-		u_Matrices.View = glm::inverse( m_RendererData.CurrentCamera.ViewMatrix );
-		u_Matrices.InvP = glm::inverse( u_Matrices.Projection );
+		auto& rClusters = *m_RendererData.PointLightClusters;
+		rClusters.Build( rSpheres, m_RendererData.CurrentCamera.ViewMatrix, m_RendererData.CurrentCamera.Camera.ProjectionMatrix(), m_RendererData.Width, m_RendererData.Height );
 
-		u_ScreenData.FullResolution = { m_RendererData.Width, m_RendererData.Height };
+		uint32_t frame = Renderer::Get().GetCurrentFrame();
 
-		u_Lights.nbLights = ( uint32_t ) m_pScene->m_Lights.PointLights.size();
+		// Point lights, only the ones that are inside the view.
+		const auto& rVisibleLights = rClusters.GetVisibleLights();
+		auto& rLightData = m_RendererData.VisiblePointLights;
+		rLightData.resize( rVisibleLights.size() );
 
-		std::memcpy( u_Lights.Lights, m_pScene->m_Lights.PointLights.data(), m_pScene->m_Lights.GetPointLightSize() );
+		for( size_t i = 0; i < rVisibleLights.size(); i++ )
+			rLightData[ i ] = rPointLights[ rVisibleLights[ i ] ];
 
-		m_RendererData.LightCullingShader->UploadUB( ShaderType::Compute, 0, 0, &u_Lights, 16ull + sizeof PointLight * u_Lights.nbLights );
-		m_RendererData.LightCullingShader->UploadUB( ShaderType::Compute, 0, 3, &u_ScreenData, sizeof( u_ScreenData ) );
-		m_RendererData.LightCullingShader->UploadUB( ShaderType::Compute, 0, 4, &u_Matrices, sizeof( u_Matrices ) );
+		// nbLights is padded to 16 bytes, the light array starts after it.
+		uint32_t LightHeader[ 4 ] = { ( uint32_t ) rLightData.size(), 0, 0, 0 };
 
-		m_RendererData.LightCullingShader->WriteAllUBs( m_RendererData.LightCullingDescriptorSet );
+		Ref<StorageBuffer> LightBuffer = m_RendererData.StorageBufferSet->Get( 0, 13, frame );
+		LightBuffer->Reserve( sizeof( LightHeader ) + sizeof( PointLight ) * rLightData.size() );
+		LightBuffer->SetData( LightHeader, sizeof( LightHeader ) );
 
-		// Write storage buffer
-		Ref<StorageBuffer> SB = m_RendererData.StorageBufferSet->Get( 0, 14, Renderer::Get().GetCurrentFrame() );
+		if( rLightData.size() )
+			LightBuffer->SetData( rLightData.data(), sizeof( PointLight ) * rLightData.size(), sizeof( LightHeader ) );
 
-		m_RendererData.LightCullingShader->WriteSB( 0, 14, SB->GetBufferInfo(), m_RendererData.LightCullingDescriptorSet );
+		// Cluster light lists.
+		const auto& rClusterData = rClusters.GetClusterData();
 
-		// Light culling here
-		auto& CullingPipeline = m_RendererData.LightCullingPipeline;
+		Ref<StorageBuffer> ClusterBuffer = m_RendererData.StorageBufferSet->Get( 0, 14, frame );
+		ClusterBuffer->Reserve( sizeof( LightClusterHeader ) + sizeof( uint32_t ) * rClusterData.size() );
+		ClusterBuffer->SetData( &rClusters.GetHeader(), sizeof( LightClusterHeader ) );
+		ClusterBuffer->SetData( rClusterData.data(), sizeof( uint32_t ) * rClusterData.size(), sizeof( LightClusterHeader ) );
 
-		CullingPipeline->BindWithCommandBuffer( m_RendererData.CommandBuffer );
+		m_RendererData.LightCullingTimer.Stop();
+	}
 
-		CullingPipeline->Execute(
-			m_RendererData.LightCullingDescriptorSet->GetVulkanSet(),
-			( uint32_t ) m_RendererData.LightCullingWorkGroups.x,
-			( uint32_t ) m_RendererData.LightCullingWorkGroups.y,
-			( uint32_t ) m_RendererData.LightCullingWorkGroups.z );
+	struct BloomSettings
+	{
+		float Threshold;
+		float Knee;
+		float TK; // Threshold - Knee
+		float DK; // Knee * 2.0f
+		float QK; // Knee / 0.25f
+		float Stage; // -1 = Prefilter, 0 = Downsample, 1 = Upsample
+		float LOD;
+	};
 
-		VkMemoryBarrier barrier = {};
-		barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
-		barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
-		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+	static BloomSettings GetBloomSettings()
+	{
+		BloomSettings Settings{};
 
-		vkCmdPipelineBarrier( CullingPipeline->GetCommandBuffer(),
-			VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
-			VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-			0,
-			1, &barrier,
-			0, nullptr,
-			0, nullptr );
+		Settings.LOD = 0.0f;
+		Settings.Threshold = 1.5f;
+		Settings.Knee = 0.1f;
 
-		CullingPipeline->Unbind();
+		Settings.TK = Settings.Knee - Settings.Threshold;
+		Settings.DK = Settings.Knee * 2.0f;
+		Settings.QK = Settings.Knee / 0.25f;
 
-		m_RendererData.LightCullingTimer.Stop();
+		return Settings;
 	}
 
 	// TODO: This function needs a rework.
 	//       We are creating a new descriptor set every frame but we are recycling it at the end of frame in the Renderer.
 	//	     We could just free them in this function?
 	//       And also we aren't freeing them after the stages are complete.
+	// Prefilter and downsample, the upsample is its own pass so the second scratch image is dead by the time the output is written.
 	void SceneRenderer::BloomPass()
 	{
 		SAT_PF_EVENT();
 
 		m_RendererData.BloomTimer.Reset();
-		//m_RendererData.BloomTimer.Stop();
-
-		// TEMP
-		//return;
-
-		struct u_Settings
-		{
-			float Threshold;
-			float Knee;
-			float TK; // Threshold - Knee
-			float DK; // Knee * 2.0f
-			float QK; // Knee / 0.25f
-			float Stage; // -1 = Prefilter, 0 = Downsample, 1 = Upsample
-			float LOD;
-		} pc_Settings{};
 
-		pc_Settings.LOD = 0.0f;
-		pc_Settings.Threshold = 1.5f;
-		pc_Settings.Knee = 0.1f;
-
-		pc_Settings.TK = pc_Settings.Knee - pc_Settings.Threshold;
-		pc_Settings.DK = pc_Settings.Knee * 2.0f;
-		pc_Settings.QK = pc_Settings.Knee / 0.25f;
+		BloomSettings pc_Settings = GetBloomSettings();
 
 		auto& shader = m_RendererData.BloomShader;
 		auto& pipeline = m_RendererData.BloomComputePipeline;
@@ -1723,6 +2430,14 @@ namespace Saturn {
 
 		auto& InputImg = m_RendererData.GeometryFramebuffer->GetColorAttachmentsResources()[ 0 ];
 
+		// The ping pong images live in the render graph and share memory with other transient images.
+		const auto& rGraph = m_RendererData.Graph;
+		const RenderGraphResource Scratch0 = m_RendererData.BloomScratch[ 0 ];
+		const RenderGraphResource Scratch1 = m_RendererData.BloomScratch[ 1 ];
+
+		VkDescriptorImageInfo Scratch0Info = rGraph->GetDescriptorInfo( Scratch0 );
+		VkDescriptorImageInfo Scratch1Info = rGraph->GetDescriptorInfo( Scratch1 );
+
 		glm::vec2 workgrps{};
 
 		// Step 0: Bind compute pipeline in graphics queue.
@@ -1741,13 +2456,13 @@ namespace Saturn {
 			shader->WriteDescriptor( "u_InputTexture", InputImg->GetDescriptorInfo(), descriptorSet );
 			shader->WriteDescriptor( "u_BloomTexture", InputImg->GetDescriptorInfo(), descriptorSet );
 
-			auto descriptorInfo = m_RendererData.BloomTextures[ 0 ]->GetDescriptorInfo();
-			descriptorInfo.imageView = m_RendererData.BloomTextures[ 0 ]->GetOrCreateMipImageView( 0 );
+			auto descriptorInfo = Scratch0Info;
+			descriptorInfo.imageView = rGraph->GetMipImageView( Scratch0, 0 );
 
 			shader->WriteDescriptor( "o_Image", descriptorInfo, descriptorSet );
 
-			workgrps.x = ( float ) m_RendererData.BloomTextures[ 0 ]->Width() / m_RendererData.BloomWorkSize;
-			workgrps.y = ( float ) m_RendererData.BloomTextures[ 0 ]->Height() / m_RendererData.BloomWorkSize;
+			workgrps.x = ( float ) rGraph->GetImageDesc( Scratch0 ).Width / m_RendererData.BloomWorkSize;
+			workgrps.y = ( float ) rGraph->GetImageDesc( Scratch0 ).Height / m_RendererData.BloomWorkSize;
 
 			pipeline->AddPushConstant( &pc_Settings, 0, sizeof( pc_Settings ) );
 			pipeline->Execute( descriptorSet, ( uint32_t ) workgrps.x, ( uint32_t ) workgrps.y, 1 );
@@ -1755,29 +2470,32 @@ namespace Saturn {
 
 		CmdEndDebugLabel( m_RendererData.CommandBuffer );
 
-		CmdBeginDebugLabel( m_RendererData.CommandBuffer, "Downsample" );
-
-		if( m_RendererData.BloomTextures[ 0 ]->GetMipMapLevels() <= 1 )
+		if( rGraph->GetImageDesc( Scratch0 ).MipLevels <= 1 )
+		{
+			pipeline->Unbind();
 			return;
+		}
+
+		CmdBeginDebugLabel( m_RendererData.CommandBuffer, "Downsample" );
 
-		uint32_t mips = m_RendererData.BloomTextures[ 0 ]->GetMipMapLevels() - 2;
+		uint32_t mips = rGraph->GetImageDesc( Scratch0 ).MipLevels - 2;
 
 		// Step 1: Downsample.
 		pc_Settings.Stage = ( float ) BloomStage::Downsample;
 		for( uint32_t i = 1; i < mips; i++ )
 		{
-			auto [w, h] = m_RendererData.BloomTextures[ 0 ]->GetMipSize( i );
+			auto [w, h] = rGraph->GetMipSize( Scratch0, i );
 
 			workgrps.x = glm::ceil( ( float ) w / m_RendererData.BloomWorkSize );
 			workgrps.y = glm::ceil( ( float ) h / m_RendererData.BloomWorkSize );
 
 			{
-				auto descriptorInfo = m_RendererData.BloomTextures[ 1 ]->GetDescriptorInfo();
-				descriptorInfo.imageView = m_RendererData.BloomTextures[ 1 ]->GetOrCreateMipImageView( i );
+				auto descriptorInfo = Scratch1Info;
+				descriptorInfo.imageView = rGraph->GetMipImageView( Scratch1, i );
 
 				VK_CHECK( vkAllocateDescriptorSets( VulkanContext::Get().GetDevice(), &info, &descriptorSet ) );
 
-				shader->WriteDescriptor( "u_InputTexture", m_RendererData.BloomTextures[ 0 ]->GetDescriptorInfo(), descriptorSet );
+				shader->WriteDescriptor( "u_InputTexture", Scratch0Info, descriptorSet );
 				shader->WriteDescriptor( "u_BloomTexture", InputImg->GetDescriptorInfo(), descriptorSet );
 
 				shader->WriteDescriptor( "o_Image", descriptorInfo, descriptorSet );
@@ -1797,11 +2515,11 @@ namespace Saturn {
 			{
 				VK_CHECK( vkAllocateDescriptorSets( VulkanContext::Get().GetDevice(), &info, &descriptorSet ) );
 
-				shader->WriteDescriptor( "u_InputTexture", m_RendererData.BloomTextures[ 1 ]->GetDescriptorInfo(), descriptorSet );
+				shader->WriteDescriptor( "u_InputTexture", Scratch1Info, descriptorSet );
 				shader->WriteDescriptor( "u_BloomTexture", InputImg->GetDescriptorInfo(), descriptorSet );
 
-				auto descriptorInfo = m_RendererData.BloomTextures[ 0 ]->GetDescriptorInfo();
-				descriptorInfo.imageView = m_RendererData.BloomTextures[ 0 ]->GetOrCreateMipImageView( i );
+				auto descriptorInfo = Scratch0Info;
+				descriptorInfo.imageView = rGraph->GetMipImageView( Scratch0, i );
 
 				shader->WriteDescriptor( "o_Image", descriptorInfo, descriptorSet );
 
@@ -1817,27 +2535,68 @@ namespace Saturn {
 
 		CmdEndDebugLabel( m_RendererData.CommandBuffer );
 
+		pipeline->Unbind();
+	}
+
+	void SceneRenderer::BloomUpsamplePass()
+	{
+		SAT_PF_EVENT();
+
+		const auto& rGraph = m_RendererData.Graph;
+		const RenderGraphResource Scratch0 = m_RendererData.BloomScratch[ 0 ];
+		const RenderGraphResource Output = m_RendererData.BloomOutput;
+
+		// Nothing was downsampled.
+		if( rGraph->GetImageDesc( Scratch0 ).MipLevels <= 1 )
+		{
+			m_RendererData.BloomTimer.Stop();
+			return;
+		}
+
+		BloomSettings pc_Settings = GetBloomSettings();
+
+		auto& shader = m_RendererData.BloomShader;
+		auto& pipeline = m_RendererData.BloomComputePipeline;
+
+		VkDescriptorSet descriptorSet;
+		VkDescriptorPool descriptorPool = Renderer::Get().GetDescriptorPool()->GetVulkanPool();
+
+		VkDescriptorSetAllocateInfo info{ VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
+		info.descriptorPool = descriptorPool;
+		info.descriptorSetCount = 1;
+		info.pSetLayouts = shader->GetSetLayouts().data();
+
+		auto& InputImg = m_RendererData.GeometryFramebuffer->GetColorAttachmentsResources()[ 0 ];
+
+		VkDescriptorImageInfo Scratch0Info = rGraph->GetDescriptorInfo( Scratch0 );
+		VkDescriptorImageInfo OutputInfo = rGraph->GetDescriptorInfo( Output );
+
+		// Matches the mip count the downsample used.
+		uint32_t mips = rGraph->GetImageDesc( Scratch0 ).MipLevels - 2;
+
+		glm::vec2 workgrps{};
+
+		pipeline->BindWithCommandBuffer( m_RendererData.CommandBuffer );
+
 		CmdBeginDebugLabel( m_RendererData.CommandBuffer, "First Upsample" );
 
 		// Step 2: First upsample.
 		pc_Settings.Stage = ( float ) BloomStage::FirstUpsample;
-		workgrps.x *= 2;
-		workgrps.y *= 2;
 
 		{
 			VK_CHECK( vkAllocateDescriptorSets( VulkanContext::Get().GetDevice(), &info, &descriptorSet ) );
 
-			shader->WriteDescriptor( "u_InputTexture", m_RendererData.BloomTextures[ 0 ]->GetDescriptorInfo(), descriptorSet );
+			shader->WriteDescriptor( "u_InputTexture", Scratch0Info, descriptorSet );
 			shader->WriteDescriptor( "u_BloomTexture", InputImg->GetDescriptorInfo(), descriptorSet );
 
-			auto info = m_RendererData.BloomTextures[ 0 ]->GetDescriptorInfo();
-			info.imageView = m_RendererData.BloomTextures[ 2 ]->GetOrCreateMipImageView( mips - 2 );
+			auto descriptorInfo = OutputInfo;
+			descriptorInfo.imageView = rGraph->GetMipImageView( Output, mips - 2 );
 
-			shader->WriteDescriptor( "o_Image", info, descriptorSet );
+			shader->WriteDescriptor( "o_Image", descriptorInfo, descriptorSet );
 
-			pc_Settings.LOD--;
+			pc_Settings.LOD = ( float ) mips - 2.0f;
 
-			auto [w, h] = m_RendererData.BloomTextures[ 2 ]->GetMipSize( mips - 2 );
+			auto [w, h] = rGraph->GetMipSize( Output, mips - 2 );
 
 			workgrps.x = glm::ceil( ( float ) w / m_RendererData.BloomWorkSize );
 			workgrps.y = glm::ceil( ( float ) h / m_RendererData.BloomWorkSize );
@@ -1857,7 +2616,7 @@ namespace Saturn {
 		pc_Settings.Stage = ( float ) BloomStage::Upsample;
 		for( int32_t mip = mips - 3; mip >= 0; mip-- )
 		{
-			auto [w, h] = m_RendererData.BloomTextures[ 2 ]->GetMipSize( mip );
+			auto [w, h] = rGraph->GetMipSize( Output, mip );
 
 			workgrps.x = glm::ceil( ( float ) w / m_RendererData.BloomWorkSize );
 			workgrps.y = glm::ceil( ( float ) h / m_RendererData.BloomWorkSize );
@@ -1865,13 +2624,13 @@ namespace Saturn {
 			VK_CHECK( vkAllocateDescriptorSets( VulkanContext::Get().GetDevice(), &info, &descriptorSet ) );
 
 			{
-				shader->WriteDescriptor( "u_InputTexture", m_RendererData.BloomTextures[ 0 ]->GetDescriptorInfo(), descriptorSet );
-				shader->WriteDescriptor( "u_BloomTexture", m_RendererData.BloomTextures[ 2 ]->GetDescriptorInfo(), descriptorSet );
+				shader->WriteDescriptor( "u_InputTexture", Scratch0Info, descriptorSet );
+				shader->WriteDescriptor( "u_BloomTexture", OutputInfo, descriptorSet );
 
-				auto info = m_RendererData.BloomTextures[ 0 ]->GetDescriptorInfo();
-				info.imageView = m_RendererData.BloomTextures[ 2 ]->GetOrCreateMipImageView( mip );
+				auto descriptorInfo = OutputInfo;
+				descriptorInfo.imageView = rGraph->GetMipImageView( Output, mip );
 
-				shader->WriteDescriptor( "o_Image", info, descriptorSet );
+				shader->WriteDescriptor( "o_Image", descriptorInfo, descriptorSet );
 
 				pc_Settings.LOD = ( float ) mip;
 
@@ -1891,6 +2650,213 @@ namespace Saturn {
 		m_RendererData.BloomTimer.Stop();
 	}
 
+	std::vector< PassTimingSample > SceneRenderer::GetPassTimings() const
+	{
+		const auto& rGPUTimer = m_RendererData.GPUTimer;
+
+		float ShadowMapTime = -1.0f;
+
+		if( m_RendererData.EnableShadows )
+		{
+			ShadowMapTime = 0.0f;
+
+			for( int i = 0; i < SHADOW_CASCADE_COUNT; i++ )
+				ShadowMapTime += m_RendererData.ShadowMapTimers[ i ].ElapsedMilliseconds();
+		}
+
+		// Passes that don't have a CPU timer only report their GPU time.
+		const std::pair< const char*, float > CPUTimes[] = {
+			{ "ShadowMap",      ShadowMapTime },
+			{ "PreDepth",       m_RendererData.PreDepthTimer.ElapsedMilliseconds() },
+			{ "LightCulling",   m_RendererData.LightCullingTimer.ElapsedMilliseconds() },
+			{ "Geometry",       m_RendererData.GeometryPassTimer.ElapsedMilliseconds() },
+			{ "Bloom",          m_RendererData.BloomTimer.ElapsedMilliseconds() }
+		};
+
+		std::vector< PassTimingSample > Samples;
+
+		for( const auto& rResult : rGPUTimer->GetResults() )
+		{
+			PassTimingSample& rSample = Samples.emplace_back();
+			rSample.Pass = rResult.Name;
+			rSample.GPUTime = rResult.Milliseconds;
+
+			for( const auto& [ pName, Time ] : CPUTimes )
+			{
+				if( rResult.Name == pName )
+					rSample.CPUTime = Time;
+			}
+		}
+
+		// No GPU results (i.e. timestamps are not supported), still report the CPU times.
+		if( Samples.empty() )
+		{
+			for( const auto& [ pName, Time ] : CPUTimes )
+			{
+				PassTimingSample& rSample = Samples.emplace_back();
+				rSample.Pass = pName;
+				rSample.CPUTime = Time;
+			}
+		}
+
+		return Samples;
+	}
+
+	void SceneRenderer::CapturePassTimings()
+	{
+		auto& rCapture = m_RendererData.PassTimingCapture;
+
+		const uint32_t Frame = rCapture.empty() ? 0 : rCapture.back().Frame + 1;
+
+		for( auto& rSample : GetPassTimings() )
+		{
+			rSample.Frame = Frame;
+			rCapture.push_back( std::move( rSample ) );
+		}
+	}
+
+	bool SceneRenderer::ExportPassTimings( const std::filesystem::path& rPath )
+	{
+		std::ofstream Stream( rPath, std::ios::trunc );
+
+		if( !Stream )
+		{
+			SAT_CORE_WARN( "Failed to open {0} to export the pass times!", rPath.string() );
+			return false;
+		}
+
+		std::vector< PassTimingSample > Samples = m_RendererData.PassTimingCapture.empty() ? GetPassTimings() : m_RendererData.PassTimingCapture;
+
+		Stream << "Frame,Pass,CPU (ms),GPU (ms)\n";
+
+		for( const auto& rSample : Samples )
+		{
+			Stream << rSample.Frame << "," << rSample.Pass << ",";
+
+			if( rSample.CPUTime >= 0.0f )
+				Stream << rSample.CPUTime;
+
+			Stream << ",";
+
+			if( rSample.GPUTime >= 0.0f )
+				Stream << rSample.GPUTime;
+
+			Stream << "\n";
+		}
+
+		SAT_CORE_INFO( "Exported {0} pass times to {1}", Samples.size(), rPath.string() );
+
+		m_RendererData.PassTimingCapture.clear();
+
+		return true;
+	}
+
+	void SceneRenderer::CaptureDrawList( const std::filesystem::path& rPath )
+	{
+		m_DrawListCapturePath = rPath;
+		m_DrawListCaptureArmed = true;
+	}
+
+	void SceneRenderer::CaptureSubmission( Ref<Entity> entity, Ref< StaticMesh > mesh, Ref<MaterialRegistry> materialRegistry, const glm::mat4& transform, bool Occluder, bool Static, bool PhysicsCollider )
+	{
+		CapturedSubmission& rSubmission = m_DrawListCapture.Submissions.emplace_back();
+		rSubmission.Entity = ( uint64_t ) entity->GetUUID();
+		rSubmission.Mesh = CaptureMesh( mesh );
+		rSubmission.Registry = m_CapturedRegistries.try_emplace( materialRegistry.Get(), ( uint32_t ) m_CapturedRegistries.size() ).first->second;
+		rSubmission.Transform = transform;
+		rSubmission.Occluder = Occluder;
+		rSubmission.Static = Static;
+		rSubmission.PhysicsCollider = PhysicsCollider;
+	}
+
+	uint32_t SceneRenderer::CaptureMesh( const Ref< StaticMesh >& rMesh )
+	{
+		auto [Itr, Inserted] = m_CapturedMeshes.try_emplace( rMesh->ID, ( uint32_t ) m_DrawListCapture.Meshes.size() );
+
+		if( !Inserted )
+			return Itr->second;
+
+		CapturedMesh& rCaptured = m_DrawListCapture.Meshes.emplace_back();
+		rCaptured.ID = ( uint64_t ) rMesh->ID;
+		rCaptured.Quantised = rMesh->IsQuantised();
+
+		// Meshes without CPU vertices are never occluders, so there is nothing to store for them.
+		const auto& rVertices = rMesh->Vertices();
+
+		if( !rVertices.empty() )
+		{
+			rCaptured.Positions.resize( rVertices.size() );
+
+			for( size_t i = 0; i < rVertices.size(); i++ )
+				rCaptured.Positions[ i ] = rVertices[ i ].Position;
+
+			const uint32_t* pIndices = reinterpret_cast< const uint32_t* >( rMesh->Indices().data() );
+			rCaptured.Indices.assign( pIndices, pIndices + rMesh->Indices().size() * 3 );
+		}
+
+		for( const auto& rSubmesh : rMesh->Submeshes() )
+		{
+			CapturedSubmesh& rCapturedSubmesh = rCaptured.Submeshes.emplace_back();
+			rCapturedSubmesh.Transform = rSubmesh.Transform;
+			rCapturedSubmesh.BoundingBox = rSubmesh.BoundingBox;
+			rCapturedSubmesh.BaseVertex = rSubmesh.BaseVertex;
+			rCapturedSubmesh.BaseIndex = rSubmesh.BaseIndex;
+			rCapturedSubmesh.IndexCount = rSubmesh.IndexCount;
+			rCapturedSubmesh.VertexCount = rSubmesh.VertexCount;
+			rCapturedSubmesh.MaterialIndex = rSubmesh.MaterialIndex;
+
+			for( const auto& rLod : rSubmesh.Lods )
+				rCapturedSubmesh.Lods.push_back( { rLod.BaseIndex, rLod.IndexCount, rLod.Error } );
+		}
+
+		return Itr->second;
+	}
+
+	void SceneRenderer::SaveDrawListCapture()
+	{
+		SAT_PF_EVENT();
+
+		m_CapturingDrawList = false;
+
+		auto& rCapture = m_DrawListCapture;
+		rCapture.Width = m_RendererData.Width;
+		rCapture.Height = m_RendererData.Height;
+		rCapture.View = m_RendererData.CurrentCamera.ViewMatrix;
+		rCapture.Projection = m_RendererData.CurrentCamera.Camera.ProjectionMatrix();
+		rCapture.CameraPosition = m_RendererData.LodCameraPosition;
+		rCapture.LodProjectionScale = m_RendererData.LodProjectionScale;
+
+		auto& rSettings = rCapture.Settings;
+		rSettings.EnableLods = m_RendererData.EnableLods;
+		rSettings.LodPixelError = m_RendererData.LodPixelError;
+		rSettings.LodHysteresis = m_RendererData.LodHysteresis;
+		rSettings.EnableOcclusionCulling = m_RendererData.EnableOcclusionCulling;
+		rSettings.AutomaticOccluders = m_RendererData.AutomaticOccluders;
+		rSettings.OccluderScreenRadius = m_RendererData.OccluderScreenRadius;
+		rSettings.MaxOccluderTriangles = m_RendererData.MaxOccluderTriangles;
+		rSettings.DrawsPerSecondary = m_RendererData.DrawsPerSecondary;
+
+		const auto& rLights = m_pScene->m_Lights;
+		rCapture.LightDirection = rLights.DirectionalLights[ 0 ].Direction;
+		rCapture.LightRadiance = rLights.DirectionalLights[ 0 ].Radiance;
+		rCapture.LightIntensity = rLights.DirectionalLights[ 0 ].Intensity;
+
+		// Same spheres as LightCullingPass.
+		const float RangeScale = std::sqrt( 10.0f );
+
+		for( const auto& rLight : rLights.PointLights )
+			rCapture.PointLights.push_back( glm::vec4( rLight.Position, rLight.Radius * RangeScale ) );
+
+		if( rCapture.Save( m_DrawListCapturePath ) )
+			SAT_CORE_INFO( "Captured {0} submissions of {1} meshes to {2}", rCapture.Submissions.size(), rCapture.Meshes.size(), m_DrawListCapturePath.string() );
+		else
+			SAT_CORE_WARN( "Failed to write the draw list capture to {0}!", m_DrawListCapturePath.string() );
+
+		rCapture.Clear();
+		m_CapturedMeshes.clear();
+		m_CapturedRegistries.clear();
+	}
+
 	void SceneRenderer::AddScheduledFunction( ScheduledFunc&& rrFunc )
 	{
 		m_ScheduledFunctions.push_back( rrFunc );
@@ -1915,30 +2881,58 @@ namespace Saturn {
 
 	Ref<TextureCube> SceneRenderer::CreateDymanicSky()
 	{
-		constexpr uint32_t cubemapSize = 512;
-		constexpr uint32_t irradianceMap = 32;
+		const auto& rEnvironment = m_RendererData.SceneEnvironment;
+
+		return m_RendererData.SkyBuilder->Build( { rEnvironment->Turbidity, rEnvironment->Azimuth, rEnvironment->Inclination } );
+	}
 
-		Ref<TextureCube> Environment = Ref<TextureCube>::Create( ImageFormat::RGBA32F, cubemapSize, cubemapSize );
+	void SceneRenderer::UpdateDynamicSky()
+	{
+		SAT_PF_EVENT();
 
-		Ref<Shader> skyShader = ShaderLibrary::Get().Find( "Skybox_Compute" );
-		Ref<ComputePipeline> pipeline = Ref<ComputePipeline>::Create( skyShader );
+		auto& rEnvironment = m_RendererData.SceneEnvironment;
 
-		glm::vec3 params = { m_RendererData.SceneEnvironment->Turbidity, m_RendererData.SceneEnvironment->Azimuth, m_RendererData.SceneEnvironment->Inclination };
+		Ref<TextureCube> Map = m_RendererData.SkyBuilder->Update( Renderer::Get().GetCurrentFrame(), rEnvironment->RadianceMap );
 
-		skyShader->WriteDescriptor( "o_CubeMap", Environment->GetDescriptorInfo(), m_RendererData.PreethamDescriptorSet->GetVulkanSet() );
+		if( Map.Get() == rEnvironment->RadianceMap.Get() )
+			return;
 
-		auto CommandBuffer = m_RendererData.CommandBuffer;
+		rEnvironment->IrradianceMap = Map;
+		rEnvironment->RadianceMap = Map;
+	}
 
-		pipeline->Bind();
-		pipeline->AddPushConstant( &params, 0, sizeof( glm::vec3 ) );
-		pipeline->Execute( m_RendererData.PreethamDescriptorSet->GetVulkanSet(), cubemapSize / irradianceMap, cubemapSize / irradianceMap, 6 );
-		pipeline->Unbind();
+	Ref<Texture2D> SceneRenderer::CreateBRDFLut()
+	{
+		SAT_PF_EVENT();
+
+		constexpr uint32_t Size = 256;
+		constexpr uint32_t SampleCount = 1024;
+
+		// The LUT does not depend on the project, it is cached with the engine's other caches.
+		const std::filesystem::path Directory = Application::Get().GetAppDataFolder() / "IBL";
+		const uint64_t Key = IBLPrecompute::GetBRDFLutKey( Size, SampleCount );
+
+		std::vector<Buffer> Mips;
+
+		if( !IBLPrecompute::LoadCache( Directory, "BRDFLut", Key, Mips ) || Mips.size() != MipGenerator::GetMipCount( Size, Size ) )
+		{
+			for( Buffer& rMip : Mips )
+				rMip.Free();
+
+			Timer BuildTimer;
 
-		Environment->CreateMips();
+			Mips = IBLPrecompute::GenerateBRDFLut( Size, SampleCount );
+			IBLPrecompute::SaveCache( Directory, "BRDFLut", Key, Mips, 1 );
 
-		pipeline = nullptr;
+			SAT_CORE_INFO( "Generated BRDF LUT in {0:.2f} ms", BuildTimer.ElapsedMilliseconds() );
+		}
+
+		Ref<Texture2D> Texture = Ref<Texture2D>::Create( ImageFormat::RGBA8, Size, Size, Mips );
 
-		return Environment;
+		for( Buffer& rMip : Mips )
+			rMip.Free();
+
+		return Texture;
 	}
 
 	void SceneRenderer::SetDynamicSky( float Turbidity, float Azimuth, float Inclination )
@@ -1949,14 +2943,8 @@ namespace Saturn {
 				m_RendererData.SceneEnvironment->Azimuth = azimuth;
 				m_RendererData.SceneEnvironment->Inclination = inclination;
 
-				m_RendererData.SceneEnvironment->IrradianceMap = nullptr;
-				m_RendererData.SceneEnvironment->RadianceMap = nullptr;
-
-				Ref<TextureCube> map = CreateDymanicSky();
-
-				m_RendererData.SceneEnvironment->IrradianceMap = map;
-				m_RendererData.SceneEnvironment->RadianceMap = map;
-
+				// The current sky stays until the new one has been uploaded.
+				m_RendererData.SkyBuilder->Request( { turbidity, azimuth, inclination } );
 			} );
 	}
 
@@ -1974,40 +2962,138 @@ namespace Saturn {
 	{
 		SAT_PF_EVENT();
 
-		// Create our buffers for instance data.
-		uint32_t frame = Renderer::Get().GetCurrentFrame();
+		// Release instances that were not submitted this frame and upload the transforms that changed.
+		m_RendererData.InstanceTransforms->Flush( m_RendererData.CommandBuffer );
+	}
 
-		uint32_t off = 0;
-		for( auto& [id, buffer] : m_RendererData.MeshTransforms )
-		{
-			buffer.Offset = off * sizeof( TransformBufferData );
-			for (const auto& transform : buffer.Data )
+	void SceneRenderer::BuildRenderGraph()
+	{
+		if( !m_RendererData.Graph )
+			m_RendererData.Graph = Ref<RenderGraph>::Create();
+
+		auto& rGraph = m_RendererData.Graph;
+		rGraph->Reset();
+
+		auto& rGeometryColors = m_RendererData.GeometryFramebuffer->GetColorAttachmentsResources();
+
+		const RenderGraphResource ShadowMap = rGraph->ImportImage( "Shadow Map", m_RendererData.ShadowImage );
+		const RenderGraphResource StaticShadowMap = rGraph->ImportImage( "Static Shadow Map", m_RendererData.StaticShadowImage );
+		// Shared by the pre depth, geometry and late composite passes.
+		const RenderGraphResource Depth = rGraph->ImportImage( "Depth", m_RendererData.PreDepthFramebuffer->GetDepthAttachmentsResource() );
+
+		std::vector< RenderGraphResource > GeometryColors;
+		for( size_t i = 0; i < rGeometryColors.size(); i++ )
+			GeometryColors.push_back( rGraph->ImportImage( "Geometry Color " + std::to_string( i ), rGeometryColors[ i ] ) );
+
+		const RenderGraphResource SceneColor = rGraph->ImportImage( "Scene Composite", m_RendererData.SceneCompositeFramebuffer->GetColorAttachmentsResources()[ 0 ] );
+		const RenderGraphResource SceneDepth = rGraph->ImportImage( "Scene Composite Depth", m_RendererData.SceneCompositeFramebuffer->GetDepthAttachmentsResource() );
+
+		// The composite image is shown by the editor viewport.
+		rGraph->MarkOutput( SceneColor );
+
+		rGraph->AddPass( "ShadowMap",
+			[&]( RenderGraphBuilder& rBuilder )
 			{
-				m_RendererData.SubmeshTransformData[ frame ].pData[ off ] = transform;
-				off++;
-			}
-		}
+				rBuilder.Write( ShadowMap, RenderGraphUsage::DepthAttachment );
+				rBuilder.Write( StaticShadowMap, RenderGraphUsage::DepthAttachment );
+			},
+			[this]( VkCommandBuffer ) { DirShadowMapPass(); },
+			[this]() { return m_RendererData.EnableShadows; } );
+
+		rGraph->AddPass( "PreDepth",
+			[&]( RenderGraphBuilder& rBuilder )
+			{
+				rBuilder.Write( Depth, RenderGraphUsage::DepthAttachment );
+			},
+			[this]( VkCommandBuffer ) { PreDepthPass(); } );
 
-		m_RendererData.SubmeshTransformData[ frame ].VertexBuffer->Reallocate( m_RendererData.SubmeshTransformData[ frame ].pData, off * sizeof( TransformBufferData ) );
-	}
+		// Only writes buffers.
+		rGraph->AddPass( "LightCulling",
+			[&]( RenderGraphBuilder& rBuilder )
+			{
+				rBuilder.SetSideEffect();
+			},
+			[this]( VkCommandBuffer ) { LightCullingPass(); } );
 
-	class ScopedDebugLabel
-	{
-	public:
-		ScopedDebugLabel( VkCommandBuffer _CommandBuffer, const char* pName ) 
-			: CommandBuffer( _CommandBuffer )
-		{
-			CmdBeginDebugLabel( CommandBuffer, pName );
-		}
-		
-		~ScopedDebugLabel() 
-		{
-			CmdEndDebugLabel( CommandBuffer );
-		}
+		rGraph->AddPass( "Geometry",
+			[&]( RenderGraphBuilder& rBuilder )
+			{
+				rBuilder.Read( ShadowMap, RenderGraphUsage::FragmentSampled );
+				rBuilder.Write( Depth, RenderGraphUsage::DepthAttachment );
+
+				for( RenderGraphResource Color : GeometryColors )
+					rBuilder.Write( Color, RenderGraphUsage::ColorAttachment );
+			},
+			[this]( VkCommandBuffer ) { GeometryPass(); } );
+
+		RenderGraphImageDesc BloomDesc;
+		BloomDesc.Format = VK_FORMAT_R32G32B32A32_SFLOAT;
+		BloomDesc.Width = m_RendererData.BloomSize.x;
+		BloomDesc.Height = m_RendererData.BloomSize.y;
+		BloomDesc.MipLevels = static_cast<uint32_t>( std::floor( std::log2( glm::min( BloomDesc.Width, BloomDesc.Height ) ) ) + 1 );
+		BloomDesc.Usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+
+		rGraph->AddPass( "Bloom",
+			[&]( RenderGraphBuilder& rBuilder )
+			{
+				for( uint32_t i = 0; i < 2; i++ )
+				{
+					m_RendererData.BloomScratch[ i ] = rBuilder.CreateImage( "Bloom Scratch " + std::to_string( i ), BloomDesc );
+					rBuilder.Write( m_RendererData.BloomScratch[ i ], RenderGraphUsage::ComputeStorage );
+				}
 
-	private:
-		VkCommandBuffer CommandBuffer;
-	};
+				rBuilder.Read( GeometryColors[ 0 ], RenderGraphUsage::ComputeSampled );
+			},
+			[this]( VkCommandBuffer ) { BloomPass(); } );
+
+		// The second scratch image is dead after the downsample, so the output is placed in its memory.
+		rGraph->AddPass( "BloomUpsample",
+			[&]( RenderGraphBuilder& rBuilder )
+			{
+				m_RendererData.BloomOutput = rBuilder.CreateImage( "Bloom", BloomDesc );
+
+				rBuilder.Read( m_RendererData.BloomScratch[ 0 ], RenderGraphUsage::ComputeStorage );
+				rBuilder.Read( GeometryColors[ 0 ], RenderGraphUsage::ComputeSampled );
+				rBuilder.Write( m_RendererData.BloomOutput, RenderGraphUsage::ComputeStorage );
+			},
+			[this]( VkCommandBuffer ) { BloomUpsamplePass(); } );
+
+		rGraph->AddPass( "SceneComposite",
+			[&]( RenderGraphBuilder& rBuilder )
+			{
+				rBuilder.Read( GeometryColors[ 0 ], RenderGraphUsage::FragmentSampled );
+				rBuilder.Read( m_RendererData.BloomOutput, RenderGraphUsage::FragmentSampled );
+				rBuilder.Read( Depth, RenderGraphUsage::FragmentSampled );
+
+				rBuilder.Write( SceneColor, RenderGraphUsage::ColorAttachment );
+				rBuilder.Write( SceneDepth, RenderGraphUsage::DepthAttachment );
+			},
+			[this]( VkCommandBuffer ) { SceneCompositePass(); } );
+
+		// Loads the composite color and the depth.
+		rGraph->AddPass( "LateComposite",
+			[&]( RenderGraphBuilder& rBuilder )
+			{
+				rBuilder.Write( SceneColor, RenderGraphUsage::ColorAttachment );
+				rBuilder.Write( Depth, RenderGraphUsage::DepthAttachment );
+			},
+			[this]( VkCommandBuffer ) { LateCompPhysicsOutline(); } );
+
+		// Writes to the swapchain.
+		rGraph->AddPass( "TexturePass",
+			[&]( RenderGraphBuilder& rBuilder )
+			{
+				rBuilder.Read( SceneColor, RenderGraphUsage::FragmentSampled );
+				rBuilder.SetSideEffect();
+			},
+			[this]( VkCommandBuffer ) { TexturePass(); },
+			[this]() { return m_RendererData.IsSwapchainTarget; } );
+
+		rGraph->Compile();
+
+		// The bloom output is a new image every time the graph is compiled.
+		m_RendererData.SceneCompositeShader->WriteDescriptor( "u_BloomTexture", rGraph->GetDescriptorInfo( m_RendererData.BloomOutput ), m_RendererData.SC_DescriptorSet->GetVulkanSet() );
+	}
 
 	void SceneRenderer::RenderScene()
 	{
@@ -2028,50 +3114,32 @@ namespace Saturn {
 
 		m_RendererData.CommandBuffer = Renderer::Get().ActiveCommandBuffer();
 
-		for( auto&& func : m_ScheduledFunctions )
-			func();
+		// Reads back the GPU times from the last time this frame was in flight, the CPU timers still hold the last frame's times at this point.
+		m_RendererData.GPUTimer->BeginFrame( m_RendererData.CommandBuffer, Renderer::Get().GetCurrentFrame() );
 
-		InitBuffers();
+		if( m_RendererData.RecordPassTimings )
+			CapturePassTimings();
 
-		// Passes
+		for( auto&& func : m_ScheduledFunctions )
+			func();
 
-		DirShadowMapPass();
+		UpdateDynamicSky();
 
-		{
-			ScopedDebugLabel label( m_RendererData.CommandBuffer, "PreDepth" );
-			PreDepthPass();
-		}
+		if( m_CapturingDrawList )
+			SaveDrawListCapture();
 
-		{
-			ScopedDebugLabel label( m_RendererData.CommandBuffer, "LightCulling" );
-			LightCullingPass();
-		}
-		
-		{
-			ScopedDebugLabel label( m_RendererData.CommandBuffer, "Geometry" );
-			GeometryPass();
-		}
+		CullStaticMeshes();
+		AddInstancedStaticMeshes();
 
-		{
-			ScopedDebugLabel label( m_RendererData.CommandBuffer, "Bloom" );
-			BloomPass();
-		}
+		// Every visible submesh has asked for its mips by now, hand them to the streamer under a single lock.
+		if( TextureStreamer* pStreamer = VulkanContext::Get().GetTextureStreamer(); pStreamer && m_TextureRequests.size() )
+			pStreamer->Request( m_TextureRequests );
 
-		{
-			ScopedDebugLabel label( m_RendererData.CommandBuffer, "Scene Composite - Post Processing" );
-			SceneCompositePass();
-		}
+		InitBuffers();
 
-		{
-			ScopedDebugLabel label( m_RendererData.CommandBuffer, "Late Composite (SceneRenderer)" );
-			LateCompPhysicsOutline();
-		}
+		// Passes
 
-		if( m_RendererData.IsSwapchainTarget )
-		{
-			ScopedDebugLabel label( m_RendererData.CommandBuffer, "Scene Composite - Texture Pass" );
-			TexturePass();
-		}
+		m_RendererData.Graph->Execute( m_RendererData.CommandBuffer, m_RendererData.GPUTimer.Get() );
 
 		FlushDrawList();
 	}
@@ -2082,12 +3150,50 @@ namespace Saturn {
 		m_ShadowMapDrawList.clear();
 		m_PhysicsColliderDrawList.clear();
 		m_ScheduledFunctions.clear();
-		m_RendererData.MeshTransforms.clear();
+		m_PendingSubmeshes.clear();
+		m_PendingInstancedMeshes.clear();
+		m_TextureRequests.clear();
+		m_OcclusionBufferReady = false;
+
+		m_PreviousLods.swap( m_CurrentLods );
+		m_CurrentLods.clear();
+
+		m_RendererData.LastLodTriangles = m_RendererData.LodTriangles;
+		m_RendererData.LastFullDetailTriangles = m_RendererData.FullDetailTriangles;
+		m_RendererData.LodTriangles = 0;
+		m_RendererData.FullDetailTriangles = 0;
+
+		m_RendererData.LastOcclusionTested = m_RendererData.OcclusionTested;
+		m_RendererData.LastOcclusionCulled = m_RendererData.OcclusionCulled;
+		m_RendererData.OcclusionTested = 0;
+		m_RendererData.OcclusionCulled = 0;
+
+		m_RendererData.LastInstancesTested = m_RendererData.InstancesTested;
+		m_RendererData.LastInstancesCulled = m_RendererData.InstancesCulled;
+		m_RendererData.InstancesTested = 0;
+		m_RendererData.InstancesCulled = 0;
+
+		m_RendererData.StaticCasterHash = 0;
 	}
 
 	void SceneRenderer::SetCamera( const RendererCamera& Camera )
 	{
 		m_RendererData.CurrentCamera = Camera;
+
+		// Meshes are submitted after the camera is set, so this is where a frame starts.
+		if( m_DrawListCaptureArmed )
+		{
+			m_DrawListCaptureArmed = false;
+			m_CapturingDrawList = true;
+
+			m_DrawListCapture.Clear();
+			m_CapturedMeshes.clear();
+			m_CapturedRegistries.clear();
+		}
+
+		// LOD selection happens when meshes are submitted, so the camera must be set before that.
+		m_RendererData.LodCameraPosition = glm::vec3( glm::inverse( Camera.ViewMatrix )[ 3 ] );
+		m_RendererData.LodProjectionScale = glm::abs( Camera.Camera.ProjectionMatrix()[ 1 ][ 1 ] ) * ( float ) m_RendererData.Height * 0.5f;
 	}
 
 	//////////////////////////////////////////////////////////////////////////
@@ -2103,8 +3209,6 @@ namespace Saturn {
 		GridDescriptorSet         = nullptr;
 		SkyboxDescriptorSet       = nullptr;
 		SC_DescriptorSet          = nullptr;
-		PreethamDescriptorSet     = nullptr;
-		LightCullingDescriptorSet = nullptr;
 		BloomDS                   = nullptr;
 		TexturePassDescriptorSet  = nullptr;
 
@@ -2118,18 +3222,26 @@ namespace Saturn {
 		PreDepthFramebuffer       = nullptr;
 		LateCompositeFramebuffer  = nullptr;
 
-		for( int i = 0; i < 3; i++ )
-			BloomTextures[ i ] = nullptr;
+		Graph = nullptr;
 
 		for( int i = 0; i < SHADOW_CASCADE_COUNT; i++ )
+		{
 			ShadowCascades[ i ].Framebuffer = nullptr;
+			ShadowCascades[ i ].StaticFramebuffer = nullptr;
+		}
 
 		ShadowCascades.clear();
 
+		ShadowImage = nullptr;
+		StaticShadowImage = nullptr;
+
 		// Render Passes
 		for( int i = 0; i < SHADOW_CASCADE_COUNT; i++ )
 			DirShadowMapPasses[ i ]->Terminate();
 
+		DirShadowMapLoadPass->Terminate();
+		DirShadowMapLoadPass = nullptr;
+
 		GeometryPass->Terminate();
 		SceneComposite->Terminate();
 
@@ -2145,26 +3257,30 @@ namespace Saturn {
 		SceneCompositePipeline = nullptr;
 
 		for( int i = 0; i < SHADOW_CASCADE_COUNT; i++ )
+		{
 			DirShadowMapPipelines[ i ] = nullptr;
+			QuantisedDirShadowMapPipelines[ i ] = nullptr;
+		}
 
 		StaticMeshPipeline      = nullptr;
 		GridPipeline            = nullptr;
 		SkyboxPipeline          = nullptr;
 		PreDepthPipeline        = nullptr;
-		LightCullingPipeline    = nullptr;
 		BloomComputePipeline    = nullptr;
 		PhysicsOutlinePipeline  = nullptr;
 
+		QuantisedStaticMeshPipeline     = nullptr;
+		QuantisedPreDepthPipeline       = nullptr;
+		QuantisedPhysicsOutlinePipeline = nullptr;
+
 		// Shaders
 		GridShader              = nullptr;
 		SkyboxShader            = nullptr;
 		StaticMeshShader        = nullptr; 
 		SceneCompositeShader    = nullptr;
 		DirShadowMapShader      = nullptr;
-		PreethamShader          = nullptr;
 		AOCompositeShader       = nullptr;
 		PreDepthShader          = nullptr;
-		LightCullingShader      = nullptr;
 		BloomShader             = nullptr;
 		PhysicsOutlineShader    = nullptr;
 
@@ -2177,16 +3293,15 @@ namespace Saturn {
 		BloomDirtTexture        = nullptr;
 
 		SceneEnvironment        = nullptr;
-
-		for( auto& buffer : SubmeshTransformData )
-			delete[] buffer.pData;
+		SkyBuilder              = nullptr;
 
 		// Storage buffer set
 		StorageBufferSet = nullptr;
 
-		SubmeshTransformData.clear();
-
-		MeshTransforms.clear();
+		InstanceTransforms = nullptr;
+		OcclusionBuffer = nullptr;
+		PointLightClusters = nullptr;
+		GPUTimer = nullptr;
 	}
 
 }
\ No newline at end of file
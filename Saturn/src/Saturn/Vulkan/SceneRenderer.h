@@ -43,11 +43,21 @@
 #include "Framebuffer.h"
 #include "ComputePipeline.h"
 #include "StorageBufferSet.h"
+#include "InstanceBuffer.h"
+#include "InstanceClusterTree.h"
+#include "GPUProfiler.h"
+#include "RenderGraph.h"
+#include "DynamicSkyBuilder.h"
+#include "TextureStreamer.h"
+
+#include "Saturn/Core/Renderer/OcclusionCuller.h"
+#include "Saturn/Core/Renderer/LightClusters.h"
+#include "Saturn/Core/Renderer/DrawListCapture.h"
+#include "Saturn/Core/Renderer/StaticMeshSelection.h"
 
 #include "Pipeline.h"
 
 constexpr int SHADOW_CASCADE_COUNT = 4;
-constexpr int MAX_POINT_LIGHTS = 512;
 
 namespace Saturn {
 
@@ -56,15 +66,60 @@ namespace Saturn {
 		Ref<Entity> entity = nullptr;
 		Ref< StaticMesh > Mesh = nullptr;
 		uint32_t SubmeshIndex = 0;
+		uint32_t LodIndex = 0;
 		uint32_t Instances = 0;
 	};
 
+	// A submesh instance that is waiting for the occlusion culling before it goes into the draw lists.
+	struct PendingSubmesh
+	{
+		Ref<Entity> entity = nullptr;
+		Ref< StaticMesh > Mesh = nullptr;
+		Ref< MaterialRegistry > Registry = nullptr;
+		uint32_t SubmeshIndex = 0;
+		uint32_t LodIndex = 0;
+		glm::mat4 Transform;
+		bool Occluder = false;
+		bool Static = false;
+	};
+
+	// An instanced mesh, its clusters are culled once every occluder has been rasterised.
+	struct PendingInstancedMesh
+	{
+		Ref<Entity> entity = nullptr;
+		Ref< StaticMesh > Mesh = nullptr;
+		Ref< MaterialRegistry > Registry = nullptr;
+		Ref< InstanceClusterTree > Clusters = nullptr;
+		glm::mat4 Transform;
+		bool CastShadows = true;
+		bool Static = false;
+	};
+
 	struct ShadowCascade
 	{
 		Ref< Framebuffer > Framebuffer = nullptr;
 
 		float SplitDepth = 0.0f;
 		glm::mat4 ViewProjection;
+
+		// Where the cascade sits in light space, x and y in texels and z in steps of the radius.
+		glm::ivec3 Origin{};
+		float Radius = 0.0f;
+
+		// Depth of the static casters only, copied into the shadow map every frame before the movable casters are drawn.
+		Ref< Framebuffer > StaticFramebuffer = nullptr;
+		bool StaticCacheValid = false;
+
+		glm::ivec3 CachedOrigin{};
+		float CachedRadius = 0.0f;
+		glm::vec3 CachedLightDirection{};
+	};
+
+	enum class ShadowCasters
+	{
+		All,
+		Static,
+		Movable
 	};
 
 	// Most of theses structs MUST (most of the time) match the structs in the shader.
@@ -95,59 +150,14 @@ namespace Saturn {
 		None
 	};
 
-	struct StaticMeshKey
-	{
-		AssetID MeshID;
-		Ref<MaterialRegistry> Registry;
-
-		uint32_t SubmeshIndex;
-
-		StaticMeshKey( AssetID meshID, Ref<MaterialRegistry> materialReg, uint32_t submeshIndex ) : MeshID( meshID ), SubmeshIndex( submeshIndex ) { Registry = materialReg; }
-
-		bool operator==( const StaticMeshKey& rKey )
-		{
-			return ( MeshID == rKey.MeshID && Registry == rKey.Registry && SubmeshIndex == rKey.SubmeshIndex );
-		}
-
-		bool operator==( const StaticMeshKey& rKey ) const
-		{
-			return ( MeshID == rKey.MeshID && Registry == rKey.Registry && SubmeshIndex == rKey.SubmeshIndex );
-		}
-	};
-
-	// Data that gets sent to the vertex shader
-	struct TransformBufferData
-	{
-		glm::vec4 TransfromBufferR[ 4 ];
-	};
-
-	// For each mesh, what offset are we and how much transform does it have.
-	struct TransformBuffer
-	{
-		uint32_t Offset = 0;
-		std::vector<TransformBufferData> Data;
-	};
-
-	struct SubmeshTransformVB
-	{
-		Ref<VertexBuffer> VertexBuffer;
-		TransformBufferData* pData = nullptr;
-	};
-}
-
-namespace std {
-
-	template<>
-	struct hash< Saturn::StaticMeshKey >
+	// CPU and GPU time of one pass in one frame, a negative time means the pass was not measured.
+	struct PassTimingSample
 	{
-		size_t operator()( const Saturn::StaticMeshKey& rKey ) const
-		{
-			return rKey.Registry->GetID() ^ rKey.MeshID ^ rKey.SubmeshIndex;
-		}
+		uint32_t Frame = 0;
+		std::string Pass;
+		float CPUTime = -1.0f;
+		float GPUTime = -1.0f;
 	};
-}
-
-namespace Saturn {
 
 	struct RendererData
 	{
@@ -192,6 +202,16 @@ namespace Saturn {
 		Timer LightCullingTimer;
 		Timer BloomTimer;
 
+		// Schedules the passes and records the barriers between them, rebuilt when the framebuffers are recreated.
+		Ref< RenderGraph > Graph = nullptr;
+
+		// GPU execution time of each pass, the timers above only measure how long the commands took to record.
+		Ref< GPUProfiler > GPUTimer = nullptr;
+
+		// Pass times captured every frame while recording, written out by SceneRenderer::ExportPassTimings.
+		bool RecordPassTimings = false;
+		std::vector< PassTimingSample > PassTimingCapture;
+
 		//////////////////////////////////////////////////////////////////////////
 
 		struct GridMatricesObject
@@ -227,12 +247,6 @@ namespace Saturn {
 			alignas( 4 ) float Roughness;
 		};
 
-		struct PointLights
-		{
-			uint32_t nbLights = 0;
-			PointLight Lights[ 512 ]{};
-		};
-
 		//////////////////////////////////////////////////////////////////////////
 		Ref<StorageBufferSet> StorageBufferSet;
 
@@ -248,6 +262,25 @@ namespace Saturn {
 
 		std::vector< Ref< Pass > > DirShadowMapPasses;
 		std::vector< Ref< Pipeline > > DirShadowMapPipelines;
+		std::vector< Ref< Pipeline > > QuantisedDirShadowMapPipelines;
+
+		// Same as the shadow map passes but keeps the depth that is already in the cascade.
+		Ref< Pass > DirShadowMapLoadPass = nullptr;
+
+		Ref< Image2D > ShadowImage = nullptr;
+		Ref< Image2D > StaticShadowImage = nullptr;
+
+		// Render static casters once and reuse them until the light or a static caster changes.
+		bool EnableStaticShadowCache = true;
+
+		// Order independent hash of every static caster submitted this frame.
+		size_t StaticCasterHash = 0;
+		size_t CachedStaticCasterHash = 0;
+
+		// Cascades that were fully rendered, scrolled or reused as is in the last frame.
+		uint32_t ShadowCascadesRebuilt = 0;
+		uint32_t ShadowCascadesScrolled = 0;
+		uint32_t ShadowCascadesReused = 0;
 
 		float CascadeSplitLambda = 0.92f;
 		float CascadeFarPlaneOffset = 100.0f;
@@ -255,17 +288,23 @@ namespace Saturn {
 		
 		std::vector< ShadowCascade > ShadowCascades;
 
-		// PreDepth + Light culling
+		// PreDepth
 		//////////////////////////////////////////////////////////////////////////
 
 		Ref<Pass> PreDepthPass = nullptr;
 		Ref<Pipeline> PreDepthPipeline = nullptr;
+		Ref<Pipeline> QuantisedPreDepthPipeline = nullptr;
 		Ref<Framebuffer> PreDepthFramebuffer = nullptr;
 		//Ref< DescriptorSet > PreDepthDescriptorSet = nullptr;
 
-		Ref< ComputePipeline > LightCullingPipeline = nullptr;
-		Ref< DescriptorSet > LightCullingDescriptorSet = nullptr;
-		glm::vec3 LightCullingWorkGroups{};
+		// Light culling
+		//////////////////////////////////////////////////////////////////////////
+
+		Ref< LightClusters > PointLightClusters = nullptr;
+
+		// Scratch buffers, kept so they don't allocate every frame.
+		std::vector< glm::vec4 > PointLightSpheres;
+		std::vector< PointLight > VisiblePointLights;
 
 		// Geometry
 		//////////////////////////////////////////////////////////////////////////
@@ -278,6 +317,8 @@ namespace Saturn {
 
 		// Main geometry for static meshes.
 		Ref<Pipeline> StaticMeshPipeline = nullptr;
+		// Same as above but for meshes that use QuantisedStaticVertex.
+		Ref<Pipeline> QuantisedStaticMeshPipeline = nullptr;
 	
 		// GRID
 
@@ -292,7 +333,8 @@ namespace Saturn {
 		Ref<Pipeline> SkyboxPipeline = nullptr;
 
 		Ref< DescriptorSet > SkyboxDescriptorSet = nullptr;
-		Ref< DescriptorSet > PreethamDescriptorSet = nullptr;
+
+		Ref< DynamicSkyBuilder > SkyBuilder = nullptr;
 
 		float SkyboxLod = 0.0f;
 		float Intensity = 1.0f;
@@ -328,7 +370,12 @@ namespace Saturn {
 		//////////////////////////////////////////////////////////////////////////
 
 		Ref<ComputePipeline> BloomComputePipeline = nullptr;
-		Ref<Texture2D> BloomTextures[ 3 ];
+		// Size of the bloom images, half the viewport rounded up to the work group size.
+		glm::uvec2 BloomSize = {};
+		// Ping pong images for the downsample and the first upsample, transient images owned by the render graph.
+		RenderGraphResource BloomScratch[ 2 ] = { InvalidRenderGraphResource, InvalidRenderGraphResource };
+		// Result of the upsample, read by the scene composite. Also transient, it shares memory with the second scratch image.
+		RenderGraphResource BloomOutput = InvalidRenderGraphResource;
 		Ref<Texture2D> BloomDirtTexture = nullptr;
 		Ref< DescriptorSet > BloomDS = nullptr;
 
@@ -348,23 +395,85 @@ namespace Saturn {
 		// Physics Outline
 		//////////////////////////////////////////////////////////////////////////
 		Ref<Pipeline> PhysicsOutlinePipeline = nullptr;
+		Ref<Pipeline> QuantisedPhysicsOutlinePipeline = nullptr;
 		Ref<Material> PhysicsOutlineMaterial = nullptr;
 
 		// Instanced Rendering
 		//////////////////////////////////////////////////////////////////////////
 		// 		
-		// MESH ID -> TRANSFORMS
-		std::unordered_map< StaticMeshKey, TransformBuffer > MeshTransforms;
+		// Persistent transform data for every submesh instance, only changed transforms are uploaded.
+		Ref< InstanceBuffer > InstanceTransforms = nullptr;
+
+		// Static Mesh LODs
+		//////////////////////////////////////////////////////////////////////////
+
+		bool EnableLods = true;
+
+		// Highest allowed simplification error of a LOD, in pixels.
+		float LodPixelError = 1.0f;
+
+		// A LOD has to be this much (as a fraction of LodPixelError) past the threshold before we switch, stops LODs from popping back and forth.
+		float LodHysteresis = 0.2f;
+
+		// Updated in SetCamera.
+		glm::vec3 LodCameraPosition{};
+		float LodProjectionScale = 0.0f;
 
-		// This holds the entire transform data for each submesh, per frame in flight.
-		std::vector< SubmeshTransformVB > SubmeshTransformData;
+		// Triangles submitted this frame, and how many there would have been without LODs.
+		uint32_t LodTriangles = 0;
+		uint32_t FullDetailTriangles = 0;
+
+		uint32_t LastLodTriangles = 0;
+		uint32_t LastFullDetailTriangles = 0;
+
+		// Texture Streaming
+		//////////////////////////////////////////////////////////////////////////
+
+		bool EnableTextureStreaming = true;
+
+		// Added to the mip a draw asks for, positive values trade sharpness for memory.
+		float TextureMipBias = 0.0f;
+
+		// Occlusion Culling
+		//////////////////////////////////////////////////////////////////////////
+
+		Ref< OcclusionCuller > OcclusionBuffer = nullptr;
+
+		bool EnableOcclusionCulling = true;
+
+		// Use any mesh that is large enough on screen as an occluder, not only the ones that are marked as occluders.
+		bool AutomaticOccluders = true;
+
+		// Radius on screen, in pixels, that a mesh must have to be picked as an automatic occluder.
+		float OccluderScreenRadius = 128.0f;
+
+		uint32_t MaxOccluderTriangles = 100000;
+
+		uint32_t OcclusionTested = 0;
+		uint32_t OcclusionCulled = 0;
+
+		uint32_t LastOcclusionTested = 0;
+		uint32_t LastOcclusionCulled = 0;
+		float LastOcclusionTime = 0.0f;
+
+		// Instances of instanced meshes, these are culled per cluster.
+		uint32_t InstancesTested = 0;
+		uint32_t InstancesCulled = 0;
+
+		uint32_t LastInstancesTested = 0;
+		uint32_t LastInstancesCulled = 0;
+
+		// Command Recording
+		//////////////////////////////////////////////////////////////////////////
+
+		// Draws per secondary command buffer in the pre depth, shadow and geometry passes, each secondary is recorded on a job system thread.
+		uint32_t DrawsPerSecondary = 128;
 
 		//////////////////////////////////////////////////////////////////////////
 		// SHADERS
 
 		Ref< Shader > GridShader = nullptr;
 		Ref< Shader > SkyboxShader = nullptr;
-		Ref< Shader > PreethamShader = nullptr;
 		Ref< Shader > StaticMeshShader = nullptr;
 		Ref< Shader > SceneCompositeShader = nullptr;
 		Ref< Shader > TexturePassShader = nullptr;
@@ -372,7 +481,6 @@ namespace Saturn {
 		Ref< Shader > SelectedGeometryShader = nullptr;
 		Ref< Shader > AOCompositeShader = nullptr;
 		Ref< Shader > PreDepthShader = nullptr;
-		Ref< Shader > LightCullingShader = nullptr;
 		Ref< Shader > BloomShader = nullptr;
 		Ref< Shader > PhysicsOutlineShader = nullptr;
 	};
@@ -389,7 +497,12 @@ namespace Saturn {
 
 		void SetCurrentScene( Scene* pScene );
 
-		void SubmitStaticMesh( Ref<Entity> entity, Ref< StaticMesh > mesh, Ref<MaterialRegistry> materialRegistry, const glm::mat4& transform );
+		// Occluders are always rasterised into the occlusion buffer, other meshes only when they are large enough on screen.
+		// Static meshes are cached in the shadow maps, stationary meshes are not as they can still be hidden or changed.
+		void SubmitStaticMesh( Ref<Entity> entity, Ref< StaticMesh > mesh, Ref<MaterialRegistry> materialRegistry, const glm::mat4& transform, bool Occluder = false, Mobility MeshMobility = Mobility::Movable );
+
+		// Instances are never occluders, clusters outside of the view or behind the occluders only go into the shadow maps.
+		void SubmitInstancedStaticMesh( Ref<Entity> entity, Ref< StaticMesh > mesh, Ref<MaterialRegistry> materialRegistry, Ref<InstanceClusterTree> clusters, const glm::mat4& transform, bool CastShadows = true, Mobility MeshMobility = Mobility::Movable );
 		
 		// This will work for now (as atm now we are just gonna render the mesh ).
 		// However, if we have a different collider mesh than the mesh it will not be correct.
@@ -422,12 +535,22 @@ namespace Saturn {
 		uint32_t Width() { return m_RendererData.Width; }
 		uint32_t Height() { return m_RendererData.Height; }
 
+		// CPU and GPU times of every pass from the last frame that finished on the GPU.
+		std::vector< PassTimingSample > GetPassTimings() const;
+
+		// Writes the recorded pass times as CSV, or the last frame's times when nothing was recorded.
+		bool ExportPassTimings( const std::filesystem::path& rPath );
+
+		// Records the camera, the lights and every mesh that is submitted in the next frame, the capture is written to rPath once that frame is rendered.
+		// Captures can be replayed without a device by DrawListReplay (Saturn-Replay).
+		void CaptureDrawList( const std::filesystem::path& rPath );
+
 	private:
 		void Init();
 		void Terminate();
 
-		void RenderGrid();
-		void RenderSkybox();
+		void RenderGrid( VkCommandBuffer CommandBuffer );
+		void RenderSkybox( VkCommandBuffer CommandBuffer );
 		void CheckInvalidSkybox();
 
 		void UpdateCascades( const glm::vec3& Direction );
@@ -449,11 +572,15 @@ namespace Saturn {
 
 		void InitBuffers();
 
+		void BuildRenderGraph();
+
 		void DirShadowMapPass();
+		void RenderShadowCasters( uint32_t Cascade, Ref< Pass > ShadowPass, Ref< Framebuffer > ShadowFramebuffer, ShadowCasters Casters, const std::vector<VkRect2D>& rRegions = {} );
 		void PreDepthPass();
 		void LightCullingPass();
 		void GeometryPass();
 		void BloomPass();
+		void BloomUpsamplePass();
 		void SceneCompositePass();
 		void LateCompPhysicsOutline();
 		void TexturePass();
@@ -461,10 +588,32 @@ namespace Saturn {
 		void RenderStaticMeshes();
 		//void RenderDynamicMeshes();
 
+		using DrawListEntry = std::pair< const StaticMeshKey*, const DrawCommand* >;
+		static void GatherDraws( const std::unordered_map< StaticMeshKey, DrawCommand >& rDrawList, std::vector< DrawListEntry >& rDraws );
+
+		StaticMeshSelectionSettings GetSelectionSettings() const;
+		// Picks the LOD of an instance and remembers it for the hysteresis of the next frame.
+		uint32_t SelectLod( const Submesh& rSubmesh, const glm::mat4& rTransform, size_t InstanceID );
+
+		void AddStaticSubmesh( const PendingSubmesh& rSubmesh, bool Visible );
+		// Asks the texture streamer for the mips the submesh's material textures need at its size on screen.
+		void RequestTextureMips( const PendingSubmesh& rSubmesh );
+		void CullStaticMeshes();
+		void AddInstancedStaticMeshes();
+
+		void CapturePassTimings();
+
+		void CaptureSubmission( Ref<Entity> entity, Ref< StaticMesh > mesh, Ref<MaterialRegistry> materialRegistry, const glm::mat4& transform, bool Occluder, bool Static, bool PhysicsCollider );
+		uint32_t CaptureMesh( const Ref< StaticMesh >& rMesh );
+		void SaveDrawListCapture();
+
 		void AddScheduledFunction( ScheduledFunc&& rrFunc );
 		void OnShaderReloaded( const std::string& rName );
 
 		Ref<TextureCube> CreateDymanicSky();
+		void UpdateDynamicSky();
+
+		Ref<Texture2D> CreateBRDFLut();
 	private:
 		SceneRendererFlags m_Flags;
 
@@ -475,6 +624,26 @@ namespace Saturn {
 		std::unordered_map< StaticMeshKey, DrawCommand > m_ShadowMapDrawList;
 		std::unordered_map< StaticMeshKey, DrawCommand > m_PhysicsColliderDrawList;
 
+		// LOD that every submesh instance used last frame, used for the hysteresis.
+		std::unordered_map< size_t, uint32_t > m_PreviousLods;
+		std::unordered_map< size_t, uint32_t > m_CurrentLods;
+
+		std::vector< PendingSubmesh > m_PendingSubmeshes;
+		std::vector< PendingInstancedMesh > m_PendingInstancedMeshes;
+		std::vector< TextureMipRequest > m_TextureRequests;
+
+		// Set once the occluders of this frame have been rasterised.
+		bool m_OcclusionBufferReady = false;
+
+		// Armed by CaptureDrawList, recording starts at the next SetCamera and the capture is saved in RenderScene.
+		std::filesystem::path m_DrawListCapturePath;
+		bool m_DrawListCaptureArmed = false;
+		bool m_CapturingDrawList = false;
+
+		DrawListCapture m_DrawListCapture;
+		std::unordered_map< AssetID, uint32_t > m_CapturedMeshes;
+		std::unordered_map< MaterialRegistry*, uint32_t > m_CapturedRegistries;
+
 		std::vector< ScheduledFunc > m_ScheduledFunctions;
 
 		ScheduledFunc m_LightCullingFunction;
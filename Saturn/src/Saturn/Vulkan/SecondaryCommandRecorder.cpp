@@ -0,0 +1,197 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#include "sppch.h"
+#include "SecondaryCommandRecorder.h"
+
+#include "VulkanContext.h"
+#include "VulkanDebug.h"
+
+#include "Saturn/Core/JobSystem.h"
+#include "Saturn/Core/OptickProfiler.h"
+
+namespace Saturn {
+
+	SecondaryCommandRecorder::SecondaryCommandRecorder()
+	{
+		VkDevice Device = VulkanContext::Get().GetDevice();
+
+		const size_t ThreadCount = JobSystem::Get().GetThreadCount() + 1;
+
+		VkCommandPoolCreateInfo CommandPoolInfo = { VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO };
+		CommandPoolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+		CommandPoolInfo.queueFamilyIndex = VulkanContext::Get().GetQueueFamilyIndices().GraphicsFamily.value();
+
+		for( uint32_t Frame = 0; Frame < MAX_FRAMES_IN_FLIGHT; Frame++ )
+		{
+			m_Frames[ Frame ].resize( ThreadCount );
+
+			for( size_t Thread = 0; Thread < ThreadCount; Thread++ )
+			{
+				VK_CHECK( vkCreateCommandPool( Device, &CommandPoolInfo, nullptr, &m_Frames[ Frame ][ Thread ].CommandPool ) );
+
+				SetDebugUtilsObjectName( std::format( "Secondary Command Pool (Frame {0}, Thread {1})", Frame, Thread ), ( uint64_t ) m_Frames[ Frame ][ Thread ].CommandPool, VK_OBJECT_TYPE_COMMAND_POOL );
+			}
+		}
+	}
+
+	SecondaryCommandRecorder::~SecondaryCommandRecorder()
+	{
+		VkDevice Device = VulkanContext::Get().GetDevice();
+
+		// Destroying a pool frees its command buffers.
+		for( auto& rThreads : m_Frames )
+		{
+			for( auto& rPool : rThreads )
+				vkDestroyCommandPool( Device, rPool.CommandPool, nullptr );
+
+			rThreads.clear();
+		}
+	}
+
+	void SecondaryCommandRecorder::BeginFrame( uint32_t Frame )
+	{
+		SAT_PF_EVENT();
+
+		SAT_CORE_ASSERT( m_Pending.empty(), "Secondary command buffers were recorded but never executed!" );
+
+		m_Frame = Frame;
+
+		m_LastSecondaryCount = m_SecondaryCount;
+		m_SecondaryCount = 0;
+
+		VkDevice Device = VulkanContext::Get().GetDevice();
+
+		for( auto& rPool : m_Frames[ m_Frame ] )
+		{
+			if( rPool.Used == 0 )
+				continue;
+
+			VK_CHECK( vkResetCommandPool( Device, rPool.CommandPool, 0 ) );
+			rPool.Used = 0;
+		}
+	}
+
+	void SecondaryCommandRecorder::BeginRenderPass( VkRenderPass RenderPass, VkFramebuffer Framebuffer, uint32_t Subpass )
+	{
+		SAT_CORE_ASSERT( m_Pending.empty(), "The last render pass was not ended!" );
+
+		m_Inheritance.renderPass = RenderPass;
+		m_Inheritance.subpass = Subpass;
+		m_Inheritance.framebuffer = Framebuffer;
+	}
+
+	VkCommandBuffer SecondaryCommandRecorder::BeginSecondary()
+	{
+		const uint32_t ThreadIndex = JobSystem::GetThreadIndex();
+
+		SAT_CORE_ASSERT( ThreadIndex < m_Frames[ m_Frame ].size(), "Job system has more threads than command pools!" );
+
+		ThreadPool& rPool = m_Frames[ m_Frame ][ ThreadIndex ];
+
+		if( rPool.Used == rPool.CommandBuffers.size() )
+		{
+			VkCommandBufferAllocateInfo AllocateInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO };
+			AllocateInfo.commandPool = rPool.CommandPool;
+			AllocateInfo.commandBufferCount = 1;
+			AllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+
+			VkCommandBuffer CommandBuffer = nullptr;
+			VK_CHECK( vkAllocateCommandBuffers( VulkanContext::Get().GetDevice(), &AllocateInfo, &CommandBuffer ) );
+
+			rPool.CommandBuffers.push_back( CommandBuffer );
+		}
+
+		VkCommandBuffer CommandBuffer = rPool.CommandBuffers[ rPool.Used++ ];
+
+		VkCommandBufferBeginInfo BeginInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+		BeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+		BeginInfo.pInheritanceInfo = &m_Inheritance;
+
+		VK_CHECK( vkBeginCommandBuffer( CommandBuffer, &BeginInfo ) );
+
+		return CommandBuffer;
+	}
+
+	void SecondaryCommandRecorder::Record( const RecordFunc& rFunc )
+	{
+		SAT_PF_EVENT();
+
+		VkCommandBuffer CommandBuffer = BeginSecondary();
+
+		rFunc( CommandBuffer );
+
+		VK_CHECK( vkEndCommandBuffer( CommandBuffer ) );
+
+		m_Pending.push_back( CommandBuffer );
+	}
+
+	void SecondaryCommandRecorder::RecordParallel( uint32_t Count, uint32_t BatchSize, const RecordRangeFunc& rFunc )
+	{
+		SAT_PF_EVENT();
+
+		if( Count == 0 )
+			return;
+
+		if( !m_Parallel )
+		{
+			Record( [&]( VkCommandBuffer CommandBuffer ) { rFunc( CommandBuffer, 0, Count ); } );
+			return;
+		}
+
+		BatchSize = std::max( BatchSize, 1u );
+
+		// Every batch writes its own slot so the order does not depend on which thread finished first.
+		const size_t FirstSlot = m_Pending.size();
+		m_Pending.resize( FirstSlot + ( Count + BatchSize - 1 ) / BatchSize );
+
+		JobSystem::Get().ParallelFor( Count, BatchSize, [&]( uint32_t Begin, uint32_t End )
+			{
+				SAT_PF_EVENT();
+
+				VkCommandBuffer CommandBuffer = BeginSecondary();
+
+				rFunc( CommandBuffer, Begin, End );
+
+				VK_CHECK( vkEndCommandBuffer( CommandBuffer ) );
+
+				m_Pending[ FirstSlot + Begin / BatchSize ] = CommandBuffer;
+			} );
+	}
+
+	void SecondaryCommandRecorder::EndRenderPass( VkCommandBuffer Primary )
+	{
+		if( !m_Pending.empty() )
+			vkCmdExecuteCommands( Primary, ( uint32_t ) m_Pending.size(), m_Pending.data() );
+
+		m_SecondaryCount += ( uint32_t ) m_Pending.size();
+
+		m_Pending.clear();
+		m_Inheritance = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO };
+	}
+}
@@ -0,0 +1,102 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#pragma once
+
+#include "Base.h"
+
+#include <vulkan.h>
+
+#include <array>
+#include <functional>
+#include <vector>
+
+namespace Saturn {
+
+	// Records the contents of a render pass into secondary command buffers, in parallel on the job system's threads.
+	// Every thread has its own command pool per frame in flight so recording never takes a lock, the pools are reset once the frame's fence has been waited on.
+	// Secondaries don't inherit any state from the primary, each one has to set its own viewport, scissor, pipeline and descriptor sets.
+	class SecondaryCommandRecorder : public RefTarget
+	{
+	public:
+		using RecordFunc = std::function<void( VkCommandBuffer CommandBuffer )>;
+		using RecordRangeFunc = std::function<void( VkCommandBuffer CommandBuffer, uint32_t Begin, uint32_t End )>;
+
+	public:
+		SecondaryCommandRecorder();
+		~SecondaryCommandRecorder();
+
+		// Resets the command pools of this frame in flight, the GPU must be done with the frame.
+		void BeginFrame( uint32_t Frame );
+
+		// The primary must have begun the render pass with VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS.
+		void BeginRenderPass( VkRenderPass RenderPass, VkFramebuffer Framebuffer, uint32_t Subpass = 0 );
+
+		// Records one secondary on the calling thread.
+		void Record( const RecordFunc& rFunc );
+
+		// Splits [0, Count) into batches of BatchSize and records every batch into its own secondary on the job system.
+		// Returns once every batch has been recorded, the secondaries are executed in batch order.
+		void RecordParallel( uint32_t Count, uint32_t BatchSize, const RecordRangeFunc& rFunc );
+
+		// Executes everything that was recorded since BeginRenderPass, the primary then ends the render pass.
+		void EndRenderPass( VkCommandBuffer Primary );
+
+		// When disabled RecordParallel records all batches into one secondary on the calling thread.
+		void SetParallel( bool Parallel ) { m_Parallel = Parallel; }
+		bool IsParallel() const { return m_Parallel; }
+
+		// How many secondaries were executed in the last frame.
+		uint32_t GetSecondaryCount() const { return m_LastSecondaryCount; }
+
+	private:
+		VkCommandBuffer BeginSecondary();
+
+	private:
+		struct ThreadPool
+		{
+			VkCommandPool CommandPool = nullptr;
+
+			// Command buffers are kept when the pool is reset, Used counts how many have been handed out this frame.
+			std::vector<VkCommandBuffer> CommandBuffers;
+			uint32_t Used = 0;
+		};
+
+		// One pool for every job system thread plus one for the thread that records the primary.
+		std::array<std::vector<ThreadPool>, MAX_FRAMES_IN_FLIGHT> m_Frames;
+		uint32_t m_Frame = 0;
+
+		VkCommandBufferInheritanceInfo m_Inheritance = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO };
+		std::vector<VkCommandBuffer> m_Pending;
+
+		bool m_Parallel = true;
+
+		uint32_t m_SecondaryCount = 0;
+		uint32_t m_LastSecondaryCount = 0;
+	};
+}
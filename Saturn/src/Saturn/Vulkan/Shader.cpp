@@ -35,6 +35,8 @@
 #include "VulkanContext.h"
 #include "VulkanDebug.h"
 #include "Renderer.h"
+#include "BindlessTable.h"
+#include "UniformBufferRing.h"
 
 #include "Saturn/Serialisation/RawSerialisation.h"
 
@@ -48,6 +50,7 @@
 #include <spirv/spirv_glsl.hpp>
 
 #include <cassert>
+#include <map>
 
 #if defined(SAT_DEBUG) || defined(SAT_RELEASE)
 #define SHADER_INFO(...) SAT_CORE_INFO(__VA_ARGS__)
@@ -280,6 +283,10 @@ namespace Saturn {
 
 		for ( auto& [ set, descriptorSet ] : m_DescriptorSets )
 		{
+			// The bindless layout is owned by the bindless table.
+			if( set == BindlessTable::SetIndex )
+				continue;
+
 			vkDestroyDescriptorSetLayout( VulkanContext::Get().GetDevice(), descriptorSet.SetLayout, nullptr );
 		}
 
@@ -369,22 +376,7 @@ namespace Saturn {
 	{
 		SAT_CORE_ASSERT( rSet, "DescriptorSet is null!" );
 
-		// Iterate over uniform buffers
-		for( auto& [set, descriptorSet] : m_DescriptorSets )
-		{
-			for( auto& [binding, ub] : descriptorSet.UniformBuffers )
-			{
-				VkDescriptorBufferInfo BufferInfo = {};
-				BufferInfo.buffer = ub.Buffer;
-				BufferInfo.offset = 0;
-				BufferInfo.range = ub.Size;
-				
-				descriptorSet.WriteDescriptorSets[ binding ].pBufferInfo = &BufferInfo;
-				descriptorSet.WriteDescriptorSets[ binding ].dstSet = rSet->GetVulkanSet();
-
-				vkUpdateDescriptorSets( VulkanContext::Get().GetDevice(), 1, &descriptorSet.WriteDescriptorSets[ binding ], 0, nullptr );
-			}
-		}
+		WriteAllUBs( rSet->GetVulkanSet() );
 	}
 
 	void Shader::WriteAllUBs( VkDescriptorSet Set )
@@ -415,31 +407,39 @@ namespace Saturn {
 		vkUpdateDescriptorSets( VulkanContext::Get().GetDevice(), 1, &m_DescriptorSets[ set ].WriteDescriptorSets[ binding ], 0, nullptr );
 	}
 
-	void* Shader::MapUB( ShaderType Type, uint32_t Set, uint32_t Binding )
+	void Shader::UploadUB( ShaderType Type, uint32_t Set, uint32_t Binding, const void* pData, size_t Size )
 	{
-		auto pAllocator = VulkanContext::Get().GetVulkanAllocator();
+		auto pRing = VulkanContext::Get().GetUniformBufferRing();
+		auto& rUniformBuffer = m_DescriptorSets[ Set ].UniformBuffers[ Binding ];
 
-		auto bufferAloc = pAllocator->GetAllocationFromBuffer( m_DescriptorSets[ Set ].UniformBuffers[ Binding ].Buffer );
-		
-		return pAllocator->MapMemory< void >( bufferAloc );
-	}
+		SAT_CORE_ASSERT( Size <= rUniformBuffer.Size, "Uploading more data than the uniform buffer holds!" );
 
-	void Shader::UnmapUB( ShaderType Type, uint32_t Set, uint32_t Binding )
-	{
-		auto pAllocator = VulkanContext::Get().GetVulkanAllocator();
-		
-		auto bufferAloc = pAllocator->GetAllocationFromBuffer( m_DescriptorSets[ Set ].UniformBuffers[ Binding ].Buffer );
-		
-		pAllocator->UnmapMemory( bufferAloc );
+		rUniformBuffer.Offset = pRing->Allocate( pData, Size );
+		rUniformBuffer.Frame = pRing->GetFrameNumber();
 	}
-	
-	void Shader::UploadUB( ShaderType Type, uint32_t Set, uint32_t Binding, void* pData, size_t Size )
+
+	uint32_t Shader::GetDynamicOffsets( uint32_t Set, uint32_t* pOffsets ) const
 	{
-		auto bufferData = MapUB( Type, Set, Binding );
+		auto Itr = m_DescriptorSets.find( Set );
+
+		if( Itr == m_DescriptorSets.end() )
+			return 0;
 
-		memcpy( bufferData, (const uint8_t*)pData, Size );
+		const uint64_t Frame = VulkanContext::Get().GetUniformBufferRing()->GetFrameNumber();
+		const auto& rDescriptorSet = Itr->second;
+
+		SAT_CORE_ASSERT( rDescriptorSet.DynamicBindings.size() <= MaxDynamicOffsets, "Too many uniform buffers in one set!" );
+
+		uint32_t Count = 0;
+		for( uint32_t Binding : rDescriptorSet.DynamicBindings )
+		{
+			const auto& rUniformBuffer = rDescriptorSet.UniformBuffers.at( Binding );
 
-		UnmapUB( Type, Set, Binding );
+			// Offset 0 is the zero block of the ring.
+			pOffsets[ Count++ ] = rUniformBuffer.Frame == Frame ? rUniformBuffer.Offset : 0;
+		}
+
+		return Count;
 	}
 
 	Ref<DescriptorSet> Shader::CreateDescriptorSet( uint32_t set, bool UseRendererPool /*= false */ )
@@ -777,31 +777,41 @@ namespace Saturn {
 
 		std::vector< VkDescriptorPoolSize > PoolSizes;
 
-		auto pAllocator = VulkanContext::Get().GetVulkanAllocator();
+		m_SetLayouts.clear();
 
 		// Iterate over descriptor sets
 		for( auto& [ set, descriptorSet ] : m_DescriptorSets )
 		{
+			// Set 2 is the global bindless table, every shader that declares it shares one layout.
+			if( set == BindlessTable::SetIndex )
+			{
+				descriptorSet.SetLayout = VulkanContext::Get().GetBindlessTable()->GetSetLayout();
+				continue;
+			}
+
 			std::vector< VkDescriptorSetLayoutBinding > Bindings;
 
+			descriptorSet.DynamicBindings.clear();
+
 			// Iterate over uniform buffers
 			for( auto& [ Binding, ub ] : descriptorSet.UniformBuffers )
 			{
 				VkDescriptorSetLayoutBinding Binding = {};
 				Binding.binding = ub.Binding;
-				Binding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+				Binding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
 				Binding.descriptorCount = 1;
 				Binding.stageFlags = ub.Location == ShaderType::Vertex ? VK_SHADER_STAGE_VERTEX_BIT : ub.Location == ShaderType::All ? VK_SHADER_STAGE_ALL : ub.Location == ShaderType::Compute ? VK_SHADER_STAGE_COMPUTE_BIT : VK_SHADER_STAGE_FRAGMENT_BIT;
 				Binding.pImmutableSamplers = nullptr;
 
-				VkBufferCreateInfo BufferInfo = { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
-				BufferInfo.size = ub.Size;
-				BufferInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
-				BufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+				SAT_CORE_ASSERT( ub.Size <= UniformBufferRing::ZeroBlockSize, "Uniform buffer is too large for the uniform buffer ring!" );
 
-				pAllocator->AllocateBuffer( BufferInfo, VMA_MEMORY_USAGE_CPU_ONLY, &ub.Buffer );
+				// Every uniform buffer lives in the uniform buffer ring.
+				ub.Buffer = VulkanContext::Get().GetUniformBufferRing()->GetBuffer();
+				ub.Frame = 0;
 
-				PoolSizes.push_back( { .type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, .descriptorCount = 250 } );
+				descriptorSet.DynamicBindings.push_back( ub.Binding );
+
+				PoolSizes.push_back( { .type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, .descriptorCount = 250 } );
 
 				Bindings.push_back( Binding );
 
@@ -813,13 +823,16 @@ namespace Saturn {
 					.dstBinding = ub.Binding,
 					.dstArrayElement = 0,
 					.descriptorCount = 1,
-					.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+					.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
 					.pImageInfo = nullptr,
 					.pBufferInfo = nullptr,
 					.pTexelBufferView = nullptr
 				};
 			}
 
+			// Dynamic offsets are consumed in binding order.
+			std::sort( descriptorSet.DynamicBindings.begin(), descriptorSet.DynamicBindings.end() );
+
 			// Iterate over storage buffers
 			for( auto& [Binding, sb] : descriptorSet.StorageBuffers )
 			{
@@ -912,10 +925,17 @@ namespace Saturn {
 			LayoutInfo.pBindings = Bindings.data();
 
 			VK_CHECK( vkCreateDescriptorSetLayout( VulkanContext::Get().GetDevice(), &LayoutInfo, nullptr, &descriptorSet.SetLayout ) );
-
-			m_SetLayouts.push_back( descriptorSet.SetLayout );
 		}
 
+		// Pipeline layouts expect the set layouts in set order.
+		std::map< uint32_t, VkDescriptorSetLayout > OrderedLayouts;
+
+		for( auto& [ set, descriptorSet ] : m_DescriptorSets )
+			OrderedLayouts[ set ] = descriptorSet.SetLayout;
+
+		for( auto& [ set, layout ] : OrderedLayouts )
+			m_SetLayouts.push_back( layout );
+
 		m_SetPool = Ref< DescriptorPool >::Create( PoolSizes, 10000 );
 	}
 
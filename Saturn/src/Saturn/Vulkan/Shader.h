@@ -62,7 +62,10 @@ namespace Saturn {
 		size_t Size = 0;
 		ShaderType Location = ShaderType::None;
 		
+		// The uniform buffer ring, Offset is where the data was last uploaded to and is only valid in Frame.
 		VkBuffer Buffer = VK_NULL_HANDLE;
+		uint32_t Offset = 0;
+		uint64_t Frame = 0;
 
 		bool operator==( const ShaderUniformBuffer& rOther ) 
 		{
@@ -164,6 +167,9 @@ namespace Saturn {
 		std::unordered_map< uint32_t, ShaderUniformBuffer > UniformBuffers;
 		std::unordered_map< uint32_t, ShaderStorageBuffer > StorageBuffers;
 
+		// Uniform buffer bindings in the order the dynamic offsets are passed in.
+		std::vector< uint32_t > DynamicBindings;
+
 		static void Serialise( const ShaderDescriptorSet& rObject, std::ofstream& rStream )
 		{
 			RawSerialisation::WriteObject( rObject.Set, rStream );
@@ -295,6 +301,9 @@ namespace Saturn {
 		
 		using ShaderWriteMap = std::unordered_map< ShaderType, std::unordered_map< std::string, VkWriteDescriptorSet > >;
 
+	public:
+		// maxDescriptorSetUniformBuffersDynamic is at least 8 on every device.
+		static constexpr uint32_t MaxDynamicOffsets = 8;
 
 	public:
 		// Internal default constructor, only used when reading from a shader bundle.
@@ -331,16 +340,18 @@ namespace Saturn {
 
 		void WriteDescriptor( const std::string& rName, VkDescriptorBufferInfo& rBufferInfo, VkDescriptorSet desSet );
 
-		// Make sure all the buffers have data mapped to them!
+		// Points the uniform buffer descriptors at the uniform buffer ring, the offsets are given when the set is bound.
 		void WriteAllUBs( const Ref< DescriptorSet >& rSet );
 		void WriteAllUBs( VkDescriptorSet Set );
 
 		void WriteSB( uint32_t set, uint32_t binding, const VkDescriptorBufferInfo& rInfo, Ref<DescriptorSet>& rSet );
 
-		void* MapUB( ShaderType Type, uint32_t Set, uint32_t Binding );
-		void UnmapUB( ShaderType Type, uint32_t Set, uint32_t Binding );
-		
-		void UploadUB( ShaderType Type, uint32_t Set, uint32_t Binding, void* pData, size_t Size );
+		// Copies the data into the uniform buffer ring, it is only valid for the current frame so upload every frame the set is bound in.
+		void UploadUB( ShaderType Type, uint32_t Set, uint32_t Binding, const void* pData, size_t Size );
+
+		// Writes the ring offsets of the set's uniform buffers in binding order and returns how many there are, pass them when binding the set.
+		// Uniform buffers that were not uploaded this frame read zeros.
+		uint32_t GetDynamicOffsets( uint32_t Set, uint32_t* pOffsets ) const;
 
 		uint32_t GetDescriptorSetCount() { return m_DescriptorSetCount; }
 
@@ -36,7 +36,9 @@ namespace Saturn {
 
 	enum class ShaderDataType
 	{
-		None = 0, Float, Float2, Float3, Float4, Mat3, Mat4, Int, Int2, Int3, Int4, Bool, Sampler2D, SamplerCube
+		None = 0, Float, Float2, Float3, Float4, Mat3, Mat4, Int, Int2, Int3, Int4, Bool, Sampler2D, SamplerCube,
+		// Packed vertex attributes, read as floats in the shader.
+		UShort4Norm, Short2Norm, Half2
 	};
 	
 	// Vulkan shader type sizes
@@ -55,6 +57,9 @@ namespace Saturn {
 			case ShaderDataType::Int3:		return 4 * 3;
 			case ShaderDataType::Int4:		return 4 * 4;
 			case ShaderDataType::Bool:		return 1;
+			case ShaderDataType::UShort4Norm: return 2 * 4;
+			case ShaderDataType::Short2Norm:  return 2 * 2;
+			case ShaderDataType::Half2:       return 2 * 2;
 		}
 
 		return 0;
@@ -94,6 +99,15 @@ namespace Saturn {
 			case ShaderDataType::Mat3:
 				return VK_FORMAT_R32G32B32_SFLOAT;
 				break;
+			case ShaderDataType::UShort4Norm:
+				return VK_FORMAT_R16G16B16A16_UNORM;
+				break;
+			case ShaderDataType::Short2Norm:
+				return VK_FORMAT_R16G16_SNORM;
+				break;
+			case ShaderDataType::Half2:
+				return VK_FORMAT_R16G16_SFLOAT;
+				break;
 			default:
 				break;
 		}
@@ -132,6 +146,15 @@ namespace Saturn {
 			case VK_FORMAT_R8_UNORM:
 				return ShaderDataType::Bool;
 				break;
+			case VK_FORMAT_R16G16B16A16_UNORM:
+				return ShaderDataType::UShort4Norm;
+				break;
+			case VK_FORMAT_R16G16_SNORM:
+				return ShaderDataType::Short2Norm;
+				break;
+			case VK_FORMAT_R16G16_SFLOAT:
+				return ShaderDataType::Half2;
+				break;
 			default:
 				break;
 		}
@@ -165,6 +188,9 @@ namespace Saturn {
 			case ShaderDataType::Mat3:		return "mat3";
 			case ShaderDataType::Mat4:		return "mat4";
 			case ShaderDataType::Sampler2D:	return "sampler2D";
+			case ShaderDataType::UShort4Norm: return "vec4";
+			case ShaderDataType::Short2Norm:  return "vec2";
+			case ShaderDataType::Half2:       return "vec2";
 			case ShaderDataType::None:
 			default:						return "";
 		}
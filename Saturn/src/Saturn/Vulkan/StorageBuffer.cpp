@@ -33,8 +33,8 @@
 
 namespace Saturn {
 
-	StorageBuffer::StorageBuffer( uint32_t set, uint32_t binding )
-		: m_Set( set ), m_Binding( binding )
+	StorageBuffer::StorageBuffer( uint32_t set, uint32_t binding, VmaMemoryUsage MemoryUsage )
+		: m_Set( set ), m_Binding( binding ), m_MemoryUsage( MemoryUsage )
 	{
 		Create();
 	}
@@ -53,7 +53,10 @@ namespace Saturn {
 		BufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
 		auto pAllocator = VulkanContext::Get().GetVulkanAllocator();
-		pAllocator->AllocateBuffer( BufferInfo, VMA_MEMORY_USAGE_GPU_ONLY, &m_Buffer );
+		pAllocator->AllocateBuffer( BufferInfo, m_MemoryUsage, &m_Buffer );
+
+		m_BufferInfo.buffer = m_Buffer;
+		m_BufferInfo.range = VK_WHOLE_SIZE;
 	}
 
 	void StorageBuffer::Resize( uint32_t newSize )
@@ -69,9 +72,29 @@ namespace Saturn {
 		BufferCreateInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
 		BufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
-		pAllocator->AllocateBuffer( BufferCreateInfo, VMA_MEMORY_USAGE_GPU_ONLY, &m_Buffer );
+		pAllocator->AllocateBuffer( BufferCreateInfo, m_MemoryUsage, &m_Buffer );
 
 		m_BufferInfo.buffer = m_Buffer;
 		m_BufferInfo.range = m_Size;
 	}
+
+	void StorageBuffer::Reserve( size_t Size )
+	{
+		if( Size > m_Size )
+			Resize( ( uint32_t ) ( Size + Size / 2 ) );
+	}
+
+	void StorageBuffer::SetData( const void* pData, size_t Size, size_t Offset )
+	{
+		SAT_CORE_ASSERT( m_MemoryUsage != VMA_MEMORY_USAGE_GPU_ONLY, "StorageBuffer::SetData: buffer is not host visible!" );
+
+		Reserve( Offset + Size );
+
+		auto pAllocator = VulkanContext::Get().GetVulkanAllocator();
+		VmaAllocation Allocation = pAllocator->GetAllocationFromBuffer( m_Buffer );
+
+		uint8_t* pDst = pAllocator->MapMemory<uint8_t>( Allocation );
+		memcpy( pDst + Offset, pData, Size );
+		pAllocator->UnmapMemory( Allocation );
+	}
 }
\ No newline at end of file
@@ -29,6 +29,8 @@
 #pragma once
 
 #include "Saturn/Core/Base.h"
+#include "VulkanAllocator.h"
+
 #include <vulkan.h>
 
 namespace Saturn {
@@ -36,11 +38,19 @@ namespace Saturn {
 	class StorageBuffer : public RefTarget
 	{
 	public:
-		StorageBuffer(uint32_t set, uint32_t binding);
+		StorageBuffer( uint32_t set, uint32_t binding, VmaMemoryUsage MemoryUsage = VMA_MEMORY_USAGE_GPU_ONLY );
 		~StorageBuffer();
 
 		void Resize( uint32_t newSize );
 
+		// Grows the buffer so it can hold at least Size bytes, the contents are not kept when it grows.
+		void Reserve( size_t Size );
+
+		// Copies the data into the buffer, the buffer grows when it is too small. Only for host visible buffers.
+		void SetData( const void* pData, size_t Size, size_t Offset = 0 );
+
+		size_t GetSize() const { return m_Size; }
+
 		VkBuffer GetBuffer() { return m_Buffer; }
 
 		const VkDescriptorBufferInfo& GetBufferInfo() { return m_BufferInfo; }
@@ -51,9 +61,10 @@ namespace Saturn {
 		void Create();
 	private:
 		VkDescriptorBufferInfo m_BufferInfo{};
-		size_t m_Size;
+		size_t m_Size = 0;
 
 		VkBuffer m_Buffer = VK_NULL_HANDLE;
+		VmaMemoryUsage m_MemoryUsage = VMA_MEMORY_USAGE_GPU_ONLY;
 
 		uint32_t m_Binding;
 		uint32_t m_Set;
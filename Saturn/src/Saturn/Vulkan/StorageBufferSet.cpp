@@ -58,6 +58,14 @@ namespace Saturn {
 		Set( sb, set, binding );
 	}
 
+	void StorageBufferSet::CreatePerFrame( uint32_t set, uint32_t binding, VmaMemoryUsage MemoryUsage )
+	{
+		for( int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++ )
+		{
+			m_Buffers[ set ][ binding ][ i ] = Ref<StorageBuffer>::Create( set, binding, MemoryUsage );
+		}
+	}
+
 	void StorageBufferSet::Set( Ref<StorageBuffer>& rBuffer, uint32_t set, uint32_t binding )
 	{
 		for( int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++ )
@@ -45,6 +45,9 @@ namespace Saturn {
 
 		void Create( uint32_t set, uint32_t binding );
 
+		// Creates a buffer for every frame in flight so the CPU can write a frame while the GPU is still reading the last one.
+		void CreatePerFrame( uint32_t set, uint32_t binding, VmaMemoryUsage MemoryUsage = VMA_MEMORY_USAGE_CPU_TO_GPU );
+
 		void Resize( uint32_t set, uint32_t binding, uint32_t frame, size_t newSize );
 		void Resize( uint32_t set, uint32_t binding, size_t newSize );
 
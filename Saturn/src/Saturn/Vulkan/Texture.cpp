@@ -32,6 +32,12 @@
 #include "VulkanContext.h"
 #include "VulkanDebug.h"
 #include "VulkanImageAux.h"
+#include "UploadManager.h"
+#include "BindlessTable.h"
+#include "TextureStreamer.h"
+#include "MipGenerator.h"
+
+#include "Saturn/Asset/TextureImporter.h"
 
 #include <stb_image.h>
 #include <backends/imgui_impl_vulkan.h>
@@ -421,16 +427,66 @@ namespace Saturn {
 		SetData( pData );
 	}
 
+	Texture2D::Texture2D( ImageFormat format, uint32_t width, uint32_t height, const std::vector<Buffer>& rMips )
+		: Texture( width, height, VulkanFormat( format ), nullptr )
+	{
+		SetMips( rMips );
+	}
+
+	Texture2D::Texture2D( const std::filesystem::path& rPath, ImageFormat format, uint32_t width, uint32_t height, TextureMipLoader Loader, const uint8_t* pPixels, bool srgb )
+		: Texture( rPath, AddressingMode::Repeat ), m_Streamed( true ), m_SRGB( srgb ), m_MipLoader( std::move( Loader ) )
+	{
+		m_Width = width;
+		m_Height = height;
+		m_ImageFormat = VulkanFormat( format );
+		m_MipCount = GetMipMapLevels();
+
+		CreateSampler( m_MipCount );
+
+		VulkanContext::Get().GetTextureStreamer()->Register( this, pPixels );
+	}
+
 	void Texture2D::Terminate()
 	{
 		if( m_IsRendererTexture && !m_ForceTerminate )
 			return;
 
+		if( BindlessTable* pTable = VulkanContext::Get().GetBindlessTable() )
+			pTable->ReleaseTexture( this );
+
+		if( m_Streamed )
+		{
+			if( TextureStreamer* pStreamer = VulkanContext::Get().GetTextureStreamer() )
+				pStreamer->Unregister( this );
+		}
+
 		Texture::Terminate();
 	}
 
 	void Texture2D::Copy( Ref<Texture2D> rOther )
 	{
+		// The image of a streamed texture is replaced whenever its residency changes, so the copy streams its own image from the same loader.
+		if( rOther->m_Streamed )
+		{
+			m_Width = rOther->m_Width;
+			m_Height = rOther->m_Height;
+			m_ImageFormat = rOther->m_ImageFormat;
+			m_AddressingMode = rOther->m_AddressingMode;
+			m_Path = rOther->m_Path;
+
+			m_Streamed = true;
+			m_Flipped = rOther->m_Flipped;
+			m_SRGB = rOther->m_SRGB;
+			m_MipCount = rOther->m_MipCount;
+			m_MipLoader = rOther->m_MipLoader;
+
+			CreateSampler( m_MipCount );
+
+			VulkanContext::Get().GetTextureStreamer()->Register( this );
+
+			return;
+		}
+
 		m_Image = rOther->m_Image;
 		m_ImageMemory = rOther->m_ImageMemory;
 		m_ImageView = rOther->m_ImageView;
@@ -453,104 +509,118 @@ namespace Saturn {
 	{
 		SAT_CORE_ASSERT( std::filesystem::exists( m_Path ), "Path does not exist!" );
 
-		int Width, Height, Channels;
+		if( stbi_is_hdr( m_Path.string().c_str() ) )
+			SAT_CORE_INFO( "Loading HDR texture {0}", m_Path.string() );
+		else
+			SAT_CORE_INFO( "Loading texture {0}", m_Path.string() );
 
-		// Flip texture
-		stbi_set_flip_vertically_on_load( flip );
+		DecodedImage Image = TextureImporter::Decode( m_Path, flip );
 
-		stbi_uc* pTextureData;
+		m_HDR = Image.HDR;
 
-		if( stbi_is_hdr( m_Path.string().c_str() ) )
-		{
-			SAT_CORE_INFO( "Loading HDR texture {0}", m_Path.string() );
-			pTextureData = ( uint8_t* ) stbi_loadf( m_Path.string().c_str(), &Width, &Height, &Channels, 4 );
+		m_Width = Image.Width;
+		m_Height = Image.Height;
+		m_Flipped = flip;
 
-			m_HDR = true;
-		}
-		else
+		m_ImageFormat = VK_FORMAT_R8G8B8A8_UNORM;
+
+		// HDR textures are environments and are always fully resident.
+		if( m_Streamed && !m_HDR )
 		{
-			SAT_CORE_INFO( "Loading texture {0}", m_Path.string() );
+			m_MipCount = GetMipMapLevels();
+
+			CreateSampler( m_MipCount );
 
-			pTextureData = stbi_load( m_Path.string().c_str(), &Width, &Height, &Channels, 4 );
+			m_MipLoader = TextureStreamer::CreateFileLoader( m_Path, flip, m_SRGB, m_Width, m_Height );
 
-			m_HDR = false;
+			// Uploads the mip tail, the pixels are not kept as the streamer decodes the file again when it needs more.
+			VulkanContext::Get().GetTextureStreamer()->Register( this, ( const uint8_t* ) Image.pPixels );
 		}
+		else if( m_HDR )
+		{
+			m_Streamed = false;
 
-		m_pData = pTextureData;
+			SetData( Image.pPixels );
+		}
+		else
+		{
+			m_Streamed = false;
 
-		m_Width = Width;
-		m_Height = Height;
+			// The mips are built here instead of blitted on the GPU so they can be filtered in linear space.
+			std::vector<Buffer> Mips = MipGenerator::GenerateMips( ( const uint8_t* ) Image.pPixels, m_Width, m_Height, MipFilter::Box, m_SRGB );
 
-		m_ImageFormat = VK_FORMAT_R8G8B8A8_UNORM;
+			SetMips( Mips );
 
-		SetData( m_pData );
+			for( Buffer& rMip : Mips )
+				rMip.Free();
+		}
 
-		stbi_image_free( pTextureData );
+		Image.Free();
 	}
 
 	void Texture2D::CreateMips()
 	{
-		VkCommandBuffer CommandBuffer = VulkanContext::Get().BeginSingleTimeCommands();
-
 		uint32_t mips = GetMipMapLevels();
 
-		VkImageMemoryBarrier barrier = { VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
-		barrier.image = m_Image;
-		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-
-		for( size_t i = 1; i < mips; i++ )
+		// Recorded into the current upload batch so it runs after mip 0 has been uploaded, blits need the graphics queue.
+		VulkanContext::Get().GetUploadManager()->RecordGraphicsCommands( [&]( VkCommandBuffer CommandBuffer )
 		{
-			VkImageBlit imageBlit{};
-
-			imageBlit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-			imageBlit.srcSubresource.layerCount = 1;
-			imageBlit.srcSubresource.mipLevel = ( uint32_t ) i - 1;
-			imageBlit.srcOffsets[ 1 ].x = int32_t( m_Width >> ( i - 1 ) );
-			imageBlit.srcOffsets[ 1 ].y = int32_t( m_Height >> ( i - 1 ) );
-			imageBlit.srcOffsets[ 1 ].z = 1;
-
-			imageBlit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-			imageBlit.dstSubresource.layerCount = 1;
-			imageBlit.dstSubresource.mipLevel = ( uint32_t ) i;
-			imageBlit.dstOffsets[ 1 ].x = int32_t( m_Width >> i );
-			imageBlit.dstOffsets[ 1 ].y = int32_t( m_Height >> i );
-			imageBlit.dstOffsets[ 1 ].z = 1;
+			VkImageMemoryBarrier barrier = { VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
+			barrier.image = m_Image;
+			barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
 
-			VkImageSubresourceRange mipSubRange = {};
-			mipSubRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-			mipSubRange.baseMipLevel = ( uint32_t ) i;
-			mipSubRange.levelCount = 1;
-			mipSubRange.layerCount = 1;
+			for( size_t i = 1; i < mips; i++ )
+			{
+				VkImageBlit imageBlit{};
 
-			ImagePipelineBarrier( CommandBuffer, m_Image, 0, VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, mipSubRange );
+				imageBlit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+				imageBlit.srcSubresource.layerCount = 1;
+				imageBlit.srcSubresource.mipLevel = ( uint32_t ) i - 1;
+				imageBlit.srcOffsets[ 1 ].x = int32_t( m_Width >> ( i - 1 ) );
+				imageBlit.srcOffsets[ 1 ].y = int32_t( m_Height >> ( i - 1 ) );
+				imageBlit.srcOffsets[ 1 ].z = 1;
 
-			vkCmdBlitImage( CommandBuffer, m_Image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, m_Image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &imageBlit, VK_FILTER_LINEAR );
+				imageBlit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+				imageBlit.dstSubresource.layerCount = 1;
+				imageBlit.dstSubresource.mipLevel = ( uint32_t ) i;
+				imageBlit.dstOffsets[ 1 ].x = int32_t( m_Width >> i );
+				imageBlit.dstOffsets[ 1 ].y = int32_t( m_Height >> i );
+				imageBlit.dstOffsets[ 1 ].z = 1;
 
-			ImagePipelineBarrier( CommandBuffer, m_Image, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, mipSubRange );
-		}
+				VkImageSubresourceRange mipSubRange = {};
+				mipSubRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+				mipSubRange.baseMipLevel = ( uint32_t ) i;
+				mipSubRange.levelCount = 1;
+				mipSubRange.layerCount = 1;
 
-		VkImageSubresourceRange range =
-		{
-			.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
-			.baseMipLevel = 0,
-			.levelCount = mips,
-			.baseArrayLayer = 0,
-			.layerCount = 1
-		};
-
-		if( !m_Storage )
-		{
-			ImagePipelineBarrier( CommandBuffer, m_Image, VK_ACCESS_TRANSFER_READ_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, range );
+				ImagePipelineBarrier( CommandBuffer, m_Image, 0, VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, mipSubRange );
 
-			m_DescriptorImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-		}
-		else
-		{
-			ImagePipelineBarrier( CommandBuffer, m_Image, VK_ACCESS_TRANSFER_READ_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_GENERAL, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, range );
-		}
+				vkCmdBlitImage( CommandBuffer, m_Image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, m_Image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &imageBlit, VK_FILTER_LINEAR );
 
-		VulkanContext::Get().EndSingleTimeCommands( CommandBuffer );
+				ImagePipelineBarrier( CommandBuffer, m_Image, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, mipSubRange );
+			}
+
+			VkImageSubresourceRange range =
+			{
+				.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+				.baseMipLevel = 0,
+				.levelCount = mips,
+				.baseArrayLayer = 0,
+				.layerCount = 1
+			};
+
+			if( !m_Storage )
+			{
+				ImagePipelineBarrier( CommandBuffer, m_Image, VK_ACCESS_TRANSFER_READ_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, range );
+
+				m_DescriptorImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+			}
+			else
+			{
+				ImagePipelineBarrier( CommandBuffer, m_Image, VK_ACCESS_TRANSFER_READ_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_GENERAL, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, range );
+			}
+		} );
 
 		m_MipsCreated = true;
 	}
@@ -563,7 +633,8 @@ namespace Saturn {
 
 			VkImageSubresourceRange range{};
 			range.aspectMask = VulkanIsDepth( m_ImageFormat ) ? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT;
-			range.baseMipLevel = mip;
+			// Mips that are not resident show the most detailed one that is.
+			range.baseMipLevel = mip > m_ResidentMip ? mip - m_ResidentMip : 0;
 			range.layerCount = 1;
 			range.baseArrayLayer = 0;
 			range.levelCount = 1;
@@ -585,31 +656,10 @@ namespace Saturn {
 
 	void Texture2D::SetData( const void* pData )
 	{
-		auto pAllocator = VulkanContext::Get().GetVulkanAllocator();
-
 		VkDeviceSize ImageSize = m_Width * m_Height * 4;
 
 		auto MipCount = GetMipMapLevels();
 
-		// Staging Buffer.
-		VkBuffer StagingBuffer = nullptr;
-
-		if( pData )
-		{
-			VkBufferCreateInfo BufferCreateInfo = { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
-			BufferCreateInfo.size = ImageSize;
-			BufferCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-			BufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-
-			auto rBufferAlloc = pAllocator->AllocateBuffer( BufferCreateInfo, VMA_MEMORY_USAGE_CPU_ONLY, &StagingBuffer );
-
-			void* pDstData = pAllocator->MapMemory< void* >( rBufferAlloc );
-
-			memcpy( pDstData, pData, ImageSize );
-
-			pAllocator->UnmapMemory( rBufferAlloc );
-		}
-
 		// Create the image.
 		if( m_ImageMemory )
 			vkFreeMemory( VulkanContext::Get().GetDevice(), m_ImageMemory, nullptr );
@@ -624,24 +674,47 @@ namespace Saturn {
 
 		CreateImage( m_Width, m_Height, m_ImageFormat, VK_IMAGE_TYPE_2D, VK_IMAGE_TILING_OPTIMAL, usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_Image, m_ImageMemory, MipCount, 1 );
 
-		//if( m_Storage )
-		//	TransitionImageLayout( m_ImageFormat, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL );
-		//else
-			TransitionImageLayout( m_ImageFormat, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL );
+		VkMemoryRequirements MemReq;
+		vkGetImageMemoryRequirements( VulkanContext::Get().GetDevice(), m_Image, &MemReq );
 
-		if( m_pData )
-			CopyBufferToImage( StagingBuffer );
+		m_MipCount = MipCount;
+		m_ResidentSize = MemReq.size;
 
-		// TRANSITION (based on following conditions):
-		// TRANSFER_DST_OPTIMAL to TRANSFER_SRC_OPTIMAL if we have mips
-		// TRANSFER_DST_OPTIMAL to SHADER_READ_ONLY_OPTIMAL if we do not mips and we are not a storage image
-		// TRANSFER_DST_OPTIMAL to GENERAL if do not have mips and we are a storage image.
-		if( MipCount > 1 )
-			TransitionImageLayout( m_ImageFormat, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL );
-		else if( !m_Storage )
-			TransitionImageLayout( m_ImageFormat, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL );
+		if( pData )
+		{
+			// FINAL LAYOUT (based on following conditions):
+			// TRANSFER_SRC_OPTIMAL if we have mips
+			// SHADER_READ_ONLY_OPTIMAL if we do not mips and we are not a storage image
+			// GENERAL if do not have mips and we are a storage image.
+			VkImageLayout FinalLayout = VK_IMAGE_LAYOUT_GENERAL;
+			VkAccessFlags DstAccess = VK_ACCESS_SHADER_READ_BIT;
+			VkPipelineStageFlags DstStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+
+			if( MipCount > 1 )
+			{
+				FinalLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+				DstAccess = VK_ACCESS_TRANSFER_READ_BIT;
+				DstStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+			}
+			else if( !m_Storage )
+			{
+				FinalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+			}
+
+			// Batched with the other uploads, the staging copy happens now and the GPU copy before the next frame is submitted.
+			VulkanContext::Get().GetUploadManager()->UploadImage( m_Image, pData, ImageSize, { ( uint32_t ) m_Width, ( uint32_t ) m_Height, 1 }, VK_IMAGE_ASPECT_COLOR_BIT, FinalLayout, DstAccess, DstStage );
+		}
 		else
-			TransitionImageLayout( m_ImageFormat, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_GENERAL );
+		{
+			TransitionImageLayout( m_ImageFormat, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL );
+
+			if( MipCount > 1 )
+				TransitionImageLayout( m_ImageFormat, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL );
+			else if( !m_Storage )
+				TransitionImageLayout( m_ImageFormat, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL );
+			else
+				TransitionImageLayout( m_ImageFormat, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_GENERAL );
+		}
 
 		// Create image views
 		if( m_ImageView )
@@ -656,7 +729,62 @@ namespace Saturn {
 
 		m_ImageView = CreateImageView( range, m_Image, m_ImageFormat );
 
-		// Create sampler
+		CreateSampler( MipCount );
+
+		m_DescriptorImageInfo = {};
+		m_DescriptorImageInfo.imageLayout = m_Storage ? VK_IMAGE_LAYOUT_GENERAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		m_DescriptorImageInfo.imageView = m_ImageView;
+		m_DescriptorImageInfo.sampler = m_Sampler;
+
+		m_DescriptorSet = ( VkDescriptorSet ) ImGui_ImplVulkan_AddTexture( m_Sampler, m_ImageView, m_Storage ? VK_IMAGE_LAYOUT_GENERAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL );
+
+		if( MipCount > 1 )
+			CreateMips();
+	}
+
+	void Texture2D::SetMips( const std::vector<Buffer>& rMips )
+	{
+		const uint32_t MipCount = ( uint32_t ) rMips.size();
+
+		CreateImage( m_Width, m_Height, m_ImageFormat, VK_IMAGE_TYPE_2D, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_Image, m_ImageMemory, MipCount, 1 );
+
+		VkMemoryRequirements MemReq;
+		vkGetImageMemoryRequirements( VulkanContext::Get().GetDevice(), m_Image, &MemReq );
+
+		m_MipCount = MipCount;
+		m_ResidentSize = MemReq.size;
+		m_MipsCreated = true;
+
+		// Block compressed mips are copied with their texel extent, the last row and column of blocks may hang over the edge.
+		for( uint32_t Mip = 0; Mip < MipCount; Mip++ )
+		{
+			auto [Width, Height] = GetMipSize( Mip );
+
+			VulkanContext::Get().GetUploadManager()->UploadImage( m_Image, rMips[ Mip ].Data, rMips[ Mip ].Size, { Width, Height, 1 }, VK_IMAGE_ASPECT_COLOR_BIT,
+				VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, Mip );
+		}
+
+		VkImageSubresourceRange range = {};
+		range.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		range.baseMipLevel = 0;
+		range.baseArrayLayer = 0;
+		range.layerCount = 1;
+		range.levelCount = MipCount;
+
+		m_ImageView = CreateImageView( range, m_Image, m_ImageFormat );
+
+		CreateSampler( MipCount );
+
+		m_DescriptorImageInfo = {};
+		m_DescriptorImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		m_DescriptorImageInfo.imageView = m_ImageView;
+		m_DescriptorImageInfo.sampler = m_Sampler;
+
+		m_DescriptorSet = ( VkDescriptorSet ) ImGui_ImplVulkan_AddTexture( m_Sampler, m_ImageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL );
+	}
+
+	void Texture2D::CreateSampler( uint32_t MipCount )
+	{
 		VkSamplerCreateInfo SamplerCreateInfo = { VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO };
 		SamplerCreateInfo.magFilter = VK_FILTER_LINEAR;
 		SamplerCreateInfo.minFilter = VK_FILTER_LINEAR;
@@ -688,16 +816,39 @@ namespace Saturn {
 			vkDestroySampler( VulkanContext::Get().GetDevice(), m_Sampler, nullptr );
 
 		VK_CHECK( vkCreateSampler( VulkanContext::Get().GetDevice(), &SamplerCreateInfo, nullptr, &m_Sampler ) );
+	}
+
+	void Texture2D::CreateResidentImage( uint32_t ResidentMip )
+	{
+		auto [Width, Height] = GetMipSize( ResidentMip );
+		const uint32_t LevelCount = m_MipCount - ResidentMip;
+
+		CreateImage( Width, Height, m_ImageFormat, VK_IMAGE_TYPE_2D, VK_IMAGE_TILING_OPTIMAL, 
+			VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_Image, m_ImageMemory, LevelCount, 1 );
+
+		VkMemoryRequirements MemReq;
+		vkGetImageMemoryRequirements( VulkanContext::Get().GetDevice(), m_Image, &MemReq );
+
+		m_ResidentMip = ResidentMip;
+		m_ResidentSize = MemReq.size;
+
+		VkImageSubresourceRange range = {};
+		range.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		range.baseMipLevel = 0;
+		range.baseArrayLayer = 0;
+		range.layerCount = 1;
+		range.levelCount = LevelCount;
+
+		m_ImageView = CreateImageView( range, m_Image, m_ImageFormat );
+
+		SetDebugUtilsObjectName( std::format( "{0} (mips {1}-{2})", m_Path.filename().string(), ResidentMip, m_MipCount - 1 ), ( uint64_t ) m_Image, VK_OBJECT_TYPE_IMAGE );
 
 		m_DescriptorImageInfo = {};
-		m_DescriptorImageInfo.imageLayout = m_Storage ? VK_IMAGE_LAYOUT_GENERAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		m_DescriptorImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 		m_DescriptorImageInfo.imageView = m_ImageView;
 		m_DescriptorImageInfo.sampler = m_Sampler;
 
-		m_DescriptorSet = ( VkDescriptorSet ) ImGui_ImplVulkan_AddTexture( m_Sampler, m_ImageView, m_Storage ? VK_IMAGE_LAYOUT_GENERAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL );
-
-		if( MipCount > 1 )
-			CreateMips();
+		m_DescriptorSet = ( VkDescriptorSet ) ImGui_ImplVulkan_AddTexture( m_Sampler, m_ImageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL );
 	}
 
 	//////////////////////////////////////////////////////////////////////////
@@ -712,7 +863,21 @@ namespace Saturn {
 		CreateTextureImage( false );
 	}
 
+	TextureCube::TextureCube( ImageFormat Format, uint32_t Size )
+		: Texture( Size, Size, VulkanFormat( Format ), nullptr )
+	{
+		// The mips are uploaded as well, there is nothing to blit.
+		m_MipsCreated = true;
+
+		CreateCubeImage( false );
+	}
+
 	void TextureCube::CreateTextureImage( bool flip )
+	{
+		CreateCubeImage( true );
+	}
+
+	void TextureCube::CreateCubeImage( bool Transition )
 	{
 		// Create the image.
 		//CreateImage( m_Width, m_Height, m_ImageFormat,
@@ -761,7 +926,9 @@ namespace Saturn {
 
 		// No need to transition image layout as the image layout will become VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL while creating mips.
 		// TRANSITION: VK_IMAGE_LAYOUT_UNDEFINED to VK_IMAGE_LAYOUT_GENERAL (temporary until mips are generated).
-		TransitionImageLayout( subresourceRange, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL );
+		// Uploads transition every face themselves.
+		if( Transition )
+			TransitionImageLayout( subresourceRange, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL );
 
 		// Create image sampler.
 		VkSamplerCreateInfo SamplerCreateInfo = { VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO };
@@ -803,6 +970,14 @@ namespace Saturn {
 		m_DescriptorImageInfo.imageView = m_ImageView;
 	}
 
+	void TextureCube::UploadFace( uint32_t Mip, uint32_t Face, const void* pData, size_t Size )
+	{
+		auto [Width, Height] = GetMipSize( Mip );
+
+		VulkanContext::Get().GetUploadManager()->UploadImage( m_Image, pData, Size, { Width, Height, 1 }, VK_IMAGE_ASPECT_COLOR_BIT,
+			VK_IMAGE_LAYOUT_GENERAL, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, Mip, Face );
+	}
+
 	void TextureCube::CreateMips()
 	{
 		if( m_MipsCreated )
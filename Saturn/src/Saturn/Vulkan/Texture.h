@@ -30,6 +30,7 @@
 
 #include "Base.h"
 #include "Image2D.h"
+#include "TextureStreamer.h"
 #include "Saturn/Core/Memory/Buffer.h"
 
 #include <filesystem>
@@ -148,10 +149,19 @@ namespace Saturn {
 	public:
 		Texture2D() : Texture() {}
 
-		Texture2D( const std::filesystem::path& rPath, AddressingMode Mode = AddressingMode::Repeat, bool flip = true ) 
-			: Texture( rPath, Mode ) { CreateTextureImage( flip ); }
+		// Streamed textures start with only their smallest mips resident, the TextureStreamer loads the rest when they are seen on screen.
+		// Mips are built on the CPU, srgb filters the color channels in linear space (for color textures such as albedo).
+		Texture2D( const std::filesystem::path& rPath, AddressingMode Mode = AddressingMode::Repeat, bool flip = true, bool streamed = false, bool srgb = false ) 
+			: Texture( rPath, Mode ), m_Streamed( streamed ), m_SRGB( srgb ) { CreateTextureImage( flip ); }
 
 		Texture2D( ImageFormat format, uint32_t width, uint32_t height, const void* pData, bool storage = false );
+
+		// A mip chain that was built offline (i.e. block compressed by the TextureCooker), uploaded as is without generating mips on the GPU.
+		Texture2D( ImageFormat format, uint32_t width, uint32_t height, const std::vector<Buffer>& rMips );
+
+		// A streamed texture whose mips come from Loader instead of a file (i.e. a texture asset), rPath only names it.
+		// pPixels is level 0 when the caller still has it decoded (RGBA8 only), otherwise the mip tail is loaded as well. srgb has to match the loader.
+		Texture2D( const std::filesystem::path& rPath, ImageFormat format, uint32_t width, uint32_t height, TextureMipLoader Loader, const uint8_t* pPixels = nullptr, bool srgb = false );
 		
 		~Texture2D() { Terminate(); }
 		
@@ -163,11 +173,46 @@ namespace Saturn {
 
 		void SetDebugName( const std::string& rName );
 
+		bool IsStreamed() const { return m_Streamed; }
+		bool IsFlipped() const { return m_Flipped; }
+		bool IsSRGB() const { return m_SRGB; }
+
+		// Mips in the full chain, including the ones that are not resident.
+		uint32_t GetMipCount() const { return m_MipCount; }
+		// The most detailed mip in the image, the image holds the mips from here to the end of the chain.
+		uint32_t GetResidentMip() const { return m_ResidentMip; }
+		// The most detailed mip the screen wanted the last time the streamer ran.
+		uint32_t GetRequestedMip() const { return m_RequestedMip; }
+		// Device memory used by the image.
+		VkDeviceSize GetResidentSize() const { return m_ResidentSize; }
+
 	private:
 
 		void CreateTextureImage( bool flip ) override;
 		void SetData( const void* pData ) override;
 		void CreateMips() override;
+
+		void CreateSampler( uint32_t MipCount );
+
+		void SetMips( const std::vector<Buffer>& rMips );
+
+		// Creates the image and view for the mips from ResidentMip to the end of the chain, the caller takes care of the old image.
+		void CreateResidentImage( uint32_t ResidentMip );
+
+	private:
+		bool m_Streamed = false;
+		bool m_Flipped = false;
+		bool m_SRGB = false;
+
+		uint32_t m_MipCount = 1;
+		uint32_t m_ResidentMip = 0;
+		uint32_t m_RequestedMip = 0;
+		VkDeviceSize m_ResidentSize = 0;
+
+		// Where the streamer gets the mips that are not resident.
+		TextureMipLoader m_MipLoader;
+
+		friend class TextureStreamer;
 	};
 
 	class TextureCube : public Texture
@@ -182,8 +227,14 @@ namespace Saturn {
 
 		TextureCube( ImageFormat Format, uint32_t width, uint32_t height, const void* pData = nullptr );
 
+		// Empty cube map that is filled with UploadFace, every mip of every face has to be uploaded before it is sampled.
+		TextureCube( ImageFormat Format, uint32_t Size );
+
 		~TextureCube() { Terminate(); }
 
+		// Goes through the upload manager, nothing waits on the GPU. The face is in GENERAL layout once the upload batch has finished.
+		void UploadFace( uint32_t Mip, uint32_t Face, const void* pData, size_t Size );
+
 		void CreateMips() override;
 
 		void Terminate() override;
@@ -193,5 +244,7 @@ namespace Saturn {
 
 		void CreateTextureImage(bool flip) override;
 		void SetData( const void* pData ) override;
+
+		void CreateCubeImage( bool Transition );
 	};
 }
\ No newline at end of file
@@ -0,0 +1,510 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#include "sppch.h"
+#include "TextureStreamer.h"
+
+#include "VulkanContext.h"
+#include "UploadManager.h"
+#include "BindlessTable.h"
+#include "Texture.h"
+#include "VulkanImageAux.h"
+#include "MipGenerator.h"
+
+#include "Saturn/Core/JobSystem.h"
+#include "Saturn/Core/OptickProfiler.h"
+
+#include "Saturn/Asset/TextureImporter.h"
+#include "Saturn/Asset/TextureCooker.h"
+
+#include <glm/glm.hpp>
+#include <backends/imgui_impl_vulkan.h>
+
+#include <thread>
+
+namespace Saturn {
+
+	//////////////////////////////////////////////////////////////////////////
+
+	TextureStreamer::TextureStreamer()
+	{
+	}
+
+	TextureStreamer::~TextureStreamer()
+	{
+		Terminate();
+	}
+
+	void TextureStreamer::Terminate()
+	{
+		// Loads write their results into the streamer.
+		while( m_LoadsInFlight > 0 )
+			std::this_thread::yield();
+
+		std::lock_guard<std::mutex> Lock( m_Mutex );
+
+		for( auto& rResult : m_FinishedLoads )
+		{
+			for( auto& rMip : rResult.Mips )
+				rMip.Free();
+		}
+
+		m_FinishedLoads.clear();
+
+		for( auto& rImages : m_RetiredImages )
+		{
+			for( auto& rImage : rImages )
+			{
+				// ImGui has shut down by now and its descriptor pool took the sets with it.
+				rImage.ImGuiDescriptorSet = nullptr;
+
+				DestroyRetiredImage( rImage );
+			}
+
+			rImages.clear();
+		}
+
+		m_Textures.clear();
+		m_TextureCount = 0;
+		m_ResidentBytes = 0;
+	}
+
+	void TextureStreamer::Register( Texture2D* pTexture, const uint8_t* pPixels )
+	{
+		SAT_PF_EVENT();
+
+		const uint32_t Width = ( uint32_t ) pTexture->m_Width;
+		const uint32_t Height = ( uint32_t ) pTexture->m_Height;
+		const uint32_t MipCount = pTexture->m_MipCount;
+
+		uint32_t TailMip = 0;
+		while( TailMip + 1 < MipCount && glm::max( Width >> TailMip, Height >> TailMip ) > ResidentTailSize )
+			TailMip++;
+
+		std::vector<Buffer> Mips = pPixels ? MipGenerator::GenerateMips( pPixels, Width, Height, MipFilter::Box, pTexture->IsSRGB(), TailMip, MipCount ) : pTexture->m_MipLoader( TailMip, MipCount );
+
+		// The image can not be left undefined, a tail that failed to load is black.
+		if( Mips.size() != MipCount - TailMip )
+		{
+			SAT_CORE_WARN( "Texture streamer failed to load the mip tail of {0}", pTexture->GetPath().string() );
+
+			for( auto& rMip : Mips )
+				rMip.Free();
+
+			Mips.resize( MipCount - TailMip );
+
+			for( uint32_t Mip = TailMip; Mip < MipCount; Mip++ )
+			{
+				Mips[ Mip - TailMip ].Allocate( GetMipByteSize( pTexture, Mip ) );
+				Mips[ Mip - TailMip ].Zero_Memory();
+			}
+		}
+
+		std::lock_guard<std::mutex> Lock( m_Mutex );
+
+		SetResidency( pTexture, TailMip, Mips );
+
+		pTexture->m_RequestedMip = TailMip;
+
+		StreamedTexture& rTexture = m_Textures[ pTexture ];
+		rTexture.pTexture = pTexture;
+		rTexture.ID = m_NextID++;
+		rTexture.TailMip = TailMip;
+		rTexture.WantedMip = TailMip;
+		rTexture.NextWantedMip = TailMip;
+
+		m_TextureCount = ( uint32_t ) m_Textures.size();
+	}
+
+	void TextureStreamer::Unregister( Texture2D* pTexture )
+	{
+		std::lock_guard<std::mutex> Lock( m_Mutex );
+
+		// A load that is still running is dropped when it finishes, the ID will not match anymore.
+		if( m_Textures.erase( pTexture ) )
+			m_ResidentBytes -= glm::min( m_ResidentBytes, pTexture->m_ResidentSize );
+
+		m_TextureCount = ( uint32_t ) m_Textures.size();
+	}
+
+	void TextureStreamer::Request( const std::vector<TextureMipRequest>& rRequests )
+	{
+		SAT_PF_EVENT();
+
+		std::lock_guard<std::mutex> Lock( m_Mutex );
+
+		for( const auto& rRequest : rRequests )
+		{
+			auto Itr = m_Textures.find( rRequest.pTexture );
+
+			if( Itr == m_Textures.end() )
+				continue;
+
+			StreamedTexture& rTexture = Itr->second;
+
+			// First request since the last update.
+			if( rTexture.LastRequestFrame != m_FrameCounter )
+			{
+				rTexture.NextWantedMip = rTexture.TailMip;
+				rTexture.NextCoverage = 0.0f;
+				rTexture.LastRequestFrame = m_FrameCounter;
+			}
+
+			rTexture.NextWantedMip = glm::min( rTexture.NextWantedMip, rRequest.Mip );
+			rTexture.NextCoverage = glm::max( rTexture.NextCoverage, rRequest.ScreenCoverage );
+		}
+	}
+
+	Ref<Texture2D> TextureStreamer::FindTexture( const std::filesystem::path& rPath )
+	{
+		std::lock_guard<std::mutex> Lock( m_Mutex );
+
+		for( auto& [ pTexture, rTexture ] : m_Textures )
+		{
+			if( pTexture->GetPath() == rPath )
+				return pTexture;
+		}
+
+		return nullptr;
+	}
+
+	void TextureStreamer::Update( uint32_t Frame )
+	{
+		SAT_PF_EVENT();
+
+		std::lock_guard<std::mutex> Lock( m_Mutex );
+
+		m_CurrentFrame = Frame;
+
+		// The last time this frame index was used has finished, nothing can sample the images retired back then.
+		for( auto& rImage : m_RetiredImages[ Frame ] )
+			DestroyRetiredImage( rImage );
+
+		m_RetiredImages[ Frame ].clear();
+
+		for( auto& rResult : m_FinishedLoads )
+		{
+			auto Itr = m_Textures.find( rResult.pTexture );
+
+			const bool Valid = Itr != m_Textures.end() && Itr->second.ID == rResult.ID && !rResult.Mips.empty()
+				&& rResult.FirstMip + rResult.Mips.size() == rResult.pTexture->m_ResidentMip;
+
+			if( Itr != m_Textures.end() && Itr->second.ID == rResult.ID )
+				Itr->second.Loading = false;
+
+			if( Valid )
+			{
+				SetResidency( rResult.pTexture, rResult.FirstMip, rResult.Mips );
+			}
+			else
+			{
+				for( auto& rMip : rResult.Mips )
+					rMip.Free();
+			}
+		}
+
+		m_FinishedLoads.clear();
+
+		// What the screen wanted since the last update.
+		std::vector<StreamedTexture*> Textures;
+		Textures.reserve( m_Textures.size() );
+
+		for( auto&& [pTexture, rTexture] : m_Textures )
+		{
+			if( rTexture.LastRequestFrame == m_FrameCounter )
+			{
+				rTexture.WantedMip = glm::min( rTexture.NextWantedMip, rTexture.TailMip );
+				rTexture.Coverage = rTexture.NextCoverage;
+			}
+			else
+			{
+				// Not on screen, these are the first to lose their mips when the budget is short.
+				rTexture.Coverage = 0.0f;
+
+				if( m_FrameCounter - rTexture.LastRequestFrame > EvictionDelayFrames )
+					rTexture.WantedMip = rTexture.TailMip;
+			}
+
+			pTexture->m_RequestedMip = rTexture.WantedMip;
+
+			Textures.push_back( &rTexture );
+		}
+
+		m_FrameCounter++;
+
+		std::sort( Textures.begin(), Textures.end(), []( const StreamedTexture* pA, const StreamedTexture* pB ) { return pA->Coverage > pB->Coverage; } );
+
+		// Mip tails are always resident, the rest of the budget goes to the textures that cover the most of the screen.
+		VkDeviceSize Remaining = m_Budget;
+
+		for( StreamedTexture* pStreamed : Textures )
+			Remaining -= glm::min( Remaining, GetMipChainSize( pStreamed->pTexture, pStreamed->TailMip ) );
+
+		for( StreamedTexture* pStreamed : Textures )
+		{
+			Texture2D* pTexture = pStreamed->pTexture;
+
+			const uint32_t Resident = pTexture->m_ResidentMip;
+			const VkDeviceSize TailSize = GetMipChainSize( pTexture, pStreamed->TailMip );
+
+			// Keep what is already resident while the texture is still wanted, so it does not reload when it moves back and forth around a mip boundary.
+			uint32_t Target = pStreamed->WantedMip;
+
+			if( pStreamed->WantedMip < pStreamed->TailMip )
+				Target = glm::min( Target, Resident );
+
+			while( Target < pStreamed->TailMip && GetMipChainSize( pTexture, Target ) - TailSize > Remaining )
+				Target++;
+
+			Remaining -= GetMipChainSize( pTexture, Target ) - TailSize;
+
+			if( pStreamed->Loading )
+				continue;
+
+			if( Target > Resident )
+			{
+				std::vector<Buffer> NoNewMips;
+				SetResidency( pTexture, Target, NoNewMips );
+			}
+			else if( Target < Resident && m_LoadsInFlight < MaxLoadsInFlight )
+			{
+				StartLoad( *pStreamed, Target );
+			}
+		}
+	}
+
+	void TextureStreamer::StartLoad( StreamedTexture& rTexture, uint32_t FirstMip )
+	{
+		Texture2D* pTexture = rTexture.pTexture;
+
+		const uint32_t EndMip = pTexture->m_ResidentMip;
+		const uint64_t ID = rTexture.ID;
+
+		// Copied, the texture may be destroyed while the job runs.
+		TextureMipLoader Loader = pTexture->m_MipLoader;
+
+		rTexture.Loading = true;
+		m_LoadsInFlight++;
+
+		JobSystem::Get().AddJob( [this, pTexture, ID, Loader, FirstMip, EndMip]()
+			{
+				SAT_PF_EVENT();
+
+				LoadResult Result;
+				Result.pTexture = pTexture;
+				Result.ID = ID;
+				Result.FirstMip = FirstMip;
+				Result.Mips = Loader( FirstMip, EndMip );
+
+				{
+					std::lock_guard<std::mutex> Lock( m_Mutex );
+					m_FinishedLoads.push_back( std::move( Result ) );
+				}
+
+				m_LoadsInFlight--;
+			} );
+	}
+
+	TextureMipLoader TextureStreamer::CreateFileLoader( const std::filesystem::path& rPath, bool Flip, bool SRGB, uint32_t Width, uint32_t Height )
+	{
+		return [Path = rPath, Flip, SRGB, Width, Height]( uint32_t FirstMip, uint32_t EndMip ) -> std::vector<Buffer>
+			{
+				std::vector<Buffer> Mips;
+
+				DecodedImage Image = TextureImporter::Decode( Path, Flip );
+
+				if( !Image || Image.HDR )
+				{
+					SAT_CORE_WARN( "Texture streamer failed to load {0}", Path.string() );
+				}
+				else if( Image.Width != Width || Image.Height != Height )
+				{
+					SAT_CORE_WARN( "Texture streamer: {0} has changed size on disk, it will not be streamed until it is reloaded", Path.string() );
+				}
+				else
+				{
+					Mips = MipGenerator::GenerateMips( ( const uint8_t* ) Image.pPixels, Width, Height, MipFilter::Box, SRGB, FirstMip, EndMip );
+				}
+
+				Image.Free();
+
+				return Mips;
+			};
+	}
+
+	void TextureStreamer::SetResidency( Texture2D* pTexture, uint32_t ResidentMip, std::vector<Buffer>& rNewMips )
+	{
+		SAT_PF_EVENT();
+
+		Texture2D& rTexture = *pTexture;
+
+		const bool HadImage = rTexture.m_Image != nullptr;
+		const uint32_t OldMip = rTexture.m_ResidentMip;
+		const uint32_t MipCount = rTexture.m_MipCount;
+
+		RetiredImage Old;
+		Old.Image = rTexture.m_Image;
+		Old.Memory = rTexture.m_ImageMemory;
+
+		if( rTexture.m_ImageView )
+			Old.ImageViews.push_back( rTexture.m_ImageView );
+
+		for( auto&& [Mip, View] : rTexture.m_MipToImageViewMap )
+			Old.ImageViews.push_back( View );
+
+		rTexture.m_MipToImageViewMap.clear();
+
+		Old.ImGuiDescriptorSet = rTexture.m_DescriptorSet;
+		rTexture.m_DescriptorSet = nullptr;
+
+		if( HadImage )
+			m_ResidentBytes -= glm::min( m_ResidentBytes, rTexture.m_ResidentSize );
+
+		rTexture.m_Image = nullptr;
+		rTexture.m_ImageMemory = nullptr;
+		rTexture.m_ImageView = nullptr;
+
+		rTexture.CreateResidentImage( ResidentMip );
+
+		m_ResidentBytes += rTexture.m_ResidentSize;
+
+		UploadManager* pUploadManager = VulkanContext::Get().GetUploadManager();
+
+		// Mips that both images have are copied on the GPU.
+		if( HadImage )
+		{
+			const uint32_t FirstShared = glm::max( ResidentMip, OldMip );
+			const uint32_t SharedCount = MipCount - FirstShared;
+
+			VkImage SrcImage = Old.Image;
+			VkImage DstImage = rTexture.m_Image;
+
+			pUploadManager->RecordGraphicsCommands( [&]( VkCommandBuffer CommandBuffer )
+				{
+					std::array<VkImageMemoryBarrier, 2> Barriers = {};
+
+					Barriers[ 0 ] = { VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
+					Barriers[ 0 ].srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+					Barriers[ 0 ].dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+					Barriers[ 0 ].oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+					Barriers[ 0 ].newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+					Barriers[ 0 ].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+					Barriers[ 0 ].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+					Barriers[ 0 ].image = SrcImage;
+					Barriers[ 0 ].subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, FirstShared - OldMip, SharedCount, 0, 1 };
+
+					Barriers[ 1 ] = Barriers[ 0 ];
+					Barriers[ 1 ].srcAccessMask = 0;
+					Barriers[ 1 ].dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+					Barriers[ 1 ].oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+					Barriers[ 1 ].newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+					Barriers[ 1 ].image = DstImage;
+					Barriers[ 1 ].subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, FirstShared - ResidentMip, SharedCount, 0, 1 };
+
+					vkCmdPipelineBarrier( CommandBuffer, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, ( uint32_t ) Barriers.size(), Barriers.data() );
+
+					std::vector<VkImageCopy> Regions( SharedCount );
+
+					for( uint32_t i = 0; i < SharedCount; i++ )
+					{
+						const uint32_t Mip = FirstShared + i;
+						auto [Width, Height] = rTexture.GetMipSize( Mip );
+
+						Regions[ i ].srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, Mip - OldMip, 0, 1 };
+						Regions[ i ].dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, Mip - ResidentMip, 0, 1 };
+						Regions[ i ].extent = { Width, Height, 1 };
+					}
+
+					vkCmdCopyImage( CommandBuffer, SrcImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, DstImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, ( uint32_t ) Regions.size(), Regions.data() );
+
+					Barriers[ 1 ].srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+					Barriers[ 1 ].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+					Barriers[ 1 ].oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+					Barriers[ 1 ].newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+					vkCmdPipelineBarrier( CommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &Barriers[ 1 ] );
+				} );
+		}
+
+		if( HadImage || Old.ImGuiDescriptorSet )
+			m_RetiredImages[ m_CurrentFrame ].push_back( std::move( Old ) );
+
+		// The mips that were not resident come from the CPU.
+		for( size_t i = 0; i < rNewMips.size(); i++ )
+		{
+			const uint32_t Mip = ResidentMip + ( uint32_t ) i;
+			auto [Width, Height] = rTexture.GetMipSize( Mip );
+
+			pUploadManager->UploadImage( rTexture.m_Image, rNewMips[ i ].Data, rNewMips[ i ].Size, { Width, Height, 1 }, VK_IMAGE_ASPECT_COLOR_BIT,
+				VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, Mip - ResidentMip );
+
+			rNewMips[ i ].Free();
+		}
+
+		rNewMips.clear();
+
+		if( BindlessTable* pTable = VulkanContext::Get().GetBindlessTable() )
+			pTable->RefreshTexture( pTexture );
+	}
+
+	void TextureStreamer::DestroyRetiredImage( RetiredImage& rImage )
+	{
+		VkDevice Device = VulkanContext::Get().GetDevice();
+
+		for( VkImageView View : rImage.ImageViews )
+			vkDestroyImageView( Device, View, nullptr );
+
+		vkDestroyImage( Device, rImage.Image, nullptr );
+		vkFreeMemory( Device, rImage.Memory, nullptr );
+
+		if( rImage.ImGuiDescriptorSet )
+			ImGui_ImplVulkan_RemoveTexture( rImage.ImGuiDescriptorSet );
+	}
+
+	VkDeviceSize TextureStreamer::GetMipByteSize( Texture2D* pTexture, uint32_t Mip )
+	{
+		const uint32_t Width = MipGenerator::GetMipExtent( pTexture->m_Width, Mip );
+		const uint32_t Height = MipGenerator::GetMipExtent( pTexture->m_Height, Mip );
+
+		// Block compressed mips are stored as whole 4x4 blocks.
+		if( const uint32_t BlockSize = TextureCooker::GetBlockSize( SaturnFormat( pTexture->m_ImageFormat ) ) )
+			return ( VkDeviceSize ) ( ( Width + 3 ) / 4 ) * ( ( Height + 3 ) / 4 ) * BlockSize;
+
+		return ( VkDeviceSize ) Width * Height * 4;
+	}
+
+	VkDeviceSize TextureStreamer::GetMipChainSize( Texture2D* pTexture, uint32_t FirstMip )
+	{
+		VkDeviceSize Size = 0;
+
+		for( uint32_t Mip = FirstMip; Mip < pTexture->m_MipCount; Mip++ )
+			Size += GetMipByteSize( pTexture, Mip );
+
+		return Size;
+	}
+}
@@ -0,0 +1,171 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#pragma once
+
+#include "Base.h"
+#include "Saturn/Core/Memory/Buffer.h"
+
+#include <vulkan.h>
+
+#include <array>
+#include <atomic>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace Saturn {
+
+	class Texture2D;
+
+	// Loads the mips from FirstMip up to (not including) EndMip of a streamed texture, runs on the job system.
+	// Returns no mips when the source could not be read.
+	using TextureMipLoader = std::function<std::vector<Buffer>( uint32_t FirstMip, uint32_t EndMip )>;
+
+	struct TextureMipRequest
+	{
+		Texture2D* pTexture = nullptr;
+		// Most detailed mip the draw needs.
+		uint32_t Mip = 0;
+		// How many pixels across the texture covers, used as the priority.
+		float ScreenCoverage = 0.0f;
+	};
+
+	// Streams the mips of textures that were created as streamed in and out of VRAM.
+	// A streamed texture always keeps its mip tail (the mips that are at most ResidentTailSize in size), everything above it is loaded when the screen needs it.
+	// The scene renderer requests the most detailed mip a draw needs from its size on screen, the streamer then decides what fits in the budget with the textures that cover the most pixels first.
+	// More detailed mips come from the texture's mip loader on the job system, evicting only copies the remaining mips into a smaller image.
+	// Either way the texture gets a new image, the old one is destroyed once the frames that could still sample it have finished.
+	class TextureStreamer
+	{
+	public:
+		static constexpr uint32_t ResidentTailSize = 128;
+		static constexpr uint32_t MaxLoadsInFlight = 4;
+		// How long a texture keeps its mips after it was last requested, unless the budget needs them sooner.
+		static constexpr uint32_t EvictionDelayFrames = 120;
+
+	public:
+		TextureStreamer();
+		~TextureStreamer();
+
+		void Terminate();
+
+		// Uploads the mip tail, called when a streamed texture is created.
+		// The tail is built from the decoded level 0 pixels (RGBA8) when the caller still has them, otherwise it comes from the texture's mip loader.
+		void Register( Texture2D* pTexture, const uint8_t* pPixels = nullptr );
+		void Unregister( Texture2D* pTexture );
+
+		// Takes the requests of a whole frame at once, a texture requested more than once keeps its most detailed mip and largest coverage.
+		void Request( const std::vector<TextureMipRequest>& rRequests );
+
+		// Applies finished loads and decides what has to be loaded or evicted to fit the budget, call once the frame's fence has been waited on.
+		void Update( uint32_t Frame );
+
+		void SetBudget( VkDeviceSize Budget ) { m_Budget = Budget; }
+		VkDeviceSize GetBudget() const { return m_Budget; }
+
+		VkDeviceSize GetResidentBytes() const { return m_ResidentBytes; }
+		uint32_t GetTextureCount() const { return m_TextureCount; }
+		uint32_t GetLoadsInFlight() const { return m_LoadsInFlight; }
+
+		// The loader of textures that were created from a file, it decodes the file again.
+		static TextureMipLoader CreateFileLoader( const std::filesystem::path& rPath, bool Flip, bool SRGB, uint32_t Width, uint32_t Height );
+
+		// The streamed texture that was loaded from rPath, or null, used by the editor to show the residency of an asset.
+		Ref<Texture2D> FindTexture( const std::filesystem::path& rPath );
+
+	private:
+		struct StreamedTexture
+		{
+			Texture2D* pTexture = nullptr;
+			uint64_t ID = 0;
+
+			uint32_t TailMip = 0;
+
+			// What the screen wants, gathered from the requests since the last update.
+			uint32_t NextWantedMip = 0;
+			float NextCoverage = 0.0f;
+			uint64_t LastRequestFrame = 0;
+
+			uint32_t WantedMip = 0;
+			float Coverage = 0.0f;
+
+			bool Loading = false;
+		};
+
+		struct LoadResult
+		{
+			Texture2D* pTexture = nullptr;
+			uint64_t ID = 0;
+			uint32_t FirstMip = 0;
+
+			// One buffer per mip, from FirstMip up to the mip that was resident when the load started.
+			std::vector<Buffer> Mips;
+		};
+
+		struct RetiredImage
+		{
+			VkImage Image = nullptr;
+			VkDeviceMemory Memory = nullptr;
+			std::vector<VkImageView> ImageViews;
+			// ImGui set that references the old view, ImGui may have recorded it in the same frames.
+			VkDescriptorSet ImGuiDescriptorSet = nullptr;
+		};
+
+		static void DestroyRetiredImage( RetiredImage& rImage );
+
+		void StartLoad( StreamedTexture& rTexture, uint32_t FirstMip );
+
+		// Gives the texture an image that holds ResidentMip to the end of the chain, rNewMips holds the mips that were not resident before.
+		void SetResidency( Texture2D* pTexture, uint32_t ResidentMip, std::vector<Buffer>& rNewMips );
+
+		static VkDeviceSize GetMipByteSize( Texture2D* pTexture, uint32_t Mip );
+		static VkDeviceSize GetMipChainSize( Texture2D* pTexture, uint32_t FirstMip );
+
+	private:
+		std::unordered_map<Texture2D*, StreamedTexture> m_Textures;
+		std::vector<LoadResult> m_FinishedLoads;
+
+		// Images a frame could still be sampling, destroyed when that frame comes around again.
+		std::array<std::vector<RetiredImage>, MAX_FRAMES_IN_FLIGHT> m_RetiredImages;
+
+		VkDeviceSize m_Budget = 512ull * 1024 * 1024;
+		VkDeviceSize m_ResidentBytes = 0;
+		uint32_t m_TextureCount = 0;
+
+		uint64_t m_NextID = 1;
+		uint64_t m_FrameCounter = 1;
+		uint32_t m_CurrentFrame = 0;
+
+		std::atomic<uint32_t> m_LoadsInFlight = 0;
+
+		std::mutex m_Mutex;
+	};
+}
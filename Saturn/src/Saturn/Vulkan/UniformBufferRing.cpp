@@ -0,0 +1,175 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#include "sppch.h"
+#include "UniformBufferRing.h"
+
+#include "VulkanContext.h"
+#include "VulkanAllocator.h"
+#include "VulkanDebug.h"
+
+namespace Saturn {
+
+	static VkDeviceSize AlignUp( VkDeviceSize Value, VkDeviceSize Alignment )
+	{
+		return ( Value + Alignment - 1 ) & ~( Alignment - 1 );
+	}
+
+	UniformBufferRing::UniformBufferRing()
+	{
+		auto pAllocator = VulkanContext::Get().GetVulkanAllocator();
+
+		VkPhysicalDeviceProperties Properties = {};
+		vkGetPhysicalDeviceProperties( VulkanContext::Get().GetPhysicalDevice(), &Properties );
+
+		m_Alignment = std::max<VkDeviceSize>( 16, Properties.limits.minUniformBufferOffsetAlignment );
+
+		VkBufferCreateInfo BufferCreateInfo = { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+		BufferCreateInfo.size = ZeroBlockSize + FrameSize * MAX_FRAMES_IN_FLIGHT + OverflowSize;
+		BufferCreateInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+		BufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+		auto Allocation = pAllocator->AllocateBuffer( BufferCreateInfo, VMA_MEMORY_USAGE_CPU_ONLY, &m_Buffer );
+		m_pData = pAllocator->MapMemory< uint8_t >( Allocation );
+
+		memset( m_pData, 0, ZeroBlockSize );
+
+		SetDebugUtilsObjectName( "Uniform Buffer Ring", ( uint64_t ) m_Buffer, VK_OBJECT_TYPE_BUFFER );
+
+		m_FrameBegin = ZeroBlockSize;
+		m_Head = m_FrameBegin;
+
+		m_OverflowBegin = ZeroBlockSize + FrameSize * MAX_FRAMES_IN_FLIGHT;
+		m_OverflowHead = m_OverflowBegin;
+
+		SAT_CORE_INFO( "Uniform buffer ring: {0} KB per frame, {1} byte alignment", FrameSize / 1024, m_Alignment );
+	}
+
+	UniformBufferRing::~UniformBufferRing()
+	{
+		Terminate();
+	}
+
+	void UniformBufferRing::Terminate()
+	{
+		if( !m_Buffer )
+			return;
+
+		auto pAllocator = VulkanContext::Get().GetVulkanAllocator();
+
+		pAllocator->UnmapMemory( pAllocator->GetAllocationFromBuffer( m_Buffer ) );
+		pAllocator->DestroyBuffer( m_Buffer );
+
+		m_Buffer = nullptr;
+		m_pData = nullptr;
+	}
+
+	void UniformBufferRing::BeginFrame( uint32_t Frame )
+	{
+		m_LastFrameBytes = GetUsedBytes();
+		m_PeakFrameBytes = std::max( m_PeakFrameBytes, m_LastFrameBytes );
+
+		if( m_Overflowed.exchange( false ) )
+			SAT_CORE_WARN( "Uniform buffer ring: a frame needed more than {0} KB, the rest went to the overflow region.", FrameSize / 1024 );
+
+		if( m_OutOfSpace.exchange( false ) )
+			SAT_CORE_WARN( "Uniform buffer ring: the overflow region was full or held by another frame, uniform buffers that did not fit read zeros." );
+
+		m_FrameNumber++;
+
+		// The frame that spilled has finished once its frame index comes round again.
+		const uint64_t OverflowFrame = m_OverflowFrame.load();
+
+		if( OverflowFrame && m_FrameNumber >= OverflowFrame + MAX_FRAMES_IN_FLIGHT )
+		{
+			m_OverflowHead = m_OverflowBegin;
+			m_OverflowFrame = 0;
+		}
+
+		// The fence for this frame index was waited on, so nothing reads its region anymore.
+		m_FrameBegin = ZeroBlockSize + FrameSize * Frame;
+		m_Head = m_FrameBegin;
+	}
+
+	uint32_t UniformBufferRing::Allocate( const void* pData, size_t Size )
+	{
+		SAT_CORE_ASSERT( Size <= ZeroBlockSize, "Uniform buffer is larger than the zero block!" );
+
+		const VkDeviceSize AlignedSize = AlignUp( Size, m_Alignment );
+		const VkDeviceSize Offset = m_Head.fetch_add( AlignedSize );
+
+		if( Offset + AlignedSize > m_FrameBegin + FrameSize )
+		{
+			// Asserts once per frame, outside of Dist running out is a bug in the frame size.
+			if( !m_Overflowed.exchange( true ) )
+			{
+				SAT_CORE_ASSERT( false, "Uniform buffer ring: the frame's region is full, FrameSize is too small for this scene!" );
+			}
+
+			return AllocateOverflow( pData, Size, AlignedSize );
+		}
+
+		memcpy( m_pData + Offset, pData, Size );
+
+		return ( uint32_t ) Offset;
+	}
+
+	uint32_t UniformBufferRing::AllocateOverflow( const void* pData, size_t Size, VkDeviceSize AlignedSize )
+	{
+		// The head is reset when the region is released, so only the frame that holds it moves it.
+		uint64_t Holder = 0;
+
+		if( !m_OverflowFrame.compare_exchange_strong( Holder, m_FrameNumber ) && Holder != m_FrameNumber )
+		{
+			m_OutOfSpace = true;
+			return 0;
+		}
+
+		const VkDeviceSize Offset = m_OverflowHead.fetch_add( AlignedSize );
+
+		if( Offset + AlignedSize > m_OverflowBegin + OverflowSize )
+		{
+			m_OutOfSpace = true;
+			return 0;
+		}
+
+		memcpy( m_pData + Offset, pData, Size );
+
+		return ( uint32_t ) Offset;
+	}
+
+	VkDeviceSize UniformBufferRing::GetUsedBytes() const
+	{
+		VkDeviceSize Used = std::min( m_Head.load() - m_FrameBegin, FrameSize );
+
+		if( m_OverflowFrame.load() == m_FrameNumber )
+			Used += std::min( m_OverflowHead.load() - m_OverflowBegin, OverflowSize );
+
+		return Used;
+	}
+}
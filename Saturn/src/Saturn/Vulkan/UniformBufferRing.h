@@ -0,0 +1,99 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#pragma once
+
+#include "Base.h"
+
+#include <vulkan.h>
+#include <algorithm>
+#include <atomic>
+
+namespace Saturn {
+
+	// Holds the uniform buffer data of every shader in one persistently mapped buffer, split into one region per frame in flight.
+	// Uploading is a bump allocation and a memcpy, the shader binds its uniform buffers as dynamic uniform buffers at the offset that was returned.
+	// A region is reused when its frame index comes round again, so data only lives for the frame it was uploaded in.
+	// The start of the buffer is kept zeroed and is bound for uniform buffers that have not been uploaded this frame.
+	// A frame that runs out of its region spills into an overflow region at the end of the buffer. It is a region of the same buffer
+	// because every uniform buffer descriptor points at this buffer, a bigger or separate buffer would mean writing all of them again.
+	class UniformBufferRing
+	{
+	public:
+		static constexpr VkDeviceSize FrameSize = 2ull * 1024 * 1024;
+		static constexpr VkDeviceSize OverflowSize = 2ull * 1024 * 1024;
+		// The smallest maxUniformBufferRange the Vulkan spec allows (the limit is only guaranteed to be at least 16 KB), shaders assert their uniform buffers fit.
+		static constexpr VkDeviceSize ZeroBlockSize = 16ull * 1024;
+
+	public:
+		UniformBufferRing();
+		~UniformBufferRing();
+
+		void Terminate();
+
+		// Starts allocating from the frame's region, call once the frame's fence has been waited on.
+		void BeginFrame( uint32_t Frame );
+
+		// Copies Size bytes into this frame's region and returns the dynamic offset of the copy. Can be called from any thread.
+		// When the region is full the copy goes to the overflow region, if another frame in flight holds it the zero block is returned instead.
+		uint32_t Allocate( const void* pData, size_t Size );
+
+		VkBuffer GetBuffer() const { return m_Buffer; }
+
+		// Increases every frame, used to tell if an offset belongs to the current frame.
+		uint64_t GetFrameNumber() const { return m_FrameNumber; }
+
+		VkDeviceSize GetUsedBytes() const;
+		VkDeviceSize GetLastFrameBytes() const { return m_LastFrameBytes; }
+		VkDeviceSize GetPeakFrameBytes() const { return m_PeakFrameBytes; }
+
+	private:
+		uint32_t AllocateOverflow( const void* pData, size_t Size, VkDeviceSize AlignedSize );
+
+	private:
+		VkBuffer m_Buffer = nullptr;
+		uint8_t* m_pData = nullptr;
+
+		VkDeviceSize m_Alignment = 256;
+
+		std::atomic<VkDeviceSize> m_Head = 0;
+		VkDeviceSize m_FrameBegin = 0;
+
+		uint64_t m_FrameNumber = 1;
+		std::atomic<bool> m_Overflowed = false;
+		std::atomic<bool> m_OutOfSpace = false;
+
+		VkDeviceSize m_OverflowBegin = 0;
+		std::atomic<VkDeviceSize> m_OverflowHead = 0;
+		// Frame number that spilled into the overflow region, 0 when it is free.
+		std::atomic<uint64_t> m_OverflowFrame = 0;
+
+		VkDeviceSize m_LastFrameBytes = 0;
+		VkDeviceSize m_PeakFrameBytes = 0;
+	};
+}
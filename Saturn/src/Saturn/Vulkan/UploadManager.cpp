@@ -0,0 +1,562 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#include "sppch.h"
+#include "UploadManager.h"
+
+#include "VulkanContext.h"
+#include "VulkanAllocator.h"
+#include "VulkanDebug.h"
+
+#include "Saturn/Core/OptickProfiler.h"
+
+namespace Saturn {
+
+	static constexpr VkDeviceSize s_StagingRingSize = 64ull * 1024 * 1024;
+
+	static VkDeviceSize AlignUp( VkDeviceSize Value, VkDeviceSize Alignment )
+	{
+		return ( Value + Alignment - 1 ) & ~( Alignment - 1 );
+	}
+
+	UploadManager::UploadManager()
+	{
+		VkDevice Device = VulkanContext::Get().GetDevice();
+		auto pAllocator = VulkanContext::Get().GetVulkanAllocator();
+		auto& rIndices = VulkanContext::Get().GetQueueFamilyIndices();
+
+		m_GraphicsFamily = rIndices.GraphicsFamily.value();
+		m_TransferFamily = rIndices.TransferFamily.value_or( m_GraphicsFamily );
+
+		m_GraphicsQueue = VulkanContext::Get().GetGraphicsQueue();
+		m_TransferQueue = VulkanContext::Get().GetTransferQueue();
+
+		// Staging ring.
+		VkPhysicalDeviceProperties Properties = {};
+		vkGetPhysicalDeviceProperties( VulkanContext::Get().GetPhysicalDevice(), &Properties );
+
+		// 16 covers the texel size of every format we upload, buffer to image copies must be aligned to it.
+		m_StagingAlignment = std::max<VkDeviceSize>( 16, Properties.limits.optimalBufferCopyOffsetAlignment );
+		m_StagingSize = s_StagingRingSize;
+
+		VkBufferCreateInfo BufferCreateInfo = { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+		BufferCreateInfo.size = m_StagingSize;
+		BufferCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+		BufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+		auto Allocation = pAllocator->AllocateBuffer( BufferCreateInfo, VMA_MEMORY_USAGE_CPU_ONLY, &m_StagingBuffer );
+		m_pStagingData = pAllocator->MapMemory< uint8_t >( Allocation );
+
+		SetDebugUtilsObjectName( "Upload Staging Ring", ( uint64_t ) m_StagingBuffer, VK_OBJECT_TYPE_BUFFER );
+
+		// Command pools.
+		VkCommandPoolCreateInfo PoolCreateInfo = { VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO };
+		PoolCreateInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+
+		PoolCreateInfo.queueFamilyIndex = m_GraphicsFamily;
+		VK_CHECK( vkCreateCommandPool( Device, &PoolCreateInfo, nullptr, &m_GraphicsCommandPool ) );
+
+		PoolCreateInfo.queueFamilyIndex = m_TransferFamily;
+		VK_CHECK( vkCreateCommandPool( Device, &PoolCreateInfo, nullptr, &m_TransferCommandPool ) );
+
+		// Timeline semaphores.
+		VkSemaphoreTypeCreateInfo TimelineCreateInfo = { VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO };
+		TimelineCreateInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+		TimelineCreateInfo.initialValue = 0;
+
+		VkSemaphoreCreateInfo SemaphoreCreateInfo = { VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO };
+		SemaphoreCreateInfo.pNext = &TimelineCreateInfo;
+
+		VK_CHECK( vkCreateSemaphore( Device, &SemaphoreCreateInfo, nullptr, &m_Timeline ) );
+		SetDebugUtilsObjectName( "Upload Timeline", ( uint64_t ) m_Timeline, VK_OBJECT_TYPE_SEMAPHORE );
+
+		if( HasDedicatedTransferQueue() )
+		{
+			VK_CHECK( vkCreateSemaphore( Device, &SemaphoreCreateInfo, nullptr, &m_TransferTimeline ) );
+			SetDebugUtilsObjectName( "Upload Transfer Timeline", ( uint64_t ) m_TransferTimeline, VK_OBJECT_TYPE_SEMAPHORE );
+		}
+
+		SAT_CORE_INFO( "Upload manager: {0} MB staging ring, {1}", m_StagingSize / ( 1024 * 1024 ), HasDedicatedTransferQueue() ? "dedicated transfer queue" : "graphics queue" );
+
+		BeginBatch();
+	}
+
+	UploadManager::~UploadManager()
+	{
+		Terminate();
+	}
+
+	void UploadManager::Terminate()
+	{
+		if( !m_StagingBuffer )
+			return;
+
+		VkDevice Device = VulkanContext::Get().GetDevice();
+		auto pAllocator = VulkanContext::Get().GetVulkanAllocator();
+
+		std::lock_guard<std::recursive_mutex> Lock( m_Mutex );
+
+		// Anything still in flight has to finish before the staging memory goes away.
+		if( !m_InFlightBatches.empty() )
+			Wait( m_InFlightBatches.back().Ticket );
+
+		RetireBatches( false );
+
+		for( VkBuffer Buffer : m_CurrentBatch.OverflowBuffers )
+			pAllocator->DestroyBuffer( Buffer );
+
+		// The current batch was never submitted, destroying the pools frees its command buffers.
+		m_CurrentBatch = {};
+
+		// Nothing is in flight anymore, the only pending destroys left belong to the batch that never got submitted.
+		for( auto& rPending : m_PendingDestroys )
+			rPending.second();
+
+		m_PendingDestroys.clear();
+
+		vkDestroyCommandPool( Device, m_GraphicsCommandPool, nullptr );
+		vkDestroyCommandPool( Device, m_TransferCommandPool, nullptr );
+
+		vkDestroySemaphore( Device, m_Timeline, nullptr );
+
+		if( m_TransferTimeline )
+			vkDestroySemaphore( Device, m_TransferTimeline, nullptr );
+
+		pAllocator->UnmapMemory( pAllocator->GetAllocationFromBuffer( m_StagingBuffer ) );
+		pAllocator->DestroyBuffer( m_StagingBuffer );
+
+		m_StagingBuffer = nullptr;
+		m_pStagingData = nullptr;
+		m_GraphicsCommandPool = nullptr;
+		m_TransferCommandPool = nullptr;
+		m_Timeline = nullptr;
+		m_TransferTimeline = nullptr;
+	}
+
+	UploadTicket UploadManager::UploadBuffer( VkBuffer Buffer, const void* pData, VkDeviceSize Size, VkDeviceSize Offset, VkAccessFlags DstAccess, VkPipelineStageFlags DstStage )
+	{
+		SAT_PF_EVENT();
+
+		std::lock_guard<std::recursive_mutex> Lock( m_Mutex );
+
+		VkBuffer SrcBuffer = nullptr;
+		VkDeviceSize SrcOffset = 0;
+		CopyToStaging( pData, Size, &SrcBuffer, &SrcOffset );
+
+		VkBufferCopy Region = {};
+		Region.srcOffset = SrcOffset;
+		Region.dstOffset = Offset;
+		Region.size = Size;
+
+		vkCmdCopyBuffer( m_CurrentBatch.TransferCommandBuffer, SrcBuffer, Buffer, 1, &Region );
+
+		VkBufferMemoryBarrier Barrier = { VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER };
+		Barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		Barrier.dstAccessMask = DstAccess;
+		Barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		Barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		Barrier.buffer = Buffer;
+		Barrier.offset = Offset;
+		Barrier.size = Size;
+
+		if( HasDedicatedTransferQueue() )
+		{
+			// Release from the transfer queue, then acquire on the graphics queue. Both halves must describe the same transfer.
+			Barrier.srcQueueFamilyIndex = m_TransferFamily;
+			Barrier.dstQueueFamilyIndex = m_GraphicsFamily;
+
+			VkBufferMemoryBarrier Release = Barrier;
+			Release.dstAccessMask = 0;
+
+			vkCmdPipelineBarrier( m_CurrentBatch.TransferCommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 1, &Release, 0, nullptr );
+
+			VkBufferMemoryBarrier Acquire = Barrier;
+			Acquire.srcAccessMask = 0;
+
+			vkCmdPipelineBarrier( m_CurrentBatch.GraphicsCommandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, DstStage, 0, 0, nullptr, 1, &Acquire, 0, nullptr );
+		}
+		else
+		{
+			vkCmdPipelineBarrier( m_CurrentBatch.TransferCommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, DstStage, 0, 0, nullptr, 1, &Barrier, 0, nullptr );
+		}
+
+		m_CurrentBatch.Recorded = true;
+
+		return m_CurrentBatch.Ticket;
+	}
+
+	UploadTicket UploadManager::UploadImage( VkImage Image, const void* pData, VkDeviceSize Size, VkExtent3D Extent, VkImageAspectFlags Aspect, VkImageLayout FinalLayout, VkAccessFlags DstAccess, VkPipelineStageFlags DstStage, uint32_t MipLevel, uint32_t ArrayLayer )
+	{
+		SAT_PF_EVENT();
+
+		std::lock_guard<std::recursive_mutex> Lock( m_Mutex );
+
+		VkBuffer SrcBuffer = nullptr;
+		VkDeviceSize SrcOffset = 0;
+		CopyToStaging( pData, Size, &SrcBuffer, &SrcOffset );
+
+		// Transfer only queues can not copy to depth or stencil aspects, those stay on the graphics queue.
+		const bool UseTransferQueue = HasDedicatedTransferQueue() && Aspect == VK_IMAGE_ASPECT_COLOR_BIT;
+		VkCommandBuffer CopyCommandBuffer = UseTransferQueue || !HasDedicatedTransferQueue() ? m_CurrentBatch.TransferCommandBuffer : m_CurrentBatch.GraphicsCommandBuffer;
+
+		VkImageMemoryBarrier Barrier = { VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
+		Barrier.srcAccessMask = 0;
+		Barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		Barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		Barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		Barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		Barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		Barrier.image = Image;
+		Barrier.subresourceRange = { Aspect, MipLevel, 1, ArrayLayer, 1 };
+
+		vkCmdPipelineBarrier( CopyCommandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &Barrier );
+
+		VkBufferImageCopy Region = {};
+		Region.bufferOffset = SrcOffset;
+		Region.imageSubresource = { Aspect, MipLevel, ArrayLayer, 1 };
+		Region.imageOffset = { 0, 0, 0 };
+		Region.imageExtent = Extent;
+
+		vkCmdCopyBufferToImage( CopyCommandBuffer, SrcBuffer, Image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &Region );
+
+		Barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		Barrier.dstAccessMask = DstAccess;
+		Barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		Barrier.newLayout = FinalLayout;
+
+		if( UseTransferQueue )
+		{
+			// The layout transition happens once, as part of the queue family ownership transfer.
+			Barrier.srcQueueFamilyIndex = m_TransferFamily;
+			Barrier.dstQueueFamilyIndex = m_GraphicsFamily;
+
+			VkImageMemoryBarrier Release = Barrier;
+			Release.dstAccessMask = 0;
+
+			vkCmdPipelineBarrier( m_CurrentBatch.TransferCommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &Release );
+
+			VkImageMemoryBarrier Acquire = Barrier;
+			Acquire.srcAccessMask = 0;
+
+			vkCmdPipelineBarrier( m_CurrentBatch.GraphicsCommandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, DstStage, 0, 0, nullptr, 0, nullptr, 1, &Acquire );
+		}
+		else
+		{
+			vkCmdPipelineBarrier( CopyCommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, DstStage, 0, 0, nullptr, 0, nullptr, 1, &Barrier );
+		}
+
+		m_CurrentBatch.Recorded = true;
+
+		return m_CurrentBatch.Ticket;
+	}
+
+	UploadTicket UploadManager::RecordGraphicsCommands( const std::function<void( VkCommandBuffer )>& rFunction )
+	{
+		std::lock_guard<std::recursive_mutex> Lock( m_Mutex );
+
+		rFunction( m_CurrentBatch.GraphicsCommandBuffer );
+
+		m_CurrentBatch.Recorded = true;
+
+		return m_CurrentBatch.Ticket;
+	}
+
+	UploadTicket UploadManager::Flush()
+	{
+		SAT_PF_EVENT();
+
+		std::lock_guard<std::recursive_mutex> Lock( m_Mutex );
+
+		if( m_CurrentBatch.Recorded )
+		{
+			SubmitBatch();
+			BeginBatch();
+		}
+
+		RetireBatches( false );
+
+		return m_CurrentBatch.Ticket - 1;
+	}
+
+	bool UploadManager::IsComplete( UploadTicket Ticket )
+	{
+		return GetCompletedValue() >= Ticket;
+	}
+
+	void UploadManager::Wait( UploadTicket Ticket )
+	{
+		SAT_PF_EVENT();
+
+		{
+			std::lock_guard<std::recursive_mutex> Lock( m_Mutex );
+
+			// Tickets past the current batch have not been handed out yet.
+			Ticket = std::min( Ticket, m_CurrentBatch.Ticket );
+
+			// The ticket belongs to the batch that is still recording.
+			if( Ticket == m_CurrentBatch.Ticket )
+			{
+				// Nothing was recorded into it, so it is never submitted and its value is never signalled.
+				// Only the batches before it can still be in flight.
+				if( !m_CurrentBatch.Recorded )
+					Ticket = m_CurrentBatch.Ticket - 1;
+				else
+					Flush();
+			}
+
+			if( Ticket == 0 )
+				return;
+		}
+
+		VkSemaphoreWaitInfo WaitInfo = { VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO };
+		WaitInfo.semaphoreCount = 1;
+		WaitInfo.pSemaphores = &m_Timeline;
+		WaitInfo.pValues = &Ticket;
+
+		VK_CHECK( vkWaitSemaphores( VulkanContext::Get().GetDevice(), &WaitInfo, UINT64_MAX ) );
+	}
+
+	void UploadManager::DestroyAfter( UploadTicket Ticket, std::function<void()>&& rrFunction )
+	{
+		std::lock_guard<std::recursive_mutex> Lock( m_Mutex );
+
+		if( !m_StagingBuffer || IsComplete( Ticket ) )
+		{
+			rrFunction();
+			return;
+		}
+
+		// Retired with the batches, see RetireBatches.
+		m_PendingDestroys.push_back( { Ticket, std::move( rrFunction ) } );
+	}
+
+	void UploadManager::BeginBatch()
+	{
+		VkCommandBufferAllocateInfo AllocateInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO };
+		AllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		AllocateInfo.commandBufferCount = 1;
+
+		m_CurrentBatch = {};
+		m_CurrentBatch.Ticket = m_NextTicket++;
+
+		AllocateInfo.commandPool = m_TransferCommandPool;
+		VK_CHECK( vkAllocateCommandBuffers( VulkanContext::Get().GetDevice(), &AllocateInfo, &m_CurrentBatch.TransferCommandBuffer ) );
+
+		AllocateInfo.commandPool = m_GraphicsCommandPool;
+		VK_CHECK( vkAllocateCommandBuffers( VulkanContext::Get().GetDevice(), &AllocateInfo, &m_CurrentBatch.GraphicsCommandBuffer ) );
+
+		VkCommandBufferBeginInfo BeginInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+		BeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+		VK_CHECK( vkBeginCommandBuffer( m_CurrentBatch.TransferCommandBuffer, &BeginInfo ) );
+		VK_CHECK( vkBeginCommandBuffer( m_CurrentBatch.GraphicsCommandBuffer, &BeginInfo ) );
+	}
+
+	void UploadManager::SubmitBatch()
+	{
+		SAT_PF_EVENT();
+
+		UploadBatch& rBatch = m_CurrentBatch;
+
+		VK_CHECK( vkEndCommandBuffer( rBatch.TransferCommandBuffer ) );
+		VK_CHECK( vkEndCommandBuffer( rBatch.GraphicsCommandBuffer ) );
+
+		VkTimelineSemaphoreSubmitInfo TimelineInfo = { VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO };
+		TimelineInfo.signalSemaphoreValueCount = 1;
+		TimelineInfo.pSignalSemaphoreValues = &rBatch.Ticket;
+
+		VkSubmitInfo SubmitInfo = { VK_STRUCTURE_TYPE_SUBMIT_INFO };
+		SubmitInfo.pNext = &TimelineInfo;
+		SubmitInfo.signalSemaphoreCount = 1;
+		SubmitInfo.pSignalSemaphores = &m_Timeline;
+
+		if( HasDedicatedTransferQueue() )
+		{
+			VkTimelineSemaphoreSubmitInfo TransferTimelineInfo = { VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO };
+			TransferTimelineInfo.signalSemaphoreValueCount = 1;
+			TransferTimelineInfo.pSignalSemaphoreValues = &rBatch.Ticket;
+
+			VkSubmitInfo TransferSubmitInfo = { VK_STRUCTURE_TYPE_SUBMIT_INFO };
+			TransferSubmitInfo.pNext = &TransferTimelineInfo;
+			TransferSubmitInfo.commandBufferCount = 1;
+			TransferSubmitInfo.pCommandBuffers = &rBatch.TransferCommandBuffer;
+			TransferSubmitInfo.signalSemaphoreCount = 1;
+			TransferSubmitInfo.pSignalSemaphores = &m_TransferTimeline;
+
+			std::lock_guard<std::mutex> QueueLock( VulkanContext::Get().GetQueueMutex() );
+
+			VK_CHECK( vkQueueSubmit( m_TransferQueue, 1, &TransferSubmitInfo, nullptr ) );
+
+			// The graphics half waits for the copies and then acquires ownership.
+			VkPipelineStageFlags WaitStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+
+			TimelineInfo.waitSemaphoreValueCount = 1;
+			TimelineInfo.pWaitSemaphoreValues = &rBatch.Ticket;
+
+			SubmitInfo.waitSemaphoreCount = 1;
+			SubmitInfo.pWaitSemaphores = &m_TransferTimeline;
+			SubmitInfo.pWaitDstStageMask = &WaitStage;
+			SubmitInfo.commandBufferCount = 1;
+			SubmitInfo.pCommandBuffers = &rBatch.GraphicsCommandBuffer;
+
+			VK_CHECK( vkQueueSubmit( m_GraphicsQueue, 1, &SubmitInfo, nullptr ) );
+		}
+		else
+		{
+			VkCommandBuffer CommandBuffers[] = { rBatch.TransferCommandBuffer, rBatch.GraphicsCommandBuffer };
+
+			SubmitInfo.commandBufferCount = 2;
+			SubmitInfo.pCommandBuffers = CommandBuffers;
+
+			std::lock_guard<std::mutex> QueueLock( VulkanContext::Get().GetQueueMutex() );
+
+			VK_CHECK( vkQueueSubmit( m_GraphicsQueue, 1, &SubmitInfo, nullptr ) );
+		}
+
+		m_InFlightBatches.push_back( std::move( rBatch ) );
+	}
+
+	void UploadManager::RetireBatches( bool WaitForOldest )
+	{
+		if( WaitForOldest && !m_InFlightBatches.empty() )
+			Wait( m_InFlightBatches.front().Ticket );
+
+		VkDevice Device = VulkanContext::Get().GetDevice();
+		auto pAllocator = VulkanContext::Get().GetVulkanAllocator();
+
+		uint64_t Completed = GetCompletedValue();
+
+		while( !m_InFlightBatches.empty() && m_InFlightBatches.front().Ticket <= Completed )
+		{
+			UploadBatch& rBatch = m_InFlightBatches.front();
+
+			vkFreeCommandBuffers( Device, m_TransferCommandPool, 1, &rBatch.TransferCommandBuffer );
+			vkFreeCommandBuffers( Device, m_GraphicsCommandPool, 1, &rBatch.GraphicsCommandBuffer );
+
+			for( VkBuffer Buffer : rBatch.OverflowBuffers )
+				pAllocator->DestroyBuffer( Buffer );
+
+			// Batches retire in the same order they took ring space.
+			m_StagingUsed -= rBatch.RingBytes;
+
+			m_InFlightBatches.pop_front();
+		}
+
+		// Tickets are not pushed in order, a resource destroyed later can still have an older upload.
+		for( size_t i = 0; i < m_PendingDestroys.size(); )
+		{
+			if( m_PendingDestroys[ i ].first <= Completed )
+			{
+				m_PendingDestroys[ i ].second();
+
+				m_PendingDestroys[ i ] = std::move( m_PendingDestroys.back() );
+				m_PendingDestroys.pop_back();
+			}
+			else
+			{
+				i++;
+			}
+		}
+	}
+
+	void UploadManager::CopyToStaging( const void* pData, VkDeviceSize Size, VkBuffer* pBuffer, VkDeviceSize* pOffset )
+	{
+		RetireBatches( false );
+
+		// Too big for the ring, give it its own staging buffer that lives until the batch is done.
+		if( Size > m_StagingSize )
+		{
+			auto pAllocator = VulkanContext::Get().GetVulkanAllocator();
+
+			VkBufferCreateInfo BufferCreateInfo = { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+			BufferCreateInfo.size = Size;
+			BufferCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+			BufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+			auto Allocation = pAllocator->AllocateBuffer( BufferCreateInfo, VMA_MEMORY_USAGE_CPU_ONLY, pBuffer );
+
+			void* pDstData = pAllocator->MapMemory< void >( Allocation );
+			memcpy( pDstData, pData, Size );
+			pAllocator->UnmapMemory( Allocation );
+
+			m_CurrentBatch.OverflowBuffers.push_back( *pBuffer );
+			*pOffset = 0;
+
+			return;
+		}
+
+		while( !TryAllocateRing( Size, pOffset ) )
+		{
+			// Nothing in flight means the current batch is holding the space, submit it so it can be waited on.
+			if( m_InFlightBatches.empty() )
+			{
+				SubmitBatch();
+				BeginBatch();
+			}
+
+			RetireBatches( true );
+		}
+
+		memcpy( m_pStagingData + *pOffset, pData, Size );
+
+		*pBuffer = m_StagingBuffer;
+	}
+
+	bool UploadManager::TryAllocateRing( VkDeviceSize Size, VkDeviceSize* pOffset )
+	{
+		if( m_StagingUsed == 0 )
+			m_StagingHead = 0;
+
+		VkDeviceSize Offset = AlignUp( m_StagingHead, m_StagingAlignment );
+
+		// Does not fit before the end of the ring, skip the tail and start from the beginning.
+		if( Offset + Size > m_StagingSize )
+			Offset = 0;
+
+		VkDeviceSize Consumed = ( Offset >= m_StagingHead ? Offset - m_StagingHead : m_StagingSize - m_StagingHead ) + Size;
+
+		if( m_StagingUsed + Consumed > m_StagingSize )
+			return false;
+
+		m_StagingHead = Offset + Size;
+		m_StagingUsed += Consumed;
+		m_CurrentBatch.RingBytes += Consumed;
+
+		*pOffset = Offset;
+
+		return true;
+	}
+
+	uint64_t UploadManager::GetCompletedValue()
+	{
+		uint64_t Value = 0;
+		VK_CHECK( vkGetSemaphoreCounterValue( VulkanContext::Get().GetDevice(), m_Timeline, &Value ) );
+
+		return Value;
+	}
+}
@@ -0,0 +1,134 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#pragma once
+
+#include "Base.h"
+
+#include <vulkan.h>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace Saturn {
+
+	// Identifies the batch an upload was recorded into, tickets are increasing so a ticket is complete once every batch up to it has finished on the GPU.
+	using UploadTicket = uint64_t;
+
+	// Batches buffer and image uploads into one submission instead of a blocking submit for every resource.
+	// Data is copied into a persistently mapped staging ring and the copies are recorded on the transfer queue when the device has a dedicated one, ownership is then handed over to the graphics queue.
+	// The current batch is submitted when Flush is called (the renderer does this every frame before it submits) or when the ring runs out of space.
+	// Completion is tracked with a timeline semaphore, the CPU only waits when it needs ring space back or when Wait is called.
+	class UploadManager
+	{
+	public:
+		UploadManager();
+		~UploadManager();
+
+		void Terminate();
+
+		// Copies Size bytes from pData into Buffer at Offset. DstAccess and DstStage describe how the buffer is first used after the upload.
+		UploadTicket UploadBuffer( VkBuffer Buffer, const void* pData, VkDeviceSize Size, VkDeviceSize Offset, VkAccessFlags DstAccess, VkPipelineStageFlags DstStage );
+
+		// Copies pData into MipLevel and ArrayLayer of Image and leaves that subresource in FinalLayout, the previous contents are discarded. Extent is the size of the mip.
+		UploadTicket UploadImage( VkImage Image, const void* pData, VkDeviceSize Size, VkExtent3D Extent, VkImageAspectFlags Aspect, VkImageLayout FinalLayout, VkAccessFlags DstAccess, VkPipelineStageFlags DstStage, uint32_t MipLevel = 0, uint32_t ArrayLayer = 0 );
+
+		// Records graphics queue work that depends on the uploads recorded so far (i.e. mip generation).
+		UploadTicket RecordGraphicsCommands( const std::function<void( VkCommandBuffer )>& rFunction );
+
+		// Submits the current batch, returns the ticket of the last submitted batch.
+		UploadTicket Flush();
+
+		bool IsComplete( UploadTicket Ticket );
+		void Wait( UploadTicket Ticket );
+
+		// Runs rrFunction once Ticket has completed, resources that were uploaded into must not be freed while the copy may still read or write them.
+		void DestroyAfter( UploadTicket Ticket, std::function<void()>&& rrFunction );
+
+		bool HasDedicatedTransferQueue() const { return m_TransferFamily != m_GraphicsFamily; }
+
+	private:
+		struct UploadBatch
+		{
+			VkCommandBuffer TransferCommandBuffer = nullptr;
+			VkCommandBuffer GraphicsCommandBuffer = nullptr;
+
+			UploadTicket Ticket = 0;
+
+			// Ring bytes owned by this batch, including any padding that was skipped when the ring wrapped.
+			VkDeviceSize RingBytes = 0;
+
+			// Staging buffers for uploads that are larger than the ring.
+			std::vector<VkBuffer> OverflowBuffers;
+
+			bool Recorded = false;
+		};
+
+		void BeginBatch();
+		void SubmitBatch();
+		void RetireBatches( bool WaitForOldest );
+
+		// Copies the data into the staging ring, flushes and waits on in flight batches until there is enough space.
+		void CopyToStaging( const void* pData, VkDeviceSize Size, VkBuffer* pBuffer, VkDeviceSize* pOffset );
+		bool TryAllocateRing( VkDeviceSize Size, VkDeviceSize* pOffset );
+
+		uint64_t GetCompletedValue();
+
+	private:
+		VkBuffer m_StagingBuffer = nullptr;
+		uint8_t* m_pStagingData = nullptr;
+		VkDeviceSize m_StagingSize = 0;
+		VkDeviceSize m_StagingHead = 0;
+		VkDeviceSize m_StagingUsed = 0;
+		VkDeviceSize m_StagingAlignment = 16;
+
+		uint32_t m_GraphicsFamily = 0;
+		uint32_t m_TransferFamily = 0;
+
+		VkQueue m_GraphicsQueue = nullptr;
+		VkQueue m_TransferQueue = nullptr;
+
+		VkCommandPool m_GraphicsCommandPool = nullptr;
+		VkCommandPool m_TransferCommandPool = nullptr;
+
+		// Signalled by the graphics submit of each batch, the value is the batch's ticket.
+		VkSemaphore m_Timeline = nullptr;
+		// Signalled by the transfer queue submit, only used with a dedicated transfer queue.
+		VkSemaphore m_TransferTimeline = nullptr;
+
+		UploadBatch m_CurrentBatch;
+		std::deque<UploadBatch> m_InFlightBatches;
+
+		std::vector<std::pair<UploadTicket, std::function<void()>>> m_PendingDestroys;
+
+		UploadTicket m_NextTicket = 1;
+
+		std::recursive_mutex m_Mutex;
+	};
+}
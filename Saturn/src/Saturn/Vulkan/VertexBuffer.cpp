@@ -31,6 +31,7 @@
 
 #include "VulkanContext.h"
 #include "VulkanDebug.h"
+#include "UploadManager.h"
 
 #include <cassert>
 
@@ -44,7 +45,7 @@ namespace Saturn {
 		CreateBuffer();
 	}
 
-	VertexBuffer::VertexBuffer( VkDeviceSize Size, VkBufferUsageFlags Usage /*= 0 */ )
+	VertexBuffer::VertexBuffer( VkDeviceSize Size, VkBufferUsageFlags Usage /*= 0 */, VmaMemoryUsage MemoryUsage /*= VMA_MEMORY_USAGE_CPU_TO_GPU */ )
 	{
 		m_Size = Size;
 		m_pData = nullptr;
@@ -54,9 +55,9 @@ namespace Saturn {
 		// Create the vertex buffer.
 		VkBufferCreateInfo VertexBufferCreateInfo = { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
 		VertexBufferCreateInfo.size = Size;
-		VertexBufferCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+		VertexBufferCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | Usage;
 
-		m_Allocation = pAllocator->AllocateBuffer( VertexBufferCreateInfo, VMA_MEMORY_USAGE_CPU_TO_GPU, &m_Buffer );
+		m_Allocation = pAllocator->AllocateBuffer( VertexBufferCreateInfo, MemoryUsage, &m_Buffer );
 		SetDebugUtilsObjectName( "Vertex Buffer", ( uint64_t ) m_Buffer, VK_OBJECT_TYPE_BUFFER );
 	}
 
@@ -96,6 +97,14 @@ namespace Saturn {
 		pAllocator->UnmapMemory( m_Allocation );
 	}
 
+	void* VertexBuffer::GetPersistentMapping()
+	{
+		if( !m_pPersistentMapping )
+			m_pPersistentMapping = VulkanContext::Get().GetVulkanAllocator()->MapMemory< void >( m_Allocation );
+
+		return m_pPersistentMapping;
+	}
+
 	void VertexBuffer::Draw( VkCommandBuffer CommandBuffer )
 	{
 		vkCmdDraw( CommandBuffer, ( uint32_t )m_Size, 1, 0, 0 );
@@ -107,25 +116,8 @@ namespace Saturn {
 		
 		VkDeviceSize BufferSize = m_Size;
 
-		VkBuffer StagingBuffer;
-		
 		auto pAllocator = VulkanContext::Get().GetVulkanAllocator();
-		
-		VkBufferCreateInfo BufferCreateInfo = { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
-		BufferCreateInfo.size = BufferSize;
-		BufferCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
-		BufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-
-		auto rBufferAlloc = pAllocator->AllocateBuffer( BufferCreateInfo, VMA_MEMORY_USAGE_CPU_TO_GPU, &StagingBuffer );
-		
-		void* dstData = pAllocator->MapMemory< void >( rBufferAlloc );
-
-		memcpy( dstData, m_pData, BufferSize );
-
-		pAllocator->UnmapMemory( rBufferAlloc );
 
-		//////////////////////////////////////////////////////////////////////////
-		
 		// Create the vertex buffer.
 		VkBufferCreateInfo VertexBufferCreateInfo = { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
 		VertexBufferCreateInfo.size = BufferSize;
@@ -134,27 +126,31 @@ namespace Saturn {
 		m_Allocation = pAllocator->AllocateBuffer( VertexBufferCreateInfo, VMA_MEMORY_USAGE_GPU_ONLY, &m_Buffer );
 		SetDebugUtilsObjectName( "Vertex Buffer", ( uint64_t ) m_Buffer, VK_OBJECT_TYPE_BUFFER );
 
-		// Copy buffer
-		{
-			auto CommandBuffer = VulkanContext::Get().BeginSingleTimeCommands();
-
-			VkBufferCopy CopyRegion{};
-			CopyRegion.size = BufferSize;
-
-			vkCmdCopyBuffer( CommandBuffer, StagingBuffer, m_Buffer, 1, &CopyRegion );
-
-			VulkanContext::Get().EndSingleTimeCommands( CommandBuffer );
-		}
-
-		pAllocator->DestroyBuffer( StagingBuffer );
+		// The copy is batched with the other uploads, it will be done before the next frame is submitted.
+		m_UploadTicket = VulkanContext::Get().GetUploadManager()->UploadBuffer( m_Buffer, m_pData, BufferSize, 0, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT );
 	}
 
 	void VertexBuffer::Destroy()
 	{
+		if( m_pPersistentMapping )
+			VulkanContext::Get().GetVulkanAllocator()->UnmapMemory( m_Allocation );
+
+		m_pPersistentMapping = nullptr;
+
 		if ( m_Buffer != nullptr )
-			VulkanContext::Get().GetVulkanAllocator()->DestroyBuffer( m_Buffer );
+		{
+			VkBuffer Buffer = m_Buffer;
+			auto DestroyFunc = [Buffer]() { VulkanContext::Get().GetVulkanAllocator()->DestroyBuffer( Buffer ); };
+
+			// The upload may still be copying into the buffer.
+			if( UploadManager* pUploadManager = VulkanContext::Get().GetUploadManager() )
+				pUploadManager->DestroyAfter( m_UploadTicket, std::move( DestroyFunc ) );
+			else
+				DestroyFunc();
+		}
 		
 		m_Buffer = nullptr;
+		m_UploadTicket = 0;
 	}
 
 	//////////////////////////////////////////////////////////////////////////
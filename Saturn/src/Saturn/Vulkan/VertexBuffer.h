@@ -33,6 +33,7 @@
 #include "ShaderDataType.h"
 
 #include "VulkanAllocator.h"
+#include "UploadManager.h"
 
 #include <vulkan.h>
 #include <string>
@@ -56,6 +57,18 @@ namespace Saturn {
 		glm::vec3 Binormal;
 		glm::vec2 Texcoord;
 	};
+
+	// Compressed version of StaticVertex, 24 bytes instead of 56.
+	// Positions are 16 bit unorm inside the submesh bounds, the dequantisation is folded into the instance transform (see Submesh::GetDequantisationMatrix).
+	// Normals and tangents are octahedral encoded, the binormal is rebuilt in the shader from the normal, the tangent and the sign.
+	struct QuantisedStaticVertex
+	{
+		uint16_t Position[ 4 ];
+		int16_t Normal[ 2 ];
+		int16_t Tangent[ 2 ];
+		int16_t BinormalSign[ 2 ];
+		uint16_t Texcoord[ 2 ];
+	};
 	
 	struct VertexBufferElement
 	{
@@ -89,6 +102,9 @@ namespace Saturn {
 				case ShaderDataType::Bool:        return 1;
 				case ShaderDataType::Sampler2D:   return 1;
 				case ShaderDataType::SamplerCube: return 1;
+				case ShaderDataType::UShort4Norm: return 4;
+				case ShaderDataType::Short2Norm:  return 2;
+				case ShaderDataType::Half2:       return 2;
 			
 				SAT_CORE_ASSERT( false, "Unknown ShaderDataType!" );
 			}
@@ -165,7 +181,7 @@ namespace Saturn {
 	public:
 		VertexBuffer() : m_pData( nullptr ) { }
 		VertexBuffer( void* pData, VkDeviceSize Size, VkBufferUsageFlags Usage = 0 );
-		VertexBuffer( VkDeviceSize Size, VkBufferUsageFlags Usage = 0 );
+		VertexBuffer( VkDeviceSize Size, VkBufferUsageFlags Usage = 0, VmaMemoryUsage MemoryUsage = VMA_MEMORY_USAGE_CPU_TO_GPU );
 		VertexBuffer( const VertexBuffer& ) = delete;
 		~VertexBuffer();
 
@@ -176,9 +192,15 @@ namespace Saturn {
 
 		void Reallocate( void* pData, uint32_t size, uint32_t offset = 0 );
 
+		// Maps the buffer once and keeps it mapped until the buffer is destroyed, only valid for host visible buffers.
+		void* GetPersistentMapping();
+
 		void Draw( VkCommandBuffer CommandBuffer );
 		void BindAndDraw( VkCommandBuffer CommandBuffer );
 
+		VkBuffer GetBuffer() { return m_Buffer; }
+		size_t GetSize() const { return m_Size; }
+
 	private:
 		void CreateBuffer();
 	private:
@@ -191,5 +213,10 @@ namespace Saturn {
 		VkBuffer m_Buffer = nullptr;
 
 		VmaAllocation m_Allocation = nullptr;
+
+		// The batch that copies m_pData into the buffer, the buffer is not freed before it completes.
+		UploadTicket m_UploadTicket = 0;
+
+		void* m_pPersistentMapping = nullptr;
 	};
 }
\ No newline at end of file
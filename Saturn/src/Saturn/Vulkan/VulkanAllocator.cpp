@@ -95,4 +95,26 @@ namespace Saturn {
 	{
 		vmaDestroyImage( m_Allocator, Image, Allocation );
 	}
+
+	VmaAllocation VulkanAllocator::AllocateMemory( const VkMemoryRequirements& rRequirements, VmaMemoryUsage MemoryUsage )
+	{
+		VmaAllocation Allocation;
+
+		VmaAllocationCreateInfo AllocationInfo = {};
+		AllocationInfo.usage = MemoryUsage;
+
+		VK_CHECK( vmaAllocateMemory( m_Allocator, &rRequirements, &AllocationInfo, &Allocation, nullptr ) );
+
+		return Allocation;
+	}
+
+	void VulkanAllocator::BindImageMemory( VmaAllocation Allocation, VkImage Image )
+	{
+		VK_CHECK( vmaBindImageMemory( m_Allocator, Allocation, Image ) );
+	}
+
+	void VulkanAllocator::FreeMemory( VmaAllocation Allocation )
+	{
+		vmaFreeMemory( m_Allocator, Allocation );
+	}
 }
\ No newline at end of file
@@ -50,6 +50,15 @@ namespace Saturn {
 		
 		// Destroy image
 		void DestroyImage( VmaAllocation Allocation, VkImage Image );
+
+		// Allocate memory without a resource, images are bound to it with BindImageMemory so several images can alias it.
+		VmaAllocation AllocateMemory( const VkMemoryRequirements& rRequirements, VmaMemoryUsage MemoryUsage );
+
+		// Bind an image to the start of the memory
+		void BindImageMemory( VmaAllocation Allocation, VkImage Image );
+
+		// Free memory from AllocateMemory, images bound to it must be destroyed first.
+		void FreeMemory( VmaAllocation Allocation );
 	
 		template<typename Ty>
 		Ty* MapMemory( VmaAllocation Allocation )
@@ -35,6 +35,11 @@
 
 #include "VulkanDebug.h"
 #include "VulkanAllocator.h"
+#include "PipelineCache.h"
+#include "UploadManager.h"
+#include "BindlessTable.h"
+#include "TextureStreamer.h"
+#include "UniformBufferRing.h"
 
 #include "Saturn/Core/Timer.h"
 #include "SceneRenderer.h"
@@ -71,6 +76,18 @@ namespace Saturn {
 		CreateCommandPool();
 
 		m_pAllocator = new VulkanAllocator();
+
+		// Engine pipelines are created before any project is loaded so they are cached in the app data folder, project pipelines are merged in when the project is set.
+		m_pPipelineCache = new PipelineCache();
+		m_pPipelineCache->Merge( PipelineCache::GetEngineCachePath() );
+
+		m_pUploadManager = new UploadManager();
+
+		m_pUniformBufferRing = new UniformBufferRing();
+
+		m_pBindlessTable = new BindlessTable();
+
+		m_pTextureStreamer = new TextureStreamer();
 	
 		// Create default pass.
 		PassSpecification Specification = {};
@@ -101,7 +118,10 @@ namespace Saturn {
 			return;
 
 		// Wait for the device to be idle, then we delete all of our vulkan items.
-		VK_CHECK( vkDeviceWaitIdle( m_LogicalDevice ) );
+		{
+			std::lock_guard<std::mutex> QueueLock( m_QueueMutex );
+			VK_CHECK( vkDeviceWaitIdle( m_LogicalDevice ) );
+		}
 
 		vkDestroyCommandPool( m_LogicalDevice, m_CommandPool, nullptr );
 		vkDestroyCommandPool( m_LogicalDevice, m_ComputeCommandPool, nullptr );
@@ -120,9 +140,28 @@ namespace Saturn {
 		ShaderLibrary::Get().Shutdown();
 
 		m_DepthImage = nullptr;
+
+		// Textures that outlive the streamer keep their current image, only the images it retired are destroyed here.
+		delete m_pTextureStreamer;
+		m_pTextureStreamer = nullptr;
+
+		delete m_pBindlessTable;
+		m_pBindlessTable = nullptr;
+
+		delete m_pUniformBufferRing;
+		m_pUniformBufferRing = nullptr;
+
+		delete m_pUploadManager;
+		m_pUploadManager = nullptr;
 		
 		delete m_pAllocator;
 
+		m_pPipelineCache->Save( PipelineCache::GetEngineCachePath() );
+		m_pPipelineCache->Save( PipelineCache::GetProjectCachePath() );
+
+		delete m_pPipelineCache;
+		m_pPipelineCache = nullptr;
+
 		vkDestroyDevice( m_LogicalDevice, nullptr );
 
 #if !defined(SAT_DIST)
@@ -247,6 +286,18 @@ namespace Saturn {
 				{
 					m_PhysicalDevice = rDevice;
 
+					// A transfer only family is usually backed by the copy engine so uploads can run alongside rendering.
+					m_Indices.TransferFamily.reset();
+
+					for( uint32_t j = 0; j < FamilyCount; j++ )
+					{
+						if( ( QueueProps[ j ].queueFlags & VK_QUEUE_TRANSFER_BIT ) && !( QueueProps[ j ].queueFlags & ( VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT ) ) )
+						{
+							m_Indices.TransferFamily = j;
+							break;
+						}
+					}
+
 					break;
 				}
 			}
@@ -293,6 +344,9 @@ namespace Saturn {
 		std::set<uint32_t> UniqueQueueFamilies = { 
 			m_Indices.GraphicsFamily.value(), m_Indices.PresentFamily.value(), m_Indices.ComputeFamily.value() };
 
+		if( m_Indices.TransferFamily.has_value() )
+			UniqueQueueFamilies.insert( m_Indices.TransferFamily.value() );
+
 		for( uint32_t QueueFamily : UniqueQueueFamilies )
 		{
 			VkDeviceQueueCreateInfo QueueCreateInfo ={ VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO };
@@ -320,6 +374,36 @@ namespace Saturn {
 		VkPhysicalDeviceInlineUniformBlockFeaturesEXT InlineUniformBlockFeatures = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_INLINE_UNIFORM_BLOCK_FEATURES_EXT };
 		InlineUniformBlockFeatures.inlineUniformBlock = VK_TRUE;
 
+		// Core in Vulkan 1.2, used by the bindless table.
+		VkPhysicalDeviceDescriptorIndexingFeatures SupportedIndexingFeatures = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES };
+
+		// Core in Vulkan 1.2 but still optional, used by the upload manager to track batches.
+		VkPhysicalDeviceVulkan12Features SupportedVulkan12Features = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES };
+		SupportedVulkan12Features.pNext = &SupportedIndexingFeatures;
+
+		VkPhysicalDeviceFeatures2 SupportedFeatures = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2 };
+		SupportedFeatures.pNext = &SupportedVulkan12Features;
+
+		vkGetPhysicalDeviceFeatures2( m_PhysicalDevice, &SupportedFeatures );
+
+		SAT_CORE_ASSERT( SupportedVulkan12Features.timelineSemaphore, "The GPU does not support timeline semaphores." );
+
+		VkPhysicalDeviceTimelineSemaphoreFeatures TimelineSemaphoreFeatures = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES };
+		TimelineSemaphoreFeatures.timelineSemaphore = SupportedVulkan12Features.timelineSemaphore;
+
+		SAT_CORE_ASSERT( SupportedIndexingFeatures.runtimeDescriptorArray && SupportedIndexingFeatures.descriptorBindingPartiallyBound && SupportedIndexingFeatures.descriptorBindingSampledImageUpdateAfterBind && SupportedIndexingFeatures.descriptorBindingVariableDescriptorCount, 
+			"The GPU does not support descriptor indexing." );
+
+		VkPhysicalDeviceDescriptorIndexingFeatures DescriptorIndexingFeatures = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES };
+		DescriptorIndexingFeatures.runtimeDescriptorArray = VK_TRUE;
+		DescriptorIndexingFeatures.shaderSampledImageArrayNonUniformIndexing = SupportedIndexingFeatures.shaderSampledImageArrayNonUniformIndexing;
+		DescriptorIndexingFeatures.descriptorBindingPartiallyBound = VK_TRUE;
+		DescriptorIndexingFeatures.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+		DescriptorIndexingFeatures.descriptorBindingVariableDescriptorCount = VK_TRUE;
+
+		InlineUniformBlockFeatures.pNext = &TimelineSemaphoreFeatures;
+		TimelineSemaphoreFeatures.pNext = &DescriptorIndexingFeatures;
+
 		VkDeviceCreateInfo DeviceInfo      ={ VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO };
 		DeviceInfo.enabledExtensionCount   = ( uint32_t ) DeviceExtensions.size();
 		DeviceInfo.ppEnabledExtensionNames = DeviceExtensions.data();
@@ -335,6 +419,11 @@ namespace Saturn {
 		vkGetDeviceQueue( m_LogicalDevice, m_Indices.GraphicsFamily.value(), 0, &m_GraphicsQueue );
 		vkGetDeviceQueue( m_LogicalDevice, m_Indices.PresentFamily.value(), 0, &m_PresentQueue );
 		vkGetDeviceQueue( m_LogicalDevice, m_Indices.ComputeFamily.value(), 0, &m_ComputeQueue );
+
+		if( m_Indices.TransferFamily.has_value() )
+			vkGetDeviceQueue( m_LogicalDevice, m_Indices.TransferFamily.value(), 0, &m_TransferQueue );
+		else
+			m_TransferQueue = m_GraphicsQueue;
 	}
 
 	// Get memory type.
@@ -540,6 +629,10 @@ namespace Saturn {
 
 		VK_CHECK( vkEndCommandBuffer( CommandBuffer ) );
 
+		// Pending uploads go first so these commands see them, both end up on the graphics queue.
+		if( m_pUploadManager )
+			m_pUploadManager->Flush();
+
 		// Submit the command buffer.
 		VkSubmitInfo SubmitInfo = { VK_STRUCTURE_TYPE_SUBMIT_INFO };
 		SubmitInfo.commandBufferCount = 1;
@@ -551,7 +644,10 @@ namespace Saturn {
 		VkFence Fence;
 		VK_CHECK( vkCreateFence( m_LogicalDevice, &FenceCreateInfo, nullptr, &Fence ) );
 
-		VK_CHECK( vkQueueSubmit( m_GraphicsQueue, 1, &SubmitInfo, Fence ) );
+		{
+			std::lock_guard<std::mutex> QueueLock( m_QueueMutex );
+			VK_CHECK( vkQueueSubmit( m_GraphicsQueue, 1, &SubmitInfo, Fence ) );
+		}
 
 		VK_CHECK( vkWaitForFences( m_LogicalDevice, 1, &Fence, VK_TRUE, FENCE_TIMEOUT ) );
 
@@ -21,17 +21,25 @@
 #include <vulkan.h>
 #include <vector>
 #include <optional>
+#include <mutex>
 
 namespace Saturn {
 
 	class VulkanDebugMessenger;
 	class VulkanAllocator;
+	class PipelineCache;
+	class UploadManager;
+	class BindlessTable;
+	class TextureStreamer;
+	class UniformBufferRing;
 	
 	struct QueueFamilyIndices
 	{
 		std::optional<uint32_t> GraphicsFamily;
 		std::optional<uint32_t> PresentFamily;
 		std::optional<uint32_t> ComputeFamily;
+		// Only set when the device has a transfer family without graphics or compute, uploads use the graphics queue otherwise.
+		std::optional<uint32_t> TransferFamily;
 
 		bool Complete() { return GraphicsFamily.has_value() && PresentFamily.has_value() && ComputeFamily.has_value(); }
 	};
@@ -101,15 +109,30 @@ namespace Saturn {
 
 		VkQueue GetGraphicsQueue() { return m_GraphicsQueue; }
 		VkQueue GetPresentQueue() { return m_PresentQueue; }
+		VkQueue GetTransferQueue() { return m_TransferQueue; }
 
 		VkPhysicalDevice GetPhysicalDevice() { return m_PhysicalDevice; }
 
 		VkQueue GetComputeQueue() { return m_ComputeQueue; }
 
+		// Queues must be externally synchronised and uploads can be submitted from job threads.
+		// Hold this around every vkQueueSubmit, vkQueuePresentKHR and vkQueueWaitIdle, it covers all queues as they may be the same queue.
+		std::mutex& GetQueueMutex() { return m_QueueMutex; }
+
 		Swapchain& GetSwapchain() { return m_SwapChain; }
 
 		VulkanAllocator* GetVulkanAllocator() { return m_pAllocator; }
 
+		PipelineCache* GetPipelineCache() { return m_pPipelineCache; }
+
+		UploadManager* GetUploadManager() { return m_pUploadManager; }
+
+		BindlessTable* GetBindlessTable() { return m_pBindlessTable; }
+
+		TextureStreamer* GetTextureStreamer() { return m_pTextureStreamer; }
+
+		UniformBufferRing* GetUniformBufferRing() { return m_pUniformBufferRing; }
+
 		// "rrFunction" will be called just before the device is destroyed.
 		void SubmitTerminateResource( std::function<void()>&& rrFunction ) { m_TerminateResourceFuncs.push_back( std::move( rrFunction ) ); }
 
@@ -153,8 +176,16 @@ namespace Saturn {
 
 		VulkanDebugMessenger* m_pDebugMessenger;
 		VulkanAllocator* m_pAllocator;
+		PipelineCache* m_pPipelineCache = nullptr;
+		UploadManager* m_pUploadManager = nullptr;
+		BindlessTable* m_pBindlessTable = nullptr;
+		TextureStreamer* m_pTextureStreamer = nullptr;
+		UniformBufferRing* m_pUniformBufferRing = nullptr;
 
 		VkQueue m_GraphicsQueue, m_PresentQueue, m_ComputeQueue;
+		VkQueue m_TransferQueue = nullptr;
+
+		std::mutex m_QueueMutex;
 
 		VkSurfaceFormatKHR m_SurfaceFormat;
 
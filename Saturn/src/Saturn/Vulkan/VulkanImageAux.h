@@ -58,6 +58,19 @@ namespace Saturn {
 				return VK_FORMAT_D32_SFLOAT_S8_UINT;
 			case Saturn::ImageFormat::DEPTH32F:
 				return VK_FORMAT_D32_SFLOAT;
+
+			case ImageFormat::BC1:
+				return VK_FORMAT_BC1_RGB_UNORM_BLOCK;
+			case ImageFormat::BC3:
+				return VK_FORMAT_BC3_UNORM_BLOCK;
+			case ImageFormat::BC4:
+				return VK_FORMAT_BC4_UNORM_BLOCK;
+			case ImageFormat::BC5:
+				return VK_FORMAT_BC5_UNORM_BLOCK;
+			case ImageFormat::BC6H:
+				return VK_FORMAT_BC6H_UFLOAT_BLOCK;
+			case ImageFormat::BC7:
+				return VK_FORMAT_BC7_UNORM_BLOCK;
 		}
 
 		return VK_FORMAT_UNDEFINED;
@@ -90,6 +103,19 @@ namespace Saturn {
 
 			case VK_FORMAT_D32_SFLOAT:
 				return ImageFormat::DEPTH32F;
+
+			case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+				return ImageFormat::BC1;
+			case VK_FORMAT_BC3_UNORM_BLOCK:
+				return ImageFormat::BC3;
+			case VK_FORMAT_BC4_UNORM_BLOCK:
+				return ImageFormat::BC4;
+			case VK_FORMAT_BC5_UNORM_BLOCK:
+				return ImageFormat::BC5;
+			case VK_FORMAT_BC6H_UFLOAT_BLOCK:
+				return ImageFormat::BC6H;
+			case VK_FORMAT_BC7_UNORM_BLOCK:
+				return ImageFormat::BC7;
 		}
 
 		return ImageFormat::None;
@@ -105,6 +131,12 @@ namespace Saturn {
 			case Saturn::ImageFormat::RGB32F:
 			case Saturn::ImageFormat::BGRA8:
 			case Saturn::ImageFormat::RED8:
+			case Saturn::ImageFormat::BC1:
+			case Saturn::ImageFormat::BC3:
+			case Saturn::ImageFormat::BC4:
+			case Saturn::ImageFormat::BC5:
+			case Saturn::ImageFormat::BC6H:
+			case Saturn::ImageFormat::BC7:
 				return true;
 		}
 
@@ -121,6 +153,12 @@ namespace Saturn {
 			case VK_FORMAT_R16G16B16A16_UNORM:
 			case VK_FORMAT_B8G8R8A8_UNORM:
 			case VK_FORMAT_R8_UNORM:
+			case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+			case VK_FORMAT_BC3_UNORM_BLOCK:
+			case VK_FORMAT_BC4_UNORM_BLOCK:
+			case VK_FORMAT_BC5_UNORM_BLOCK:
+			case VK_FORMAT_BC6H_UFLOAT_BLOCK:
+			case VK_FORMAT_BC7_UNORM_BLOCK:
 				return true;
 		}
 
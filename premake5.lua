@@ -522,6 +522,138 @@ project "Saturn-ProjectBrowser"
 			runtime "Release"
 			optimize "on"
 
+group "Tools"
+project "Saturn-Replay"
+	location "Saturn-Replay"
+	language "C++"
+	cppdialect "C++20"
+	staticruntime "on"
+	warnings "Default"
+	kind "ConsoleApp"
+
+	targetdir ("bin/" .. outputdir .. "/%{prj.name}")
+	objdir ("bin-int/" .. outputdir .. "/%{prj.name}")
+
+	defines
+	{
+		"_CRT_SECURE_NO_WARNINGS",
+		"SATURN_SS_IMPORT"
+	}
+
+	files
+	{
+		"%{prj.name}/src/**.h",
+		"%{prj.name}/src/**.cpp"
+	}
+
+	includedirs
+	{
+		"Saturn/vendor/spdlog/include",
+		"Saturn/src",
+		"Saturn/vendor",
+--		"%{IncludeDir.Ruby}",
+		"%{IncludeDir.ImGui}",
+		"%{IncludeDir.glm}",
+		"%{IncludeDir.entt}",
+		"%{IncludeDir.assimp}",
+		"%{IncludeDir.DiscordRPC}",
+		"%{IncludeDir.rapidjson}",
+		"%{IncludeDir.glslc}",
+		"%{IncludeDir.shaderc}",
+		"%{IncludeDir.SPIRV_Cross}",
+		"%{IncludeDir.vma}",
+		"%{IncludeDir.ImSpinner}",
+		"%{IncludeDir.PhysX}",
+		"%{IncludeDir.PhysX}/pxshared",
+		"%{IncludeDir.PhysX}/physx",
+		"%{IncludeDir.Optick}",
+		"Saturn/vendor/vulkan/include",
+		"%{IncludeDir.ImGuizmo}",
+		"%{IncludeDir.Filewatch}",
+		"%{IncludeDir.MiniAudio}",
+		"%{IncludeDir.SharedStorage}"
+	}
+
+	links
+	{
+		"Saturn"
+	}
+
+	filter "system:windows"
+		systemversion "latest"
+
+		defines
+		{
+			"SAT_PLATFORM_WINDOWS"
+		}
+
+		filter "configurations:Debug"
+			defines "SAT_DEBUG"
+			runtime "Debug"
+			symbols "on"
+
+			postbuildcommands 
+			{
+				'{COPYFILE} "../Saturn/vendor/assimp/bin/Debug/assimp-vc142-mtd.dll" "%{cfg.targetdir}"',
+				
+				'{COPYFILE} "../bin/Debug-windows-x86_64/Saturn-SharedStorage/Saturn-SharedStorage.dll" "%{cfg.targetdir}"'
+			}
+
+		filter "configurations:Release"
+			defines "SAT_RELEASE"
+			runtime "Release"
+			optimize "on"
+
+			postbuildcommands 
+			{ 
+				'{COPYFILE} "../bin/Release-windows-x86_64/Saturn-SharedStorage/Saturn-SharedStorage.dll" "%{cfg.targetdir}"'
+			}
+
+		filter "configurations:Dist"
+			defines "SAT_DIST"
+			runtime "Release"
+			optimize "on"
+			symbols "Off"
+
+		filter "configurations:Release or configurations:Dist"
+			postbuildcommands 
+			{ 
+				'{COPYFILE} "../Saturn/vendor/assimp/bin/Release/assimp-vc142-mt.dll" "%{cfg.targetdir}"',
+			}
+
+	filter "system:linux"
+		systemversion "latest"
+
+		defines
+		{
+			"SAT_PLATFORM_LINUX"
+		}
+
+		links 
+		{
+			"stdc++fs",
+			"pthread",
+			"dl",
+			"GL",
+			"X11",
+			"ImGui"
+		}
+
+		filter "configurations:Debug"
+			defines "SAT_DEBUG"
+			runtime "Debug"
+			symbols "on"
+
+		filter "configurations:Release"
+			defines "SAT_RELEASE"
+			runtime "Release"
+			optimize "on"
+
+		filter "configurations:Dist"
+			defines "SAT_DIST"
+			runtime "Release"
+			optimize "on"
+
 group "Tools"
 project "SaturnBuildTool"
 	location "SaturnBuildTool"